@@ -180,6 +180,13 @@ int SlicerAppMain(int argc, char* argv[])
     }
 
   // Load all available modules
+  if (app.commandOptions()->lazyModuleLoading())
+    {
+    // Only the startup module is set up, the others are set up when used.
+    moduleFactoryManager->setLazyLoading(true);
+    moduleFactoryManager->setEagerModules(
+      QStringList() << QSettings().value("Modules/HomeModule").toString());
+    }
   foreach(const QString& name, moduleFactoryManager->instantiatedModuleNames())
     {
     Q_ASSERT(!name.isNull());
@@ -190,6 +197,11 @@ int SlicerAppMain(int argc, char* argv[])
     {
     qDebug() << "Number of loaded modules:" << moduleManager->modulesNames().count();
     }
+  if (app.commandOptions()->lazyModuleLoading() && app.commandOptions()->verbose())
+    {
+    qDebug() << "Number of deferred modules:"
+             << moduleFactoryManager->deferredModuleNames().count();
+    }
 
   splashMessage(splashScreen, QString());
 
@@ -204,6 +216,12 @@ int SlicerAppMain(int argc, char* argv[])
     splashScreen->finish(window.data());
     }
 
+  if (app.commandOptions()->profileStartup())
+    {
+    qDebug().nospace() << "Startup timings:\n"
+                       << qPrintable(moduleFactoryManager->startupTimingsReport());
+    }
+
   // Process command line argument after the event loop is started
   QTimer::singleShot(0, &app, SLOT(handleCommandLineArguments()));
 
@@ -0,0 +1,224 @@
+/*=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================*/
+#ifndef __PluginProgressProtocol_h
+#define __PluginProgressProtocol_h
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/// \brief Framed progress messages written by the CLIs on their standard
+/// output.
+///
+/// The application running an executable CLI sets the environment variable
+/// SLICER_CLI_PROGRESS_FRAMES. The plugin filter watchers then report the
+/// progress with frames instead of the <filter-progress> XML tags, which
+/// remain the fallback when the CLI is run by another application.
+/// A frame is a record separator (0x1e), a type character, the value as
+/// text and a unit separator (0x1f). Frames are read as the output comes,
+/// without searching the whole output, and are not part of the text output
+/// of the CLI.
+namespace PluginProgressProtocol
+{
+
+enum FrameType
+{
+  Progress = 'P',
+  StageProgress = 'S',
+  FilterName = 'N',
+  FilterComment = 'C',
+  FilterStart = 'B',
+  FilterEnd = 'E',
+  FilterTime = 'T'
+};
+
+const char FrameBegin = 0x1e;
+const char FrameEnd = 0x1f;
+
+//-----------------------------------------------------------------------------
+inline const char* EnvironmentVariable()
+{
+  return "SLICER_CLI_PROGRESS_FRAMES";
+}
+
+//-----------------------------------------------------------------------------
+/// Return true if the CLI must report its progress with frames
+inline bool UseFrames()
+{
+  static const char* frames = getenv(EnvironmentVariable());
+  return frames != 0 && frames[0] != '\0' && frames[0] != '0';
+}
+
+//-----------------------------------------------------------------------------
+/// The value must not contain the frame separators
+template <class T>
+void WriteFrame(std::ostream& os, FrameType type, const T& value)
+{
+  os << FrameBegin << static_cast<char>(type) << value << FrameEnd;
+}
+
+//-----------------------------------------------------------------------------
+/// Read the frames from the chunks of output of a CLI, or the XML tags of
+/// the CLIs that don't write frames
+class Parser
+{
+public:
+  Parser()
+    : Progress(0.)
+    , StageProgress(0.)
+    , NumberOfFrames(0)
+    , InFrame(false)
+    , ParsedLength(0)
+  {
+  }
+
+  /// Parse a chunk of output, the text outside of the frames is appended
+  /// to text. A frame can be split over several chunks.
+  /// Return true if a progress or a message frame has been read.
+  bool Parse(const char* data, int length, std::string& text)
+  {
+    bool modified = false;
+    const char* end = data + length;
+    const char* textBegin = data;
+    for (const char* c = data; c != end; ++c)
+      {
+      if (*c == FrameBegin)
+        {
+        if (!this->InFrame)
+          {
+          text.append(textBegin, c);
+          }
+        this->InFrame = true;
+        this->Frame.clear();
+        }
+      else if (*c == FrameEnd && this->InFrame)
+        {
+        modified = this->ReadFrame() || modified;
+        this->InFrame = false;
+        textBegin = c + 1;
+        }
+      else if (this->InFrame)
+        {
+        this->Frame += *c;
+        }
+      }
+    if (!this->InFrame)
+      {
+      text.append(textBegin, end);
+      }
+    return modified;
+  }
+
+  /// Search the <filter-progress>, <filter-stage-progress>, <filter-name>
+  /// and <filter-comment> tags in the complete lines of text not searched
+  /// yet. text is the whole output, as appended to by Parse().
+  /// Return true if a value has been read.
+  bool ParseTags(const std::string& text)
+  {
+    const std::string::size_type lineEnd = text.rfind('\n');
+    if (lineEnd == std::string::npos || lineEnd < this->ParsedLength)
+      {
+      return false;
+      }
+    bool modified = false;
+    std::string value;
+    if (FindLastTagValue(text, this->ParsedLength, lineEnd, "filter-progress", value))
+      {
+      this->Progress = atof(value.c_str());
+      modified = true;
+      }
+    if (FindLastTagValue(text, this->ParsedLength, lineEnd, "filter-stage-progress", value))
+      {
+      this->StageProgress = atof(value.c_str());
+      modified = true;
+      }
+    if (FindLastTagValue(text, this->ParsedLength, lineEnd, "filter-name", value))
+      {
+      this->Message = value;
+      modified = true;
+      }
+    if (FindLastTagValue(text, this->ParsedLength, lineEnd, "filter-comment", value))
+      {
+      this->Message = value;
+      modified = true;
+      }
+    this->ParsedLength = lineEnd + 1;
+    return modified;
+  }
+
+  double Progress;
+  double StageProgress;
+  /// Last filter name or comment
+  std::string Message;
+  int NumberOfFrames;
+
+protected:
+  /// Find the value of the last <tag>value</tag> of the text between begin
+  /// and end.
+  static bool FindLastTagValue(const std::string& text,
+                               std::string::size_type begin, std::string::size_type end,
+                               const std::string& tag, std::string& value)
+  {
+    const std::string startTag = "<" + tag + ">";
+    const std::string endTag = "</" + tag + ">";
+    bool found = false;
+    std::string::size_type tagstart = text.find(startTag, begin);
+    while (tagstart != std::string::npos && tagstart < end)
+      {
+      std::string::size_type valuestart = tagstart + startTag.size();
+      std::string::size_type tagend = text.find(endTag, valuestart);
+      if (tagend == std::string::npos || tagend > end)
+        {
+        break;
+        }
+      value.assign(text, valuestart, tagend - valuestart);
+      found = true;
+      tagstart = text.find(startTag, tagend);
+      }
+    return found;
+  }
+
+  bool ReadFrame()
+  {
+    ++this->NumberOfFrames;
+    if (this->Frame.empty())
+      {
+      return false;
+      }
+    const std::string value(this->Frame, 1);
+    // the frame types are qualified, Progress and StageProgress are also
+    // members of the parser
+    switch (this->Frame[0])
+      {
+      case PluginProgressProtocol::Progress:
+        this->Progress = atof(value.c_str());
+        return true;
+      case PluginProgressProtocol::StageProgress:
+        this->StageProgress = atof(value.c_str());
+        return true;
+      case PluginProgressProtocol::FilterName:
+      case PluginProgressProtocol::FilterComment:
+        this->Message = value;
+        return true;
+      default:
+        return false;
+      }
+  }
+
+  bool InFrame;
+  std::string Frame;
+  std::string::size_type ParsedLength;
+};
+
+} // end namespace PluginProgressProtocol
+
+#endif
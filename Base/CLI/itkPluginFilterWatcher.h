@@ -14,6 +14,9 @@
 // ModuleDescriptionParser includes
 #include <ModuleProcessInformation.h>
 
+// SlicerBaseCLI includes
+#include "PluginProgressProtocol.h"
+
 // ITK includes
 #include <itkSimpleFilterWatcher.h>
 
@@ -81,6 +84,19 @@ virtual void ShowProgress()
           (*(m_ProcessInformation->ProgressCallbackFunction))(m_ProcessInformation->ProgressCallbackClientData);
           }
         }
+      else if (PluginProgressProtocol::UseFrames())
+        {
+        PluginProgressProtocol::WriteFrame(std::cout,
+          PluginProgressProtocol::Progress,
+          (this->GetProcess()->GetProgress() * m_Fraction) + m_Start);
+        if (m_Fraction != 1.0)
+          {
+          PluginProgressProtocol::WriteFrame(std::cout,
+            PluginProgressProtocol::StageProgress,
+            this->GetProcess()->GetProgress());
+          }
+        std::cout << std::flush;
+        }
       else
         {
         std::cout << "<filter-progress>"
@@ -122,6 +138,18 @@ virtual void StartFilter()
         (*(m_ProcessInformation->ProgressCallbackFunction))(m_ProcessInformation->ProgressCallbackClientData);
         }
       }
+    else if (PluginProgressProtocol::UseFrames())
+      {
+      PluginProgressProtocol::WriteFrame(std::cout,
+        PluginProgressProtocol::FilterStart, "");
+      PluginProgressProtocol::WriteFrame(std::cout,
+        PluginProgressProtocol::FilterName,
+        this->GetProcess() ? this->GetProcess()->GetNameOfClass() : "None");
+      PluginProgressProtocol::WriteFrame(std::cout,
+        PluginProgressProtocol::FilterComment,
+        " \"" + this->GetComment() + "\" ");
+      std::cout << std::flush;
+      }
     else
       {
       std::cout << "<filter-start>"
@@ -164,6 +192,18 @@ virtual void EndFilter()
         (*(m_ProcessInformation->ProgressCallbackFunction))(m_ProcessInformation->ProgressCallbackClientData);
         }
       }
+    else if (PluginProgressProtocol::UseFrames())
+      {
+      PluginProgressProtocol::WriteFrame(std::cout,
+        PluginProgressProtocol::FilterEnd, "");
+      PluginProgressProtocol::WriteFrame(std::cout,
+        PluginProgressProtocol::FilterName,
+        this->GetProcess() ? this->GetProcess()->GetNameOfClass() : "None");
+      PluginProgressProtocol::WriteFrame(std::cout,
+        PluginProgressProtocol::FilterTime,
+        this->GetTimeProbe().GetMean());
+      std::cout << std::flush;
+      }
     else
       {
       std::cout << "<filter-end>"
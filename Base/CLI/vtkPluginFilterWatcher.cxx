@@ -1,6 +1,9 @@
 
 #include <vtkPluginFilterWatcher.h>
 
+// SlicerBaseCLI includes
+#include "PluginProgressProtocol.h"
+
 // VTK includes
 
 //-----------------------------------------------------------------------------
@@ -31,6 +34,19 @@ public:
           (*(this->Watcher->GetProcessInformation()->ProgressCallbackFunction))(this->Watcher->GetProcessInformation()->ProgressCallbackClientData);
           }
         }
+      else if (PluginProgressProtocol::UseFrames())
+        {
+        PluginProgressProtocol::WriteFrame(std::cout,
+          PluginProgressProtocol::FilterStart, "");
+        PluginProgressProtocol::WriteFrame(std::cout,
+          PluginProgressProtocol::FilterName,
+          this->Watcher->GetProcess()
+          ? this->Watcher->GetProcess()->GetClassName() : "None");
+        PluginProgressProtocol::WriteFrame(std::cout,
+          PluginProgressProtocol::FilterComment,
+          " \"" + this->Watcher->GetComment() + "\" ");
+        std::cout << std::flush;
+        }
       else
         {
         std::cout << "<filter-start>"
@@ -86,6 +102,16 @@ public:
           (*(this->Watcher->GetProcessInformation()->ProgressCallbackFunction))(this->Watcher->GetProcessInformation()->ProgressCallbackClientData);
           }
         }
+      else if (PluginProgressProtocol::UseFrames())
+        {
+        PluginProgressProtocol::WriteFrame(std::cout,
+          PluginProgressProtocol::FilterEnd, "");
+        PluginProgressProtocol::WriteFrame(std::cout,
+          PluginProgressProtocol::FilterName,
+          this->Watcher->GetProcess()
+          ? this->Watcher->GetProcess()->GetClassName() : "None");
+        std::cout << std::flush;
+        }
       else
         {
         std::cout << "<filter-end>"
@@ -153,7 +179,21 @@ public:
         }
       else
         {
-        if (!this->Quiet)
+        if (!this->Quiet && PluginProgressProtocol::UseFrames())
+          {
+          PluginProgressProtocol::WriteFrame(std::cout,
+            PluginProgressProtocol::Progress,
+            (this->Watcher->GetProcess()->GetProgress() *
+             this->Watcher->GetFraction()) + this->Watcher->GetStart());
+          if (this->Watcher->GetFraction() != 1.0)
+            {
+            PluginProgressProtocol::WriteFrame(std::cout,
+              PluginProgressProtocol::StageProgress,
+              this->Watcher->GetProcess()->GetProgress());
+            }
+          std::cout << std::flush;
+          }
+        else if (!this->Quiet)
           {
           std::cout << "<filter-progress>"
                     << (this->Watcher->GetProcess()->GetProgress() *
@@ -0,0 +1,267 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerTask.h"
+
+// VTK includes
+#include <vtkMutexLock.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Logic running the tasks of the test. The tasks record their name in the
+// order they are run.
+class vtkTaskTestLogic : public vtkMRMLAbstractLogic
+{
+public:
+  static vtkTaskTestLogic *New();
+  vtkTypeMacro(vtkTaskTestLogic, vtkMRMLAbstractLogic);
+
+  // Record the name of the task, given as client data
+  void Run(void* clientData)
+  {
+    this->Lock->Lock();
+    this->Order += *static_cast<const char*>(clientData);
+    this->Lock->Unlock();
+  }
+
+  // Record the cancellation of the task, given as client data
+  void Cancel(void* clientData)
+  {
+    this->Lock->Lock();
+    this->Order += '~';
+    this->Order += *static_cast<const char*>(clientData);
+    this->Lock->Unlock();
+  }
+
+  // Wait for Release to be set
+  void Block(void* clientData)
+  {
+    this->Run(clientData);
+    while (!this->WaitFor(&this->Release, 1))
+      {
+      }
+  }
+
+  // Wait for another task to reach the rendezvous
+  void Rendezvous(void* clientData)
+  {
+    this->Lock->Lock();
+    ++this->Arrived;
+    this->Lock->Unlock();
+    if (this->WaitFor(&this->Arrived, 2))
+      {
+      this->Run(clientData);
+      }
+  }
+
+  // Wait at most 5s for the value to reach the minimum
+  bool WaitFor(int* value, int minimum)
+  {
+    for (int i = 0; i < 500; ++i)
+      {
+      this->Lock->Lock();
+      bool reached = *value >= minimum;
+      this->Lock->Unlock();
+      if (reached)
+        {
+        return true;
+        }
+      vtksys::SystemTools::Delay(10);
+      }
+    return false;
+  }
+
+  std::string GetOrder()
+  {
+    this->Lock->Lock();
+    std::string order = this->Order;
+    this->Lock->Unlock();
+    return order;
+  }
+
+  vtkSimpleMutexLock* Lock;
+  std::string Order;
+  int Release;
+  int Arrived;
+
+protected:
+  vtkTaskTestLogic()
+  {
+    this->Lock = vtkSimpleMutexLock::New();
+    this->Release = 0;
+    this->Arrived = 0;
+  }
+  ~vtkTaskTestLogic()
+  {
+    this->Lock->Delete();
+  }
+};
+vtkStandardNewMacro(vtkTaskTestLogic);
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkSlicerTask> NewTask(vtkTaskTestLogic* logic,
+                                       void (vtkTaskTestLogic::*function)(void*),
+                                       const char* name, int priority = 0)
+{
+  vtkSmartPointer<vtkSlicerTask> task = vtkSmartPointer<vtkSlicerTask>::New();
+  task->SetTaskFunction(logic,
+    static_cast<vtkMRMLAbstractLogic::TaskFunctionPointer>(function),
+    const_cast<char*>(name));
+  task->SetTypeToProcessing();
+  task->SetPriority(priority);
+  return task;
+}
+
+//----------------------------------------------------------------------------
+// Wait at most 5s for the task to be completed or cancelled
+bool WaitForTask(vtkSlicerTask* task)
+{
+  for (int i = 0; i < 500; ++i)
+    {
+    if (task->GetStatus() == vtkSlicerTask::Completed ||
+        task->GetStatus() == vtkSlicerTask::Cancelled)
+      {
+      return true;
+      }
+    vtksys::SystemTools::Delay(10);
+    }
+  return false;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogicTest2(int , char * [])
+{
+  vtkSmartPointer<vtkSlicerApplicationLogic> appLogic =
+    vtkSmartPointer<vtkSlicerApplicationLogic>::New();
+  vtkSmartPointer<vtkTaskTestLogic> logic = vtkSmartPointer<vtkTaskTestLogic>::New();
+
+  vtkSmartPointer<vtkSlicerTask> task = NewTask(logic, &vtkTaskTestLogic::Run, "X");
+  if (appLogic->ScheduleTask(task))
+    {
+    std::cerr << "Line " << __LINE__ << ": task scheduled without processing thread" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A single processing thread runs the tasks by priority once the
+  // blocking task is done.
+  appLogic->CreateProcessingThread();
+  vtkSmartPointer<vtkSlicerTask> a = NewTask(logic, &vtkTaskTestLogic::Block, "A");
+  vtkSmartPointer<vtkSlicerTask> b = NewTask(logic, &vtkTaskTestLogic::Run, "B");
+  vtkSmartPointer<vtkSlicerTask> c = NewTask(logic, &vtkTaskTestLogic::Run, "C", 10);
+  vtkSmartPointer<vtkSlicerTask> d = NewTask(logic, &vtkTaskTestLogic::Run, "D", 20);
+  vtkSmartPointer<vtkSlicerTask> e = NewTask(logic, &vtkTaskTestLogic::Run, "E");
+  vtkSmartPointer<vtkSlicerTask> f = NewTask(logic, &vtkTaskTestLogic::Run, "F", 30);
+  d->AddDependency(b);
+  f->AddDependency(e);
+  appLogic->ScheduleTask(a);
+  for (int i = 0; i < 500 && a->GetStatus() != vtkSlicerTask::Running; ++i)
+    {
+    vtksys::SystemTools::Delay(10);
+    }
+  if (a->GetStatus() != vtkSlicerTask::Running)
+    {
+    std::cerr << "Line " << __LINE__ << ": the task is not running" << std::endl;
+    return EXIT_FAILURE;
+    }
+  appLogic->ScheduleTask(b);
+  appLogic->ScheduleTask(c);
+  appLogic->ScheduleTask(d);
+  appLogic->ScheduleTask(e);
+  appLogic->ScheduleTask(f);
+  e->Cancel();
+  logic->Lock->Lock();
+  logic->Release = 1;
+  logic->Lock->Unlock();
+  if (!WaitForTask(d) || !WaitForTask(f) ||
+      d->GetStatus() != vtkSlicerTask::Completed ||
+      e->GetStatus() != vtkSlicerTask::Cancelled ||
+      f->GetStatus() != vtkSlicerTask::Cancelled)
+    {
+    std::cerr << "Line " << __LINE__ << ": tasks not completed or cancelled" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (logic->GetOrder() != "ACBD")
+    {
+    std::cerr << "Line " << __LINE__ << ": tasks run in the order "
+              << logic->GetOrder() << " instead of ACBD" << std::endl;
+    return EXIT_FAILURE;
+    }
+  appLogic->TerminateProcessingThread();
+
+  // Two processing threads run two tasks at the same time
+  appLogic->SetNumberOfProcessingThreads(2);
+  appLogic->CreateProcessingThread();
+  vtkSmartPointer<vtkSlicerTask> g = NewTask(logic, &vtkTaskTestLogic::Rendezvous, "G");
+  vtkSmartPointer<vtkSlicerTask> h = NewTask(logic, &vtkTaskTestLogic::Rendezvous, "H");
+  appLogic->ScheduleTask(g);
+  appLogic->ScheduleTask(h);
+  if (!WaitForTask(g) || !WaitForTask(h) ||
+      logic->GetOrder().size() != 6)
+    {
+    std::cerr << "Line " << __LINE__ << ": the tasks did not run concurrently: "
+              << logic->GetOrder() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The tasks not started when the threads are terminated are run once the
+  // threads are created again
+  vtkSmartPointer<vtkSlicerTask> k = NewTask(logic, &vtkTaskTestLogic::Run, "K");
+  vtkSmartPointer<vtkSlicerTask> l = NewTask(logic, &vtkTaskTestLogic::Run, "L");
+  k->AddDependency(l);
+  appLogic->ScheduleTask(k);
+  appLogic->TerminateProcessingThread();
+  appLogic->CreateProcessingThread();
+  appLogic->ScheduleTask(l);
+  if (!WaitForTask(k) ||
+      k->GetStatus() != vtkSlicerTask::Completed ||
+      logic->GetOrder().substr(6) != "LK")
+    {
+    std::cerr << "Line " << __LINE__ << ": the task scheduled before the threads "
+              << "were terminated did not run: " << logic->GetOrder() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A task with a cancel function is run when it is cancelled, after its
+  // cancel function
+  vtkSmartPointer<vtkSlicerTask> m = NewTask(logic, &vtkTaskTestLogic::Run, "M");
+  vtkSmartPointer<vtkSlicerTask> n = NewTask(logic, &vtkTaskTestLogic::Run, "N");
+  n->SetCancelFunction(static_cast<vtkMRMLAbstractLogic::TaskFunctionPointer>(
+    &vtkTaskTestLogic::Cancel));
+  n->AddDependency(m);
+  m->Cancel();
+  appLogic->ScheduleTask(n);
+  appLogic->ScheduleTask(m);
+  if (!WaitForTask(n) ||
+      m->GetStatus() != vtkSlicerTask::Cancelled ||
+      n->GetStatus() != vtkSlicerTask::Cancelled ||
+      logic->GetOrder().substr(6) != "LK~NN")
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong cancellation of a task with a "
+              << "cancel function: " << logic->GetOrder() << std::endl;
+    return EXIT_FAILURE;
+    }
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Logic includes
+#include "vtkSlicerMeshProcessingFilter.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkPolyData* CreateSphere(vtkSphereSource* sphere)
+{
+  sphere->SetRadius(10.);
+  sphere->SetThetaResolution(128);
+  sphere->SetPhiResolution(128);
+  sphere->Update();
+  return sphere->GetOutput();
+}
+
+//----------------------------------------------------------------------------
+double MaximumRadiusError(vtkPolyData* polyData, double radius)
+{
+  double error = 0.;
+  for (vtkIdType i = 0; i < polyData->GetNumberOfPoints(); ++i)
+    {
+    double point[3];
+    polyData->GetPoint(i, point);
+    error = std::max(error, fabs(vtkMath::Norm(point) - radius));
+    }
+  return error;
+}
+
+//----------------------------------------------------------------------------
+bool TestDecimation()
+{
+  vtkNew<vtkSphereSource> sphere;
+  vtkPolyData* input = CreateSphere(sphere.GetPointer());
+
+  vtkNew<vtkSlicerMeshProcessingFilter> filter;
+  filter->SetInput(input);
+  filter->DecimationOn();
+  filter->SetTargetReduction(0.8);
+  filter->Update();
+  vtkPolyData* output = filter->GetOutput();
+
+  const vtkIdType expectedPolys =
+    static_cast<vtkIdType>(0.2 * input->GetNumberOfPolys());
+  if (output->GetNumberOfPolys() > expectedPolys ||
+      output->GetNumberOfPolys() < expectedPolys - 2)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << output->GetNumberOfPolys()
+              << " triangles instead of " << expectedPolys << std::endl;
+    return false;
+    }
+  // Closed surface of genus 0: V - E + F = 2 with E = 3F/2
+  if (2 * output->GetNumberOfPoints() - output->GetNumberOfPolys() != 4)
+    {
+    std::cerr << "Line " << __LINE__ << ": the topology changed: "
+              << output->GetNumberOfPoints() << " points and "
+              << output->GetNumberOfPolys() << " triangles" << std::endl;
+    return false;
+    }
+  if (MaximumRadiusError(output, 10.) > 0.05)
+    {
+    std::cerr << "Line " << __LINE__ << ": points moved away from the sphere: "
+              << MaximumRadiusError(output, 10.) << std::endl;
+    return false;
+    }
+  // The input normals are passed for the kept points
+  if (output->GetPointData()->GetNormals() == 0 ||
+      output->GetPointData()->GetNormals()->GetNumberOfTuples() !=
+      output->GetNumberOfPoints())
+    {
+    std::cerr << "Line " << __LINE__ << ": point data not passed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestSmoothingAndNormals(int method)
+{
+  vtkNew<vtkSphereSource> sphere;
+  vtkPolyData* input = CreateSphere(sphere.GetPointer());
+
+  vtkNew<vtkSlicerMeshProcessingFilter> filter;
+  filter->SetInput(input);
+  filter->SmoothingOn();
+  filter->SetSmoothingMethod(method);
+  filter->SetNumberOfIterations(20);
+  filter->SetRelaxationFactor(0.1);
+  filter->ComputeNormalsOn();
+  filter->FlipNormalsOn();
+  filter->AutoOrientNormalsOn();
+  filter->SetNumberOfThreads(4);
+  filter->Update();
+  vtkPolyData* output = filter->GetOutput();
+
+  if (output->GetNumberOfPoints() != input->GetNumberOfPoints() ||
+      output->GetNumberOfPolys() != input->GetNumberOfPolys())
+    {
+    std::cerr << "Line " << __LINE__ << ": smoothing changed the mesh size"
+              << std::endl;
+    return false;
+    }
+  // Laplace shrinks the sphere a bit, Taubin barely
+  const double tolerance = method == vtkSlicerMeshProcessingFilter::Taubin ? 0.05 : 0.5;
+  if (MaximumRadiusError(output, 10.) > tolerance)
+    {
+    std::cerr << "Line " << __LINE__ << ": sphere deformed by the smoothing: "
+              << MaximumRadiusError(output, 10.) << std::endl;
+    return false;
+    }
+  // The sphere is oriented outward, then flipped
+  vtkDataArray* normals = output->GetPointData()->GetNormals();
+  if (!normals)
+    {
+    std::cerr << "Line " << __LINE__ << ": no normals" << std::endl;
+    return false;
+    }
+  for (vtkIdType i = 0; i < output->GetNumberOfPoints(); ++i)
+    {
+    double point[3];
+    output->GetPoint(i, point);
+    vtkMath::Normalize(point);
+    if (vtkMath::Dot(point, normals->GetTuple3(i)) > -0.99)
+      {
+      std::cerr << "Line " << __LINE__ << ": wrong normal at point " << i
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerMeshProcessingFilterTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  bool res = true;
+  res = TestDecimation() && res;
+  res = TestSmoothingAndNormals(vtkSlicerMeshProcessingFilter::Laplace) && res;
+  res = TestSmoothingAndNormals(vtkSlicerMeshProcessingFilter::Taubin) && res;
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -12,7 +12,11 @@
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkStringArray.h>
 
 // VTKsys includes
 #include <vtksys/SystemTools.hxx>
@@ -21,6 +25,7 @@
 
 // STD includes
 #include <cassert>
+#include <vector>
 
 #ifdef linux 
 #include "unistd.h"
@@ -316,6 +321,8 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
   //--- Again, test for space to download the file.
   //--- This test has been done in MRML (DataIOManager), but with asynchIO,
   //--- Cache may have become full since the remote read was queued.
+  //--- The least recently used files were already evicted by the
+  //--- DataIOManager when it queued the read.
   //---
   float bufsize = (cm->GetRemoteCacheLimit() * 1000000.0) -  (cm->GetRemoteCacheFreeBufferSize() * 1000000.0);
   if ( (cm->GetCurrentCacheSize()*1000000.0) >= bufsize )
@@ -354,6 +361,7 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
        allCachedFilesExist &&
        ( !(cm->GetEnableForceRedownload())) )
     {
+    cm->TouchCacheEntry ( dest );
     dnode->GetNthStorageNode(storageNodeIndex)->SetReadStateTransferDone();
     vtkDebugMacro("QueueRead: the destination file is there and we're not forceing redownload");
     return 1;
@@ -385,145 +393,79 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
     return 0;
     }
   
-  //--- construct and add a record of the transfer
-  //--- which includes the ID of associated node
-  vtkDataTransfer *transfer0 = vtkDataTransfer::New();
-  if ( transfer0 == NULL )
+  //--- construct and add a record of the transfer of each file
+  //--- which includes the ID of associated node, the first
+  //--- one being the file of the storage node.
+  vtkMRMLStorageNode *storageNode = dnode->GetNthStorageNode(storageNodeIndex);
+  vtkCollection *transfers = vtkCollection::New();
+  for (int n = -1; n < storageNode->GetNumberOfURIs(); n++)
     {
-    vtkErrorMacro("QueueRead: failed to add new data transfer");
-    return 0;
+    vtkDataTransfer *transfer = vtkDataTransfer::New();
+    transfer->SetTransferID ( this->GetDataIOManager()->GetUniqueTransferID() );
+    transfer->SetTransferNodeID ( node->GetID() );
+    transfer->SetSourceURI ( n < 0 ? source : storageNode->GetNthURI(n) );
+    transfer->SetDestinationURI ( n < 0 ? dest : storageNode->GetNthFileName(n) );
+    // use one handler for all files in the storage node
+    transfer->SetHandler ( handler );
+    transfer->SetTransferType ( vtkDataTransfer::RemoteDownload );
+    transfer->SetTransferStatus ( vtkDataTransfer::Idle );
+    transfer->SetCancelRequested ( 0 );
+    //--- Add the data transfer to the collection, and
+    //--- the resulting mrml call will trigger an event
+    //--- that causes GUI to refresh.
+    this->AddNewDataTransfer ( transfer, node );
+    transfers->AddItem ( transfer );
+    transfer->Delete();
     }
-  transfer0->SetTransferID ( this->GetDataIOManager()->GetUniqueTransferID() );
-  transfer0->SetTransferNodeID ( node->GetID() );
-  transfer0->SetSourceURI ( source );
-  transfer0->SetDestinationURI ( dest );
-  transfer0->SetHandler ( handler );
-  transfer0->SetTransferType ( vtkDataTransfer::RemoteDownload );
-  transfer0->SetTransferStatus ( vtkDataTransfer::Idle );
-  transfer0->SetCancelRequested ( 0 );
-  //--- Add the data transfer to the collection, and
-  //--- the resulting mrml call will trigger an event
-  //--- that causes GUI to refresh.
-  this->AddNewDataTransfer ( transfer0, node );
   this->GetDataIOManager()->InvokeEvent ( vtkDataIOManager::RefreshDisplayEvent );
-  
+
   vtkDebugMacro("QueueRead: asynchronous enabled = " << this->GetDataIOManager()->GetEnableAsynchronousIO());
-  
+
   if ( this->GetDataIOManager()->GetEnableAsynchronousIO() )
     {
-    vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer");
+    vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer of " << transfers->GetNumberOfItems() << " files");
     //---
-    //--- Schedule an ASYNCHRONOUS data transfer
+    //--- Schedule an ASYNCHRONOUS data transfer of all the files
+    //--- at once, they are downloaded concurrently by the handler.
     //---
     vtkSlicerTask *task = vtkSlicerTask::New();
-
-    // Pass the current data transfer, which has a pointer 
-    // to the associated mrml node, as client data to the task.
-    if ( !task )
+    task->SetTypeToNetworking();
+    for (int n = 0; n < transfers->GetNumberOfItems(); n++)
       {
-      transfer0->Delete();
-      return 0;
+      vtkDataTransfer::SafeDownCast(transfers->GetItemAsObject(n))
+        ->SetTransferStatus ( vtkDataTransfer::Pending );
       }
-    task->SetTypeToNetworking();
-    transfer0->SetTransferStatus ( vtkDataTransfer::Pending );
+    // Pass the data transfers, which have the ID of the associated
+    // mrml node, as client data to the task. ApplyTransfers deletes them.
     task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
-                          &vtkDataIOManagerLogic::ApplyTransfer, transfer0);
-  
+                          &vtkDataIOManagerLogic::ApplyTransfers, transfers);
+
     // Schedule the transfer
     if ( ! this->GetApplicationLogic()->ScheduleTask( task ) )
       {
-      transfer0->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
+      for (int n = 0; n < transfers->GetNumberOfItems(); n++)
+        {
+        vtkDataTransfer::SafeDownCast(transfers->GetItemAsObject(n))
+          ->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
+        }
+      transfers->Delete();
       task->Delete();
-      return 0;      
+      return 0;
       }
     task->Delete();
     }
   else
     {
-    vtkDebugMacro("QueueRead: Schedule a SYNCHRONOUS data transfer");
+    vtkDebugMacro("QueueRead: Schedule a SYNCHRONOUS data transfer of " << transfers->GetNumberOfItems() << " files");
     //---
     //--- Execute a SYNCHRONOUS data transfer
     //---
-    transfer0->SetTransferStatus( vtkDataTransfer::Running);
-    this->ApplyTransfer ( transfer0 );
-    transfer0->SetTransferStatus( vtkDataTransfer::Completed);
+    this->ApplyTransfers ( transfers );
     // now set the node's storage node state to ready
-    vtkDebugMacro("QueueRead: setting storage node state to transferdone: " << dnode->GetNthStorageNode(storageNodeIndex)->GetURI());
-    if (dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs() == 0)
-      {
-      // done
-      dnode->GetNthStorageNode(storageNodeIndex)->SetReadStateTransferDone();
-      }
+    vtkDebugMacro("QueueRead: setting storage node state to transferdone after synchronous transfer of all files: " << storageNode->GetURI());
+    storageNode->SetReadStateTransferDone();
     }
-  transfer0->Delete();
-//  this->DebugOff();
 
-  // loop over any other files in the storage node
-  for (int n = 0; n < dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs(); n++)
-    {
-    const char *sourceN =  dnode->GetNthStorageNode(storageNodeIndex)->GetNthURI(n);
-    const char *destN = dnode->GetNthStorageNode(storageNodeIndex)->GetNthFileName(n);
-
-    vtkDataTransfer *transfer1 = vtkDataTransfer::New();
-    if ( transfer1 == NULL )
-      {
-      vtkErrorMacro("QueueRead: failed to add new data transfer for file " << n);
-      return 0;
-      }
-    transfer1->SetTransferID ( this->GetDataIOManager()->GetUniqueTransferID() );
-    transfer1->SetTransferNodeID ( node->GetID() );
-    transfer1->SetSourceURI ( sourceN );
-    transfer1->SetDestinationURI ( destN );
-    // use one handler for all files in the storage node
-    transfer1->SetHandler ( handler );
-    transfer1->SetTransferType ( vtkDataTransfer::RemoteDownload );
-    transfer1->SetTransferStatus ( vtkDataTransfer::Idle );
-    transfer1->SetCancelRequested ( 0 );
-    this->AddNewDataTransfer ( transfer1, node );
-    this->GetDataIOManager()->InvokeEvent ( vtkDataIOManager::RefreshDisplayEvent );
-    
-    if ( this->GetDataIOManager()->GetEnableAsynchronousIO() )
-      {
-      vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer, n = " << n);
-      vtkSlicerTask *task = vtkSlicerTask::New();
-      
-      if ( !task )
-        {
-        transfer1->Delete();
-        return 0;
-        }
-      task->SetTypeToNetworking();
-      transfer1->SetTransferStatus ( vtkDataTransfer::Pending );
-      task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
-                            &vtkDataIOManagerLogic::ApplyTransfer, transfer1);
-  
-      // Schedule the transfer
-      if ( ! this->GetApplicationLogic()->ScheduleTask( task ) )
-        {
-        transfer1->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
-        task->Delete();
-        return 0;      
-        }
-      task->Delete();
-      }
-    else
-      {
-      vtkDebugMacro("QueueRead: Schedule a SYNCHRONOUS data transfer, n = " << n);
-      transfer1->SetTransferStatus( vtkDataTransfer::Running);
-      this->ApplyTransfer ( transfer1 );
-      transfer1->SetTransferStatus( vtkDataTransfer::Completed);
-      // now set the node's storage node state to ready
-   
-      }
-    transfer1->Delete();
-    }
-  if ( dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs() > 0 &&
-       !this->GetDataIOManager()->GetEnableAsynchronousIO())
-    {
-    vtkDebugMacro("QueueRead: setting storage node state to transferdone after synchronous transfer of all files: " << dnode->GetNthStorageNode(storageNodeIndex)->GetURI());
-    dnode->GetNthStorageNode(storageNodeIndex)->SetReadStateTransferDone();
-    }
-  
   return 1;
 }
 
@@ -756,58 +698,9 @@ void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
     //---
     //--- Download data
     //---
-     vtkURIHandler *handler = dt->GetHandler();
-     if ( handler != NULL && source != NULL && dest != NULL )
-      {
-      if ( asynchIO && dt->GetTransferStatus() == vtkDataTransfer::Pending)
-        {
-        dt->SetTransferStatusNoModify ( vtkDataTransfer::Running );
-        this->GetApplicationLogic()->RequestModified( dt );
-        handler->StageFileRead( source, dest);
-        dt->SetTransferStatusNoModify ( vtkDataTransfer::Completed );
-        this->GetApplicationLogic()->RequestModified( dt );
-
-        vtkMRMLStorableNode *storableNode = vtkMRMLStorableNode::SafeDownCast( node );
-        if ( !storableNode )
-          {
-          vtkErrorMacro( "ApplyTransfer: could not get storable node for scheduled data transfer" );
-          return;
-          }
-        // find the storage node that's been scheduled  and we're working on it
-        int storageNodeIndex = -1;
-        for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); i++)
-          {
-          if (storableNode->GetNthStorageNode(i)->GetReadState() == vtkMRMLStorageNode::Transferring &&
-              strcmp(storableNode->GetNthStorageNode(i)->GetURI(),source) == 0)
-            {
-            vtkDebugMacro("ApplyTransfer: found a working storage node who's uri matches source " << source << " at " << i);
-            storageNodeIndex = i;
-            break;
-            }
-          }
-        if (storageNodeIndex == -1)
-          {
-          vtkErrorMacro("ApplyTransfer: unable to find a storage node in scheduled state.");
-          }
-        vtkMRMLStorageNode *storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
-        if ( !storageNode )
-          {
-          vtkErrorMacro( "ApplyTransfer: no storage node for scheduled data transfer" );
-          return;
-          }
-        storageNode->SetDisableModifiedEvent( 1 );
-        // let the storage node know that the remote transfer is done
-        vtkDebugMacro("ApplyTransfer: setting storage node read state to transfer done for uri " << storageNode->GetURI());
-        storageNode->SetReadStateTransferDone();
-        storageNode->SetDisableModifiedEvent( 0 );
-        this->GetApplicationLogic()->RequestReadData( node->GetID(), dest, 0, 0 );
-        }
-      else
-        {
-        vtkDebugMacro("ApplyTransfer: stage file read on the handler..., source = " << source << ", dest = " << dest);
-        handler->StageFileRead( source, dest);
-        }
-      }
+    vtkCollection *transfers = vtkCollection::New();
+    transfers->AddItem ( dt );
+    this->ApplyTransfers ( transfers );
     }
   else if ( dt->GetTransferType() == vtkDataTransfer::RemoteUpload  )
     {
@@ -873,6 +766,130 @@ void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
 
 
 
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::ApplyTransfers( void *clientdata )
+{
+  vtkCollection *transfers = reinterpret_cast < vtkCollection*> (clientdata);
+  if ( transfers == NULL || transfers->GetNumberOfItems() == 0 )
+    {
+    vtkErrorMacro("ApplyTransfers: no data transfer");
+    if ( transfers )
+      {
+      transfers->Delete();
+      }
+    return;
+    }
+
+  //assume synchronous io if no data manager exists.
+  vtkDataIOManager *iom = this->GetDataIOManager();
+  vtkCacheManager *cm = iom ? iom->GetCacheManager() : NULL;
+  vtkDataTransfer *dt0 = vtkDataTransfer::SafeDownCast ( transfers->GetItemAsObject(0) );
+  //--- the transfers are pending if they run in a networking task
+  const bool scheduled = iom != NULL && iom->GetEnableAsynchronousIO() &&
+    dt0->GetTransferStatus() == vtkDataTransfer::Pending;
+  vtkURIHandler *handler = dt0->GetHandler();
+
+  std::vector<vtkDataTransfer*> downloads;
+  vtkNew<vtkStringArray> sources;
+  vtkNew<vtkStringArray> destinations;
+  for (int n = 0; n < transfers->GetNumberOfItems(); n++)
+    {
+    vtkDataTransfer *dt = vtkDataTransfer::SafeDownCast ( transfers->GetItemAsObject(n) );
+    if ( dt->GetCancelRequested() )
+      {
+      this->SetTransferStatus ( dt, vtkDataTransfer::Cancelled, scheduled );
+      continue;
+      }
+    if ( handler == NULL || dt->GetSourceURI() == NULL || dt->GetDestinationURI() == NULL )
+      {
+      vtkErrorMacro("ApplyTransfers: either no handler, or source or dest are null.");
+      this->SetTransferStatus ( dt, vtkDataTransfer::CompletedWithErrors, scheduled );
+      continue;
+      }
+    this->SetTransferStatus ( dt, vtkDataTransfer::Running, scheduled );
+    sources->InsertNextValue ( dt->GetSourceURI() );
+    destinations->InsertNextValue ( dt->GetDestinationURI() );
+    downloads.push_back ( dt );
+    }
+
+  //--- download all the files at once, the handler runs them concurrently
+  vtkNew<vtkIntArray> succeeded;
+  if ( !downloads.empty() )
+    {
+    vtkDebugMacro("ApplyTransfers: stage " << downloads.size() << " file reads on the handler, first source = " << sources->GetValue(0));
+    handler->StageFileReads ( sources.GetPointer(), destinations.GetPointer(), succeeded.GetPointer() );
+    }
+  for (size_t n = 0; n < downloads.size(); n++)
+    {
+    if ( succeeded->GetValue(n) )
+      {
+      if ( cm != NULL )
+        {
+        cm->AddCacheEntry ( downloads[n]->GetDestinationURI(), downloads[n]->GetSourceURI() );
+        }
+      this->SetTransferStatus ( downloads[n], vtkDataTransfer::Completed, scheduled );
+      }
+    else
+      {
+      this->SetTransferStatus ( downloads[n], vtkDataTransfer::CompletedWithErrors, scheduled );
+      }
+    }
+
+  vtkMRMLNode *node = scheduled ?
+    this->GetMRMLScene()->GetNodeByID ( dt0->GetTransferNodeID() ) : NULL;
+  vtkMRMLStorableNode *storableNode = vtkMRMLStorableNode::SafeDownCast( node );
+  if ( scheduled && storableNode == NULL )
+    {
+    vtkErrorMacro( "ApplyTransfers: could not get storable node for scheduled data transfer " << dt0->GetTransferNodeID() );
+    }
+  else if ( scheduled )
+    {
+    //--- find the storage node that's been scheduled and we're working on it
+    const char *source = dt0->GetSourceURI();
+    vtkMRMLStorageNode *storageNode = NULL;
+    for (int i = 0; source != NULL && i < storableNode->GetNumberOfStorageNodes(); i++)
+      {
+      if (storableNode->GetNthStorageNode(i)->GetReadState() == vtkMRMLStorageNode::Transferring &&
+          strcmp(storableNode->GetNthStorageNode(i)->GetURI(),source) == 0)
+        {
+        vtkDebugMacro("ApplyTransfers: found a working storage node who's uri matches source " << source << " at " << i);
+        storageNode = storableNode->GetNthStorageNode(i);
+        break;
+        }
+      }
+    if ( !storageNode )
+      {
+      vtkErrorMacro( "ApplyTransfers: no storage node for scheduled data transfer" );
+      }
+    else
+      {
+      storageNode->SetDisableModifiedEvent( 1 );
+      //--- let the storage node know that the remote transfer of all its files is done
+      vtkDebugMacro("ApplyTransfers: setting storage node read state to transfer done for uri " << storageNode->GetURI());
+      storageNode->SetReadStateTransferDone();
+      storageNode->SetDisableModifiedEvent( 0 );
+      this->GetApplicationLogic()->RequestReadData( node->GetID(), dt0->GetDestinationURI(), 0, 0 );
+      }
+    }
+  transfers->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::SetTransferStatus ( vtkDataTransfer *transfer,
+                                               int status, bool scheduled )
+{
+  if ( scheduled )
+    {
+    //--- the observers are notified in the main thread
+    transfer->SetTransferStatusNoModify ( status );
+    this->GetApplicationLogic()->RequestModified( transfer );
+    }
+  else
+    {
+    transfer->SetTransferStatus ( status );
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkDataIOManagerLogic::ProgressCallback ( void * vtkNotUsed(who) )
 {
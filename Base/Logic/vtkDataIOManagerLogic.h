@@ -45,6 +45,14 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkDataIOManagerLogic : public vtkSlicerModul
   /// The method that executes the data transfer in another thread
   virtual void ApplyTransfer(void *clientdata);
 
+  /// 
+  /// The method that executes the downloads of all the files of a storage
+  /// node at once, in another thread. The client data is a vtkCollection
+  /// of data transfers sharing the same handler, the first being the file
+  /// of the storage node. The collection is deleted once the transfers are
+  /// done.
+  virtual void ApplyTransfers(void *clientdata);
+
   /// Description
   /// Communicates progress back to the DataIOManager
   static void ProgressCallback ( void * );
@@ -66,6 +74,10 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkDataIOManagerLogic : public vtkSlicerModul
   vtkDataIOManagerLogic(const vtkDataIOManagerLogic&);
   void operator=(const vtkDataIOManagerLogic&);
 
+  /// Set the status of a transfer, notifying the observers from the main
+  /// thread if the transfer is \a scheduled in a networking task
+  void SetTransferStatus ( vtkDataTransfer *transfer, int status, bool scheduled );
+
   vtkObserverManager* GetDataIOObserverManager();
   vtkObserverManager* DataIOObserverManager;
   static void DataIOManagerCallback(vtkObject *caller, unsigned long eid, void *clientData, void *callData);
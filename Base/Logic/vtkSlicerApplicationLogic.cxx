@@ -48,6 +48,9 @@
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
 
+// ITK includes
+#include <itkConditionVariable.h>
+
 // ITKSYS includes
 #include <itksys/SystemTools.hxx>
 
@@ -56,10 +59,83 @@
 #ifdef linux
 # include <unistd.h>
 #endif
+#include <list>
 #include <queue>
 
 //----------------------------------------------------------------------------
-class ProcessingTaskQueue : public std::queue<vtkSmartPointer<vtkSlicerTask> > {};
+// Scheduled tasks sorted by decreasing priority, in the order they were
+// scheduled for the same priority. The processing threads wait on
+// Condition until a task they can run is scheduled or a task is done.
+// Lock protects the tasks, their status and Active.
+class ProcessingTaskQueue
+{
+public:
+  ProcessingTaskQueue()
+  {
+    this->Condition = itk::ConditionVariable::New();
+    this->Active = false;
+  }
+
+  void Push(vtkSlicerTask* task)
+  {
+    std::list<vtkSmartPointer<vtkSlicerTask> >::iterator it = this->Tasks.begin();
+    while (it != this->Tasks.end() && (*it)->GetPriority() >= task->GetPriority())
+      {
+      ++it;
+      }
+    task->SetStatus(vtkSlicerTask::Scheduled);
+    this->Tasks.insert(it, task);
+  }
+
+  // Remove and return the first task of the type ready to run or 0.
+  // Cancelled tasks are removed on the way, except the ones with a cancel
+  // function that are run to let them clean up.
+  vtkSmartPointer<vtkSlicerTask> Pop(int taskType)
+  {
+    std::list<vtkSmartPointer<vtkSlicerTask> >::iterator it = this->Tasks.begin();
+    while (it != this->Tasks.end())
+      {
+      vtkSlicerTask* task = *it;
+      bool cancelled = task->GetCancelRequested();
+      bool ready = true;
+      for (int i = 0; i < task->GetNumberOfDependencies(); ++i)
+        {
+        int status = task->GetDependency(i)->GetStatus();
+        cancelled = cancelled || status == vtkSlicerTask::Cancelled;
+        ready = ready && status == vtkSlicerTask::Completed;
+        }
+      if (cancelled && task->HasCancelFunction())
+        {
+        // A dependency may have been cancelled
+        task->Cancel();
+        ready = true;
+        }
+      else if (cancelled)
+        {
+        task->SetStatus(vtkSlicerTask::Cancelled);
+        it = this->Tasks.erase(it);
+        // The tasks depending on it before in the list can be cancelled too
+        it = this->Tasks.begin();
+        continue;
+        }
+      if (ready && task->GetType() == taskType)
+        {
+        vtkSmartPointer<vtkSlicerTask> readyTask = task;
+        this->Tasks.erase(it);
+        return readyTask;
+        }
+      ++it;
+      }
+    return 0;
+  }
+
+  std::list<vtkSmartPointer<vtkSlicerTask> > Tasks;
+  itk::SimpleMutexLock Lock;
+  itk::ConditionVariable::Pointer Condition;
+  bool Active;
+};
+
+//----------------------------------------------------------------------------
 class ModifiedQueue : public std::queue<vtkSmartPointer<vtkObject> > {};
 
 //----------------------------------------------------------------------------
@@ -210,10 +286,9 @@ vtkStandardNewMacro(vtkSlicerApplicationLogic);
 vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 {
   this->ProcessingThreader = itk::MultiThreader::New();
-  this->ProcessingThreadId = -1;
+  this->NumberOfProcessingThreads = 1;
   this->ProcessingThreadActive = false;
   this->ProcessingThreadActiveLock = itk::MutexLock::New();
-  this->ProcessingTaskQueueLock = itk::MutexLock::New();
 
   this->ModifiedQueueActive = false;
   this->ModifiedQueueActiveLock = itk::MutexLock::New();
@@ -238,19 +313,30 @@ vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
 {
   // Note that TerminateThread does not kill a thread, it only waits
-  // for the thread to finish.  We need to signal the thread that we
+  // for the thread to finish.  We need to signal the threads that we
   // want to terminate
-  if (this->ProcessingThreadId != -1 && this->ProcessingThreader)
+  if (!this->ProcessingThreadIDs.empty() && this->ProcessingThreader)
     {
-    // Signal the processingThread that we are terminating.
+    // Signal the processing threads that we are terminating.
     this->ProcessingThreadActiveLock->Lock();
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock->Unlock();
+    this->InternalTaskQueue->Lock.Lock();
+    this->InternalTaskQueue->Active = false;
+    this->InternalTaskQueue->Condition->Broadcast();
+    this->InternalTaskQueue->Lock.Unlock();
 
-    // Wait for the thread to finish and clean up the state of the threader
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-
-    this->ProcessingThreadId = -1;
+    // Wait for the threads to finish and clean up the state of the threader
+    for (size_t i = 0; i < this->ProcessingThreadIDs.size(); ++i)
+      {
+      this->ProcessingThreader->TerminateThread( this->ProcessingThreadIDs[i] );
+      }
+    for (size_t i = 0; i < this->NetworkingThreadIDs.size(); ++i)
+      {
+      this->ProcessingThreader->TerminateThread( this->NetworkingThreadIDs[i] );
+      }
+    this->ProcessingThreadIDs.clear();
+    this->NetworkingThreadIDs.clear();
     }
 
   delete this->InternalTaskQueue;
@@ -298,16 +384,21 @@ void vtkSlicerApplicationLogic::PrintSelf(ostream& os, vtkIndent indent)
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::CreateProcessingThread()
 {
-  if (this->ProcessingThreadId == -1)
+  if (this->ProcessingThreadIDs.empty())
     {
     this->ProcessingThreadActiveLock->Lock();
     this->ProcessingThreadActive = true;
     this->ProcessingThreadActiveLock->Unlock();
+    this->InternalTaskQueue->Lock.Lock();
+    this->InternalTaskQueue->Active = true;
+    this->InternalTaskQueue->Lock.Unlock();
 
-    this->ProcessingThreadId
-      = this->ProcessingThreader
-      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
-                    this);
+    for (int i = 0; i < this->NumberOfProcessingThreads; ++i)
+      {
+      this->ProcessingThreadIDs.push_back( this->ProcessingThreader
+        ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
+                      this) );
+      }
 
     // Start four network threads (TODO: make the number of threads a setting)
     this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
@@ -350,7 +441,7 @@ void vtkSlicerApplicationLogic::CreateProcessingThread()
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::TerminateProcessingThread()
 {
-  if (this->ProcessingThreadId != -1)
+  if (!this->ProcessingThreadIDs.empty())
     {
     std::cout << "vtkSlicerApplicationLogic::TerminateProcessingThread()" << std::endl;
     this->ModifiedQueueActiveLock->Lock();
@@ -369,10 +460,22 @@ void vtkSlicerApplicationLogic::TerminateProcessingThread()
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock->Unlock();
 
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-    this->ProcessingThreadId = -1;
+    // Wake up the threads waiting for a task. The tasks that have not
+    // started stay in the queue until the threads are created again.
+    this->InternalTaskQueue->Lock.Lock();
+    this->InternalTaskQueue->Active = false;
+    this->InternalTaskQueue->Condition->Broadcast();
+    this->InternalTaskQueue->Lock.Unlock();
 
     std::vector<int>::const_iterator idIterator;
+    idIterator = this->ProcessingThreadIDs.begin();
+    while (idIterator != this->ProcessingThreadIDs.end())
+      {
+      this->ProcessingThreader->TerminateThread( *idIterator );
+      ++idIterator;
+      }
+    this->ProcessingThreadIDs.clear();
+
     idIterator = this->NetworkingThreadIDs.begin();
     while (idIterator != this->NetworkingThreadIDs.end())
       {
@@ -417,48 +520,36 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessProcessingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
+  this->ProcessTasks(vtkSlicerTask::Processing);
+}
 
-  while (active)
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ProcessTasks(int taskType)
+{
+  ProcessingTaskQueue* queue = this->InternalTaskQueue;
+  queue->Lock.Lock();
+  while (queue->Active)
     {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock->Lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock->Unlock();
-
-    if (active)
+    // pull a task off the queue
+    vtkSmartPointer<vtkSlicerTask> task = queue->Pop(taskType);
+    if (!task)
       {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-        {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-
-        // only handle processing tasks in this thread
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Processing )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
-        }
-      this->ProcessingTaskQueueLock->Unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
-        {
-        task->Execute();
-        task = 0;
-        }
+      // Sleep until a task is scheduled or done, or the threads terminate
+      queue->Condition->Wait(&queue->Lock);
+      continue;
       }
+    task->SetStatus(vtkSlicerTask::Running);
+    queue->Lock.Unlock();
+
+    task->Execute();
 
-    // busy wait
-    itksys::SystemTools::Delay(100);
+    queue->Lock.Lock();
+    task->SetStatus(task->GetCancelRequested() ?
+                    vtkSlicerTask::Cancelled : vtkSlicerTask::Completed);
+    // Tasks depending on this one may be ready to run
+    queue->Condition->Broadcast();
     }
+  queue->Lock.Unlock();
 }
 
 ITK_THREAD_RETURN_TYPE
@@ -493,46 +584,7 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
-
-  while (active)
-    {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock->Lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock->Unlock();
-
-    if (active)
-      {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-        {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Networking )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
-        }
-      this->ProcessingTaskQueueLock->Unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
-        {
-        task->Execute();
-        task = 0;
-        }
-      }
-
-    // busy wait
-    itksys::SystemTools::Delay(100);
-    }
+  this->ProcessTasks(vtkSlicerTask::Networking);
 }
 
 //----------------------------------------------------------------------------
@@ -549,10 +601,11 @@ int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
 
   if (active)
     {
-    this->ProcessingTaskQueueLock->Lock();
-    (*this->InternalTaskQueue).push( task );
-    //std::cout << (*this->InternalTaskQueue).size() << std::endl;
-    this->ProcessingTaskQueueLock->Unlock();
+    this->InternalTaskQueue->Lock.Lock();
+    this->InternalTaskQueue->Push( task );
+    // Wake up the threads, only the ones of the task type can run it
+    this->InternalTaskQueue->Condition->Broadcast();
+    this->InternalTaskQueue->Lock.Unlock();
 
     return true;
     }
@@ -56,11 +56,19 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// (display it in the Fiducials GUI)
   void PropagateFiducialListSelection();
 
-  /// Create a thread for processing
+  /// Create the threads for processing
   void CreateProcessingThread();
 
-  /// Shutdown the processing thread
+  /// Shutdown the processing threads. The tasks that have not started
+  /// are run once the threads are created again.
   void TerminateProcessingThread();
+
+  /// Number of threads running the processing tasks, i.e. the number of
+  /// tasks (e.g. CLI modules) that can run concurrently. It is used by
+  /// the next call to CreateProcessingThread(). 1 by default.
+  vtkSetClampMacro(NumberOfProcessingThreads, int, 1, 32);
+  vtkGetMacro(NumberOfProcessingThreads, int);
+
   /// List of events potentially fired by the application logic
   enum RequestEvents
     {
@@ -77,6 +85,11 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// Schedule a task to run in the processing thread. Returns true if
   /// task was successfully scheduled. ScheduleTask() is called from the
   /// main thread to run something in the processing thread.
+  /// The first idle thread of the type of the task runs it, as soon as the
+  /// tasks it depends on are completed and no task with a higher priority
+  /// is ready to run.
+  /// \sa vtkSlicerTask::SetPriority(), vtkSlicerTask::AddDependency(),
+  /// vtkSlicerTask::Cancel()
   int ScheduleTask( vtkSlicerTask* );
 
   /// Request a Modified call on an object.  This method allows a
@@ -188,12 +201,16 @@ protected:
   /// Callback used by a MultiThreader to start a networking thread
   static ITK_THREAD_RETURN_TYPE NetworkingThreaderCallback( void * );
 
-  /// Task processing loop that is run in the processing thread
+  /// Task processing loop that is run in the processing threads
   void ProcessProcessingTasks();
 
   /// Networking Task processing loop that is run in a networking thread
   void ProcessNetworkingTasks();
 
+  /// Run the tasks of the given type until the threads are terminated.
+  /// The thread sleeps while there is no task to run.
+  void ProcessTasks(int taskType);
+
   /// Process a request to read data into a node.  This method is
   /// called by ProcessReadData() in the application main thread
   /// because calls to load data will cause a Modified() on a node
@@ -214,7 +231,6 @@ private:
 
   itk::MultiThreader::Pointer ProcessingThreader;
   itk::MutexLock::Pointer ProcessingThreadActiveLock;
-  itk::MutexLock::Pointer ProcessingTaskQueueLock;
   itk::MutexLock::Pointer ModifiedQueueActiveLock;
   itk::MutexLock::Pointer ModifiedQueueLock;
   itk::MutexLock::Pointer ReadDataQueueActiveLock;
@@ -222,8 +238,9 @@ private:
   itk::MutexLock::Pointer WriteDataQueueActiveLock;
   itk::MutexLock::Pointer WriteDataQueueLock;
   vtkTimeStamp RequestTimeStamp;
-  int ProcessingThreadId;
+  std::vector<int> ProcessingThreadIDs;
   std::vector<int> NetworkingThreadIDs;
+  int NumberOfProcessingThreads;
   int ProcessingThreadActive;
   int ModifiedQueueActive;
   int ReadDataQueueActive;
@@ -0,0 +1,1091 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// SlicerBaseLogic includes
+#include "vtkSlicerMeshProcessingFilter.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkSlicerMeshProcessingFilter, "$Revision$");
+vtkStandardNewMacro(vtkSlicerMeshProcessingFilter);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Work on a range of items [begin, end). The ranges given to the threads
+/// do not overlap.
+class RangeFunctor
+{
+public:
+  virtual ~RangeFunctor() {}
+  virtual void Execute(vtkIdType begin, vtkIdType end) = 0;
+};
+
+struct ThreadedRange
+{
+  RangeFunctor* Functor;
+  vtkIdType Size;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE ThreadedRangeExecute(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ThreadedRange* range = static_cast<ThreadedRange*>(info->UserData);
+  const vtkIdType begin = range->Size * info->ThreadID / info->NumberOfThreads;
+  const vtkIdType end = range->Size * (info->ThreadID + 1) / info->NumberOfThreads;
+  range->Functor->Execute(begin, end);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+/// Split [0, size) among the threads of the threader
+void ParallelFor(vtkMultiThreader* threader, vtkIdType size, RangeFunctor& functor)
+{
+  // Not worth spawning threads for small meshes
+  if (size < 4096 || threader->GetNumberOfThreads() < 2)
+    {
+    functor.Execute(0, size);
+    return;
+    }
+  ThreadedRange range;
+  range.Functor = &functor;
+  range.Size = size;
+  threader->SetSingleMethod(ThreadedRangeExecute, &range);
+  threader->SingleMethodExecute();
+}
+
+//----------------------------------------------------------------------------
+/// Triangle soup shared by all the steps of the filter
+struct TriangleMesh
+{
+  std::vector<double> Points; // x, y, z
+  std::vector<vtkIdType> Triangles; // 3 point ids
+
+  vtkIdType GetNumberOfPoints() const
+    { return static_cast<vtkIdType>(this->Points.size() / 3); }
+  vtkIdType GetNumberOfTriangles() const
+    { return static_cast<vtkIdType>(this->Triangles.size() / 3); }
+};
+
+//----------------------------------------------------------------------------
+void AddTriangle(TriangleMesh& mesh, vtkIdType a, vtkIdType b, vtkIdType c)
+{
+  if (a == b || b == c || a == c)
+    {
+    return;
+    }
+  mesh.Triangles.push_back(a);
+  mesh.Triangles.push_back(b);
+  mesh.Triangles.push_back(c);
+}
+
+//----------------------------------------------------------------------------
+/// Unnormalized normal of a triangle, twice its area long
+void TriangleNormal(const double* p0, const double* p1, const double* p2,
+                    double normal[3])
+{
+  const double u[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+  const double v[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+  vtkMath::Cross(u, v, normal);
+}
+
+//----------------------------------------------------------------------------
+// Quadrics are stored as the upper half of the symmetric matrix A, the
+// vector b and the scalar c of the error v.A.v + 2 b.v + c
+const int QuadricSize = 10;
+
+//----------------------------------------------------------------------------
+void AddPlaneQuadric(double* q, const double n[3], double d, double weight)
+{
+  q[0] += weight * n[0] * n[0];
+  q[1] += weight * n[0] * n[1];
+  q[2] += weight * n[0] * n[2];
+  q[3] += weight * n[1] * n[1];
+  q[4] += weight * n[1] * n[2];
+  q[5] += weight * n[2] * n[2];
+  q[6] += weight * d * n[0];
+  q[7] += weight * d * n[1];
+  q[8] += weight * d * n[2];
+  q[9] += weight * d * d;
+}
+
+//----------------------------------------------------------------------------
+double EvaluateQuadric(const double* q, const double p[3])
+{
+  const double error =
+    q[0] * p[0] * p[0] + 2. * q[1] * p[0] * p[1] + 2. * q[2] * p[0] * p[2]
+    + q[3] * p[1] * p[1] + 2. * q[4] * p[1] * p[2] + q[5] * p[2] * p[2]
+    + 2. * (q[6] * p[0] + q[7] * p[1] + q[8] * p[2]) + q[9];
+  return error > 0. ? error : 0.;
+}
+
+//----------------------------------------------------------------------------
+/// Point of least error, false if the quadric is (nearly) singular
+bool MinimizeQuadric(const double* q, double p[3])
+{
+  double a[3][3] = {{q[0], q[1], q[2]},
+                    {q[1], q[3], q[4]},
+                    {q[2], q[4], q[5]}};
+  const double scale = std::max(q[0], std::max(q[3], q[5]));
+  const double determinant = vtkMath::Determinant3x3(a);
+  if (scale <= 0. || fabs(determinant) < 1e-9 * scale * scale * scale)
+    {
+    return false;
+    }
+  double inverse[3][3];
+  vtkMath::Invert3x3(a, inverse);
+  const double minusB[3] = {-q[6], -q[7], -q[8]};
+  vtkMath::Multiply3x3(inverse, minusB, p);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Greedy edge collapse driven by the quadric error metric
+class QuadricDecimator
+{
+public:
+  QuadricDecimator(TriangleMesh& mesh, bool boundaryDeletion);
+
+  /// Collapse edges until at most numberOfTriangles triangles are left or no
+  /// collapse is possible. Return false if aborted.
+  bool Decimate(vtkIdType numberOfTriangles, vtkAlgorithm* algorithm);
+
+  /// Remove the deleted triangles and the unused points from the mesh.
+  /// pointMap is set to the new id of the input points, -1 if removed.
+  void Compact(std::vector<vtkIdType>& pointMap);
+
+protected:
+  enum PointFlags
+    {
+    Boundary = 0x1,
+    NonManifold = 0x2,
+    Removed = 0x4
+    };
+
+  struct Collapse
+    {
+    double Cost;
+    vtkIdType Points[2];
+    unsigned int Versions[2];
+    bool operator>(const Collapse& other) const
+      { return this->Cost > other.Cost; }
+    };
+
+  double* Position(vtkIdType point)
+    { return &this->Mesh.Points[3 * point]; }
+  double* Quadric(vtkIdType point)
+    { return &this->Quadrics[QuadricSize * point]; }
+  bool IsPinned(vtkIdType point) const;
+  /// Sorted neighbors of a point, excluding another point
+  void GetNeighbors(vtkIdType point, vtkIdType excluded,
+                    std::vector<vtkIdType>& neighbors) const;
+
+  /// Choose the kept point and its new position, false if the edge can't
+  /// be collapsed
+  bool ComputeCollapse(vtkIdType a, vtkIdType b, vtkIdType& keep,
+                       vtkIdType& remove, double position[3], double& cost);
+  void QueueCollapse(vtkIdType a, vtkIdType b);
+  bool IsCollapseValid(vtkIdType keep, vtkIdType remove, const double position[3]);
+  void ApplyCollapse(vtkIdType keep, vtkIdType remove, const double position[3]);
+  void RemoveTriangleFromPoint(vtkIdType triangle, vtkIdType point);
+
+  TriangleMesh& Mesh;
+  bool BoundaryDeletion;
+  vtkIdType NumberOfTriangles;
+  std::vector<std::vector<vtkIdType> > PointTriangles;
+  std::vector<double> Quadrics;
+  std::vector<unsigned char> Flags;
+  std::vector<unsigned int> Versions;
+  std::vector<unsigned char> RemovedTriangles;
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> > Queue;
+  std::vector<vtkIdType> Neighbors[2];
+};
+
+//----------------------------------------------------------------------------
+QuadricDecimator::QuadricDecimator(TriangleMesh& mesh, bool boundaryDeletion)
+  : Mesh(mesh)
+  , BoundaryDeletion(boundaryDeletion)
+  , NumberOfTriangles(mesh.GetNumberOfTriangles())
+{
+  const vtkIdType numberOfPoints = mesh.GetNumberOfPoints();
+  this->PointTriangles.resize(numberOfPoints);
+  this->Quadrics.resize(QuadricSize * numberOfPoints, 0.);
+  this->Flags.resize(numberOfPoints, 0);
+  this->Versions.resize(numberOfPoints, 0);
+  this->RemovedTriangles.resize(this->NumberOfTriangles, 0);
+
+  const vtkIdType* triangles = this->NumberOfTriangles ? &mesh.Triangles[0] : 0;
+  for (vtkIdType t = 0; t < this->NumberOfTriangles; ++t)
+    {
+    const vtkIdType* ids = triangles + 3 * t;
+    double normal[3];
+    TriangleNormal(this->Position(ids[0]), this->Position(ids[1]),
+                   this->Position(ids[2]), normal);
+    const double doubleArea = vtkMath::Normalize(normal);
+    const double d = -vtkMath::Dot(normal, this->Position(ids[0]));
+    for (int i = 0; i < 3; ++i)
+      {
+      this->PointTriangles[ids[i]].push_back(t);
+      if (doubleArea > 0.)
+        {
+        AddPlaneQuadric(this->Quadric(ids[i]), normal, d, 0.5 * doubleArea);
+        }
+      }
+    }
+
+  // Classify the edges around each point by the number of triangles they
+  // belong to. Boundary edges get a plane quadric orthogonal to their
+  // triangle so that the decimation does not erode the boundary.
+  std::vector<std::pair<vtkIdType, vtkIdType> > edges;
+  for (vtkIdType p = 0; p < numberOfPoints; ++p)
+    {
+    edges.clear();
+    for (size_t i = 0; i < this->PointTriangles[p].size(); ++i)
+      {
+      const vtkIdType t = this->PointTriangles[p][i];
+      for (int j = 0; j < 3; ++j)
+        {
+        if (triangles[3 * t + j] != p)
+          {
+          edges.push_back(std::make_pair(triangles[3 * t + j], t));
+          }
+        }
+      }
+    std::sort(edges.begin(), edges.end());
+    for (size_t i = 0; i < edges.size();)
+      {
+      size_t j = i + 1;
+      while (j < edges.size() && edges[j].first == edges[i].first)
+        {
+        ++j;
+        }
+      if (j - i == 1)
+        {
+        this->Flags[p] |= Boundary;
+        const vtkIdType* ids = triangles + 3 * edges[i].second;
+        double faceNormal[3];
+        TriangleNormal(this->Position(ids[0]), this->Position(ids[1]),
+                       this->Position(ids[2]), faceNormal);
+        const double* p0 = this->Position(p);
+        const double* p1 = this->Position(edges[i].first);
+        const double edge[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        double normal[3];
+        vtkMath::Cross(edge, faceNormal, normal);
+        if (vtkMath::Normalize(normal) > 0.)
+          {
+          AddPlaneQuadric(this->Quadric(p), normal, -vtkMath::Dot(normal, p0),
+                          vtkMath::Dot(edge, edge));
+          }
+        }
+      else if (j - i > 2)
+        {
+        this->Flags[p] |= NonManifold;
+        }
+      i = j;
+      }
+    }
+
+  for (vtkIdType p = 0; p < numberOfPoints; ++p)
+    {
+    this->GetNeighbors(p, p, this->Neighbors[0]);
+    for (size_t i = 0; i < this->Neighbors[0].size(); ++i)
+      {
+      if (this->Neighbors[0][i] > p)
+        {
+        this->QueueCollapse(p, this->Neighbors[0][i]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::IsPinned(vtkIdType point) const
+{
+  return (this->Flags[point] & NonManifold) ||
+    (!this->BoundaryDeletion && (this->Flags[point] & Boundary));
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::GetNeighbors(vtkIdType point, vtkIdType excluded,
+                                    std::vector<vtkIdType>& neighbors) const
+{
+  neighbors.clear();
+  const std::vector<vtkIdType>& pointTriangles = this->PointTriangles[point];
+  for (size_t i = 0; i < pointTriangles.size(); ++i)
+    {
+    const vtkIdType* ids = &this->Mesh.Triangles[3 * pointTriangles[i]];
+    for (int j = 0; j < 3; ++j)
+      {
+      if (ids[j] != point && ids[j] != excluded)
+        {
+        neighbors.push_back(ids[j]);
+        }
+      }
+    }
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::ComputeCollapse(vtkIdType a, vtkIdType b,
+                                       vtkIdType& keep, vtkIdType& remove,
+                                       double position[3], double& cost)
+{
+  const bool pinnedA = this->IsPinned(a);
+  const bool pinnedB = this->IsPinned(b);
+  if (pinnedA && pinnedB)
+    {
+    return false;
+    }
+  double q[QuadricSize];
+  for (int i = 0; i < QuadricSize; ++i)
+    {
+    q[i] = this->Quadric(a)[i] + this->Quadric(b)[i];
+    }
+  keep = pinnedB ? b : a;
+  remove = pinnedB ? a : b;
+  const double* pa = this->Position(a);
+  const double* pb = this->Position(b);
+  if (pinnedA || pinnedB)
+    {
+    const double* pk = this->Position(keep);
+    position[0] = pk[0];
+    position[1] = pk[1];
+    position[2] = pk[2];
+    cost = EvaluateQuadric(q, position);
+    return true;
+    }
+  const double middle[3] = {0.5 * (pa[0] + pb[0]), 0.5 * (pa[1] + pb[1]),
+                            0.5 * (pa[2] + pb[2])};
+  // Reject the optimal positions far from the edge: they come from nearly
+  // singular quadrics
+  if (MinimizeQuadric(q, position) &&
+      vtkMath::Distance2BetweenPoints(position, middle) <=
+      4. * vtkMath::Distance2BetweenPoints(pa, pb))
+    {
+    cost = EvaluateQuadric(q, position);
+    return true;
+    }
+  const double* candidates[3] = {pa, pb, middle};
+  cost = VTK_DOUBLE_MAX;
+  for (int i = 0; i < 3; ++i)
+    {
+    const double error = EvaluateQuadric(q, candidates[i]);
+    if (error < cost)
+      {
+      cost = error;
+      position[0] = candidates[i][0];
+      position[1] = candidates[i][1];
+      position[2] = candidates[i][2];
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::QueueCollapse(vtkIdType a, vtkIdType b)
+{
+  vtkIdType keep;
+  vtkIdType remove;
+  double position[3];
+  Collapse collapse;
+  if (!this->ComputeCollapse(a, b, keep, remove, position, collapse.Cost))
+    {
+    return;
+    }
+  collapse.Points[0] = a;
+  collapse.Points[1] = b;
+  collapse.Versions[0] = this->Versions[a];
+  collapse.Versions[1] = this->Versions[b];
+  this->Queue.push(collapse);
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::IsCollapseValid(vtkIdType keep, vtkIdType remove,
+                                       const double position[3])
+{
+  // Link condition: the only common neighbors of the two points are the
+  // opposite points of the triangles of the edge.
+  int sharedTriangles = 0;
+  const std::vector<vtkIdType>& removeTriangles = this->PointTriangles[remove];
+  for (size_t i = 0; i < removeTriangles.size(); ++i)
+    {
+    const vtkIdType* ids = &this->Mesh.Triangles[3 * removeTriangles[i]];
+    if (ids[0] == keep || ids[1] == keep || ids[2] == keep)
+      {
+      ++sharedTriangles;
+      }
+    }
+  if (sharedTriangles == 0 || sharedTriangles > 2)
+    {
+    return false;
+    }
+  // An inner edge between two boundary points would pinch the surface
+  if (sharedTriangles == 2 &&
+      (this->Flags[keep] & Boundary) && (this->Flags[remove] & Boundary))
+    {
+    return false;
+    }
+  this->GetNeighbors(keep, remove, this->Neighbors[0]);
+  this->GetNeighbors(remove, keep, this->Neighbors[1]);
+  std::vector<vtkIdType>::const_iterator it0 = this->Neighbors[0].begin();
+  std::vector<vtkIdType>::const_iterator it1 = this->Neighbors[1].begin();
+  int commonNeighbors = 0;
+  while (it0 != this->Neighbors[0].end() && it1 != this->Neighbors[1].end())
+    {
+    if (*it0 < *it1)
+      {
+      ++it0;
+      }
+    else if (*it1 < *it0)
+      {
+      ++it1;
+      }
+    else
+      {
+      ++commonNeighbors;
+      ++it0;
+      ++it1;
+      }
+    }
+  if (commonNeighbors != sharedTriangles)
+    {
+    return false;
+    }
+  // Don't collapse a tetrahedron into a double sided triangle
+  if (this->Neighbors[0].size() + this->Neighbors[1].size() - commonNeighbors < 3)
+    {
+    return false;
+    }
+
+  // The triangles that are not removed must not flip nor degenerate
+  for (int side = 0; side < 2; ++side)
+    {
+    const vtkIdType moved = side == 0 ? keep : remove;
+    const vtkIdType other = side == 0 ? remove : keep;
+    const std::vector<vtkIdType>& pointTriangles = this->PointTriangles[moved];
+    for (size_t i = 0; i < pointTriangles.size(); ++i)
+      {
+      const vtkIdType* ids = &this->Mesh.Triangles[3 * pointTriangles[i]];
+      if (ids[0] == other || ids[1] == other || ids[2] == other)
+        {
+        continue;
+        }
+      const double* p[3];
+      const double* q[3];
+      for (int j = 0; j < 3; ++j)
+        {
+        p[j] = this->Position(ids[j]);
+        q[j] = ids[j] == moved ? position : p[j];
+        }
+      double before[3];
+      double after[3];
+      TriangleNormal(p[0], p[1], p[2], before);
+      TriangleNormal(q[0], q[1], q[2], after);
+      const double beforeNorm = vtkMath::Norm(before);
+      const double afterNorm = vtkMath::Norm(after);
+      if (afterNorm <= 1e-6 * beforeNorm ||
+          vtkMath::Dot(before, after) <= 0.2 * beforeNorm * afterNorm)
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::RemoveTriangleFromPoint(vtkIdType triangle, vtkIdType point)
+{
+  std::vector<vtkIdType>& pointTriangles = this->PointTriangles[point];
+  std::vector<vtkIdType>::iterator it =
+    std::find(pointTriangles.begin(), pointTriangles.end(), triangle);
+  if (it != pointTriangles.end())
+    {
+    *it = pointTriangles.back();
+    pointTriangles.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::ApplyCollapse(vtkIdType keep, vtkIdType remove,
+                                     const double position[3])
+{
+  std::vector<vtkIdType> removeTriangles;
+  removeTriangles.swap(this->PointTriangles[remove]);
+  for (size_t i = 0; i < removeTriangles.size(); ++i)
+    {
+    const vtkIdType t = removeTriangles[i];
+    vtkIdType* ids = &this->Mesh.Triangles[3 * t];
+    if (ids[0] == keep || ids[1] == keep || ids[2] == keep)
+      {
+      this->RemovedTriangles[t] = 1;
+      --this->NumberOfTriangles;
+      for (int j = 0; j < 3; ++j)
+        {
+        if (ids[j] != remove)
+          {
+          this->RemoveTriangleFromPoint(t, ids[j]);
+          }
+        }
+      continue;
+      }
+    for (int j = 0; j < 3; ++j)
+      {
+      if (ids[j] == remove)
+        {
+        ids[j] = keep;
+        }
+      }
+    this->PointTriangles[keep].push_back(t);
+    }
+
+  double* p = this->Position(keep);
+  p[0] = position[0];
+  p[1] = position[1];
+  p[2] = position[2];
+  for (int i = 0; i < QuadricSize; ++i)
+    {
+    this->Quadric(keep)[i] += this->Quadric(remove)[i];
+    }
+  this->Flags[keep] |= this->Flags[remove] & Boundary;
+  this->Flags[remove] |= Removed;
+  ++this->Versions[keep];
+
+  std::vector<vtkIdType> neighbors;
+  this->GetNeighbors(keep, keep, neighbors);
+  for (size_t i = 0; i < neighbors.size(); ++i)
+    {
+    this->QueueCollapse(keep, neighbors[i]);
+    }
+}
+
+//----------------------------------------------------------------------------
+bool QuadricDecimator::Decimate(vtkIdType numberOfTriangles, vtkAlgorithm* algorithm)
+{
+  const vtkIdType initialNumberOfTriangles = this->NumberOfTriangles;
+  const vtkIdType trianglesToRemove = initialNumberOfTriangles - numberOfTriangles;
+  vtkIdType collapses = 0;
+  while (this->NumberOfTriangles > numberOfTriangles && !this->Queue.empty())
+    {
+    const Collapse collapse = this->Queue.top();
+    this->Queue.pop();
+    const vtkIdType a = collapse.Points[0];
+    const vtkIdType b = collapse.Points[1];
+    // Outdated entry: one of the points moved or was removed since
+    if ((this->Flags[a] & Removed) || (this->Flags[b] & Removed) ||
+        this->Versions[a] != collapse.Versions[0] ||
+        this->Versions[b] != collapse.Versions[1])
+      {
+      continue;
+      }
+    vtkIdType keep;
+    vtkIdType remove;
+    double position[3];
+    double cost;
+    if (!this->ComputeCollapse(a, b, keep, remove, position, cost) ||
+        !this->IsCollapseValid(keep, remove, position))
+      {
+      continue;
+      }
+    this->ApplyCollapse(keep, remove, position);
+    if ((++collapses % 10000) == 0)
+      {
+      algorithm->UpdateProgress(0.6 *
+        (initialNumberOfTriangles - this->NumberOfTriangles) / trianglesToRemove);
+      if (algorithm->GetAbortExecute())
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void QuadricDecimator::Compact(std::vector<vtkIdType>& pointMap)
+{
+  const vtkIdType numberOfPoints = this->Mesh.GetNumberOfPoints();
+  const vtkIdType numberOfTriangles = this->Mesh.GetNumberOfTriangles();
+  pointMap.assign(numberOfPoints, -1);
+  std::vector<vtkIdType> triangles;
+  triangles.reserve(3 * this->NumberOfTriangles);
+  vtkIdType newNumberOfPoints = 0;
+  for (vtkIdType t = 0; t < numberOfTriangles; ++t)
+    {
+    if (this->RemovedTriangles[t])
+      {
+      continue;
+      }
+    for (int j = 0; j < 3; ++j)
+      {
+      const vtkIdType id = this->Mesh.Triangles[3 * t + j];
+      if (pointMap[id] < 0)
+        {
+        pointMap[id] = newNumberOfPoints++;
+        }
+      triangles.push_back(pointMap[id]);
+      }
+    }
+  std::vector<double> points(3 * newNumberOfPoints);
+  for (vtkIdType p = 0; p < numberOfPoints; ++p)
+    {
+    if (pointMap[p] >= 0)
+      {
+      std::copy(&this->Mesh.Points[3 * p], &this->Mesh.Points[3 * p] + 3,
+                &points[3 * pointMap[p]]);
+      }
+    }
+  this->Mesh.Points.swap(points);
+  this->Mesh.Triangles.swap(triangles);
+}
+
+//----------------------------------------------------------------------------
+/// Triangles of each point and neighbors of each point, in compressed
+/// sparse row arrays
+struct MeshAdjacency
+{
+  std::vector<vtkIdType> TriangleOffsets;
+  std::vector<vtkIdType> PointTriangles;
+  /// The neighbors of point p start at 2 * TriangleOffsets[p]
+  std::vector<vtkIdType> Neighbors;
+  std::vector<vtkIdType> NumberOfNeighbors;
+  /// Point on a boundary or non-manifold edge
+  std::vector<unsigned char> Boundary;
+};
+
+//----------------------------------------------------------------------------
+void BuildPointTriangles(const TriangleMesh& mesh, MeshAdjacency& adjacency)
+{
+  const vtkIdType numberOfPoints = mesh.GetNumberOfPoints();
+  const vtkIdType numberOfTriangles = mesh.GetNumberOfTriangles();
+  adjacency.TriangleOffsets.assign(numberOfPoints + 1, 0);
+  for (vtkIdType i = 0; i < 3 * numberOfTriangles; ++i)
+    {
+    ++adjacency.TriangleOffsets[mesh.Triangles[i] + 1];
+    }
+  for (vtkIdType p = 0; p < numberOfPoints; ++p)
+    {
+    adjacency.TriangleOffsets[p + 1] += adjacency.TriangleOffsets[p];
+    }
+  adjacency.PointTriangles.resize(3 * numberOfTriangles);
+  std::vector<vtkIdType> fill(adjacency.TriangleOffsets.begin(),
+                              adjacency.TriangleOffsets.end() - 1);
+  for (vtkIdType i = 0; i < 3 * numberOfTriangles; ++i)
+    {
+    adjacency.PointTriangles[fill[mesh.Triangles[i]]++] = i / 3;
+    }
+}
+
+//----------------------------------------------------------------------------
+class NeighborsFunctor : public RangeFunctor
+{
+public:
+  NeighborsFunctor(const TriangleMesh& mesh, MeshAdjacency& adjacency)
+    : Mesh(mesh), Adjacency(adjacency) {}
+  virtual void Execute(vtkIdType begin, vtkIdType end)
+    {
+    const vtkIdType* offsets = &this->Adjacency.TriangleOffsets[0];
+    for (vtkIdType p = begin; p < end; ++p)
+      {
+      vtkIdType* neighbors = this->Adjacency.Neighbors.empty() ? 0 :
+        &this->Adjacency.Neighbors[2 * offsets[p]];
+      vtkIdType count = 0;
+      for (vtkIdType i = offsets[p]; i < offsets[p + 1]; ++i)
+        {
+        const vtkIdType* ids = &this->Mesh.Triangles[3 * this->Adjacency.PointTriangles[i]];
+        for (int j = 0; j < 3; ++j)
+          {
+          if (ids[j] != p)
+            {
+            neighbors[count++] = ids[j];
+            }
+          }
+        }
+      std::sort(neighbors, neighbors + count);
+      // Each inner edge is listed by its 2 triangles
+      vtkIdType unique = 0;
+      unsigned char boundary = 0;
+      for (vtkIdType i = 0; i < count;)
+        {
+        vtkIdType j = i + 1;
+        while (j < count && neighbors[j] == neighbors[i])
+          {
+          ++j;
+          }
+        boundary |= (j - i != 2);
+        neighbors[unique++] = neighbors[i];
+        i = j;
+        }
+      this->Adjacency.NumberOfNeighbors[p] = unique;
+      this->Adjacency.Boundary[p] = boundary;
+      }
+    }
+  const TriangleMesh& Mesh;
+  MeshAdjacency& Adjacency;
+};
+
+//----------------------------------------------------------------------------
+/// One smoothing pass: move each point toward the centroid of its neighbors
+class SmoothFunctor : public RangeFunctor
+{
+public:
+  SmoothFunctor(const MeshAdjacency& adjacency, bool boundarySmoothing)
+    : Adjacency(adjacency), BoundarySmoothing(boundarySmoothing),
+      Input(0), Output(0), Factor(0.) {}
+  virtual void Execute(vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType p = begin; p < end; ++p)
+      {
+      const double* in = this->Input + 3 * p;
+      double* out = this->Output + 3 * p;
+      const vtkIdType count = this->Adjacency.NumberOfNeighbors[p];
+      if (count == 0 || (this->Adjacency.Boundary[p] && !this->BoundarySmoothing))
+        {
+        out[0] = in[0];
+        out[1] = in[1];
+        out[2] = in[2];
+        continue;
+        }
+      const vtkIdType* neighbors =
+        &this->Adjacency.Neighbors[2 * this->Adjacency.TriangleOffsets[p]];
+      double centroid[3] = {0., 0., 0.};
+      for (vtkIdType i = 0; i < count; ++i)
+        {
+        const double* neighbor = this->Input + 3 * neighbors[i];
+        centroid[0] += neighbor[0];
+        centroid[1] += neighbor[1];
+        centroid[2] += neighbor[2];
+        }
+      out[0] = in[0] + this->Factor * (centroid[0] / count - in[0]);
+      out[1] = in[1] + this->Factor * (centroid[1] / count - in[1]);
+      out[2] = in[2] + this->Factor * (centroid[2] / count - in[2]);
+      }
+    }
+  const MeshAdjacency& Adjacency;
+  bool BoundarySmoothing;
+  const double* Input;
+  double* Output;
+  double Factor;
+};
+
+//----------------------------------------------------------------------------
+class PointNormalsFunctor : public RangeFunctor
+{
+public:
+  PointNormalsFunctor(const TriangleMesh& mesh, const MeshAdjacency& adjacency,
+                      float* normals)
+    : Mesh(mesh), Adjacency(adjacency), Normals(normals) {}
+  virtual void Execute(vtkIdType begin, vtkIdType end)
+    {
+    const vtkIdType* offsets = &this->Adjacency.TriangleOffsets[0];
+    for (vtkIdType p = begin; p < end; ++p)
+      {
+      // Unnormalized triangle normals are weighted by the triangle areas
+      double normal[3] = {0., 0., 0.};
+      for (vtkIdType i = offsets[p]; i < offsets[p + 1]; ++i)
+        {
+        const vtkIdType* ids = &this->Mesh.Triangles[3 * this->Adjacency.PointTriangles[i]];
+        double triangleNormal[3];
+        TriangleNormal(&this->Mesh.Points[3 * ids[0]], &this->Mesh.Points[3 * ids[1]],
+                       &this->Mesh.Points[3 * ids[2]], triangleNormal);
+        normal[0] += triangleNormal[0];
+        normal[1] += triangleNormal[1];
+        normal[2] += triangleNormal[2];
+        }
+      if (vtkMath::Normalize(normal) == 0.)
+        {
+        normal[2] = 1.;
+        }
+      float* out = this->Normals + 3 * p;
+      out[0] = static_cast<float>(normal[0]);
+      out[1] = static_cast<float>(normal[1]);
+      out[2] = static_cast<float>(normal[2]);
+      }
+    }
+  const TriangleMesh& Mesh;
+  const MeshAdjacency& Adjacency;
+  float* Normals;
+};
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkSlicerMeshProcessingFilter::vtkSlicerMeshProcessingFilter()
+{
+  this->Decimation = 0;
+  this->TargetReduction = 0.9;
+  this->BoundaryDeletion = 1;
+  this->Smoothing = 0;
+  this->SmoothingMethod = Laplace;
+  this->NumberOfIterations = 20;
+  this->RelaxationFactor = 0.5;
+  this->PassBand = 0.1;
+  this->BoundarySmoothing = 1;
+  this->ComputeNormals = 0;
+  this->AutoOrientNormals = 0;
+  this->FlipNormals = 0;
+  this->NumberOfThreads = 0;
+  this->Threader = vtkMultiThreader::New();
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerMeshProcessingFilter::~vtkSlicerMeshProcessingFilter()
+{
+  this->Threader->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerMeshProcessingFilter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Decimation: " << this->Decimation << "\n";
+  os << indent << "TargetReduction: " << this->TargetReduction << "\n";
+  os << indent << "BoundaryDeletion: " << this->BoundaryDeletion << "\n";
+  os << indent << "Smoothing: " << this->Smoothing << "\n";
+  os << indent << "SmoothingMethod: "
+     << (this->SmoothingMethod == Taubin ? "Taubin" : "Laplace") << "\n";
+  os << indent << "NumberOfIterations: " << this->NumberOfIterations << "\n";
+  os << indent << "RelaxationFactor: " << this->RelaxationFactor << "\n";
+  os << indent << "PassBand: " << this->PassBand << "\n";
+  os << indent << "BoundarySmoothing: " << this->BoundarySmoothing << "\n";
+  os << indent << "ComputeNormals: " << this->ComputeNormals << "\n";
+  os << indent << "AutoOrientNormals: " << this->AutoOrientNormals << "\n";
+  os << indent << "FlipNormals: " << this->FlipNormals << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerMeshProcessingFilter::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkPolyData *input = vtkPolyData::SafeDownCast(
+    inputVector[0]->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
+  vtkPolyData *output = vtkPolyData::SafeDownCast(
+    outputVector->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
+
+  vtkPoints* inputPoints = input->GetPoints();
+  if (!inputPoints || input->GetNumberOfPoints() == 0)
+    {
+    return 1;
+    }
+  this->Threader->SetNumberOfThreads(this->NumberOfThreads > 0 ?
+    this->NumberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+
+  // Triangulate the input
+  TriangleMesh mesh;
+  const vtkIdType numberOfInputPoints = input->GetNumberOfPoints();
+  mesh.Points.resize(3 * numberOfInputPoints);
+  for (vtkIdType p = 0; p < numberOfInputPoints; ++p)
+    {
+    inputPoints->GetPoint(p, &mesh.Points[3 * p]);
+    }
+  vtkIdType npts = 0;
+  vtkIdType* pts = 0;
+  vtkCellArray* polys = input->GetPolys();
+  mesh.Triangles.reserve(3 * polys->GetNumberOfCells());
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+    {
+    for (vtkIdType i = 1; i + 1 < npts; ++i)
+      {
+      AddTriangle(mesh, pts[0], pts[i], pts[i + 1]);
+      }
+    }
+  vtkCellArray* strips = input->GetStrips();
+  for (strips->InitTraversal(); strips->GetNextCell(npts, pts);)
+    {
+    for (vtkIdType i = 0; i + 2 < npts; ++i)
+      {
+      if (i % 2)
+        {
+        AddTriangle(mesh, pts[i + 1], pts[i], pts[i + 2]);
+        }
+      else
+        {
+        AddTriangle(mesh, pts[i], pts[i + 1], pts[i + 2]);
+        }
+      }
+    }
+
+  // Decimate
+  std::vector<vtkIdType> pointMap;
+  if (this->Decimation && mesh.GetNumberOfTriangles() > 0)
+    {
+    QuadricDecimator decimator(mesh, this->BoundaryDeletion != 0);
+    const vtkIdType numberOfTriangles = static_cast<vtkIdType>(
+      (1. - this->TargetReduction) * mesh.GetNumberOfTriangles());
+    if (!decimator.Decimate(numberOfTriangles, this))
+      {
+      return 1;
+      }
+    decimator.Compact(pointMap);
+    }
+  this->UpdateProgress(0.6);
+
+  const vtkIdType numberOfPoints = mesh.GetNumberOfPoints();
+  const vtkIdType numberOfTriangles = mesh.GetNumberOfTriangles();
+
+  // Orient
+  bool reverse = this->FlipNormals != 0;
+  if (this->AutoOrientNormals)
+    {
+    double volume = 0.;
+    for (vtkIdType t = 0; t < numberOfTriangles; ++t)
+      {
+      const vtkIdType* ids = &mesh.Triangles[3 * t];
+      double cross[3];
+      vtkMath::Cross(&mesh.Points[3 * ids[1]], &mesh.Points[3 * ids[2]], cross);
+      volume += vtkMath::Dot(&mesh.Points[3 * ids[0]], cross);
+      }
+    if (volume < 0.)
+      {
+      reverse = !reverse;
+      }
+    }
+  if (reverse)
+    {
+    for (vtkIdType t = 0; t < numberOfTriangles; ++t)
+      {
+      std::swap(mesh.Triangles[3 * t + 1], mesh.Triangles[3 * t + 2]);
+      }
+    }
+
+  MeshAdjacency adjacency;
+  if ((this->Smoothing && this->NumberOfIterations > 0) || this->ComputeNormals)
+    {
+    BuildPointTriangles(mesh, adjacency);
+    }
+
+  // Smooth
+  if (this->Smoothing && this->NumberOfIterations > 0)
+    {
+    adjacency.Neighbors.resize(2 * adjacency.PointTriangles.size());
+    adjacency.NumberOfNeighbors.resize(numberOfPoints);
+    adjacency.Boundary.resize(numberOfPoints);
+    NeighborsFunctor neighbors(mesh, adjacency);
+    ParallelFor(this->Threader, numberOfPoints, neighbors);
+
+    std::vector<double> buffer(mesh.Points.size());
+    SmoothFunctor smooth(adjacency, this->BoundarySmoothing != 0);
+    // Taubin: the pass band kpb satisfies 1/lambda + 1/mu = kpb
+    const double lambda = 0.5;
+    const double mu = 1. / (this->PassBand - 1. / lambda);
+    const int passes = this->SmoothingMethod == Taubin ?
+      2 * this->NumberOfIterations : this->NumberOfIterations;
+    for (int pass = 0; pass < passes; ++pass)
+      {
+      smooth.Input = &mesh.Points[0];
+      smooth.Output = &buffer[0];
+      if (this->SmoothingMethod == Taubin)
+        {
+        smooth.Factor = (pass % 2) ? mu : lambda;
+        }
+      else
+        {
+        smooth.Factor = this->RelaxationFactor;
+        }
+      ParallelFor(this->Threader, numberOfPoints, smooth);
+      mesh.Points.swap(buffer);
+      this->UpdateProgress(0.6 + 0.3 * (pass + 1) / passes);
+      if (this->GetAbortExecute())
+        {
+        return 1;
+        }
+      }
+    }
+
+  // Build the output
+  vtkPoints* outputPoints = vtkPoints::New(inputPoints->GetDataType());
+  outputPoints->SetNumberOfPoints(numberOfPoints);
+  for (vtkIdType p = 0; p < numberOfPoints; ++p)
+    {
+    outputPoints->SetPoint(p, &mesh.Points[3 * p]);
+    }
+  output->SetPoints(outputPoints);
+  outputPoints->Delete();
+
+  vtkIdTypeArray* cells = vtkIdTypeArray::New();
+  cells->SetNumberOfValues(4 * numberOfTriangles);
+  vtkIdType* cell = cells->GetPointer(0);
+  for (vtkIdType t = 0; t < numberOfTriangles; ++t, cell += 4)
+    {
+    cell[0] = 3;
+    cell[1] = mesh.Triangles[3 * t];
+    cell[2] = mesh.Triangles[3 * t + 1];
+    cell[3] = mesh.Triangles[3 * t + 2];
+    }
+  vtkCellArray* outputPolys = vtkCellArray::New();
+  outputPolys->SetCells(numberOfTriangles, cells);
+  output->SetPolys(outputPolys);
+  outputPolys->Delete();
+  cells->Delete();
+
+  vtkPointData* inputPD = input->GetPointData();
+  vtkPointData* outputPD = output->GetPointData();
+  if (this->ComputeNormals)
+    {
+    outputPD->CopyNormalsOff();
+    }
+  if (pointMap.empty())
+    {
+    outputPD->PassData(inputPD);
+    }
+  else
+    {
+    outputPD->CopyAllocate(inputPD, numberOfPoints);
+    for (vtkIdType p = 0; p < numberOfInputPoints; ++p)
+      {
+      if (pointMap[p] >= 0)
+        {
+        outputPD->CopyData(inputPD, p, pointMap[p]);
+        }
+      }
+    }
+
+  // Normals
+  if (this->ComputeNormals)
+    {
+    vtkFloatArray* normals = vtkFloatArray::New();
+    normals->SetName("Normals");
+    normals->SetNumberOfComponents(3);
+    normals->SetNumberOfTuples(numberOfPoints);
+    PointNormalsFunctor pointNormals(mesh, adjacency, normals->GetPointer(0));
+    ParallelFor(this->Threader, numberOfPoints, pointNormals);
+    outputPD->SetNormals(normals);
+    normals->Delete();
+    }
+  this->UpdateProgress(1.0);
+
+  return 1;
+}
@@ -0,0 +1,153 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkSlicerMeshProcessingFilter_h
+#define __vtkSlicerMeshProcessingFilter_h
+
+// SlicerBaseLogic includes
+#include "vtkSlicerBaseLogic.h"
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+class vtkMultiThreader;
+
+/// \brief Decimate, smooth and compute the normals of a surface in one pass.
+///
+/// The polygons and triangle strips of the input are triangulated once into
+/// flat point and triangle arrays, and all the enabled steps work on these
+/// arrays before the output is built. Vertices and lines are ignored.
+///
+/// - Decimation collapses the edges of least quadric error (Garland and
+/// Heckbert) until TargetReduction of the triangles are removed. Collapses
+/// that would change the topology of the surface or flip a triangle are
+/// rejected. Boundary vertices are kept in place unless BoundaryDeletion is
+/// set, and vertices on non-manifold edges are never removed.
+/// - Smoothing iterates over a compact (CSR) vertex adjacency, each pass
+/// being split among threads. Laplace moves the vertices toward the
+/// centroid of their neighbors by RelaxationFactor. Taubin alternates a
+/// shrinking step of 0.5 and an inflating step derived from PassBand, which
+/// does not shrink the surface. Boundary and non-manifold vertices are
+/// fixed unless BoundarySmoothing is set.
+/// - Normals are the area weighted average of the triangle normals, computed
+/// in parallel from the same arrays. They are not split at sharp edges:
+/// use vtkPolyDataNormals for that.
+///
+/// The point data of the kept points is passed to the output; the cell data
+/// is not.
+class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerMeshProcessingFilter
+  : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkSlicerMeshProcessingFilter *New();
+  vtkTypeRevisionMacro(vtkSlicerMeshProcessingFilter, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Enable the decimation. Off by default.
+  vtkSetMacro(Decimation, int);
+  vtkGetMacro(Decimation, int);
+  vtkBooleanMacro(Decimation, int);
+
+  /// Fraction of the triangles to remove. 0.9 by default.
+  vtkSetClampMacro(TargetReduction, double, 0.0, 1.0);
+  vtkGetMacro(TargetReduction, double);
+
+  /// Allow the decimation to remove boundary vertices. On by default.
+  vtkSetMacro(BoundaryDeletion, int);
+  vtkGetMacro(BoundaryDeletion, int);
+  vtkBooleanMacro(BoundaryDeletion, int);
+
+  enum SmoothingMethods
+  {
+    Laplace = 0,
+    Taubin
+  };
+
+  /// Enable the smoothing. Off by default.
+  vtkSetMacro(Smoothing, int);
+  vtkGetMacro(Smoothing, int);
+  vtkBooleanMacro(Smoothing, int);
+
+  /// Laplace (default) or Taubin smoothing.
+  vtkSetClampMacro(SmoothingMethod, int, Laplace, Taubin);
+  vtkGetMacro(SmoothingMethod, int);
+  void SetSmoothingMethodToLaplace() {this->SetSmoothingMethod(Laplace);}
+  void SetSmoothingMethodToTaubin() {this->SetSmoothingMethod(Taubin);}
+
+  /// Number of smoothing passes. A Taubin iteration is made of a shrinking
+  /// and an inflating pass. 20 by default.
+  vtkSetClampMacro(NumberOfIterations, int, 0, VTK_INT_MAX);
+  vtkGetMacro(NumberOfIterations, int);
+
+  /// Displacement of a vertex toward the centroid of its neighbors for each
+  /// Laplace iteration. 0.5 by default.
+  vtkSetClampMacro(RelaxationFactor, double, 0.0, 1.0);
+  vtkGetMacro(RelaxationFactor, double);
+
+  /// Pass band of the Taubin smoothing, the lower the smoother.
+  /// 0.1 by default.
+  vtkSetClampMacro(PassBand, double, 0.001, 1.0);
+  vtkGetMacro(PassBand, double);
+
+  /// Smooth the boundary and non-manifold vertices. On by default.
+  vtkSetMacro(BoundarySmoothing, int);
+  vtkGetMacro(BoundarySmoothing, int);
+  vtkBooleanMacro(BoundarySmoothing, int);
+
+  /// Generate point normals. Off by default.
+  vtkSetMacro(ComputeNormals, int);
+  vtkGetMacro(ComputeNormals, int);
+  vtkBooleanMacro(ComputeNormals, int);
+
+  /// Reverse the triangles of a surface enclosing a negative volume so
+  /// that its normals point outward. Off by default.
+  vtkSetMacro(AutoOrientNormals, int);
+  vtkGetMacro(AutoOrientNormals, int);
+  vtkBooleanMacro(AutoOrientNormals, int);
+
+  /// Reverse the orientation of the triangles and normals. Off by default.
+  vtkSetMacro(FlipNormals, int);
+  vtkGetMacro(FlipNormals, int);
+  vtkBooleanMacro(FlipNormals, int);
+
+  /// Number of threads of the smoothing and the normals computation.
+  /// The default of vtkMultiThreader if 0 (default).
+  vtkSetClampMacro(NumberOfThreads, int, 0, VTK_INT_MAX);
+  vtkGetMacro(NumberOfThreads, int);
+
+protected:
+  vtkSlicerMeshProcessingFilter();
+  virtual ~vtkSlicerMeshProcessingFilter();
+
+  virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
+
+  int Decimation;
+  double TargetReduction;
+  int BoundaryDeletion;
+  int Smoothing;
+  int SmoothingMethod;
+  int NumberOfIterations;
+  double RelaxationFactor;
+  double PassBand;
+  int BoundarySmoothing;
+  int ComputeNormals;
+  int AutoOrientNormals;
+  int FlipNormals;
+  int NumberOfThreads;
+
+  vtkMultiThreader* Threader;
+
+private:
+  vtkSlicerMeshProcessingFilter(const vtkSlicerMeshProcessingFilter&); // Not implemented
+  void operator=(const vtkSlicerMeshProcessingFilter&); // Not implemented
+};
+
+#endif
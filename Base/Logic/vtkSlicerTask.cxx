@@ -12,7 +12,12 @@ vtkSlicerTask::vtkSlicerTask()
 {
   this->TaskObject = 0;
   this->TaskFunction = 0;
+  this->TaskCancelFunction = 0;
+  this->TaskClientData = 0;
   this->Type = vtkSlicerTask::Undefined;
+  this->Priority = 0;
+  this->CancelRequested = 0;
+  this->Status = vtkSlicerTask::Idle;
 }
 //----------------------------------------------------------------------------
 vtkSlicerTask::~vtkSlicerTask()
@@ -29,6 +34,12 @@ void vtkSlicerTask::SetTaskFunction(vtkMRMLAbstractLogic *object,
   this->TaskClientData = clientdata;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerTask::SetCancelFunction(vtkMRMLAbstractLogic::TaskFunctionPointer function)
+{
+  this->TaskCancelFunction = function;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerTask::Execute()
 {
@@ -38,8 +49,61 @@ void vtkSlicerTask::Execute()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerTask::AddDependency(vtkSlicerTask* task)
+{
+  if (!task || task == this)
+    {
+    return;
+    }
+  this->Dependencies.push_back(task);
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerTask::GetNumberOfDependencies()
+{
+  return static_cast<int>(this->Dependencies.size());
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerTask* vtkSlicerTask::GetDependency(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfDependencies())
+    {
+    return 0;
+    }
+  return this->Dependencies[index];
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerTask::Cancel()
+{
+  // Don't call Modified(), it can be called from the processing threads
+  if (this->CancelRequested)
+    {
+    return;
+    }
+  this->CancelRequested = 1;
+  if (this->TaskObject && this->TaskCancelFunction)
+    {
+    ((*this->TaskObject).*(this->TaskCancelFunction))(this->TaskClientData);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerTask::SetStatus(int status)
+{
+  // Don't call Modified(), it is called from the processing threads
+  this->Status = status;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerTask::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "Type: " << this->GetTypeAsString() << "\n";
+  os << indent << "Priority: " << this->Priority << "\n";
+  os << indent << "NumberOfDependencies: " << this->Dependencies.size() << "\n";
+  os << indent << "CancelRequested: " << this->CancelRequested << "\n";
+  os << indent << "Status: " << this->Status << "\n";
 }
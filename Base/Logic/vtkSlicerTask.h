@@ -6,6 +6,8 @@
 #include "vtkMRMLAbstractLogic.h"
 #include "vtkSlicerBaseLogic.h"
 
+#include <vector>
+
 class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerTask : public vtkObject
 {
 public:
@@ -48,6 +50,50 @@ public:
     return "Unknown";
   }
 
+  /// 
+  /// Scheduled tasks with a higher priority are run first, tasks with the
+  /// same priority are run in the order they were scheduled. 0 by default.
+  vtkSetMacro (Priority, int);
+  vtkGetMacro (Priority, int);
+
+  /// 
+  /// The task is not run before the tasks it depends on are completed.
+  /// They must be scheduled too. If one of them is cancelled, the task is
+  /// cancelled as well.
+  void AddDependency(vtkSlicerTask* task);
+  int GetNumberOfDependencies();
+  vtkSlicerTask* GetDependency(int index);
+
+  /// 
+  /// Request the cancellation of the task. A scheduled task that has not
+  /// started is not run, a running task can poll GetCancelRequested() to
+  /// stop early. It can be called from any thread.
+  void Cancel();
+  vtkGetMacro (CancelRequested, int);
+
+  /// 
+  /// Set the function of the task object called by Cancel() with the client
+  /// data of the task, e.g. to stop a running CLI. A task with a cancel
+  /// function is run even when it is cancelled before it starts, so that
+  /// it can release its client data: it must return right away.
+  /// The function can be called from any thread, possibly while the task
+  /// queue is locked, and must not schedule tasks.
+  void SetCancelFunction(TaskFunctionPointer);
+  bool HasCancelFunction() { return this->TaskCancelFunction != 0; }
+
+  /// 
+  /// Status of the task, set by the application logic that runs it
+  enum
+    {
+    Idle = 0,
+    Scheduled,
+    Running,
+    Completed,
+    Cancelled
+    };
+  void SetStatus(int status);
+  vtkGetMacro (Status, int);
+
 protected:
   vtkSlicerTask();
   virtual ~vtkSlicerTask();
@@ -57,10 +103,15 @@ protected:
 private:
   vtkSmartPointer<vtkMRMLAbstractLogic> TaskObject;
   vtkMRMLAbstractLogic::TaskFunctionPointer TaskFunction;
+  vtkMRMLAbstractLogic::TaskFunctionPointer TaskCancelFunction;
   void *TaskClientData;
   
   int Type;
-  
+  int Priority;
+  int CancelRequested;
+  int Status;
+  std::vector<vtkSmartPointer<vtkSlicerTask> > Dependencies;
+
 };
 #endif
 
@@ -0,0 +1,191 @@
+/*=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================*/
+
+// SlicerBaseCLI includes
+#include <PluginProgressProtocol.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+bool Parse(PluginProgressProtocol::Parser& parser, const std::string& chunk,
+           std::string& text)
+{
+  return parser.Parse(chunk.c_str(), static_cast<int>(chunk.size()), text);
+}
+
+//-----------------------------------------------------------------------------
+bool TestFramesSplitAcrossChunks()
+{
+  std::ostringstream output;
+  PluginProgressProtocol::WriteFrame(output, PluginProgressProtocol::Progress, 0.25);
+  PluginProgressProtocol::WriteFrame(output, PluginProgressProtocol::FilterName, "Reader");
+  const std::string frames = output.str();
+
+  // Every split position of the frames, including the separators
+  for (std::string::size_type split = 0; split <= frames.size(); ++split)
+    {
+    PluginProgressProtocol::Parser parser;
+    std::string text;
+    bool modified = Parse(parser, frames.substr(0, split), text);
+    modified = Parse(parser, frames.substr(split), text) || modified;
+    if (!modified || !text.empty() || parser.NumberOfFrames != 2 ||
+        parser.Progress != 0.25 || parser.Message != "Reader")
+      {
+      std::cerr << "Line " << __LINE__ << ": frames split at " << split
+                << " are wrongly parsed: text \"" << text << "\", "
+                << parser.NumberOfFrames << " frames, progress "
+                << parser.Progress << ", message " << parser.Message << std::endl;
+      return false;
+      }
+    }
+
+  // A chunk without the end of the frame does not report the progress
+  PluginProgressProtocol::Parser parser;
+  std::string text;
+  if (Parse(parser, std::string(1, PluginProgressProtocol::FrameBegin) + "S0.", text) ||
+      parser.StageProgress != 0. ||
+      !Parse(parser, std::string("75") + PluginProgressProtocol::FrameEnd, text) ||
+      parser.StageProgress != 0.75)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong partial frame, stage progress "
+              << parser.StageProgress << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool TestTextBetweenFrames()
+{
+  std::ostringstream output;
+  output << "Reading the input\n";
+  PluginProgressProtocol::WriteFrame(output, PluginProgressProtocol::FilterStart, "");
+  PluginProgressProtocol::WriteFrame(output, PluginProgressProtocol::FilterComment, "Smoothing");
+  output << "Sigma: 2.5";
+  PluginProgressProtocol::WriteFrame(output, PluginProgressProtocol::Progress, 0.5);
+  output << "\n";
+  PluginProgressProtocol::WriteFrame(output, PluginProgressProtocol::FilterEnd, "");
+  PluginProgressProtocol::WriteFrame(output, PluginProgressProtocol::FilterTime, 1.5);
+  output << "Done\n";
+
+  PluginProgressProtocol::Parser parser;
+  std::string text;
+  if (!Parse(parser, output.str(), text) ||
+      text != "Reading the input\nSigma: 2.5\nDone\n" ||
+      parser.NumberOfFrames != 5 ||
+      parser.Progress != 0.5 ||
+      parser.Message != "Smoothing")
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong text between frames: \""
+              << text << "\", " << parser.NumberOfFrames << " frames, progress "
+              << parser.Progress << ", message " << parser.Message << std::endl;
+    return false;
+    }
+
+  // The frames that are not progress or messages are skipped silently
+  std::ostringstream timeOutput;
+  PluginProgressProtocol::WriteFrame(timeOutput, PluginProgressProtocol::FilterTime, 2.);
+  timeOutput << "Output written";
+  text.clear();
+  if (Parse(parser, timeOutput.str(), text) ||
+      text != "Output written" || parser.NumberOfFrames != 6)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong time frame: \"" << text
+              << "\", " << parser.NumberOfFrames << " frames" << std::endl;
+    return false;
+    }
+
+  // A frame end without frame begin is text
+  text.clear();
+  const std::string stray = std::string("a") + PluginProgressProtocol::FrameEnd + "b";
+  if (Parse(parser, stray, text) || text != stray)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong stray frame end: \"" << text
+              << "\"" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool TestXMLFallback()
+{
+  PluginProgressProtocol::Parser parser;
+  std::string text;
+  // No frames, the whole output is text
+  if (Parse(parser, "<filter-start><filter-name>Reader</filter-name>"
+                    "<filter-comment>Reading</filter-comment></filter-start>\n"
+                    "<filter-progress>0.1</filter-progress>\n"
+                    "<filter-progress>0.2</filter-progress>", text) ||
+      parser.NumberOfFrames != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": tags read as frames" << std::endl;
+    return false;
+    }
+
+  // Only the complete lines are searched, the last value of a tag wins
+  if (!parser.ParseTags(text) ||
+      parser.Progress != 0.1 || parser.Message != "Reading")
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong tags: progress "
+              << parser.Progress << ", message " << parser.Message << std::endl;
+    return false;
+    }
+
+  // The lines already searched are not searched again
+  if (parser.ParseTags(text))
+    {
+    std::cerr << "Line " << __LINE__ << ": tags searched twice" << std::endl;
+    return false;
+    }
+
+  // The end of the line completes the last tag
+  Parse(parser, "\n<filter-stage-progress>0.5</filter-stage-progress>", text);
+  if (!parser.ParseTags(text) ||
+      parser.Progress != 0.2 || parser.StageProgress != 0.)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong completed line: progress "
+              << parser.Progress << ", stage progress " << parser.StageProgress
+              << std::endl;
+    return false;
+    }
+  Parse(parser, "\n<filter-end><filter-name>Reader</filter-name>"
+                "<filter-time>0.3</filter-time></filter-end>\n", text);
+  if (!parser.ParseTags(text) ||
+      parser.StageProgress != 0.5 || parser.Message != "Reader")
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong stage progress "
+              << parser.StageProgress << ", message " << parser.Message << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int PluginProgressProtocolTest1(int, char * [])
+{
+  if (!TestFramesSplitAcrossChunks() ||
+      !TestTextBetweenFrames() ||
+      !TestXMLFallback())
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,314 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QTextStream>
+#include <QTimer>
+
+// SlicerQt includes
+#include "qSlicerApplication.h"
+#include "qSlicerCLILoadableModuleFactory.h"
+#include "qSlicerCLIModule.h"
+#include "qSlicerModuleFactoryManager.h"
+#include "qSlicerModuleManager.h"
+
+// MRML includes
+#include <vtkMRMLScene.h>
+
+// MRMLCLI includes
+#include <vtkMRMLCommandLineModuleNode.h>
+#include <vtkSlicerCLIModuleLogic.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+struct BatchObserver
+{
+  BatchObserver()
+    : Logic(0)
+    , MaximumNumberOfRunningJobs(0)
+    , NumberOfFinishedJobEvents(0)
+    , NumberOfFinishedBatches(0)
+  {
+  }
+  vtkSlicerCLIModuleLogic* Logic;
+  /// Largest number of unfinished job nodes of a batch observed in the scene
+  int MaximumNumberOfRunningJobs;
+  int NumberOfFinishedJobEvents;
+  int NumberOfFinishedBatches;
+  /// Number of finished and failed jobs per batch ID when it is finished
+  std::vector<int> FinishedBatchIDs;
+  std::vector<int> FinishedJobs;
+  std::vector<int> FailedJobs;
+};
+
+//-----------------------------------------------------------------------------
+/// Count the job nodes of all the batches or of the batch \a batchID
+int numberOfBatchJobNodes(vtkMRMLScene* scene, bool unfinishedOnly,
+                          const char* batchID = 0)
+{
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLCommandLineModuleNode", nodes);
+  int count = 0;
+  for (std::vector<vtkMRMLNode*>::const_iterator it = nodes.begin();
+       it != nodes.end(); ++it)
+    {
+    vtkMRMLCommandLineModuleNode* node =
+      vtkMRMLCommandLineModuleNode::SafeDownCast(*it);
+    const char* nodeBatchID = node->GetAttribute("BatchID");
+    if (!nodeBatchID || (batchID && strcmp(nodeBatchID, batchID) != 0))
+      {
+      continue;
+      }
+    if (unfinishedOnly &&
+        (node->GetStatus() & (vtkMRMLCommandLineModuleNode::Completed |
+                              vtkMRMLCommandLineModuleNode::Cancelled)))
+      {
+      continue;
+      }
+    ++count;
+    }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+void onEvent(vtkObject* caller, unsigned long eid,
+             void* clientData, void* callData)
+{
+  BatchObserver* observer = reinterpret_cast<BatchObserver*>(clientData);
+  vtkMRMLScene* scene = observer->Logic->GetMRMLScene();
+  if (vtkMRMLScene::SafeDownCast(caller) && eid == vtkMRMLScene::NodeAddedEvent)
+    {
+    vtkMRMLNode* node = reinterpret_cast<vtkMRMLNode*>(callData);
+    const char* batchID = node ? node->GetAttribute("BatchID") : 0;
+    if (batchID)
+      {
+      observer->MaximumNumberOfRunningJobs =
+        std::max(observer->MaximumNumberOfRunningJobs,
+                 numberOfBatchJobNodes(scene, true, batchID));
+      }
+    }
+  else if (eid == vtkSlicerCLIModuleLogic::BatchJobFinishedEvent)
+    {
+    ++observer->NumberOfFinishedJobEvents;
+    }
+  else if (eid == vtkSlicerCLIModuleLogic::BatchFinishedEvent)
+    {
+    int batchID = *reinterpret_cast<int*>(callData);
+    ++observer->NumberOfFinishedBatches;
+    observer->FinishedBatchIDs.push_back(batchID);
+    observer->FinishedJobs.push_back(
+      observer->Logic->GetBatchNumberOfFinishedJobs(batchID));
+    observer->FailedJobs.push_back(
+      observer->Logic->GetBatchNumberOfFailedJobs(batchID));
+    }
+}
+
+//-----------------------------------------------------------------------------
+int readResult(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return -1;
+    }
+  QTextStream stream(&file);
+  bool ok = false;
+  int result = stream.readAll().trimmed().toInt(&ok);
+  return ok ? result : -1;
+}
+
+} // end anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIModuleBatchTest1(int argc, char * argv[])
+{
+  // The CLI4Test module (CLIModule4Test) is built as a shared object CLI.
+  QString cliModuleName("CLI4Test");
+
+  qSlicerApplication::setAttribute(qSlicerApplication::AA_DisablePython);
+  qSlicerApplication app(argc, argv);
+
+  qSlicerModuleManager * moduleManager = app.moduleManager();
+  qSlicerModuleFactoryManager* moduleFactoryManager = moduleManager->factoryManager();
+  moduleFactoryManager->registerFactory(new qSlicerCLILoadableModuleFactory);
+  QString cliPath = app.slicerHome() + "/" + Slicer_CLIMODULES_LIB_DIR + "/";
+  moduleFactoryManager->addSearchPath(cliPath);
+  moduleFactoryManager->addSearchPath(cliPath + app.intDir());
+  moduleFactoryManager->registerModules();
+  moduleFactoryManager->instantiateModules();
+  moduleFactoryManager->loadModule(cliModuleName);
+
+  qSlicerCLIModule * cliModule =
+    qobject_cast<qSlicerCLIModule*>(moduleManager->module(cliModuleName));
+  if (!cliModule)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Failed to load module '" << qPrintable(cliModuleName) << "'"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkSlicerCLIModuleLogic* logic = cliModule->cliModuleLogic();
+  vtkMRMLScene* scene = logic->GetMRMLScene();
+
+  BatchObserver observer;
+  observer.Logic = logic;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetClientData(&observer);
+  callback->SetCallback(onEvent);
+  scene->AddObserver(vtkMRMLScene::NodeAddedEvent, callback.GetPointer());
+  logic->AddObserver(vtkSlicerCLIModuleLogic::BatchJobFinishedEvent, callback.GetPointer());
+  logic->AddObserver(vtkSlicerCLIModuleLogic::BatchFinishedEvent, callback.GetPointer());
+
+  vtkMRMLCommandLineModuleNode * templateNode = logic->CreateNodeInScene();
+  templateNode->SetParameterAsString("OperationType", "Multiplication");
+  templateNode->SetParameterAsInt("InputValue2", 10);
+
+  // First batch: 6 jobs, at most 2 at a time
+  const int numberOfJobs = 6;
+  const int maximumNumberOfRunningJobs = 2;
+  QStringList outputFiles;
+  std::vector<vtkSlicerCLIModuleLogic::ParameterBindings> jobs;
+  for (int i = 0; i < numberOfJobs; ++i)
+    {
+    QString outputFile = QDir::temp().filePath(
+      QString("qSlicerCLIModuleBatchTest1-%1-%2.txt").arg(app.applicationPid()).arg(i));
+    QFile::remove(outputFile);
+    outputFiles << outputFile;
+    vtkSlicerCLIModuleLogic::ParameterBindings bindings;
+    bindings.push_back(std::make_pair(std::string("InputValue1"),
+                                      QString::number(i + 1).toStdString()));
+    bindings.push_back(std::make_pair(std::string("OutputFile"),
+                                      outputFile.toStdString()));
+    jobs.push_back(bindings);
+    }
+  int batchID = logic->ApplyBatch(templateNode, jobs, maximumNumberOfRunningJobs);
+  if (batchID <= 0 ||
+      logic->GetBatchNumberOfJobs(batchID) != numberOfJobs ||
+      numberOfBatchJobNodes(scene, true) != maximumNumberOfRunningJobs)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with ApplyBatch(): "
+              << numberOfBatchJobNodes(scene, true) << " scheduled jobs" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Second batch, cancelled before its first job is finished
+  std::vector<vtkSlicerCLIModuleLogic::ParameterBindings> cancelledJobs(
+    jobs.begin(), jobs.begin() + 4);
+  for (size_t i = 0; i < cancelledJobs.size(); ++i)
+    {
+    cancelledJobs[i][1].second += ".cancelled";
+    }
+  int cancelledBatchID = logic->ApplyBatch(templateNode, cancelledJobs, 1);
+  logic->CancelBatch(cancelledBatchID);
+
+  // Run the event loop until both batches are finished and the job nodes
+  // removed.
+  QTimer timer;
+  QObject::connect(&timer, SIGNAL(timeout()), &app, SLOT(quit()));
+  timer.start(100);
+  for (int i = 0; i < 300; ++i)
+    {
+    app.exec();
+    if (observer.NumberOfFinishedBatches == 2 &&
+        numberOfBatchJobNodes(scene, false) == 0)
+      {
+      break;
+      }
+    }
+  timer.stop();
+
+  if (observer.NumberOfFinishedBatches != 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - Batches not finished: "
+              << observer.NumberOfFinishedBatches << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (observer.MaximumNumberOfRunningJobs != maximumNumberOfRunningJobs)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of concurrent jobs: "
+              << observer.MaximumNumberOfRunningJobs << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (size_t i = 0; i < observer.FinishedBatchIDs.size(); ++i)
+    {
+    if (observer.FinishedBatchIDs[i] == batchID &&
+        (observer.FinishedJobs[i] != numberOfJobs || observer.FailedJobs[i] != 0))
+      {
+      std::cerr << "Line " << __LINE__ << " - Problem with the batch: "
+                << observer.FinishedJobs[i] << " finished jobs, "
+                << observer.FailedJobs[i] << " failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    // The first job of the cancelled batch may be finished before it is
+    // cancelled.
+    if (observer.FinishedBatchIDs[i] == cancelledBatchID &&
+        (observer.FinishedJobs[i] != static_cast<int>(cancelledJobs.size()) ||
+         observer.FailedJobs[i] < static_cast<int>(cancelledJobs.size()) - 1))
+      {
+      std::cerr << "Line " << __LINE__ << " - Problem with CancelBatch(): "
+                << observer.FinishedJobs[i] << " finished jobs, "
+                << observer.FailedJobs[i] << " failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  // Only the jobs that have been scheduled have a node
+  if (observer.NumberOfFinishedJobEvents < numberOfJobs ||
+      observer.NumberOfFinishedJobEvents > numberOfJobs + 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong number of finished job events: "
+              << observer.NumberOfFinishedJobEvents << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The job nodes are removed and the batches released
+  if (numberOfBatchJobNodes(scene, false) != 0 ||
+      logic->GetBatchNumberOfJobs(batchID) != 0 ||
+      logic->GetBatchNumberOfJobs(cancelledBatchID) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Batch jobs not released: "
+              << numberOfBatchJobNodes(scene, false) << " job nodes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int i = 0; i < numberOfJobs; ++i)
+    {
+    int result = readResult(outputFiles[i]);
+    QFile::remove(outputFiles[i]);
+    QFile::remove(outputFiles[i] + ".cancelled");
+    if (result != (i + 1) * 10)
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong result of job " << i
+                << ": " << result << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  scene->RemoveObserver(callback.GetPointer());
+  logic->RemoveObserver(callback.GetPointer());
+
+  return EXIT_SUCCESS;
+}
@@ -17,6 +17,9 @@
 // SlicerExecutionModel includes
 #include <ModuleDescription.h>
 
+// SlicerBaseCLI includes
+#include <PluginProgressProtocol.h>
+
 // MRML includes
 #include <vtkEventBroker.h>
 #include <vtkMRMLColorNode.h>
@@ -32,9 +35,11 @@
 #include <vtkCallbackCommand.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkStringArray.h>
+#include <vtkTimerLog.h>
 #include <vtksys/SystemTools.hxx>
 
 // ITKSYS includes
@@ -53,7 +58,9 @@
 #include <algorithm>
 #include <cassert>
 #include <ctime>
+#include <map>
 #include <set>
+#include <sstream>
 
 #ifdef _WIN32
 #else
@@ -87,8 +94,13 @@ public:
   }
   virtual void Execute(vtkObject* caller, unsigned long eid, void *callData)
   {
-    if (std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
-                  vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end())
+    // Several CLIs can run at the same time in the processing threads
+    this->ThreadIDsLock->Lock();
+    bool reschedule =
+      std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
+                vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end();
+    this->ThreadIDsLock->Unlock();
+    if (reschedule)
       {
       if (this->CLIModuleLogic)
         {
@@ -124,29 +136,36 @@ public:
       {
       return;
       }
+    this->ThreadIDsLock->Lock();
     if (reschedule)
       {
       this->ThreadIDs.push_back(id);
       }
     else
       {
-      std::remove(this->ThreadIDs.begin(), this->ThreadIDs.end(), id);
+      this->ThreadIDs.erase(
+        std::remove(this->ThreadIDs.begin(), this->ThreadIDs.end(), id),
+        this->ThreadIDs.end());
       }
+    this->ThreadIDsLock->Unlock();
   }
 protected:
   vtkSlicerCLIRescheduleCallback()
   {
     this->CLIModuleLogic = 0;
     this->Delay = 0;
+    this->ThreadIDsLock = vtkSimpleMutexLock::New();
   }
   ~vtkSlicerCLIRescheduleCallback()
   {
     this->SetCLIModuleLogic(0);
+    this->ThreadIDsLock->Delete();
   }
 
   vtkSlicerCLIModuleLogic* CLIModuleLogic;
   int Delay;
   std::vector<vtkMultiThreaderIDType> ThreadIDs;
+  vtkSimpleMutexLock* ThreadIDsLock;
 };
 
 //---------------------------------------------------------------------------
@@ -247,6 +266,53 @@ protected:
   std::string NodeID;
 };
 
+//---------------------------------------------------------------------------
+// A callback command to remove a node from the scene. This command is used to
+// remove the node of a finished batch job once the processing of its status
+// modification is over.
+class vtkSlicerCLIRemoveNodeCallback : public vtkCallbackCommand
+{
+public:
+  static vtkSlicerCLIRemoveNodeCallback *New()
+  {
+    return new vtkSlicerCLIRemoveNodeCallback;
+  }
+  virtual void Execute(vtkObject* vtkNotUsed(caller),
+                       unsigned long vtkNotUsed(eid),
+                       void * vtkNotUsed(callData))
+  {
+    vtkMRMLScene* scene = this->CLIModuleLogic->GetMRMLScene();
+    vtkMRMLNode* node = scene ? scene->GetNodeByID(this->NodeID.c_str()) : 0;
+    if (node)
+      {
+      scene->RemoveNode(node);
+      }
+  }
+
+  void SetCLIModuleLogic(vtkSlicerCLIModuleLogic* logic)
+  {
+    this->CLIModuleLogic = logic;
+  }
+
+  void SetNodeID(const std::string& id)
+  {
+    this->NodeID = id;
+  }
+
+protected:
+  vtkSlicerCLIRemoveNodeCallback()
+  {
+    this->CLIModuleLogic = 0;
+  }
+  ~vtkSlicerCLIRemoveNodeCallback()
+  {
+    this->SetCLIModuleLogic(0);
+  }
+
+  vtkSlicerCLIModuleLogic* CLIModuleLogic;
+  std::string NodeID;
+};
+
 //----------------------------------------------------------------------------
 class vtkSlicerCLIModuleLogic::vtkInternal
 {
@@ -256,6 +322,11 @@ public:
 
   int RedirectModuleStreams;
 
+  /// std::cout and std::cerr are redirected while a shared object module
+  /// runs. The streams are global, the shared object modules redirecting
+  /// them run one at a time.
+  static vtkSimpleMutexLock ModuleStreamsLock;
+
   std::string TemporaryDirectory;
 
   typedef std::vector<std::pair<int, vtkMRMLCommandLineModuleNode*> > RequestType;
@@ -282,6 +353,7 @@ public:
 
   void SetLastRequest(vtkMRMLCommandLineModuleNode* node, int requestUID)
   {
+    this->LastRequestsLock->Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
     if (it == this->LastRequests.end())
@@ -293,12 +365,32 @@ public:
       assert( it->first < requestUID );
       it->first = requestUID;
       }
+    this->LastRequestsLock->Unlock();
   }
   int GetLastRequest(vtkMRMLCommandLineModuleNode* node)
   {
+    this->LastRequestsLock->Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
-    return (it != this->LastRequests.end())? it->first : 0;
+    int requestUID = (it != this->LastRequests.end())? it->first : 0;
+    this->LastRequestsLock->Unlock();
+    return requestUID;
+  }
+  /// Remove and return the node of the request, 0 if there is none
+  vtkMRMLCommandLineModuleNode* TakeRequestNode(int requestUID)
+  {
+    this->LastRequestsLock->Lock();
+    RequestType::iterator it = std::find_if(
+      this->LastRequests.begin(), this->LastRequests.end(),
+      FindRequest(requestUID));
+    vtkMRMLCommandLineModuleNode* node = 0;
+    if (it != this->LastRequests.end())
+      {
+      node = it->second;
+      this->LastRequests.erase(it);
+      }
+    this->LastRequestsLock->Unlock();
+    return node;
   }
 
   /// Install the reschedule callback on a node and its references
@@ -337,13 +429,62 @@ public:
 
   /// List of read data/scene requests of the CLI nodes
   /// being executed with their.
+  /// The requests are made in the processing threads, LastRequestsLock
+  /// must be locked to access them.
   RequestType LastRequests;
+  vtkSmartPointer<vtkSimpleMutexLock> LastRequestsLock;
+
+  /// Jobs of a batch and their progress
+  struct BatchType
+  {
+    BatchType()
+      : MaximumNumberOfRunningJobs(1)
+      , UpdateDisplay(false)
+      , NextJob(0)
+      , NumberOfFinishedJobs(0)
+      , NumberOfFailedJobs(0)
+      , StartTime(0.)
+      , EndTime(-1.)
+    {
+    }
+    ModuleDescription Description;
+    std::string Name;
+    std::vector<vtkSlicerCLIModuleLogic::ParameterBindings> Jobs;
+    int MaximumNumberOfRunningJobs;
+    bool UpdateDisplay;
+    /// Index of the next job to schedule
+    int NextJob;
+    /// CLI nodes of the scheduled jobs that are not finished yet
+    std::vector<vtkMRMLCommandLineModuleNode*> RunningJobs;
+    int NumberOfFinishedJobs;
+    int NumberOfFailedJobs;
+    double StartTime;
+    /// -1 until the last job is finished
+    double EndTime;
+  };
+  typedef std::map<int, BatchType> BatchMapType;
+  BatchMapType Batches;
+  int LastBatchID;
+
+  const BatchType* GetBatch(int batchID)const
+  {
+    BatchMapType::const_iterator it = this->Batches.find(batchID);
+    return it != this->Batches.end() ? &it->second : 0;
+  }
+  BatchType* GetBatch(int batchID)
+  {
+    BatchMapType::iterator it = this->Batches.find(batchID);
+    return it != this->Batches.end() ? &it->second : 0;
+  }
 
   vtkSmartPointer<vtkSlicerCLIRescheduleCallback> RescheduleCallback;
   vtkSmartPointer<vtkSlicerCLIOneShotCallbackCallback>OneShotCallbackCallback;
 
 };
 
+//----------------------------------------------------------------------------
+vtkSimpleMutexLock vtkSlicerCLIModuleLogic::vtkInternal::ModuleStreamsLock;
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerCLIModuleLogic);
 
@@ -354,6 +495,9 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
 
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->RedirectModuleStreams = 1;
+  this->Internal->LastBatchID = 0;
+  this->Internal->LastRequestsLock =
+    vtkSmartPointer<vtkSimpleMutexLock>::New();
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
   this->Internal->RescheduleCallback->SetCLIModuleLogic(this);
@@ -362,6 +506,8 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
 
   this->AddObserver(vtkSlicerCLIModuleLogic::RequestHierarchyEditEvent,
                                       this->Internal->OneShotCallbackCallback, 100000000.f);
+  this->AddObserver(vtkSlicerCLIModuleLogic::RequestNodeRemovalEvent,
+                                      this->Internal->OneShotCallbackCallback, 100000000.f);
 }
 
 //----------------------------------------------------------------------------
@@ -514,7 +660,8 @@ vtkSlicerCLIModuleLogic
                              const std::string& type,
                              const std::string& name,
                              const std::vector<std::string>& extensions,
-                             CommandLineModuleType commandType)
+                             CommandLineModuleType commandType,
+                             const std::string& executionTag)
 {
   std::string fname = name;
   std::string pid;
@@ -540,10 +687,10 @@ vtkSlicerCLIModuleLogic
   // encoded to the same filename every time within that running
   // instance of Slicer).  This last point is an optimization to
   // minimize the number of times a file is written when running a
-  // module.  However, if we change the execution model such that more
-  // than one module can run at the same time within the same Slicer
-  // process, then this encoding will need to be changed to be unique
-  // per module execution.
+  // module.  As several modules can run at the same time within the
+  // same Slicer process (e.g. the jobs of a batch), the executionTag
+  // of the module (its CLI node ID) is added to the filename so that
+  // two executions sharing a node don't write and delete the same file.
   //
 
 
@@ -569,9 +716,13 @@ vtkSlicerCLIModuleLogic
   std::transform(fname.begin(), fname.end(),
                  fname.begin(), DigitsToCharacters());
 
-  // By default, the filename is based on the temporary directory and
-  // the pid
-  fname = this->Internal->TemporaryDirectory + "/" + pid + "_" + fname;
+  // By default, the filename is based on the temporary directory,
+  // the pid and the execution
+  std::string execution = executionTag;
+  std::transform(execution.begin(), execution.end(),
+                 execution.begin(), DigitsToCharacters());
+  fname = this->Internal->TemporaryDirectory + "/" + pid + "_"
+    + (execution.empty() ? std::string() : execution + "_") + fname;
 
   if (tag == "image")
     {
@@ -671,10 +822,16 @@ void vtkSlicerCLIModuleLogic::ApplyAndWait ( vtkMRMLCommandLineModuleNode* node,
   node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
 
   // Observe application logic to know when the CLI is completed and the
-  // associated data loaded. The observation will be removed in the callback.
-  vtkEventBroker::GetInstance()->AddObservation(
-    this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
-    this, this->GetMRMLLogicsCallbackCommand());
+  // associated data loaded. The observation is shared by all the CLIs run
+  // by the logic, possibly at the same time.
+  if (!vtkEventBroker::GetInstance()->GetObservationExist(
+        this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
+        this, this->GetMRMLLogicsCallbackCommand()))
+    {
+    vtkEventBroker::GetInstance()->AddObservation(
+      this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
+      this, this->GetMRMLLogicsCallbackCommand());
+    }
 
   vtkSlicerCLIModuleLogic::ApplyTask ( node );
 
@@ -712,6 +869,10 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
   task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
                         &vtkSlicerCLIModuleLogic::ApplyTask,
                         node);
+  // Cancelling the task cancels the module, ApplyTask() still runs to
+  // release the node if the module did not start
+  task->SetCancelFunction((vtkSlicerTask::TaskFunctionPointer)
+                          &vtkSlicerCLIModuleLogic::CancelTask);
 
   // Client data on the task is just a regular pointer, up the
   // reference count on the node, we'll decrease the reference count
@@ -720,10 +881,16 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
   node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
 
   // Observe application logic to know when the CLI is completed and the
-  // associated data loaded. The observation will be removed in the callback.
-  vtkEventBroker::GetInstance()->AddObservation(
-    this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
-    this, this->GetMRMLLogicsCallbackCommand());
+  // associated data loaded. The observation is shared by all the CLIs run
+  // by the logic, possibly at the same time.
+  if (!vtkEventBroker::GetInstance()->GetObservationExist(
+        this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
+        this, this->GetMRMLLogicsCallbackCommand()))
+    {
+    vtkEventBroker::GetInstance()->AddObservation(
+      this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
+      this, this->GetMRMLLogicsCallbackCommand());
+    }
 
   // Schedule the task
   ret = this->GetApplicationLogic()->ScheduleTask( task );
@@ -741,6 +908,217 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
 
 }
 
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic
+::ApplyBatch(vtkMRMLCommandLineModuleNode* templateNode,
+             const std::vector<ParameterBindings>& jobs,
+             int maximumNumberOfRunningJobs, bool updateDisplay)
+{
+  if (!templateNode || !this->GetMRMLScene())
+    {
+    vtkErrorMacro("ApplyBatch: no template node or no scene");
+    return 0;
+    }
+  int batchID = ++this->Internal->LastBatchID;
+  vtkInternal::BatchType& batch = this->Internal->Batches[batchID];
+  // The template node can be modified while the batch runs, the jobs use
+  // the parameters it has now.
+  batch.Description = templateNode->GetModuleDescription();
+  batch.Name = templateNode->GetName() ? templateNode->GetName() : "";
+  batch.Jobs = jobs;
+  batch.MaximumNumberOfRunningJobs = std::max(maximumNumberOfRunningJobs, 1);
+  batch.UpdateDisplay = updateDisplay;
+  batch.StartTime = vtkTimerLog::GetUniversalTime();
+
+  this->ScheduleBatchJobs(batchID);
+  return batchID;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::ScheduleBatchJobs(int batchID)
+{
+  // A job that fails to be scheduled is finished right away, which can
+  // schedule the next jobs and release the batch: the batch is searched again
+  // after each job.
+  for (vtkInternal::BatchType* batchPtr = this->Internal->GetBatch(batchID);
+       batchPtr &&
+         batchPtr->NextJob < static_cast<int>(batchPtr->Jobs.size()) &&
+         static_cast<int>(batchPtr->RunningJobs.size()) < batchPtr->MaximumNumberOfRunningJobs;
+       batchPtr = this->Internal->GetBatch(batchID))
+    {
+    vtkInternal::BatchType& batch = *batchPtr;
+    const int jobIndex = batch.NextJob++;
+    vtkMRMLCommandLineModuleNode* jobNode =
+      vtkMRMLCommandLineModuleNode::SafeDownCast(
+        this->GetMRMLScene()->CreateNodeByClass("vtkMRMLCommandLineModuleNode"));
+    jobNode->SetModuleDescription(batch.Description);
+    std::stringstream name;
+    name << batch.Name << " batch " << batchID << " job " << jobIndex;
+    jobNode->SetName(name.str().c_str());
+    jobNode->SetHideFromEditors(1);
+    jobNode->SetSaveWithScene(0);
+    std::stringstream id;
+    id << batchID;
+    jobNode->SetAttribute("BatchID", id.str().c_str());
+    std::stringstream index;
+    index << jobIndex;
+    jobNode->SetAttribute("BatchJob", index.str().c_str());
+
+    const ParameterBindings& bindings = batch.Jobs[jobIndex];
+    for (ParameterBindings::const_iterator it = bindings.begin();
+         it != bindings.end(); ++it)
+      {
+      if (!jobNode->SetParameterAsString(it->first.c_str(), it->second))
+        {
+        vtkWarningMacro("ApplyBatch: job " << jobIndex << " of batch " << batchID
+                        << " has no parameter " << it->first);
+        }
+      }
+    // The node is observed when it is added into the scene.
+    this->GetMRMLScene()->AddNode(jobNode);
+    jobNode->Delete();
+    batch.RunningJobs.push_back(jobNode);
+
+    this->Apply(jobNode, batch.UpdateDisplay);
+    if (jobNode->GetStatus() == vtkMRMLCommandLineModuleNode::Idle)
+      {
+      // The job could not be scheduled.
+      jobNode->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors);
+      }
+    }
+
+  vtkInternal::BatchType* batch = this->Internal->GetBatch(batchID);
+  if (!batch || batch->EndTime >= 0. ||
+      batch->NumberOfFinishedJobs != static_cast<int>(batch->Jobs.size()))
+    {
+    return;
+    }
+  batch->EndTime = vtkTimerLog::GetUniversalTime();
+  qDebug() << "Batch" << batchID << "of" << batch->Description.GetTitle().c_str()
+           << ":" << batch->NumberOfFinishedJobs << "jobs,"
+           << batch->NumberOfFailedJobs << "failed, in"
+           << batch->EndTime - batch->StartTime << "s ("
+           << this->GetBatchThroughput(batchID) << "jobs/s)";
+  this->InvokeEvent(vtkSlicerCLIModuleLogic::BatchFinishedEvent, &batchID);
+  // All the job nodes have been removed or are about to be.
+  this->Internal->Batches.erase(batchID);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic
+::OnBatchJobStatusModified(vtkMRMLCommandLineModuleNode* jobNode)
+{
+  int status = jobNode->GetStatus();
+  if (!(status & (vtkMRMLCommandLineModuleNode::Completed |
+                  vtkMRMLCommandLineModuleNode::Cancelled)))
+    {
+    return;
+    }
+  int batchID = atoi(jobNode->GetAttribute("BatchID"));
+  vtkInternal::BatchMapType::iterator batchIt =
+    this->Internal->Batches.find(batchID);
+  if (batchIt == this->Internal->Batches.end())
+    {
+    return;
+    }
+  vtkInternal::BatchType& batch = batchIt->second;
+  std::vector<vtkMRMLCommandLineModuleNode*>::iterator jobIt =
+    std::find(batch.RunningJobs.begin(), batch.RunningJobs.end(), jobNode);
+  if (jobIt == batch.RunningJobs.end())
+    {
+    // Already finished
+    return;
+    }
+  batch.RunningJobs.erase(jobIt);
+  ++batch.NumberOfFinishedJobs;
+  if (status != vtkMRMLCommandLineModuleNode::Completed)
+    {
+    ++batch.NumberOfFailedJobs;
+    }
+  this->InvokeEvent(vtkSlicerCLIModuleLogic::BatchJobFinishedEvent, jobNode);
+
+  // The node is still processing its status modification, it is removed
+  // from the scene later by the main thread.
+  if (this->GetApplicationLogic() && jobNode->GetID())
+    {
+    vtkSlicerCLIRemoveNodeCallback* callback = vtkSlicerCLIRemoveNodeCallback::New();
+    callback->SetCLIModuleLogic(this);
+    callback->SetNodeID(jobNode->GetID());
+    // callback is deleted by the vtkSlicerCLIOneShotCallbackCallback observing this event
+    this->GetApplicationLogic()->InvokeEventWithDelay(0, this,
+      vtkSlicerCLIModuleLogic::RequestNodeRemovalEvent, callback);
+    }
+
+  this->ScheduleBatchJobs(batchID);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::CancelBatch(int batchID)
+{
+  vtkInternal::BatchMapType::iterator batchIt =
+    this->Internal->Batches.find(batchID);
+  if (batchIt == this->Internal->Batches.end())
+    {
+    return;
+    }
+  vtkInternal::BatchType& batch = batchIt->second;
+  // The jobs not scheduled yet are cancelled right away
+  const int numberOfJobs = static_cast<int>(batch.Jobs.size());
+  batch.NumberOfFinishedJobs += numberOfJobs - batch.NextJob;
+  batch.NumberOfFailedJobs += numberOfJobs - batch.NextJob;
+  batch.NextJob = numberOfJobs;
+  // The others when their thread stops them
+  std::vector<vtkMRMLCommandLineModuleNode*> runningJobs = batch.RunningJobs;
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::iterator it = runningJobs.begin();
+       it != runningJobs.end(); ++it)
+    {
+    (*it)->Cancel();
+    }
+  this->ScheduleBatchJobs(batchID);
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetBatchNumberOfJobs(int batchID)const
+{
+  const vtkInternal::BatchType* batch = this->Internal->GetBatch(batchID);
+  return batch ? static_cast<int>(batch->Jobs.size()) : 0;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetBatchNumberOfFinishedJobs(int batchID)const
+{
+  const vtkInternal::BatchType* batch = this->Internal->GetBatch(batchID);
+  return batch ? batch->NumberOfFinishedJobs : 0;
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetBatchNumberOfFailedJobs(int batchID)const
+{
+  const vtkInternal::BatchType* batch = this->Internal->GetBatch(batchID);
+  return batch ? batch->NumberOfFailedJobs : 0;
+}
+
+//-----------------------------------------------------------------------------
+double vtkSlicerCLIModuleLogic::GetBatchElapsedTime(int batchID)const
+{
+  const vtkInternal::BatchType* batch = this->Internal->GetBatch(batchID);
+  if (!batch)
+    {
+    return 0.;
+    }
+  double endTime = batch->EndTime >= 0. ?
+    batch->EndTime : vtkTimerLog::GetUniversalTime();
+  return endTime - batch->StartTime;
+}
+
+//-----------------------------------------------------------------------------
+double vtkSlicerCLIModuleLogic::GetBatchThroughput(int batchID)const
+{
+  double elapsedTime = this->GetBatchElapsedTime(batchID);
+  return elapsedTime > 0. ?
+    this->GetBatchNumberOfFinishedJobs(batchID) / elapsedTime : 0.;
+}
+
 //-----------------------------------------------------------------------------
 // Static method for lazy evaluation of module target
 // void vtkSlicerCLIModuleLogic::LazyEvaluateModuleTarget(ModuleDescription& moduleDescriptionObject)
@@ -788,6 +1166,24 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
 //     }
 // }
 
+//-----------------------------------------------------------------------------
+// This routine can be called from any thread, the node is not modified
+// directly.
+void vtkSlicerCLIModuleLogic::CancelTask(void *clientdata)
+{
+  vtkMRMLCommandLineModuleNode* node =
+    reinterpret_cast<vtkMRMLCommandLineModuleNode*>(clientdata);
+  if (node == NULL ||
+      !node->IsBusy() ||
+      node->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelling)
+    {
+    return;
+    }
+  // ApplyTask() and the running module check for the Cancelling status
+  node->SetStatus(vtkMRMLCommandLineModuleNode::Cancelling, false);
+  this->GetApplicationLogic()->RequestModified( node );
+}
+
 //-----------------------------------------------------------------------------
 //
 // This routine is called in a separate thread from the main thread.
@@ -943,7 +1339,8 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              (*pit).GetType(),
                                              id,
                                              (*pit).GetFileExtensions(),
-                                             commandType);
+                                             commandType,
+                                             node0->GetID() ? node0->GetID() : "");
 
         filesToDelete.insert(fname);
 
@@ -1743,6 +2140,19 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
        {
        vtkErrorMacro( "Unable to reset ITK_AUTOLOAD_PATH.");
        }
+     // Ask the plugin filter watchers of the CLI to report the progress with
+     // frames.
+     std::string saveProgressFrames;
+     itksys::SystemTools::GetEnv(PluginProgressProtocol::EnvironmentVariable(),
+                                 saveProgressFrames);
+     std::string framesString =
+       std::string(PluginProgressProtocol::EnvironmentVariable()) + "=1";
+     putSuccess =
+       itksys::SystemTools::PutEnv(const_cast <char *> (framesString.c_str()));
+     if (!putSuccess)
+       {
+       vtkErrorMacro( "Unable to set " << PluginProgressProtocol::EnvironmentVariable());
+       }
     //
     // now run the process
     //
@@ -1768,6 +2178,15 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       {
       vtkErrorMacro( "Unable to restore ITK_AUTOLOAD_PATH. ");
       }
+    // restore the progress frames variable
+    framesString = std::string(PluginProgressProtocol::EnvironmentVariable())
+      + "=" + saveProgressFrames;
+    putSuccess =
+      itksys::SystemTools::PutEnv(const_cast <char *> (framesString.c_str()));
+    if (!putSuccess)
+      {
+      vtkErrorMacro( "Unable to restore " << PluginProgressProtocol::EnvironmentVariable());
+      }
 
     // Wait for the command to finish
     char *tbuffer;
@@ -1775,28 +2194,35 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     int pipe;
     const double timeoutlimit = 0.1;    // tenth of a second
     double timeout = timeoutlimit;
+    // CLIs can report their progress much more often than the GUI can be
+    // refreshed: the node is modified at most every tenth of a second.
+    const double modifiedInterval = 0.1;
+    double lastModifiedTime = 0.;
+    bool processInformationModified = false;
     std::string stdoutbuffer;
     std::string stderrbuffer;
-    std::string::size_type tagend;
-    std::string::size_type tagstart;
+    ModuleProcessInformation* processInformation =
+      node0->GetModuleDescription().GetProcessInformation();
+    // Progress frames written by the plugin filter watchers
+    PluginProgressProtocol::Parser progressParser;
     while ((pipe = itksysProcess_WaitForData(process ,&tbuffer,
                                              &length, &timeout)) != 0)
       {
       // increment the elapsed time
-      node0->GetModuleDescription().GetProcessInformation()->ElapsedTime
-        += (timeoutlimit - timeout);
-      this->GetApplicationLogic()->RequestModified( node0 );
+      processInformation->ElapsedTime += (timeoutlimit - timeout);
+      processInformationModified = true;
 
       // reset the timeout value
       timeout = timeoutlimit;
 
       // Check to see if the plugin was cancelled
-      if (node0->GetModuleDescription().GetProcessInformation()->Abort)
+      if (processInformation->Abort)
         {
         itksysProcess_Kill(process);
-        node0->GetModuleDescription().GetProcessInformation()->Progress = 0;
-        node0->GetModuleDescription().GetProcessInformation()->StageProgress =0;
+        processInformation->Progress = 0;
+        processInformation->StageProgress =0;
         this->GetApplicationLogic()->RequestModified( node0 );
+        processInformationModified = false;
         break;
         }
 
@@ -1806,66 +2232,16 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         if (pipe == itksysProcess_Pipe_STDOUT)
           {
           //std::cout << "STDOUT: " << std::string(tbuffer, length) << std::endl;
-          stdoutbuffer = stdoutbuffer.append(tbuffer, length);
-
-          bool foundTag = false;
-          // search for the last occurence of </filter-progress>
-          tagend = stdoutbuffer.rfind("</filter-progress>");
-          if (tagend != std::string::npos)
-            {
-            tagstart = stdoutbuffer.rfind("<filter-progress>");
-            if (tagstart != std::string::npos)
-              {
-              std::string progressString(stdoutbuffer, tagstart+17,
-                                         tagend-tagstart-17);
-              node0->GetModuleDescription().GetProcessInformation()->Progress = atof(progressString.c_str());
-              foundTag = true;
-              }
-            }
-          // search for the last occurence of </filter-stage-progress>
-          tagend = stdoutbuffer.rfind("</filter-stage-progress>");
-          if (tagend != std::string::npos)
-            {
-            tagstart = stdoutbuffer.rfind("<filter-stage-progress>");
-            if (tagstart != std::string::npos)
-              {
-              std::string progressString(stdoutbuffer, tagstart+23,
-                                         tagend-tagstart-23);
-              node0->GetModuleDescription().GetProcessInformation()->StageProgress = atof(progressString.c_str());
-              foundTag = true;
-              }
-            }
-
-          // search for the last occurence of </filter-name>
-          tagend = stdoutbuffer.rfind("</filter-name>");
-          if (tagend != std::string::npos)
-            {
-            tagstart = stdoutbuffer.rfind("<filter-name>");
-            if (tagstart != std::string::npos)
-              {
-              std::string filterString(stdoutbuffer, tagstart+13,
-                                       tagend-tagstart-13);
-              strncpy(node0->GetModuleDescription().GetProcessInformation()->ProgressMessage, filterString.c_str(), 1023);
-              foundTag = true;
-              }
-            }
-
-          // search for the last occurence of </filter-comment>
-          tagend = stdoutbuffer.rfind("</filter-comment>");
-          if (tagend != std::string::npos)
+          // The CLIs that don't write frames report their progress with
+          // text tags.
+          if (progressParser.Parse(tbuffer, length, stdoutbuffer) ||
+              (progressParser.NumberOfFrames == 0 &&
+               progressParser.ParseTags(stdoutbuffer)))
             {
-            tagstart = stdoutbuffer.rfind("<filter-comment>");
-            if (tagstart != std::string::npos)
-              {
-              std::string progressMessage(stdoutbuffer, tagstart+16,
-                                         tagend-tagstart-16);
-              strncpy (node0->GetModuleDescription().GetProcessInformation()->ProgressMessage, progressMessage.c_str(), 1023);
-              foundTag = true;
-              }
-            }
-          if (foundTag)
-            {
-            this->GetApplicationLogic()->RequestModified( node0 );
+            processInformation->Progress = progressParser.Progress;
+            processInformation->StageProgress = progressParser.StageProgress;
+            strncpy(processInformation->ProgressMessage,
+                    progressParser.Message.c_str(), 1023);
             }
           }
         else if (pipe == itksysProcess_Pipe_STDERR)
@@ -1873,64 +2249,81 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
           stderrbuffer = stderrbuffer.append(tbuffer, length);
           }
         }
+
+      const double now = itksys::SystemTools::GetTime();
+      if (processInformationModified &&
+          now - lastModifiedTime >= modifiedInterval)
+        {
+        this->GetApplicationLogic()->RequestModified( node0 );
+        lastModifiedTime = now;
+        processInformationModified = false;
+        }
+      }
+    if (processInformationModified)
+      {
+      this->GetApplicationLogic()->RequestModified( node0 );
       }
     itksysProcess_WaitForExit(process, 0);
 
 
-    // remove the embedded XML from the stdout stream
+    // remove the embedded XML from the stdout stream. The frames are
+    // already removed by the parser.
     //
     // Note that itksys::RegularExpression gives begin()/end() as
     // size_types not iterators. So we need to use the version of
     // erase that takes a position and length to erase.
     //
-    itksys::RegularExpression filterProgressRegExp("<filter-progress>[^<]*</filter-progress>[ \t\n\r]*");
-    while (filterProgressRegExp.find(stdoutbuffer))
-      {
-      stdoutbuffer.erase(filterProgressRegExp.start(),
-                         filterProgressRegExp.end()
-                         - filterProgressRegExp.start());
-      }
-    itksys::RegularExpression filterStageProgressRegExp("<filter-stage-progress>[^<]*</filter-stage-progress>[ \t\n\r]*");
-    while (filterStageProgressRegExp.find(stdoutbuffer))
+    if (progressParser.NumberOfFrames == 0)
       {
-      stdoutbuffer.erase(filterStageProgressRegExp.start(),
-                         filterStageProgressRegExp.end()
-                         - filterStageProgressRegExp.start());
-      }
-    itksys::RegularExpression filterNameRegExp("<filter-name>[^<]*</filter-name>[ \t\n\r]*");
-    while (filterNameRegExp.find(stdoutbuffer))
-      {
-      stdoutbuffer.erase(filterNameRegExp.start(),
-                         filterNameRegExp.end()
-                         - filterNameRegExp.start());
-      }
-    itksys::RegularExpression filterCommentRegExp("<filter-comment>[^<]*</filter-comment>[ \t\n\r]*");
-    while (filterCommentRegExp.find(stdoutbuffer))
-      {
-      stdoutbuffer.erase(filterCommentRegExp.start(),
-                         filterCommentRegExp.end()
-                         - filterCommentRegExp.start());
-      }
-    itksys::RegularExpression filterTimeRegExp("<filter-time>[^<]*</filter-time>[ \t\n\r]*");
-    while (filterTimeRegExp.find(stdoutbuffer))
-      {
-      stdoutbuffer.erase(filterTimeRegExp.start(),
-                         filterTimeRegExp.end()
-                         - filterTimeRegExp.start());
-      }
-    itksys::RegularExpression filterStartRegExp("<filter-start>[^<]*</filter-start>[ \t\n\r]*");
-    while (filterStartRegExp.find(stdoutbuffer))
-      {
-      stdoutbuffer.erase(filterStartRegExp.start(),
-                         filterStartRegExp.end()
-                         - filterStartRegExp.start());
-      }
-    itksys::RegularExpression filterEndRegExp("<filter-end>[^<]*</filter-end>[ \t\n\r]*");
-    while (filterEndRegExp.find(stdoutbuffer))
-      {
-      stdoutbuffer.erase(filterEndRegExp.start(),
-                         filterEndRegExp.end()
-                         - filterEndRegExp.start());
+      itksys::RegularExpression filterProgressRegExp("<filter-progress>[^<]*</filter-progress>[ \t\n\r]*");
+      while (filterProgressRegExp.find(stdoutbuffer))
+        {
+        stdoutbuffer.erase(filterProgressRegExp.start(),
+                           filterProgressRegExp.end()
+                           - filterProgressRegExp.start());
+        }
+      itksys::RegularExpression filterStageProgressRegExp("<filter-stage-progress>[^<]*</filter-stage-progress>[ \t\n\r]*");
+      while (filterStageProgressRegExp.find(stdoutbuffer))
+        {
+        stdoutbuffer.erase(filterStageProgressRegExp.start(),
+                           filterStageProgressRegExp.end()
+                           - filterStageProgressRegExp.start());
+        }
+      itksys::RegularExpression filterNameRegExp("<filter-name>[^<]*</filter-name>[ \t\n\r]*");
+      while (filterNameRegExp.find(stdoutbuffer))
+        {
+        stdoutbuffer.erase(filterNameRegExp.start(),
+                           filterNameRegExp.end()
+                           - filterNameRegExp.start());
+        }
+      itksys::RegularExpression filterCommentRegExp("<filter-comment>[^<]*</filter-comment>[ \t\n\r]*");
+      while (filterCommentRegExp.find(stdoutbuffer))
+        {
+        stdoutbuffer.erase(filterCommentRegExp.start(),
+                           filterCommentRegExp.end()
+                           - filterCommentRegExp.start());
+        }
+      itksys::RegularExpression filterTimeRegExp("<filter-time>[^<]*</filter-time>[ \t\n\r]*");
+      while (filterTimeRegExp.find(stdoutbuffer))
+        {
+        stdoutbuffer.erase(filterTimeRegExp.start(),
+                           filterTimeRegExp.end()
+                           - filterTimeRegExp.start());
+        }
+      itksys::RegularExpression filterStartRegExp("<filter-start>[^<]*</filter-start>[ \t\n\r]*");
+      while (filterStartRegExp.find(stdoutbuffer))
+        {
+        stdoutbuffer.erase(filterStartRegExp.start(),
+                           filterStartRegExp.end()
+                           - filterStartRegExp.start());
+        }
+      itksys::RegularExpression filterEndRegExp("<filter-end>[^<]*</filter-end>[ \t\n\r]*");
+      while (filterEndRegExp.find(stdoutbuffer))
+        {
+        stdoutbuffer.erase(filterEndRegExp.start(),
+                           filterEndRegExp.end()
+                           - filterEndRegExp.start());
+        }
       }
 
 
@@ -2046,12 +2439,17 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
 
     std::ostringstream coutstringstream;
     std::ostringstream cerrstringstream;
+    const bool redirectStreams = this->Internal->RedirectModuleStreams != 0;
+    if (redirectStreams)
+      {
+      vtkInternal::ModuleStreamsLock.Lock();
+      }
     std::streambuf* origcoutrdbuf = std::cout.rdbuf();
     std::streambuf* origcerrrdbuf = std::cerr.rdbuf();
     int returnValue = 0;
     try
       {
-      if (this->Internal->RedirectModuleStreams)
+      if (redirectStreams)
         {
         // redirect the streams
         std::cout.rdbuf( coutstringstream.rdbuf() );
@@ -2080,7 +2478,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         vtkErrorMacro( << (tmp + cerrstringstream.str()).c_str() );
         }
 
-      if (this->Internal->RedirectModuleStreams)
+      if (redirectStreams)
         {
         // reset the streams
         std::cout.rdbuf( origcoutrdbuf );
@@ -2121,6 +2519,10 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       std::cout.rdbuf( origcoutrdbuf );
       std::cerr.rdbuf( origcerrrdbuf );
       }
+    if (redirectStreams)
+      {
+      vtkInternal::ModuleStreamsLock.Unlock();
+      }
     if (node0->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelling)
       {
       node0->SetStatus(vtkMRMLCommandLineModuleNode::Cancelled, false);
@@ -2135,8 +2537,6 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       vtkErrorMacro( << information.str().c_str() );
       node0->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors, false);
       this->GetApplicationLogic()->RequestModified( node0 );
-      std::cout.rdbuf( origcoutrdbuf );
-      std::cerr.rdbuf( origcerrrdbuf );
       }
     }
   else if ( commandType == PythonModule )
@@ -2566,6 +2966,7 @@ void vtkSlicerCLIModuleLogic::SetMRMLSceneInternal(vtkMRMLScene * newScene)
 {
   vtkNew<vtkIntArray> events;
   events->InsertNextValue(vtkMRMLScene::NodeAddedEvent);
+  events->InsertNextValue(vtkMRMLScene::NodeRemovedEvent);
   this->SetAndObserveMRMLSceneEventsInternal(newScene, events.GetPointer());
 }
 
@@ -2578,11 +2979,23 @@ void vtkSlicerCLIModuleLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
     events->InsertNextValue(vtkCommand::ModifiedEvent);
     events->InsertNextValue(
       vtkMRMLCommandLineModuleNode::AutoRunEvent);
+    events->InsertNextValue(
+      vtkMRMLCommandLineModuleNode::StatusModifiedEvent);
     vtkObserveMRMLNodeEventsMacro(node, events.GetPointer());
     }
   this->Superclass::OnMRMLSceneNodeAdded(node);
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
+{
+  if (node->IsA("vtkMRMLCommandLineModuleNode"))
+    {
+    vtkUnObserveMRMLNodeMacro(node);
+    }
+  this->Superclass::OnMRMLSceneNodeRemoved(node);
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::ProcessMRMLLogicsEvents(vtkObject* caller,
                                                       unsigned long event,
@@ -2592,22 +3005,15 @@ void vtkSlicerCLIModuleLogic::ProcessMRMLLogicsEvents(vtkObject* caller,
       event == vtkSlicerApplicationLogic::RequestProcessedEvent)
     {
     unsigned long uid = reinterpret_cast<unsigned long>(callData);
-    vtkInternal::RequestType::iterator it =
-      std::find_if(this->Internal->LastRequests.begin(),
-      this->Internal->LastRequests.end(), vtkInternal::FindRequest(uid));
-    if (it != this->Internal->LastRequests.end())
+    vtkMRMLCommandLineModuleNode* node = this->Internal->TakeRequestNode(uid);
+    if (node)
       {
-      vtkMRMLCommandLineModuleNode* node = it->second;
       // If the status is not Completing, then there should be no request made
       // on the application logic.
       assert(node->GetStatus() == vtkMRMLCommandLineModuleNode::Completing);
+      // The observation of the application logic is kept: other CLIs may be
+      // running and make their requests later.
       node->SetStatus(vtkMRMLCommandLineModuleNode::Completed);
-      this->Internal->LastRequests.erase(it);
-      // we are not interested in any request anymore because the cli node is
-      // Completed.
-      vtkEventBroker::GetInstance()->RemoveObservations(
-        this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
-        this, this->GetMRMLLogicsCallbackCommand());
       }
     }
 }
@@ -2622,6 +3028,12 @@ void vtkSlicerCLIModuleLogic
   // Observe only the CLI of the logic.
   vtkMRMLCommandLineModuleNode* cliNode =
     vtkMRMLCommandLineModuleNode::SafeDownCast(node);
+  // Batch jobs can run any CLI.
+  if (cliNode && event == vtkMRMLCommandLineModuleNode::StatusModifiedEvent &&
+      cliNode->GetAttribute("BatchID"))
+    {
+    this->OnBatchJobStatusModified(cliNode);
+    }
   if (cliNode &&
       cliNode->GetModuleTitle() ==
         this->Internal->DefaultModuleDescription.GetTitle())
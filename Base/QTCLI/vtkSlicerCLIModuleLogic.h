@@ -26,6 +26,8 @@ class ModuleParameter;
 
 // STL includes
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "qSlicerBaseQTCLIExport.h"
 
@@ -96,6 +98,58 @@ public:
   /// in the node selectors.
   void ApplyAndWait ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay = true);
 
+  /// Parameter values of a batch job as pairs of parameter name and value,
+  /// typically the IDs of the input and output nodes of a subject.
+  typedef std::vector<std::pair<std::string, std::string> > ParameterBindings;
+
+  /// Schedules the command line module of \a templateNode to run once per
+  /// job. A job runs with the parameters of the template node, overridden by
+  /// its bindings. At most \a maximumNumberOfRunningJobs jobs are scheduled
+  /// at a time, the next job being scheduled when one is finished. The jobs
+  /// run concurrently up to the number of processing threads of the
+  /// application logic, except the shared object modules that run one at a
+  /// time when the module streams are redirected.
+  /// Each job runs in its own hidden CLI node, removed from the scene once
+  /// BatchJobFinishedEvent has been invoked. A shared object module is
+  /// loaded once and its entry point is called for every job.
+  /// The batch is released once BatchFinishedEvent has been invoked, its
+  /// statistics must be retrieved before.
+  /// This method is non blocking and returns the ID of the batch.
+  /// \sa BatchJobFinishedEvent, BatchFinishedEvent, CancelBatch(),
+  /// vtkSlicerApplicationLogic::SetNumberOfProcessingThreads()
+  int ApplyBatch(vtkMRMLCommandLineModuleNode* templateNode,
+                 const std::vector<ParameterBindings>& jobs,
+                 int maximumNumberOfRunningJobs = 1,
+                 bool updateDisplay = false);
+
+  /// Cancel the jobs of the batch that are not finished yet.
+  void CancelBatch(int batchID);
+
+  /// Number of jobs of the batch, finished or not.
+  int GetBatchNumberOfJobs(int batchID)const;
+  /// Number of jobs of the batch that are completed, with or without
+  /// errors, or cancelled.
+  int GetBatchNumberOfFinishedJobs(int batchID)const;
+  /// Number of finished jobs of the batch that are not successfully
+  /// completed.
+  int GetBatchNumberOfFailedJobs(int batchID)const;
+  /// Time in seconds since the batch has been applied, until its last job
+  /// is finished.
+  double GetBatchElapsedTime(int batchID)const;
+  /// Number of finished jobs per second.
+  double GetBatchThroughput(int batchID)const;
+
+  /// List of public events fired by the class.
+  enum BatchEvents{
+    /// Invoked when a job of a batch is finished. The CLI node of the job is
+    /// passed as call data, its "BatchID" and "BatchJob" attributes are the
+    /// ID of the batch and the index of the job.
+    BatchJobFinishedEvent = vtkCommand::UserEvent + 2,
+    /// Invoked when all the jobs of a batch are finished. A pointer to the
+    /// ID of the batch (int*) is passed as call data.
+    BatchFinishedEvent
+  };
+
   /// Set/Get the directory to use for temporary files
   void SetTemporaryDirectory(const char *tempdir);
 
@@ -108,6 +162,7 @@ protected:
   virtual void SetMRMLSceneInternal(vtkMRMLScene * newScene);
   /// Reimplemented for AutoRun mode.
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node);
+  virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* node);
   /// Reimplemented to observe CLI node.
   virtual void ProcessMRMLNodesEvents(vtkObject *caller, unsigned long event,
                                       void *callData);
@@ -119,7 +174,8 @@ protected:
                                          const std::string& type,
                                          const std::string& name,
                                      const std::vector<std::string>& extensions,
-                                     CommandLineModuleType commandType);
+                                     CommandLineModuleType commandType,
+                                     const std::string& executionTag = std::string());
   std::string ConstructTemporarySceneFileName(vtkMRMLScene *scene);
   std::string FindHiddenNodeID(const ModuleDescription& d,
                                const ModuleParameter& p);
@@ -127,6 +183,9 @@ protected:
   // The method that runs the command line module
   void ApplyTask(void *clientdata);
 
+  // Called when the task running the command line module is cancelled
+  void CancelTask(void *clientdata);
+
   // Communicate progress back to the node
   static void ProgressCallback(void *);
 
@@ -138,9 +197,16 @@ protected:
   /// Call apply because the node requests it.
   void AutoRun(vtkMRMLCommandLineModuleNode* cliNode);
 
+  /// Schedule the next jobs of the batch, up to its maximum number of
+  /// running jobs.
+  void ScheduleBatchJobs(int batchID);
+  /// Called when the status of the CLI node of a batch job is modified.
+  void OnBatchJobStatusModified(vtkMRMLCommandLineModuleNode* jobNode);
+
     /// List of custom events fired by the class.
   enum Events{
-    RequestHierarchyEditEvent = vtkCommand::UserEvent + 1
+    RequestHierarchyEditEvent = vtkCommand::UserEvent + 1,
+    RequestNodeRemovalEvent = vtkCommand::UserEvent + 4
   };
 
 private:
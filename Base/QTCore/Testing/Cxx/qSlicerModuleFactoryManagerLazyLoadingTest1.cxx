@@ -0,0 +1,147 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Qt includes
+#include <QSignalSpy>
+
+// CTK includes
+#include <ctkAbstractObjectFactory.h>
+
+// SlicerQt includes
+#include "qSlicerAbstractCoreModule.h"
+#include "qSlicerCoreApplication.h"
+#include "qSlicerCoreIOManager.h"
+#include "qSlicerFileReader.h"
+#include "qSlicerModuleFactoryManager.h"
+#include "qSlicerModuleManager.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+class qSlicerLazyTestReader : public qSlicerFileReader
+{
+public:
+  virtual QString description()const { return "Lazy test file"; }
+  virtual IOFileType fileType()const { return "LazyTestFile"; }
+  virtual QStringList extensions()const
+  {
+    return QStringList() << "Lazy test file (*.lazytest)";
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Module without logic nor widget, counting its setups
+class qSlicerLazyTestModule : public qSlicerAbstractCoreModule
+{
+public:
+  qSlicerLazyTestModule() : SetupCount(0) {}
+  virtual QString title()const { return "Lazy Test"; }
+  int SetupCount;
+protected:
+  virtual void setup() { ++this->SetupCount; }
+  virtual qSlicerAbstractModuleRepresentation* createWidgetRepresentation()
+  {
+    return 0;
+  }
+  virtual vtkMRMLAbstractLogic* createLogic()
+  {
+    return 0;
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Module registering a reader when it is set up
+class qSlicerLazyReaderTestModule : public qSlicerLazyTestModule
+{
+public:
+  virtual QString title()const { return "Lazy Reader Test"; }
+protected:
+  virtual void setup()
+  {
+    this->qSlicerLazyTestModule::setup();
+    qSlicerCoreApplication::application()->coreIOManager()->registerIO(
+      new qSlicerLazyTestReader);
+  }
+};
+
+//-----------------------------------------------------------------------------
+class qSlicerLazyTestModuleFactory
+  : public ctkAbstractObjectFactory<qSlicerAbstractCoreModule>
+{
+public:
+  virtual void registerItems()
+  {
+    this->registerObject<qSlicerLazyTestModule>("LazyTest");
+    this->registerObject<qSlicerLazyReaderTestModule>("LazyReaderTest");
+  }
+};
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerModuleFactoryManagerLazyLoadingTest1(int argc, char * argv [])
+{
+  qSlicerCoreApplication app(argc, argv);
+  qSlicerModuleFactoryManager* factoryManager = app.moduleManager()->factoryManager();
+  factoryManager->registerFactory(new qSlicerLazyTestModuleFactory);
+  factoryManager->setLazyLoading(true);
+  factoryManager->registerModules();
+  factoryManager->instantiateModules();
+  factoryManager->loadModules();
+
+  qSlicerLazyTestModule* module = dynamic_cast<qSlicerLazyTestModule*>(
+    factoryManager->loadedModule("LazyTest"));
+  qSlicerLazyTestModule* readerModule = dynamic_cast<qSlicerLazyTestModule*>(
+    factoryManager->loadedModule("LazyReaderTest"));
+  if (!module || !readerModule ||
+      factoryManager->deferredModuleNames().count() != 2 ||
+      module->SetupCount != 0 || readerModule->SetupCount != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": the modules are not deferred" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The first use of a module initializes it, and only it
+  QSignalSpy spyInitializationRequested(module, SIGNAL(initializationRequested()));
+  module->logic();
+  module->logic();
+  if (module->SetupCount != 1 ||
+      spyInitializationRequested.count() != 1 ||
+      factoryManager->deferredModuleNames() != QStringList() << "LazyReaderTest" ||
+      readerModule->SetupCount != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong initialization on first use: "
+              << module->SetupCount << " setups, "
+              << spyInitializationRequested.count() << " requests" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Looking up a reader initializes the deferred modules, which register
+  // their readers
+  qSlicerIO::IOFileType fileType =
+    app.coreIOManager()->fileType("volume.lazytest");
+  if (fileType != "LazyTestFile" ||
+      readerModule->SetupCount != 1 ||
+      !factoryManager->deferredModuleNames().isEmpty())
+    {
+    std::cerr << "Line " << __LINE__ << ": the reader of the deferred module is "
+              << "not available: " << qPrintable(fileType) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -51,6 +51,7 @@ public:
   vtkSmartPointer<vtkMRMLScene>              MRMLScene;
   vtkSmartPointer<vtkSlicerApplicationLogic> AppLogic;
   vtkSmartPointer<vtkMRMLAbstractLogic>      Logic;
+  bool                                       InitializationRequested;
 };
 
 //-----------------------------------------------------------------------------
@@ -61,6 +62,7 @@ qSlicerAbstractCoreModulePrivate::qSlicerAbstractCoreModulePrivate()
   this->Name = "NA";
   this->WidgetRepresentation = 0;
   this->Installed = false;
+  this->InitializationRequested = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -207,6 +209,19 @@ CTK_SET_CPP(qSlicerAbstractCoreModule, const QString&, setPath, Path);
 CTK_GET_CPP(qSlicerAbstractCoreModule, bool, isInstalled, Installed);
 CTK_SET_CPP(qSlicerAbstractCoreModule, bool, setInstalled, Installed);
 
+//-----------------------------------------------------------------------------
+void qSlicerAbstractCoreModule::requestInitialization()
+{
+  Q_D(qSlicerAbstractCoreModule);
+  // Modules without logic would request it at each call of logic()
+  if (d->InitializationRequested)
+    {
+    return;
+    }
+  d->InitializationRequested = true;
+  emit initializationRequested();
+}
+
 //-----------------------------------------------------------------------------
 qSlicerAbstractModuleRepresentation* qSlicerAbstractCoreModule::widgetRepresentation()
 {
@@ -215,6 +230,7 @@ qSlicerAbstractModuleRepresentation* qSlicerAbstractCoreModule::widgetRepresenta
   // If required, create widgetRepresentation
   if (!d->WidgetRepresentation)
     {
+    this->requestInitialization();
     d->WidgetRepresentation = this->createNewWidgetRepresentation();
     }
   return d->WidgetRepresentation;
@@ -259,6 +275,12 @@ vtkMRMLAbstractLogic* qSlicerAbstractCoreModule::logic()
   Q_D(qSlicerAbstractCoreModule);
 
   // Return a logic object is one already exists
+  if (d->Logic)
+    {
+    return d->Logic;
+    }
+  // A deferred initialization creates the logic
+  this->requestInitialization();
   if (d->Logic)
     {
     return d->Logic;
@@ -259,6 +259,13 @@ public slots:
   /// and representations if any
   virtual void setMRMLScene(vtkMRMLScene*);
 
+signals:
+  /// Emitted once, before the logic or the widget representation of the
+  /// module is first created. The module factory manager observes it to
+  /// initialize the modules whose initialization has been deferred.
+  /// \sa logic(), widgetRepresentation()
+  void initializationRequested();
+
 protected:
   /// All initialization code should be done in the setup
   virtual void setup() = 0;
@@ -281,6 +288,8 @@ private:
   /// Internal method called by the destructor of qSlicerAbstractModuleRepresentation
   /// to remove the representation from the list.
   void representationDeleted(qSlicerAbstractModuleRepresentation *representation);
+  /// Emit initializationRequested() if it hasn't been emitted yet
+  void requestInitialization();
   /// Indicate if the module has already been initialized
   bool Initialized;
 };
@@ -20,14 +20,33 @@
 
 // Qt includes
 #include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
 
 // SlicerQt includes
 #include "qSlicerAbstractModuleFactoryManager.h"
 #include "qSlicerAbstractCoreModule.h"
 
 // STD includes
+#include <algorithm>
 #include <typeinfo>
 
+namespace
+{
+//-----------------------------------------------------------------------------
+double elapsedMilliseconds(const QElapsedTimer& timer)
+{
+  return static_cast<double>(timer.nsecsElapsed()) / 1000000.;
+}
+
+//-----------------------------------------------------------------------------
+bool isMoreExpensive(const QPair<double, QString>& left,
+                     const QPair<double, QString>& right)
+{
+  return left.first > right.first;
+}
+}
+
 //-----------------------------------------------------------------------------
 class qSlicerAbstractModuleFactoryManagerPrivate
 {
@@ -46,6 +65,9 @@ public:
   QVector<qSlicerFileBasedModuleFactory*> fileBasedFactories()const;
   QVector<qSlicerModuleFactory*> notFileBasedFactories()const;
 
+  /// Name used to identify a factory in the startup timings
+  QString factoryName(qSlicerModuleFactory* factory)const;
+
   QStringList SearchPaths;
   QStringList ExplicitModules;
   QStringList ModulesToIgnore;
@@ -54,6 +76,12 @@ public:
   QMap<QString, qSlicerModuleFactory*> RegisteredModules;
   QMap<QString, QStringList> ModuleDependees;
 
+  /// Startup timings: step -> (factory or module name -> time in ms)
+  QMap<QString, QMap<QString, double> > StartupTimings;
+  /// Ordered list of steps, used to print the report in the order the
+  /// steps are run.
+  QStringList StartupSteps;
+
   bool Verbose;
 };
 
@@ -113,6 +141,14 @@ qSlicerAbstractModuleFactoryManagerPrivate
   return factories;
 }
 
+//-----------------------------------------------------------------------------
+QString qSlicerAbstractModuleFactoryManagerPrivate
+::factoryName(qSlicerModuleFactory* factory)const
+{
+  // todo: qSlicerModuleFactory should derive from QObject.
+  return QString(typeid(*factory).name());
+}
+
 //-----------------------------------------------------------------------------
 // qSlicerAbstractModuleFactoryManager methods
 
@@ -235,7 +271,11 @@ void qSlicerAbstractModuleFactoryManager::registerModules()
   // \todo: don't support factories other than filebased factories
   foreach(qSlicerModuleFactory* factory, d->notFileBasedFactories())
     {
+    QElapsedTimer timer;
+    timer.start();
     factory->registerItems();
+    this->addStartupTiming("factories", d->factoryName(factory),
+                           elapsedMilliseconds(timer));
     foreach(const QString& moduleName, factory->itemKeys())
       {
       if (d->Verbose)
@@ -282,7 +322,12 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
       {
       qDebug() << " checking file: " << file.absoluteFilePath() << " as a " << typeid(*factory).name();
       }
-    if (!factory->isValidFile(file))
+    QElapsedTimer timer;
+    timer.start();
+    bool validFile = factory->isValidFile(file);
+    this->addStartupTiming("factories", d->factoryName(factory),
+                           elapsedMilliseconds(timer));
+    if (!validFile)
       {
       continue;
       }
@@ -329,7 +374,11 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
     emit moduleIgnored(moduleName);
     return;
     }
+  QElapsedTimer timer;
+  timer.start();
   QString registeredModuleName = moduleFactory->registerFileItem(file);
+  this->addStartupTiming("factories", d->factoryName(moduleFactory),
+                         elapsedMilliseconds(timer));
   if (registeredModuleName != moduleName)
     {
     //qDebug() << "Ignore module" << moduleName;
@@ -366,7 +415,10 @@ qSlicerAbstractCoreModule* qSlicerAbstractModuleFactoryManager
   Q_D(qSlicerAbstractModuleFactoryManager);
   Q_ASSERT(d->RegisteredModules.contains(moduleName));
   qSlicerModuleFactory* factory = d->RegisteredModules[moduleName];
+  QElapsedTimer timer;
+  timer.start();
   qSlicerAbstractCoreModule* module = factory->instantiate(moduleName);
+  this->addStartupTiming("instantiate", moduleName, elapsedMilliseconds(timer));
   if (module)
     {
     module->setName(moduleName);
@@ -508,3 +560,71 @@ void qSlicerAbstractModuleFactoryManager::setIsVerbose(bool flag)
   d->Verbose = flag;
 }
   
+
+//---------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManager
+::addStartupTiming(const QString& step, const QString& name, double elapsedTime)
+{
+  Q_D(qSlicerAbstractModuleFactoryManager);
+  if (!d->StartupSteps.contains(step))
+    {
+    d->StartupSteps << step;
+    }
+  d->StartupTimings[step][name] += elapsedTime;
+}
+
+//---------------------------------------------------------------------------
+QVariantMap qSlicerAbstractModuleFactoryManager::startupTimings()const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  QVariantMap timings;
+  foreach(const QString& step, d->StartupSteps)
+    {
+    QVariantMap stepTimings;
+    const QMap<QString, double>& items = d->StartupTimings[step];
+    for (QMap<QString, double>::const_iterator it = items.constBegin();
+         it != items.constEnd(); ++it)
+      {
+      stepTimings[it.key()] = it.value();
+      }
+    timings[step] = stepTimings;
+    }
+  return timings;
+}
+
+//---------------------------------------------------------------------------
+QString qSlicerAbstractModuleFactoryManager::startupTimingsReport()const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  QString report;
+  QTextStream stream(&report);
+  stream.setRealNumberNotation(QTextStream::FixedNotation);
+  stream.setRealNumberPrecision(2);
+  foreach(const QString& step, d->StartupSteps)
+    {
+    QList<QPair<double, QString> > items;
+    double total = 0.;
+    const QMap<QString, double>& stepTimings = d->StartupTimings[step];
+    for (QMap<QString, double>::const_iterator it = stepTimings.constBegin();
+         it != stepTimings.constEnd(); ++it)
+      {
+      items << qMakePair(it.value(), it.key());
+      total += it.value();
+      }
+    std::stable_sort(items.begin(), items.end(), isMoreExpensive);
+    stream << step << ": " << total << " ms (" << items.count() << " items)\n";
+    for (int i = 0; i < items.count(); ++i)
+      {
+      stream << "  " << items[i].second << ": " << items[i].first << " ms\n";
+      }
+    }
+  return report;
+}
+
+//---------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManager::clearStartupTimings()
+{
+  Q_D(qSlicerAbstractModuleFactoryManager);
+  d->StartupTimings.clear();
+  d->StartupSteps.clear();
+}
@@ -24,6 +24,7 @@
 // Qt includes
 #include <QObject>
 #include <QString>
+#include <QVariantMap>
 
 // CTK includes
 #include <ctkAbstractFileBasedFactory.h>
@@ -179,6 +180,24 @@ public:
   /// \sa dependentModules(), qSlicerAbstractCoreModule::dependencies()
   QStringList moduleDependees(const QString& module)const;
 
+  /// Return the time (in ms) spent in each step of the module startup
+  /// process. The returned map associates a step name to a map of
+  /// (factory or module name, time in ms):
+  ///  - "factories": time spent by each factory to discover/register modules
+  ///  - "instantiate": time spent instantiating each module
+  ///  - "logic": time spent creating the logic of each module
+  ///  - "setup": time spent in the setup of each module
+  /// Times are accumulated if a step is run multiple times for the same item.
+  /// \sa startupTimingsReport(), clearStartupTimings()
+  Q_INVOKABLE QVariantMap startupTimings()const;
+
+  /// Return a human readable report of startupTimings() where, for each step,
+  /// items are sorted from the most to the least expensive.
+  Q_INVOKABLE QString startupTimingsReport()const;
+
+  /// Forget all the recorded startup timings.
+  Q_INVOKABLE void clearStartupTimings();
+
 signals:
   /// \brief This signal is emitted when all the modules associated with the
   /// registered factories have been loaded
@@ -217,6 +236,11 @@ protected:
   /// Uninstantiate a module given its \a moduleName
   virtual void uninstantiateModule(const QString& moduleName);
 
+  /// Accumulate \a elapsedTime (in ms) spent by \a name during the
+  /// startup step \a step.
+  /// \sa startupTimings()
+  void addStartupTiming(const QString& step, const QString& name, double elapsedTime);
+
 private:
   Q_DECLARE_PRIVATE(qSlicerAbstractModuleFactoryManager);
   Q_DISABLE_COPY(qSlicerAbstractModuleFactoryManager);
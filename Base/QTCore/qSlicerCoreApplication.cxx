@@ -253,6 +253,8 @@ void qSlicerCoreApplicationPrivate::init()
   // in MRMLApplicationLogic.
   //this->AppLogic->ProcessMRMLEvents(scene, vtkCommand::ModifiedEvent, NULL);
   //this->AppLogic->SetAndObserveMRMLScene(scene);
+  this->AppLogic->SetNumberOfProcessingThreads(
+    q->userSettings()->value("Modules/NumberOfProcessingThreads", 1).toInt());
   this->AppLogic->CreateProcessingThread();
 
   // Set up Slicer to use the system proxy
@@ -275,6 +275,20 @@ bool qSlicerCoreCommandOptions::verboseModuleDiscovery() const
   return d->ParsedArgs.value("verbose-module-discovery").toBool();
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCoreCommandOptions::profileStartup() const
+{
+  Q_D(const qSlicerCoreCommandOptions);
+  return d->ParsedArgs.value("profile-startup").toBool();
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreCommandOptions::lazyModuleLoading() const
+{
+  Q_D(const qSlicerCoreCommandOptions);
+  return d->ParsedArgs.value("lazy-module-loading").toBool();
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerCoreCommandOptions::verbose()const
 {
@@ -405,6 +419,12 @@ void qSlicerCoreCommandOptions::addArguments()
   this->addArgument("verbose-module-discovery", "", QVariant::Bool,
                     "Enable verbose output during module discovery process.");
 
+  this->addArgument("profile-startup", "", QVariant::Bool,
+                    "Display the time spent registering, instantiating and setting up each module.");
+
+  this->addArgument("lazy-module-loading", "", QVariant::Bool,
+                    "Defer the logic creation and setup of modules until they are first used.");
+
   this->addArgument("disable-settings", "", QVariant::Bool,
                     "Start application ignoring user settings.");
 
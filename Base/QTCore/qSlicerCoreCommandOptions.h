@@ -51,6 +51,8 @@ class Q_SLICER_BASE_QTCORE_EXPORT qSlicerCoreCommandOptions : public ctkCommandL
   Q_PROPERTY(bool displaySettingsPathAndExit READ displaySettingsPathAndExit)
   Q_PROPERTY(bool displayTemporaryPathAndExit READ displayTemporaryPathAndExit)
   Q_PROPERTY(bool verboseModuleDiscovery READ verboseModuleDiscovery)
+  Q_PROPERTY(bool profileStartup READ profileStartup)
+  Q_PROPERTY(bool lazyModuleLoading READ lazyModuleLoading)
   Q_PROPERTY(bool disableMessageHandlers READ disableMessageHandlers)
   Q_PROPERTY(bool testingEnabled READ isTestingEnabled)
 #ifdef Slicer_USE_PYTHONQT
@@ -137,6 +139,16 @@ public:
   /// Return True if slicer should display details regarding the module discovery process
   bool verboseModuleDiscovery()const;
 
+  /// Return True if slicer should display the time spent by each module
+  /// factory and in the instantiation, logic creation and setup of each module.
+  /// \sa qSlicerAbstractModuleFactoryManager::startupTimingsReport()
+  bool profileStartup()const;
+
+  /// Return True if the logic creation and setup of the modules not needed
+  /// at startup should be deferred until they are first used.
+  /// \sa qSlicerModuleFactoryManager::setLazyLoading()
+  bool lazyModuleLoading()const;
+
   /// Return True if slicer should display information at startup
   bool verbose()const;
 
@@ -30,6 +30,8 @@
 #include "qSlicerCoreIOManager.h"
 #include "qSlicerFileReader.h"
 #include "qSlicerFileWriter.h"
+#include "qSlicerModuleFactoryManager.h"
+#include "qSlicerModuleManager.h"
 
 // MRML includes
 #include <vtkMRMLNode.h>
@@ -223,6 +225,7 @@ qSlicerIO::IOFileType qSlicerCoreIOManager
 ::fileWriterFileType(vtkObject* object)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   QList<qSlicerIO::IOFileType> matchingFileTypes;
   foreach (const qSlicerFileWriter* writer, d->Writers)
     {
@@ -238,6 +241,7 @@ qSlicerIO::IOFileType qSlicerCoreIOManager
 QList<qSlicerIO::IOFileType> qSlicerCoreIOManager::fileTypes(const QString& fileName)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   QList<qSlicerIO::IOFileType> matchingFileTypes;
   foreach (const qSlicerIO* matchingReader, d->readers(fileName))
     {
@@ -250,6 +254,7 @@ QList<qSlicerIO::IOFileType> qSlicerCoreIOManager::fileTypes(const QString& file
 QStringList qSlicerCoreIOManager::fileDescriptions(const QString& fileName)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   QStringList matchingDescriptions;
   foreach(qSlicerFileReader* reader, d->readers(fileName))
     {
@@ -290,6 +295,7 @@ QStringList qSlicerCoreIOManager::fileWriterExtensions(
   vtkObject* object)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   QStringList matchingExtensions;
   foreach(qSlicerFileWriter* writer, d->Writers)
     {
@@ -320,6 +326,7 @@ qSlicerIOOptions* qSlicerCoreIOManager::fileWriterOptions(
   vtkObject* object, const QString& extension)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   qSlicerFileWriter* bestWriter = 0;
   foreach(qSlicerFileWriter* writer, d->Writers)
     {
@@ -466,6 +473,7 @@ bool qSlicerCoreIOManager::saveNodes(qSlicerIO::IOFileType fileType,
 
   Q_ASSERT(parameters.contains("fileName"));
 
+  this->initializeDeferredModules();
   // HACK - See http://www.na-mic.org/Bug/view.php?id=3322
   //        Sort writers to ensure generic ones are last.
   const QList<qSlicerFileWriter*> writers = d->writers(fileType, parameters);
@@ -503,6 +511,7 @@ bool qSlicerCoreIOManager::saveNodes(qSlicerIO::IOFileType fileType,
 const QList<qSlicerFileReader*>& qSlicerCoreIOManager::readers()const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   return d->Readers;
 }
 
@@ -510,6 +519,7 @@ const QList<qSlicerFileReader*>& qSlicerCoreIOManager::readers()const
 const QList<qSlicerFileWriter*>& qSlicerCoreIOManager::writers()const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   return d->Writers;
 }
 
@@ -517,6 +527,7 @@ const QList<qSlicerFileWriter*>& qSlicerCoreIOManager::writers()const
 QList<qSlicerFileReader*> qSlicerCoreIOManager::readers(const qSlicerIO::IOFileType& fileType)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   QList<qSlicerFileReader*> res;
   foreach(qSlicerFileReader* io, d->Readers)
     {
@@ -532,6 +543,7 @@ QList<qSlicerFileReader*> qSlicerCoreIOManager::readers(const qSlicerIO::IOFileT
 QList<qSlicerFileWriter*> qSlicerCoreIOManager::writers(const qSlicerIO::IOFileType& fileType)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   QList<qSlicerFileWriter*> res;
   foreach(qSlicerFileWriter* io, d->Writers)
     {
@@ -547,6 +559,7 @@ QList<qSlicerFileWriter*> qSlicerCoreIOManager::writers(const qSlicerIO::IOFileT
 qSlicerFileReader* qSlicerCoreIOManager::reader(const QString& ioDescription)const
 {
   Q_D(const qSlicerCoreIOManager);
+  this->initializeDeferredModules();
   QList<qSlicerFileReader*> res;
   foreach(qSlicerFileReader* io, d->Readers)
     {
@@ -559,6 +572,17 @@ qSlicerFileReader* qSlicerCoreIOManager::reader(const QString& ioDescription)con
   return res.count() ? res[0] : 0;
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::initializeDeferredModules()const
+{
+  qSlicerCoreApplication* app = qSlicerCoreApplication::application();
+  qSlicerModuleManager* moduleManager = app ? app->moduleManager() : 0;
+  if (moduleManager && moduleManager->factoryManager())
+    {
+    moduleManager->factoryManager()->initializeDeferredModules();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerCoreIOManager::registerIO(qSlicerIO* io)
 {
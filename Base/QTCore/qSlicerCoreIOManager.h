@@ -149,6 +149,12 @@ protected:
   QList<qSlicerFileReader*> readers(const qSlicerIO::IOFileType& fileType)const;
   qSlicerFileReader* reader(const QString& ioDescription)const;
 
+  /// Initialize the loaded modules whose initialization has been deferred,
+  /// they register their readers, writers and dialogs when they are set up.
+  /// It is called before the readers or writers are looked up.
+  /// \sa qSlicerModuleFactoryManager::setLazyLoading()
+  void initializeDeferredModules()const;
+
 protected:
   QScopedPointer<qSlicerCoreIOManagerPrivate> d_ptr;
 
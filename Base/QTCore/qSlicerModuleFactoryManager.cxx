@@ -18,10 +18,20 @@
 
 ==============================================================================*/
 
+// Qt includes
+#include <QElapsedTimer>
+
 // SlicerQt includes
 #include "qSlicerModuleFactoryManager.h"
 #include "qSlicerAbstractCoreModule.h"
 
+// MRML includes
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkSmartPointer.h>
+
 // STD includes
 #include <algorithm>
 
@@ -33,10 +43,21 @@ protected:
   qSlicerModuleFactoryManager* const q_ptr;
 public:
   qSlicerModuleFactoryManagerPrivate(qSlicerModuleFactoryManager& object);
+  ~qSlicerModuleFactoryManagerPrivate();
+
+  /// Observe the scene import/restore to initialize the deferred modules
+  void observeScene(vtkMRMLScene* oldScene, vtkMRMLScene* newScene);
+  static void onSceneEvent(vtkObject* caller, unsigned long eid,
+                           void* clientData, void* callData);
 
   QStringList LoadedModules;
   vtkSlicerApplicationLogic* AppLogic;
   vtkMRMLScene* MRMLScene;
+
+  bool LazyLoading;
+  QStringList EagerModules;
+  QStringList DeferredModules;
+  vtkSmartPointer<vtkCallbackCommand> SceneCallback;
 };
 
 //-----------------------------------------------------------------------------
@@ -47,6 +68,43 @@ qSlicerModuleFactoryManagerPrivate
 {
   this->AppLogic = 0;
   this->MRMLScene = 0;
+  this->LazyLoading = false;
+  this->SceneCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->SceneCallback->SetClientData(this);
+  this->SceneCallback->SetCallback(qSlicerModuleFactoryManagerPrivate::onSceneEvent);
+}
+
+//-----------------------------------------------------------------------------
+qSlicerModuleFactoryManagerPrivate::~qSlicerModuleFactoryManagerPrivate()
+{
+  this->observeScene(this->MRMLScene, 0);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerModuleFactoryManagerPrivate
+::observeScene(vtkMRMLScene* oldScene, vtkMRMLScene* newScene)
+{
+  if (oldScene)
+    {
+    oldScene->RemoveObserver(this->SceneCallback);
+    }
+  if (newScene)
+    {
+    newScene->AddObserver(vtkMRMLScene::StartImportEvent, this->SceneCallback);
+    newScene->AddObserver(vtkMRMLScene::StartRestoreEvent, this->SceneCallback);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerModuleFactoryManagerPrivate
+::onSceneEvent(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+               void* clientData, void* vtkNotUsed(callData))
+{
+  qSlicerModuleFactoryManagerPrivate* self =
+    reinterpret_cast<qSlicerModuleFactoryManagerPrivate*>(clientData);
+  // Nodes from the scene file may need node classes registered by the
+  // logic of any module.
+  self->q_func()->initializeDeferredModules();
 }
 
 //-----------------------------------------------------------------------------
@@ -146,7 +204,27 @@ bool qSlicerModuleFactoryManager::loadModule(const QString& name, const QString&
   d->LoadedModules << name;
 
   // Initialize module
-  instance->initialize(d->AppLogic);
+  bool deferInitialization = d->LazyLoading
+    && !d->EagerModules.contains(name)
+    && !instance->isHidden();
+  if (deferInitialization)
+    {
+    // The logic is not created, only the application logic is passed.
+    instance->setAppLogic(d->AppLogic);
+    d->DeferredModules << name;
+    // The module is initialized when its logic or widget is first needed.
+    QObject::connect(instance, SIGNAL(initializationRequested()),
+                     this, SLOT(onModuleInitializationRequested()));
+    }
+  else
+    {
+    // Dependencies loaded before this module may have been deferred.
+    foreach(const QString& dependency, instance->dependencies())
+      {
+      this->initializeModule(dependency);
+      }
+    this->initializeModuleInstance(instance);
+    }
 
   // Check the module has a title (required)
   if (instance->title().isEmpty())
@@ -221,6 +299,7 @@ void qSlicerModuleFactoryManager::unloadModule(const QString& name)
     }
   emit this->moduleAboutToBeUnloaded(name);
   d->LoadedModules.removeOne(name);
+  d->DeferredModules.removeOne(name);
   this->uninstantiateModule(name);
   emit this->moduleUnloaded(name);
 }
@@ -283,6 +362,7 @@ vtkSlicerApplicationLogic* qSlicerModuleFactoryManager::appLogic()const
 void qSlicerModuleFactoryManager::setMRMLScene(vtkMRMLScene* scene)
 {
   Q_D(qSlicerModuleFactoryManager);
+  d->observeScene(d->MRMLScene, scene);
   d->MRMLScene = scene;
   emit mrmlSceneChanged(d->MRMLScene);
 }
@@ -293,3 +373,107 @@ vtkMRMLScene* qSlicerModuleFactoryManager::mrmlScene()const
   Q_D(const qSlicerModuleFactoryManager);
   return d->MRMLScene;
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerModuleFactoryManager::setLazyLoading(bool lazy)
+{
+  Q_D(qSlicerModuleFactoryManager);
+  d->LazyLoading = lazy;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerModuleFactoryManager::lazyLoading()const
+{
+  Q_D(const qSlicerModuleFactoryManager);
+  return d->LazyLoading;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerModuleFactoryManager::setEagerModules(const QStringList& moduleNames)
+{
+  Q_D(qSlicerModuleFactoryManager);
+  d->EagerModules = moduleNames;
+}
+
+//-----------------------------------------------------------------------------
+QStringList qSlicerModuleFactoryManager::eagerModules()const
+{
+  Q_D(const qSlicerModuleFactoryManager);
+  return d->EagerModules;
+}
+
+//-----------------------------------------------------------------------------
+QStringList qSlicerModuleFactoryManager::deferredModuleNames()const
+{
+  Q_D(const qSlicerModuleFactoryManager);
+  return d->DeferredModules;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerModuleFactoryManager::initializeModule(const QString& name)
+{
+  Q_D(qSlicerModuleFactoryManager);
+  if (!this->isLoaded(name))
+    {
+    return false;
+    }
+  if (!d->DeferredModules.contains(name))
+    {
+    return true;
+    }
+  d->DeferredModules.removeOne(name);
+  qSlicerAbstractCoreModule* instance = this->moduleInstance(name);
+  Q_ASSERT(instance);
+  QObject::disconnect(instance, SIGNAL(initializationRequested()),
+                      this, SLOT(onModuleInitializationRequested()));
+  foreach(const QString& dependency, instance->dependencies())
+    {
+    this->initializeModule(dependency);
+    }
+  if (this->Superclass::isVerbose())
+    {
+    qDebug() << "Initializing deferred module" << name;
+    }
+  this->initializeModuleInstance(instance);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerModuleFactoryManager::onModuleInitializationRequested()
+{
+  qSlicerAbstractCoreModule* instance =
+    qobject_cast<qSlicerAbstractCoreModule*>(this->sender());
+  if (instance)
+    {
+    this->initializeModule(instance->name());
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerModuleFactoryManager::initializeDeferredModules()
+{
+  Q_D(qSlicerModuleFactoryManager);
+  // initializeModule() may initialize more than one module at a time
+  while (!d->DeferredModules.isEmpty())
+    {
+    this->initializeModule(d->DeferredModules.first());
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerModuleFactoryManager::initializeModuleInstance(qSlicerAbstractCoreModule* instance)
+{
+  Q_D(qSlicerModuleFactoryManager);
+  // Same as qSlicerAbstractCoreModule::initialize() but timed.
+  QElapsedTimer timer;
+  timer.start();
+  instance->setAppLogic(d->AppLogic);
+  instance->logic();
+  this->addStartupTiming("logic", instance->name(),
+                         static_cast<double>(timer.nsecsElapsed()) / 1000000.);
+  timer.restart();
+  // logic() is a no-op now that the logic exists.
+  instance->initialize(d->AppLogic);
+  this->addStartupTiming("setup", instance->name(),
+                         static_cast<double>(timer.nsecsElapsed()) / 1000000.);
+}
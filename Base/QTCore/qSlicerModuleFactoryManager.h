@@ -69,6 +69,10 @@ public:
 
   /// Return the loaded module identified by \a name, 0 if no module
   /// has been loaded yet, even if the module has been instantiated.
+  /// Looking up a module does not initialize it when its initialization is
+  /// deferred: its metadata (title, categories, icon...) can be used
+  /// without creating its logic.
+  /// \sa setLazyLoading()
   Q_INVOKABLE qSlicerAbstractCoreModule* loadedModule(const QString& name)const;
 
   /// Set the application logic to pass to modules at "load" time.
@@ -82,10 +86,47 @@ public:
   /// \todo move it as protected
   bool loadModule(const QString& name);
 
+  /// If enabled, the logic creation and setup of the loaded modules are
+  /// deferred until the logic or the widget representation of the module is
+  /// first requested (e.g. when the module is selected), unless the module is
+  /// hidden, is listed in \a eagerModules or is a dependency of an initialized
+  /// module. All the deferred modules are initialized when the scene starts
+  /// importing or restoring nodes, and before the IO manager looks up its
+  /// readers, writers or dialogs, to make sure the node classes and readers
+  /// they provide are available.
+  /// The launch cost then grows with the number of modules actually used.
+  /// Must be set before loadModules() is called. False by default.
+  /// \sa initializeModule(), deferredModuleNames(),
+  /// qSlicerCoreIOManager::initializeDeferredModules()
+  void setLazyLoading(bool lazy);
+  bool lazyLoading()const;
+
+  /// Modules that are always initialized at load time when lazyLoading is
+  /// enabled. Typically the startup (home) module.
+  void setEagerModules(const QStringList& moduleNames);
+  QStringList eagerModules()const;
+
+  /// Return the list of loaded modules whose initialization (logic creation
+  /// and setup) has been deferred and has not happened yet.
+  Q_INVOKABLE QStringList deferredModuleNames()const;
+
+  /// Initialize the loaded module \a name (and its dependencies) if its
+  /// initialization has been deferred. No-op otherwise.
+  /// Return false if the module is not loaded.
+  /// \sa setLazyLoading()
+  Q_INVOKABLE bool initializeModule(const QString& name);
+
+  /// Initialize all the deferred modules.
+  Q_INVOKABLE void initializeDeferredModules();
+
 public slots:
   /// Set the MRML scene to pass to modules at "load" time.
   void setMRMLScene(vtkMRMLScene* mrmlScene);
 
+protected slots:
+  /// Initialize the deferred module that emitted initializationRequested()
+  void onModuleInitializationRequested();
+
 signals:
 
   void modulesLoaded(const QStringList& modulesNames);
@@ -106,6 +147,10 @@ protected:
   /// Unload module identified by \a name
   void unloadModule(const QString& name);
 
+  /// Create the logic of \a module and set it up, recording the time spent
+  /// in each step.
+  void initializeModuleInstance(qSlicerAbstractCoreModule* module);
+
   /// Uninstantiate a module given its \a moduleName
   virtual void uninstantiateModule(const QString& moduleName);
 
@@ -52,7 +52,10 @@ public:
   /// Return the list of all the loaded modules
   Q_INVOKABLE QStringList modulesNames()const;
 
-  /// Return the loaded module identified by \a name
+  /// Return the loaded module identified by \a name.
+  /// It does not initialize a module whose initialization is deferred, the
+  /// module is initialized when its logic or widget is first requested.
+  /// \sa qSlicerModuleFactoryManager::setLazyLoading()
   Q_INVOKABLE qSlicerAbstractCoreModule* module(const QString& name)const;
 
 signals:
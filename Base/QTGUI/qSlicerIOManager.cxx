@@ -234,6 +234,7 @@ bool qSlicerIOManager::openDialog(qSlicerIO::IOFileType fileType,
                                   vtkCollection* loadedNodes)
 {
   Q_D(qSlicerIOManager);
+  this->initializeDeferredModules();
   bool deleteDialog = false;
   if (properties["objectName"].toString().isEmpty())
     {
@@ -273,6 +274,8 @@ bool qSlicerIOManager::openDialog(qSlicerIO::IOFileType fileType,
 void qSlicerIOManager::dragEnterEvent(QDragEnterEvent *event)
 {
   Q_D(qSlicerIOManager);
+  // The modules register their dialogs when they are set up
+  this->initializeDeferredModules();
   foreach(qSlicerFileDialog* dialog, d->ReadDialogs)
     {
     if (dialog->isMimeDataAccepted(event->mimeData()))
@@ -287,6 +290,7 @@ void qSlicerIOManager::dragEnterEvent(QDragEnterEvent *event)
 void qSlicerIOManager::dropEvent(QDropEvent *event)
 {
   Q_D(qSlicerIOManager);
+  this->initializeDeferredModules();
   QStringList supportedReaders;
   QStringList genericReaders; // those must be last in the choice menu
   foreach(qSlicerFileDialog* dialog, d->ReadDialogs)
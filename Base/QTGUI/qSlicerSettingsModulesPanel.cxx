@@ -118,6 +118,7 @@ void qSlicerSettingsModulesPanelPrivate::init()
 
   // Default values
   this->PreferExecutableCLICheckBox->setChecked(false);
+  this->NumberOfProcessingThreadsSpinBox->setValue(1);
   this->TemporaryDirectoryButton->setDirectory(coreApp->defaultTemporaryPath());
   this->DisableModulesListView->setFactoryManager( factoryManager );
   this->FavoritesModulesListView->setFactoryManager( factoryManager );
@@ -143,6 +144,9 @@ void qSlicerSettingsModulesPanelPrivate::init()
 
   q->registerProperty("Modules/PreferExecutableCLI", this->PreferExecutableCLICheckBox,
                       "checked", SIGNAL(toggled(bool)));
+  q->registerProperty("Modules/NumberOfProcessingThreads", this->NumberOfProcessingThreadsSpinBox,
+                      "value", SIGNAL(valueChanged(int)),
+                      "Number of processing threads", ctkSettingsPanel::OptionRequireRestart);
   q->registerProperty("Modules/HomeModule", this->ModulesMenu,
                       "currentModule", SIGNAL(currentModuleChanged(QString)));
   q->registerProperty("Modules/FavoriteModules", this->FavoritesModulesListView->filterModel(),
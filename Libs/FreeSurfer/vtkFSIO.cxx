@@ -18,6 +18,20 @@
 // VTK includes
 #include <vtkByteSwap.h>
 
+// STD includes
+#include <cstring>
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+# define VTK_FSIO_WIN32_MAPPING
+# include <windows.h>
+#else
+# define VTK_FSIO_POSIX_MAPPING
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
 //------------------------------------------------------------------------------
 int vtkFSIO::ReadShort (FILE* iFile, short& oShort) {
 
@@ -201,3 +215,269 @@ int vtkFSIO::WriteInt2 (FILE* oFile, int iInt)
 
     return result;
 }
+
+//------------------------------------------------------------------------------
+// Bulk reads
+
+//------------------------------------------------------------------------------
+size_t vtkFSIO::ReadInts (FILE* iFile, int* oInts, size_t iCount)
+{
+  size_t result = fread (oInts, sizeof(int), iCount, iFile);
+  vtkByteSwap::Swap4BERange (oInts, static_cast<vtkIdType>(result));
+  return result;
+}
+
+//------------------------------------------------------------------------------
+size_t vtkFSIO::ReadFloats (FILE* iFile, float* oFloats, size_t iCount)
+{
+  size_t result = fread (oFloats, sizeof(float), iCount, iFile);
+  vtkByteSwap::Swap4BERange (oFloats, static_cast<vtkIdType>(result));
+  return result;
+}
+
+//------------------------------------------------------------------------------
+void vtkFSIO::DecodeInts (const unsigned char* iBlock, int* oInts, size_t iCount)
+{
+  for (size_t i = 0; i < iCount; ++i)
+    {
+    oInts[i] = vtkFSIO::DecodeInt (iBlock + 4 * i);
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkFSIO::DecodeInt3s (const unsigned char* iBlock, int* oInts, size_t iCount)
+{
+  for (size_t i = 0; i < iCount; ++i)
+    {
+    oInts[i] = vtkFSIO::DecodeInt3 (iBlock + 3 * i);
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkFSIO::DecodeInt2s (const unsigned char* iBlock, int* oInts, size_t iCount)
+{
+  for (size_t i = 0; i < iCount; ++i)
+    {
+    oInts[i] = vtkFSIO::DecodeInt2 (iBlock + 2 * i);
+    }
+}
+
+//------------------------------------------------------------------------------
+float vtkFSIO::DecodeFloat (const unsigned char* iBytes)
+{
+  int i = vtkFSIO::DecodeInt (iBytes);
+  float f;
+  memcpy (&f, &i, sizeof(float));
+  return f;
+}
+
+//------------------------------------------------------------------------------
+void vtkFSIO::DecodeFloats (const unsigned char* iBlock, float* oFloats, size_t iCount)
+{
+  // The values may not be aligned in the block: copy them first then
+  // swap them in place.
+  memcpy (oFloats, iBlock, iCount * sizeof(float));
+  vtkByteSwap::Swap4BERange (oFloats, static_cast<vtkIdType>(iCount));
+}
+
+//------------------------------------------------------------------------------
+vtkFSIO::BlockReader::BlockReader()
+{
+  this->Data = 0;
+  this->Size = 0;
+  this->Position = 0;
+  this->Mapping = 0;
+  this->MappingHandle = 0;
+}
+
+//------------------------------------------------------------------------------
+vtkFSIO::BlockReader::~BlockReader()
+{
+  this->Close();
+}
+
+//------------------------------------------------------------------------------
+bool vtkFSIO::BlockReader::Open (const char* iFileName)
+{
+  this->Close();
+  if (!iFileName)
+    {
+    return false;
+    }
+
+#if defined(VTK_FSIO_POSIX_MAPPING)
+  int fd = open (iFileName, O_RDONLY);
+  if (fd < 0)
+    {
+    return false;
+    }
+  struct stat fileStat;
+  if (fstat (fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+    void* mapping = mmap (0, static_cast<size_t>(fileStat.st_size),
+                          PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED)
+      {
+      // The surfaces are read from start to end
+      madvise (mapping, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+      this->Mapping = mapping;
+      this->Data = static_cast<const unsigned char*>(mapping);
+      this->Size = static_cast<size_t>(fileStat.st_size);
+      }
+    }
+  // The mapping stays valid after the file is closed
+  close (fd);
+#elif defined(VTK_FSIO_WIN32_MAPPING)
+  HANDLE file = CreateFileA (iFileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    {
+    return false;
+    }
+  LARGE_INTEGER fileSize;
+  if (GetFileSizeEx (file, &fileSize) && fileSize.QuadPart > 0)
+    {
+    HANDLE mappingHandle = CreateFileMappingA (file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle != NULL)
+      {
+      void* mapping = MapViewOfFile (mappingHandle, FILE_MAP_READ, 0, 0, 0);
+      if (mapping != NULL)
+        {
+        this->Mapping = mapping;
+        this->MappingHandle = mappingHandle;
+        this->Data = static_cast<const unsigned char*>(mapping);
+        this->Size = static_cast<size_t>(fileSize.QuadPart);
+        }
+      else
+        {
+        CloseHandle (mappingHandle);
+        }
+      }
+    }
+  CloseHandle (file);
+#endif
+
+  if (this->Mapping)
+    {
+    return true;
+    }
+
+  // No mapping: read the whole file at once
+  FILE* file = fopen (iFileName, "rb");
+  if (!file)
+    {
+    return false;
+    }
+  unsigned char block[65536];
+  size_t read;
+  while ((read = fread (block, 1, sizeof(block), file)) > 0)
+    {
+    this->Buffer.insert (this->Buffer.end(), block, block + read);
+    }
+  fclose (file);
+  this->Data = this->Buffer.empty() ? 0 : &this->Buffer[0];
+  this->Size = this->Buffer.size();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkFSIO::BlockReader::Close ()
+{
+  if (this->Mapping)
+    {
+#if defined(VTK_FSIO_POSIX_MAPPING)
+    munmap (this->Mapping, this->Size);
+#elif defined(VTK_FSIO_WIN32_MAPPING)
+    UnmapViewOfFile (this->Mapping);
+    CloseHandle (static_cast<HANDLE>(this->MappingHandle));
+#endif
+    }
+  this->Mapping = 0;
+  this->MappingHandle = 0;
+  std::vector<unsigned char>().swap (this->Buffer);
+  this->Data = 0;
+  this->Size = 0;
+  this->Position = 0;
+}
+
+//------------------------------------------------------------------------------
+bool vtkFSIO::BlockReader::Skip (size_t iBytes)
+{
+  if (iBytes > this->GetRemaining())
+    {
+    return false;
+    }
+  this->Position += iBytes;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkFSIO::BlockReader::SkipLine (size_t iMaximumLength)
+{
+  // fgets: up to and including the end of line
+  size_t length = 0;
+  while (this->Position < this->Size && length + 1 < iMaximumLength)
+    {
+    ++length;
+    if (this->Data[this->Position++] == '\n')
+      {
+      break;
+      }
+    }
+  // fscanf (file, "\n"): any white space
+  while (this->Position < this->Size &&
+         (this->Data[this->Position] == ' ' ||
+          (this->Data[this->Position] >= '\t' && this->Data[this->Position] <= '\r')))
+    {
+    ++this->Position;
+    }
+  return this->Position < this->Size;
+}
+
+//------------------------------------------------------------------------------
+bool vtkFSIO::BlockReader::ReadInts (int* oInts, size_t iCount)
+{
+  if (iCount > this->GetRemaining() / 4)
+    {
+    return false;
+    }
+  vtkFSIO::DecodeInts (this->GetPointer(), oInts, iCount);
+  this->Position += 4 * iCount;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkFSIO::BlockReader::ReadInt3s (int* oInts, size_t iCount)
+{
+  if (iCount > this->GetRemaining() / 3)
+    {
+    return false;
+    }
+  vtkFSIO::DecodeInt3s (this->GetPointer(), oInts, iCount);
+  this->Position += 3 * iCount;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkFSIO::BlockReader::ReadInt2s (int* oInts, size_t iCount)
+{
+  if (iCount > this->GetRemaining() / 2)
+    {
+    return false;
+    }
+  vtkFSIO::DecodeInt2s (this->GetPointer(), oInts, iCount);
+  this->Position += 2 * iCount;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkFSIO::BlockReader::ReadFloats (float* oFloats, size_t iCount)
+{
+  if (iCount > this->GetRemaining() / 4)
+    {
+    return false;
+    }
+  vtkFSIO::DecodeFloats (this->GetPointer(), oFloats, iCount);
+  this->Position += 4 * iCount;
+  return true;
+}
@@ -21,7 +21,9 @@
 #include <vtk_zlib.h>
 
 // STD includes
+#include <cstddef>
 #include <cstdio>
+#include <vector>
 
 /// \brief Some IO functions for irregular FreeSurface files.
 ///
@@ -47,6 +49,88 @@ namespace vtkFSIO {
   int VTK_FreeSurfer_EXPORT WriteInt (FILE* iFile, int iInt);
   int VTK_FreeSurfer_EXPORT WriteInt3 (FILE* iFile, int iInt);
   int VTK_FreeSurfer_EXPORT WriteInt2 (FILE* iFile, int iInt);
+
+  /// Read iCount big endian values at once. Return the number of
+  /// values read.
+  size_t VTK_FreeSurfer_EXPORT ReadInts (FILE* iFile, int* oInts, size_t iCount);
+  size_t VTK_FreeSurfer_EXPORT ReadFloats (FILE* iFile, float* oFloats, size_t iCount);
+
+  /// Decode iCount big endian values stored contiguously in iBlock.
+  /// The loops have no dependency between values so that the compiler
+  /// can vectorize them.
+  void VTK_FreeSurfer_EXPORT DecodeInts (const unsigned char* iBlock, int* oInts, size_t iCount);
+  void VTK_FreeSurfer_EXPORT DecodeInt3s (const unsigned char* iBlock, int* oInts, size_t iCount);
+  void VTK_FreeSurfer_EXPORT DecodeInt2s (const unsigned char* iBlock, int* oInts, size_t iCount);
+  void VTK_FreeSurfer_EXPORT DecodeFloats (const unsigned char* iBlock, float* oFloats, size_t iCount);
+
+  /// Decode a single big endian value.
+  inline int DecodeInt (const unsigned char* iBytes)
+    {
+    return static_cast<int>(
+      (static_cast<unsigned int>(iBytes[0]) << 24) |
+      (static_cast<unsigned int>(iBytes[1]) << 16) |
+      (static_cast<unsigned int>(iBytes[2]) << 8) |
+      static_cast<unsigned int>(iBytes[3]));
+    }
+  inline int DecodeInt3 (const unsigned char* iBytes)
+    {
+    return (iBytes[0] << 16) | (iBytes[1] << 8) | iBytes[2];
+    }
+  inline int DecodeInt2 (const unsigned char* iBytes)
+    {
+    return static_cast<short>((iBytes[0] << 8) | iBytes[1]);
+    }
+  float VTK_FreeSurfer_EXPORT DecodeFloat (const unsigned char* iBytes);
+
+  /// \brief Sequential reader of a whole file.
+  ///
+  /// The file is memory mapped where available (POSIX and Windows),
+  /// otherwise it is read at once into memory. The Read methods decode
+  /// blocks of big endian values; they return false and don't move if
+  /// the file is too short. A BlockReader doesn't share any state with
+  /// other instances, different files can be read concurrently.
+  class VTK_FreeSurfer_EXPORT BlockReader
+  {
+  public:
+    BlockReader();
+    ~BlockReader();
+
+    /// Return false if the file can't be opened
+    bool Open (const char* iFileName);
+    void Close ();
+
+    size_t GetSize () const { return this->Size; }
+    size_t GetPosition () const { return this->Position; }
+    /// Number of bytes after the current position
+    size_t GetRemaining () const { return this->Size - this->Position; }
+    /// Current position in the file, NULL if closed
+    const unsigned char* GetPointer () const { return this->Data + this->Position; }
+
+    /// Move the position by iBytes. Return false if it is past the end.
+    bool Skip (size_t iBytes);
+    /// Skip a line of text and the white spaces that follow it, as
+    /// fgets followed by fscanf(file, "\n") would.
+    bool SkipLine (size_t iMaximumLength);
+
+    bool ReadInts (int* oInts, size_t iCount = 1);
+    bool ReadInt3s (int* oInts, size_t iCount = 1);
+    bool ReadInt2s (int* oInts, size_t iCount = 1);
+    bool ReadFloats (float* oFloats, size_t iCount = 1);
+
+  protected:
+    const unsigned char* Data;
+    size_t Size;
+    size_t Position;
+    /// Content of the file when it is not mapped
+    std::vector<unsigned char> Buffer;
+    /// Platform specific handles of the mapping
+    void* Mapping;
+    void* MappingHandle;
+
+  private:
+    BlockReader(const BlockReader&);  /// Not implemented.
+    void operator=(const BlockReader&);  /// Not implemented.
+  };
 }
 
 #endif
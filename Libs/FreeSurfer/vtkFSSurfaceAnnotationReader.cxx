@@ -21,6 +21,9 @@
 #include <vtkLookupTable.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <vector>
+
 //-------------------------------------------------------------------------
 vtkStandardNewMacro(vtkFSSurfaceAnnotationReader);
 
@@ -149,45 +152,27 @@ int vtkFSSurfaceAnnotationReader::ReadFSAnnotation()
   // table stuff.
   totalSteps = numLabels*2;
 
+  // The vertex index and rgb value pairs are read at once.
+  std::vector<int> pairs (2 * static_cast<size_t>(numLabels));
+  if (vtkFSIO::ReadInts (annotFile, &pairs[0], pairs.size()) != pairs.size())
+  {
+      vtkErrorMacro (<< "\nReadFSAnnotation: unexpected EOF, expected\n "
+                     << numLabels << " values.");
+      fclose (annotFile);
+      free (rgbs);
+      free (labels);
+      return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
+  }
   for (labelIndex = 0; labelIndex < numLabels; labelIndex ++ )
   {
-      if (feof (annotFile) )
-      {
-          vtkErrorMacro (<< "\nReadFSAnnotation: unexpected EOF after\n "
-                         << numLabels << " values read.");
-          fclose (annotFile);
-          free (rgbs);
-          free (labels);
-          return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
-      }
-
-      // Read a vertex index and an rgb value. Set the appropriate
-      // value in the rgb array.
-      read = vtkFSIO::ReadInt (annotFile, vertexIndex);
-      if (read != 1)
-      {
-          vtkErrorMacro (<< "\nReadFSAnnotation: error reading vertex index at\n"
-                         << labelIndex);
-          fclose (annotFile);
-          free (rgbs);
-          free (labels);
-          return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
-      }
-      read = vtkFSIO::ReadInt (annotFile, rgb);
-      if (read != 1)
-      {
-          vtkErrorMacro (<< "\nReadFSAnnotation: error reading rgb value at\n"
-                         << labelIndex);
-          fclose (annotFile);
-          free (rgbs);
-          free (labels);
-          return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
-      }
+      // Set the appropriate value in the rgb array.
+      vertexIndex = pairs[2 * labelIndex];
+      rgb = pairs[2 * labelIndex + 1];
       if (labelIndex < 100)
       {
           vtkDebugMacro(<< "ReadFSAnnotation: Read vertex # " << vertexIndex << " rgb = " << rgb << endl);
       }
-      if (vertexIndex >= numLabels)
+      if (vertexIndex < 0 || vertexIndex >= numLabels)
         {
         vtkErrorMacro("ReadFSAnnotation: Read vertex # " << vertexIndex << " is out of bounds! Not in 0 to " << numLabels << " -1, rgb = " << rgb << endl);
         }
@@ -195,12 +180,9 @@ int vtkFSSurfaceAnnotationReader::ReadFSAnnotation()
         {
         rgbs[vertexIndex] = rgb;
         }
-    thisStep++;
-    if (thisStep % 1000 == 0)
-    {
-        this->UpdateProgress(1.0*thisStep/totalSteps);
-    }
   }
+  thisStep += numLabels;
+  this->UpdateProgress(1.0*thisStep/totalSteps);
 
 
   // Are we using an embedded or an external color table?
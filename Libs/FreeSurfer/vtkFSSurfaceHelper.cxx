@@ -12,9 +12,67 @@
 
 =========================================================================auto=*/
 #include "vtkFSSurfaceHelper.h"
+#include "vtkFSSurfaceReader.h"
+#include "vtkFSSurfaceScalarReader.h"
+#include "vtkFSSurfaceWFileReader.h"
 
+#include <vtkCollection.h>
 #include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
 #include <vtkObjectFactory.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+//-------------------------------------------------------------------------
+struct ReadInParallelData
+{
+  std::vector<vtkObject*> Readers;
+  /// 1 if the reader failed, one element per reader so that the
+  /// threads don't write the same memory
+  std::vector<int> Failures;
+};
+
+//-------------------------------------------------------------------------
+bool readFile(vtkObject* object)
+{
+  if (vtkFSSurfaceReader* surfaceReader = vtkFSSurfaceReader::SafeDownCast(object))
+    {
+    surfaceReader->Update();
+    vtkPolyData* output = surfaceReader->GetOutput();
+    return output && output->GetNumberOfPoints() > 0;
+    }
+  if (vtkFSSurfaceScalarReader* scalarReader = vtkFSSurfaceScalarReader::SafeDownCast(object))
+    {
+    return scalarReader->ReadFSScalars() != 0;
+    }
+  if (vtkFSSurfaceWFileReader* wFileReader = vtkFSSurfaceWFileReader::SafeDownCast(object))
+    {
+    return wFileReader->ReadWFile() == vtkFSSurfaceWFileReader::FS_ERROR_W_NONE;
+    }
+  return false;
+}
+
+//-------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE readFilesThreaderCallback(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ReadInParallelData* data = static_cast<ReadInParallelData*>(info->UserData);
+  // Readers are interleaved between threads: a thread reads the
+  // surfaces of a hemisphere while another reads the other one.
+  for (size_t i = info->ThreadID; i < data->Readers.size(); i += info->NumberOfThreads)
+    {
+    data->Failures[i] = readFile(data->Readers[i]) ? 0 : 1;
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
 
 //-------------------------------------------------------------------------
 //----------------------------------------------------------------------------
@@ -145,3 +203,39 @@ void vtkFSSurfaceHelper
   T->Delete();
   Sinv->Delete();
 }
+
+//-------------------------------------------------------------------------
+int vtkFSSurfaceHelper::ReadInParallel(vtkCollection* readers, int numberOfThreads)
+{
+  if (!readers)
+    {
+    return 0;
+    }
+  ReadInParallelData data;
+  vtkObject* reader = 0;
+  vtkCollectionSimpleIterator it;
+  for (readers->InitTraversal(it); (reader = readers->GetNextItemAsObject(it));)
+    {
+    data.Readers.push_back(reader);
+    }
+  if (data.Readers.empty())
+    {
+    return 0;
+    }
+  data.Failures.resize(data.Readers.size(), 0);
+
+  if (numberOfThreads <= 0)
+    {
+    numberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  numberOfThreads = std::max(1, std::min(numberOfThreads,
+                                         static_cast<int>(data.Readers.size())));
+
+  vtkMultiThreader* threader = vtkMultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(readFilesThreaderCallback, &data);
+  threader->SingleMethodExecute();
+  threader->Delete();
+
+  return static_cast<int>(std::count(data.Failures.begin(), data.Failures.end(), 1));
+}
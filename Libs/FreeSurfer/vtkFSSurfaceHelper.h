@@ -20,6 +20,7 @@
 // VTK includes
 #include <vtkObject.h>
 
+class vtkCollection;
 class vtkMatrix4x4;
 
 /// \brief Provides tools.
@@ -40,6 +41,16 @@ public:
     double* V2Spacing, int* V2Dim, vtkMatrix4x4* V2RASToIJKMatrix,
     vtkMatrix4x4 *FSRegistrationMatrix, vtkMatrix4x4 *RAS2RASMatrix);
 
+  /// Read concurrently the files of a collection of vtkFSSurfaceReader,
+  /// vtkFSSurfaceScalarReader and vtkFSSurfaceWFileReader, e.g. the
+  /// pial and white surfaces of both hemispheres and their overlays.
+  /// The readers must have their file name and output set, they are
+  /// distributed among at most \a numberOfThreads threads (0 for the
+  /// number of processors). Progress events are invoked from the
+  /// reading threads.
+  /// Return the number of readers that failed.
+  static int ReadInParallel(vtkCollection* readers, int numberOfThreads = 0);
+
 protected:
   vtkFSSurfaceHelper();
 };
@@ -24,10 +24,6 @@
 /// Prints debugging info.
 #define FS_DEBUG 0
 
-/// This code can calc normals but it doesn't seem to do so very well
-/// (bug?) and vtkPolyDataNormals does it anyway.
-#define FS_CALC_NORMALS 0
-
 class vtkInformation;
 class vtkInformationVector;
 class vtkPolyData;
@@ -36,6 +32,11 @@ class vtkPolyData;
 ///
 /// Reads a surface file from FreeSurfer and output PolyData. Use the
 /// SetFileName function to specify the file name.
+///
+/// The file is memory mapped and the vertices and faces are decoded by
+/// blocks directly into the output arrays. Normals are not computed,
+/// use vtkPolyDataNormals. Readers don't share any state: several
+/// surfaces can be read concurrently, see vtkFSSurfaceHelper::ReadInParallel.
 class VTK_FreeSurfer_EXPORT vtkFSSurfaceReader : public vtkDataReader
 {
 public:
@@ -84,22 +85,4 @@ private:
   void operator=(const vtkFSSurfaceReader&);  /// Not implemented.
 };
 
-
-/// If we're going to try to do normals, we need to keep some
-/// connectivity information for the verts and faces. Use these
-/// structures.
-#if FS_CALC_NORMALS
-typedef struct {
-  int numFaces;
-  int faces[FS_MAX_NUM_FACES_PER_VERTEX];
-  int indicesInFace[FS_MAX_NUM_FACES_PER_VERTEX];
-  float x, y, z;
-  float nx, ny, nz;
-} Vertex;
-
-typedef struct {
-  int vertices[FS_NUM_SIDES_IN_FACE];
-} Face;
-#endif
-
 #endif
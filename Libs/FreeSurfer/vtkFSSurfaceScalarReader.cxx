@@ -17,10 +17,12 @@
 #include "vtkFSSurfaceScalarReader.h"
 
 // VTK includes
-#include <vtkByteSwap.h>
 #include <vtkFloatArray.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <vector>
+
 //-------------------------------------------------------------------------
 vtkStandardNewMacro(vtkFSSurfaceScalarReader);
 
@@ -50,14 +52,10 @@ void vtkFSSurfaceScalarReader::SetOutput(vtkFloatArray *output)
 //-------------------------------------------------------------------------
 int vtkFSSurfaceScalarReader::ReadFSScalars()
 {
-  FILE* scalarFile;
-  int magicNumber;
+  int magicNumber = 0;
   int numValues = 0;
   int numFaces = 0;
   int numValuesPerPoint = 0;
-  int vIndex;
-  int ivalue;
-  float fvalue;
   float *FSscalars;
   vtkFloatArray *output = this->Scalars;
 
@@ -75,9 +73,10 @@ int vtkFSSurfaceScalarReader::ReadFSScalars()
 
   vtkDebugMacro(<<"Reading surface scalar data...");
 
-  // Try to open the file.
-  scalarFile = fopen(this->FileName, "rb") ;
-  if (!scalarFile) {
+  // Try to open the file. The values are decoded by blocks from the
+  // mapped file.
+  vtkFSIO::BlockReader scalarFile;
+  if (!scalarFile.Open(this->FileName)) {
     vtkErrorMacro (<< "Could not open file " << this->FileName);
     return 0;
   }
@@ -89,34 +88,18 @@ int vtkFSSurfaceScalarReader::ReadFSScalars()
   // and assume it's a magic number, check and assign it to the number
   // of values if not. New style files also have a number of faces and
   // values per point, which aren't really used.
-  vtkFSIO::ReadInt3 (scalarFile, magicNumber);
+  scalarFile.ReadInt3s (&magicNumber);
   if (this->FS_NEW_SCALAR_MAGIC_NUMBER == magicNumber)
     {
-    size_t retval;
-    retval = fread (&numValues, sizeof(int), 1, scalarFile);
-    if (retval == 1)
-      {
-      vtkByteSwap::Swap4BE (&numValues);
-      }
-    else
+    if (!scalarFile.ReadInts (&numValues))
       {
       vtkErrorMacro("Error reading number of values from file " << this->FileName);
       }
-    retval = fread (&numFaces, sizeof(int), 1, scalarFile);
-    if (retval == 1)
-      {
-      vtkByteSwap::Swap4BE (&numFaces);
-      }
-    else
+    if (!scalarFile.ReadInts (&numFaces))
       {
       vtkErrorMacro("Error reading number of faces from file " << this->FileName);
       }
-    retval = fread (&numValuesPerPoint, sizeof(int), 1, scalarFile);
-    if (retval == 1)
-      {
-      vtkByteSwap::Swap4BE (&numValuesPerPoint);
-      }
-    else
+    if (!scalarFile.ReadInts (&numValuesPerPoint))
       {
       vtkErrorMacro("Error reading number of values per point, should be 1, in filename " << this->FileName);
       }
@@ -137,49 +120,32 @@ int vtkFSSurfaceScalarReader::ReadFSScalars()
 
   // Make our float array.
   FSscalars = (float*) calloc (numValues, sizeof(float));
+  if (FSscalars == NULL) {
+    vtkErrorMacro (<< "vtkFSSurfaceScalarReader.cxx Execute: error allocating " << numValues << " floats.");
+    return 0;
+  }
 
-  // For each value, if it's a new style file read a float, otherwise
-  // read a two byte int and divide it by 100. Add this value to the
-  // array.
-  for (vIndex = 0; vIndex < numValues; vIndex ++ ) {
-
-    if (feof(scalarFile)) {
-      vtkErrorMacro (<< "vtkFSSurfaceScalarReader.cxx Execute: Unexpected EOF after " << vIndex << " values read.");
-      return 0;
-    }
-
-    if (this->FS_NEW_SCALAR_MAGIC_NUMBER == magicNumber) {
-      size_t retval = fread (&fvalue, sizeof(float), 1, scalarFile);
-      if (retval == 1)
-        {
-        vtkByteSwap::Swap4BE (&fvalue);
-        }
-      else
-        {
-        vtkErrorMacro("Error reading fvalue from file " << this->FileName);
-        }
-
-    } else {
-      vtkFSIO::ReadInt2 (scalarFile, ivalue);
-      fvalue = ivalue / 100.0;
-    }
-
-    FSscalars[vIndex] = fvalue;
-
-    if (numValues < 10000 ||
-        (vIndex % 100) == 0)
-    {
-        this->UpdateProgress(1.0*vIndex/numValues);
+  // If it's a new style file read floats, otherwise read two byte ints
+  // and divide them by 100.
+  bool read = false;
+  if (this->FS_NEW_SCALAR_MAGIC_NUMBER == magicNumber) {
+    read = scalarFile.ReadFloats (FSscalars, numValues);
+  } else {
+    std::vector<int> ivalues (numValues);
+    read = scalarFile.ReadInt2s (ivalues.empty() ? 0 : &ivalues[0], ivalues.size());
+    for (int vIndex = 0; read && vIndex < numValues; vIndex ++ ) {
+      FSscalars[vIndex] = ivalues[vIndex] / 100.0;
     }
-
+  }
+  if (!read) {
+    vtkErrorMacro (<< "vtkFSSurfaceScalarReader.cxx Execute: Unexpected EOF, " << numValues << " values expected.");
+    free (FSscalars);
+    return 0;
   }
 
   this->SetProgressText("");
   this->UpdateProgress(0.0);
 
-  // Close the file.
-  fclose (scalarFile);
-
   // Set the array in our output.
   output->SetArray (FSscalars, numValues, 0);
 
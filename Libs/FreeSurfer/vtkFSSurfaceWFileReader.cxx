@@ -51,12 +51,10 @@ void vtkFSSurfaceWFileReader::SetOutput(vtkFloatArray *output)
 // Returns error codes depending on failure
 int vtkFSSurfaceWFileReader::ReadWFile()
 {
-  FILE* wFile;
-  int magicNumber;
+  int magicNumber = 0;
   int numValues = 0;
   int vIndex;
   int vIndexFromFile;
-  float fvalue;
   float *FSscalars;
   vtkFloatArray *output = this->Scalars;
 
@@ -76,9 +74,10 @@ int vtkFSSurfaceWFileReader::ReadWFile()
 
   vtkDebugMacro(<<"Reading surface WFile data...");
 
-  // Try to open the file.
-  wFile = fopen(this->FileName, "rb") ;
-  if (!wFile)
+  // Try to open the file. The records are decoded from the mapped
+  // file instead of being read one value at a time.
+  vtkFSIO::BlockReader wFile;
+  if (!wFile.Open(this->FileName))
     {
     vtkErrorMacro (<< "Could not open file " << this->FileName);
     return this->FS_ERROR_W_OPEN;
@@ -92,11 +91,10 @@ int vtkFSSurfaceWFileReader::ReadWFile()
   //
   // And then the lat variable is not used again. Maybe it was a scale
   // factor of some kind? No idea.
-  vtkFSIO::ReadInt2 (wFile, magicNumber);
+  wFile.ReadInt2s (&magicNumber);
 
   // This is the number of values in the wfile.
-  vtkFSIO::ReadInt3 (wFile, numValues);
-  if (numValues < 0)
+  if (!wFile.ReadInt3s (&numValues) || numValues < 0)
     {
     vtkErrorMacro (<< "vtkFSSurfaceWFileReader.cxx Execute: Number of vertices is 0 or negative, can't process file.");
     return this->FS_ERROR_W_NUM_VALUES;
@@ -123,17 +121,19 @@ int vtkFSSurfaceWFileReader::ReadWFile()
     return this->FS_ERROR_W_ALLOC;
     }
 
-  // For each value in the wfile...
-  for (vIndex = 0; vIndex < numValues; vIndex ++ )
+  // Each record is a 3 byte int index followed by a float value.
+  const size_t recordSize = 3 + sizeof(float);
+  if (wFile.GetRemaining() / recordSize < static_cast<size_t>(numValues))
     {
+    vtkErrorMacro (<< "vtkFSSurfaceWFileReader.cxx Execute: Unexpected EOF after " << wFile.GetRemaining() / recordSize << " values read. Tried to read " << numValues);
+    free (FSscalars);
+    return this->FS_ERROR_W_EOF;
+    }
+  const unsigned char* record = wFile.GetPointer();
 
-    // Check for eof.
-    if (feof(wFile))
-      {
-      vtkErrorMacro (<< "vtkFSSurfaceWFileReader.cxx Execute: Unexpected EOF after " << vIndex << " values read. Tried to read " << numValues);
-      return this->FS_ERROR_W_EOF;
-      }
-
+  // For each value in the wfile...
+  for (vIndex = 0; vIndex < numValues; vIndex ++, record += recordSize)
+    {
     // Read the 3 byte int index and float value. The wfile is weird
     // in that there is an index/value pair for every value. I guess
     // this means that the wfile could have fewer values than the
@@ -141,8 +141,7 @@ int vtkFSSurfaceWFileReader::ReadWFile()
     // happen in practice. Additionally, these are usually written
     // with indices from 0->nvertices, so this index value isn't even
     // really needed.
-    vtkFSIO::ReadInt3 (wFile, vIndexFromFile);
-    vtkFSIO::ReadFloat (wFile, fvalue);
+    vIndexFromFile = vtkFSIO::DecodeInt3 (record);
 
     // Make sure the index is in bounds. If not, print a warning and
     // try to do the next value. If this happens, there is probably a
@@ -158,21 +157,12 @@ int vtkFSSurfaceWFileReader::ReadWFile()
 
     // Set the value in the scalars array based on the index we read
     // in, not the index in our for loop.
-    FSscalars[vIndexFromFile] = fvalue;
-
-    if (numValues < 10000 ||
-        (vIndex % 100) == 0)
-      {
-      this->UpdateProgress(1.0*vIndex/numValues);
-      }
+    FSscalars[vIndexFromFile] = vtkFSIO::DecodeFloat (record + 3);
     }
 
   this->SetProgressText("");
   this->UpdateProgress(0.0);
 
-  // Close the file.
-  fclose (wFile);
-
   // Set the array in our output.
   //output->SetArray (FSscalars, numValues, 0);
   output->SetArray(FSscalars, this->NumberOfVertices, 0);
@@ -0,0 +1,251 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkCacheManager.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLVolumeArchetypeStorageNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool WriteFile(const std::string& fileName, unsigned long size)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  const std::string block(1000, 'x');
+  for (unsigned long written = 0; written < size; written += block.size())
+    {
+    file.write(block.c_str(), std::min<unsigned long>(block.size(), size - written));
+    }
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+int NumberOfIndexLines(const std::string& cacheDirectory)
+{
+  std::string indexFileName =
+    cacheDirectory + "/" + vtkCacheManager::GetCacheIndexFileName();
+  std::ifstream indexFile(indexFileName.c_str());
+  int numberOfLines = 0;
+  std::string line;
+  while (std::getline(indexFile, line))
+    {
+    ++numberOfLines;
+    }
+  return numberOfLines;
+}
+
+//----------------------------------------------------------------------------
+bool IsSize(float size, double expected)
+{
+  return size > expected / 1000000.0 - 1e-6 && size < expected / 1000000.0 + 1e-6;
+}
+
+//----------------------------------------------------------------------------
+bool TestCacheIndex(const std::string& cacheDirectory)
+{
+  vtkSmartPointer<vtkCacheManager> cacheManager =
+    vtkSmartPointer<vtkCacheManager>::New();
+  cacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  if (cacheManager->GetNumberOfCacheEntries() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": the cache index of an empty "
+              << "directory has " << cacheManager->GetNumberOfCacheEntries()
+              << " entries" << std::endl;
+    return false;
+    }
+
+  vtksys::SystemTools::MakeDirectory((cacheDirectory + "/series").c_str());
+  if (!WriteFile(cacheDirectory + "/a.nrrd", 1000) ||
+      !WriteFile(cacheDirectory + "/b.nrrd", 2000) ||
+      !WriteFile(cacheDirectory + "/series/1.dcm", 3000) ||
+      !WriteFile(cacheDirectory + "/series/2.dcm", 4000))
+    {
+    std::cerr << "Line " << __LINE__ << ": unable to write the cached files"
+              << std::endl;
+    return false;
+    }
+  cacheManager->AddCacheEntry((cacheDirectory + "/a.nrrd").c_str(), "http://host/a.nrrd");
+  cacheManager->AddCacheEntry("b.nrrd", "http://host/b.nrrd");
+  cacheManager->AddCacheEntry((cacheDirectory + "/series").c_str(), "http://host/series");
+  cacheManager->AddCacheEntry("/elsewhere/c.nrrd", "http://host/c.nrrd");
+  cacheManager->UpdateCacheInformation();
+  if (cacheManager->GetNumberOfCacheEntries() != 4 ||
+      !IsSize(cacheManager->GetCurrentCacheSize(), 10000))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong cache index: "
+              << cacheManager->GetNumberOfCacheEntries() << " entries, "
+              << cacheManager->GetCurrentCacheSize() << " MB" << std::endl;
+    return false;
+    }
+
+  // The changes are appended to the index file, not rewritten
+  cacheManager->TouchCacheEntry("a.nrrd");
+  cacheManager->RemoveCacheEntry("b.nrrd");
+  if (NumberOfIndexLines(cacheDirectory) != 6)
+    {
+    std::cerr << "Line " << __LINE__ << ": the index file has "
+              << NumberOfIndexLines(cacheDirectory) << " lines instead of "
+              << "the 6 lines of the journal" << std::endl;
+    return false;
+    }
+
+  // A cache manager replays the journal. b.nrrd is still on disk but is no
+  // longer in the index.
+  vtkSmartPointer<vtkCacheManager> otherCacheManager =
+    vtkSmartPointer<vtkCacheManager>::New();
+  otherCacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  if (otherCacheManager->GetNumberOfCacheEntries() != 3 ||
+      !IsSize(otherCacheManager->GetCurrentCacheSize(), 8000))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong journaled cache index: "
+              << otherCacheManager->GetNumberOfCacheEntries() << " entries, "
+              << otherCacheManager->GetCurrentCacheSize() << " MB" << std::endl;
+    return false;
+    }
+  otherCacheManager = 0;
+
+  // The index file is rewritten without the journal when the cache manager
+  // is deleted
+  cacheManager = 0;
+  if (NumberOfIndexLines(cacheDirectory) != 3)
+    {
+    std::cerr << "Line " << __LINE__ << ": the index file has "
+              << NumberOfIndexLines(cacheDirectory) << " lines instead of 3"
+              << std::endl;
+    return false;
+    }
+
+  // Scanning the directory finds b.nrrd again
+  cacheManager = vtkSmartPointer<vtkCacheManager>::New();
+  cacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  cacheManager->RebuildCacheIndex();
+  if (cacheManager->GetNumberOfCacheEntries() != 4 ||
+      !IsSize(cacheManager->GetCurrentCacheSize(), 10000))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong rebuilt cache index: "
+              << cacheManager->GetNumberOfCacheEntries() << " entries, "
+              << cacheManager->GetCurrentCacheSize() << " MB" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestEvictLeastRecentlyUsedFiles(const std::string& cacheDirectory)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkSmartPointer<vtkCacheManager> cacheManager =
+    vtkSmartPointer<vtkCacheManager>::New();
+  cacheManager->SetMRMLScene(scene.GetPointer());
+  cacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  // 2 MB available
+  cacheManager->SetRemoteCacheLimit(3);
+  cacheManager->SetRemoteCacheFreeBufferSize(1);
+
+  const char* files[3] = {"x.nrrd", "y.nrrd", "z.nrrd"};
+  for (int n = 0; n < 3; ++n)
+    {
+    const std::string fileName = cacheDirectory + "/" + files[n];
+    if (!WriteFile(fileName, 900000))
+      {
+      std::cerr << "Line " << __LINE__ << ": unable to write " << fileName
+                << std::endl;
+      return false;
+      }
+    cacheManager->AddCacheEntry(fileName.c_str(),
+                                (std::string("http://host/") + files[n]).c_str());
+    }
+  // from the least to the most recently used: y, z, x
+  cacheManager->TouchCacheEntry("x.nrrd");
+
+  // y.nrrd is read by a node of the scene, z.nrrd goes first
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+  storageNode->SetFileName((cacheDirectory + "/y.nrrd").c_str());
+  scene->AddNode(storageNode.GetPointer());
+
+  int removed = cacheManager->EvictLeastRecentlyUsedFiles();
+  if (removed != 1 ||
+      !vtksys::SystemTools::FileExists((cacheDirectory + "/x.nrrd").c_str()) ||
+      !vtksys::SystemTools::FileExists((cacheDirectory + "/y.nrrd").c_str()) ||
+      vtksys::SystemTools::FileExists((cacheDirectory + "/z.nrrd").c_str()) ||
+      !IsSize(cacheManager->GetCurrentCacheSize(), 1800000))
+    {
+    std::cerr << "Line " << __LINE__ << ": EvictLeastRecentlyUsedFiles "
+              << "removed " << removed << " files, the cache has "
+              << cacheManager->GetCurrentCacheSize() << " MB" << std::endl;
+    return false;
+    }
+
+  // nothing to do when the cache fits
+  if (cacheManager->EvictLeastRecentlyUsedFiles() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": EvictLeastRecentlyUsedFiles "
+              << "removed files from a cache within its limit" << std::endl;
+    return false;
+    }
+
+  // the eviction is recorded in the index
+  vtkSmartPointer<vtkCacheManager> otherCacheManager =
+    vtkSmartPointer<vtkCacheManager>::New();
+  otherCacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  if (otherCacheManager->GetNumberOfCacheEntries() != 2)
+    {
+    std::cerr << "Line " << __LINE__ << ": the index has "
+              << otherCacheManager->GetNumberOfCacheEntries()
+              << " entries after the eviction instead of 2" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkCacheManagerTest1(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkCacheManagerTest1 /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string tempDirectory = argv[1];
+
+  const std::string indexDirectory = tempDirectory + "/vtkCacheManagerTest1Index";
+  vtksys::SystemTools::RemoveADirectory(indexDirectory.c_str());
+  if (!TestCacheIndex(indexDirectory))
+    {
+    return EXIT_FAILURE;
+    }
+
+  const std::string evictionDirectory = tempDirectory + "/vtkCacheManagerTest1Eviction";
+  vtksys::SystemTools::RemoveADirectory(evictionDirectory.c_str());
+  if (!TestEvictLeastRecentlyUsedFiles(evictionDirectory))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
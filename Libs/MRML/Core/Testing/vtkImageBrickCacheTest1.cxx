@@ -0,0 +1,207 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkImageBrickCache.h"
+#include "vtkImageBrickSource.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+short Voxel(int i, int j, int k)
+{
+  return static_cast<short>(i + 7 * j + 31 * k - 500);
+}
+
+//----------------------------------------------------------------------------
+bool WriteNRRD(const char* fileName, const int dimensions[3])
+{
+  std::ofstream file(fileName, std::ios::out | std::ios::binary);
+  file << "NRRD0004\n"
+       << "# Test volume\n"
+       << "type: short\n"
+       << "dimension: 3\n"
+       << "sizes: " << dimensions[0] << " " << dimensions[1] << " " << dimensions[2] << "\n"
+       << "space directions: (1,0,0) (0,1,0) (0,0,1)\n"
+       << "encoding: raw\n"
+       << "endian: big\n"
+       << "key:=value\n"
+       << "\n";
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        const short voxel = Voxel(i, j, k);
+        const char bytes[2] = {static_cast<char>((voxel >> 8) & 0xff),
+                               static_cast<char>(voxel & 0xff)};
+        file.write(bytes, 2);
+        }
+      }
+    }
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+// Check the voxels of the extent. If readLayer is not -1, only the bricks
+// of 16 voxels of this layer in z are expected to be read.
+bool CheckExtent(vtkImageBrickSource* source, int extent[6], int readLayer = -1)
+{
+  vtkImageData* output = source->GetOutput();
+  output->SetUpdateExtent(extent);
+  output->Update();
+  int outputExtent[6];
+  output->GetExtent(outputExtent);
+  for (int i = 0; i < 6; ++i)
+    {
+    if (outputExtent[i] != extent[i])
+      {
+      std::cerr << "Line " << __LINE__ << ": the output extent is not the update extent" << std::endl;
+      return false;
+      }
+    }
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        const short voxel = *static_cast<short*>(output->GetScalarPointer(i, j, k));
+        const bool read = readLayer == -1 || k / 16 == readLayer;
+        if (read && voxel != Voxel(i, j, k))
+          {
+          std::cerr << "Line " << __LINE__ << ": wrong voxel (" << i << ", " << j << ", " << k
+                    << "): " << voxel << " instead of " << Voxel(i, j, k) << std::endl;
+          return false;
+          }
+        if (!read && voxel != 0)
+          {
+          std::cerr << "Line " << __LINE__ << ": voxel (" << i << ", " << j << ", " << k
+                    << ") outside of the slab has been read" << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCacheTest1(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkImageBrickCacheTest1 <temporary file.nrrd>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int dimensions[3] = {128, 128, 48};
+  if (!WriteNRRD(argv[1], dimensions))
+    {
+    std::cerr << "Line " << __LINE__ << ": can't write " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkImageBrickCache> cache;
+  if (!cache->ReadNRRDHeader(argv[1]) ||
+      cache->GetDimensions()[0] != 128 || cache->GetDimensions()[1] != 128 ||
+      cache->GetDimensions()[2] != 48 || cache->GetScalarType() != VTK_SHORT ||
+      cache->GetNumberOfScalarComponents() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong header" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // 8 KB bricks, at most 128 of them in the cache
+  cache->SetBrickSize(16);
+  cache->SetMaximumCacheSize(1);
+
+  vtkNew<vtkImageBrickSource> source;
+  source->SetCache(cache.GetPointer());
+  source->UpdateInformation();
+  if (vtkImageBrickSource::GetImageBrickSource(source->GetOutput()) != source.GetPointer())
+    {
+    std::cerr << "Line " << __LINE__ << ": the source of the output is not found" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A slice only reads its bricks
+  int slice[6] = {0, 127, 0, 127, 20, 20};
+  if (!CheckExtent(source.GetPointer(), slice) ||
+      cache->GetNumberOfBrickReads() != 64)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << cache->GetNumberOfBrickReads()
+              << " bricks read for a slice" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // The whole volume doesn't fit in the cache
+  int wholeExtent[6] = {0, 127, 0, 127, 0, 47};
+  if (!CheckExtent(source.GetPointer(), wholeExtent) ||
+      cache->GetCacheSizeInBytes() > 1024 * 1024 ||
+      cache->GetNumberOfCachedBricks() != 128)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << cache->GetNumberOfCachedBricks()
+              << " bricks and " << cache->GetCacheSizeInBytes() << " bytes cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // The most recently used bricks are kept
+  const vtkTypeInt64 reads = cache->GetNumberOfBrickReads();
+  int lastBricks[6] = {64, 127, 0, 127, 32, 47};
+  if (!CheckExtent(source.GetPointer(), lastBricks) ||
+      cache->GetNumberOfBrickReads() != reads)
+    {
+    std::cerr << "Line " << __LINE__ << ": cached bricks read again" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Only the bricks crossing the slab are read
+  source->SetSlabOrigin(0., 0., 40.);
+  source->SetSlabNormal(0., 0., 1.);
+  source->SetSlabThickness(2.);
+  source->RestrictToSlabOn();
+  if (!CheckExtent(source.GetPointer(), wholeExtent, 40 / 16))
+    {
+    return EXIT_FAILURE;
+    }
+  source->RestrictToSlabOff();
+
+  // Sample for the auto levels
+  vtkNew<vtkImageData> sample;
+  if (!cache->FillSampleImage(sample.GetPointer(), 1000) ||
+      sample->GetNumberOfPoints() > 1000 ||
+      sample->GetDimensions()[2] != 8)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong sample" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The cache is released when the file changes
+  cache->SetBrickSize(32);
+  if (!CheckExtent(source.GetPointer(), slice) ||
+      cache->GetNumberOfCachedBricks() != 16)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << cache->GetNumberOfCachedBricks()
+              << " bricks cached after a change of brick size" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,383 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// FreeSurfer includes
+#include <vtkFSSurfaceHelper.h>
+#include <vtkFSSurfaceReader.h>
+#include <vtkFSSurfaceScalarReader.h>
+
+// MRML includes
+#include "vtkMRMLFreeSurferModelStorageNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCollection.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void writeBigEndian(std::ofstream& file, unsigned int value, int numberOfBytes)
+{
+  for (int i = numberOfBytes - 1; i >= 0; --i)
+    {
+    file.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+//----------------------------------------------------------------------------
+void writeBigEndian(std::ofstream& file, float value)
+{
+  unsigned int bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  writeBigEndian(file, bits, 4);
+}
+
+//----------------------------------------------------------------------------
+// Triangle surface of a (size x size) grid of vertices, shifted by offset
+bool writeSurface(const std::string& fileName, int size, float offset)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  writeBigEndian(file, vtkFSSurfaceReader::FS_TRIANGLE_FILE_MAGIC_NUMBER, 3);
+  file << "created by vtkMRMLFreeSurferModelStorageNodeTest2\n\n";
+  const int numberOfFaces = 2 * (size - 1) * (size - 1);
+  writeBigEndian(file, size * size, 4);
+  writeBigEndian(file, numberOfFaces, 4);
+  for (int j = 0; j < size; ++j)
+    {
+    for (int i = 0; i < size; ++i)
+      {
+      writeBigEndian(file, i + offset);
+      writeBigEndian(file, j - offset);
+      writeBigEndian(file, 0.01f * i * j);
+      }
+    }
+  for (int j = 0; j < size - 1; ++j)
+    {
+    for (int i = 0; i < size - 1; ++i)
+      {
+      const int v = j * size + i;
+      writeBigEndian(file, v, 4);
+      writeBigEndian(file, v + 1, 4);
+      writeBigEndian(file, v + size, 4);
+      writeBigEndian(file, v + 1, 4);
+      writeBigEndian(file, v + size + 1, 4);
+      writeBigEndian(file, v + size, 4);
+      }
+    }
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+// New style (float) or old style (2 byte ints in hundredths) curvature
+bool writeScalars(const std::string& fileName, int numberOfValues, bool newStyle)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  if (newStyle)
+    {
+    writeBigEndian(file, vtkFSSurfaceScalarReader::FS_NEW_SCALAR_MAGIC_NUMBER, 3);
+    writeBigEndian(file, numberOfValues, 4);
+    writeBigEndian(file, 0, 4);
+    writeBigEndian(file, 1, 4);
+    }
+  else
+    {
+    writeBigEndian(file, numberOfValues, 3);
+    }
+  for (int i = 0; i < numberOfValues; ++i)
+    {
+    if (newStyle)
+      {
+      writeBigEndian(file, 0.5f * i - 10.f);
+      }
+    else
+      {
+      writeBigEndian(file, static_cast<unsigned short>(static_cast<short>(3 * i - 500)), 2);
+      }
+    }
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+bool arePolyDataEqual(vtkPolyData* polyData1, vtkPolyData* polyData2)
+{
+  if (!polyData1 || !polyData2 ||
+      polyData1->GetNumberOfPoints() == 0 ||
+      polyData1->GetNumberOfPoints() != polyData2->GetNumberOfPoints() ||
+      polyData1->GetNumberOfPolys() != polyData2->GetNumberOfPolys())
+    {
+    return false;
+    }
+  for (vtkIdType i = 0; i < polyData1->GetNumberOfPoints(); ++i)
+    {
+    double point1[3];
+    double point2[3];
+    polyData1->GetPoint(i, point1);
+    polyData2->GetPoint(i, point2);
+    if (point1[0] != point2[0] || point1[1] != point2[1] || point1[2] != point2[2])
+      {
+      return false;
+      }
+    }
+  vtkIdTypeArray* cells1 = polyData1->GetPolys()->GetData();
+  vtkIdTypeArray* cells2 = polyData2->GetPolys()->GetData();
+  return cells1->GetNumberOfTuples() == cells2->GetNumberOfTuples() &&
+         memcmp(cells1->GetPointer(0), cells2->GetPointer(0),
+                cells1->GetNumberOfTuples() * sizeof(vtkIdType)) == 0;
+}
+
+//----------------------------------------------------------------------------
+bool areScalarsEqual(vtkFloatArray* scalars1, vtkFloatArray* scalars2)
+{
+  return scalars1->GetNumberOfTuples() > 0 &&
+         scalars1->GetNumberOfTuples() == scalars2->GetNumberOfTuples() &&
+         memcmp(scalars1->GetPointer(0), scalars2->GetPointer(0),
+                scalars1->GetNumberOfTuples() * sizeof(float)) == 0;
+}
+
+//----------------------------------------------------------------------------
+bool testReadInParallel(const std::vector<std::string>& surfaceFileNames,
+                        const std::vector<std::string>& scalarFileNames)
+{
+  // Sequential reads
+  std::vector<vtkSmartPointer<vtkPolyData> > surfaces;
+  for (size_t i = 0; i < surfaceFileNames.size(); ++i)
+    {
+    vtkNew<vtkFSSurfaceReader> reader;
+    reader->SetFileName(surfaceFileNames[i].c_str());
+    reader->Update();
+    surfaces.push_back(reader->GetOutput());
+    }
+  std::vector<vtkSmartPointer<vtkFloatArray> > scalars;
+  for (size_t i = 0; i < scalarFileNames.size(); ++i)
+    {
+    vtkNew<vtkFSSurfaceScalarReader> reader;
+    vtkNew<vtkFloatArray> output;
+    reader->SetFileName(scalarFileNames[i].c_str());
+    reader->SetOutput(output.GetPointer());
+    if (!reader->ReadFSScalars())
+      {
+      std::cerr << "Line " << __LINE__ << ": can't read "
+                << scalarFileNames[i] << std::endl;
+      return false;
+      }
+    scalars.push_back(output.GetPointer());
+    }
+
+  // Parallel reads, with more or less threads than readers
+  const int numbersOfThreads[4] = {1, 2, 3, 16};
+  for (int t = 0; t < 4; ++t)
+    {
+    vtkNew<vtkCollection> readers;
+    std::vector<vtkSmartPointer<vtkFSSurfaceReader> > surfaceReaders;
+    for (size_t i = 0; i < surfaceFileNames.size(); ++i)
+      {
+      vtkSmartPointer<vtkFSSurfaceReader> reader =
+        vtkSmartPointer<vtkFSSurfaceReader>::New();
+      reader->SetFileName(surfaceFileNames[i].c_str());
+      readers->AddItem(reader);
+      surfaceReaders.push_back(reader);
+      }
+    std::vector<vtkSmartPointer<vtkFloatArray> > outputs;
+    for (size_t i = 0; i < scalarFileNames.size(); ++i)
+      {
+      vtkNew<vtkFSSurfaceScalarReader> reader;
+      vtkSmartPointer<vtkFloatArray> output = vtkSmartPointer<vtkFloatArray>::New();
+      reader->SetFileName(scalarFileNames[i].c_str());
+      reader->SetOutput(output);
+      readers->AddItem(reader.GetPointer());
+      outputs.push_back(output);
+      }
+    int failures = vtkFSSurfaceHelper::ReadInParallel(readers.GetPointer(),
+                                                      numbersOfThreads[t]);
+    if (failures != 0)
+      {
+      std::cerr << "Line " << __LINE__ << ": " << failures << " failures with "
+                << numbersOfThreads[t] << " threads" << std::endl;
+      return false;
+      }
+    for (size_t i = 0; i < surfaces.size(); ++i)
+      {
+      if (!arePolyDataEqual(surfaceReaders[i]->GetOutput(), surfaces[i]))
+        {
+        std::cerr << "Line " << __LINE__ << ": surface " << surfaceFileNames[i]
+                  << " differs from the sequential read with "
+                  << numbersOfThreads[t] << " threads" << std::endl;
+        return false;
+        }
+      }
+    for (size_t i = 0; i < scalars.size(); ++i)
+      {
+      if (!areScalarsEqual(outputs[i], scalars[i]))
+        {
+        std::cerr << "Line " << __LINE__ << ": scalars " << scalarFileNames[i]
+                  << " differ from the sequential read with "
+                  << numbersOfThreads[t] << " threads" << std::endl;
+        return false;
+        }
+      }
+    }
+
+  // A missing file is counted as a failure, the others are read
+  vtkNew<vtkCollection> readers;
+  vtkNew<vtkFSSurfaceReader> missingReader;
+  missingReader->SetFileName((surfaceFileNames[0] + ".missing").c_str());
+  readers->AddItem(missingReader.GetPointer());
+  vtkNew<vtkFSSurfaceReader> reader;
+  reader->SetFileName(surfaceFileNames[0].c_str());
+  readers->AddItem(reader.GetPointer());
+  int failures = vtkFSSurfaceHelper::ReadInParallel(readers.GetPointer(), 2);
+  if (failures != 1 || !arePolyDataEqual(reader->GetOutput(), surfaces[0]))
+    {
+    std::cerr << "Line " << __LINE__ << ": " << failures
+              << " failures instead of 1" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool testReadSurfacesInParallel(const std::vector<std::string>& surfaceFileNames)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkCollection> storageNodes;
+  std::vector<vtkSmartPointer<vtkMRMLModelNode> > modelNodes;
+  std::vector<vtkSmartPointer<vtkMRMLModelNode> > expectedModelNodes;
+  for (size_t i = 0; i < surfaceFileNames.size(); ++i)
+    {
+    // expected model, read from the file by the storage node
+    vtkNew<vtkMRMLFreeSurferModelStorageNode> expectedStorageNode;
+    expectedStorageNode->SetUseStripper(0);
+    expectedStorageNode->SetFileName(surfaceFileNames[i].c_str());
+    scene->AddNode(expectedStorageNode.GetPointer());
+    vtkSmartPointer<vtkMRMLModelNode> expectedModelNode =
+      vtkSmartPointer<vtkMRMLModelNode>::New();
+    scene->AddNode(expectedModelNode);
+    expectedModelNode->SetAndObserveStorageNodeID(expectedStorageNode->GetID());
+    if (!expectedStorageNode->ReadData(expectedModelNode))
+      {
+      std::cerr << "Line " << __LINE__ << ": can't read "
+                << surfaceFileNames[i] << std::endl;
+      return false;
+      }
+    expectedModelNodes.push_back(expectedModelNode);
+
+    vtkNew<vtkMRMLFreeSurferModelStorageNode> storageNode;
+    storageNode->SetUseStripper(0);
+    storageNode->SetFileName(surfaceFileNames[i].c_str());
+    scene->AddNode(storageNode.GetPointer());
+    vtkSmartPointer<vtkMRMLModelNode> modelNode =
+      vtkSmartPointer<vtkMRMLModelNode>::New();
+    scene->AddNode(modelNode);
+    modelNode->SetAndObserveStorageNodeID(storageNode->GetID());
+    storageNodes->AddItem(storageNode.GetPointer());
+    modelNodes.push_back(modelNode);
+    }
+
+  int failures = vtkMRMLFreeSurferModelStorageNode::ReadSurfacesInParallel(
+    storageNodes.GetPointer());
+  if (failures != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << failures << " failures" << std::endl;
+    return false;
+    }
+  // The files are not needed anymore: the surfaces have already been read
+  for (size_t i = 0; i < surfaceFileNames.size(); ++i)
+    {
+    std::ofstream file(surfaceFileNames[i].c_str(), std::ios::out | std::ios::trunc);
+    }
+  for (size_t i = 0; i < modelNodes.size(); ++i)
+    {
+    vtkMRMLStorageNode* storageNode = modelNodes[i]->GetStorageNode();
+    if (!storageNode->ReadData(modelNodes[i]) ||
+        !arePolyDataEqual(modelNodes[i]->GetPolyData(),
+                          expectedModelNodes[i]->GetPolyData()))
+      {
+      std::cerr << "Line " << __LINE__ << ": model " << i
+                << " differs from the sequential read" << std::endl;
+      return false;
+      }
+    // The surface read in parallel is used only once
+    if (storageNode->ReadData(modelNodes[i]))
+      {
+      std::cerr << "Line " << __LINE__ << ": model " << i
+                << " was not read from the (empty) file again" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLFreeSurferModelStorageNodeTest2(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkMRMLFreeSurferModelStorageNodeTest2 <temporary directory>"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory(argv[1]);
+  const char* surfaceNames[4] = {"lh.white", "lh.pial", "rh.white", "rh.pial"};
+  const int size = 40;
+  std::vector<std::string> surfaceFileNames;
+  for (int i = 0; i < 4; ++i)
+    {
+    surfaceFileNames.push_back(directory +
+      "/vtkMRMLFreeSurferModelStorageNodeTest2." + surfaceNames[i]);
+    if (!writeSurface(surfaceFileNames.back(), size + i, 1.5f * i))
+      {
+      std::cerr << "Line " << __LINE__ << ": can't write "
+                << surfaceFileNames.back() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  std::vector<std::string> scalarFileNames;
+  for (int i = 0; i < 2; ++i)
+    {
+    std::stringstream fileName;
+    fileName << directory << "/vtkMRMLFreeSurferModelStorageNodeTest2."
+             << i << ".curv";
+    scalarFileNames.push_back(fileName.str());
+    if (!writeScalars(scalarFileNames.back(), size * size, i == 0))
+      {
+      std::cerr << "Line " << __LINE__ << ": can't write "
+                << scalarFileNames.back() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  if (!testReadInParallel(surfaceFileNames, scalarFileNames) ||
+      !testReadSurfacesInParallel(surfaceFileNames))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkImageBrickCache.h"
+#include "vtkImageBrickSource.h"
+#include "vtkMRMLNRRDStorageNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+short Voxel(int i, int j, int k)
+{
+  return static_cast<short>(3 * i - 5 * j + 11 * k);
+}
+
+//----------------------------------------------------------------------------
+bool WriteNRRD(const char* fileName, const int dimensions[3])
+{
+  std::ofstream file(fileName, std::ios::out | std::ios::binary);
+  file << "NRRD0004\n"
+       << "type: short\n"
+       << "dimension: 3\n"
+       << "space: left-posterior-superior\n"
+       << "sizes: " << dimensions[0] << " " << dimensions[1] << " " << dimensions[2] << "\n"
+       << "space directions: (1,0,0) (0,1,0) (0,0,2)\n"
+       << "space origin: (-10,20,30)\n"
+       << "encoding: raw\n"
+       << "endian: little\n"
+       << "\n";
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        const short voxel = Voxel(i, j, k);
+        const char bytes[2] = {static_cast<char>(voxel & 0xff),
+                               static_cast<char>((voxel >> 8) & 0xff)};
+        file.write(bytes, 2);
+        }
+      }
+    }
+  return file.good();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// Read a volume by bricks with the NRRD storage node
+int vtkMRMLNRRDStorageNodeTest2(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkMRMLNRRDStorageNodeTest2 <temporary file.nrrd>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // 3 MB of voxels
+  const int dimensions[3] = {128, 128, 96};
+  if (!WriteNRRD(argv[1], dimensions))
+    {
+    std::cerr << "Line " << __LINE__ << ": can't write " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  scene->AddNode(volumeNode.GetPointer());
+  vtkNew<vtkMRMLNRRDStorageNode> storageNode;
+  storageNode->SetFileName(argv[1]);
+  storageNode->BrickedReadingOn();
+  scene->AddNode(storageNode.GetPointer());
+  volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  if (!storageNode->ReadData(volumeNode.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << ": can't read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The dimensions and the geometry are known before any voxel is read
+  vtkImageData* imageData = volumeNode->GetImageData();
+  vtkImageBrickSource* source = vtkImageBrickSource::GetImageBrickSource(imageData);
+  if (!source || !source->GetCache() ||
+      imageData->GetDimensions()[0] != 128 || imageData->GetDimensions()[1] != 128 ||
+      imageData->GetDimensions()[2] != 96 ||
+      volumeNode->GetSpacing()[2] != 2. ||
+      source->GetCache()->GetNumberOfBrickReads() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": the volume is not read by bricks" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The volume is read slice by slice within the limit of the cache
+  vtkImageBrickCache* cache = source->GetCache();
+  cache->SetBrickSize(16);
+  cache->SetMaximumCacheSize(1);
+  for (int k = 0; k < dimensions[2]; k += 5)
+    {
+    imageData->SetUpdateExtent(0, 127, 0, 127, k, k);
+    imageData->Update();
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        const short voxel = *static_cast<short*>(imageData->GetScalarPointer(i, j, k));
+        if (voxel != Voxel(i, j, k))
+          {
+          std::cerr << "Line " << __LINE__ << ": wrong voxel (" << i << ", " << j << ", "
+                    << k << "): " << voxel << " instead of " << Voxel(i, j, k) << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    if (imageData->GetNumberOfPoints() != 128 * 128 ||
+        cache->GetCacheSizeInBytes() > 1024 * 1024)
+      {
+      std::cerr << "Line " << __LINE__ << ": " << imageData->GetNumberOfPoints()
+                << " voxels in memory and " << cache->GetCacheSizeInBytes()
+                << " bytes cached for a slice" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
@@ -23,6 +23,7 @@
 #include "vtkMRMLScalarVolumeNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLSceneViewNode.h"
+#include "vtkMRMLVolumeArchetypeStorageNode.h"
 
 // VTK includes
 #include <vtkCollection.h>
@@ -30,6 +31,9 @@
 #include <vtkSmartPointer.h>
 #include <vtkTimerLog.h>
 
+// STD includes
+#include <sstream>
+
 namespace
 {
 
@@ -41,6 +45,9 @@ bool storeTwice();
 bool storeAndRestoreTwice();
 bool storeTwiceAndRemoveVolume();
 bool references();
+bool shareNodes();
+bool modifySharedNodes();
+bool restoreModifiedNodes();
 bool storePerformance();
 
 } // end of anonymous namespace
@@ -84,6 +91,21 @@ int vtkMRMLSceneViewNodeStoreSceneTest(int vtkNotUsed(argc),
     std::cerr << "references call not successful." << std::endl;
     return EXIT_FAILURE;
     }
+  if (!shareNodes())
+    {
+    std::cerr << "shareNodes call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!modifySharedNodes())
+    {
+    std::cerr << "modifySharedNodes call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!restoreModifiedNodes())
+    {
+    std::cerr << "restoreModifiedNodes call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
   if (!storePerformance())
     {
     std::cerr << "updateNodeIDs call not successful." << std::endl;
@@ -347,6 +369,180 @@ bool references()
   return true;
 }
 
+//---------------------------------------------------------------------------
+bool shareNodes()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer());
+
+  vtkSmartPointer<vtkMRMLSceneViewNode> sceneViewNode1 =
+    vtkSmartPointer<vtkMRMLSceneViewNode>::New();
+  scene->AddNode(sceneViewNode1);
+  sceneViewNode1->StoreScene();
+
+  scene->GetNodeByID("vtkMRMLScalarVolumeNode1")->SetName("Modified");
+
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode2;
+  scene->AddNode(sceneViewNode2.GetPointer());
+  sceneViewNode2->StoreScene();
+
+  vtkMRMLScene* storedScene1 = sceneViewNode1->GetStoredScene();
+  vtkMRMLScene* storedScene2 = sceneViewNode2->GetStoredScene();
+  vtkMRMLNode* sharedDisplayNode =
+    storedScene2->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1");
+  // The display node didn't change, the volume node did.
+  if (storedScene2->GetNumberOfNodes() != 2 ||
+      sharedDisplayNode == 0 ||
+      sharedDisplayNode != storedScene1->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1") ||
+      storedScene2->GetNodeByID("vtkMRMLScalarVolumeNode1") ==
+        storedScene1->GetNodeByID("vtkMRMLScalarVolumeNode1") ||
+      strcmp(storedScene2->GetNodeByID("vtkMRMLScalarVolumeNode1")->GetName(), "Modified"))
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::StoreScene() failed"
+              << std::endl;
+    return false;
+    }
+
+  // The shared node must outlive the scene view that stored it first.
+  scene->RemoveNode(sceneViewNode1);
+  sceneViewNode1 = 0;
+  if (sharedDisplayNode->GetScene() != storedScene2 ||
+      storedScene2->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1") != sharedDisplayNode)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::~vtkMRMLSceneViewNode() failed"
+              << std::endl;
+    return false;
+    }
+  sceneViewNode2->RestoreScene();
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool modifySharedNodes()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer());
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+  storageNode->SetFileName("first.nrrd");
+  scene->AddNode(storageNode.GetPointer());
+  vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetNodeByID("vtkMRMLScalarVolumeNode1"))
+    ->SetAndObserveStorageNodeID(storageNode->GetID());
+
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode1;
+  scene->AddNode(sceneViewNode1.GetPointer());
+  sceneViewNode1->StoreScene();
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode2;
+  scene->AddNode(sceneViewNode2.GetPointer());
+  sceneViewNode2->StoreScene();
+
+  vtkMRMLScene* storedScene1 = sceneViewNode1->GetStoredScene();
+  vtkMRMLScene* storedScene2 = sceneViewNode2->GetStoredScene();
+  vtkMRMLStorageNode* sharedStorageNode = vtkMRMLStorageNode::SafeDownCast(
+    storedScene1->GetNodeByID(storageNode->GetID()));
+  vtkMRMLNode* sharedVolumeNode =
+    storedScene1->GetNodeByID("vtkMRMLScalarVolumeNode1");
+  if (sharedStorageNode == 0 ||
+      storedScene2->GetNodeByID(storageNode->GetID()) != sharedStorageNode ||
+      storedScene2->GetNodeByID("vtkMRMLScalarVolumeNode1") != sharedVolumeNode)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::StoreScene() failed"
+              << std::endl;
+    return false;
+    }
+
+  // Saving the second scene view updates its own storage node only
+  storageNode->SetFileName("second.nrrd");
+  std::stringstream ss;
+  sceneViewNode2->WriteNodeBodyXML(ss, 0);
+  vtkMRMLStorageNode* storageNode2 = vtkMRMLStorageNode::SafeDownCast(
+    storedScene2->GetNodeByID(storageNode->GetID()));
+  if (strcmp(sharedStorageNode->GetFileName(), "first.nrrd") ||
+      sharedStorageNode->GetScene() != storedScene1 ||
+      storedScene1->GetNodeByID(storageNode->GetID()) != sharedStorageNode ||
+      storageNode2 == 0 || storageNode2 == sharedStorageNode ||
+      storageNode2->GetScene() != storedScene2 ||
+      strcmp(storageNode2->GetFileName(), "second.nrrd") ||
+      storedScene2->GetNodeByID("vtkMRMLScalarVolumeNode1") != sharedVolumeNode)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::WriteNodeBodyXML() "
+              << "modified a shared node" << std::endl;
+    return false;
+    }
+
+  // Restoring the first scene view leaves the second one unchanged
+  sceneViewNode1->RestoreScene();
+  if (strcmp(storageNode->GetFileName(), "first.nrrd") ||
+      strcmp(sharedStorageNode->GetFileName(), "first.nrrd") ||
+      sharedStorageNode->GetScene() != storedScene1 ||
+      sharedVolumeNode->GetScene() != storedScene1 ||
+      storedScene2->GetNodeByID(storageNode->GetID()) != storageNode2 ||
+      strcmp(storageNode2->GetFileName(), "second.nrrd"))
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::RestoreScene() failed"
+              << std::endl;
+    return false;
+    }
+
+  // The copy shares the stored nodes without taking them over
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode3;
+  sceneViewNode3->Copy(sceneViewNode1.GetPointer());
+  vtkMRMLScene* storedScene3 = sceneViewNode3->GetStoredScene();
+  if (storedScene3->GetNodeByID("vtkMRMLScalarVolumeNode1") != sharedVolumeNode ||
+      sharedVolumeNode->GetScene() != storedScene1 ||
+      sharedStorageNode->GetScene() != storedScene1)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::Copy() failed"
+              << std::endl;
+    return false;
+    }
+
+  // Updating the copy gives it its own nodes
+  scene->AddNode(sceneViewNode3.GetPointer());
+  sceneViewNode3->UpdateScene(scene.GetPointer());
+  vtkMRMLNode* volumeNode3 = storedScene3->GetNodeByID("vtkMRMLScalarVolumeNode1");
+  if (volumeNode3 == 0 || volumeNode3 == sharedVolumeNode ||
+      volumeNode3->GetScene() != storedScene3 ||
+      sharedVolumeNode->GetScene() != storedScene1 ||
+      storedScene1->GetNodeByID("vtkMRMLScalarVolumeNode1") != sharedVolumeNode ||
+      storedScene2->GetNodeByID("vtkMRMLScalarVolumeNode1") != sharedVolumeNode)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::UpdateScene() failed"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool restoreModifiedNodes()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLSceneViewNode> sceneViewNode;
+  scene->AddNode(sceneViewNode.GetPointer());
+  sceneViewNode->StoreScene();
+
+  vtkMRMLNode* volumeNode = scene->GetNodeByID("vtkMRMLScalarVolumeNode1");
+  vtkMRMLNode* displayNode = scene->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1");
+  std::string name = volumeNode->GetName() ? volumeNode->GetName() : "";
+  volumeNode->SetName("Modified");
+  unsigned long displayNodeMTime = displayNode->GetMTime();
+
+  sceneViewNode->RestoreScene();
+
+  // Only the modified node is restored.
+  if (scene->GetNodeByID("vtkMRMLScalarVolumeNode1") != volumeNode ||
+      name != (volumeNode->GetName() ? volumeNode->GetName() : "") ||
+      displayNode->GetMTime() != displayNodeMTime)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::RestoreScene() failed"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
 //---------------------------------------------------------------------------
 bool storePerformance()
 {
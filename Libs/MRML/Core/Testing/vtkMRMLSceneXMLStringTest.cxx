@@ -0,0 +1,144 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <string>
+
+namespace
+{
+
+bool registerNodeClasses();
+bool saveAndImport();
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneXMLStringTest(int vtkNotUsed(argc),
+                              char * vtkNotUsed(argv)[] )
+{
+  if (!registerNodeClasses())
+    {
+    std::cerr << "registerNodeClasses call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!saveAndImport())
+    {
+    std::cerr << "saveAndImport call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+bool isEqual(const char* value, const char* expected)
+{
+  return value && expected && strcmp(value, expected) == 0;
+}
+
+//---------------------------------------------------------------------------
+bool registerNodeClasses()
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // A class registered with an obsolete tag keeps its own tag
+  vtkNew<vtkMRMLModelNode> modelNode;
+  scene->RegisterNodeClass(modelNode.GetPointer(), "ObsoleteModel");
+  if (!isEqual(scene->GetClassNameByTag("ObsoleteModel"), "vtkMRMLModelNode") ||
+      !isEqual(scene->GetClassNameByTag("Model"), "vtkMRMLModelNode") ||
+      !isEqual(scene->GetTagByClassName("vtkMRMLModelNode"), "Model"))
+    {
+    std::cerr << __LINE__ << ": wrong registered node class" << std::endl;
+    return false;
+    }
+
+  // Registering another class with the same tag replaces the previous one
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  scene->RegisterNodeClass(volumeNode.GetPointer(), "ObsoleteModel");
+  if (!isEqual(scene->GetClassNameByTag("ObsoleteModel"), "vtkMRMLScalarVolumeNode") ||
+      !isEqual(scene->GetTagByClassName("vtkMRMLModelNode"), "Model") ||
+      scene->GetClassNameByTag("UnknownTag") != 0 ||
+      scene->GetTagByClassName("vtkMRMLUnknownNode") != 0)
+    {
+    std::cerr << __LINE__ << ": wrong registered node class after replacement"
+              << std::endl;
+    return false;
+    }
+
+  vtkMRMLNode* node = scene->CreateNodeByClass("vtkMRMLModelNode");
+  if (!node || !node->IsA("vtkMRMLModelNode"))
+    {
+    std::cerr << __LINE__ << ": CreateNodeByClass failed" << std::endl;
+    return false;
+    }
+  node->Delete();
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool saveAndImport()
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLLinearTransformNode> transformNode;
+  scene->AddNode(transformNode.GetPointer());
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetAttribute("Category", "Bone");
+  modelNode->SetAttribute("Source", "file:model.vtk");
+  scene->AddNode(modelNode.GetPointer());
+  modelNode->SetAndObserveTransformNodeID(transformNode->GetID());
+
+  scene->SetSaveToXMLString(1);
+  scene->Commit();
+  std::string xmlScene = scene->GetSceneXMLString();
+  // Committing again replaces the previous XML
+  scene->Commit();
+  if (xmlScene.empty() || scene->GetSceneXMLString() != xmlScene)
+    {
+    std::cerr << __LINE__ << ": commit failed." << std::endl
+              << xmlScene << std::endl
+              << scene->GetSceneXMLString() << std::endl;
+    return false;
+    }
+
+  vtkNew<vtkMRMLScene> scene2;
+  scene2->SetLoadFromXMLString(1);
+  scene2->SetSceneXMLString(xmlScene);
+  scene2->Import();
+
+  vtkMRMLModelNode* importedModelNode = vtkMRMLModelNode::SafeDownCast(
+    scene2->GetNthNodeByClass(0, "vtkMRMLModelNode"));
+  if (!importedModelNode ||
+      !isEqual(importedModelNode->GetAttribute("Category"), "Bone") ||
+      !isEqual(importedModelNode->GetAttribute("Source"), "file:model.vtk") ||
+      !isEqual(importedModelNode->GetTransformNodeID(), transformNode->GetID()))
+    {
+    std::cerr << __LINE__ << ": import failed." << std::endl
+              << xmlScene << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
@@ -8,7 +8,15 @@
 #include <vtksys/SystemTools.hxx>
 
 #include <vtkCallbackCommand.h>
+#include <vtkCriticalSection.h>
 #include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
 
 vtkStandardNewMacro ( vtkCacheManager );
 vtkCxxRevisionMacro ( vtkCacheManager, "$Revision: 1.0 $" );
@@ -29,6 +37,9 @@ vtkCacheManager::vtkCacheManager()
   this->InsufficientFreeBufferNotificationFlag = 0;
   // this->EnableRemoteCacheOverwriting = 1;
   this->uriMap.clear();
+  this->CacheIndexSize = 0.;
+  this->CacheIndexJournalLength = 0;
+  this->CacheIndexLock = new vtkSimpleCriticalSection;
 }
 
 
@@ -49,6 +60,12 @@ vtkCacheManager::~vtkCacheManager()
   this->EnableForceRedownload = 0;
   this->InsufficientFreeBufferNotificationFlag = 0;
 //  this->EnableRemoteCacheOverwriting = 1;
+  //--- fold the journal into the index file
+  if (this->CacheIndexJournalLength > 0)
+    {
+    this->SaveCacheIndex();
+    }
+  delete this->CacheIndexLock;
 }
 
 
@@ -129,12 +146,19 @@ void vtkCacheManager::SetRemoteCacheDirectory (const char *dir )
     return;
     }
 
+  this->CacheIndexLock->Lock();
+  if (this->CacheIndexJournalLength > 0)
+    {
+    this->SaveCacheIndex();
+    }
   this->RemoteCacheDirectory = dirstring;
   if (!vtksys::SystemTools::FileExists(this->RemoteCacheDirectory.c_str()))
     {
     vtksys::SystemTools::MakeDirectory(this->RemoteCacheDirectory.c_str());
     }
-  // scan files in cache, it calls Modified
+  this->LoadCacheIndex();
+  this->CacheIndexLock->Unlock();
+  // list the files of the index, it calls Modified
   this->UpdateCacheInformation();
 }
 
@@ -308,7 +332,9 @@ int vtkCacheManager::GetCachedFileList ( const char *dirname )
               return (0);
               }
             }
-          else
+          else if ( strncmp(dir.GetFile(static_cast<unsigned long>(fileNum)),
+                            vtkCacheManager::GetCacheIndexFileName(),
+                            strlen(vtkCacheManager::GetCacheIndexFileName())) )
             {
             this->CachedFileList.push_back ( dir.GetFile(static_cast<unsigned long>(fileNum) ));
             }
@@ -515,9 +541,16 @@ void vtkCacheManager::UpdateCacheInformation ( )
   //--- recompute free buffer size
   // this->RemoteCacheFreeBufferSize = ?;
 
-  //--- and refresh list of cached files.
+  //--- and refresh list of cached files from the index.
+  this->CacheIndexLock->Lock();
   this->CachedFileList.clear();
-  this->GetCachedFileList ( this->GetRemoteCacheDirectory() );
+  for (std::map<std::string, CacheEntry>::const_iterator it = this->CacheIndex.begin();
+       it != this->CacheIndex.end(); ++it)
+    {
+    this->CachedFileList.push_back(vtksys::SystemTools::GetFilenameName(it->first));
+    }
+  this->CurrentCacheSize = static_cast<float>(this->CacheIndexSize / MB);
+  this->CacheIndexLock->Unlock();
   this->Modified();
 }
 
@@ -573,6 +606,7 @@ void vtkCacheManager::DeleteFromCache( const char *target )
 
     //--- remove the file or directory in str....
     vtkDebugMacro ( "Removing " << str.c_str() << " from disk and from record of cached files." );
+    this->RemoveCacheEntry ( str.c_str() );
     if ( vtksys::SystemTools::FileIsDirectory ( str.c_str() ) )
       {
       if ( !vtksys::SystemTools::RemoveADirectory ( str.c_str() ))
@@ -644,6 +678,11 @@ int vtkCacheManager::ClearCache()
     this->MarkNodesBeforeDeletingDataFromCache ( this->RemoteCacheDirectory.c_str() );
     vtksys::SystemTools::RemoveADirectory ( this->RemoteCacheDirectory.c_str() );
     }
+  this->CacheIndexLock->Lock();
+  this->CacheIndex.clear();
+  this->CacheIndexSize = 0.;
+  this->CacheIndexJournalLength = 0;
+  this->CacheIndexLock->Unlock();
   if ( vtksys::SystemTools::MakeDirectory ( this->RemoteCacheDirectory.c_str() ) == false )
     {
     vtkWarningMacro ( "Cache cleared: Error: unable to recreate cache directory after deleting its contents." );      
@@ -659,11 +698,10 @@ int vtkCacheManager::ClearCache()
 //----------------------------------------------------------------------------
 float vtkCacheManager::GetCurrentCacheSize ()
 {
-  if ( this->RemoteCacheDirectory.c_str() == NULL )
-    {
-    return (0.0);
-    }
-  float size = this->ComputeCacheSize ( this->RemoteCacheDirectory.c_str(), 0 );
+  //--- the index is kept up to date, no need to scan the cache directory
+  this->CacheIndexLock->Lock();
+  float size = static_cast<float>(this->CacheIndexSize / MB);
+  this->CacheIndexLock->Unlock();
   this->SetCurrentCacheSize ( size );
   return ( this->CurrentCacheSize );
 
@@ -832,7 +870,7 @@ void vtkCacheManager::CacheSizeCheck()
 {
   
   //--- Compute size of the current cache
-  this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+  this->GetCurrentCacheSize();
   //--- Invoke an event if cache size is exceeded.
   if ( this->CurrentCacheSize > (float) (this->RemoteCacheLimit) )
     {
@@ -845,7 +883,7 @@ void vtkCacheManager::CacheSizeCheck()
 float vtkCacheManager::GetFreeCacheSpaceRemaining()
 {
 
-  float cachesize = this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+  float cachesize = this->GetCurrentCacheSize();
   // cache limit - current cache size = total space left in cache.
   // total space in cache - free buffer size = amount that can be used.
   float diff = ( float (this->RemoteCacheLimit) - cachesize );
@@ -998,3 +1036,425 @@ const char* vtkCacheManager::FindCachedFile ( const char * target, const char *d
     }
 
 }
+
+//----------------------------------------------------------------------------
+const char* vtkCacheManager::GetCacheIndexFileName()
+{
+  return ".SlicerCacheIndex";
+}
+
+//----------------------------------------------------------------------------
+std::string vtkCacheManager::GetCacheIndexKey(const char *filename)
+{
+  if (filename == NULL || this->RemoteCacheDirectory.empty())
+    {
+    return std::string();
+    }
+  std::string cacheDir =
+    vtksys::SystemTools::CollapseFullPath(this->RemoteCacheDirectory.c_str());
+  std::string path = filename;
+  vtksys::SystemTools::ConvertToUnixSlashes(path);
+  if (!vtksys::SystemTools::FileIsFullPath(path.c_str()))
+    {
+    //--- a file name relative to the cache directory
+    path = cacheDir + "/" + path;
+    }
+  path = vtksys::SystemTools::CollapseFullPath(path.c_str());
+  if (path.size() <= cacheDir.size() + 1 ||
+      path.compare(0, cacheDir.size(), cacheDir) != 0 ||
+      path[cacheDir.size()] != '/')
+    {
+    return std::string();
+    }
+  return path.substr(cacheDir.size() + 1);
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AddCacheIndexEntry(const std::string& key,
+                                         const std::string& uri,
+                                         double lastAccess)
+{
+  std::string path = this->RemoteCacheDirectory + "/" + key;
+  if (vtksys::SystemTools::FileIsDirectory(path.c_str()))
+    {
+    vtksys::Directory dir;
+    dir.Load(path.c_str());
+    for (unsigned long fileNum = 0; fileNum < dir.GetNumberOfFiles(); ++fileNum)
+      {
+      if (strcmp(dir.GetFile(fileNum), ".") && strcmp(dir.GetFile(fileNum), ".."))
+        {
+        this->AddCacheIndexEntry(key + "/" + dir.GetFile(fileNum), uri, lastAccess);
+        }
+      }
+    return;
+    }
+  if (key.compare(0, strlen(vtkCacheManager::GetCacheIndexFileName()),
+                  vtkCacheManager::GetCacheIndexFileName()) == 0 ||
+      !vtksys::SystemTools::FileExists(path.c_str()))
+    {
+    return;
+    }
+  std::map<std::string, CacheEntry>::iterator it = this->CacheIndex.find(key);
+  if (it == this->CacheIndex.end())
+    {
+    CacheEntry newEntry;
+    newEntry.Size = 0;
+    it = this->CacheIndex.insert(std::make_pair(key, newEntry)).first;
+    }
+  CacheEntry& entry = it->second;
+  this->CacheIndexSize -= entry.Size;
+  entry.Size = vtksys::SystemTools::FileLength(path.c_str());
+  entry.LastAccess = lastAccess;
+  if (!uri.empty())
+    {
+    entry.SourceURI = uri;
+    }
+  this->CacheIndexSize += entry.Size;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::RemoveCacheIndexEntries(const std::string& key)
+{
+  //--- the entry itself and all the entries under it if it is a directory
+  std::map<std::string, CacheEntry>::iterator it = this->CacheIndex.lower_bound(key);
+  while (it != this->CacheIndex.end() &&
+         it->first.compare(0, key.size(), key) == 0)
+    {
+    if (it->first.size() == key.size() || it->first[key.size()] == '/')
+      {
+      this->CacheIndexSize -= it->second.Size;
+      this->CacheIndex.erase(it++);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AddCacheIndexDirectory(const std::string& key)
+{
+  std::string path = this->RemoteCacheDirectory;
+  if (!key.empty())
+    {
+    path += "/" + key;
+    }
+  vtksys::Directory dir;
+  if (!dir.Load(path.c_str()))
+    {
+    return;
+    }
+  for (unsigned long fileNum = 0; fileNum < dir.GetNumberOfFiles(); ++fileNum)
+    {
+    const char* name = dir.GetFile(fileNum);
+    if (!strcmp(name, ".") || !strcmp(name, ".."))
+      {
+      continue;
+      }
+    std::string fileKey = key.empty() ? std::string(name) : key + "/" + name;
+    std::string filePath = this->RemoteCacheDirectory + "/" + fileKey;
+    if (vtksys::SystemTools::FileIsDirectory(filePath.c_str()))
+      {
+      this->AddCacheIndexDirectory(fileKey);
+      }
+    else
+      {
+      //--- files found on disk are considered as accessed when modified
+      this->AddCacheIndexEntry(fileKey, std::string(),
+        static_cast<double>(vtksys::SystemTools::ModifiedTime(filePath.c_str())));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::LoadCacheIndex()
+{
+  this->CacheIndex.clear();
+  this->CacheIndexSize = 0.;
+  std::string indexFileName =
+    this->RemoteCacheDirectory + "/" + vtkCacheManager::GetCacheIndexFileName();
+  std::ifstream indexFile(indexFileName.c_str());
+  if (!indexFile.is_open())
+    {
+    //--- first use of the cache directory: scan it once
+    this->AddCacheIndexDirectory(std::string());
+    this->SaveCacheIndex();
+    return;
+    }
+  //--- one entry per line: size, last access, path and source URI
+  //--- separated by tabs. The journal lines appended after the entries
+  //--- replace them, a "-" size removes the path.
+  std::string line;
+  int numberOfLines = 0;
+  while (std::getline(indexFile, line))
+    {
+    ++numberOfLines;
+    std::string::size_type tab1 = line.find('\t');
+    std::string::size_type tab2 = tab1 == std::string::npos ?
+      std::string::npos : line.find('\t', tab1 + 1);
+    std::string::size_type tab3 = tab2 == std::string::npos ?
+      std::string::npos : line.find('\t', tab2 + 1);
+    if (tab3 == std::string::npos)
+      {
+      continue;
+      }
+    std::string key = line.substr(tab2 + 1, tab3 - tab2 - 1);
+    if (line.compare(0, tab1, "-") == 0)
+      {
+      this->RemoveCacheIndexEntries(key);
+      continue;
+      }
+    CacheEntry entry;
+    std::stringstream sizeStream(line.substr(0, tab1));
+    sizeStream >> entry.Size;
+    std::stringstream accessStream(line.substr(tab1 + 1, tab2 - tab1 - 1));
+    accessStream >> entry.LastAccess;
+    entry.SourceURI = line.substr(tab3 + 1);
+    std::map<std::string, CacheEntry>::iterator it = this->CacheIndex.find(key);
+    if (it != this->CacheIndex.end())
+      {
+      this->CacheIndexSize -= it->second.Size;
+      it->second = entry;
+      }
+    else
+      {
+      this->CacheIndex[key] = entry;
+      }
+    this->CacheIndexSize += entry.Size;
+    }
+  this->CacheIndexJournalLength =
+    numberOfLines - static_cast<int>(this->CacheIndex.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::SaveCacheIndex()
+{
+  if (this->RemoteCacheDirectory.empty() ||
+      !vtksys::SystemTools::FileIsDirectory(this->RemoteCacheDirectory.c_str()))
+    {
+    return;
+    }
+  std::string indexFileName =
+    this->RemoteCacheDirectory + "/" + vtkCacheManager::GetCacheIndexFileName();
+  //--- write a temporary file and rename it so a crash never leaves a
+  //--- truncated index
+  std::string tmpFileName = indexFileName + ".tmp";
+  {
+  std::ofstream indexFile(tmpFileName.c_str());
+  if (!indexFile.is_open())
+    {
+    vtkWarningMacro("SaveCacheIndex: unable to write " << tmpFileName);
+    return;
+    }
+  indexFile.precision(16);
+  for (std::map<std::string, CacheEntry>::const_iterator it = this->CacheIndex.begin();
+       it != this->CacheIndex.end(); ++it)
+    {
+    indexFile << it->second.Size << "\t" << it->second.LastAccess << "\t"
+              << it->first << "\t" << it->second.SourceURI << "\n";
+    }
+  }
+  vtksys::SystemTools::RemoveFile(indexFileName.c_str());
+  if (rename(tmpFileName.c_str(), indexFileName.c_str()) != 0)
+    {
+    vtkWarningMacro("SaveCacheIndex: unable to write " << indexFileName);
+    return;
+    }
+  this->CacheIndexJournalLength = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AppendCacheIndexJournal(const std::string& key)
+{
+  if (this->RemoteCacheDirectory.empty() ||
+      !vtksys::SystemTools::FileIsDirectory(this->RemoteCacheDirectory.c_str()))
+    {
+    return;
+    }
+  //--- rewrite the index once the journal is longer than the index itself
+  //--- (but never for a few lines)
+  if (this->CacheIndexJournalLength >=
+      std::max(static_cast<int>(this->CacheIndex.size()), 1000))
+    {
+    this->SaveCacheIndex();
+    return;
+    }
+  std::string indexFileName =
+    this->RemoteCacheDirectory + "/" + vtkCacheManager::GetCacheIndexFileName();
+  std::ofstream indexFile(indexFileName.c_str(), std::ios::out | std::ios::app);
+  if (!indexFile.is_open())
+    {
+    vtkWarningMacro("AppendCacheIndexJournal: unable to write " << indexFileName);
+    return;
+    }
+  indexFile.precision(16);
+  //--- the entry itself and all the entries under it if it is a directory
+  bool found = false;
+  for (std::map<std::string, CacheEntry>::const_iterator it = this->CacheIndex.lower_bound(key);
+       it != this->CacheIndex.end() && it->first.compare(0, key.size(), key) == 0; ++it)
+    {
+    if (it->first.size() == key.size() || it->first[key.size()] == '/')
+      {
+      indexFile << it->second.Size << "\t" << it->second.LastAccess << "\t"
+                << it->first << "\t" << it->second.SourceURI << "\n";
+      ++this->CacheIndexJournalLength;
+      found = true;
+      }
+    }
+  if (!found)
+    {
+    indexFile << "-\t0\t" << key << "\t\n";
+    ++this->CacheIndexJournalLength;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AddCacheEntry(const char *filename, const char *uri)
+{
+  std::string key = this->GetCacheIndexKey(filename);
+  if (key.empty())
+    {
+    vtkDebugMacro("AddCacheEntry: " << (filename ? filename : "(null)")
+                  << " is not in the cache directory.");
+    return;
+    }
+  this->CacheIndexLock->Lock();
+  this->AddCacheIndexEntry(key, uri ? uri : "", vtkTimerLog::GetUniversalTime());
+  this->AppendCacheIndexJournal(key);
+  this->CacheIndexLock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::TouchCacheEntry(const char *filename)
+{
+  std::string key = this->GetCacheIndexKey(filename);
+  if (key.empty())
+    {
+    return;
+    }
+  this->CacheIndexLock->Lock();
+  std::map<std::string, CacheEntry>::iterator it = this->CacheIndex.find(key);
+  if (it != this->CacheIndex.end())
+    {
+    it->second.LastAccess = vtkTimerLog::GetUniversalTime();
+    this->AppendCacheIndexJournal(key);
+    }
+  this->CacheIndexLock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::RemoveCacheEntry(const char *filename)
+{
+  std::string key = this->GetCacheIndexKey(filename);
+  if (key.empty())
+    {
+    return;
+    }
+  this->CacheIndexLock->Lock();
+  this->RemoveCacheIndexEntries(key);
+  this->AppendCacheIndexJournal(key);
+  this->CacheIndexLock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+int vtkCacheManager::GetNumberOfCacheEntries()
+{
+  this->CacheIndexLock->Lock();
+  int numberOfEntries = static_cast<int>(this->CacheIndex.size());
+  this->CacheIndexLock->Unlock();
+  return numberOfEntries;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::RebuildCacheIndex()
+{
+  this->CacheIndexLock->Lock();
+  std::map<std::string, CacheEntry> oldIndex;
+  oldIndex.swap(this->CacheIndex);
+  this->CacheIndexSize = 0.;
+  this->AddCacheIndexDirectory(std::string());
+  //--- keep the access times and URIs of the files still there
+  for (std::map<std::string, CacheEntry>::iterator it = this->CacheIndex.begin();
+       it != this->CacheIndex.end(); ++it)
+    {
+    std::map<std::string, CacheEntry>::const_iterator oldIt = oldIndex.find(it->first);
+    if (oldIt != oldIndex.end())
+      {
+      it->second.LastAccess = oldIt->second.LastAccess;
+      it->second.SourceURI = oldIt->second.SourceURI;
+      }
+    }
+  this->SaveCacheIndex();
+  this->CacheIndexLock->Unlock();
+  this->UpdateCacheInformation();
+}
+
+//----------------------------------------------------------------------------
+int vtkCacheManager::EvictLeastRecentlyUsedFiles()
+{
+  const double maximumSize =
+    (this->RemoteCacheLimit - this->RemoteCacheFreeBufferSize) * MB;
+
+  //--- files read by the nodes of the scene must stay in the cache
+  std::set<std::string> usedKeys;
+  if (this->MRMLScene)
+    {
+    std::vector<vtkMRMLNode*> storageNodes;
+    this->MRMLScene->GetNodesByClass("vtkMRMLStorageNode", storageNodes);
+    for (std::vector<vtkMRMLNode*>::const_iterator it = storageNodes.begin();
+         it != storageNodes.end(); ++it)
+      {
+      vtkMRMLStorageNode* storageNode = vtkMRMLStorageNode::SafeDownCast(*it);
+      if (storageNode && storageNode->GetFileName())
+        {
+        usedKeys.insert(this->GetCacheIndexKey(
+          storageNode->GetFullNameFromFileName().c_str()));
+        for (int n = 0; n < storageNode->GetNumberOfFileNames(); ++n)
+          {
+          usedKeys.insert(this->GetCacheIndexKey(
+            storageNode->GetFullNameFromNthFileName(n).c_str()));
+          }
+        }
+      }
+    }
+
+  int removed = 0;
+  this->CacheIndexLock->Lock();
+  if (this->CacheIndexSize > maximumSize)
+    {
+    std::vector<std::pair<double, std::string> > entries;
+    for (std::map<std::string, CacheEntry>::const_iterator it = this->CacheIndex.begin();
+         it != this->CacheIndex.end(); ++it)
+      {
+      if (usedKeys.find(it->first) == usedKeys.end())
+        {
+        entries.push_back(std::make_pair(it->second.LastAccess, it->first));
+        }
+      }
+    std::sort(entries.begin(), entries.end());
+    for (std::vector<std::pair<double, std::string> >::const_iterator it = entries.begin();
+         it != entries.end() && this->CacheIndexSize > maximumSize; ++it)
+      {
+      std::string path = this->RemoteCacheDirectory + "/" + it->second;
+      vtkDebugMacro("EvictLeastRecentlyUsedFiles: removing " << path);
+      if (vtksys::SystemTools::FileExists(path.c_str()) &&
+          !vtksys::SystemTools::RemoveFile(path.c_str()))
+        {
+        vtkWarningMacro("Unable to remove cached file " << path << " from disk.");
+        continue;
+        }
+      this->RemoveCacheIndexEntries(it->second);
+      this->AppendCacheIndexJournal(it->second);
+      ++removed;
+      }
+    }
+  this->CacheIndexLock->Unlock();
+
+  if (removed)
+    {
+    this->UpdateCacheInformation();
+    this->InvokeEvent(vtkCacheManager::CacheDeleteEvent);
+    }
+  return removed;
+}
@@ -5,6 +5,7 @@
 #include "vtkMRML.h"
 class vtkCallbackCommand;
 class vtkMRMLScene;
+class vtkSimpleCriticalSection;
 
 // VTK includes
 #include <vtkObject.h>
@@ -18,6 +19,19 @@ class vtkMRMLScene;
 #define vtkObjectPointer(xx) (reinterpret_cast <vtkObject **>( (xx) ))
 #endif
 
+/// \brief Manage the local cache of the remote files.
+///
+/// The files of the cache are recorded in an index with their size, last
+/// access time and source URI. The index is saved in the cache directory
+/// (see GetCacheIndexFileName()) and loaded by SetRemoteCacheDirectory():
+/// the cache directory is only scanned when there is no index yet or when
+/// RebuildCacheIndex() is called. Adding, touching and removing an entry
+/// only appends a line to the index file; the file is rewritten when these
+/// lines outnumber the entries (and 1000), when the cache directory changes
+/// and when the cache manager is deleted. The cache size is computed from the
+/// index, and the least recently used files can be evicted to keep the
+/// cache within RemoteCacheLimit.
+/// The index methods can be called concurrently from the data I/O threads.
 class VTK_MRML_EXPORT vtkCacheManager : public vtkObject 
 {
   public:
@@ -116,6 +130,33 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
 
   std::vector< std::string > GetCachedFiles()const;
 
+  /// 
+  /// Record a file (or directory) downloaded from uri into the cache, or
+  /// update its size and last access time if it is already recorded.
+  void AddCacheEntry(const char *filename, const char *uri);
+  /// 
+  /// Update the last access time of a cached file
+  void TouchCacheEntry(const char *filename);
+  /// 
+  /// Forget a cached file, or all the cached files of a directory
+  void RemoveCacheEntry(const char *filename);
+  /// 
+  /// Number of files recorded in the cache index
+  int GetNumberOfCacheEntries();
+  /// 
+  /// Scan the cache directory and rebuild the cache index. The last access
+  /// time of the files already recorded is kept.
+  void RebuildCacheIndex();
+  /// 
+  /// Remove the least recently used files from the cache until it fits in
+  /// RemoteCacheLimit minus RemoteCacheFreeBufferSize. The files read by the
+  /// storage nodes of the scene are never removed. Must be called from the
+  /// main thread. Returns the number of removed files.
+  int EvictLeastRecentlyUsedFiles();
+  /// 
+  /// Name of the index file in the cache directory
+  static const char* GetCacheIndexFileName();
+
   /// 
   vtkGetMacro ( RemoteCacheLimit, int );
   vtkSetMacro ( RemoteCacheLimit, int );
@@ -172,6 +213,32 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   /// with every download, remove from cache, and clearcache call.
   std::vector< std::string > CachedFileList;
 
+  struct CacheEntry
+    {
+    unsigned long Size;
+    double LastAccess;
+    std::string SourceURI;
+    };
+  /// Entries by path relative to the cache directory
+  std::map<std::string, CacheEntry> CacheIndex;
+  double CacheIndexSize;
+  /// Number of lines appended to the index file since it was last written
+  int CacheIndexJournalLength;
+  vtkSimpleCriticalSection* CacheIndexLock;
+
+  /// Path of a file relative to the cache directory, empty if the file is
+  /// not in the cache directory
+  std::string GetCacheIndexKey(const char *filename);
+  /// The following methods expect the index to be locked
+  void AddCacheIndexEntry(const std::string& key, const std::string& uri, double lastAccess);
+  void RemoveCacheIndexEntries(const std::string& key);
+  void AddCacheIndexDirectory(const std::string& key);
+  void LoadCacheIndex();
+  void SaveCacheIndex();
+  /// Append the entries of key (or its removal if there is none) to the
+  /// index file, rewrite the whole file if the journal got too long
+  void AppendCacheIndexJournal(const std::string& key);
+
  protected:
   vtkCacheManager();
   virtual ~vtkCacheManager();
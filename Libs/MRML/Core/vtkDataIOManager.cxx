@@ -397,6 +397,9 @@ void vtkDataIOManager::QueueRead ( vtkMRMLNode *node )
     //--- a large scene that consists of multiple datasets.
     //--- ***The risk with this implementation  is that they may
     //--- forget to adjust the cache size, but aren't notified again... 
+    //--- make room for the download by removing the least recently
+    //--- used files that no node reads.
+    cm->EvictLeastRecentlyUsedFiles();
     float bufsize = (cm->GetRemoteCacheLimit() * 1000000.0) -  (cm->GetRemoteCacheFreeBufferSize() * 1000000.0);
     if ( (cm->GetCurrentCacheSize()*1000000.0) >= bufsize )
       {
@@ -0,0 +1,677 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkImageBrickCache.h"
+
+// VTK includes
+#include <vtkByteSwap.h>
+#include <vtkCriticalSection.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkTimeStamp.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <vector>
+
+//----------------------------------------------------------------------------
+class vtkImageBrickCache::vtkInternal
+{
+public:
+  struct Brick
+    {
+    std::vector<char> Voxels;
+    std::list<vtkIdType>::iterator Position;
+    };
+
+  std::ifstream File;
+  vtkTimeStamp FileTime;
+  int NumberOfBricks[3];
+  /// Cached bricks by index, and their indices from the most to the least
+  /// recently used
+  std::map<vtkIdType, Brick> Bricks;
+  std::list<vtkIdType> LeastRecentlyUsed;
+  vtkTypeInt64 CacheSize;
+  /// Serialize FillImage()
+  vtkSimpleCriticalSection FillLock;
+};
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string Trim(const std::string& str)
+{
+  std::string::size_type first = str.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos)
+    {
+    return std::string();
+    }
+  std::string::size_type last = str.find_last_not_of(" \t\r\n");
+  return str.substr(first, last - first + 1);
+}
+
+//----------------------------------------------------------------------------
+int NRRDScalarType(const std::string& type)
+{
+  if (type == "signed char" || type == "int8" || type == "int8_t")
+    {
+    return VTK_SIGNED_CHAR;
+    }
+  if (type == "uchar" || type == "unsigned char" || type == "uint8" || type == "uint8_t")
+    {
+    return VTK_UNSIGNED_CHAR;
+    }
+  if (type == "short" || type == "short int" || type == "signed short" ||
+      type == "signed short int" || type == "int16" || type == "int16_t")
+    {
+    return VTK_SHORT;
+    }
+  if (type == "ushort" || type == "unsigned short" || type == "unsigned short int" ||
+      type == "uint16" || type == "uint16_t")
+    {
+    return VTK_UNSIGNED_SHORT;
+    }
+  if (type == "int" || type == "signed int" || type == "int32" || type == "int32_t")
+    {
+    return VTK_INT;
+    }
+  if (type == "uint" || type == "unsigned int" || type == "uint32" || type == "uint32_t")
+    {
+    return VTK_UNSIGNED_INT;
+    }
+  if (type == "float")
+    {
+    return VTK_FLOAT;
+    }
+  if (type == "double")
+    {
+    return VTK_DOUBLE;
+    }
+  return VTK_VOID;
+}
+
+//----------------------------------------------------------------------------
+int ScalarSize(int scalarType)
+{
+  switch (scalarType)
+    {
+    vtkTemplateMacro(return sizeof(VTK_TT));
+    default:
+      break;
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool IntersectSlab(const int extent[6], const double* slab)
+{
+  double center = -slab[3];
+  double radius = slab[4];
+  for (int i = 0; i < 3; ++i)
+    {
+    // Voxels are points, a brick spans from its first to its last voxel
+    center += slab[i] * 0.5 * (extent[2*i] + extent[2*i+1]);
+    radius += fabs(slab[i]) * 0.5 * (extent[2*i+1] - extent[2*i]);
+    }
+  return fabs(center) <= radius;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageBrickCache);
+
+//----------------------------------------------------------------------------
+vtkImageBrickCache::vtkImageBrickCache()
+{
+  this->FileName = 0;
+  this->HeaderSize = 0;
+  this->Dimensions[0] = this->Dimensions[1] = this->Dimensions[2] = 0;
+  this->ScalarType = VTK_UNSIGNED_SHORT;
+  this->NumberOfScalarComponents = 1;
+  this->SwapBytes = 0;
+  this->BrickSize = 64;
+  this->MaximumCacheSize = 512;
+  this->NumberOfBrickReads = 0;
+  this->Internal = new vtkInternal;
+  this->Internal->CacheSize = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageBrickCache::~vtkImageBrickCache()
+{
+  this->SetFileName(0);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBrickCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FileName: " << (this->FileName ? this->FileName : "(none)") << "\n";
+  os << indent << "HeaderSize: " << this->HeaderSize << "\n";
+  os << indent << "Dimensions: " << this->Dimensions[0] << " "
+     << this->Dimensions[1] << " " << this->Dimensions[2] << "\n";
+  os << indent << "ScalarType: " << this->ScalarType << "\n";
+  os << indent << "NumberOfScalarComponents: " << this->NumberOfScalarComponents << "\n";
+  os << indent << "SwapBytes: " << this->SwapBytes << "\n";
+  os << indent << "BrickSize: " << this->BrickSize << "\n";
+  os << indent << "MaximumCacheSize: " << this->MaximumCacheSize << "\n";
+  os << indent << "NumberOfCachedBricks: " << this->Internal->Bricks.size() << "\n";
+  os << indent << "CacheSizeInBytes: " << this->Internal->CacheSize << "\n";
+  os << indent << "NumberOfBrickReads: " << this->NumberOfBrickReads << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::ReadNRRDHeader(const char* fileName)
+{
+  std::ifstream header(fileName, std::ios::in | std::ios::binary);
+  std::string line;
+  if (!header.is_open() || !std::getline(header, line) ||
+      Trim(line).compare(0, 4, "NRRD") != 0)
+    {
+    vtkErrorMacro("ReadNRRDHeader: " << fileName << " is not a NRRD file");
+    return 0;
+    }
+
+  std::string encoding = "raw";
+  std::string endian;
+  std::string dataFile;
+  int scalarType = VTK_VOID;
+  int dimension = 0;
+  std::vector<int> sizes;
+  int lineSkip = 0;
+  vtkTypeInt64 byteSkip = 0;
+  bool attached = true;
+  vtkTypeInt64 dataStart = 0;
+  while (std::getline(header, line))
+    {
+    line = Trim(line);
+    if (line.empty())
+      {
+      // End of the header, the data follows when attached
+      dataStart = static_cast<vtkTypeInt64>(header.tellg());
+      break;
+      }
+    std::string::size_type colon = line.find(':');
+    if (line[0] == '#' || colon == std::string::npos ||
+        (colon + 1 < line.size() && line[colon + 1] == '='))
+      {
+      // comment or key/value pair
+      continue;
+      }
+    std::string field = line.substr(0, colon);
+    std::string value = Trim(line.substr(colon + 1));
+    if (field == "type")
+      {
+      scalarType = NRRDScalarType(value);
+      }
+    else if (field == "dimension")
+      {
+      dimension = atoi(value.c_str());
+      }
+    else if (field == "sizes")
+      {
+      std::istringstream ss(value);
+      int size;
+      while (ss >> size)
+        {
+        sizes.push_back(size);
+        }
+      }
+    else if (field == "encoding")
+      {
+      encoding = value;
+      }
+    else if (field == "endian")
+      {
+      endian = value;
+      }
+    else if (field == "line skip" || field == "lineskip")
+      {
+      lineSkip = atoi(value.c_str());
+      }
+    else if (field == "byte skip" || field == "byteskip")
+      {
+      std::istringstream ss(value);
+      ss >> byteSkip;
+      }
+    else if (field == "data file" || field == "datafile")
+      {
+      dataFile = value;
+      attached = false;
+      }
+    }
+
+  if (encoding != "raw")
+    {
+    vtkDebugMacro("ReadNRRDHeader: " << encoding << " encoding can't be read by bricks");
+    return 0;
+    }
+  if (scalarType == VTK_VOID)
+    {
+    vtkDebugMacro("ReadNRRDHeader: unsupported type in " << fileName);
+    return 0;
+    }
+  if (dimension != static_cast<int>(sizes.size()) || (dimension != 3 && dimension != 4))
+    {
+    vtkDebugMacro("ReadNRRDHeader: unsupported dimension in " << fileName);
+    return 0;
+    }
+  if (dataFile.compare(0, 4, "LIST") == 0 || dataFile.find(' ') != std::string::npos)
+    {
+    vtkDebugMacro("ReadNRRDHeader: data split in several files can't be read by bricks");
+    return 0;
+    }
+  if (!attached && !vtksys::SystemTools::FileIsFullPath(dataFile.c_str()))
+    {
+    dataFile = vtksys::SystemTools::GetFilenamePath(fileName) + "/" + dataFile;
+    }
+  else if (attached)
+    {
+    dataFile = fileName;
+    }
+
+  int components = dimension == 4 ? sizes[0] : 1;
+  int dimensions[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    dimensions[i] = sizes[dimension - 3 + i];
+    }
+
+  std::ifstream data(dataFile.c_str(), std::ios::in | std::ios::binary);
+  if (!data.is_open())
+    {
+    vtkErrorMacro("ReadNRRDHeader: can't open " << dataFile);
+    return 0;
+    }
+  vtkTypeInt64 headerSize = attached ? dataStart : 0;
+  if (byteSkip == -1)
+    {
+    // the data is at the end of the file
+    vtkTypeInt64 dataSize = static_cast<vtkTypeInt64>(dimensions[0]) *
+      dimensions[1] * dimensions[2] * components * ScalarSize(scalarType);
+    data.seekg(0, std::ios::end);
+    headerSize = static_cast<vtkTypeInt64>(data.tellg()) - dataSize;
+    }
+  else
+    {
+    data.seekg(static_cast<std::streamoff>(headerSize));
+    for (int i = 0; i < lineSkip && std::getline(data, line); ++i)
+      {
+      }
+    headerSize = static_cast<vtkTypeInt64>(data.tellg()) + byteSkip;
+    }
+  if (headerSize < 0 || !data.good())
+    {
+    vtkErrorMacro("ReadNRRDHeader: the data of " << fileName << " is truncated");
+    return 0;
+    }
+
+  this->SetFileName(dataFile.c_str());
+  this->SetHeaderSize(headerSize);
+  this->SetDimensions(dimensions);
+  this->SetScalarType(scalarType);
+  this->SetNumberOfScalarComponents(components);
+#ifdef VTK_WORDS_BIGENDIAN
+  this->SetSwapBytes(endian == "little");
+#else
+  this->SetSwapBytes(endian == "big");
+#endif
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBrickCache::SetMaximumCacheSize(int size)
+{
+  size = std::max(size, 1);
+  if (size == this->MaximumCacheSize)
+    {
+    return;
+    }
+  // Not a change of configuration: don't release all the bricks
+  this->MaximumCacheSize = size;
+  this->EvictBricks();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::GetVoxelSize()
+{
+  return ScalarSize(this->ScalarType) * this->NumberOfScalarComponents;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::UpdateFile()
+{
+  if (this->Internal->File.is_open() &&
+      this->Internal->FileTime.GetMTime() >= this->GetMTime())
+    {
+    return 1;
+    }
+  this->ReleaseBricks();
+  this->Internal->File.close();
+  this->Internal->File.clear();
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Internal->NumberOfBricks[i] =
+      (this->Dimensions[i] + this->BrickSize - 1) / this->BrickSize;
+    }
+  if (!this->FileName || this->GetVoxelSize() == 0)
+    {
+    return 0;
+    }
+  this->Internal->File.open(this->FileName, std::ios::in | std::ios::binary);
+  if (!this->Internal->File.is_open())
+    {
+    vtkErrorMacro("UpdateFile: can't open " << this->FileName);
+    return 0;
+    }
+  this->Internal->FileTime.Modified();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::ReadVoxels(vtkTypeInt64 voxelIndex,
+                                   vtkTypeInt64 numberOfVoxels, char* buffer)
+{
+  const int voxelSize = this->GetVoxelSize();
+  std::ifstream& file = this->Internal->File;
+  file.seekg(static_cast<std::streamoff>(this->HeaderSize + voxelIndex * voxelSize));
+  file.read(buffer, static_cast<std::streamsize>(numberOfVoxels * voxelSize));
+  if (!file.good())
+    {
+    file.clear();
+    vtkErrorMacro("ReadVoxels: can't read " << numberOfVoxels
+                  << " voxels at " << voxelIndex << " in " << this->FileName);
+    return 0;
+    }
+  if (this->SwapBytes)
+    {
+    const int scalarSize = voxelSize / this->NumberOfScalarComponents;
+    vtkByteSwap::SwapVoidRange(buffer,
+      static_cast<int>(numberOfVoxels * this->NumberOfScalarComponents), scalarSize);
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::ReadBrick(const int brickExtent[6], char* buffer)
+{
+  const vtkTypeInt64 dims[3] =
+    {this->Dimensions[0], this->Dimensions[1], this->Dimensions[2]};
+  const int width = brickExtent[1] - brickExtent[0] + 1;
+  const int height = brickExtent[3] - brickExtent[2] + 1;
+  const int depth = brickExtent[5] - brickExtent[4] + 1;
+  const int voxelSize = this->GetVoxelSize();
+  const bool fullRows = width == dims[0];
+  const bool fullSlices = fullRows && height == dims[1];
+  // Read the largest contiguous runs of voxels of the file
+  if (fullSlices)
+    {
+    return this->ReadVoxels(brickExtent[4] * dims[0] * dims[1],
+      static_cast<vtkTypeInt64>(width) * height * depth, buffer);
+    }
+  for (int k = brickExtent[4]; k <= brickExtent[5]; ++k)
+    {
+    if (fullRows)
+      {
+      if (!this->ReadVoxels((k * dims[1] + brickExtent[2]) * dims[0],
+                            static_cast<vtkTypeInt64>(width) * height, buffer))
+        {
+        return 0;
+        }
+      buffer += static_cast<size_t>(width) * height * voxelSize;
+      continue;
+      }
+    for (int j = brickExtent[2]; j <= brickExtent[3]; ++j)
+      {
+      if (!this->ReadVoxels((k * dims[1] + j) * dims[0] + brickExtent[0], width, buffer))
+        {
+        return 0;
+        }
+      buffer += static_cast<size_t>(width) * voxelSize;
+      }
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+const char* vtkImageBrickCache::GetBrick(int i, int j, int k)
+{
+  vtkInternal* internal = this->Internal;
+  const vtkIdType id =
+    (static_cast<vtkIdType>(k) * internal->NumberOfBricks[1] + j) * internal->NumberOfBricks[0] + i;
+  std::map<vtkIdType, vtkInternal::Brick>::iterator it = internal->Bricks.find(id);
+  if (it != internal->Bricks.end())
+    {
+    // Most recently used
+    internal->LeastRecentlyUsed.splice(internal->LeastRecentlyUsed.begin(),
+                                       internal->LeastRecentlyUsed, it->second.Position);
+    return &it->second.Voxels[0];
+    }
+
+  int brickExtent[6];
+  const int ijk[3] = {i, j, k};
+  size_t brickSize = this->GetVoxelSize();
+  for (int d = 0; d < 3; ++d)
+    {
+    brickExtent[2*d] = ijk[d] * this->BrickSize;
+    brickExtent[2*d+1] = std::min(brickExtent[2*d] + this->BrickSize, this->Dimensions[d]) - 1;
+    brickSize *= brickExtent[2*d+1] - brickExtent[2*d] + 1;
+    }
+  vtkInternal::Brick& brick = internal->Bricks[id];
+  brick.Voxels.resize(brickSize);
+  if (!this->ReadBrick(brickExtent, &brick.Voxels[0]))
+    {
+    internal->Bricks.erase(id);
+    return 0;
+    }
+  ++this->NumberOfBrickReads;
+  internal->LeastRecentlyUsed.push_front(id);
+  brick.Position = internal->LeastRecentlyUsed.begin();
+  internal->CacheSize += brickSize;
+  this->EvictBricks();
+  return &brick.Voxels[0];
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBrickCache::EvictBricks()
+{
+  vtkInternal* internal = this->Internal;
+  const vtkTypeInt64 maximumSize =
+    static_cast<vtkTypeInt64>(this->MaximumCacheSize) * 1024 * 1024;
+  // The most recently used brick is always kept: it is being copied
+  while (internal->CacheSize > maximumSize && internal->LeastRecentlyUsed.size() > 1)
+    {
+    std::map<vtkIdType, vtkInternal::Brick>::iterator it =
+      internal->Bricks.find(internal->LeastRecentlyUsed.back());
+    internal->CacheSize -= it->second.Voxels.size();
+    internal->Bricks.erase(it);
+    internal->LeastRecentlyUsed.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBrickCache::ReleaseBricks()
+{
+  this->Internal->Bricks.clear();
+  this->Internal->LeastRecentlyUsed.clear();
+  this->Internal->CacheSize = 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::GetNumberOfCachedBricks()
+{
+  return static_cast<int>(this->Internal->Bricks.size());
+}
+
+//----------------------------------------------------------------------------
+vtkTypeInt64 vtkImageBrickCache::GetCacheSizeInBytes()
+{
+  return this->Internal->CacheSize;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::FillImage(vtkImageData* image, const int extent[6],
+                                  const double* slab)
+{
+  this->Internal->FillLock.Lock();
+  const int success = this->FillExtent(image, extent, slab);
+  this->Internal->FillLock.Unlock();
+  return success;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::FillExtent(vtkImageData* image, const int extent[6],
+                                   const double* slab)
+{
+  if (!image || !this->UpdateFile())
+    {
+    return 0;
+    }
+  int imageExtent[6];
+  image->GetExtent(imageExtent);
+  const int voxelSize = this->GetVoxelSize();
+  if (image->GetScalarSize() * image->GetNumberOfScalarComponents() != voxelSize)
+    {
+    vtkErrorMacro("FillImage: the scalars of the image don't match the file");
+    return 0;
+    }
+  const vtkIdType rowIncrement =
+    static_cast<vtkIdType>(imageExtent[1] - imageExtent[0] + 1) * voxelSize;
+  const vtkIdType sliceIncrement = rowIncrement * (imageExtent[3] - imageExtent[2] + 1);
+  char* imagePtr = static_cast<char*>(image->GetScalarPointer());
+
+  int firstBrick[3];
+  int lastBrick[3];
+  bool outside = false;
+  for (int d = 0; d < 3; ++d)
+    {
+    firstBrick[d] = std::max(extent[2*d], 0) / this->BrickSize;
+    lastBrick[d] = std::min(extent[2*d+1], this->Dimensions[d] - 1) / this->BrickSize;
+    outside = outside || extent[2*d] < 0 || extent[2*d+1] >= this->Dimensions[d];
+    }
+  if (outside)
+    {
+    memset(imagePtr, 0, static_cast<size_t>(image->GetNumberOfPoints()) * voxelSize);
+    }
+
+  for (int k = firstBrick[2]; k <= lastBrick[2]; ++k)
+    {
+    for (int j = firstBrick[1]; j <= lastBrick[1]; ++j)
+      {
+      for (int i = firstBrick[0]; i <= lastBrick[0]; ++i)
+        {
+        // Bounds of the brick and of its part in the extent
+        const int ijk[3] = {i, j, k};
+        int brickExtent[6];
+        int copyExtent[6];
+        for (int d = 0; d < 3; ++d)
+          {
+          brickExtent[2*d] = ijk[d] * this->BrickSize;
+          brickExtent[2*d+1] = std::min(brickExtent[2*d] + this->BrickSize, this->Dimensions[d]) - 1;
+          copyExtent[2*d] = std::max(brickExtent[2*d], extent[2*d]);
+          copyExtent[2*d+1] = std::min(brickExtent[2*d+1], extent[2*d+1]);
+          }
+        const char* brick = 0;
+        if (!slab || IntersectSlab(brickExtent, slab))
+          {
+          brick = this->GetBrick(i, j, k);
+          if (!brick)
+            {
+            return 0;
+            }
+          }
+        const int brickWidth = brickExtent[1] - brickExtent[0] + 1;
+        const int brickHeight = brickExtent[3] - brickExtent[2] + 1;
+        const size_t rowSize = static_cast<size_t>(copyExtent[1] - copyExtent[0] + 1) * voxelSize;
+        for (int z = copyExtent[4]; z <= copyExtent[5]; ++z)
+          {
+          for (int y = copyExtent[2]; y <= copyExtent[3]; ++y)
+            {
+            char* row = imagePtr + (copyExtent[0] - imageExtent[0]) * voxelSize +
+              (y - imageExtent[2]) * rowIncrement + (z - imageExtent[4]) * sliceIncrement;
+            if (brick)
+              {
+              memcpy(row, brick + ((static_cast<size_t>(z - brickExtent[4]) * brickHeight +
+                                    (y - brickExtent[2])) * brickWidth +
+                                   (copyExtent[0] - brickExtent[0])) * voxelSize, rowSize);
+              }
+            else
+              {
+              memset(row, 0, rowSize);
+              }
+            }
+          }
+        }
+      }
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickCache::FillSampleImage(vtkImageData* image,
+                                        vtkIdType maximumNumberOfVoxels)
+{
+  if (!image || !this->UpdateFile() ||
+      this->Dimensions[0] <= 0 || this->Dimensions[1] <= 0 || this->Dimensions[2] <= 0)
+    {
+    return 0;
+    }
+  const int numberOfSlices = std::min(this->Dimensions[2], 8);
+  int step = 1;
+  while (static_cast<vtkIdType>((this->Dimensions[0] + step - 1) / step) *
+         ((this->Dimensions[1] + step - 1) / step) * numberOfSlices > maximumNumberOfVoxels)
+    {
+    ++step;
+    }
+  const int width = (this->Dimensions[0] + step - 1) / step;
+  const int height = (this->Dimensions[1] + step - 1) / step;
+  image->SetDimensions(width, height, numberOfSlices);
+  image->SetScalarType(this->ScalarType);
+  image->SetNumberOfScalarComponents(this->NumberOfScalarComponents);
+  image->AllocateScalars();
+
+  const int voxelSize = this->GetVoxelSize();
+  std::vector<char> row(static_cast<size_t>(this->Dimensions[0]) * voxelSize);
+  char* imagePtr = static_cast<char*>(image->GetScalarPointer());
+  for (int s = 0; s < numberOfSlices; ++s)
+    {
+    const vtkTypeInt64 k = (2 * s + 1) * static_cast<vtkTypeInt64>(this->Dimensions[2]) / (2 * numberOfSlices);
+    for (int j = 0; j < this->Dimensions[1]; j += step)
+      {
+      if (!this->ReadVoxels((k * this->Dimensions[1] + j) * this->Dimensions[0],
+                            this->Dimensions[0], &row[0]))
+        {
+        return 0;
+        }
+      for (int i = 0; i < this->Dimensions[0]; i += step)
+        {
+        memcpy(imagePtr, &row[static_cast<size_t>(i) * voxelSize], voxelSize);
+        imagePtr += voxelSize;
+        }
+      }
+    }
+  image->Modified();
+  return 1;
+}
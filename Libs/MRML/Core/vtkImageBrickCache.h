@@ -0,0 +1,142 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageBrickCache_h
+#define __vtkImageBrickCache_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkImageData;
+
+/// \brief Bricks of a raw volume file, read on demand and kept in a LRU cache.
+///
+/// The voxels of the file are stored x fastest, then y, then z, the
+/// components of a voxel being contiguous, starting HeaderSize bytes into
+/// the file. The volume is split into cubic bricks of BrickSize voxels.
+/// A brick is read from the file the first time it is needed, and the least
+/// recently used bricks are released when the cache grows over
+/// MaximumCacheSize. Changing the file, the geometry or the brick size
+/// releases the cached bricks.
+///
+/// A cache is shared by the vtkImageBrickSource instances reading the same
+/// volume, so that the slice views reuse the bricks read by the others.
+/// FillImage() can be called from several threads, the other methods can't.
+/// \sa vtkImageBrickSource
+class VTK_MRML_EXPORT vtkImageBrickCache : public vtkObject
+{
+public:
+  static vtkImageBrickCache *New();
+  vtkTypeMacro(vtkImageBrickCache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Read the header of a NRRD file (.nrrd or .nhdr) and set the file name,
+  /// header size, dimensions, scalar type, number of components and byte
+  /// order of the voxels. Return 0 if the file can't be read by bricks: the
+  /// encoding is not raw, the data is split in several files or the
+  /// dimensions are not 3 (or 4 with the components first).
+  int ReadNRRDHeader(const char* fileName);
+
+  /// File containing the voxels
+  vtkSetStringMacro(FileName);
+  vtkGetStringMacro(FileName);
+
+  /// Offset of the first voxel in the file, in bytes
+  vtkSetMacro(HeaderSize, vtkTypeInt64);
+  vtkGetMacro(HeaderSize, vtkTypeInt64);
+
+  vtkSetVector3Macro(Dimensions, int);
+  vtkGetVector3Macro(Dimensions, int);
+
+  vtkSetMacro(ScalarType, int);
+  vtkGetMacro(ScalarType, int);
+
+  vtkSetMacro(NumberOfScalarComponents, int);
+  vtkGetMacro(NumberOfScalarComponents, int);
+
+  /// Swap the bytes of the voxels read from the file. Off by default.
+  vtkSetMacro(SwapBytes, int);
+  vtkGetMacro(SwapBytes, int);
+  vtkBooleanMacro(SwapBytes, int);
+
+  /// Size of the side of the bricks in voxels. 64 by default.
+  vtkSetClampMacro(BrickSize, int, 1, 1024);
+  vtkGetMacro(BrickSize, int);
+
+  /// Memory used by the cached bricks in MB. 512 by default.
+  /// The cached bricks are kept when it changes.
+  void SetMaximumCacheSize(int size);
+  vtkGetMacro(MaximumCacheSize, int);
+
+  /// Fill the extent of the image from the bricks, reading the missing ones.
+  /// The scalars of the image must be allocated for at least the extent.
+  /// If slab is not null ({nx, ny, nz, distance, half thickness}), the
+  /// bricks that don't intersect the slab of the IJK space are not read:
+  /// their voxels are set to 0. Return 0 if the file can't be read.
+  /// The calls are serialized, a brick read by a thread is cached for the
+  /// others.
+  int FillImage(vtkImageData* image, const int extent[6], const double* slab = 0);
+
+  /// Fill the image with a few slices of the volume, evenly spaced in z and
+  /// subsampled in x and y so that there are at most maximumNumberOfVoxels.
+  /// The slices are read from the file without going through the cache.
+  /// It is used to estimate the range and histogram of the voxels.
+  int FillSampleImage(vtkImageData* image, vtkIdType maximumNumberOfVoxels = 4194304);
+
+  /// Release all the bricks
+  void ReleaseBricks();
+
+  /// Number of bricks in the cache
+  int GetNumberOfCachedBricks();
+
+  /// Memory used by the cached bricks in bytes
+  vtkTypeInt64 GetCacheSizeInBytes();
+
+  /// Number of bricks read from the file since the creation of the cache
+  vtkGetMacro(NumberOfBrickReads, vtkTypeInt64);
+
+protected:
+  vtkImageBrickCache();
+  virtual ~vtkImageBrickCache();
+
+  /// Release the bricks and reopen the file if the configuration changed
+  int UpdateFile();
+  /// Unsynchronized FillImage()
+  int FillExtent(vtkImageData* image, const int extent[6], const double* slab);
+  /// Return the voxels of the brick, reading it if it is not cached
+  const char* GetBrick(int i, int j, int k);
+  int ReadBrick(const int brickExtent[6], char* buffer);
+  int ReadVoxels(vtkTypeInt64 voxelIndex, vtkTypeInt64 numberOfVoxels, char* buffer);
+  void EvictBricks();
+  int GetVoxelSize();
+
+  char* FileName;
+  vtkTypeInt64 HeaderSize;
+  int Dimensions[3];
+  int ScalarType;
+  int NumberOfScalarComponents;
+  int SwapBytes;
+  int BrickSize;
+  int MaximumCacheSize;
+  vtkTypeInt64 NumberOfBrickReads;
+
+private:
+  vtkImageBrickCache(const vtkImageBrickCache&);  // Not implemented.
+  void operator=(const vtkImageBrickCache&);  // Not implemented.
+
+  class vtkInternal;
+  vtkInternal* Internal;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkImageBrickCache.h"
+#include "vtkImageBrickSource.h"
+
+// VTK includes
+#include <vtkExecutive.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationExecutivePortKey.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageBrickSource);
+vtkCxxSetObjectMacro(vtkImageBrickSource, Cache, vtkImageBrickCache);
+
+//----------------------------------------------------------------------------
+vtkImageBrickSource::vtkImageBrickSource()
+{
+  this->Cache = 0;
+  this->RestrictToSlab = 0;
+  this->SlabOrigin[0] = this->SlabOrigin[1] = this->SlabOrigin[2] = 0.;
+  this->SlabNormal[0] = this->SlabNormal[1] = 0.;
+  this->SlabNormal[2] = 1.;
+  this->SlabThickness = 1.;
+  this->SetNumberOfInputPorts(0);
+}
+
+//----------------------------------------------------------------------------
+vtkImageBrickSource::~vtkImageBrickSource()
+{
+  this->SetCache(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBrickSource::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Cache: " << this->Cache << "\n";
+  os << indent << "RestrictToSlab: " << this->RestrictToSlab << "\n";
+  os << indent << "SlabOrigin: " << this->SlabOrigin[0] << " "
+     << this->SlabOrigin[1] << " " << this->SlabOrigin[2] << "\n";
+  os << indent << "SlabNormal: " << this->SlabNormal[0] << " "
+     << this->SlabNormal[1] << " " << this->SlabNormal[2] << "\n";
+  os << indent << "SlabThickness: " << this->SlabThickness << "\n";
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkImageBrickSource::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+  if (this->Cache && this->Cache->GetMTime() > mTime)
+    {
+    mTime = this->Cache->GetMTime();
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+vtkImageBrickSource* vtkImageBrickSource::GetImageBrickSource(vtkImageData* imageData)
+{
+  vtkInformation* info = imageData ? imageData->GetPipelineInformation() : 0;
+  if (!info)
+    {
+    return 0;
+    }
+  vtkExecutive* executive = 0;
+  int port = 0;
+  vtkExecutive::PRODUCER()->Get(info, executive, port);
+  return executive ? vtkImageBrickSource::SafeDownCast(executive->GetAlgorithm()) : 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickSource::FillImage(vtkImageData* image, const int extent[6])
+{
+  if (!this->Cache)
+    {
+    return 0;
+    }
+  double slab[5];
+  double* slabPtr = 0;
+  double normal[3] = {this->SlabNormal[0], this->SlabNormal[1], this->SlabNormal[2]};
+  if (this->RestrictToSlab && vtkMath::Normalize(normal) > 0.)
+    {
+    slab[0] = normal[0];
+    slab[1] = normal[1];
+    slab[2] = normal[2];
+    slab[3] = vtkMath::Dot(normal, this->SlabOrigin);
+    slab[4] = 0.5 * this->SlabThickness;
+    slabPtr = slab;
+    }
+  return this->Cache->FillImage(image, extent, slabPtr);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickSource::RequestInformation(
+  vtkInformation * vtkNotUsed(request),
+  vtkInformationVector ** vtkNotUsed(inputVector),
+  vtkInformationVector *outputVector)
+{
+  if (!this->Cache)
+    {
+    vtkErrorMacro("RequestInformation: no cache");
+    return 0;
+    }
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  int* dimensions = this->Cache->GetDimensions();
+  int wholeExtent[6] = {0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1};
+  double spacing[3] = {1., 1., 1.};
+  double origin[3] = {0., 0., 0.};
+  outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent, 6);
+  outInfo->Set(vtkDataObject::SPACING(), spacing, 3);
+  outInfo->Set(vtkDataObject::ORIGIN(), origin, 3);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo,
+    this->Cache->GetScalarType(), this->Cache->GetNumberOfScalarComponents());
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageBrickSource::RequestData(
+  vtkInformation * vtkNotUsed(request),
+  vtkInformationVector ** vtkNotUsed(inputVector),
+  vtkInformationVector *outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkImageData* output = this->AllocateOutputData(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  int extent[6];
+  output->GetExtent(extent);
+  if (extent[1] < extent[0] || extent[3] < extent[2] || extent[5] < extent[4])
+    {
+    return 1;
+    }
+
+  if (!this->FillImage(output, extent))
+    {
+    vtkErrorMacro("RequestData: can't read the bricks of "
+                  << (this->Cache->GetFileName() ? this->Cache->GetFileName() : "(none)"));
+    return 0;
+    }
+  return 1;
+}
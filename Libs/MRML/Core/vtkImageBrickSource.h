@@ -0,0 +1,94 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageBrickSource_h
+#define __vtkImageBrickSource_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkImageAlgorithm.h>
+
+class vtkImageBrickCache;
+
+/// \brief Produce the requested extent of a volume from the bricks of a cache.
+///
+/// Only the update extent is allocated and filled, from the bricks of the
+/// cache intersecting it. The output has a spacing of 1 and an origin of 0,
+/// the geometry being kept by the volume node.
+///
+/// The bounding box of an oblique slice, or the whole extent for a nonlinear
+/// transform, can be as large as the volume: vtkImageResliceMask only
+/// requests a voxel of a brick source input and reads the bricks itself with
+/// FillImage(), a few rows of the slice at a time, within its
+/// MaximumBrickInputSize.
+///
+/// When RestrictToSlab is on, the bricks that don't intersect the slab are
+/// not read and their voxels are 0. A slice view sets the slab of its slice
+/// so that an oblique slice only reads the bricks it crosses.
+/// \sa vtkImageBrickCache
+class VTK_MRML_EXPORT vtkImageBrickSource : public vtkImageAlgorithm
+{
+public:
+  static vtkImageBrickSource *New();
+  vtkTypeMacro(vtkImageBrickSource, vtkImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Cache of the bricks, shared with the other sources of the volume
+  virtual void SetCache(vtkImageBrickCache* cache);
+  vtkGetObjectMacro(Cache, vtkImageBrickCache);
+
+  /// Only read the bricks intersecting the slab. Off by default.
+  vtkSetMacro(RestrictToSlab, int);
+  vtkGetMacro(RestrictToSlab, int);
+  vtkBooleanMacro(RestrictToSlab, int);
+
+  /// Center, normal and thickness of the slab in the IJK space
+  vtkSetVector3Macro(SlabOrigin, double);
+  vtkGetVector3Macro(SlabOrigin, double);
+  vtkSetVector3Macro(SlabNormal, double);
+  vtkGetVector3Macro(SlabNormal, double);
+  vtkSetMacro(SlabThickness, double);
+  vtkGetMacro(SlabThickness, double);
+
+  /// Fill the extent of the image from the bricks of the cache, restricted
+  /// to the slab if RestrictToSlab is on. The scalars of the image must be
+  /// allocated for at least the extent. Return 0 if the file can't be read.
+  /// It can be called from several threads.
+  int FillImage(vtkImageData* image, const int extent[6]);
+
+  /// Include the modification time of the cache
+  virtual unsigned long GetMTime();
+
+  /// Return the brick source producing the image data if any.
+  /// It is how a bricked volume node is recognized.
+  static vtkImageBrickSource* GetImageBrickSource(vtkImageData* imageData);
+
+protected:
+  vtkImageBrickSource();
+  virtual ~vtkImageBrickSource();
+
+  virtual int RequestInformation(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
+  virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
+
+  vtkImageBrickCache* Cache;
+  int RestrictToSlab;
+  double SlabOrigin[3];
+  double SlabNormal[3];
+  double SlabThickness;
+
+private:
+  vtkImageBrickSource(const vtkImageBrickSource&);  // Not implemented.
+  void operator=(const vtkImageBrickSource&);  // Not implemented.
+};
+
+#endif
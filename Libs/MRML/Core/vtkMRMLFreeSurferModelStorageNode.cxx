@@ -20,9 +20,14 @@ Version:   $Revision: 1.2 $
 #include "vtkPolyDataNormals.h"
 #include "vtkStripper.h"
 
+#include "vtkFSSurfaceHelper.h"
 #include "vtkFSSurfaceReader.h"
 #include "vtkMRMLModelNode.h"
 
+#include "vtkCollection.h"
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+
 #include "vtkPolyDataWriter.h"
 #include "vtkXMLPolyDataWriter.h"
 #include "vtkPolyDataReader.h"
@@ -34,6 +39,9 @@ Version:   $Revision: 1.2 $
 
 #include "vtkStringArray.h"
 
+// STD includes
+#include <vector>
+
 // Initialize static member that controls resampling -- 
 // old comment: "This offset will be changed to 0.5 from 0.0 per 2/8/2002 Slicer 
 // development meeting, to move ijk coordinates to voxel centers."
@@ -45,11 +53,17 @@ vtkMRMLNodeNewMacro(vtkMRMLFreeSurferModelStorageNode);
 vtkMRMLFreeSurferModelStorageNode::vtkMRMLFreeSurferModelStorageNode()
 {
   this->UseStripper = 1;
+  this->Surface = NULL;
 }
 
 //----------------------------------------------------------------------------
 vtkMRMLFreeSurferModelStorageNode::~vtkMRMLFreeSurferModelStorageNode()
 {
+  if (this->Surface)
+    {
+    this->Surface->Delete();
+    this->Surface = NULL;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -134,7 +148,16 @@ int vtkMRMLFreeSurferModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     
     reader->SetFileName(fullName.c_str());
     normals->SetSplitting(0);
-    normals->SetInput( reader->GetOutput() );
+    // use the surface if it has already been read by ReadSurfacesInParallel
+    if (this->Surface && this->SurfaceFileName == fullName)
+      {
+      vtkDebugMacro("ReadDataInternal: using the surface already read");
+      normals->SetInput( this->Surface );
+      }
+    else
+      {
+      normals->SetInput( reader->GetOutput() );
+      }
     if ( this->GetUseStripper() )
       {
       stripper->SetInput( normals->GetOutput() );
@@ -173,6 +196,11 @@ int vtkMRMLFreeSurferModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     {
     result = 0;
     }
+  if (this->Surface)
+    {
+    this->Surface->Delete();
+    this->Surface = NULL;
+    }
   
   if (modelNode->GetPolyData() != NULL) 
     {
@@ -182,6 +210,62 @@ int vtkMRMLFreeSurferModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   return result;
 }
 
+//----------------------------------------------------------------------------
+int vtkMRMLFreeSurferModelStorageNode::ReadSurfacesInParallel(vtkCollection* storageNodes)
+{
+  if (storageNodes == NULL)
+    {
+    return 0;
+    }
+  std::vector<vtkMRMLFreeSurferModelStorageNode*> nodes;
+  std::vector<std::string> fileNames;
+  vtkNew<vtkCollection> readers;
+  vtkObject* object = NULL;
+  vtkCollectionSimpleIterator it;
+  for (storageNodes->InitTraversal(it); (object = storageNodes->GetNextItemAsObject(it));)
+    {
+    vtkMRMLFreeSurferModelStorageNode* node =
+      vtkMRMLFreeSurferModelStorageNode::SafeDownCast(object);
+    // remote files must be downloaded by ReadData() first
+    if (node == NULL || node->GetFileName() == NULL)
+      {
+      continue;
+      }
+    std::string fullName = node->GetFullNameFromFileName();
+    if (fullName.empty())
+      {
+      continue;
+      }
+    vtkNew<vtkFSSurfaceReader> reader;
+    reader->SetFileName(fullName.c_str());
+    readers->AddItem(reader.GetPointer());
+    nodes.push_back(node);
+    fileNames.push_back(fullName);
+    }
+
+  int failures = vtkFSSurfaceHelper::ReadInParallel(readers.GetPointer());
+
+  for (size_t i = 0; i < nodes.size(); ++i)
+    {
+    vtkFSSurfaceReader* reader =
+      vtkFSSurfaceReader::SafeDownCast(readers->GetItemAsObject(static_cast<int>(i)));
+    // a surface that failed is read again by ReadData(), which reports it
+    if (reader->GetOutput()->GetNumberOfPoints() == 0)
+      {
+      continue;
+      }
+    vtkPolyData* surface = vtkPolyData::New();
+    surface->ShallowCopy(reader->GetOutput());
+    if (nodes[i]->Surface)
+      {
+      nodes[i]->Surface->Delete();
+      }
+    nodes[i]->Surface = surface;
+    nodes[i]->SurfaceFileName = fileNames[i];
+    }
+  return failures;
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLFreeSurferModelStorageNode::CopyData(vtkMRMLNode *refNode,
                                                 const char *newFileName)
@@ -17,6 +17,9 @@
 
 #include "vtkMRMLModelStorageNode.h"
 
+class vtkCollection;
+class vtkPolyData;
+
 /// \brief MRML node for model storage on disk.
 ///
 /// Storage nodes has methods to read/write vtkPolyData to/from disk
@@ -58,6 +61,14 @@ class VTK_MRML_EXPORT vtkMRMLFreeSurferModelStorageNode : public vtkMRMLModelSto
   vtkGetMacro(UseStripper, int);
   vtkSetMacro(UseStripper, int);
 
+  /// Read concurrently the surface files of a collection of
+  /// vtkMRMLFreeSurferModelStorageNode, e.g. the pial and white surfaces
+  /// of both hemispheres, with vtkFSSurfaceHelper::ReadInParallel().
+  /// The next ReadData() of each node uses the surface read here instead
+  /// of reading its file again. Only local files are read.
+  /// Return the number of surfaces that failed to be read.
+  static int ReadSurfacesInParallel(vtkCollection* storageNodes);
+
 protected:
   vtkMRMLFreeSurferModelStorageNode();
   ~vtkMRMLFreeSurferModelStorageNode();
@@ -71,6 +82,11 @@ protected:
   virtual int ReadDataInternal(vtkMRMLNode *refNode);
 
   int UseStripper;
+
+  /// Surface read by ReadSurfacesInParallel() from SurfaceFileName,
+  /// released by the next ReadDataInternal()
+  vtkPolyData* Surface;
+  std::string SurfaceFileName;
 };
 
 #endif
@@ -14,6 +14,8 @@ Version:   $Revision: 1.6 $
 
 
 // MRML includes
+#include "vtkImageBrickCache.h"
+#include "vtkImageBrickSource.h"
 #include "vtkMRMLDiffusionWeightedVolumeNode.h"
 #include "vtkMRMLDiffusionTensorVolumeNode.h"
 #include "vtkMRMLNRRDStorageNode.h"
@@ -28,6 +30,7 @@ Version:   $Revision: 1.6 $
 #include <vtkNRRDReader.h>
 #include <vtkNRRDWriter.h>
 #include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
 
 
@@ -38,6 +41,7 @@ vtkMRMLNodeNewMacro(vtkMRMLNRRDStorageNode);
 vtkMRMLNRRDStorageNode::vtkMRMLNRRDStorageNode()
 {
   this->CenterImage = 0;
+  this->BrickedReading = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -54,6 +58,7 @@ void vtkMRMLNRRDStorageNode::WriteXML(ostream& of, int nIndent)
   std::stringstream ss;
   ss << this->CenterImage;
   of << indent << " centerImage=\"" << ss.str() << "\"";
+  of << indent << " brickedReading=\"" << this->BrickedReading << "\"";
 
 }
 
@@ -76,6 +81,12 @@ void vtkMRMLNRRDStorageNode::ReadXMLAttributes(const char** atts)
       ss << attValue;
       ss >> this->CenterImage;
       }
+    else if (!strcmp(attName, "brickedReading"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->BrickedReading;
+      }
     }
 
   this->EndModify(disabledModify);
@@ -93,6 +104,7 @@ void vtkMRMLNRRDStorageNode::Copy(vtkMRMLNode *anode)
   vtkMRMLNRRDStorageNode *node = (vtkMRMLNRRDStorageNode *) anode;
 
   this->SetCenterImage(node->CenterImage);
+  this->SetBrickedReading(node->BrickedReading);
 
   this->EndModify(disabledModify);
 
@@ -103,6 +115,7 @@ void vtkMRMLNRRDStorageNode::PrintSelf(ostream& os, vtkIndent indent)
 {  
   vtkMRMLStorageNode::PrintSelf(os,indent);
   os << indent << "CenterImage:   " << this->CenterImage << "\n";
+  os << indent << "BrickedReading:   " << this->BrickedReading << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -228,7 +241,37 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       }
     }
 
-  reader->Update();
+  // Read the voxels by bricks only when they are requested
+  vtkSmartPointer<vtkImageBrickSource> brickSource;
+  if (this->BrickedReading &&
+      !refNode->IsA("vtkMRMLTensorVolumeNode") &&
+      !refNode->IsA("vtkMRMLDiffusionWeightedVolumeNode"))
+    {
+    vtkNew<vtkImageBrickCache> brickCache;
+    int* extent = reader->GetDataExtent();
+    if (brickCache->ReadNRRDHeader(fullName.c_str()) &&
+        brickCache->GetDimensions()[0] == extent[1] - extent[0] + 1 &&
+        brickCache->GetDimensions()[1] == extent[3] - extent[2] + 1 &&
+        brickCache->GetDimensions()[2] == extent[5] - extent[4] + 1 &&
+        brickCache->GetNumberOfScalarComponents() == reader->GetNumberOfComponents())
+      {
+      brickSource = vtkSmartPointer<vtkImageBrickSource>::New();
+      brickSource->SetCache(brickCache.GetPointer());
+      brickSource->UpdateInformation();
+      // Report the dimensions of the volume before any voxel is read
+      vtkImageData* output = brickSource->GetOutput();
+      output->SetExtent(output->GetWholeExtent());
+      }
+    else
+      {
+      vtkWarningMacro("ReadData: " << fullName << " can't be read by bricks, "
+                      "it is read as a whole");
+      }
+    }
+  if (!brickSource)
+    {
+    reader->Update();
+    }
   // set volume attributes
   vtkMatrix4x4* mat = reader->GetRasToIjkMatrix();
   volNode->SetRASToIJKMatrix(mat);
@@ -284,6 +327,12 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     volNode->SetAttribute((*kit).c_str(), reader->GetHeaderValue((*kit).c_str()));    
     }
 
+  if (brickSource)
+    {
+    // the output of the source keeps the source alive
+    volNode->SetAndObserveImageData(brickSource->GetOutput());
+    return 1;
+    }
 
   vtkNew<vtkImageChangeInformation> ici;
   ici->SetInput (reader->GetOutput());
@@ -53,6 +53,18 @@ class VTK_MRML_EXPORT vtkMRMLNRRDStorageNode : public vtkMRMLStorageNode
   vtkGetMacro(CenterImage, int);
   vtkSetMacro(CenterImage, int);
 
+  ///
+  /// Read the volume by bricks on demand instead of as a whole (off by
+  /// default), for volumes larger than the memory. The image data of the
+  /// volume node is then the output of a vtkImageBrickSource: only the
+  /// requested extents are read, e.g. the slices of the slice views.
+  /// Only the raw encoded files can be read by bricks, the others are read
+  /// as a whole. Tensor and diffusion weighted volumes are always read as a
+  /// whole.
+  vtkGetMacro(BrickedReading, int);
+  vtkSetMacro(BrickedReading, int);
+  vtkBooleanMacro(BrickedReading, int);
+
   /// 
   /// Access the nrrd header fields to create a diffusion gradient table
   int ParseDiffusionInformation(vtkNRRDReader *reader,vtkDoubleArray *grad,vtkDoubleArray *bvalues);
@@ -89,6 +101,7 @@ protected:
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
   int CenterImage;
+  int BrickedReading;
 
 };
 
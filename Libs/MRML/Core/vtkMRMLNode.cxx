@@ -24,6 +24,7 @@ Version:   $Revision: 1.11 $
 #include <vtksys/SystemTools.hxx>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sstream>
@@ -395,14 +396,21 @@ void vtkMRMLNode::ReadXMLAttributes(const char** atts)
       }
      else if (!strcmp(attName, "attributes"))
        {
-       std::stringstream attributes(attValue);
-       std::string attribute;
-       while (std::getline(attributes, attribute, ';'))
+       // "name1:value1;name2:value2", parsed in place
+       std::string name;
+       std::string value;
+       for (const char* attribute = attValue; *attribute != '\0';)
          {
-         int colonIndex = attribute.find(':');
-         std::string name = attribute.substr(0, colonIndex);
-         std::string value = attribute.substr(colonIndex + 1);
+         const char* attributeEnd = strchr(attribute, ';');
+         if (!attributeEnd)
+           {
+           attributeEnd = attribute + strlen(attribute);
+           }
+         const char* colon = std::find(attribute, attributeEnd, ':');
+         name.assign(attribute, colon);
+         value.assign(colon != attributeEnd ? colon + 1 : attribute, attributeEnd);
          this->SetAttribute(name.c_str(), value.c_str());
+         attribute = (*attributeEnd == ';') ? attributeEnd + 1 : attributeEnd;
          }
        }
      else if (!strcmp(attName, "references"))
@@ -643,7 +651,8 @@ const char* vtkMRMLNode::GetReferenceRoleFromMRMLAttributeName(const char* attNa
     {
     return 0;
     }
-  std::string attributeName(attName);
+  // Called for each attribute read from XML: don't copy the attribute name.
+  const size_t attributeNameLength = strlen(attName);
   // Search if the attribute name has been registered using AddNodeReferenceRole.
   std::map< std::string, std::string>::iterator it;
   for (it = this->NodeReferenceMRMLAttributeNames.begin();
@@ -652,22 +661,21 @@ const char* vtkMRMLNode::GetReferenceRoleFromMRMLAttributeName(const char* attNa
     {
     const std::string& nodeReferenceRole = it->first;
     const std::string& nodeMRMLAttributeName = it->second;
-    if (nodeMRMLAttributeName == attributeName)
+    if (nodeMRMLAttributeName == attName)
       {
       return nodeReferenceRole.c_str();
       }
-    else if (this->IsReferenceRoleGeneric(nodeReferenceRole.c_str()) &&
-             (attributeName.length() >= nodeMRMLAttributeName.length()) &&
-             attributeName.compare(
-              attributeName.length() - nodeMRMLAttributeName.length(),
-              nodeMRMLAttributeName.length(), nodeMRMLAttributeName) == 0)
+    else if (attributeNameLength >= nodeMRMLAttributeName.length() &&
+             this->IsReferenceRoleGeneric(nodeReferenceRole.c_str()) &&
+             !strcmp(attName + attributeNameLength - nodeMRMLAttributeName.length(),
+                     nodeMRMLAttributeName.c_str()))
       {
       // if attName = "lengthUnitRef" and  [refRole,attName] = ["unit/","UnitRef"]
       // then return "unit/length"
       static std::string referenceRole;
       referenceRole = nodeReferenceRole;
-      referenceRole += attributeName.substr(0, attributeName.length() -
-                                               nodeMRMLAttributeName.length());
+      referenceRole.append(attName,
+        attributeNameLength - nodeMRMLAttributeName.length());
       return referenceRole.c_str();
       }
     }
@@ -14,6 +14,8 @@ Version:   $Revision: 1.2 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkImageBrickCache.h"
+#include "vtkImageBrickSource.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLProceduralColorNode.h"
@@ -106,6 +108,7 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
 
   this->Bimodal = NULL;
   this->Accumulate = NULL;
+  this->SampleImageData = NULL;
   this->IsInCalculateAutoLevels = false;
   
   vtkEventBroker::GetInstance()->AddObservation(
@@ -138,6 +141,11 @@ vtkMRMLScalarVolumeDisplayNode::~vtkMRMLScalarVolumeDisplayNode()
     this->Accumulate->Delete();
     this->Accumulate = NULL;
     }
+  if (this->SampleImageData)
+    {
+    this->SampleImageData->Delete();
+    this->SampleImageData = NULL;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -649,13 +657,36 @@ vtkImageData* vtkMRMLScalarVolumeDisplayNode::GetScalarImageData()
   return this->GetInputImageData();
 }
 
+//---------------------------------------------------------------------------
+vtkImageData* vtkMRMLScalarVolumeDisplayNode::GetAutoLevelsImageData()
+{
+  vtkImageData* imageData = this->GetScalarImageData();
+  vtkImageBrickSource* brickSource = vtkImageBrickSource::GetImageBrickSource(imageData);
+  if (!brickSource || !brickSource->GetCache())
+    {
+    return imageData;
+    }
+  // Updating a bricked volume would read it as a whole, a few slices of
+  // it are used instead.
+  if (this->SampleImageData == NULL)
+    {
+    this->SampleImageData = vtkImageData::New();
+    }
+  if (this->SampleImageData->GetMTime() < brickSource->GetCache()->GetMTime() ||
+      this->SampleImageData->GetNumberOfPoints() == 0)
+    {
+    brickSource->GetCache()->FillSampleImage(this->SampleImageData);
+    }
+  return this->SampleImageData;
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLScalarVolumeDisplayNode::GetDisplayScalarRange(double range[2])
 {
   range[0] = 0;
   range[1] = 255.;
 
-  vtkImageData *imageData = this->GetScalarImageData();
+  vtkImageData *imageData = this->GetAutoLevelsImageData();
   if (!imageData || !this->GetInputImageData())
     {
     // it's a problem if the volume node has an image data but the display node
@@ -687,7 +718,7 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     return;
     }
 
-  vtkImageData *imageDataScalar = this->GetScalarImageData();
+  vtkImageData *imageDataScalar = this->GetAutoLevelsImageData();
 
   if (!imageDataScalar)
     {
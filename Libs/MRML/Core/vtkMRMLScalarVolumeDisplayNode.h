@@ -193,6 +193,11 @@ protected:
   /// Return the image data with scalar type, it can be in the middle of the
   /// pipeline, it's typically the input of the threshold/windowlevel filters
   virtual vtkImageData* GetScalarImageData();
+
+  /// Return the image data the auto levels are computed on: the scalar
+  /// image data, or a sample of it for the bricked volumes that don't fit
+  /// in memory.
+  vtkImageData* GetAutoLevelsImageData();
   
   virtual void SetInputToImageDataPipeline(vtkImageData* input);
 
@@ -237,6 +242,7 @@ protected:
   /// Used internally in CalculateScalarAutoLevels and CalculateStatisticsAutoLevels
   vtkImageAccumulate *Accumulate;
   vtkImageBimodalAnalysis *Bimodal;
+  vtkImageData *SampleImageData;
   bool IsInCalculateAutoLevels;
 };
 
@@ -83,6 +83,7 @@ Version:   $Revision: 1.18 $
 #include <algorithm>
 #include <cassert>
 #include <numeric>
+#include <streambuf>
 
 //#define MRMLSCENE_VERBOSE 1
 
@@ -367,13 +368,11 @@ vtkMRMLNode* vtkMRMLScene::CreateNodeByClass(const char* className)
     return NULL;
     }
   vtkMRMLNode* node = NULL;
-  for (unsigned int i=0; i<RegisteredNodeClasses.size(); i++)
+  std::map< std::string, vtkMRMLNode* >::iterator it =
+    this->RegisteredNodeClassesByName.find(className);
+  if (it != this->RegisteredNodeClassesByName.end())
     {
-    if (!strcmp(RegisteredNodeClasses[i]->GetClassName(), className))
-      {
-      node = RegisteredNodeClasses[i]->CreateNodeInstance();
-      break;
-      }
+    node = it->second->CreateNodeInstance();
     }
   // non-registered nodes can have a registered factory
   if (node == NULL)
@@ -428,24 +427,45 @@ void vtkMRMLScene::RegisterNodeClass(vtkMRMLNode* node, const char* tagName)
   // By doing so we make sure there is no more than 1 node matching a given
   // XML tag. It allows plugins to MRML to overide default behavior when
   // instantiating nodes via XML tags.
-  for (unsigned int i = 0; i < this->RegisteredNodeTags.size(); ++i)
+  std::map< std::string, vtkMRMLNode* >::iterator tagIt =
+    this->RegisteredNodeClassesByTag.find(xmlTag);
+  for (unsigned int i = 0;
+       tagIt != this->RegisteredNodeClassesByTag.end() &&
+       i < this->RegisteredNodeTags.size(); ++i)
     {
     if (this->RegisteredNodeTags[i] == xmlTag)
       {
+      vtkMRMLNode* previousNode = this->RegisteredNodeClasses[i];
       vtkWarningMacro("Tag " << tagName
                       << " has already been registered, unregistering previous node class "
                       << (this->RegisteredNodeClasses[i]->GetClassName() ? this->RegisteredNodeClasses[i]->GetClassName() : "(no class name)")
                       << " to register "
                       << (node->GetClassName() ? node->GetClassName() : "(no class name)"));
-      // As the node was previously Registered to the scene, we need to
-      // unregister it here. It should destruct the pointer as well (only 1
-      // reference on the node).
-      this->RegisteredNodeClasses[i]->Delete();
       // Remove the outdated reference to the tag, it will then be added later
       // (after the for loop).
       // we could have replace the entry with the new node also.
       this->RegisteredNodeClasses.erase(this->RegisteredNodeClasses.begin() + i);
       this->RegisteredNodeTags.erase(this->RegisteredNodeTags.begin() + i);
+      this->RegisteredNodeClassesByTag.erase(tagIt);
+      // The class may still be registered with another tag
+      const std::string previousClassName = previousNode->GetClassName();
+      if (this->RegisteredNodeClassesByName[previousClassName] == previousNode)
+        {
+        this->RegisteredNodeClassesByName.erase(previousClassName);
+        for (unsigned int j = 0; j < this->RegisteredNodeClasses.size(); ++j)
+          {
+          if (previousClassName == this->RegisteredNodeClasses[j]->GetClassName())
+            {
+            this->RegisteredNodeClassesByName[previousClassName] =
+              this->RegisteredNodeClasses[j];
+            break;
+            }
+          }
+        }
+      // As the node was previously Registered to the scene, we need to
+      // unregister it here. It should destruct the pointer as well (only 1
+      // reference on the node).
+      previousNode->Delete();
       // we found a matching tag, there is maximum one in the list, no need to
       // search any further
       break;
@@ -455,6 +475,11 @@ void vtkMRMLScene::RegisterNodeClass(vtkMRMLNode* node, const char* tagName)
   node->Register(this);
   this->RegisteredNodeClasses.push_back(node);
   this->RegisteredNodeTags.push_back(xmlTag);
+  this->RegisteredNodeClassesByTag[xmlTag] = node;
+  // Like the tags, the first node registered for a class is used to create
+  // the nodes of that class.
+  this->RegisteredNodeClassesByName.insert(
+    std::make_pair(std::string(node->GetClassName()), node));
 }
 
 //------------------------------------------------------------------------------
@@ -503,14 +528,10 @@ const char* vtkMRMLScene::GetClassNameByTag(const char *tagName)
     vtkErrorMacro("GetClassNameByTag: tagname is null");
     return NULL;
     }
-  for (unsigned int i=0; i<RegisteredNodeTags.size(); i++)
-    {
-    if (!strcmp(RegisteredNodeTags[i].c_str(), tagName))
-      {
-      return (RegisteredNodeClasses[i])->GetClassName();
-      }
-    }
-  return NULL;
+  std::map< std::string, vtkMRMLNode* >::iterator it =
+    this->RegisteredNodeClassesByTag.find(tagName);
+  return it != this->RegisteredNodeClassesByTag.end() ?
+    it->second->GetClassName() : NULL;
 }
 
 //------------------------------------------------------------------------------
@@ -525,14 +546,10 @@ const char* vtkMRMLScene::GetTagByClassName(const char *className)
     vtkErrorMacro("GetTagByClassName: className is null");
     return NULL;
     }
-  for (unsigned int i=0; i<this->RegisteredNodeClasses.size(); i++)
-    {
-    if (!strcmp(this->RegisteredNodeClasses[i]->GetClassName(), className))
-      {
-      return (this->RegisteredNodeClasses[i])->GetNodeTagName();
-      }
-    }
-  return NULL;
+  std::map< std::string, vtkMRMLNode* >::iterator it =
+    this->RegisteredNodeClassesByName.find(className);
+  return it != this->RegisteredNodeClassesByName.end() ?
+    it->second->GetNodeTagName() : NULL;
 }
 
 //------------------------------------------------------------------------------
@@ -835,6 +852,33 @@ int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection)
   return result;
 }
 
+//------------------------------------------------------------------------------
+namespace
+{
+// Stream buffer appending to a string. The scene is written directly in
+// SceneXMLString instead of being written in a string stream and copied.
+class vtkMRMLSceneStringBuffer : public std::streambuf
+{
+public:
+  vtkMRMLSceneStringBuffer(std::string& str) : String(str) {}
+protected:
+  virtual int_type overflow(int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      {
+      this->String += traits_type::to_char_type(c);
+      }
+    return traits_type::not_eof(c);
+  }
+  virtual std::streamsize xsputn(const char* s, std::streamsize n)
+  {
+    this->String.append(s, static_cast<std::string::size_type>(n));
+    return n;
+  }
+  std::string& String;
+};
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLScene::Commit(const char* url)
 {
@@ -854,13 +898,17 @@ int vtkMRMLScene::Commit(const char* url)
 
   vtkMRMLNode *node;
 
-  std::stringstream oss;
+  vtkMRMLSceneStringBuffer stringBuffer(this->SceneXMLString);
+  std::ostream oss(&stringBuffer);
   std::ofstream ofs;
 
   std::ostream *os = NULL;
 
   if (this->GetSaveToXMLString())
     {
+    // Clearing the string keeps its capacity: successive commits don't
+    // reallocate it while it grows.
+    this->SceneXMLString.clear();
     os = &oss;
     }
   else
@@ -937,10 +985,10 @@ int vtkMRMLScene::Commit(const char* url)
   //--- END test of user tags
 
   // Write each node
-  int n;
-  for (n=0; n < this->Nodes->GetNumberOfItems(); n++)
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
     {
-    node = (vtkMRMLNode*)this->Nodes->GetItemAsObject(n);
     if (!node->GetSaveWithScene())
       {
       continue;
@@ -973,11 +1021,7 @@ int vtkMRMLScene::Commit(const char* url)
   *os << "</MRML>\n";
 
   // Close file
-  if (this->GetSaveToXMLString())
-    {
-    SceneXMLString = oss.str();
-    }
-  else
+  if (!this->GetSaveToXMLString())
     {
     ofs.close();
     }
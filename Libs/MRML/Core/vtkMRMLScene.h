@@ -651,6 +651,10 @@ protected:
   
   std::vector< vtkMRMLNode* > RegisteredNodeClasses;
   std::vector< std::string >  RegisteredNodeTags;
+  /// Registered node classes indexed by XML tag and by class name, so that
+  /// nodes created from XML don't search the registered node classes.
+  std::map< std::string, vtkMRMLNode* > RegisteredNodeClassesByTag;
+  std::map< std::string, vtkMRMLNode* > RegisteredNodeClassesByName;
 
   NodeReferencesType NodeReferences; // ReferencedIDs (string), ReferencingNodes (node pointer)
   std::map< std::string, std::string > ReferencedIDChanges;
@@ -29,9 +29,58 @@ Version:   $Revision: 1.14 $
 
 // STD includes
 #include <cassert>
+#include <set>
 #include <sstream>
 #include <stack>
 
+namespace
+{
+
+/// All the instantiated scene view nodes. Used to find the nodes a stored
+/// scene can share and to hand the shared nodes over when a stored scene
+/// is cleared.
+std::set<vtkMRMLSceneViewNode*> SceneViewNodes;
+
+//----------------------------------------------------------------------------
+/// Stored scene of another scene view that contains the node instance, NULL
+/// if the node is not shared with another scene view.
+vtkMRMLScene* FindOtherStoredScene(vtkMRMLNode* node, vtkMRMLScene* storedScene)
+{
+  if (node->GetID() == NULL)
+    {
+    return NULL;
+    }
+  for (std::set<vtkMRMLSceneViewNode*>::const_iterator viewIt = SceneViewNodes.begin();
+       viewIt != SceneViewNodes.end(); ++viewIt)
+    {
+    vtkMRMLScene* otherStoredScene = (*viewIt)->GetStoredScene();
+    if (otherStoredScene && otherStoredScene != storedScene &&
+        otherStoredScene->GetNodeByID(node->GetID()) == node)
+      {
+      return otherStoredScene;
+      }
+    }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void AddReferencingNodeIDs(vtkMRMLScene* scene, vtkMRMLNode* node,
+                           std::set<std::string>& nodeIDs)
+{
+  std::vector<vtkMRMLNode *> referencingNodes;
+  scene->GetReferencingNodes(node, referencingNodes);
+  for (std::vector<vtkMRMLNode *>::const_iterator referencingIt = referencingNodes.begin();
+       referencingIt != referencingNodes.end(); ++referencingIt)
+    {
+    if ((*referencingIt)->GetID())
+      {
+      nodeIDs.insert((*referencingIt)->GetID());
+      }
+    }
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSceneViewNode);
 
@@ -44,13 +93,17 @@ vtkMRMLSceneViewNode::vtkMRMLSceneViewNode()
 //  this->ScreenShot = vtkImageData::New();
   this->ScreenShot = NULL;
   this->ScreenShotType = 0;
+
+  SceneViewNodes.insert(this);
 }
 
 //----------------------------------------------------------------------------
 vtkMRMLSceneViewNode::~vtkMRMLSceneViewNode()
 {
+  SceneViewNodes.erase(this);
   if (this->SnapshotScene)
     {
+    this->ReleaseSharedNodes();
     this->SnapshotScene->Delete();
     this->SnapshotScene = 0;
     }
@@ -235,6 +288,7 @@ void vtkMRMLSceneViewNode::Copy(vtkMRMLNode *anode)
   this->SetScreenShot(vtkMRMLSceneViewNode::SafeDownCast(anode)->GetScreenShot());
   this->SetScreenShotType(vtkMRMLSceneViewNode::SafeDownCast(anode)->GetScreenShotType());
   this->SetSceneViewDescription(vtkMRMLSceneViewNode::SafeDownCast(anode)->GetSceneViewDescription());
+  this->StoredSceneNodes = snode->StoredSceneNodes;
 
   if (this->SnapshotScene == NULL)
     {
@@ -242,6 +296,7 @@ void vtkMRMLSceneViewNode::Copy(vtkMRMLNode *anode)
     }
   else
     {
+    this->ReleaseSharedNodes();
     this->SnapshotScene->GetNodes()->RemoveAllItems();
     this->SnapshotScene->ClearNodeIDs();
     }
@@ -254,9 +309,11 @@ void vtkMRMLSceneViewNode::Copy(vtkMRMLNode *anode)
       node = (vtkMRMLNode*)snode->SnapshotScene->GetNodes()->GetItemAsObject(n);
       if (node)
         {
-        node->SetScene(this->SnapshotScene);
+        // the stored nodes are shared with the copied scene view, they keep
+        // the stored scene that owns them
+        this->SnapshotScene->GetNodes()->vtkCollection::AddItem(node);
         this->SnapshotScene->AddNodeID(node);
-       }
+        }
       }
     }
 }
@@ -282,6 +339,7 @@ void vtkMRMLSceneViewNode::UpdateScene(vtkMRMLScene *scene)
     // node references are in (this->SavedScene) already, so they should not be modified
     // but there could have been some node ID changes, so get them and update the
     // references accordingly
+    this->DetachSharedNodes();
     this->SnapshotScene->CopyNodeChangedIDs(scene);
     this->SnapshotScene->UpdateNodeChangedIDs();
     this->SnapshotScene->UpdateNodeReferences();
@@ -302,6 +360,10 @@ void vtkMRMLSceneViewNode::UpdateStoredScene()
     return;
     }
 
+  // UpdateScene can modify the stored nodes
+  this->DetachSharedNodes();
+  this->StoredSceneNodes.clear();
+
   unsigned int nnodesSanpshot = this->SnapshotScene->GetNodes()->GetNumberOfItems();
   unsigned int n;
   vtkMRMLNode *node = NULL;
@@ -353,38 +415,74 @@ void vtkMRMLSceneViewNode::StoreScene()
     }
   else
     {
+    this->ReleaseSharedNodes();
     this->SnapshotScene->Clear(1);
     }
+  this->StoredSceneNodes.clear();
 
   if (this->GetScene())
     {
     this->SnapshotScene->SetRootDirectory(this->GetScene()->GetRootDirectory());
     }
 
-  /// \todo: GetNumberOfNodes/GetNthNode is slow, fasten by using collection
-  /// iterators.
-  for (int n=0; n < this->Scene->GetNumberOfNodes(); n++) 
+  // Other scene views of the scene, their stored nodes are reused when the
+  // scene nodes have not been modified since they were stored or restored.
+  std::vector<vtkMRMLSceneViewNode*> sceneViews;
+  for (std::set<vtkMRMLSceneViewNode*>::const_iterator viewIt = SceneViewNodes.begin();
+       viewIt != SceneViewNodes.end(); ++viewIt)
     {
-    vtkMRMLNode *node = this->Scene->GetNthNode(n);
-    if (this->IncludeNodeInSceneView(node) &&
-        node->GetSaveWithScene() )
+    if (*viewIt != this && (*viewIt)->GetScene() == this->Scene &&
+        (*viewIt)->GetStoredScene() != NULL &&
+        (*viewIt)->GetStoredScene() != this->SnapshotScene)
       {
-      vtkSmartPointer<vtkMRMLNode> newNode = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+      sceneViews.push_back(*viewIt);
+      }
+    }
 
-      newNode->SetScene(this->SnapshotScene);
-      newNode->CopyWithoutModifiedEvent(node);
-      newNode->SetID(node->GetID());
+  vtkCollectionSimpleIterator it;
+  vtkCollection* sceneNodes = this->Scene->GetNodes();
+  vtkMRMLNode* node = NULL;
+  for (sceneNodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(sceneNodes->GetNextItemAsObject(it))) ;)
+    {
+    if (!this->IncludeNodeInSceneView(node) ||
+        !node->GetSaveWithScene())
+      {
+      continue;
+      }
+    vtkMRMLNode* sharedNode = NULL;
+    for (std::vector<vtkMRMLSceneViewNode*>::const_iterator viewIt = sceneViews.begin();
+         viewIt != sceneViews.end() && !sharedNode; ++viewIt)
+      {
+      if ((*viewIt)->IsSceneNodeStored(node))
+        {
+        sharedNode = (*viewIt)->GetStoredScene()->GetNodeByID(node->GetID());
+        }
+      }
+    if (sharedNode)
+      {
+      // the node keeps the stored scene that owns it
+      this->SnapshotScene->GetNodes()->vtkCollection::AddItem(sharedNode);
+      this->SnapshotScene->AddNodeID(sharedNode);
+      continue;
+      }
 
-      newNode->SetAddToSceneNoModify(1);
-      this->SnapshotScene->AddNode(newNode);
-      newNode->SetAddToSceneNoModify(0);
+    vtkSmartPointer<vtkMRMLNode> newNode = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
 
-      // sanity check
-      assert(newNode->GetScene() == this->SnapshotScene);
-      }
+    newNode->SetScene(this->SnapshotScene);
+    newNode->CopyWithoutModifiedEvent(node);
+    newNode->SetID(node->GetID());
+
+    newNode->SetAddToSceneNoModify(1);
+    this->SnapshotScene->AddNode(newNode);
+    newNode->SetAddToSceneNoModify(0);
+
+    // sanity check
+    assert(newNode->GetScene() == this->SnapshotScene);
     }
   this->SnapshotScene->CopyNodeReferences(this->GetScene());
   this->SnapshotScene->CopyNodeChangedIDs(this->GetScene());
+  this->MarkSceneNodesAsStored();
 }
 
 //----------------------------------------------------------------------------
@@ -451,6 +549,14 @@ void vtkMRMLSceneViewNode::RestoreScene()
       removedNodes.push(vtkSmartPointer<vtkMRMLNode>(node));
       }
     }
+  // IDs of the nodes to update once the scene is restored: the restored
+  // nodes and the nodes referencing the added, modified or removed nodes.
+  std::set<std::string> nodeIDsToUpdate;
+  for (std::stack<vtkSmartPointer<vtkMRMLNode> > nodes(removedNodes);
+       !nodes.empty(); nodes.pop())
+    {
+    AddReferencingNodeIDs(this->Scene, nodes.top(), nodeIDsToUpdate);
+    }
   while(!removedNodes.empty())
     {
     vtkMRMLNode* nodeToRemove = removedNodes.top().GetPointer();
@@ -480,10 +586,18 @@ void vtkMRMLSceneViewNode::RestoreScene()
         if (snode)
           {
           snode->SetScene(this->Scene);
+          // nodes that didn't change since the scene view was stored or
+          // restored are left untouched
+          if (this->IsSceneNodeStored(snode))
+            {
+            continue;
+            }
           // to prevent copying of default info if not stored in sanpshot
           snode->CopyWithSingleModifiedEvent(node);
           // to prevent reading data on UpdateScene()
           snode->SetAddToSceneNoModify(0);
+          nodeIDsToUpdate.insert(snode->GetID());
+          AddReferencingNodeIDs(this->Scene, snode, nodeIDsToUpdate);
           }
         else 
           {
@@ -494,6 +608,8 @@ void vtkMRMLSceneViewNode::RestoreScene()
           newNode->SetAddToSceneNoModify(1);
           this->Scene->AddNode(newNode);
           newNode->Delete();
+          nodeIDsToUpdate.insert(newNode->GetID());
+          AddReferencingNodeIDs(this->Scene, newNode, nodeIDsToUpdate);
           
           // to prevent reading data on UpdateScene()
           // but new nodes should read their data
@@ -503,14 +619,16 @@ void vtkMRMLSceneViewNode::RestoreScene()
       }
     }
   
-  // update all nodes in the scene
+  // update the restored nodes and the nodes referencing them
 
   //this->Scene->UpdateNodeReferences(this->Nodes);
 
   for (sceneNodes->InitTraversal(it);
+       !nodeIDsToUpdate.empty() &&
        (node = vtkMRMLNode::SafeDownCast(sceneNodes->GetNextItemAsObject(it))) ;)
     {
-    if (this->IncludeNodeInSceneView(node) && node->GetSaveWithScene())
+    if (node->GetID() && nodeIDsToUpdate.count(node->GetID()) &&
+        this->IncludeNodeInSceneView(node) && node->GetSaveWithScene())
       {
       node->UpdateScene(this->Scene);
       }
@@ -523,6 +641,8 @@ void vtkMRMLSceneViewNode::RestoreScene()
     //this->Scene->InvokeEvent(vtkMRMLScene::NodeAddedEvent, addedNodes[n] );
     }
 
+  this->MarkSceneNodesAsStored();
+
   this->Scene->EndState(vtkMRMLScene::RestoreState);
 
 #ifndef NDEBUG
@@ -541,6 +661,106 @@ vtkMRMLScene* vtkMRMLSceneViewNode::GetStoredScene()
   return this->SnapshotScene;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSceneViewNode::ReleaseSharedNodes()
+{
+  if (this->SnapshotScene == NULL)
+    {
+    return;
+    }
+  vtkCollectionSimpleIterator it;
+  vtkCollection* nodes = this->SnapshotScene->GetNodes();
+  vtkMRMLNode* node = NULL;
+  for (nodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+    {
+    if (node->GetScene() != this->SnapshotScene)
+      {
+      continue;
+      }
+    vtkMRMLScene* otherStoredScene = FindOtherStoredScene(node, this->SnapshotScene);
+    if (otherStoredScene)
+      {
+      node->SetScene(otherStoredScene);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneViewNode::DetachSharedNodes()
+{
+  if (this->SnapshotScene == NULL)
+    {
+    return;
+    }
+  for (int n = 0; n < this->SnapshotScene->GetNodes()->GetNumberOfItems(); ++n)
+    {
+    this->DetachSharedNode(n);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLSceneViewNode::DetachSharedNode(int n)
+{
+  vtkCollection* nodes = this->SnapshotScene->GetNodes();
+  vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(nodes->GetItemAsObject(n));
+  if (node == NULL)
+    {
+    return NULL;
+    }
+  vtkMRMLScene* otherStoredScene = FindOtherStoredScene(node, this->SnapshotScene);
+  if (otherStoredScene == NULL)
+    {
+    return node;
+    }
+  // the other scene views keep the shared node
+  if (node->GetScene() == this->SnapshotScene)
+    {
+    node->SetScene(otherStoredScene);
+    }
+  vtkSmartPointer<vtkMRMLNode> newNode = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+  newNode->SetScene(this->SnapshotScene);
+  newNode->CopyWithoutModifiedEvent(node);
+  newNode->SetID(node->GetID());
+  nodes->ReplaceItem(n, newNode);
+  this->SnapshotScene->AddNodeID(newNode);
+  return newNode;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSceneViewNode::MarkSceneNodesAsStored()
+{
+  vtkCollectionSimpleIterator it;
+  vtkCollection* nodes = this->SnapshotScene->GetNodes();
+  vtkMRMLNode* node = NULL;
+  for (nodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+    {
+    vtkMRMLNode* sceneNode = node->GetID() ? this->Scene->GetNodeByID(node->GetID()) : NULL;
+    if (sceneNode)
+      {
+      this->StoredSceneNodes[node->GetID()] =
+        std::make_pair(sceneNode, sceneNode->GetMTime());
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSceneViewNode::IsSceneNodeStored(vtkMRMLNode* sceneNode)
+{
+  if (sceneNode->GetID() == NULL)
+    {
+    return false;
+    }
+  std::map<std::string, std::pair<vtkMRMLNode*, unsigned long> >::const_iterator
+    storedIt = this->StoredSceneNodes.find(sceneNode->GetID());
+  // the modification time is global, a node created at the address of a
+  // deleted node is more recent than the recorded time
+  return storedIt != this->StoredSceneNodes.end() &&
+    storedIt->second.first == sceneNode &&
+    sceneNode->GetMTime() <= storedIt->second.second;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSceneViewNode::SetAbsentStorageFileNames()
 {
@@ -571,8 +791,13 @@ void vtkMRMLSceneViewNode::SetAbsentStorageFileNames()
         if (node1)
           {
           vtkMRMLStorageNode *snode1 = vtkMRMLStorageNode::SafeDownCast(node1);
-          if (snode1)
+          if (snode1 &&
+              std::string(snode->GetFileName() ? snode->GetFileName() : "") !=
+              std::string(snode1->GetFileName() ? snode1->GetFileName() : ""))
             {
+            // the other scene views sharing the storage node keep their
+            // file name
+            snode = vtkMRMLStorageNode::SafeDownCast(this->DetachSharedNode(n));
             snode->SetFileName(snode1->GetFileName());
             }
           }
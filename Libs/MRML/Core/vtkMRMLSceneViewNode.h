@@ -21,6 +21,9 @@
 #include <vtkStdString.h>
 class vtkImageData;
 
+// STD includes
+#include <map>
+
 class vtkMRMLStorageNode;
 class VTK_MRML_EXPORT vtkMRMLSceneViewNode : public vtkMRMLStorableNode
 {
@@ -69,11 +72,18 @@ class VTK_MRML_EXPORT vtkMRMLSceneViewNode : public vtkMRMLStorableNode
 
   /// 
   /// Store content of the scene
+  /// Nodes that have not been modified since another scene view of the
+  /// scene stored or restored them are not copied: the stored scenes share
+  /// the same node instance. A scene view replaces a shared node by its own
+  /// copy before modifying it.
   /// \sa GetStoredScene() RestoreScene()
   void StoreScene();
 
   /// 
   /// Restore content of the scene from the node
+  /// Only the nodes modified since they were stored or restored are copied,
+  /// added or removed; the scene is in RestoreState during the whole
+  /// operation.
   /// \sa GetStoredScene() StoreScene()
   void RestoreScene();
 
@@ -118,6 +128,24 @@ protected:
   vtkMRMLSceneViewNode(const vtkMRMLSceneViewNode&);
   void operator=(const vtkMRMLSceneViewNode&);
 
+  /// Give the stored nodes shared with other scene views to one of them
+  /// before the stored scene is cleared, so they keep a valid scene.
+  void ReleaseSharedNodes();
+
+  /// Replace the stored nodes shared with other scene views by copies owned
+  /// by this scene view. Must be called before modifying the stored nodes.
+  void DetachSharedNodes();
+
+  /// Replace the nth stored node by a copy owned by this scene view if it is
+  /// shared with other scene views. Returns the stored node.
+  vtkMRMLNode* DetachSharedNode(int n);
+
+  /// Record that the nodes of the scene are identical to the stored nodes.
+  void MarkSceneNodesAsStored();
+
+  /// Return true if the scene node has not been modified since it was
+  /// stored or restored by this scene view.
+  bool IsSceneNodeStored(vtkMRMLNode* sceneNode);
 
   vtkMRMLScene* SnapshotScene;
 
@@ -130,6 +158,10 @@ protected:
   /// The type of the screenshot
   int ScreenShotType;
 
+  /// Scene nodes identical to the stored nodes, with their modification time
+  /// at the time they were stored or restored.
+  std::map<std::string, std::pair<vtkMRMLNode*, unsigned long> > StoredSceneNodes;
+
 };
 
 #endif
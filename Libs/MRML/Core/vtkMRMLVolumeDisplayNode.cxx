@@ -29,6 +29,7 @@ vtkMRMLVolumeDisplayNode::vtkMRMLVolumeDisplayNode()
 {
   // try setting a default greyscale color map
   //this->SetDefaultColorMap(0);
+  this->UseMipmapPyramid = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -40,13 +41,31 @@ vtkMRMLVolumeDisplayNode::~vtkMRMLVolumeDisplayNode()
 void vtkMRMLVolumeDisplayNode::WriteXML(ostream& of, int nIndent)
 {
   Superclass::WriteXML(of, nIndent);
+
+  vtkIndent indent(nIndent);
+  of << indent << " useMipmapPyramid=\"" << (this->UseMipmapPyramid ? "true" : "false") << "\"";
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeDisplayNode::ReadXMLAttributes(const char** atts)
 {
+  int disabledModify = this->StartModify();
 
   Superclass::ReadXMLAttributes(atts);
+
+  const char* attName;
+  const char* attValue;
+  while (*atts != NULL)
+    {
+    attName = *(atts++);
+    attValue = *(atts++);
+    if (!strcmp(attName, "useMipmapPyramid"))
+      {
+      this->SetUseMipmapPyramid(!strcmp(attValue, "true") ? 1 : 0);
+      }
+    }
+
+  this->EndModify(disabledModify);
 }
 
 //----------------------------------------------------------------------------
@@ -54,9 +73,16 @@ void vtkMRMLVolumeDisplayNode::ReadXMLAttributes(const char** atts)
 // Does NOT copy: ID, FilePrefix, Name, VolumeID
 void vtkMRMLVolumeDisplayNode::Copy(vtkMRMLNode *anode)
 {
+  int disabledModify = this->StartModify();
+
   Superclass::Copy(anode);
-  //vtkMRMLVolumeDisplayNode *node = (vtkMRMLVolumeDisplayNode *) anode;
+  vtkMRMLVolumeDisplayNode *node = vtkMRMLVolumeDisplayNode::SafeDownCast(anode);
+  if (node)
+    {
+    this->SetUseMipmapPyramid(node->GetUseMipmapPyramid());
+    }
 
+  this->EndModify(disabledModify);
 }
 
 //---------------------------------------------------------------------------
@@ -75,6 +101,7 @@ void vtkMRMLVolumeDisplayNode::ProcessMRMLEvents(vtkObject *caller,
 void vtkMRMLVolumeDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "UseMipmapPyramid: " << this->UseMipmapPyramid << "\n";
 }
 
 //-----------------------------------------------------------
@@ -108,6 +108,15 @@ public:
   /// to
   vtkMRMLVolumeNode* GetVolumeNode();
 
+  /// Reslice the slice views from a downsampled version of the volume while
+  /// the slices are zoomed out and interacted with. The downsampled versions
+  /// are built in the background the first time they are needed and use
+  /// about a seventh of the memory of the volume. Off by default.
+  /// \sa vtkImageMipmapPyramid
+  vtkSetMacro(UseMipmapPyramid, int);
+  vtkGetMacro(UseMipmapPyramid, int);
+  vtkBooleanMacro(UseMipmapPyramid, int);
+
 protected:
   vtkMRMLVolumeDisplayNode();
   ~vtkMRMLVolumeDisplayNode();
@@ -115,6 +124,8 @@ protected:
   void operator=(const vtkMRMLVolumeDisplayNode&);
   
   virtual void SetInputToImageDataPipeline(vtkImageData *imageData);
+
+  int UseMipmapPyramid;
 };
 
 #endif
@@ -3,7 +3,12 @@
 #include "vtkPermissionPrompter.h"
 
 // VTK includes
+#include <vtkIntArray.h>
 #include <vtkObjectFactory.h>
+#include <vtkStringArray.h>
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
 
 vtkStandardNewMacro ( vtkURIHandler );
 vtkCxxRevisionMacro ( vtkURIHandler, "$Revision: 1.0 $" );
@@ -112,6 +117,39 @@ void vtkURIHandler::StageFileWrite ( const char * vtkNotUsed( source ), const ch
 {
 }
 
+//----------------------------------------------------------------------------
+int vtkURIHandler::StageFileReads(vtkStringArray* sources,
+                                  vtkStringArray* destinations,
+                                  vtkIntArray* succeeded)
+{
+  if (sources == NULL || destinations == NULL ||
+      sources->GetNumberOfValues() != destinations->GetNumberOfValues())
+    {
+    vtkErrorMacro("StageFileReads: sources and destinations don't match!");
+    return sources ? static_cast<int>(sources->GetNumberOfValues()) : 0;
+    }
+  const int numberOfFiles = static_cast<int>(sources->GetNumberOfValues());
+  if (succeeded)
+    {
+    succeeded->SetNumberOfComponents(1);
+    succeeded->SetNumberOfTuples(numberOfFiles);
+    }
+  int failed = 0;
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    const std::string& destination = destinations->GetValue(i);
+    this->StageFileRead(sources->GetValue(i).c_str(), destination.c_str());
+    // StageFileRead doesn't report errors, the file is there or not
+    bool downloaded = vtksys::SystemTools::FileExists(destination.c_str(), true);
+    if (succeeded)
+      {
+      succeeded->SetValue(i, downloaded ? 1 : 0);
+      }
+    failed += downloaded ? 0 : 1;
+    }
+  return failed;
+}
+
 //----------------------------------------------------------------------------
 void vtkURIHandler::StageFileRead(const char * vtkNotUsed( source ),
                              const char * vtkNotUsed( destination ),
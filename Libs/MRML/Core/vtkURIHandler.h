@@ -4,6 +4,8 @@
 // MRML includes
 #include "vtkMRML.h"
 class vtkPermissionPrompter;
+class vtkIntArray;
+class vtkStringArray;
 
 // VTK includes
 #include <vtkObject.h>
@@ -26,6 +28,16 @@ public:
   virtual void StageFileRead ( const char *source, const char * destination );
   virtual void StageFileWrite ( const char *source, const char * destination );
 
+  /// 
+  /// Download the files of \a sources into the files of \a destinations.
+  /// The default implementation stages the files one after the other,
+  /// handlers able to download several files concurrently override it.
+  /// If \a succeeded is not null, it is set to 1 for each download that
+  /// succeeded and 0 otherwise. Returns the number of failed downloads.
+  virtual int StageFileReads(vtkStringArray* sources,
+                             vtkStringArray* destinations,
+                             vtkIntArray* succeeded = 0);
+
   /// 
   /// various Read/Write method footprints useful to redefine in specific handlers.
   virtual void StageFileRead(const char * source,
@@ -34,11 +34,14 @@
 
 // VTK includes
 #include <vtkCamera.h>
+#include <vtkCellPicker.h>
 #include <vtkErrorCode.h>
 #include <vtkImageData.h>
 #include <vtkInteractorEventRecorder.h>
 #include <vtkNew.h>
 #include <vtkPNGWriter.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
 #include <vtkRegressionTestImage.h>
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
@@ -47,10 +50,103 @@
 #include <vtkWindowToImageFilter.h>
 
 // STD includes
+#include <cmath>
+#include <iostream>
 
 const char vtkMRMLModelDisplayableManagerTest1EventLog[] =
 "# StreamVersion 1\n";
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// The displayable manager picks with cell locators, a cell picker without
+// locator must pick the same cells at the same positions.
+bool comparePicks(vtkMRMLModelDisplayableManager* displayableManager,
+                  vtkRenderer* renderer)
+{
+  vtkNew<vtkCellPicker> picker;
+  picker->SetTolerance(displayableManager->GetPickTolerance());
+  const int* size = renderer->GetSize();
+  int numberOfHits = 0;
+  for (int y = 0; y < size[1]; y += size[1] / 20)
+    {
+    for (int x = 0; x < size[0]; x += size[0] / 20)
+      {
+      displayableManager->Pick(x, y);
+      picker->Pick(x, size[1] - y, 0., renderer);
+      double* pickedRAS = displayableManager->GetPickedRAS();
+      double* expectedRAS = picker->GetPickPosition();
+      if (displayableManager->GetPickedCellID() != picker->GetCellId() ||
+          fabs(pickedRAS[0] - expectedRAS[0]) > 1e-6 ||
+          fabs(pickedRAS[1] - expectedRAS[1]) > 1e-6 ||
+          fabs(pickedRAS[2] - expectedRAS[2]) > 1e-6)
+        {
+        std::cerr << "Line " << __LINE__ << ": wrong pick at " << x << ", " << y
+                  << ": cell " << displayableManager->GetPickedCellID() << " at "
+                  << pickedRAS[0] << " " << pickedRAS[1] << " " << pickedRAS[2]
+                  << " instead of cell " << picker->GetCellId() << " at "
+                  << expectedRAS[0] << " " << expectedRAS[1] << " " << expectedRAS[2]
+                  << std::endl;
+        return false;
+        }
+      numberOfHits += picker->GetCellId() >= 0 ? 1 : 0;
+      }
+    }
+  if (numberOfHits == 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": nothing is picked" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool testPick(vtkMRMLModelDisplayableManager* displayableManager,
+              vtkRenderer* renderer, vtkMRMLScene* scene)
+{
+  // Enough cells for the model to be picked with a locator
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetRadius(12.);
+  sphereSource->SetThetaResolution(64);
+  sphereSource->SetPhiResolution(64);
+  sphereSource->Update();
+  vtkNew<vtkPolyData> polyData;
+  polyData->DeepCopy(sphereSource->GetOutput());
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetAndObservePolyData(polyData.GetPointer());
+  scene->AddNode(modelNode.GetPointer());
+  vtkNew<vtkMRMLModelDisplayNode> modelDisplayNode;
+  scene->AddNode(modelDisplayNode.GetPointer());
+  modelNode->AddAndObserveDisplayNodeID(modelDisplayNode->GetID());
+  renderer->GetRenderWindow()->Render();
+
+  bool res = comparePicks(displayableManager, renderer);
+
+  // Move the points in place: the locator built when the model was
+  // displayed is out of date
+  vtkPoints* points = polyData->GetPoints();
+  for (vtkIdType i = 0; res && i < points->GetNumberOfPoints(); ++i)
+    {
+    double point[3];
+    points->GetPoint(i, point);
+    points->SetPoint(i, 0.8 * point[0] + 2., 0.8 * point[1], 0.8 * point[2]);
+    }
+  points->Modified();
+  polyData->Modified();
+  res = res && comparePicks(displayableManager, renderer);
+
+  // Hidden models are not picked, with or without locator
+  modelDisplayNode->SetVisibility(0);
+  res = res && comparePicks(displayableManager, renderer);
+
+  scene->RemoveNode(modelDisplayNode.GetPointer());
+  scene->RemoveNode(modelNode.GetPointer());
+  return res;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 int vtkMRMLModelDisplayableManagerTest(int argc, char* argv[])
 {
@@ -109,6 +205,15 @@ int vtkMRMLModelDisplayableManagerTest(int argc, char* argv[])
   renderer->SetBackground2(0, 83. / 255, 155. /255);
   renderer->SetGradientBackground(true);
   renderer->ResetCamera();
+  renderWindow->Render();
+
+  if (!testPick(vrDisplayableManager.GetPointer(), renderer.GetPointer(), scene))
+    {
+    vrDisplayableManager->SetMRMLApplicationLogic(0);
+    applicationLogic->Delete();
+    scene->Delete();
+    return EXIT_FAILURE;
+    }
 
   // Event recorder
   bool disableReplay = false, record = false, screenshot = false;
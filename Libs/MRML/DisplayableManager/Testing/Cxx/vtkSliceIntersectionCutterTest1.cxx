@@ -0,0 +1,213 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkSliceIntersectionCutter.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCutter.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+double totalLineLength(vtkPolyData* polyData)
+{
+  double length = 0.;
+  vtkCellArray* lines = polyData->GetLines();
+  if (!lines)
+    {
+    return length;
+    }
+  vtkIdType npts = 0;
+  vtkIdType* pts = 0;
+  for (lines->InitTraversal(); lines->GetNextCell(npts, pts);)
+    {
+    for (vtkIdType i = 0; i + 1 < npts; ++i)
+      {
+      double p0[3];
+      double p1[3];
+      polyData->GetPoint(pts[i], p0);
+      polyData->GetPoint(pts[i + 1], p1);
+      length += sqrt(vtkMath::Distance2BetweenPoints(p0, p1));
+      }
+    }
+  return length;
+}
+
+//----------------------------------------------------------------------------
+bool TestSameAsCutter()
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(10.);
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+  sphere->Update();
+
+  vtkNew<vtkPlane> plane;
+  vtkNew<vtkCutter> cutter;
+  cutter->SetInput(sphere->GetOutput());
+  cutter->SetCutFunction(plane.GetPointer());
+  cutter->SetGenerateCutScalars(0);
+  vtkNew<vtkSliceIntersectionCutter> indexedCutter;
+  indexedCutter->SetInput(sphere->GetOutput());
+  indexedCutter->SetPlane(plane.GetPointer());
+
+  const double normals[3][3] = {{0., 0., 1.}, {1., 0., 0.}, {0.6, 0., -0.8}};
+  for (int n = 0; n < 3; ++n)
+    {
+    plane->SetNormal(normals[n][0], normals[n][1], normals[n][2]);
+    for (double offset = -12.; offset <= 12.; offset += 0.7)
+      {
+      plane->SetOrigin(normals[n][0] * offset, normals[n][1] * offset,
+                       normals[n][2] * offset);
+      cutter->Update();
+      indexedCutter->Update();
+      vtkPolyData* expected = cutter->GetOutput();
+      vtkPolyData* output = indexedCutter->GetOutput();
+      const double expectedLength = totalLineLength(expected);
+      const double length = totalLineLength(output);
+      if (expected->GetNumberOfLines() != output->GetNumberOfLines() ||
+          fabs(expectedLength - length) > 1e-6 * (1. + expectedLength))
+        {
+        std::cerr << "Line " << __LINE__ << ": cut " << n << " at " << offset
+                  << " has " << output->GetNumberOfLines() << " lines of length "
+                  << length << ", vtkCutter: " << expected->GetNumberOfLines()
+                  << " lines of length " << expectedLength << std::endl;
+        return false;
+        }
+      if (fabs(offset) > 10. && indexedCutter->GetNumberOfTestedCells() != 0)
+        {
+        std::cerr << "Line " << __LINE__ << ": cells tested for a plane"
+                  << " outside of the bounds" << std::endl;
+        return false;
+        }
+      if (indexedCutter->GetNumberOfTestedCells() >
+          sphere->GetOutput()->GetNumberOfCells() / 4)
+        {
+        std::cerr << "Line " << __LINE__ << ": " << indexedCutter->GetNumberOfTestedCells()
+                  << " cells tested out of " << sphere->GetOutput()->GetNumberOfCells()
+                  << std::endl;
+        return false;
+        }
+      }
+    }
+  // The 3 normals share the same polydata
+  if (vtkSliceIntersectionCutter::GetNumberOfCachedIndexes() != 3)
+    {
+    std::cerr << "Line " << __LINE__ << ": "
+              << vtkSliceIntersectionCutter::GetNumberOfCachedIndexes()
+              << " cached indexes instead of 3" << std::endl;
+    return false;
+    }
+  vtkSliceIntersectionCutter::ClearCache();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Time the cut of many models by a plane scrolling through them
+bool TestScrollingPerformance()
+{
+  const int modelCount = 200;
+  const int sliceCount = 100;
+  std::vector<vtkSmartPointer<vtkPolyData> > models;
+  for (int i = 0; i < modelCount; ++i)
+    {
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetCenter(20. * (i % 10), 20. * ((i / 10) % 10), 5. * i);
+    sphere->SetRadius(8.);
+    sphere->SetThetaResolution(48);
+    sphere->SetPhiResolution(48);
+    sphere->Update();
+    models.push_back(sphere->GetOutput());
+    }
+
+  vtkNew<vtkPlane> plane;
+  plane->SetNormal(0., 0., 1.);
+  std::vector<vtkSmartPointer<vtkCutter> > cutters;
+  std::vector<vtkSmartPointer<vtkSliceIntersectionCutter> > indexedCutters;
+  for (int i = 0; i < modelCount; ++i)
+    {
+    vtkSmartPointer<vtkCutter> cutter = vtkSmartPointer<vtkCutter>::New();
+    cutter->SetInput(models[i]);
+    cutter->SetCutFunction(plane.GetPointer());
+    cutter->SetGenerateCutScalars(0);
+    cutters.push_back(cutter);
+    vtkSmartPointer<vtkSliceIntersectionCutter> indexedCutter =
+      vtkSmartPointer<vtkSliceIntersectionCutter>::New();
+    indexedCutter->SetInput(models[i]);
+    indexedCutter->SetPlane(plane.GetPointer());
+    indexedCutters.push_back(indexedCutter);
+    }
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int s = 0; s < sliceCount; ++s)
+    {
+    plane->SetOrigin(0., 0., 10. * s);
+    for (int i = 0; i < modelCount; ++i)
+      {
+      cutters[i]->Update();
+      }
+    }
+  timer->StopTimer();
+  const double cutterTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  for (int s = 0; s < sliceCount; ++s)
+    {
+    plane->SetOrigin(0., 0., 10. * s);
+    for (int i = 0; i < modelCount; ++i)
+      {
+      indexedCutters[i]->Update();
+      }
+    }
+  timer->StopTimer();
+  const double indexedCutterTime = timer->GetElapsedTime();
+
+  std::cout << "<DartMeasurement name=\"vtkCutter-Scrolling-"
+            << modelCount << "\" type=\"numeric/double\">"
+            << cutterTime << "</DartMeasurement>" << std::endl;
+  std::cout << "<DartMeasurement name=\"vtkSliceIntersectionCutter-Scrolling-"
+            << modelCount << "\" type=\"numeric/double\">"
+            << indexedCutterTime << "</DartMeasurement>" << std::endl;
+  vtkSliceIntersectionCutter::ClearCache();
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSliceIntersectionCutterTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  bool res = true;
+  res = TestSameAsCutter() && res;
+  res = TestScrollingPerformance() && res;
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
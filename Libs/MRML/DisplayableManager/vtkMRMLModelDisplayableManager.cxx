@@ -35,8 +35,11 @@
 #include "vtkMRMLInteractionNode.h"
 
 // VTK includes
+#include <vtkActor.h>
 #include <vtkAssignAttribute.h>
+#include <vtkBox.h>
 #include <vtkCellArray.h>
+#include <vtkCellLocator.h>
 #include <vtkClipPolyData.h>
 #include <vtkColorTransferFunction.h>
 #include <vtkDataSetAttributes.h>
@@ -48,6 +51,7 @@
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkRenderWindowInteractor.h>
@@ -79,6 +83,18 @@ public:
   /// Reset all the pick vars
   void ResetPick();
 
+  /// Create the locator of the poly data displayed by the actor and build
+  /// it if the actor is visible and pickable. Called when the model is
+  /// displayed or its poly data modified, so that picks don't build it.
+  void UpdateCellLocator(vtkProp3D* actor);
+  /// Give the cell picker the locators that are up to date. The locators
+  /// that are not (e.g. the actor was hidden) are built only if the pick
+  /// ray hits the bounds of their actor, the others can't be picked.
+  void UpdateCellLocatorsForPick(double displayPoint[3], vtkRenderer* renderer);
+  /// Release the locator of the poly data displayed by the actor
+  void RemoveCellLocator(vtkProp3D* actor);
+  void RemoveAllCellLocators();
+
   std::map<std::string, vtkProp3D *>               DisplayedActors;
   std::map<std::string, vtkMRMLDisplayNode *>      DisplayedNodes;
   std::map<std::string, int>                       DisplayedClipState;
@@ -110,6 +126,18 @@ public:
   vtkSmartPointer<vtkCellPicker>       CellPicker;
   vtkSmartPointer<vtkPointPicker>      PointPicker;
 
+  /// Cell locator of the poly data displayed by an actor. Picking a model
+  /// intersects the ray with every cell of the model without a locator.
+  struct CellLocator
+  {
+    CellLocator() : BuildPolyDataMTime(0) {}
+    vtkSmartPointer<vtkCellLocator> Locator;
+    /// Modified time of the poly data when the locator was built, 0 if the
+    /// locator has not been built
+    unsigned long BuildPolyDataMTime;
+  };
+  std::map<vtkProp3D*, CellLocator> CellLocators;
+
   /// Information about a pick event
   std::string  PickedNodeID;
   double       PickedRAS[3];
@@ -178,6 +206,129 @@ void vtkMRMLModelDisplayableManager::vtkInternal::ResetPick()
 }
 
 
+//---------------------------------------------------------------------------
+namespace
+{
+// Below this number of cells, building a locator costs more than the picks
+const vtkIdType MinimumNumberOfCellsForLocator = 1000;
+
+vtkPolyData* GetActorPolyData(vtkProp3D* prop)
+{
+  vtkActor* actor = vtkActor::SafeDownCast(prop);
+  if (!actor || !actor->GetMapper())
+    {
+    return 0;
+    }
+  return vtkPolyData::SafeDownCast(actor->GetMapper()->GetInput());
+}
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::UpdateCellLocator(vtkProp3D* actor)
+{
+  vtkPolyData* polyData = GetActorPolyData(actor);
+  if (!polyData || polyData->GetNumberOfCells() < MinimumNumberOfCellsForLocator)
+    {
+    this->RemoveCellLocator(actor);
+    return;
+    }
+  CellLocator& cellLocator = this->CellLocators[actor];
+  if (!cellLocator.Locator)
+    {
+    cellLocator.Locator = vtkSmartPointer<vtkCellLocator>::New();
+    }
+  if (cellLocator.Locator->GetDataSet() != polyData)
+    {
+    cellLocator.Locator->SetDataSet(polyData);
+    cellLocator.BuildPolyDataMTime = 0;
+    }
+  if (actor->GetVisibility() && actor->GetPickable() &&
+      cellLocator.BuildPolyDataMTime != polyData->GetMTime())
+    {
+    cellLocator.Locator->BuildLocator();
+    cellLocator.BuildPolyDataMTime = polyData->GetMTime();
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal
+::UpdateCellLocatorsForPick(double displayPoint[3], vtkRenderer* renderer)
+{
+  // Pick ray, from the near to the far clipping plane
+  double ray[2][3];
+  for (int i = 0; i < 2; ++i)
+    {
+    double worldPoint[4];
+    renderer->SetDisplayPoint(displayPoint[0], displayPoint[1], i);
+    renderer->DisplayToWorld();
+    renderer->GetWorldPoint(worldPoint);
+    for (int j = 0; j < 3; ++j)
+      {
+      ray[i][j] = worldPoint[3] != 0. ? worldPoint[j] / worldPoint[3] : worldPoint[j];
+      }
+    }
+  double direction[3] = {ray[1][0] - ray[0][0],
+                         ray[1][1] - ray[0][1],
+                         ray[1][2] - ray[0][2]};
+
+  this->CellPicker->RemoveAllLocators();
+  std::map<vtkProp3D*, CellLocator>::iterator it;
+  for (it = this->CellLocators.begin(); it != this->CellLocators.end(); ++it)
+    {
+    vtkProp3D* actor = it->first;
+    vtkPolyData* polyData = vtkPolyData::SafeDownCast(it->second.Locator->GetDataSet());
+    if (!actor->GetVisibility() || !actor->GetPickable() || !polyData)
+      {
+      continue;
+      }
+    if (it->second.BuildPolyDataMTime != polyData->GetMTime())
+      {
+      // The bounds are padded to not miss the cells the picker finds
+      // within its tolerance.
+      double bounds[6];
+      actor->GetBounds(bounds);
+      const double padding = 0.01 * sqrt(
+        (bounds[1] - bounds[0]) * (bounds[1] - bounds[0]) +
+        (bounds[3] - bounds[2]) * (bounds[3] - bounds[2]) +
+        (bounds[5] - bounds[4]) * (bounds[5] - bounds[4]));
+      for (int i = 0; i < 3; ++i)
+        {
+        bounds[2 * i] -= padding;
+        bounds[2 * i + 1] += padding;
+        }
+      double hitPoint[3];
+      double t;
+      if (!vtkBox::IntersectBox(bounds, ray[0], direction, hitPoint, t))
+        {
+        // The picker intersects the cells without locator if it happens
+        // to test the actor.
+        continue;
+        }
+      it->second.Locator->BuildLocator();
+      it->second.BuildPolyDataMTime = polyData->GetMTime();
+      }
+    this->CellPicker->AddLocator(it->second.Locator);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::RemoveCellLocator(vtkProp3D* actor)
+{
+  std::map<vtkProp3D*, CellLocator>::iterator it = this->CellLocators.find(actor);
+  if (it != this->CellLocators.end())
+    {
+    this->CellPicker->DeleteLocator(it->second.Locator);
+    this->CellLocators.erase(it);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::RemoveAllCellLocators()
+{
+  this->CellPicker->RemoveAllLocators();
+  this->CellLocators.clear();
+}
+
 //---------------------------------------------------------------------------
 // vtkMRMLModelDisplayableManager methods
 
@@ -198,6 +349,7 @@ vtkMRMLModelDisplayableManager::~vtkMRMLModelDisplayableManager()
   vtkSetMRMLNodeMacro(this->Internal->YellowSliceNode, 0);
 
   // release the DisplayedModelActors
+  this->Internal->RemoveAllCellLocators();
   this->Internal->DisplayedActors.clear();
 
   delete this->Internal;
@@ -802,6 +954,7 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
       }
     this->RemoveModelObservers(1);
     this->RemoveHierarchyObservers(1);
+    this->Internal->RemoveAllCellLocators();
     this->Internal->DisplayedActors.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
@@ -1273,6 +1426,12 @@ void vtkMRMLModelDisplayableManager::RemoveDisplayable(vtkMRMLDisplayableNode* m
 void vtkMRMLModelDisplayableManager::RemoveDispalyedID(std::string &id)
 {
   std::map<std::string, vtkMRMLDisplayNode *>::iterator modelIter;
+  std::map<std::string, vtkProp3D *>::iterator actorIter =
+    this->Internal->DisplayedActors.find(id);
+  if (actorIter != this->Internal->DisplayedActors.end())
+    {
+    this->Internal->RemoveCellLocator(actorIter->second);
+    }
   this->Internal->DisplayedActors.erase(id);
   this->Internal->DisplayedClipState.erase(id);
   this->Internal->DisplayedVisibility.erase(id);
@@ -1322,6 +1481,7 @@ void vtkMRMLModelDisplayableManager::RemoveModelObservers(int clearCache)
   if (clearCache)
     {
     this->Internal->DisplayableNodes.clear();
+    this->Internal->RemoveAllCellLocators();
     this->Internal->DisplayedActors.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
@@ -1529,6 +1689,7 @@ void vtkMRMLModelDisplayableManager::SetModelDisplayProperty(vtkMRMLDisplayableN
           }
         imageActor->SetDisplayExtent(-1, 0, 0, 0, 0, 0);
         }
+      this->Internal->UpdateCellLocator(prop);
       }
     }
 
@@ -1719,6 +1880,7 @@ int vtkMRMLModelDisplayableManager::Pick(int x, int y)
   displayPoint[1] = renSize[1] - y;
   displayPoint[2] = 0.0;
 
+  this->Internal->UpdateCellLocatorsForPick(displayPoint, ren);
   if (this->Internal->CellPicker->Pick(displayPoint[0], displayPoint[1], displayPoint[2], ren))
     {
     this->Internal->CellPicker->GetPickPosition(pickPoint);
@@ -1770,7 +1932,7 @@ int vtkMRMLModelDisplayableManager::Pick(int x, int y)
               vtkDebugMacro("Pick: found closest point id = " << closestPointId << ", distance = " << closestDistance);
               this->SetPickedPointID(closestPointId);
               }
-            continue;
+            break;
             }
           }
         }
@@ -17,6 +17,7 @@
 
 // MRMLDisplayableManager includes
 #include "vtkMRMLModelSliceDisplayableManager.h"
+#include "vtkSliceIntersectionCutter.h"
 
 // MRML includes
 #include <vtkMRMLColorNode.h>
@@ -45,11 +46,6 @@
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkWeakPointer.h>
-#include <vtkPointLocator.h>
-
-
-// VTK includes: customization
-#include <vtkCutter.h>
 
 // STD includes
 #include <algorithm>
@@ -71,7 +67,7 @@ public:
     vtkSmartPointer<vtkTransform> TransformToSlice;
     vtkSmartPointer<vtkTransformPolyDataFilter> Transformer;
     vtkSmartPointer<vtkPlane> Plane;
-    vtkSmartPointer<vtkCutter> Cutter;
+    vtkSmartPointer<vtkSliceIntersectionCutter> Cutter;
     vtkSmartPointer<vtkProp> Actor;
     };
 
@@ -283,7 +279,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   // Create pipeline
   Pipeline* pipeline = new Pipeline();
   pipeline->Actor = actor.GetPointer();
-  pipeline->Cutter = vtkSmartPointer<vtkCutter>::New();
+  pipeline->Cutter = vtkSmartPointer<vtkSliceIntersectionCutter>::New();
   pipeline->TransformToSlice = vtkSmartPointer<vtkTransform>::New();
   pipeline->NodeToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
   pipeline->Transformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
@@ -292,8 +288,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   // Set up pipeline
   pipeline->Transformer->SetTransform(pipeline->TransformToSlice);
   pipeline->Transformer->SetInputConnection(pipeline->Cutter->GetOutputPort());
-  pipeline->Cutter->SetCutFunction(pipeline->Plane);
-  pipeline->Cutter->SetGenerateCutScalars(0);
+  pipeline->Cutter->SetPlane(pipeline->Plane);
   pipeline->Actor->SetVisibility(0);
 
   // Add actor to Renderer and local cache
@@ -352,11 +347,10 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
       {
       return;
       }
+    // The cutter caches an index of the cells of the polydata, don't
+    // modify the polydata here.
     pipeline->Cutter->SetInput(polyData);
 
-    // need this to update bounds of the locator, to avoid crash in the cutter 
-    polyData->Modified();
-
     // Update transform matrices
 
     vtkNew<vtkMatrix4x4> tempMat1;
@@ -379,17 +373,6 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
     pipeline->TransformToSlice->SetMatrix(tempMat2.GetPointer());
 
     pipeline->Plane->Modified(); 
-    
-    // optimization for slice to slice intersections which are 1 quad polydatas
-    // no need for 50^3 default locator divisons
-    if (polyData->GetPoints() != NULL && polyData->GetNumberOfPoints() <= 4)
-    {
-      vtkNew<vtkPointLocator> locator;
-      double *bounds = polyData->GetBounds();
-      locator->SetDivisions(2,2,2);
-      locator->InitPointInsertion(polyData->GetPoints(), bounds);
-      pipeline->Cutter->SetLocator(locator.GetPointer());
-    }
 
     // Update pipeline actor
     vtkActor2D* actor = vtkActor2D::SafeDownCast(pipeline->Actor);
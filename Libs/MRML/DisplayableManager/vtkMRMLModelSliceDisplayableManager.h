@@ -26,7 +26,6 @@
 #include "vtkMRMLDisplayableManagerWin32Header.h"
 
 class vtkMRMLDisplayableNode;
-class vtkCutter;
 class vtkProp;
 
 /// \brief Displayable manager for slice (2D) views.
@@ -34,6 +33,10 @@ class vtkProp;
 /// Responsible for any display on Slice views that is not the slice themselves
 /// nor the annotations.
 /// Currently support only glyph display for Diffusion Tensor volumes.
+///
+/// Model intersections are computed by vtkSliceIntersectionCutter which
+/// shares an index of the cells of each model between the slice views
+/// and skips the models that don't intersect the slice.
 class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkMRMLModelSliceDisplayableManager
   : public vtkMRMLAbstractSliceViewDisplayableManager
 {
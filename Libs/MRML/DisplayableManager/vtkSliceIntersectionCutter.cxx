@@ -0,0 +1,677 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkSliceIntersectionCutter.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+//---------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSliceIntersectionCutter);
+vtkCxxRevisionMacro(vtkSliceIntersectionCutter, "$Revision$");
+vtkCxxSetObjectMacro(vtkSliceIntersectionCutter, Plane, vtkPlane);
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+/// Cells of a polydata binned by their extent along a direction
+class CellIntervalIndex
+{
+public:
+  CellIntervalIndex();
+
+  void Build(vtkPolyData* polyData, const double direction[3]);
+
+  /// Append to \a cells the cells whose extent contains \a value.
+  /// Return the number of tested cells.
+  vtkIdType FindCells(double value, std::vector<vtkIdType>& cells)const;
+
+  double Direction[3];
+  unsigned long PolyDataMTime;
+  unsigned long LastUsed;
+  /// Projection of each point on Direction
+  std::vector<double> PointProjections;
+
+protected:
+  int GetBin(double value)const;
+
+  std::vector<double> CellMin;
+  std::vector<double> CellMax;
+  double Min;
+  double Max;
+  double BinWidth;
+  int NumberOfBins;
+  /// Cells of bin b are BinCells[BinOffsets[b]] to BinCells[BinOffsets[b+1]-1]
+  std::vector<vtkIdType> BinOffsets;
+  std::vector<vtkIdType> BinCells;
+  /// Cells spanning too many bins to be listed in each of them
+  std::vector<vtkIdType> LongCells;
+};
+
+//---------------------------------------------------------------------------
+CellIntervalIndex::CellIntervalIndex()
+{
+  this->Direction[0] = this->Direction[1] = this->Direction[2] = 0.;
+  this->PolyDataMTime = 0;
+  this->LastUsed = 0;
+  this->Min = 0.;
+  this->Max = 0.;
+  this->BinWidth = 1.;
+  this->NumberOfBins = 0;
+}
+
+//---------------------------------------------------------------------------
+int CellIntervalIndex::GetBin(double value)const
+{
+  int bin = static_cast<int>((value - this->Min) / this->BinWidth);
+  return std::max(0, std::min(this->NumberOfBins - 1, bin));
+}
+
+//---------------------------------------------------------------------------
+void CellIntervalIndex::Build(vtkPolyData* polyData, const double direction[3])
+{
+  std::copy(direction, direction + 3, this->Direction);
+  this->PolyDataMTime = polyData->GetMTime();
+
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  this->PointProjections.resize(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+    double x[3];
+    polyData->GetPoint(i, x);
+    this->PointProjections[i] = vtkMath::Dot(x, this->Direction);
+    }
+
+  const vtkIdType numberOfCells = polyData->GetNumberOfCells();
+  this->CellMin.resize(numberOfCells);
+  this->CellMax.resize(numberOfCells);
+  this->Min = VTK_DOUBLE_MAX;
+  this->Max = VTK_DOUBLE_MIN;
+  for (vtkIdType c = 0; c < numberOfCells; ++c)
+    {
+    vtkIdType npts = 0;
+    vtkIdType* pts = 0;
+    polyData->GetCellPoints(c, npts, pts);
+    double cellMin = VTK_DOUBLE_MAX;
+    double cellMax = VTK_DOUBLE_MIN;
+    for (vtkIdType i = 0; i < npts; ++i)
+      {
+      cellMin = std::min(cellMin, this->PointProjections[pts[i]]);
+      cellMax = std::max(cellMax, this->PointProjections[pts[i]]);
+      }
+    this->CellMin[c] = cellMin;
+    this->CellMax[c] = cellMax;
+    if (npts > 0)
+      {
+      this->Min = std::min(this->Min, cellMin);
+      this->Max = std::max(this->Max, cellMax);
+      }
+    }
+
+  this->BinOffsets.clear();
+  this->BinCells.clear();
+  this->LongCells.clear();
+  if (this->Min > this->Max)
+    {
+    // no cell with points
+    this->NumberOfBins = 0;
+    return;
+    }
+
+  // About 2*sqrt(n) bins: a plane intersects O(sqrt(n)) cells of a
+  // surface and a cell typically overlaps 1 or 2 bins.
+  this->NumberOfBins = std::max(1, std::min(65536,
+    static_cast<int>(2. * sqrt(static_cast<double>(numberOfCells)))));
+  this->BinWidth = (this->Max - this->Min) / this->NumberOfBins;
+  if (this->BinWidth <= 0.)
+    {
+    this->NumberOfBins = 1;
+    this->BinWidth = 1.;
+    }
+  const int maximumSpan = std::max(8, this->NumberOfBins / 16);
+
+  std::vector<vtkIdType> counts(this->NumberOfBins + 1, 0);
+  for (vtkIdType c = 0; c < numberOfCells; ++c)
+    {
+    if (this->CellMin[c] > this->CellMax[c])
+      {
+      continue;
+      }
+    const int first = this->GetBin(this->CellMin[c]);
+    const int last = this->GetBin(this->CellMax[c]);
+    if (last - first + 1 > maximumSpan)
+      {
+      this->LongCells.push_back(c);
+      continue;
+      }
+    for (int b = first; b <= last; ++b)
+      {
+      ++counts[b + 1];
+      }
+    }
+  this->BinOffsets.resize(this->NumberOfBins + 1, 0);
+  for (int b = 0; b < this->NumberOfBins; ++b)
+    {
+    this->BinOffsets[b + 1] = this->BinOffsets[b] + counts[b + 1];
+    }
+  this->BinCells.resize(this->BinOffsets[this->NumberOfBins]);
+  std::vector<vtkIdType> next(this->BinOffsets.begin(), this->BinOffsets.end() - 1);
+  for (vtkIdType c = 0; c < numberOfCells; ++c)
+    {
+    if (this->CellMin[c] > this->CellMax[c])
+      {
+      continue;
+      }
+    const int first = this->GetBin(this->CellMin[c]);
+    const int last = this->GetBin(this->CellMax[c]);
+    if (last - first + 1 > maximumSpan)
+      {
+      continue;
+      }
+    for (int b = first; b <= last; ++b)
+      {
+      this->BinCells[next[b]++] = c;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+vtkIdType CellIntervalIndex::FindCells(double value, std::vector<vtkIdType>& cells)const
+{
+  if (this->NumberOfBins == 0 || value < this->Min || value > this->Max)
+    {
+    return 0;
+    }
+  const int bin = this->GetBin(value);
+  const vtkIdType begin = this->BinOffsets[bin];
+  const vtkIdType end = this->BinOffsets[bin + 1];
+  for (vtkIdType i = begin; i < end; ++i)
+    {
+    const vtkIdType c = this->BinCells[i];
+    if (this->CellMin[c] <= value && value <= this->CellMax[c])
+      {
+      cells.push_back(c);
+      }
+    }
+  for (size_t i = 0; i < this->LongCells.size(); ++i)
+    {
+    const vtkIdType c = this->LongCells[i];
+    if (this->CellMin[c] <= value && value <= this->CellMax[c])
+      {
+      cells.push_back(c);
+      }
+    }
+  return (end - begin) + static_cast<vtkIdType>(this->LongCells.size());
+}
+
+//---------------------------------------------------------------------------
+/// Indexes of all the polydata cut by a vtkSliceIntersectionCutter
+class CellIntervalIndexCache
+{
+public:
+  CellIntervalIndexCache() : Clock(0) {}
+  ~CellIntervalIndexCache() { this->Clear(); }
+
+  /// Return an up to date index of \a polyData along \a direction or
+  /// along -direction (\a sign is then -1).
+  CellIntervalIndex* GetIndex(vtkPolyData* polyData, const double direction[3], double& sign);
+  int GetNumberOfIndexes()const;
+  void Clear();
+
+protected:
+  /// Release the indexes of the deleted polydata
+  void RemoveDeletedPolyData();
+
+  struct Entry
+    {
+    vtkWeakPointer<vtkPolyData> PolyData;
+    std::vector<CellIntervalIndex*> Indexes;
+    };
+  typedef std::map<vtkPolyData*, Entry> EntryMap;
+  EntryMap Entries;
+  unsigned long Clock;
+
+  /// Typically one per slice orientation
+  static const size_t MaximumNumberOfIndexesPerPolyData = 4;
+};
+
+//---------------------------------------------------------------------------
+CellIntervalIndex* CellIntervalIndexCache
+::GetIndex(vtkPolyData* polyData, const double direction[3], double& sign)
+{
+  ++this->Clock;
+  Entry& entry = this->Entries[polyData];
+  if (entry.PolyData.GetPointer() != polyData)
+    {
+    // new polydata, or the previous one at the same address was deleted
+    for (size_t i = 0; i < entry.Indexes.size(); ++i)
+      {
+      delete entry.Indexes[i];
+      }
+    entry.Indexes.clear();
+    entry.PolyData = polyData;
+    }
+
+  const unsigned long mtime = polyData->GetMTime();
+  for (size_t i = 0; i < entry.Indexes.size(); ++i)
+    {
+    CellIntervalIndex* index = entry.Indexes[i];
+    const double* indexDirection = index->Direction;
+    if (indexDirection[0] == direction[0] &&
+        indexDirection[1] == direction[1] &&
+        indexDirection[2] == direction[2])
+      {
+      sign = 1.;
+      }
+    else if (indexDirection[0] == -direction[0] &&
+             indexDirection[1] == -direction[1] &&
+             indexDirection[2] == -direction[2])
+      {
+      sign = -1.;
+      }
+    else
+      {
+      continue;
+      }
+    if (index->PolyDataMTime != mtime)
+      {
+      index->Build(polyData, index->Direction);
+      }
+    index->LastUsed = this->Clock;
+    return index;
+    }
+
+  // Build a new index, replace the least recently used one if needed
+  this->RemoveDeletedPolyData();
+  CellIntervalIndex* index = 0;
+  if (entry.Indexes.size() < MaximumNumberOfIndexesPerPolyData)
+    {
+    index = new CellIntervalIndex;
+    entry.Indexes.push_back(index);
+    }
+  else
+    {
+    index = entry.Indexes[0];
+    for (size_t i = 1; i < entry.Indexes.size(); ++i)
+      {
+      if (entry.Indexes[i]->LastUsed < index->LastUsed)
+        {
+        index = entry.Indexes[i];
+        }
+      }
+    }
+  index->Build(polyData, direction);
+  index->LastUsed = this->Clock;
+  sign = 1.;
+  return index;
+}
+
+//---------------------------------------------------------------------------
+void CellIntervalIndexCache::RemoveDeletedPolyData()
+{
+  EntryMap::iterator it = this->Entries.begin();
+  while (it != this->Entries.end())
+    {
+    if (it->second.PolyData.GetPointer() != 0)
+      {
+      ++it;
+      continue;
+      }
+    for (size_t i = 0; i < it->second.Indexes.size(); ++i)
+      {
+      delete it->second.Indexes[i];
+      }
+    this->Entries.erase(it++);
+    }
+}
+
+//---------------------------------------------------------------------------
+int CellIntervalIndexCache::GetNumberOfIndexes()const
+{
+  int count = 0;
+  for (EntryMap::const_iterator it = this->Entries.begin();
+       it != this->Entries.end(); ++it)
+    {
+    count += static_cast<int>(it->second.Indexes.size());
+    }
+  return count;
+}
+
+//---------------------------------------------------------------------------
+void CellIntervalIndexCache::Clear()
+{
+  for (EntryMap::iterator it = this->Entries.begin();
+       it != this->Entries.end(); ++it)
+    {
+    for (size_t i = 0; i < it->second.Indexes.size(); ++i)
+      {
+      delete it->second.Indexes[i];
+      }
+    }
+  this->Entries.clear();
+}
+
+//---------------------------------------------------------------------------
+CellIntervalIndexCache& GetCellIntervalIndexCache()
+{
+  static CellIntervalIndexCache cache;
+  return cache;
+}
+
+//---------------------------------------------------------------------------
+/// Output points created on the edges of the input, merged by edge
+class EdgePointMerger
+{
+public:
+  EdgePointMerger(vtkPolyData* input, vtkPoints* points,
+                  vtkPointData* inPD, vtkPointData* outPD)
+    : Input(input), Points(points), InPD(inPD), OutPD(outPD) {}
+
+  /// Point where the plane crosses the edge (a, b) given the signed
+  /// distances of a and b to the plane.
+  vtkIdType GetEdgePoint(vtkIdType a, double da, vtkIdType b, double db)
+    {
+    // A point on the plane is shared by all the edges it belongs to
+    if (da == 0.)
+      {
+      b = a;
+      }
+    else if (db == 0.)
+      {
+      a = b;
+      da = db;
+      }
+    // Interpolate from the smallest id so that both cells sharing the
+    // edge create the same point.
+    if (b < a)
+      {
+      std::swap(a, b);
+      std::swap(da, db);
+      }
+    std::pair<vtkIdType, vtkIdType> edge(a, b);
+    std::map<std::pair<vtkIdType, vtkIdType>, vtkIdType>::iterator it =
+      this->EdgePoints.find(edge);
+    if (it != this->EdgePoints.end())
+      {
+      return it->second;
+      }
+    const double t = (a == b || da == db) ? 0. : da / (da - db);
+    double xa[3];
+    double xb[3];
+    double x[3];
+    this->Input->GetPoint(a, xa);
+    this->Input->GetPoint(b, xb);
+    for (int i = 0; i < 3; ++i)
+      {
+      x[i] = xa[i] + t * (xb[i] - xa[i]);
+      }
+    const vtkIdType id = this->Points->InsertNextPoint(x);
+    this->OutPD->InterpolateEdge(this->InPD, id, a, b, t);
+    this->EdgePoints.insert(std::make_pair(edge, id));
+    return id;
+    }
+
+protected:
+  vtkPolyData* Input;
+  vtkPoints* Points;
+  vtkPointData* InPD;
+  vtkPointData* OutPD;
+  std::map<std::pair<vtkIdType, vtkIdType>, vtkIdType> EdgePoints;
+};
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+vtkSliceIntersectionCutter::vtkSliceIntersectionCutter()
+{
+  this->Plane = 0;
+  this->NumberOfTestedCells = 0;
+}
+
+//---------------------------------------------------------------------------
+vtkSliceIntersectionCutter::~vtkSliceIntersectionCutter()
+{
+  this->SetPlane(0);
+}
+
+//---------------------------------------------------------------------------
+void vtkSliceIntersectionCutter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Plane: " << this->Plane << "\n";
+  os << indent << "NumberOfTestedCells: " << this->NumberOfTestedCells << "\n";
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkSliceIntersectionCutter::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+  if (this->Plane)
+    {
+    mTime = std::max(mTime, this->Plane->GetMTime());
+    }
+  return mTime;
+}
+
+//---------------------------------------------------------------------------
+int vtkSliceIntersectionCutter::GetNumberOfCachedIndexes()
+{
+  return GetCellIntervalIndexCache().GetNumberOfIndexes();
+}
+
+//---------------------------------------------------------------------------
+void vtkSliceIntersectionCutter::ClearCache()
+{
+  GetCellIntervalIndexCache().Clear();
+}
+
+//---------------------------------------------------------------------------
+int vtkSliceIntersectionCutter::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkPolyData *input = vtkPolyData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkPolyData *output = vtkPolyData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  this->NumberOfTestedCells = 0;
+  if (!input || !output || !this->Plane ||
+      input->GetNumberOfPoints() == 0 || input->GetNumberOfCells() == 0)
+    {
+    return 1;
+    }
+
+  double normal[3];
+  this->Plane->GetNormal(normal);
+  if (vtkMath::Normalize(normal) == 0.)
+    {
+    vtkErrorMacro("Invalid plane normal");
+    return 1;
+    }
+  const double planeValue = vtkMath::Dot(normal, this->Plane->GetOrigin());
+
+  // Skip the models whose bounds don't intersect the plane
+  double bounds[6];
+  input->GetBounds(bounds);
+  double boundsMin = VTK_DOUBLE_MAX;
+  double boundsMax = VTK_DOUBLE_MIN;
+  for (int corner = 0; corner < 8; ++corner)
+    {
+    double x[3] = {bounds[corner & 1], bounds[2 + ((corner >> 1) & 1)],
+                   bounds[4 + ((corner >> 2) & 1)]};
+    const double value = vtkMath::Dot(normal, x);
+    boundsMin = std::min(boundsMin, value);
+    boundsMax = std::max(boundsMax, value);
+    }
+  if (planeValue < boundsMin || planeValue > boundsMax)
+    {
+    return 1;
+    }
+
+  double sign = 1.;
+  CellIntervalIndex* index =
+    GetCellIntervalIndexCache().GetIndex(input, normal, sign);
+  // Signed distances are computed along the plane normal, as vtkCutter
+  const double indexValue = sign * planeValue;
+
+  std::vector<vtkIdType> cells;
+  this->NumberOfTestedCells = index->FindCells(indexValue, cells);
+  if (cells.empty())
+    {
+    return 1;
+    }
+
+  vtkPointData* inPD = input->GetPointData();
+  vtkCellData* inCD = input->GetCellData();
+  vtkPointData* outPD = output->GetPointData();
+  vtkCellData* outCD = output->GetCellData();
+
+  const vtkIdType estimatedSize = 2 * static_cast<vtkIdType>(cells.size());
+  vtkNew<vtkPoints> newPoints;
+  newPoints->SetDataType(input->GetPoints()->GetDataType());
+  newPoints->Allocate(estimatedSize);
+  vtkNew<vtkCellArray> newLines;
+  newLines->Allocate(newLines->EstimateSize(estimatedSize, 2));
+  vtkNew<vtkCellArray> newVerts;
+  std::vector<vtkIdType> lineCells;
+  std::vector<vtkIdType> vertCells;
+  outPD->InterpolateAllocate(inPD, estimatedSize, estimatedSize);
+
+  EdgePointMerger merger(input, newPoints.GetPointer(), inPD, outPD);
+  const std::vector<double>& projections = index->PointProjections;
+
+  for (size_t i = 0; i < cells.size(); ++i)
+    {
+    const vtkIdType cellId = cells[i];
+    const int cellType = input->GetCellType(cellId);
+    vtkIdType npts = 0;
+    vtkIdType* pts = 0;
+    input->GetCellPoints(cellId, npts, pts);
+
+    if (cellType == VTK_LINE || cellType == VTK_POLY_LINE)
+      {
+      for (vtkIdType j = 0; j + 1 < npts; ++j)
+        {
+        const double d0 = sign * (projections[pts[j]] - indexValue);
+        const double d1 = sign * (projections[pts[j + 1]] - indexValue);
+        if ((d0 >= 0.) != (d1 >= 0.))
+          {
+          vtkIdType id = merger.GetEdgePoint(pts[j], d0, pts[j + 1], d1);
+          newVerts->InsertNextCell(1, &id);
+          vertCells.push_back(cellId);
+          }
+        }
+      continue;
+      }
+    if (cellType != VTK_TRIANGLE && cellType != VTK_QUAD &&
+        cellType != VTK_POLYGON && cellType != VTK_TRIANGLE_STRIP)
+      {
+      continue;
+      }
+
+    // Contour each triangle of the cell (fan or strip)
+    const vtkIdType numberOfTriangles = npts - 2;
+    for (vtkIdType t = 0; t < numberOfTriangles; ++t)
+      {
+      vtkIdType tri[3];
+      if (cellType == VTK_TRIANGLE_STRIP)
+        {
+        tri[0] = pts[t];
+        tri[1] = pts[t + 1];
+        tri[2] = pts[t + 2];
+        }
+      else
+        {
+        tri[0] = pts[0];
+        tri[1] = pts[t + 1];
+        tri[2] = pts[t + 2];
+        }
+      double d[3];
+      int above = 0;
+      for (int k = 0; k < 3; ++k)
+        {
+        d[k] = sign * (projections[tri[k]] - indexValue);
+        above += (d[k] >= 0.) ? 1 : 0;
+        }
+      if (above == 0 || above == 3)
+        {
+        continue;
+        }
+      vtkIdType line[2];
+      int n = 0;
+      for (int k = 0; k < 3 && n < 2; ++k)
+        {
+        const int l = (k + 1) % 3;
+        if ((d[k] >= 0.) != (d[l] >= 0.))
+          {
+          line[n++] = merger.GetEdgePoint(tri[k], d[k], tri[l], d[l]);
+          }
+        }
+      if (n == 2 && line[0] != line[1])
+        {
+        newLines->InsertNextCell(2, line);
+        lineCells.push_back(cellId);
+        }
+      }
+    }
+
+  // Cell data: vertices are numbered before lines in a vtkPolyData
+  outCD->CopyAllocate(inCD, static_cast<vtkIdType>(vertCells.size() + lineCells.size()));
+  vtkIdType outCellId = 0;
+  for (size_t i = 0; i < vertCells.size(); ++i)
+    {
+    outCD->CopyData(inCD, vertCells[i], outCellId++);
+    }
+  for (size_t i = 0; i < lineCells.size(); ++i)
+    {
+    outCD->CopyData(inCD, lineCells[i], outCellId++);
+    }
+
+  output->SetPoints(newPoints.GetPointer());
+  if (newVerts->GetNumberOfCells() > 0)
+    {
+    output->SetVerts(newVerts.GetPointer());
+    }
+  output->SetLines(newLines.GetPointer());
+  output->Squeeze();
+  return 1;
+}
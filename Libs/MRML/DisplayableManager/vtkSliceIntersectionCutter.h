@@ -0,0 +1,81 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSliceIntersectionCutter_h
+#define __vtkSliceIntersectionCutter_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerWin32Header.h"
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+class vtkPlane;
+
+/// \brief Cut a polydata with a plane, visiting only the intersected cells.
+///
+/// Produces the same lines as vtkCutter with a vtkPlane cut function
+/// (GenerateCutScalars off) for polygons and triangle strips, and vertices
+/// for lines, with interpolated point data and copied cell data.
+///
+/// The cells of the input are indexed by their extent along the normal of
+/// the plane: the extents are binned along the normal, each bin listing the
+/// cells overlapping it. A cut only tests the cells of the bin containing
+/// the plane, and an input whose bounds miss the plane is not visited at
+/// all. The indexes are cached per polydata and per normal and shared by
+/// all the cutters, so the slice views cutting the same model with
+/// parallel planes (e.g. scrolling) reuse the same index. An index is
+/// rebuilt when its polydata is modified.
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkSliceIntersectionCutter
+  : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkSliceIntersectionCutter* New();
+  vtkTypeRevisionMacro(vtkSliceIntersectionCutter, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Cutting plane, in the coordinate system of the input
+  virtual void SetPlane(vtkPlane* plane);
+  vtkGetObjectMacro(Plane, vtkPlane);
+
+  /// Take the plane into account
+  virtual unsigned long GetMTime();
+
+  /// Number of cells tested by the last cut
+  vtkGetMacro(NumberOfTestedCells, vtkIdType);
+
+  /// Number of indexes in the cache shared by all the cutters
+  static int GetNumberOfCachedIndexes();
+
+  /// Release the indexes of all the polydata
+  static void ClearCache();
+
+protected:
+  vtkSliceIntersectionCutter();
+  virtual ~vtkSliceIntersectionCutter();
+
+  virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
+
+  vtkPlane* Plane;
+  vtkIdType NumberOfTestedCells;
+
+private:
+  vtkSliceIntersectionCutter(const vtkSliceIntersectionCutter&);  // Not implemented
+  void operator=(const vtkSliceIntersectionCutter&);  // Not implemented
+};
+
+#endif
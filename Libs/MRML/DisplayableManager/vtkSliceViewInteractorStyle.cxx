@@ -54,6 +54,10 @@ vtkSliceViewInteractorStyle::vtkSliceViewInteractorStyle()
   this->ActionStartLabelOpacity = 0;
 
   this->SliceLogic = 0;
+
+  this->StepInteractionDelay = 200;
+  this->StepInteractionParameters = 0;
+  this->StepInteractionTimerId = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -63,6 +67,7 @@ vtkSliceViewInteractorStyle::~vtkSliceViewInteractorStyle()
   this->ActionStartXYToRAS->Delete();
   this->ScratchMatrix ->Delete();
 
+  this->EndStepInteraction();
   this->SetSliceLogic(0);
 }
 
@@ -71,6 +76,8 @@ void vtkSliceViewInteractorStyle::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "StepInteractionDelay: " << this->StepInteractionDelay << "\n";
+
   os << indent << "\nSlice Logic:\n";
   if (this->SliceLogic)
     {
@@ -132,10 +139,10 @@ void vtkSliceViewInteractorStyle::OnChar()
     }
   else if ( !strcmp(key, "r") )
     {
-    this->SliceLogic->StartSliceNodeInteraction(vtkMRMLSliceNode::ResetFieldOfViewFlag);
+    this->StartStepInteraction(vtkMRMLSliceNode::ResetFieldOfViewFlag);
     this->SliceLogic->FitSliceToAll();
     sliceNode->UpdateMatrices();
-    this->SliceLogic->EndSliceNodeInteraction();
+    this->EndStepInteractionWhenIdle();
     }
   else if ( !strcmp(key, "g") )
     {
@@ -209,6 +216,7 @@ void vtkSliceViewInteractorStyle::OnRightButtonDown()
 {
   this->SliceLogic->GetMRMLScene()->SaveStateForUndo(this->SliceLogic->GetSliceNode());
   this->SetActionState(vtkSliceViewInteractorStyle::Zoom);
+  this->EndStepInteraction();
   this->SliceLogic->StartSliceNodeInteraction(vtkMRMLSliceNode::FieldOfViewFlag);
   vtkMRMLSliceNode *sliceNode = this->SliceLogic->GetSliceNode();
   this->SetActionStartFOV(sliceNode->GetFieldOfView());
@@ -384,6 +392,20 @@ void vtkSliceViewInteractorStyle::OnMouseWheelBackward()
   this->Superclass::OnMouseWheelBackward();
 }
 
+//----------------------------------------------------------------------------
+void vtkSliceViewInteractorStyle::OnTimer()
+{
+  if (this->StepInteractionTimerId &&
+      this->Interactor->GetTimerEventId() == this->StepInteractionTimerId)
+    {
+    // One shot timers are destroyed once fired
+    this->StepInteractionTimerId = 0;
+    this->EndStepInteraction();
+    return;
+    }
+  this->Superclass::OnTimer();
+}
+
 //----------------------------------------------------------------------------
 void vtkSliceViewInteractorStyle::OnExpose()
 {
@@ -445,8 +467,61 @@ void vtkSliceViewInteractorStyle::MoveSlice(double delta)
   this->SliceLogic->GetSliceBounds(sliceBounds);
   if (newOffset >= sliceBounds[4] && newOffset <= sliceBounds[5])
     {
-    this->SliceLogic->StartSliceNodeInteraction(vtkMRMLSliceNode::SliceToRASFlag);
+    this->StartStepInteraction(vtkMRMLSliceNode::SliceToRASFlag);
     this->SliceLogic->SetSliceOffset(newOffset);
+    this->EndStepInteractionWhenIdle();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSliceViewInteractorStyle::StartStepInteraction(unsigned int parameters)
+{
+  if (this->StepInteractionParameters == parameters)
+    {
+    // Same interaction, the step continues it
+    return;
+    }
+  this->EndStepInteraction();
+  this->SliceLogic->StartSliceNodeInteraction(parameters);
+  this->StepInteractionParameters = parameters;
+}
+
+//----------------------------------------------------------------------------
+void vtkSliceViewInteractorStyle::EndStepInteractionWhenIdle()
+{
+  if (!this->StepInteractionParameters)
+    {
+    return;
+    }
+  // Restart the timer at each step
+  if (this->StepInteractionTimerId && this->Interactor)
+    {
+    this->Interactor->DestroyTimer(this->StepInteractionTimerId);
+    }
+  this->StepInteractionTimerId = this->Interactor ?
+    this->Interactor->CreateOneShotTimer(this->StepInteractionDelay) : 0;
+  if (!this->StepInteractionTimerId)
+    {
+    // No timer, each step is an interaction
+    this->EndStepInteraction();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSliceViewInteractorStyle::EndStepInteraction()
+{
+  if (this->StepInteractionTimerId && this->Interactor)
+    {
+    this->Interactor->DestroyTimer(this->StepInteractionTimerId);
+    }
+  this->StepInteractionTimerId = 0;
+  if (!this->StepInteractionParameters)
+    {
+    return;
+    }
+  this->StepInteractionParameters = 0;
+  if (this->SliceLogic)
+    {
     this->SliceLogic->EndSliceNodeInteraction();
     }
 }
@@ -456,6 +531,7 @@ void vtkSliceViewInteractorStyle::StartTranslate()
 {
   vtkMRMLSliceNode *sliceNode = this->SliceLogic->GetSliceNode();
   this->SliceLogic->GetMRMLScene()->SaveStateForUndo(sliceNode);
+  this->EndStepInteraction();
   this->SliceLogic->StartSliceNodeInteraction(vtkMRMLSliceNode::XYZOriginFlag);
 
   this->SetActionState(this->Translate);
@@ -69,6 +69,8 @@ public:
   virtual void OnConfigure();
   virtual void OnEnter();
   virtual void OnLeave();
+  /// Ends the slice step interaction when its timer fires
+  virtual void OnTimer();
 
   /// Internal state management for multi-event sequences (like click-drag-release)
 
@@ -142,6 +144,20 @@ public:
   void DecrementSlice();
   void MoveSlice(double delta);
 
+  /// Successive steps of the slice (mouse wheel, arrow keys...) are a single
+  /// slice node interaction, that ends when no step happened for
+  /// StepInteractionDelay milliseconds. The slice layers can then display
+  /// the downsampled volumes during the whole scrolling.
+  /// StartStepInteraction() is called before and EndStepInteractionWhenIdle()
+  /// after changing the slice node. 200ms by default.
+  /// \sa vtkMRMLSliceLogic::StartSliceNodeInteraction()
+  vtkSetMacro(StepInteractionDelay, unsigned long);
+  vtkGetMacro(StepInteractionDelay, unsigned long);
+  void StartStepInteraction(unsigned int parameters);
+  void EndStepInteractionWhenIdle();
+  /// End the step interaction now if any.
+  void EndStepInteraction();
+
   /// Collect some boilerplate management steps so they can be used
   /// in more than one place
   void StartTranslate();
@@ -211,6 +227,11 @@ protected:
 
   vtkMRMLSliceLogic *SliceLogic;
 
+  unsigned long StepInteractionDelay;
+  /// Parameters of the step interaction, 0 if there is none
+  unsigned int StepInteractionParameters;
+  int StepInteractionTimerId;
+
 private:
   vtkSliceViewInteractorStyle(const vtkSliceViewInteractorStyle&);  /// Not implemented.
   void operator=(const vtkSliceViewInteractorStyle&);  /// Not implemented.
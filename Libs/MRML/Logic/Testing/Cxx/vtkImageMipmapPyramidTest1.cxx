@@ -0,0 +1,138 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageMipmapPyramid.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkShortArray.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Wait for the background thread to build all the levels
+int WaitForLevels(vtkImageMipmapPyramid* pyramid, int expectedNumberOfLevels)
+{
+  for (int i = 0; i < 500 && pyramid->GetNumberOfLevels() < expectedNumberOfLevels; ++i)
+    {
+    vtksys::SystemTools::Delay(10);
+    }
+  return pyramid->GetNumberOfLevels();
+}
+
+//----------------------------------------------------------------------------
+short Voxel(vtkImageData* image, int i, int j, int k)
+{
+  return *static_cast<short*>(image->GetScalarPointer(i, j, k));
+}
+
+//----------------------------------------------------------------------------
+// Rounded average of the 2x2x2 voxels starting at (i, j, k)
+short Average(vtkImageData* image, int i, int j, int k)
+{
+  double sum = 0.;
+  for (int n = 0; n < 8; ++n)
+    {
+    sum += Voxel(image, i + (n & 1), j + ((n >> 1) & 1), k + ((n >> 2) & 1));
+    }
+  return static_cast<short>(floor(sum / 8. + 0.5));
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageMipmapPyramidTest1(int , char * [] )
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(130, 100, 3);
+  image->SetSpacing(1., 1., 1.);
+  image->SetOrigin(0., 0., 0.);
+  vtkNew<vtkShortArray> scalars;
+  scalars->SetNumberOfTuples(130 * 100 * 3);
+  for (vtkIdType i = 0; i < scalars->GetNumberOfTuples(); ++i)
+    {
+    scalars->SetValue(i, static_cast<short>(i % 1000));
+    }
+  image->GetPointData()->SetScalars(scalars.GetPointer());
+  image->SetScalarTypeToShort();
+
+  vtkImageMipmapPyramid* pyramid = vtkImageMipmapPyramid::GetImagePyramid(image.GetPointer());
+  if (!pyramid ||
+      pyramid != vtkImageMipmapPyramid::GetImagePyramid(image.GetPointer()) ||
+      pyramid->GetInput() != image.GetPointer())
+    {
+    std::cerr << "Line " << __LINE__ << ": the pyramid is not kept with the image" << std::endl;
+    return EXIT_FAILURE;
+    }
+  pyramid->SetMinimumDimension(16);
+
+  // 130x100x3, 65x50x2, 33x25x1, 17x13x1, 9x7x1
+  if (WaitForLevels(pyramid, 5) != 5)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << pyramid->GetNumberOfLevels()
+              << " levels instead of 5" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkImageData* level1 = pyramid->GetLevel(1);
+  int* dimensions = level1->GetDimensions();
+  if (pyramid->GetLevel(0) != image.GetPointer() ||
+      dimensions[0] != 65 || dimensions[1] != 50 || dimensions[2] != 2 ||
+      level1->GetSpacing()[0] != 2. || level1->GetOrigin()[0] != 0.5 ||
+      pyramid->GetLevel(4)->GetDimensions()[0] != 9 || pyramid->GetLevel(5) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong level geometry" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (Voxel(level1, 1, 1, 0) != Average(image.GetPointer(), 2, 2, 0))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong average " << Voxel(level1, 1, 1, 0)
+              << " instead of " << Average(image.GetPointer(), 2, 2, 0) << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Level matching the pixel size
+  if (pyramid->GetLevelForVoxelSize(1.5) != 0 ||
+      pyramid->GetLevelForVoxelSize(2.) != level1 ||
+      pyramid->GetLevelForVoxelSize(5.) != pyramid->GetLevel(2) ||
+      pyramid->GetLevelForVoxelSize(1000.) != pyramid->GetLevel(4))
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong level for the voxel size" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The levels are rebuilt when the image is modified
+  scalars->SetValue(0, 999);
+  image->Modified();
+  if (WaitForLevels(pyramid, 5) != 5 ||
+      Voxel(pyramid->GetLevel(1), 0, 0, 0) != Average(image.GetPointer(), 0, 0, 0))
+    {
+    std::cerr << "Line " << __LINE__ << ": outdated level" << std::endl;
+    return EXIT_FAILURE;
+    }
+  pyramid->AverageOff();
+  if (WaitForLevels(pyramid, 5) != 5 ||
+      Voxel(pyramid->GetLevel(1), 0, 0, 0) != 999 ||
+      Voxel(pyramid->GetLevel(1), 1, 1, 0) != Voxel(image.GetPointer(), 2, 2, 0) ||
+      pyramid->GetLevel(1)->GetOrigin()[0] != 0.)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong subsampling" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,602 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkMRMLSliceLayerLogic.h"
+#include "vtkMRMLSliceLogic.h"
+
+// MRML includes
+#include <vtkMRMLColorTableNode.h>
+#include <vtkMRMLLabelMapVolumeDisplayNode.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceCompositeNode.h>
+#include <vtkMRMLStorageNode.h>
+#include <vtkMRMLVectorVolumeDisplayNode.h>
+#include <vtkMRMLVectorVolumeNode.h>
+
+// VTK includes
+#include <vtkCutter.h>
+#include <vtkImageAccumulate.h>
+#include <vtkImageData.h>
+#include <vtkImageThreshold.h>
+#include <vtkImageToImageStencil.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#if ITK_VERSION_MAJOR > 3
+#  include <itkFactoryRegistration.h>
+#endif
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+// Time the core pipelines on synthetic data, without rendering or network
+// access. The timings are printed and written in JSON so that they can be
+// compared between builds:
+//   vtkMRMLLogicBenchmarkTest <temporary directory> [<output.json>]
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct BenchmarkResult
+{
+  BenchmarkResult(const std::string& name, const std::string& description)
+    : Name(name), Description(description), Total(0.), Min(0.), Max(0.) {}
+
+  void Add(double time)
+  {
+    this->Min = this->Times.empty() ? time : std::min(this->Min, time);
+    this->Max = this->Times.empty() ? time : std::max(this->Max, time);
+    this->Total += time;
+    this->Times.push_back(time);
+  }
+
+  double GetMean()const
+  {
+    return this->Times.empty() ? 0. : this->Total / this->Times.size();
+  }
+
+  std::string Name;
+  std::string Description;
+  std::vector<double> Times;
+  double Total;
+  double Min;
+  double Max;
+};
+
+//----------------------------------------------------------------------------
+class Benchmarks
+{
+public:
+  BenchmarkResult& Add(const std::string& name, const std::string& description)
+  {
+    this->Results.push_back(BenchmarkResult(name, description));
+    return this->Results.back();
+  }
+
+  void Print(std::ostream& os)const
+  {
+    for (std::list<BenchmarkResult>::const_iterator it = this->Results.begin();
+         it != this->Results.end(); ++it)
+      {
+      os << it->Name << ": mean " << it->GetMean() << "s, min " << it->Min
+         << "s, max " << it->Max << "s (" << it->Times.size() << " runs)"
+         << std::endl;
+      }
+  }
+
+  void WriteJSON(std::ostream& os)const
+  {
+    os << "{\n  \"benchmarks\": [";
+    for (std::list<BenchmarkResult>::const_iterator it = this->Results.begin();
+         it != this->Results.end(); ++it)
+      {
+      os << (it == this->Results.begin() ? "\n" : ",\n")
+         << "    {\n"
+         << "      \"name\": \"" << it->Name << "\",\n"
+         << "      \"description\": \"" << it->Description << "\",\n"
+         << "      \"unit\": \"s\",\n"
+         << "      \"iterations\": " << it->Times.size() << ",\n"
+         << "      \"mean\": " << it->GetMean() << ",\n"
+         << "      \"min\": " << it->Min << ",\n"
+         << "      \"max\": " << it->Max << ",\n"
+         << "      \"times\": [";
+      for (size_t i = 0; i < it->Times.size(); ++i)
+        {
+        os << (i ? ", " : "") << it->Times[i];
+        }
+      os << "]\n    }";
+      }
+    os << "\n  ]\n}\n";
+  }
+
+protected:
+  // The results stay at the same address while others are added
+  std::list<BenchmarkResult> Results;
+};
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> CreateImage(int size, int scalarType, int components)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  image->SetSpacing(1., 1., 1.);
+  image->SetOrigin(-size / 2., -size / 2., -size / 2.);
+  image->SetScalarType(scalarType);
+  image->SetNumberOfScalarComponents(components);
+  image->AllocateScalars();
+  return image;
+}
+
+//----------------------------------------------------------------------------
+// Smooth intensities with some noise
+vtkSmartPointer<vtkImageData> CreateGrayscaleImage(int size)
+{
+  vtkSmartPointer<vtkImageData> image = CreateImage(size, VTK_SHORT, 1);
+  short* voxel = static_cast<short*>(image->GetScalarPointer());
+  for (int k = 0; k < size; ++k)
+    {
+    for (int j = 0; j < size; ++j)
+      {
+      for (int i = 0; i < size; ++i)
+        {
+        *(voxel++) = static_cast<short>(i * 4 + j * 2 + k + (i * 7919 + j * 104729 + k) % 37);
+        }
+      }
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+// Concentric shells of labels 0 to numberOfLabels - 1
+vtkSmartPointer<vtkImageData> CreateLabelImage(int size, int numberOfLabels)
+{
+  vtkSmartPointer<vtkImageData> image = CreateImage(size, VTK_SHORT, 1);
+  short* voxel = static_cast<short*>(image->GetScalarPointer());
+  const int center = size / 2;
+  for (int k = 0; k < size; ++k)
+    {
+    for (int j = 0; j < size; ++j)
+      {
+      for (int i = 0; i < size; ++i)
+        {
+        int distance = std::max(abs(i - center), std::max(abs(j - center), abs(k - center)));
+        *(voxel++) = static_cast<short>(
+          std::max(0, numberOfLabels - 1 - distance * numberOfLabels / (center + 1)));
+        }
+      }
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> CreateColorImage(int size)
+{
+  vtkSmartPointer<vtkImageData> image = CreateImage(size, VTK_UNSIGNED_CHAR, 3);
+  unsigned char* voxel = static_cast<unsigned char*>(image->GetScalarPointer());
+  for (int k = 0; k < size; ++k)
+    {
+    for (int j = 0; j < size; ++j)
+      {
+      for (int i = 0; i < size; ++i)
+        {
+        *(voxel++) = static_cast<unsigned char>(i);
+        *(voxel++) = static_cast<unsigned char>(j);
+        *(voxel++) = static_cast<unsigned char>(k);
+        }
+      }
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLColorTableNode* AddColorNode(vtkMRMLScene* scene, bool labels)
+{
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  if (labels)
+    {
+    colorNode->SetTypeToLabels();
+    }
+  else
+    {
+    colorNode->SetTypeToGrey();
+    }
+  scene->AddNode(colorNode.GetPointer());
+  return colorNode.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeNode* AddVolume(vtkMRMLScene* scene, vtkMRMLVolumeNode* volumeNode,
+                             vtkMRMLVolumeDisplayNode* displayNode,
+                             vtkImageData* image, const char* name)
+{
+  displayNode->SetAndObserveColorNodeID(
+    AddColorNode(scene, displayNode->IsA("vtkMRMLLabelMapVolumeDisplayNode"))->GetID());
+  scene->AddNode(displayNode);
+  volumeNode->SetName(name);
+  volumeNode->SetAndObserveImageData(image);
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  scene->AddNode(volumeNode);
+  return volumeNode;
+}
+
+//----------------------------------------------------------------------------
+// Models with display nodes, under a few transforms
+void PopulateScene(vtkMRMLScene* scene, int numberOfModels)
+{
+  vtkMRMLLinearTransformNode* transformNode = 0;
+  for (int i = 0; i < numberOfModels; ++i)
+    {
+    if (i % 10 == 0)
+      {
+      vtkNew<vtkMRMLLinearTransformNode> newTransformNode;
+      scene->AddNode(newTransformNode.GetPointer());
+      transformNode = newTransformNode.GetPointer();
+      }
+    vtkNew<vtkMRMLModelDisplayNode> displayNode;
+    scene->AddNode(displayNode.GetPointer());
+    vtkNew<vtkMRMLModelNode> modelNode;
+    modelNode->SetAttribute("Benchmark", "1");
+    scene->AddNode(modelNode.GetPointer());
+    modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+    modelNode->SetAndObserveTransformNodeID(transformNode->GetID());
+    }
+}
+
+//----------------------------------------------------------------------------
+bool BenchmarkScene(Benchmarks& benchmarks, const std::string& temporaryDirectory)
+{
+  const int numberOfModels = 2000;
+  const int iterations = 5;
+  vtkNew<vtkMRMLScene> scene;
+  PopulateScene(scene.GetPointer(), numberOfModels);
+  vtkNew<vtkTimerLog> timer;
+
+  BenchmarkResult& exportString = benchmarks.Add("SceneExportToString",
+    "Commit a scene of 2000 models to an XML string");
+  scene->SetSaveToXMLString(1);
+  for (int i = 0; i < iterations; ++i)
+    {
+    timer->StartTimer();
+    scene->Commit();
+    timer->StopTimer();
+    exportString.Add(timer->GetElapsedTime());
+    }
+  const std::string xmlScene = scene->GetSceneXMLString();
+
+  BenchmarkResult& exportFile = benchmarks.Add("SceneExportToFile",
+    "Commit a scene of 2000 models to a file");
+  const std::string fileName = temporaryDirectory + "/vtkMRMLLogicBenchmarkTest.mrml";
+  scene->SetSaveToXMLString(0);
+  for (int i = 0; i < iterations; ++i)
+    {
+    timer->StartTimer();
+    scene->Commit(fileName.c_str());
+    timer->StopTimer();
+    exportFile.Add(timer->GetElapsedTime());
+    }
+
+  BenchmarkResult& import = benchmarks.Add("SceneImport",
+    "Import a scene of 2000 models from an XML string");
+  for (int i = 0; i < iterations; ++i)
+    {
+    vtkNew<vtkMRMLScene> importedScene;
+    importedScene->SetLoadFromXMLString(1);
+    importedScene->SetSceneXMLString(xmlScene);
+    timer->StartTimer();
+    importedScene->Import();
+    timer->StopTimer();
+    import.Add(timer->GetElapsedTime());
+    if (importedScene->GetNumberOfNodesByClass("vtkMRMLModelNode") != numberOfModels)
+      {
+      std::cerr << "Line " << __LINE__ << ": "
+                << importedScene->GetNumberOfNodesByClass("vtkMRMLModelNode")
+                << " models imported instead of " << numberOfModels << std::endl;
+      return false;
+      }
+    }
+
+  BenchmarkResult& undo = benchmarks.Add("UndoSnapshot",
+    "Save the state of a scene of 2000 models for undo");
+  BenchmarkResult& undoRestore = benchmarks.Add("UndoRestore",
+    "Undo the modification of a scene of 2000 models");
+  scene->SetUndoOn();
+  for (int i = 0; i < iterations; ++i)
+    {
+    // Undo can replace the nodes
+    vtkMRMLNode* node = scene->GetNthNodeByClass(0, "vtkMRMLModelNode");
+    timer->StartTimer();
+    scene->SaveStateForUndo();
+    timer->StopTimer();
+    undo.Add(timer->GetElapsedTime());
+    node->SetName("Modified");
+    timer->StartTimer();
+    scene->Undo();
+    timer->StopTimer();
+    undoRestore.Add(timer->GetElapsedTime());
+    }
+  scene->ClearUndoStack();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool BenchmarkSlice(Benchmarks& benchmarks)
+{
+  const int size = 192;
+  const int iterations = 20;
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLScalarVolumeNode> scalarNode;
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> scalarDisplayNode;
+  AddVolume(scene.GetPointer(), scalarNode.GetPointer(), scalarDisplayNode.GetPointer(),
+            CreateGrayscaleImage(size), "Grayscale");
+  vtkNew<vtkMRMLVectorVolumeNode> vectorNode;
+  vtkNew<vtkMRMLVectorVolumeDisplayNode> vectorDisplayNode;
+  AddVolume(scene.GetPointer(), vectorNode.GetPointer(), vectorDisplayNode.GetPointer(),
+            CreateColorImage(size), "Color");
+  vtkNew<vtkMRMLScalarVolumeNode> labelNode;
+  labelNode->SetLabelMap(1);
+  vtkNew<vtkMRMLLabelMapVolumeDisplayNode> labelDisplayNode;
+  AddVolume(scene.GetPointer(), labelNode.GetPointer(), labelDisplayNode.GetPointer(),
+            CreateLabelImage(size, 8), "Label");
+
+  vtkNew<vtkMRMLSliceLogic> sliceLogic;
+  sliceLogic->SetName("Red");
+  sliceLogic->SetMRMLScene(scene.GetPointer());
+  vtkNew<vtkMRMLSliceLayerLogic> backgroundLayer;
+  vtkNew<vtkMRMLSliceLayerLogic> foregroundLayer;
+  vtkNew<vtkMRMLSliceLayerLogic> labelLayer;
+  labelLayer->IsLabelLayerOn();
+  sliceLogic->SetBackgroundLayer(backgroundLayer.GetPointer());
+  sliceLogic->SetForegroundLayer(foregroundLayer.GetPointer());
+  sliceLogic->SetLabelLayer(labelLayer.GetPointer());
+  sliceLogic->ResizeSliceNode(512, 512);
+
+  vtkMRMLSliceCompositeNode* compositeNode = sliceLogic->GetSliceCompositeNode();
+  compositeNode->SetBackgroundVolumeID(scalarNode->GetID());
+  compositeNode->SetForegroundVolumeID(vectorNode->GetID());
+  compositeNode->SetForegroundOpacity(0.5);
+  compositeNode->SetLabelVolumeID(labelNode->GetID());
+  sliceLogic->FitSliceToAll();
+
+  const char* layerNames[3] = {"ResliceScalarVolume", "ResliceVectorVolume", "ResliceLabelMap"};
+  const char* layerDescriptions[3] = {
+    "Reslice a 192^3 short volume in the background layer of a 512x512 slice",
+    "Reslice a 192^3 RGB volume in the foreground layer of a 512x512 slice",
+    "Reslice and outline a 192^3 label map in the label layer of a 512x512 slice"};
+  vtkMRMLSliceLayerLogic* layers[3] = {
+    backgroundLayer.GetPointer(), foregroundLayer.GetPointer(), labelLayer.GetPointer()};
+  BenchmarkResult* layerResults[3];
+  for (int layer = 0; layer < 3; ++layer)
+    {
+    layerResults[layer] = &benchmarks.Add(layerNames[layer], layerDescriptions[layer]);
+    }
+  BenchmarkResult& blend = benchmarks.Add("BlendLayers",
+    "Blend the 3 layers of a 512x512 slice");
+
+  vtkNew<vtkTimerLog> timer;
+  for (int i = 0; i < iterations; ++i)
+    {
+    sliceLogic->SetSliceOffset(-size / 2. + (i + 0.5) * size / iterations);
+    for (int layer = 0; layer < 3; ++layer)
+      {
+      vtkImageData* layerImage = layers[layer]->GetImageData();
+      if (!layerImage)
+        {
+        std::cerr << "Line " << __LINE__ << ": no image in layer " << layer << std::endl;
+        return false;
+        }
+      timer->StartTimer();
+      layerImage->Update();
+      timer->StopTimer();
+      layerResults[layer]->Add(timer->GetElapsedTime());
+      }
+    vtkImageData* sliceImage = sliceLogic->GetImageData();
+    if (!sliceImage)
+      {
+      std::cerr << "Line " << __LINE__ << ": no slice image" << std::endl;
+      return false;
+      }
+    timer->StartTimer();
+    sliceImage->Update();
+    timer->StopTimer();
+    blend.Add(timer->GetElapsedTime());
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool BenchmarkModelCutting(Benchmarks& benchmarks)
+{
+  const int iterations = 20;
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(100.);
+  sphere->SetThetaResolution(1000);
+  sphere->SetPhiResolution(1000);
+  sphere->Update();
+
+  vtkNew<vtkPlane> plane;
+  plane->SetNormal(0., 0., 1.);
+  vtkNew<vtkCutter> cutter;
+  cutter->SetInputConnection(sphere->GetOutputPort());
+  cutter->SetCutFunction(plane.GetPointer());
+
+  BenchmarkResult& cutting = benchmarks.Add("ModelCutting",
+    "Cut a model of 2 million triangles with a slice plane");
+  vtkNew<vtkTimerLog> timer;
+  for (int i = 0; i < iterations; ++i)
+    {
+    plane->SetOrigin(0., 0., -95. + i * 190. / iterations);
+    timer->StartTimer();
+    cutter->Update();
+    timer->StopTimer();
+    cutting.Add(timer->GetElapsedTime());
+    if (cutter->GetOutput()->GetNumberOfCells() == 0)
+      {
+      std::cerr << "Line " << __LINE__ << ": empty intersection" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Statistics of each label the way the LabelStatistics module computes them
+bool BenchmarkLabelStatistics(Benchmarks& benchmarks)
+{
+  const int size = 192;
+  const int numberOfLabels = 8;
+  const int iterations = 3;
+  vtkSmartPointer<vtkImageData> grayscale = CreateGrayscaleImage(size);
+  vtkSmartPointer<vtkImageData> labels = CreateLabelImage(size, numberOfLabels);
+
+  BenchmarkResult& statistics = benchmarks.Add("LabelStatistics",
+    "Statistics of 8 labels of a 192^3 label map over a 192^3 volume");
+  vtkNew<vtkTimerLog> timer;
+  for (int i = 0; i < iterations; ++i)
+    {
+    vtkIdType numberOfVoxels = 0;
+    timer->StartTimer();
+    for (int label = 0; label < numberOfLabels; ++label)
+      {
+      vtkNew<vtkImageThreshold> threshold;
+      threshold->SetInput(labels);
+      threshold->ThresholdBetween(label, label);
+      threshold->SetInValue(1);
+      threshold->SetOutValue(0);
+      threshold->SetOutputScalarTypeToUnsignedChar();
+      vtkNew<vtkImageToImageStencil> stencil;
+      stencil->SetInput(threshold->GetOutput());
+      stencil->ThresholdBetween(1, 1);
+      vtkNew<vtkImageAccumulate> accumulate;
+      accumulate->SetInput(grayscale);
+      accumulate->SetStencil(stencil->GetOutput());
+      accumulate->Update();
+      numberOfVoxels += accumulate->GetVoxelCount();
+      }
+    timer->StopTimer();
+    statistics.Add(timer->GetElapsedTime());
+    if (numberOfVoxels != static_cast<vtkIdType>(size) * size * size)
+      {
+      std::cerr << "Line " << __LINE__ << ": " << numberOfVoxels
+                << " voxels in the labels instead of " << size * size * size << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Write and read back a volume with the storage nodes configured for data
+// exchange, the file I/O part of running a CLI as an executable. No CLI is run.
+bool BenchmarkDataExchangeRoundTrip(Benchmarks& benchmarks, const std::string& temporaryDirectory)
+{
+  const int size = 192;
+  const int iterations = 5;
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  AddVolume(scene.GetPointer(), volumeNode.GetPointer(), displayNode.GetPointer(),
+            CreateGrayscaleImage(size), "Input");
+  const std::string fileName = temporaryDirectory + "/vtkMRMLLogicBenchmarkTest.nrrd";
+
+  BenchmarkResult& roundTrip = benchmarks.Add("DataExchangeRoundTrip",
+    "Write and read back a 192^3 short volume with the data exchange storage settings");
+  vtkNew<vtkTimerLog> timer;
+  for (int i = 0; i < iterations; ++i)
+    {
+    vtkNew<vtkMRMLScalarVolumeNode> outputNode;
+    scene->AddNode(outputNode.GetPointer());
+    timer->StartTimer();
+    vtkSmartPointer<vtkMRMLStorageNode> writer;
+    writer.TakeReference(volumeNode->CreateDefaultStorageNode());
+    writer->ConfigureForDataExchange();
+    writer->SetFileName(fileName.c_str());
+    int written = writer->WriteData(volumeNode.GetPointer());
+    vtkSmartPointer<vtkMRMLStorageNode> reader;
+    reader.TakeReference(outputNode->CreateDefaultStorageNode());
+    reader->ConfigureForDataExchange();
+    reader->SetFileName(fileName.c_str());
+    int read = reader->ReadData(outputNode.GetPointer());
+    timer->StopTimer();
+    roundTrip.Add(timer->GetElapsedTime());
+    if (!written || !read || !outputNode->GetImageData() ||
+        outputNode->GetImageData()->GetNumberOfPoints() !=
+        volumeNode->GetImageData()->GetNumberOfPoints())
+      {
+      std::cerr << "Line " << __LINE__ << ": failed to write and read "
+                << fileName << std::endl;
+      return false;
+      }
+    scene->RemoveNode(outputNode.GetPointer());
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLLogicBenchmarkTest(int argc, char * argv [] )
+{
+#if ITK_VERSION_MAJOR > 3
+  itk::itkFactoryRegistration();
+#endif
+
+  if (argc < 2)
+    {
+    std::cerr << "Error: missing arguments" << std::endl;
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << argv[0] << " temporary_directory [output.json]" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string temporaryDirectory = argv[1];
+
+  Benchmarks benchmarks;
+  if (!BenchmarkScene(benchmarks, temporaryDirectory) ||
+      !BenchmarkSlice(benchmarks) ||
+      !BenchmarkModelCutting(benchmarks) ||
+      !BenchmarkLabelStatistics(benchmarks) ||
+      !BenchmarkDataExchangeRoundTrip(benchmarks, temporaryDirectory))
+    {
+    return EXIT_FAILURE;
+    }
+
+  benchmarks.Print(std::cout);
+  if (argc > 2)
+    {
+    std::ofstream output(argv[2]);
+    benchmarks.WriteJSON(output);
+    if (!output)
+      {
+      std::cerr << "Line " << __LINE__ << ": can't write " << argv[2] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
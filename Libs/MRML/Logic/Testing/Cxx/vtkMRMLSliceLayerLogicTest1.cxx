@@ -0,0 +1,251 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include <vtkImageResliceMask.h>
+#include <vtkMRMLSliceLayerLogic.h>
+#include <vtkMRMLSliceLogic.h>
+
+// MRML includes
+#include <vtkImageBrickCache.h>
+#include <vtkImageBrickSource.h>
+#include <vtkMRMLNRRDStorageNode.h>
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceCompositeNode.h>
+#include <vtkMRMLSliceNode.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkThinPlateSplineTransform.h>
+
+// STD includes
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+short Voxel(int i, int j, int k)
+{
+  return static_cast<short>(i * j - 3 * k);
+}
+
+//----------------------------------------------------------------------------
+bool WriteNRRD(const char* fileName, const int dimensions[3])
+{
+  std::ofstream file(fileName, std::ios::out | std::ios::binary);
+  file << "NRRD0004\n"
+       << "type: short\n"
+       << "dimension: 3\n"
+       << "space: left-posterior-superior\n"
+       << "sizes: " << dimensions[0] << " " << dimensions[1] << " " << dimensions[2] << "\n"
+       << "space directions: (1,0,0) (0,1,0) (0,0,1)\n"
+       << "encoding: raw\n"
+       << "endian: little\n"
+       << "\n";
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        const short voxel = Voxel(i, j, k);
+        const char bytes[2] = {static_cast<char>(voxel & 0xff),
+                               static_cast<char>((voxel >> 8) & 0xff)};
+        file.write(bytes, 2);
+        }
+      }
+    }
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLScalarVolumeNode* ReadVolume(vtkMRMLScene* scene, const char* fileName,
+                                    bool bricked)
+{
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+  vtkNew<vtkMRMLNRRDStorageNode> storageNode;
+  storageNode->SetFileName(fileName);
+  storageNode->SetBrickedReading(bricked ? 1 : 0);
+  scene->AddNode(storageNode.GetPointer());
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  scene->AddNode(volumeNode.GetPointer());
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  if (!storageNode->ReadData(volumeNode.GetPointer()))
+    {
+    return 0;
+    }
+  return volumeNode.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+bool AreImagesEqual(vtkImageData* image1, vtkImageData* image2)
+{
+  int extent1[6];
+  int extent2[6];
+  image1->GetExtent(extent1);
+  image2->GetExtent(extent2);
+  return memcmp(extent1, extent2, sizeof(extent1)) == 0 &&
+         image1->GetScalarType() == image2->GetScalarType() &&
+         memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(),
+                image1->GetNumberOfPoints() * image1->GetScalarSize()) == 0;
+}
+
+//----------------------------------------------------------------------------
+// An oblique slice of a bricked volume is the same as the slice of the
+// volume read as a whole, without reading the bounding box of the slice
+bool TestObliqueSlice(vtkMRMLScene* scene, vtkMRMLScalarVolumeNode* brickedVolumeNode,
+                      vtkMRMLScalarVolumeNode* volumeNode)
+{
+  vtkNew<vtkMRMLSliceLogic> sliceLogic;
+  sliceLogic->SetName("Red");
+  sliceLogic->SetMRMLScene(scene);
+  vtkNew<vtkMRMLSliceLayerLogic> sliceLayerLogic;
+  sliceLogic->SetBackgroundLayer(sliceLayerLogic.GetPointer());
+
+  vtkMRMLSliceNode* sliceNode = sliceLogic->GetSliceNode();
+  sliceNode->SetDimensions(128, 128, 1);
+  sliceNode->SetFieldOfView(128., 128., 1.);
+  double center[4] = {47.5, 47.5, 47.5, 1.};
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  volumeNode->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  ijkToRAS->MultiplyPoint(center, center);
+  sliceNode->SetSliceToRASByNTP(1., 1., 1., 1., -1., 0.,
+                                center[0], center[1], center[2], 0);
+
+  vtkMRMLSliceCompositeNode* sliceCompositeNode = sliceLogic->GetSliceCompositeNode();
+  sliceCompositeNode->SetBackgroundVolumeID(volumeNode->GetID());
+  sliceLogic->GetImageData();
+  vtkImageResliceMask* reslice = sliceLayerLogic->GetReslice();
+  reslice->Update();
+  vtkNew<vtkImageData> expected;
+  expected->DeepCopy(reslice->GetOutput());
+
+  // At most 32 KB of input for each thread
+  reslice->SetMaximumBrickInputSize(32);
+  vtkImageBrickCache* cache =
+    vtkImageBrickSource::GetImageBrickSource(brickedVolumeNode->GetImageData())->GetCache();
+  cache->SetBrickSize(8);
+  sliceCompositeNode->SetBackgroundVolumeID(brickedVolumeNode->GetID());
+  sliceLogic->GetImageData();
+  reslice->Update();
+  vtkImageData* resliceInput = vtkImageData::SafeDownCast(reslice->GetInput());
+  if (!AreImagesEqual(reslice->GetOutput(), expected.GetPointer()) ||
+      !resliceInput || resliceInput->GetNumberOfPoints() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong oblique slice of the bricked volume, "
+              << (resliceInput ? resliceInput->GetNumberOfPoints() : 0)
+              << " voxels of input" << std::endl;
+    return false;
+    }
+  // The slab of the slice is read
+  const vtkTypeInt64 numberOfBricks = 12 * 12 * 12;
+  if (cache->GetNumberOfBrickReads() == 0 ||
+      cache->GetNumberOfBrickReads() >= numberOfBricks / 2)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << cache->GetNumberOfBrickReads()
+              << " bricks read out of " << numberOfBricks << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// A nonlinear transform doesn't read the whole volume either
+bool TestNonlinearTransform(vtkMRMLScalarVolumeNode* brickedVolumeNode,
+                            vtkMRMLScalarVolumeNode* volumeNode)
+{
+  vtkNew<vtkPoints> sourceLandmarks;
+  vtkNew<vtkPoints> targetLandmarks;
+  for (int n = 0; n < 8; ++n)
+    {
+    const double x = (n & 1) ? 90. : 5.;
+    const double y = (n & 2) ? 90. : 5.;
+    const double z = (n & 4) ? 90. : 5.;
+    sourceLandmarks->InsertNextPoint(x, y, z);
+    targetLandmarks->InsertNextPoint(x + (n % 3), y - (n % 2), z + 2.);
+    }
+  vtkNew<vtkThinPlateSplineTransform> transform;
+  transform->SetSourceLandmarks(sourceLandmarks.GetPointer());
+  transform->SetTargetLandmarks(targetLandmarks.GetPointer());
+  transform->SetBasisToR();
+
+  vtkNew<vtkImageResliceMask> reslice;
+  reslice->SetInput(volumeNode->GetImageData());
+  reslice->SetResliceTransform(transform.GetPointer());
+  reslice->SetInterpolationModeToLinear();
+  reslice->SetOutputExtent(0, 95, 0, 95, 40, 41);
+  reslice->SetOutputSpacing(1., 1., 1.);
+  reslice->SetOutputOrigin(0., 0., 0.);
+  reslice->Update();
+  vtkNew<vtkImageData> expected;
+  expected->DeepCopy(reslice->GetOutput());
+
+  vtkImageBrickSource* brickSource =
+    vtkImageBrickSource::GetImageBrickSource(brickedVolumeNode->GetImageData());
+  reslice->SetInputConnection(brickSource->GetOutputPort());
+  reslice->SetMaximumBrickInputSize(32);
+  reslice->Update();
+  if (!AreImagesEqual(reslice->GetOutput(), expected.GetPointer()) ||
+      brickSource->GetOutput()->GetNumberOfPoints() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong nonlinear reslice of the bricked volume, "
+              << brickSource->GetOutput()->GetNumberOfPoints() << " voxels of input"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLSliceLayerLogicTest1(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkMRMLSliceLayerLogicTest1 <temporary file.nrrd>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int dimensions[3] = {96, 96, 96};
+  if (!WriteNRRD(argv[1], dimensions))
+    {
+    std::cerr << "Line " << __LINE__ << ": can't write " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLScalarVolumeNode* brickedVolumeNode = ReadVolume(scene.GetPointer(), argv[1], true);
+  vtkMRMLScalarVolumeNode* volumeNode = ReadVolume(scene.GetPointer(), argv[1], false);
+  if (!brickedVolumeNode || !volumeNode ||
+      !vtkImageBrickSource::GetImageBrickSource(brickedVolumeNode->GetImageData()))
+    {
+    std::cerr << "Line " << __LINE__ << ": can't read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!TestObliqueSlice(scene.GetPointer(), brickedVolumeNode, volumeNode) ||
+      !TestNonlinearTransform(brickedVolumeNode, volumeNode))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,398 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageMipmapPyramid.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationObjectBaseKey.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkImageMipmapPyramid, "$Revision$");
+vtkStandardNewMacro(vtkImageMipmapPyramid);
+vtkInformationKeyMacro(vtkImageMipmapPyramid, PYRAMID, ObjectBase);
+
+//----------------------------------------------------------------------------
+class vtkImageMipmapPyramid::vtkInternal
+{
+public:
+  vtkInternal();
+
+  vtkSmartPointer<vtkMultiThreader> Threader;
+  int ThreadID;
+
+  /// Modification time of the input and averaging of the levels
+  unsigned long BuildTime;
+  int BuildAverage;
+
+  /// Levels 1 to n, allocated in the main thread and filled by the
+  /// background thread. The scalars of the input are referenced during
+  /// the build. Dimensions[0] are the dimensions of the input and
+  /// Dimensions[n] the ones of the level n.
+  std::vector<vtkSmartPointer<vtkImageData> > Levels;
+  std::vector<void*> LevelPointers;
+  std::vector<std::vector<int> > Dimensions;
+  vtkSmartPointer<vtkDataArray> InputScalars;
+
+  /// Protects NumberOfBuiltLevels and Abort
+  vtkSimpleMutexLock Lock;
+  int NumberOfBuiltLevels;
+  bool Abort;
+};
+
+//----------------------------------------------------------------------------
+vtkImageMipmapPyramid::vtkInternal::vtkInternal()
+{
+  this->Threader = vtkSmartPointer<vtkMultiThreader>::New();
+  this->ThreadID = -1;
+  this->BuildTime = 0;
+  this->BuildAverage = 1;
+  this->NumberOfBuiltLevels = 0;
+  this->Abort = false;
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+template <class T>
+T vtkImageMipmapPyramidRound(double value)
+{
+  return std::numeric_limits<T>::is_integer ?
+    static_cast<T>(floor(value + 0.5)) : static_cast<T>(value);
+}
+
+//----------------------------------------------------------------------------
+// Fill the slice k of the output with the average (or the first) of the
+// 2x2x2 voxels of the input it covers. An axis of dimension 1 is not
+// downsampled.
+template <class T>
+void vtkImageMipmapPyramidDownsample(const T* inPtr, const int inDims[3],
+                                     T* outPtr, const int outDims[3],
+                                     int numComps, int average, int k)
+{
+  const vtkIdType inIncY = static_cast<vtkIdType>(inDims[0]) * numComps;
+  const vtkIdType inIncZ = inIncY * inDims[1];
+  int factors[3];
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    factors[axis] = inDims[axis] > outDims[axis] ? 2 : 1;
+    }
+  const int k0 = k * factors[2];
+  const int k1 = std::min(k0 + factors[2], inDims[2]);
+  T* out = outPtr + static_cast<vtkIdType>(k) * outDims[1] * outDims[0] * numComps;
+  for (int j = 0; j < outDims[1]; ++j)
+    {
+    const int j0 = j * factors[1];
+    const int j1 = std::min(j0 + factors[1], inDims[1]);
+    for (int i = 0; i < outDims[0]; ++i)
+      {
+      const int i0 = i * factors[0];
+      const int i1 = std::min(i0 + factors[0], inDims[0]);
+      const T* in = inPtr + k0 * inIncZ + j0 * inIncY + static_cast<vtkIdType>(i0) * numComps;
+      if (!average)
+        {
+        for (int c = 0; c < numComps; ++c)
+          {
+          *out++ = in[c];
+          }
+        continue;
+        }
+      const double count = (k1 - k0) * (j1 - j0) * (i1 - i0);
+      for (int c = 0; c < numComps; ++c)
+        {
+        double sum = 0.;
+        for (int kk = k0; kk < k1; ++kk)
+          {
+          for (int jj = j0; jj < j1; ++jj)
+            {
+            const T* row = inPtr + kk * inIncZ + jj * inIncY + c;
+            for (int ii = i0; ii < i1; ++ii)
+              {
+              sum += row[static_cast<vtkIdType>(ii) * numComps];
+              }
+            }
+          }
+        *out++ = vtkImageMipmapPyramidRound<T>(sum / count);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkImageMipmapPyramidThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  static_cast<vtkImageMipmapPyramid*>(info->UserData)->BuildLevels();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageMipmapPyramid::vtkImageMipmapPyramid()
+{
+  this->Input = 0;
+  this->Average = 1;
+  this->MinimumDimension = 64;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkImageMipmapPyramid::~vtkImageMipmapPyramid()
+{
+  this->ReleaseLevels();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMipmapPyramid::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Input: " << this->Input << "\n";
+  os << indent << "Average: " << this->Average << "\n";
+  os << indent << "MinimumDimension: " << this->MinimumDimension << "\n";
+  os << indent << "NumberOfLevels: " << this->Internal->Levels.size() + 1 << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkImageMipmapPyramid* vtkImageMipmapPyramid::GetImagePyramid(vtkImageData* image)
+{
+  if (!image)
+    {
+    return 0;
+    }
+  vtkInformation* info = image->GetInformation();
+  vtkImageMipmapPyramid* pyramid =
+    vtkImageMipmapPyramid::SafeDownCast(info->Get(vtkImageMipmapPyramid::PYRAMID()));
+  if (!pyramid)
+    {
+    pyramid = vtkImageMipmapPyramid::New();
+    pyramid->SetInput(image);
+    info->Set(vtkImageMipmapPyramid::PYRAMID(), pyramid);
+    pyramid->Delete();
+    }
+  return pyramid;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMipmapPyramid::SetInput(vtkImageData* image)
+{
+  if (this->Input == image)
+    {
+    return;
+    }
+  this->ReleaseLevels();
+  this->Input = image;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMipmapPyramid::SetAverage(int average)
+{
+  if (this->Average == average)
+    {
+    return;
+    }
+  // The levels are rebuilt the next time they are requested
+  this->Average = average;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageMipmapPyramid::IsUpToDate()
+{
+  return this->Input &&
+    this->Internal->BuildTime == this->Input->GetMTime() &&
+    this->Internal->BuildAverage == this->Average;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMipmapPyramid::ReleaseLevels()
+{
+  if (this->Internal->ThreadID >= 0)
+    {
+    this->Internal->Lock.Lock();
+    this->Internal->Abort = true;
+    this->Internal->Lock.Unlock();
+    // Wait for the thread to exit
+    this->Internal->Threader->TerminateThread(this->Internal->ThreadID);
+    this->Internal->ThreadID = -1;
+    }
+  this->Internal->Levels.clear();
+  this->Internal->LevelPointers.clear();
+  this->Internal->Dimensions.clear();
+  this->Internal->InputScalars = 0;
+  this->Internal->NumberOfBuiltLevels = 0;
+  this->Internal->Abort = false;
+  this->Internal->BuildTime = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMipmapPyramid::RequestUpdate()
+{
+  if (!this->Input || this->IsUpToDate())
+    {
+    return;
+    }
+  this->ReleaseLevels();
+  this->Internal->BuildTime = this->Input->GetMTime();
+  this->Internal->BuildAverage = this->Average;
+
+  vtkDataArray* scalars = this->Input->GetPointData()->GetScalars();
+  int dimensions[3];
+  this->Input->GetDimensions(dimensions);
+  if (!scalars || scalars->GetNumberOfTuples() !=
+      static_cast<vtkIdType>(dimensions[0]) * dimensions[1] * dimensions[2])
+    {
+    return;
+    }
+
+  // Allocate the levels here: the background thread only fills the voxels
+  double spacing[3];
+  double origin[3];
+  this->Input->GetSpacing(spacing);
+  this->Input->GetOrigin(origin);
+  this->Internal->Dimensions.push_back(std::vector<int>(dimensions, dimensions + 3));
+  while (std::max(dimensions[0], std::max(dimensions[1], dimensions[2])) >
+         this->MinimumDimension)
+    {
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      if (dimensions[axis] == 1)
+        {
+        continue;
+        }
+      dimensions[axis] = (dimensions[axis] + 1) / 2;
+      // The center of 2 averaged voxels is between them
+      if (this->Average)
+        {
+        origin[axis] += 0.5 * spacing[axis];
+        }
+      spacing[axis] *= 2.;
+      }
+    vtkSmartPointer<vtkDataArray> levelScalars;
+    levelScalars.TakeReference(vtkDataArray::CreateDataArray(scalars->GetDataType()));
+    levelScalars->SetNumberOfComponents(scalars->GetNumberOfComponents());
+    levelScalars->SetNumberOfTuples(
+      static_cast<vtkIdType>(dimensions[0]) * dimensions[1] * dimensions[2]);
+    vtkSmartPointer<vtkImageData> level = vtkSmartPointer<vtkImageData>::New();
+    level->SetDimensions(dimensions);
+    level->SetSpacing(spacing);
+    level->SetOrigin(origin);
+    level->SetScalarType(scalars->GetDataType());
+    level->SetNumberOfScalarComponents(scalars->GetNumberOfComponents());
+    level->GetPointData()->SetScalars(levelScalars);
+    this->Internal->Levels.push_back(level);
+    this->Internal->LevelPointers.push_back(levelScalars->GetVoidPointer(0));
+    this->Internal->Dimensions.push_back(std::vector<int>(dimensions, dimensions + 3));
+    }
+  if (this->Internal->Levels.empty())
+    {
+    return;
+    }
+  this->Internal->InputScalars = scalars;
+  this->Internal->ThreadID = this->Internal->Threader->SpawnThread(
+    vtkImageMipmapPyramidThreadFunction, this);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMipmapPyramid::BuildLevels()
+{
+  vtkDataArray* inputScalars = this->Internal->InputScalars;
+  const int numComps = inputScalars->GetNumberOfComponents();
+  const void* inPtr = inputScalars->GetVoidPointer(0);
+  const int average = this->Internal->BuildAverage;
+  for (size_t level = 0; level < this->Internal->LevelPointers.size(); ++level)
+    {
+    const int* inDims = &this->Internal->Dimensions[level][0];
+    const int* outDims = &this->Internal->Dimensions[level + 1][0];
+    void* outPtr = this->Internal->LevelPointers[level];
+    for (int k = 0; k < outDims[2]; ++k)
+      {
+      this->Internal->Lock.Lock();
+      const bool abort = this->Internal->Abort;
+      this->Internal->Lock.Unlock();
+      if (abort)
+        {
+        return;
+        }
+      switch (inputScalars->GetDataType())
+        {
+        vtkTemplateMacro(vtkImageMipmapPyramidDownsample(
+          static_cast<const VTK_TT*>(inPtr), inDims,
+          static_cast<VTK_TT*>(outPtr), outDims, numComps, average, k));
+        default:
+          return;
+        }
+      }
+    // The level can be used by the main thread from now on
+    this->Internal->Lock.Lock();
+    this->Internal->NumberOfBuiltLevels = static_cast<int>(level) + 1;
+    this->Internal->Lock.Unlock();
+    inPtr = outPtr;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMipmapPyramid::GetNumberOfLevels()
+{
+  this->RequestUpdate();
+  this->Internal->Lock.Lock();
+  const int numberOfLevels = this->Internal->NumberOfBuiltLevels + 1;
+  this->Internal->Lock.Unlock();
+  return numberOfLevels;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkImageMipmapPyramid::GetLevel(int level)
+{
+  if (level == 0)
+    {
+    return this->Input;
+    }
+  if (level < 0 || level >= this->GetNumberOfLevels())
+    {
+    return 0;
+    }
+  return this->Internal->Levels[level - 1];
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkImageMipmapPyramid::GetLevelForVoxelSize(double voxelSize)
+{
+  int level = 0;
+  for (double levelVoxelSize = 2.; levelVoxelSize <= voxelSize; levelVoxelSize *= 2.)
+    {
+    ++level;
+    }
+  if (level == 0)
+    {
+    return 0;
+    }
+  // Use a finer level while the coarser ones are being built
+  level = std::min(level, this->GetNumberOfLevels() - 1);
+  return level > 0 ? this->GetLevel(level) : 0;
+}
@@ -0,0 +1,106 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageMipmapPyramid_h
+#define __vtkImageMipmapPyramid_h
+
+// MRMLLogic includes
+#include "vtkMRMLLogicWin32Header.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkImageData;
+class vtkInformationObjectBaseKey;
+
+/// \brief Downsampled versions of an image, built in a background thread.
+///
+/// Level 0 is the image itself, each following level halves the dimensions
+/// of the previous one, down to MinimumDimension. The voxels of a level are
+/// the average of the voxels they cover, or the first of them if Average is
+/// off (e.g. for label maps). The origin and spacing of the levels are set
+/// so that they overlap the image: a level can replace the image as the
+/// input of a reslice without changing its transform.
+///
+/// The levels are built the first time they are requested and rebuilt when
+/// the image is modified. Until they are up to date, no level is returned
+/// and the image must be used instead.
+/// \sa vtkMRMLSliceLayerLogic
+class VTK_MRML_LOGIC_EXPORT vtkImageMipmapPyramid : public vtkObject
+{
+public:
+  static vtkImageMipmapPyramid *New();
+  vtkTypeRevisionMacro(vtkImageMipmapPyramid,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Return the pyramid of the image, creating it if needed.
+  /// The pyramid is kept in the information of the image: it is shared by
+  /// all the views displaying the image and deleted with it.
+  static vtkImageMipmapPyramid* GetImagePyramid(vtkImageData* image);
+
+  /// Key of the pyramid in the information of the image
+  static vtkInformationObjectBaseKey* PYRAMID();
+
+  /// Image the levels are built from. It is not referenced by the pyramid.
+  vtkGetObjectMacro(Input, vtkImageData);
+
+  /// Average the voxels of the previous level. On by default.
+  void SetAverage(int average);
+  vtkGetMacro(Average, int);
+  vtkBooleanMacro(Average, int);
+
+  /// The levels are built until all their dimensions are smaller than
+  /// MinimumDimension. 64 by default.
+  vtkSetClampMacro(MinimumDimension, int, 1, VTK_INT_MAX);
+  vtkGetMacro(MinimumDimension, int);
+
+  /// Return the coarsest level whose voxels are not larger than voxelSize
+  /// voxels of the image, or 0 if it is the image itself or if the levels
+  /// are not up to date. The levels are (re)built in the background if
+  /// needed.
+  vtkImageData* GetLevelForVoxelSize(double voxelSize);
+
+  /// Return the level, or 0 if it is not built or not up to date.
+  /// Level 0 is the image.
+  vtkImageData* GetLevel(int level);
+
+  /// Number of levels up to date, including the image
+  int GetNumberOfLevels();
+
+  /// Start building the levels in a background thread if they are not up to
+  /// date with the image.
+  void RequestUpdate();
+
+  /// Build the levels. Called from the background thread.
+  void BuildLevels();
+
+protected:
+  vtkImageMipmapPyramid();
+  virtual ~vtkImageMipmapPyramid();
+
+  void SetInput(vtkImageData* image);
+  /// Wait for the background thread and release the levels
+  void ReleaseLevels();
+  bool IsUpToDate();
+
+  vtkImageData* Input;
+  int Average;
+  int MinimumDimension;
+
+private:
+  vtkImageMipmapPyramid(const vtkImageMipmapPyramid&);  // Not implemented.
+  void operator=(const vtkImageMipmapPyramid&);  // Not implemented.
+
+  class vtkInternal;
+  vtkInternal* Internal;
+};
+
+#endif
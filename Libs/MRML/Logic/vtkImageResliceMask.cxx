@@ -15,7 +15,11 @@
 
 #include "vtkImageResliceMask.h"
 
+// MRML includes
+#include "vtkImageBrickSource.h"
+
 // VTK includes
+#include <vtkAlgorithmOutput.h>
 #include <vtkDataSetAttributes.h>
 #include <vtkImageData.h>
 #include <vtkImageStencilData.h>
@@ -34,6 +38,7 @@
 # define VTK_USE_UINT64 0
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 
 vtkCxxRevisionMacro(vtkImageResliceMask, "$Revision$");
@@ -87,6 +92,106 @@ inline int vtkResliceRound(double x)
 #endif
 }
 
+//----------------------------------------------------------------------------
+// Grow the input extent to include the voxels used to interpolate at the
+// point, given in input indices
+static void vtkResliceExpandExtent(int interpolationMode, const double point[3],
+                                   int inExt[6])
+{
+  int j, k;
+  double f;
+  if (interpolationMode != VTK_RESLICE_NEAREST)
+    {
+    int extra = (interpolationMode == VTK_RESLICE_CUBIC); 
+    for (j = 0; j < 3; j++) 
+      {
+      k = vtkResliceFloor(point[j], f);
+      if (f == 0)
+        {
+        if (k < inExt[2*j])
+          { 
+          inExt[2*j] = k;
+          }
+        if (k > inExt[2*j+1])
+          { 
+          inExt[2*j+1] = k;
+          }
+        }
+      else
+        {
+        if (k - extra < inExt[2*j])
+          { 
+          inExt[2*j] = k - extra;
+          }
+        if (k + 1 + extra > inExt[2*j+1])
+          { 
+          inExt[2*j+1] = k + 1 + extra;
+          }
+        }
+      }
+    }
+  else
+    {
+    for (j = 0; j < 3; j++) 
+      {
+      k = vtkResliceRound(point[j]);
+      if (k < inExt[2*j])
+        { 
+        inExt[2*j] = k;
+        } 
+      if (k > inExt[2*j+1]) 
+        {
+        inExt[2*j+1] = k;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Clip the input extent to the whole extent. Return 0 if it doesn't hit
+// the whole extent.
+static int vtkResliceClipExtent(const int wholeExtent[6], int wrap, int inExt[6])
+{
+  int hitInputExtent = 1;
+  for (int i = 0; i < 3; i++)
+    {
+    if (inExt[2*i] < wholeExtent[2*i])
+      {
+      inExt[2*i] = wholeExtent[2*i];
+      if (wrap)
+        {
+        inExt[2*i+1] = wholeExtent[2*i+1];
+        }
+      else if (inExt[2*i+1] < wholeExtent[2*i])
+        {
+        // didn't hit any of the input extent
+        inExt[2*i+1] = wholeExtent[2*i];
+        hitInputExtent = 0;
+        }
+      }
+    if (inExt[2*i+1] > wholeExtent[2*i+1])
+      {
+      inExt[2*i+1] = wholeExtent[2*i+1];
+      if (wrap)
+        {
+        inExt[2*i] = wholeExtent[2*i];
+        }
+      else if (inExt[2*i] > wholeExtent[2*i+1])
+        {
+        // didn't hit any of the input extent
+        inExt[2*i] = wholeExtent[2*i+1];
+        // finally, check for null input extent
+        if (inExt[2*i] < wholeExtent[2*i])
+          {
+          inExt[2*i] = wholeExtent[2*i];
+          }
+        hitInputExtent = 0;
+        }
+      }
+    }
+  return hitInputExtent;
+}
+
 //----------------------------------------------------------------------------
 vtkImageResliceMask::vtkImageResliceMask()
 {
@@ -154,6 +259,9 @@ vtkImageResliceMask::vtkImageResliceMask()
   // set to zero when we completely missed the input extent
   this->HitInputExtent = 1;
 
+  // memory used to read the input of a brick source, by thread
+  this->MaximumBrickInputSize = 16384;
+
   // There is an optional second input.
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(2);
@@ -218,6 +326,7 @@ void vtkImageResliceMask::PrintSelf(ostream& os, vtkIndent indent)
     this->ResliceTransform->PrintSelf(os,indent.GetNextIndent());
     }
   os << indent << "InformationInput: " << this->InformationInput << "\n";
+  os << indent << "MaximumBrickInputSize: " << this->MaximumBrickInputSize << "\n";
   os << indent << "TransformInputSampling: " << 
     (this->TransformInputSampling ? "On\n":"Off\n");
   os << indent << "AutoCropOutput: " << 
@@ -379,7 +488,7 @@ int vtkImageResliceMask::RequestUpdateExtent(
 {
   // RSierra: TODO why is this called 3 times for all slices if we are only changing one slice?
   int inExt[6], outExt[6], outExt2[6];
-  int i,j,k;
+  int i;
   vtkInformation *outInfo = outputVector->GetInformationObject(0);
   vtkInformation *outInfo2 = outputVector->GetInformationObject(1);
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
@@ -397,6 +506,29 @@ int vtkImageResliceMask::RequestUpdateExtent(
   if (this->ResliceTransform)
     {
     this->ResliceTransform->Update();
+    }
+
+  // The bricks are read by pieces of the output in ThreadedRequestData,
+  // only a voxel is requested from the brick source
+  if (this->GetInputBrickSource())
+    {
+    inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inExt);
+    inExt[1] = inExt[0];
+    inExt[3] = inExt[2];
+    inExt[5] = inExt[4];
+    inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
+    this->HitInputExtent = 1;
+    if (this->GetNumberOfInputConnections(1) > 0)
+      {
+      vtkInformation *stencilInfo = inputVector[1]->GetInformationObject(0);
+      stencilInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(),
+                       outExt, 6);
+      }
+    return 1;
+    }
+
+  if (this->ResliceTransform)
+    {
     if (!this->ResliceTransform->IsA("vtkHomogeneousTransform"))
       { // update the whole input extent if the transform is nonlinear
       inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inExt);
@@ -510,94 +642,13 @@ int vtkImageResliceMask::RequestUpdateExtent(
       }
 
     // set the extent appropriately according to the interpolation mode 
-    if (this->GetInterpolationMode() != VTK_RESLICE_NEAREST)
-      {
-      int extra = (this->GetInterpolationMode() == VTK_RESLICE_CUBIC); 
-      for (j = 0; j < 3; j++) 
-        {
-        k = vtkResliceFloor(point[j], f);
-        if (f == 0)
-          {
-          if (k < inExt[2*j])
-            { 
-            inExt[2*j] = k;
-            }
-          if (k > inExt[2*j+1])
-            { 
-            inExt[2*j+1] = k;
-            }
-          }
-        else
-          {
-          if (k - extra < inExt[2*j])
-            { 
-            inExt[2*j] = k - extra;
-            }
-          if (k + 1 + extra > inExt[2*j+1])
-            { 
-            inExt[2*j+1] = k + 1 + extra;
-            }
-          }
-        }
-      }
-    else
-      {
-      for (j = 0; j < 3; j++) 
-        {
-        k = vtkResliceRound(point[j]);
-        if (k < inExt[2*j])
-          { 
-          inExt[2*j] = k;
-          } 
-        if (k > inExt[2*j+1]) 
-          {
-          inExt[2*j+1] = k;
-          }
-        }
-      }
+    vtkResliceExpandExtent(this->GetInterpolationMode(), point, inExt);
     }
 
   // Clip to whole extent, make sure we hit the extent 
   int wholeExtent[6];
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
-  this->HitInputExtent = 1;
-
-  for (i = 0; i < 3; i++)
-    {
-    if (inExt[2*i] < wholeExtent[2*i])
-      {
-      inExt[2*i] = wholeExtent[2*i];
-      if (wrap)
-        {
-        inExt[2*i+1] = wholeExtent[2*i+1];
-        }
-      else if (inExt[2*i+1] < wholeExtent[2*i])
-        {
-        // didn't hit any of the input extent
-        inExt[2*i+1] = wholeExtent[2*i];
-        this->HitInputExtent = 0;
-        }
-      }
-    if (inExt[2*i+1] > wholeExtent[2*i+1])
-      {
-      inExt[2*i+1] = wholeExtent[2*i+1];
-      if (wrap)
-        {
-        inExt[2*i] = wholeExtent[2*i];
-        }
-      else if (inExt[2*i] > wholeExtent[2*i+1])
-        {
-        // didn't hit any of the input extent
-        inExt[2*i] = wholeExtent[2*i+1];
-        // finally, check for null input extent
-        if (inExt[2*i] < wholeExtent[2*i])
-          {
-          inExt[2*i] = wholeExtent[2*i];
-          }
-        this->HitInputExtent = 0;
-        }
-      }
-    }
+  this->HitInputExtent = vtkResliceClipExtent(wholeExtent, wrap, inExt);
 
   inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
 
@@ -3389,6 +3440,28 @@ void vtkImageResliceMask::ThreadedRequestData(
     return;
     }
 
+  vtkImageBrickSource *brickSource = this->GetInputBrickSource();
+  if (brickSource)
+    {
+    this->BrickRequestData(brickSource, inData[0][0], outData, outExt, id);
+    return;
+    }
+
+  this->ResliceExtent(inData[0][0], outData, outExt, id, this->HitInputExtent);
+}
+
+//----------------------------------------------------------------------------
+// Reslice the input into the output extent. The input extent must contain
+// the input of the output extent, unless hitInputExtent is 0: the output
+// is then cleared.
+void vtkImageResliceMask::ResliceExtent(vtkImageData *inData,
+                                        vtkImageData **outData,
+                                        int outExt[6], int id,
+                                        int hitInputExtent)
+{
+  int inExt[6];
+  inData->GetExtent(inExt);
+
   vtkImageData* backgroundMask = outData[1];
   // Get the output pointer
   void *outPtr = outData[0]->GetScalarPointerForExtent(outExt);
@@ -3415,15 +3488,15 @@ void vtkImageResliceMask::ThreadedRequestData(
           wholeExtent1[2] <= outExt[2] && wholeExtent1[3] >= outExt[3] &&
           wholeExtent1[4] <= outExt[4] && wholeExtent1[5] >= outExt[5] );        
 
-  if (this->HitInputExtent == 0)
+  if (hitInputExtent == 0)
     {
-    vtkImageResliceMaskClearExecute(this, inData[0][0], 0, outData[0], outPtr,
+    vtkImageResliceMaskClearExecute(this, inData, 0, outData[0], outPtr,
                                 outExt, id);
     return;
     }
   
   // Now that we know that we need the input, get the input pointer
-  void *inPtr = inData[0][0]->GetScalarPointerForExtent(inExt);
+  void *inPtr = inData->GetScalarPointerForExtent(inExt);
 
   if (this->Optimization)
     {
@@ -3446,19 +3519,175 @@ void vtkImageResliceMask::ThreadedRequestData(
   
     if (vtkIsPermutationMatrix(newmat) && newtrans == NULL)
       {
-      vtkReslicePermuteExecute(this, inData[0][0], inPtr, outData[0], outPtr,
+      vtkReslicePermuteExecute(this, inData, inPtr, outData[0], outPtr,
                                outExt, id, newmat, backgroundMask, backgroundMaskPtr);
       }
     else
       {
-      vtkOptimizedExecute(this, inData[0][0], inPtr, outData[0], outPtr,
+      vtkOptimizedExecute(this, inData, inPtr, outData[0], outPtr,
                           outExt, id, newmat, newtrans, backgroundMask, backgroundMaskPtr);
       }
     }
   else
     {
-    vtkImageResliceMaskExecute(this, inData[0][0], inPtr, outData[0], outPtr,
+    vtkImageResliceMaskExecute(this, inData, inPtr, outData[0], outPtr,
                            outExt, id, backgroundMask, backgroundMaskPtr);
     }
 }
 
+//----------------------------------------------------------------------------
+// Compute the input extent used by the output extent, like
+// RequestUpdateExtent but from the data objects. The corners of the output
+// extent are enough for a linear transform, all the points are transformed
+// otherwise. Return 0 if the input extent is not hit.
+int vtkImageResliceMask::ComputeInputExtent(vtkImageData *inData,
+                                            vtkImageData *outData,
+                                            const int outExt[6], int inExt[6])
+{
+  double *inOrigin = inData->GetOrigin();
+  double *inSpacing = inData->GetSpacing();
+  double *outOrigin = outData->GetOrigin();
+  double *outSpacing = outData->GetSpacing();
+
+  // the transform applied after the IndexMatrix or the ResliceAxes
+  vtkAbstractTransform *transform =
+    this->Optimization ? this->OptimizedTransform : this->ResliceTransform;
+  int linear = (transform == NULL || transform->IsA("vtkHomogeneousTransform"));
+
+  int i, step[3];
+  for (i = 0; i < 3; i++)
+    {
+    inExt[2*i] = VTK_INT_MAX;
+    inExt[2*i+1] = VTK_INT_MIN;
+    step[i] = (linear ? std::max(outExt[2*i+1] - outExt[2*i], 1) : 1);
+    }
+
+  double point[4], f;
+  for (int idZ = outExt[4]; idZ <= outExt[5]; idZ += step[2])
+    {
+    for (int idY = outExt[2]; idY <= outExt[3]; idY += step[1])
+      {
+      for (int idX = outExt[0]; idX <= outExt[1]; idX += step[0])
+        {
+        if (this->Optimization)
+          {
+          point[0] = idX;
+          point[1] = idY;
+          point[2] = idZ;
+          point[3] = 1.0;
+          this->IndexMatrix->MultiplyPoint(point, point);
+          f = 1.0/point[3];
+          point[0] *= f;
+          point[1] *= f;
+          point[2] *= f;
+          if (transform)
+            {
+            transform->InternalTransformPoint(point, point);
+            for (i = 0; i < 3; i++)
+              {
+              point[i] = (point[i] - inOrigin[i])/inSpacing[i];
+              }
+            }
+          }
+        else
+          {
+          point[0] = idX*outSpacing[0] + outOrigin[0];
+          point[1] = idY*outSpacing[1] + outOrigin[1];
+          point[2] = idZ*outSpacing[2] + outOrigin[2];
+          if (this->ResliceAxes)
+            {
+            point[3] = 1.0;
+            this->ResliceAxes->MultiplyPoint(point, point);
+            f = 1.0/point[3];
+            point[0] *= f;
+            point[1] *= f;
+            point[2] *= f;
+            }
+          if (transform)
+            {
+            transform->TransformPoint(point, point);
+            }
+          for (i = 0; i < 3; i++)
+            {
+            point[i] = (point[i] - inOrigin[i])/inSpacing[i];
+            }
+          }
+        vtkResliceExpandExtent(this->GetInterpolationMode(), point, inExt);
+        }
+      }
+    }
+
+  int wholeExtent[6];
+  inData->GetWholeExtent(wholeExtent);
+  return vtkResliceClipExtent(wholeExtent, this->Wrap || this->Mirror, inExt);
+}
+
+//----------------------------------------------------------------------------
+// Read the input of the output extent from the bricks and reslice it.
+// The output extent is split in halves along its largest dimension until
+// its input fits in MaximumBrickInputSize.
+void vtkImageResliceMask::BrickRequestData(vtkImageBrickSource *brickSource,
+                                           vtkImageData *inData,
+                                           vtkImageData **outData,
+                                           int outExt[6], int id)
+{
+  int inExt[6];
+  int hit = this->ComputeInputExtent(inData, outData[0], outExt, inExt);
+
+  double inputSize = inData->GetScalarSize() * inData->GetNumberOfScalarComponents();
+  int axis = 0;
+  for (int i = 0; i < 3; i++)
+    {
+    inputSize *= inExt[2*i+1] - inExt[2*i] + 1;
+    if (outExt[2*i+1] - outExt[2*i] > outExt[2*axis+1] - outExt[2*axis])
+      {
+      axis = i;
+      }
+    }
+  // the whole input is read along the wrapped axes whatever the output
+  // extent, splitting it would not reduce the input
+  if (hit && !this->Wrap && !this->Mirror &&
+      inputSize > this->MaximumBrickInputSize * 1024.0 &&
+      outExt[2*axis+1] > outExt[2*axis])
+    {
+    int half[6] = {outExt[0], outExt[1], outExt[2], outExt[3], outExt[4], outExt[5]};
+    half[2*axis+1] = (outExt[2*axis] + outExt[2*axis+1]) / 2;
+    this->BrickRequestData(brickSource, inData, outData, half, id);
+    half[2*axis] = half[2*axis+1] + 1;
+    half[2*axis+1] = outExt[2*axis+1];
+    this->BrickRequestData(brickSource, inData, outData, half, id);
+    return;
+    }
+
+  if (!hit)
+    {
+    this->ResliceExtent(inData, outData, outExt, id, 0);
+    return;
+    }
+
+  vtkNew<vtkImageData> input;
+  input->SetExtent(inExt);
+  input->SetSpacing(inData->GetSpacing());
+  input->SetOrigin(inData->GetOrigin());
+  input->SetScalarType(inData->GetScalarType());
+  input->SetNumberOfScalarComponents(inData->GetNumberOfScalarComponents());
+  input->AllocateScalars();
+  if (!brickSource->FillImage(input.GetPointer(), inExt))
+    {
+    vtkErrorMacro(<< "Execute: can't read the bricks of the input");
+    this->ResliceExtent(inData, outData, outExt, id, 0);
+    return;
+    }
+  this->ResliceExtent(input.GetPointer(), outData, outExt, id, 1);
+}
+
+//----------------------------------------------------------------------------
+vtkImageBrickSource *vtkImageResliceMask::GetInputBrickSource()
+{
+  if (this->GetNumberOfInputConnections(0) == 0)
+    {
+    return NULL;
+    }
+  vtkAlgorithmOutput *input = this->GetInputConnection(0, 0);
+  return vtkImageBrickSource::SafeDownCast(input ? input->GetProducer() : NULL);
+}
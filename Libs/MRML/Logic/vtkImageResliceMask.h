@@ -22,6 +22,7 @@
 #include <vtkImageReslice.h> // for VTK_RESLICE_NEAREST, LINEAR, CUBIC
 #include <vtkThreadedImageAlgorithm.h>
 class vtkAbstractTransform;
+class vtkImageBrickSource;
 class vtkImageData;
 class vtkImageStencilData;
 class vtkMatrix4x4;
@@ -293,6 +294,15 @@ public:
   vtkImageStencilData *GetStencil();
 
   vtkImageData *GetBackgroundMask();
+
+  /// 
+  /// Memory in kilobytes used by each thread to read the input when it is
+  /// produced by a vtkImageBrickSource. Only a voxel is then requested from
+  /// the source: the output extent is split until the input of each piece
+  /// fits, and the input of the pieces is read from the bricks.
+  /// The default is 16384 (16 MB).
+  vtkSetMacro(MaximumBrickInputSize, int);
+  vtkGetMacro(MaximumBrickInputSize, int);
 protected:
   vtkImageResliceMask();
   ~vtkImageResliceMask();
@@ -315,6 +325,7 @@ protected:
   int TransformInputSampling;
   int AutoCropOutput;
   int HitInputExtent;
+  int MaximumBrickInputSize;
 
   vtkMatrix4x4 *IndexMatrix;
   vtkAbstractTransform *OptimizedTransform;
@@ -338,6 +349,15 @@ protected:
   vtkAbstractTransform *GetOptimizedTransform() { 
     return this->OptimizedTransform; };
 
+  vtkImageBrickSource *GetInputBrickSource();
+  int ComputeInputExtent(vtkImageData *inData, vtkImageData *outData,
+                         const int outExt[6], int inExt[6]);
+  void BrickRequestData(vtkImageBrickSource *brickSource,
+                        vtkImageData *inData, vtkImageData **outData,
+                        int outExt[6], int id);
+  void ResliceExtent(vtkImageData *inData, vtkImageData **outData,
+                     int outExt[6], int id, int hitInputExtent);
+
 private:
   vtkImageResliceMask(const vtkImageResliceMask&);  /// Not implemented.
   void operator=(const vtkImageResliceMask&);  /// Not implemented.
@@ -13,9 +13,11 @@
 =========================================================================auto=*/
 
 // MRMLLogic includes
+#include "vtkImageMipmapPyramid.h"
 #include "vtkMRMLSliceLayerLogic.h"
 
 // MRML includes
+#include "vtkImageBrickSource.h"
 #include "vtkMRMLLabelMapVolumeDisplayNode.h"
 #include "vtkMRMLVectorVolumeDisplayNode.h"
 #include "vtkMRMLDiffusionWeightedVolumeDisplayNode.h"
@@ -34,6 +36,7 @@
 #include <vtkImageReslice.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
@@ -42,6 +45,9 @@
 //
 #include "vtkImageLabelOutline.h"
 
+// STD includes
+#include <algorithm>
+
 //----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkMRMLSliceLayerLogic, "$Revision$");
 vtkStandardNewMacro(vtkMRMLSliceLayerLogic);
@@ -66,6 +72,50 @@ bool AreMatricesEqual(const vtkMatrix4x4* first, const vtkMatrix4x4* second)
          first->GetElement(3,3) == second->GetElement(3,3);
 }
 
+//----------------------------------------------------------------------------
+// Restrict the brick source to the slab of the IJK space covered by the
+// slices of the given dimensions
+void SetBrickSourceSlab(vtkImageBrickSource* brickSource,
+                        vtkMatrix4x4* xyToIJK, const int dimensions[3])
+{
+  double u[3], v[3], w[3], normal[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    u[i] = xyToIJK->GetElement(i, 0);
+    v[i] = xyToIJK->GetElement(i, 1);
+    w[i] = xyToIJK->GetElement(i, 2);
+    }
+  vtkMath::Cross(u, v, normal);
+  if (vtkMath::Normalize(normal) == 0.)
+    {
+    brickSource->RestrictToSlabOff();
+    return;
+    }
+  const double center[4] = {0.5 * (dimensions[0] - 1), 0.5 * (dimensions[1] - 1),
+                            0.5 * (dimensions[2] - 1), 1.};
+  double origin[4];
+  xyToIJK->MultiplyPoint(center, origin);
+  brickSource->SetSlabOrigin(origin);
+  brickSource->SetSlabNormal(normal);
+  // The interpolation reads up to 2 voxels away along each axis
+  brickSource->SetSlabThickness(
+    fabs(vtkMath::Dot(normal, w)) * (dimensions[2] - 1) + 8.);
+  brickSource->RestrictToSlabOn();
+}
+
+//----------------------------------------------------------------------------
+// Return the size of the pixels of the slices in voxels
+double GetPixelSizeInVoxels(vtkMatrix4x4* xyToIJK)
+{
+  double u[3], v[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    u[i] = xyToIJK->GetElement(i, 0);
+    v[i] = xyToIJK->GetElement(i, 1);
+    }
+  return std::min(vtkMath::Norm(u), vtkMath::Norm(v));
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
 {
@@ -79,6 +129,7 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->UVWToIJKTransform = vtkTransform::New();
 
   this->IsLabelLayer = 0;
+  this->Interacting = 0;
 
   this->AssignAttributeTensorsToScalars= vtkAssignAttribute::New();
   this->AssignAttributeScalarsToTensors= vtkAssignAttribute::New();
@@ -92,6 +143,8 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->ResliceUVW = vtkImageResliceMask::New();
   this->LabelOutline = vtkImageLabelOutline::New();
   this->LabelOutlineUVW = vtkImageLabelOutline::New();
+  this->BrickSource = vtkImageBrickSource::New();
+  this->BrickSourceUVW = vtkImageBrickSource::New();
 
   //
   // Set parameters that won't change based on input
@@ -148,6 +201,8 @@ vtkMRMLSliceLayerLogic::~vtkMRMLSliceLayerLogic()
 
   this->LabelOutline->Delete();
   this->LabelOutlineUVW->Delete();
+  this->BrickSource->Delete();
+  this->BrickSourceUVW->Delete();
 
   this->AssignAttributeTensorsToScalars->Delete();
   this->AssignAttributeScalarsToTensors->Delete();
@@ -532,6 +587,9 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
                                      0, dimensionsUVW[1]-1,
                                      0, dimensionsUVW[2]-1);
 
+  SetBrickSourceSlab(this->BrickSource, xyToIJK.GetPointer(), dimensions);
+  SetBrickSourceSlab(this->BrickSourceUVW, uvwToIJK.GetPointer(), dimensionsUVW);
+
   this->UpdatingTransforms = 0; 
 
   if (transformModified || transformModifiedUVW)
@@ -704,8 +762,40 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
     } 
   else if (volumeNode) 
     {
-    this->Reslice->SetInput( volumeNode->GetImageData());
-    this->ResliceUVW->SetInput( volumeNode->GetImageData());
+    vtkImageBrickSource* volumeBrickSource =
+      vtkImageBrickSource::GetImageBrickSource(volumeNode->GetImageData());
+    if (volumeBrickSource)
+      {
+      // Read the bricks of the volume crossed by the slice only, the
+      // volume image data is never updated. The reslice reads the bricks
+      // itself, a few rows of the slice at a time.
+      this->BrickSource->SetCache(volumeBrickSource->GetCache());
+      this->BrickSourceUVW->SetCache(volumeBrickSource->GetCache());
+      this->Reslice->SetInputConnection( this->BrickSource->GetOutputPort());
+      this->ResliceUVW->SetInputConnection( this->BrickSourceUVW->GetOutputPort());
+      }
+    else
+      {
+      this->BrickSource->SetCache(0);
+      this->BrickSourceUVW->SetCache(0);
+      vtkImageData* resliceInput = volumeNode->GetImageData();
+      if (this->Interacting && resliceInput &&
+          volumeDisplayNode && volumeDisplayNode->GetUseMipmapPyramid())
+        {
+        // Zoomed out slices don't need all the voxels. Until the pyramid is
+        // built, the full resolution volume is used.
+        vtkImageMipmapPyramid* pyramid = vtkImageMipmapPyramid::GetImagePyramid(resliceInput);
+        pyramid->SetAverage(labelMapVolumeDisplayNode == 0);
+        vtkImageData* level = pyramid->GetLevelForVoxelSize(
+          GetPixelSizeInVoxels(this->XYToIJKTransform->GetMatrix()));
+        if (level)
+          {
+          resliceInput = level;
+          }
+        }
+      this->Reslice->SetInput( resliceInput);
+      this->ResliceUVW->SetInput( volumeNode->GetImageData());
+      }
     // use the label outline if we have a label map volume, this is the label
     // layer (turned on in slice logic when the label layer is instantiated)
     // and the slice node is set to use it.
@@ -777,6 +867,18 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetInteracting(int interacting)
+{
+  if (this->Interacting == interacting)
+    {
+    return;
+    }
+  this->Interacting = interacting;
+  // Go back to the full resolution volume for the last frame
+  this->UpdateImageDisplay();
+}
+
 //----------------------------------------------------------------------------
 vtkImageData* vtkMRMLSliceLayerLogic::GetSliceImageData()
 {
@@ -952,6 +1054,7 @@ void vtkMRMLSliceLayerLogic::PrintSelf(ostream& os, vtkIndent indent)
     }
 
   os << indent << "IsLabelLayer: " << this->GetIsLabelLayer() << "\n";
+  os << indent << "Interacting: " << this->Interacting << "\n";
   os << indent << "LabelOutline:\n";
   if (this->LabelOutline)
     {
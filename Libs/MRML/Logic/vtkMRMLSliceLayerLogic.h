@@ -47,6 +47,7 @@
 #include "vtkImageExtractComponents.h"
 
 class vtkAssignAttribute;
+class vtkImageBrickSource;
 class vtkImageResliceMask;
 
 // STL includes
@@ -124,6 +125,13 @@ public:
   /// The current reslice transform XYToIJK
   vtkGetObjectMacro (XYToIJKTransform, vtkTransform);
 
+  /// Set while the slice node is interacted with (e.g. by
+  /// vtkMRMLSliceLogic::StartSliceNodeInteraction()). If the volume display
+  /// node uses a mipmap pyramid, the slice is resliced from the level
+  /// matching the size of its pixels until the interaction ends.
+  void SetInteracting(int interacting);
+  vtkGetMacro (Interacting, int);
+
 
 protected:
   vtkMRMLSliceLayerLogic();
@@ -168,6 +176,11 @@ protected:
   vtkImageLabelOutline *LabelOutline;
   vtkImageLabelOutline *LabelOutlineUVW;
 
+  /// Inputs of the reslices for the bricked volumes, sharing the bricks of
+  /// the volume but reading only the ones of the slice
+  vtkImageBrickSource *BrickSource;
+  vtkImageBrickSource *BrickSourceUVW;
+
   vtkAssignAttribute* AssignAttributeTensorsToScalars;
   vtkAssignAttribute* AssignAttributeScalarsToTensors;
   vtkAssignAttribute* AssignAttributeScalarsToTensorsUVW;
@@ -177,6 +190,7 @@ protected:
   vtkTransform *UVWToIJKTransform;
 
   int IsLabelLayer;
+  int Interacting;
 
   int UpdatingTransforms;
 };
@@ -2025,6 +2025,21 @@ void vtkMRMLSliceLogic::EndSliceCompositeNodeInteraction()
     }
 }
 
+//----------------------------------------------------------------------------
+static void SetLayersInteracting(vtkMRMLSliceLogic* sliceLogic, int interacting)
+{
+  vtkMRMLSliceLayerLogic* layers[3] = {sliceLogic->GetBackgroundLayer(),
+                                       sliceLogic->GetForegroundLayer(),
+                                       sliceLogic->GetLabelLayer()};
+  for (int i = 0; i < 3; ++i)
+    {
+    if (layers[i])
+      {
+      layers[i]->SetInteracting(interacting);
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLogic::StartSliceNodeInteraction(unsigned int parameters)
 {
@@ -2033,6 +2048,9 @@ void vtkMRMLSliceLogic::StartSliceNodeInteraction(unsigned int parameters)
     return;
     }
 
+  // The layers may display downsampled volumes until the interaction ends
+  SetLayersInteracting(this, 1);
+
   // Cache the flags on what parameters are going to be modified. Need
   // to this this outside the conditional on HotLinkedControl and LinkedControl
   this->SliceNode->SetInteractionFlags(parameters);
@@ -2151,6 +2169,8 @@ void vtkMRMLSliceLogic::EndSliceNodeInteraction()
     return;
     }
 
+  SetLayersInteracting(this, 0);
+
   // If we have linked controls, then we want to broadcast changes
   if (this->SliceCompositeNode->GetLinkedControl())
     {
@@ -0,0 +1,593 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// RemoteIO includes
+#include "vtkHTTPHandler.h"
+
+// VTK includes
+#include <vtkIntArray.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Content of a file, deterministic for a given name
+std::string fileContent(const std::string& name, size_t size = 100000)
+{
+  unsigned int seed = 0;
+  for (size_t i = 0; i < name.size(); ++i)
+    {
+    seed = seed * 31 + static_cast<unsigned char>(name[i]);
+    }
+  std::string content(size, '\0');
+  for (size_t i = 0; i < size; ++i)
+    {
+    content[i] = static_cast<char>((i * 7 + seed) % 251);
+    }
+  return content;
+}
+
+//----------------------------------------------------------------------------
+std::string readFile(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+//----------------------------------------------------------------------------
+bool testFileURLs(const std::string& directory);
+
+#ifndef _WIN32
+bool testServer(const std::string& directory);
+#endif
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandlerTest1(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkHTTPHandlerTest1 /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = argv[1];
+  if (!testFileURLs(directory))
+    {
+    std::cerr << "testFileURLs call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+#ifndef _WIN32
+  if (!testServer(directory))
+    {
+    std::cerr << "testServer call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+#endif
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool testFileURLs(const std::string& directory)
+{
+  const int numberOfFiles = 6;
+  vtkNew<vtkStringArray> sources;
+  vtkNew<vtkStringArray> destinations;
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    std::stringstream name;
+    name << "vtkHTTPHandlerTest1-source" << i;
+    std::string source = directory + "/" + name.str();
+    std::ofstream file(source.c_str(), std::ios::binary);
+    file << fileContent(name.str(), 50000 * (i + 1));
+    file.close();
+    sources->InsertNextValue("file://" + source);
+    destinations->InsertNextValue(directory + "/" + name.str() + ".downloaded");
+    }
+  // A missing file fails
+  sources->InsertNextValue("file://" + directory + "/vtkHTTPHandlerTest1-missing");
+  destinations->InsertNextValue(directory + "/vtkHTTPHandlerTest1-missing.downloaded");
+
+  vtkNew<vtkHTTPHandler> handler;
+  handler->SetMaximumNumberOfConcurrentTransfers(3);
+  vtkNew<vtkIntArray> succeeded;
+  int failed = handler->StageFileReads(sources.GetPointer(), destinations.GetPointer(),
+                                       succeeded.GetPointer());
+  if (failed != 1 ||
+      succeeded->GetNumberOfTuples() != numberOfFiles + 1 ||
+      succeeded->GetValue(numberOfFiles) != 0)
+    {
+    std::cerr << __LINE__ << ": StageFileReads failed: " << failed << " failures" << std::endl;
+    return false;
+    }
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    std::stringstream name;
+    name << "vtkHTTPHandlerTest1-source" << i;
+    if (succeeded->GetValue(i) != 1 ||
+        readFile(destinations->GetValue(i)) != fileContent(name.str(), 50000 * (i + 1)))
+      {
+      std::cerr << __LINE__ << ": Wrong download of " << sources->GetValue(i) << std::endl;
+      return false;
+      }
+    }
+  // The staged downloads leave no record
+  if (handler->GetNumberOfTransfers() != 0)
+    {
+    std::cerr << __LINE__ << ": Staged downloads recorded: "
+              << handler->GetNumberOfTransfers() << std::endl;
+    return false;
+    }
+
+  // The queued downloads are recorded until ClearTransfers() is called
+  for (int i = 0; i < 3; ++i)
+    {
+    if (handler->QueueFileRead(sources->GetValue(i).c_str(),
+                               destinations->GetValue(i).c_str()) != i)
+      {
+      std::cerr << __LINE__ << ": QueueFileRead failed" << std::endl;
+      return false;
+      }
+    }
+  if (handler->GetTransferStatus(2) != vtkHTTPHandler::Queued ||
+      handler->PerformQueuedFileReads() != 0)
+    {
+    std::cerr << __LINE__ << ": PerformQueuedFileReads failed" << std::endl;
+    return false;
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    if (handler->GetTransferStatus(i) != vtkHTTPHandler::Completed ||
+        handler->GetTransferBytes(i) != 50000 * (i + 1))
+      {
+      std::cerr << __LINE__ << ": Wrong statistics of transfer " << i << ": "
+                << handler->GetTransferBytes(i) << " bytes" << std::endl;
+      return false;
+      }
+    }
+  handler->ClearTransfers();
+  if (handler->GetNumberOfTransfers() != 0)
+    {
+    std::cerr << __LINE__ << ": ClearTransfers failed" << std::endl;
+    return false;
+    }
+
+  for (int i = 0; i < sources->GetNumberOfValues(); ++i)
+    {
+    remove(sources->GetValue(i).substr(7).c_str());
+    remove(destinations->GetValue(i).c_str());
+    }
+  return true;
+}
+
+#ifndef _WIN32
+
+//----------------------------------------------------------------------------
+// Minimal HTTP/1.1 server with keep alive connections and range requests.
+// The path of a request selects its behavior:
+//  /data/<name>       answered right away
+//  /slow/<name>       answered once 4 slow requests are pending, or after 2s
+//  /interrupt/<name>  the first request is closed after half of the content
+//  /close/<name>      the connection is closed without an answer
+class TestServer
+{
+public:
+  TestServer()
+    : Socket(-1)
+    , Port(0)
+    , Stop(false)
+    , NumberOfConnections(0)
+    , NumberOfRangeRequests(0)
+    , MaximumNumberOfPendingRequests(0)
+  {
+  }
+
+  bool Start()
+  {
+    this->Socket = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (this->Socket < 0 ||
+        bind(this->Socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(this->Socket, 16) != 0 ||
+        getsockname(this->Socket, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+      {
+      return false;
+      }
+    this->Port = ntohs(address.sin_port);
+    this->ThreadID = this->Threader->SpawnThread(&TestServer::Run, this);
+    return true;
+  }
+
+  void Terminate()
+  {
+    this->Lock->Lock();
+    this->Stop = true;
+    this->Lock->Unlock();
+    this->Threader->TerminateThread(this->ThreadID);
+    close(this->Socket);
+  }
+
+  std::string URL(const std::string& path)const
+  {
+    std::stringstream url;
+    url << "http://127.0.0.1:" << this->Port << path;
+    return url.str();
+  }
+
+  void ResetCounters()
+  {
+    this->Lock->Lock();
+    this->NumberOfConnections = 0;
+    this->NumberOfRangeRequests = 0;
+    this->MaximumNumberOfPendingRequests = 0;
+    this->Lock->Unlock();
+  }
+
+  int GetCounter(const int& counter)
+  {
+    this->Lock->Lock();
+    int value = counter;
+    this->Lock->Unlock();
+    return value;
+  }
+
+  int Socket;
+  int Port;
+  bool Stop;
+  int NumberOfConnections;
+  int NumberOfRangeRequests;
+  int MaximumNumberOfPendingRequests;
+
+protected:
+  struct Request
+  {
+    std::string Path;
+    size_t RangeStart;
+    double Time;
+  };
+
+  static double Now()
+  {
+    timeval now;
+    gettimeofday(&now, 0);
+    return now.tv_sec + now.tv_usec * 1e-6;
+  }
+
+  static void Send(int socket, const std::string& data)
+  {
+    size_t sent = 0;
+    while (sent < data.size())
+      {
+      ssize_t n = send(socket, data.data() + sent, data.size() - sent, 0);
+      if (n <= 0)
+        {
+        return;
+        }
+      sent += n;
+      }
+  }
+
+  /// Answer a request, returns false if the connection is closed
+  bool Answer(int socket, const Request& request)
+  {
+    std::string name = request.Path.substr(request.Path.find('/', 1) + 1);
+    std::string content = fileContent(name);
+    if (request.Path.find("/close/") == 0)
+      {
+      return false;
+      }
+    bool interrupt = request.Path.find("/interrupt/") == 0 &&
+      this->Interrupted.find(request.Path) == this->Interrupted.end();
+    std::stringstream header;
+    if (request.RangeStart > 0)
+      {
+      this->Lock->Lock();
+      ++this->NumberOfRangeRequests;
+      this->Lock->Unlock();
+      header << "HTTP/1.1 206 Partial Content\r\n"
+             << "Content-Range: bytes " << request.RangeStart << "-"
+             << content.size() - 1 << "/" << content.size() << "\r\n";
+      content = content.substr(request.RangeStart);
+      }
+    else
+      {
+      header << "HTTP/1.1 200 OK\r\n";
+      }
+    header << "Content-Length: " << content.size() << "\r\n"
+           << "Accept-Ranges: bytes\r\n\r\n";
+    Send(socket, header.str());
+    if (interrupt)
+      {
+      this->Interrupted[request.Path] = true;
+      Send(socket, content.substr(0, content.size() / 2));
+      return false;
+      }
+    Send(socket, content);
+    return true;
+  }
+
+  void Serve()
+  {
+    std::map<int, std::string> buffers;
+    std::map<int, Request> pendingRequests;
+    while (true)
+      {
+      this->Lock->Lock();
+      bool stop = this->Stop;
+      this->Lock->Unlock();
+      if (stop)
+        {
+        break;
+        }
+
+      fd_set readSet;
+      FD_ZERO(&readSet);
+      FD_SET(this->Socket, &readSet);
+      int maxFd = this->Socket;
+      for (std::map<int, std::string>::iterator it = buffers.begin();
+           it != buffers.end(); ++it)
+        {
+        FD_SET(it->first, &readSet);
+        maxFd = std::max(maxFd, it->first);
+        }
+      timeval wait;
+      wait.tv_sec = 0;
+      wait.tv_usec = 20000;
+      select(maxFd + 1, &readSet, 0, 0, &wait);
+
+      if (FD_ISSET(this->Socket, &readSet))
+        {
+        int client = accept(this->Socket, 0, 0);
+        if (client >= 0)
+          {
+          buffers[client] = std::string();
+          this->Lock->Lock();
+          ++this->NumberOfConnections;
+          this->Lock->Unlock();
+          }
+        }
+
+      std::vector<int> closed;
+      for (std::map<int, std::string>::iterator it = buffers.begin();
+           it != buffers.end(); ++it)
+        {
+        if (!FD_ISSET(it->first, &readSet))
+          {
+          continue;
+          }
+        char data[4096];
+        ssize_t n = recv(it->first, data, sizeof(data), 0);
+        if (n <= 0)
+          {
+          closed.push_back(it->first);
+          continue;
+          }
+        it->second.append(data, n);
+        size_t end = it->second.find("\r\n\r\n");
+        if (end == std::string::npos)
+          {
+          continue;
+          }
+        std::string header = it->second.substr(0, end);
+        it->second.erase(0, end + 4);
+        Request request;
+        request.Path = header.substr(4, header.find(' ', 4) - 4);
+        request.RangeStart = 0;
+        request.Time = Now();
+        size_t range = header.find("Range: bytes=");
+        if (range != std::string::npos)
+          {
+          request.RangeStart = strtoul(header.c_str() + range + 13, 0, 10);
+          }
+        if (request.Path.find("/slow/") == 0)
+          {
+          pendingRequests[it->first] = request;
+          this->Lock->Lock();
+          this->MaximumNumberOfPendingRequests =
+            std::max(this->MaximumNumberOfPendingRequests,
+                     static_cast<int>(pendingRequests.size()));
+          this->Lock->Unlock();
+          }
+        else if (!this->Answer(it->first, request))
+          {
+          closed.push_back(it->first);
+          }
+        }
+
+      // The slow requests are answered together
+      bool answer = pendingRequests.size() >= 4;
+      for (std::map<int, Request>::iterator it = pendingRequests.begin();
+           it != pendingRequests.end(); ++it)
+        {
+        answer = answer || Now() - it->second.Time > 2.;
+        }
+      if (answer)
+        {
+        for (std::map<int, Request>::iterator it = pendingRequests.begin();
+             it != pendingRequests.end(); ++it)
+          {
+          this->Answer(it->first, it->second);
+          }
+        pendingRequests.clear();
+        }
+
+      for (size_t i = 0; i < closed.size(); ++i)
+        {
+        close(closed[i]);
+        buffers.erase(closed[i]);
+        pendingRequests.erase(closed[i]);
+        }
+      }
+    for (std::map<int, std::string>::iterator it = buffers.begin();
+         it != buffers.end(); ++it)
+      {
+      close(it->first);
+      }
+  }
+
+  static VTK_THREAD_RETURN_TYPE Run(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    static_cast<TestServer*>(info->UserData)->Serve();
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  vtkNew<vtkMultiThreader> Threader;
+  vtkNew<vtkSimpleMutexLock> Lock;
+  int ThreadID;
+  /// Paths of the interrupted requests
+  std::map<std::string, bool> Interrupted;
+};
+
+//----------------------------------------------------------------------------
+bool testServer(const std::string& directory)
+{
+  TestServer server;
+  if (!server.Start())
+    {
+    std::cerr << __LINE__ << ": Can't start the server" << std::endl;
+    return false;
+    }
+  vtkNew<vtkHTTPHandler> handler;
+  bool success = true;
+
+  // Successive downloads reuse the connection
+  for (int i = 0; i < 3 && success; ++i)
+    {
+    std::stringstream name;
+    name << "data" << i;
+    std::string destination = directory + "/vtkHTTPHandlerTest1-" + name.str();
+    handler->StageFileRead(server.URL("/data/" + name.str()).c_str(), destination.c_str());
+    success = readFile(destination) == fileContent(name.str());
+    remove(destination.c_str());
+    }
+  if (!success || server.GetCounter(server.NumberOfConnections) != 1)
+    {
+    std::cerr << __LINE__ << ": Connection not reused: "
+              << server.GetCounter(server.NumberOfConnections) << " connections" << std::endl;
+    server.Terminate();
+    return false;
+    }
+
+  // Concurrent downloads
+  server.ResetCounters();
+  handler->SetMaximumNumberOfConcurrentTransfers(4);
+  vtkNew<vtkStringArray> sources;
+  vtkNew<vtkStringArray> destinations;
+  for (int i = 0; i < 6; ++i)
+    {
+    std::stringstream name;
+    name << "slow" << i;
+    sources->InsertNextValue(server.URL("/slow/" + name.str()));
+    destinations->InsertNextValue(directory + "/vtkHTTPHandlerTest1-" + name.str());
+    }
+  vtkNew<vtkIntArray> succeeded;
+  int failed = handler->StageFileReads(sources.GetPointer(), destinations.GetPointer(),
+                                       succeeded.GetPointer());
+  for (int i = 0; i < 6; ++i)
+    {
+    std::stringstream name;
+    name << "slow" << i;
+    success = success && succeeded->GetValue(i) == 1 &&
+      readFile(destinations->GetValue(i)) == fileContent(name.str());
+    remove(destinations->GetValue(i).c_str());
+    }
+  if (failed != 0 || !success ||
+      server.GetCounter(server.MaximumNumberOfPendingRequests) != 4)
+    {
+    std::cerr << __LINE__ << ": Concurrent downloads failed: " << failed << " failures, "
+              << server.GetCounter(server.MaximumNumberOfPendingRequests)
+              << " concurrent requests" << std::endl;
+    server.Terminate();
+    return false;
+    }
+
+  // An interrupted download is resumed with a range request
+  server.ResetCounters();
+  std::string destination = directory + "/vtkHTTPHandlerTest1-interrupted";
+  int transfer = handler->QueueFileRead(server.URL("/interrupt/interrupted").c_str(),
+                                        destination.c_str());
+  failed = handler->PerformQueuedFileReads();
+  if (failed != 0 ||
+      readFile(destination) != fileContent("interrupted") ||
+      handler->GetTransferStatus(transfer) != vtkHTTPHandler::Completed ||
+      handler->GetTransferNumberOfRetries(transfer) != 1 ||
+      server.GetCounter(server.NumberOfRangeRequests) != 1)
+    {
+    std::cerr << __LINE__ << ": Download not resumed: "
+              << handler->GetTransferNumberOfRetries(transfer) << " retries, "
+              << server.GetCounter(server.NumberOfRangeRequests) << " range requests"
+              << std::endl;
+    server.Terminate();
+    return false;
+    }
+  remove(destination.c_str());
+
+  // A download that received nothing is not retried
+  destination = directory + "/vtkHTTPHandlerTest1-closed";
+  transfer = handler->QueueFileRead(server.URL("/close/closed").c_str(),
+                                    destination.c_str());
+  failed = handler->PerformQueuedFileReads();
+  if (failed != 1 ||
+      handler->GetTransferStatus(transfer) != vtkHTTPHandler::Failed ||
+      handler->GetTransferNumberOfRetries(transfer) != 0)
+    {
+    std::cerr << __LINE__ << ": Empty answer retried: "
+              << handler->GetTransferNumberOfRetries(transfer) << " retries" << std::endl;
+    server.Terminate();
+    return false;
+    }
+  remove(destination.c_str());
+  handler->ClearTransfers();
+
+  server.Terminate();
+  return true;
+}
+
+#endif
+
+} // end of anonymous namespace
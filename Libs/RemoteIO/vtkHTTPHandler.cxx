@@ -1,6 +1,389 @@
 #include "vtkHTTPHandler.h"
 #include <vtkPermissionPrompter.h>
 
+// VTK includes
+#include <vtkIntArray.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+
+// STD includes
+#include <deque>
+#include <vector>
+
+//----------------------------------------------------------------------------
+class vtkHTTPHandler::vtkInternal
+{
+public:
+  struct Transfer
+    {
+    std::string Source;
+    std::string Destination;
+    int Status;
+    CURL* Handle;
+    FILE* File;
+    /// Number of bytes in the destination file
+    curl_off_t FileSize;
+    /// Size of the file when the current request started, requested as a
+    /// range when resuming
+    curl_off_t ResumeOffset;
+    bool ResponseChecked;
+    double Bytes;
+    double Time;
+    int Retries;
+    long Connections;
+    };
+
+  vtkInternal();
+  ~vtkInternal();
+
+  /// Start or resume the request of a transfer
+  bool Start(vtkHTTPHandler* self, Transfer* transfer);
+  /// Collect the statistics of the request of a transfer that is done and
+  /// either retry it or close it. Returns true if it is retried.
+  bool Finish(vtkHTTPHandler* self, Transfer* transfer, CURLcode result);
+  /// Close the file of a transfer and keep its handle for the next requests
+  void Release(Transfer* transfer);
+  /// Run transfers with at most MaximumNumberOfConcurrentTransfers
+  /// requests at the same time and return the number of failed transfers.
+  int Run(vtkHTTPHandler* self, const std::vector<Transfer*>& transfers);
+  /// Add a transfer to the queue and return its index
+  int Queue(const char* source, const char* destination);
+  /// Run the queued transfers and return the number of failed transfers
+  int RunQueued(vtkHTTPHandler* self);
+
+  static size_t WriteCallback(void *ptr, size_t size, size_t nmemb, void *data);
+
+  CURLM* Multi;
+  /// Easy handles kept for the next requests
+  std::vector<CURL*> IdleHandles;
+  /// Deque to keep the address of the transfers valid
+  std::deque<Transfer> Transfers;
+  /// The downloads can be staged from several networking threads, the curl
+  /// handles and the transfers are used by one thread at a time.
+  vtkSmartPointer<vtkSimpleMutexLock> Lock;
+};
+
+//----------------------------------------------------------------------------
+vtkHTTPHandler::vtkInternal::vtkInternal()
+{
+  this->Multi = NULL;
+  this->Lock = vtkSmartPointer<vtkSimpleMutexLock>::New();
+}
+
+//----------------------------------------------------------------------------
+vtkHTTPHandler::vtkInternal::~vtkInternal()
+{
+  for (std::vector<CURL*>::iterator it = this->IdleHandles.begin();
+       it != this->IdleHandles.end(); ++it)
+    {
+    curl_easy_cleanup(*it);
+    }
+  if (this->Multi)
+    {
+    curl_multi_cleanup(this->Multi);
+    }
+}
+
+//----------------------------------------------------------------------------
+size_t vtkHTTPHandler::vtkInternal::WriteCallback(void *ptr, size_t size, size_t nmemb, void *data)
+{
+  Transfer* transfer = reinterpret_cast<Transfer*>(data);
+  if (!transfer->ResponseChecked)
+    {
+    transfer->ResponseChecked = true;
+    long responseCode = 0;
+    curl_easy_getinfo(transfer->Handle, CURLINFO_RESPONSE_CODE, &responseCode);
+    // 206 is a partial content: the server honored the range. Otherwise
+    // the whole file is sent again.
+    if (transfer->ResumeOffset > 0 && responseCode != 206)
+      {
+      transfer->File = freopen(transfer->Destination.c_str(), "wb", transfer->File);
+      transfer->FileSize = 0;
+      }
+    }
+  if (transfer->File == NULL)
+    {
+    return 0;
+    }
+  size_t written = fwrite(ptr, 1, size * nmemb, transfer->File);
+  transfer->FileSize += written;
+  return written;
+}
+
+//----------------------------------------------------------------------------
+bool vtkHTTPHandler::vtkInternal::Start(vtkHTTPHandler* self, Transfer* transfer)
+{
+  if (transfer->File == NULL)
+    {
+    transfer->File = fopen(transfer->Destination.c_str(), "wb");
+    if (transfer->File == NULL)
+      {
+      vtkErrorWithObjectMacro(self, "StageFileRead: can't write " << transfer->Destination);
+      return false;
+      }
+    transfer->FileSize = 0;
+    }
+  if (transfer->Handle == NULL)
+    {
+    if (this->IdleHandles.empty())
+      {
+      transfer->Handle = curl_easy_init();
+      }
+    else
+      {
+      transfer->Handle = this->IdleHandles.back();
+      this->IdleHandles.pop_back();
+      curl_easy_reset(transfer->Handle);
+      }
+    if (transfer->Handle == NULL)
+      {
+      vtkErrorWithObjectMacro(self, "StageFileRead: unable to initialise curl");
+      this->Release(transfer);
+      return false;
+      }
+    }
+  CURL* handle = transfer->Handle;
+  if (self->GetForbidReuse())
+    {
+    curl_easy_setopt(handle, CURLOPT_FORBID_REUSE, 1);
+    }
+  curl_easy_setopt(handle, CURLOPT_HTTPGET, 1);
+  curl_easy_setopt(handle, CURLOPT_URL, transfer->Source.c_str());
+  curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
+  // don't save error pages as data
+  curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1);
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, vtkInternal::WriteCallback);
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, transfer);
+  curl_easy_setopt(handle, CURLOPT_PRIVATE, transfer);
+  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
+  curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 3); // in seconds (type long)
+  transfer->ResumeOffset = transfer->FileSize;
+  transfer->ResponseChecked = false;
+  curl_easy_setopt(handle, CURLOPT_RESUME_FROM_LARGE, transfer->ResumeOffset);
+
+  if (curl_multi_add_handle(this->Multi, handle) != CURLM_OK)
+    {
+    vtkErrorWithObjectMacro(self, "StageFileRead: unable to start the transfer of " << transfer->Source);
+    this->Release(transfer);
+    return false;
+    }
+  transfer->Status = vtkHTTPHandler::Running;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkHTTPHandler::vtkInternal::Finish(vtkHTTPHandler* self, Transfer* transfer, CURLcode result)
+{
+  double bytes = 0.;
+  double time = 0.;
+  long connections = 0;
+  curl_easy_getinfo(transfer->Handle, CURLINFO_SIZE_DOWNLOAD, &bytes);
+  curl_easy_getinfo(transfer->Handle, CURLINFO_TOTAL_TIME, &time);
+  curl_easy_getinfo(transfer->Handle, CURLINFO_NUM_CONNECTS, &connections);
+  transfer->Bytes += bytes;
+  transfer->Time += time;
+  transfer->Connections += connections;
+  curl_multi_remove_handle(this->Multi, transfer->Handle);
+
+  // resume the downloads interrupted after they received data, a server
+  // that doesn't answer is not retried
+  const bool interrupted =
+    transfer->FileSize > 0 &&
+    (result == CURLE_PARTIAL_FILE ||
+     result == CURLE_OPERATION_TIMEDOUT ||
+     result == CURLE_RECV_ERROR ||
+     result == CURLE_SEND_ERROR ||
+     result == CURLE_GOT_NOTHING);
+  if (interrupted && transfer->Retries < self->GetMaximumNumberOfRetries())
+    {
+    ++transfer->Retries;
+    vtkDebugWithObjectMacro(self, "StageFileRead: resume " << transfer->Source
+                            << " from byte " << transfer->FileSize);
+    if (this->Start(self, transfer))
+      {
+      return true;
+      }
+    }
+
+  if (result == CURLE_OK)
+    {
+    vtkDebugWithObjectMacro(self, "StageFileRead: successful return from curl for " << transfer->Source);
+    transfer->Status = vtkHTTPHandler::Completed;
+    }
+  else
+    {
+    const char *stringError = curl_easy_strerror(result);
+    vtkErrorWithObjectMacro(self, "StageFileRead: error running curl: " << stringError
+                            << " for " << transfer->Source);
+    transfer->Status = vtkHTTPHandler::Failed;
+    }
+  this->Release(transfer);
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::Release(Transfer* transfer)
+{
+  if (transfer->Handle)
+    {
+    this->IdleHandles.push_back(transfer->Handle);
+    transfer->Handle = NULL;
+    }
+  if (transfer->File)
+    {
+    fclose(transfer->File);
+    transfer->File = NULL;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::vtkInternal::Run(vtkHTTPHandler* self, const std::vector<Transfer*>& transfers)
+{
+  if (this->Multi == NULL)
+    {
+    curl_global_init(CURL_GLOBAL_ALL);
+    this->Multi = curl_multi_init();
+    if (this->Multi == NULL)
+      {
+      vtkErrorWithObjectMacro(self, "StageFileRead: unable to initialise curl");
+      for (size_t i = 0; i < transfers.size(); ++i)
+        {
+        transfers[i]->Status = vtkHTTPHandler::Failed;
+        }
+      return static_cast<int>(transfers.size());
+      }
+    }
+
+  int failed = 0;
+  int active = 0;
+  size_t next = 0;
+  while (next < transfers.size() || active > 0)
+    {
+    for (; next < transfers.size() &&
+           active < self->GetMaximumNumberOfConcurrentTransfers(); ++next)
+      {
+      if (this->Start(self, transfers[next]))
+        {
+        ++active;
+        }
+      else
+        {
+        transfers[next]->Status = vtkHTTPHandler::Failed;
+        ++failed;
+        }
+      }
+
+    int stillRunning = 0;
+    while (curl_multi_perform(this->Multi, &stillRunning) == CURLM_CALL_MULTI_PERFORM)
+      {
+      }
+
+    CURLMsg* message = NULL;
+    int messagesLeft = 0;
+    while ((message = curl_multi_info_read(this->Multi, &messagesLeft)) != NULL)
+      {
+      if (message->msg != CURLMSG_DONE)
+        {
+        continue;
+        }
+      Transfer* transfer = NULL;
+      curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, reinterpret_cast<char**>(&transfer));
+      // message is invalid once the handle is removed from the multi handle
+      CURLcode result = message->data.result;
+      if (!this->Finish(self, transfer, result))
+        {
+        --active;
+        if (transfer->Status == vtkHTTPHandler::Failed)
+          {
+          ++failed;
+          }
+        }
+      }
+
+    if (stillRunning > 0)
+      {
+      // wait for activity on the sockets of the transfers
+      fd_set readSet;
+      fd_set writeSet;
+      fd_set errorSet;
+      FD_ZERO(&readSet);
+      FD_ZERO(&writeSet);
+      FD_ZERO(&errorSet);
+      int maxFd = -1;
+      long timeout = -1;
+      curl_multi_timeout(this->Multi, &timeout);
+      if (timeout < 0 || timeout > 100)
+        {
+        timeout = 100;
+        }
+      curl_multi_fdset(this->Multi, &readSet, &writeSet, &errorSet, &maxFd);
+      struct timeval wait;
+      wait.tv_sec = 0;
+      wait.tv_usec = timeout * 1000;
+      if (maxFd >= 0)
+        {
+        select(maxFd + 1, &readSet, &writeSet, &errorSet, &wait);
+        }
+      else if (timeout > 0)
+        {
+        // curl has no socket to wait on yet (e.g. resolving a name)
+#ifdef _WIN32
+        Sleep(timeout);
+#else
+        select(0, NULL, NULL, NULL, &wait);
+#endif
+        }
+      }
+    }
+  return failed;
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::vtkInternal::Queue(const char* source, const char* destination)
+{
+  Transfer transfer;
+  transfer.Source = source;
+  transfer.Destination = destination;
+  transfer.Status = vtkHTTPHandler::Queued;
+  transfer.Handle = NULL;
+  transfer.File = NULL;
+  transfer.FileSize = 0;
+  transfer.ResumeOffset = 0;
+  transfer.ResponseChecked = false;
+  transfer.Bytes = 0.;
+  transfer.Time = 0.;
+  transfer.Retries = 0;
+  transfer.Connections = 0;
+  this->Transfers.push_back(transfer);
+  return static_cast<int>(this->Transfers.size()) - 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::vtkInternal::RunQueued(vtkHTTPHandler* self)
+{
+  std::vector<Transfer*> transfers;
+  for (std::deque<Transfer>::iterator it = this->Transfers.begin();
+       it != this->Transfers.end(); ++it)
+    {
+    if (it->Status == vtkHTTPHandler::Queued)
+      {
+      transfers.push_back(&(*it));
+      }
+    }
+  int failed = this->Run(self, transfers);
+  //--- in case the permissions were not correct and that's
+  //--- the reason the read command failed,
+  //--- reset the 'remember check' in the permissions
+  //--- prompter so that new login info  will be prompted.
+  if (failed && self->GetPermissionPrompter() != NULL)
+    {
+    self->GetPermissionPrompter()->SetRemember ( 0 );
+    }
+  return failed;
+}
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro ( vtkHTTPHandler );
 vtkCxxRevisionMacro ( vtkHTTPHandler, "$Revision: 1.0 $" );
@@ -55,6 +438,9 @@ vtkHTTPHandler::vtkHTTPHandler()
 {
   this->CurlHandle = NULL;
   this->ForbidReuse = 0;
+  this->MaximumNumberOfConcurrentTransfers = 4;
+  this->MaximumNumberOfRetries = 3;
+  this->Internal = new vtkInternal;
 }
 
 
@@ -62,6 +448,7 @@ vtkHTTPHandler::vtkHTTPHandler()
 vtkHTTPHandler::~vtkHTTPHandler()
 {
   this->CurlHandle = NULL;
+  delete this->Internal;
 }
 
 
@@ -69,6 +456,11 @@ vtkHTTPHandler::~vtkHTTPHandler()
 void vtkHTTPHandler::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf ( os, indent );
+  os << indent << "ForbidReuse: " << this->ForbidReuse << "\n";
+  os << indent << "MaximumNumberOfConcurrentTransfers: "
+     << this->MaximumNumberOfConcurrentTransfers << "\n";
+  os << indent << "MaximumNumberOfRetries: " << this->MaximumNumberOfRetries << "\n";
+  os << indent << "NumberOfTransfers: " << this->GetNumberOfTransfers() << "\n";
 }
 
 
@@ -139,76 +531,180 @@ void vtkHTTPHandler::StageFileRead(const char * source, const char * destination
     vtkErrorMacro("StageFileRead: source or dest is null!");
     return;
     }
-  /*
-  if (this->LocalFile)
+  vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination);
+  vtkNew<vtkStringArray> sources;
+  sources->InsertNextValue(source);
+  vtkNew<vtkStringArray> destinations;
+  destinations->InsertNextValue(destination);
+  this->StageFileReads(sources.GetPointer(), destinations.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::StageFileReads(vtkStringArray* sources,
+                                   vtkStringArray* destinations,
+                                   vtkIntArray* succeeded)
+{
+  if (sources == NULL || destinations == NULL ||
+      sources->GetNumberOfValues() != destinations->GetNumberOfValues())
     {
-    this->LocalFile->close();
-    delete this->LocalFile;
-    this->LocalFile = NULL;
+    vtkErrorMacro("StageFileReads: sources and destinations don't match!");
+    return sources ? static_cast<int>(sources->GetNumberOfValues()) : 0;
+    }
+  const int numberOfFiles = static_cast<int>(sources->GetNumberOfValues());
+  if (succeeded)
+    {
+    succeeded->SetNumberOfComponents(1);
+    succeeded->SetNumberOfTuples(numberOfFiles);
     }
-  this->LocalFile = new std::ofstream(destination, std::ios::binary);
-  */
-  this->InitTransfer( );
 
+  this->Internal->Lock->Lock();
+  // The downloads are queued last, they are removed from the queue once done
+  // so that they leave no record.
+  const int first = static_cast<int>(this->Internal->Transfers.size());
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    this->Internal->Queue(sources->GetValue(i).c_str(),
+                          destinations->GetValue(i).c_str());
+    }
+  this->Internal->RunQueued(this);
+  int failed = 0;
+  for (int i = 0; i < numberOfFiles; ++i)
+    {
+    bool completed =
+      this->Internal->Transfers[first + i].Status == vtkHTTPHandler::Completed;
+    if (succeeded)
+      {
+      succeeded->SetValue(i, completed ? 1 : 0);
+      }
+    failed += completed ? 0 : 1;
+    }
+  this->Internal->Transfers.resize(first);
+  this->Internal->Lock->Unlock();
+  return failed;
+}
 
-  if ( this->ForbidReuse )
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::QueueFileRead(const char * source, const char * destination)
+{
+  if (source == NULL || destination == NULL)
     {
-    curl_easy_setopt(this->CurlHandle, CURLOPT_FORBID_REUSE, 1);
+    vtkErrorMacro("QueueFileRead: source or dest is null!");
+    return -1;
     }
-  curl_easy_setopt(this->CurlHandle, CURLOPT_HTTPGET, 1);
-  curl_easy_setopt(this->CurlHandle, CURLOPT_URL, source);
-//  curl_easy_setopt(this->CurlHandle, CURLOPT_NOPROGRESS, false);
-  curl_easy_setopt(this->CurlHandle, CURLOPT_FOLLOWLOCATION, true);
-  // use the default curl write call back
-  curl_easy_setopt(this->CurlHandle, CURLOPT_WRITEFUNCTION, NULL); // write_callback);
-  this->LocalFile = fopen(destination, "wb");
-  // output goes into LocalFile, must be  FILE*
-  curl_easy_setopt(this->CurlHandle, CURLOPT_WRITEDATA, this->LocalFile);
-//  curl_easy_setopt(this->CurlHandle, CURLOPT_PROGRESSDATA, NULL);
-//  curl_easy_setopt(this->CurlHandle, CURLOPT_PROGRESSFUNCTION, ProgressCallback);
+  this->Internal->Lock->Lock();
+  int index = this->Internal->Queue(source, destination);
+  this->Internal->Lock->Unlock();
+  return index;
+}
 
-  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
-  curl_easy_setopt(this->CurlHandle, CURLOPT_CONNECTTIMEOUT, 3); // in seconds (type long)
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::PerformQueuedFileReads()
+{
+  this->Internal->Lock->Lock();
+  int failed = this->Internal->RunQueued(this);
+  this->Internal->Lock->Unlock();
+  return failed;
+}
 
-  vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination);
-  CURLcode retval = curl_easy_perform(this->CurlHandle);
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::GetNumberOfTransfers()
+{
+  return static_cast<int>(this->Internal->Transfers.size());
+}
+
+//----------------------------------------------------------------------------
+const char* vtkHTTPHandler::GetTransferSource(int transfer)
+{
+  if (transfer < 0 || transfer >= this->GetNumberOfTransfers())
+    {
+    return NULL;
+    }
+  return this->Internal->Transfers[transfer].Source.c_str();
+}
+
+//----------------------------------------------------------------------------
+const char* vtkHTTPHandler::GetTransferDestination(int transfer)
+{
+  if (transfer < 0 || transfer >= this->GetNumberOfTransfers())
+    {
+    return NULL;
+    }
+  return this->Internal->Transfers[transfer].Destination.c_str();
+}
 
-  if (retval == CURLE_OK)
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::GetTransferStatus(int transfer)
+{
+  if (transfer < 0 || transfer >= this->GetNumberOfTransfers())
     {
-    vtkDebugMacro("StageFileRead: successful return from curl");
+    return vtkHTTPHandler::Failed;
     }
-  else if (retval == CURLE_BAD_FUNCTION_ARGUMENT)
+  return this->Internal->Transfers[transfer].Status;
+}
+
+//----------------------------------------------------------------------------
+double vtkHTTPHandler::GetTransferBytes(int transfer)
+{
+  if (transfer < 0 || transfer >= this->GetNumberOfTransfers())
     {
-    vtkErrorMacro("StageFileRead: bad function argument to curl, did you init CurlHandle?");
+    return 0.;
     }
-  else if (retval == CURLE_OUT_OF_MEMORY)
+  return this->Internal->Transfers[transfer].Bytes;
+}
+
+//----------------------------------------------------------------------------
+double vtkHTTPHandler::GetTransferTime(int transfer)
+{
+  if (transfer < 0 || transfer >= this->GetNumberOfTransfers())
     {
-    vtkErrorMacro("StageFileRead: curl ran out of memory!");
+    return 0.;
     }
-  else
+  return this->Internal->Transfers[transfer].Time;
+}
+
+//----------------------------------------------------------------------------
+double vtkHTTPHandler::GetTransferThroughput(int transfer)
+{
+  double time = this->GetTransferTime(transfer);
+  return time > 0. ? this->GetTransferBytes(transfer) / time : 0.;
+}
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::GetTransferNumberOfRetries(int transfer)
+{
+  if (transfer < 0 || transfer >= this->GetNumberOfTransfers())
     {
-    const char *stringError = curl_easy_strerror(retval);
-    vtkErrorMacro("StageFileRead: error running curl: " << stringError);
-    //--- in case the permissions were not correct and that's
-    //--- the reason the read command failed,
-    //--- reset the 'remember check' in the permissions
-    //--- prompter so that new login info  will be prompted.
-    if ( this->GetPermissionPrompter() != NULL )
-      {
-      this->GetPermissionPrompter()->SetRemember ( 0 );
-      }
+    return 0;
     }
-  this->CloseTransfer();
+  return this->Internal->Transfers[transfer].Retries;
+}
 
-  /*
-  this->LocalFile->close();
-  delete this->LocalFile;
-  this->LocalFile = NULL;
-  */
-  if (this->LocalFile)
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::GetTransferNumberOfConnections(int transfer)
+{
+  if (transfer < 0 || transfer >= this->GetNumberOfTransfers())
     {
-    fclose(this->LocalFile);
+    return 0;
+    }
+  return static_cast<int>(this->Internal->Transfers[transfer].Connections);
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::ClearTransfers()
+{
+  this->Internal->Lock->Lock();
+  std::deque<vtkInternal::Transfer> transfers;
+  for (std::deque<vtkInternal::Transfer>::iterator it = this->Internal->Transfers.begin();
+       it != this->Internal->Transfers.end(); ++it)
+    {
+    if (it->Status == vtkHTTPHandler::Queued ||
+        it->Status == vtkHTTPHandler::Running)
+      {
+      transfers.push_back(*it);
+      }
     }
+  this->Internal->Transfers.swap(transfers);
+  this->Internal->Lock->Unlock();
 }
 
 
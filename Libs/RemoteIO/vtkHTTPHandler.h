@@ -15,6 +15,32 @@
 //--- derived from libMRML class
 #include "vtkURIHandler.h"
 
+/// \brief Download and upload files over HTTP with libcurl.
+///
+/// The downloads go through a curl multi handle that is kept alive with
+/// the handler: successive and concurrent downloads reuse the open (keep
+/// alive) connections of the servers instead of paying a new connection
+/// and handshake per file, unless ForbidReuse is set.
+///
+/// Several downloads can be queued with QueueFileRead() and run in
+/// parallel by PerformQueuedFileReads(), at most
+/// MaximumNumberOfConcurrentTransfers at a time. A download interrupted
+/// after it received data is retried MaximumNumberOfRetries times and
+/// resumes where it stopped with a HTTP range request (it starts over if
+/// the server doesn't support ranges).
+///
+/// StageFileReads() queues several downloads, runs them and removes them
+/// from the queue: the data IO manager downloads all the files of a storage
+/// node at once this way.
+///
+/// Every download queued with QueueFileRead() is recorded with its status,
+/// the number of bytes received, the time spent and the number of
+/// connections opened, until ClearTransfers() is called.
+/// The downloads can be staged from several threads, they run one call at a
+/// time. The statistics must not be read while another thread stages
+/// downloads.
+/// Any URL supported by curl works, e.g. file:// URLs can stand in for a
+/// HTTP server.
 class VTK_RemoteIO_EXPORT vtkHTTPHandler : public vtkURIHandler 
 {
   public:
@@ -37,15 +63,73 @@ class VTK_RemoteIO_EXPORT vtkHTTPHandler : public vtkURIHandler
   vtkSetMacro(ForbidReuse, int);
   vtkGetMacro(ForbidReuse, int);
 
+  /// 
+  /// Maximum number of downloads running at the same time in
+  /// PerformQueuedFileReads(). 4 by default.
+  vtkSetClampMacro(MaximumNumberOfConcurrentTransfers, int, 1, 64);
+  vtkGetMacro(MaximumNumberOfConcurrentTransfers, int);
+
+  /// 
+  /// Number of times an interrupted download is resumed before failing.
+  /// 3 by default.
+  vtkSetClampMacro(MaximumNumberOfRetries, int, 0, 100);
+  vtkGetMacro(MaximumNumberOfRetries, int);
+
   /// 
   /// This function wraps curl functionality to download a specified URL to a specified dir
   void StageFileRead(const char * source, const char * destination);
   using vtkURIHandler::StageFileRead;
+  virtual int StageFileReads(vtkStringArray* sources,
+                             vtkStringArray* destinations,
+                             vtkIntArray* succeeded = 0);
   void StageFileWrite(const char * source, const char * destination);
   using vtkURIHandler::StageFileWrite;
   virtual void InitTransfer ( );
   virtual int CloseTransfer ( );
 
+  /// 
+  /// Add a download to the queue, it is run by the next call to
+  /// PerformQueuedFileReads(). Returns the index of the transfer.
+  int QueueFileRead(const char * source, const char * destination);
+
+  /// 
+  /// Run all the queued downloads concurrently and return once they are
+  /// all done. Returns the number of downloads that failed. The downloads
+  /// stay recorded until ClearTransfers() is called.
+  int PerformQueuedFileReads();
+
+  enum TransferStatus
+    {
+    Queued = 0,
+    Running,
+    Completed,
+    Failed
+    };
+
+  /// 
+  /// Statistics of the downloads, by index in the order they were queued
+  /// or staged.
+  int GetNumberOfTransfers();
+  const char* GetTransferSource(int transfer);
+  const char* GetTransferDestination(int transfer);
+  int GetTransferStatus(int transfer);
+  /// Number of bytes received, including the retries
+  double GetTransferBytes(int transfer);
+  /// Time spent downloading in seconds, including the retries
+  double GetTransferTime(int transfer);
+  /// Average download speed in bytes per second
+  double GetTransferThroughput(int transfer);
+  /// Number of times the download was resumed
+  int GetTransferNumberOfRetries(int transfer);
+  /// Number of connections opened by the download, 0 if it reused a
+  /// connection for all its requests
+  int GetTransferNumberOfConnections(int transfer);
+
+  /// 
+  /// Forget the statistics of the completed and failed transfers. The
+  /// transfers still queued are renumbered from 0.
+  void ClearTransfers();
+
   CURL* CurlHandle;  
 
  private:
@@ -57,6 +141,11 @@ class VTK_RemoteIO_EXPORT vtkHTTPHandler : public vtkURIHandler
   void operator=(const vtkHTTPHandler&);
 
   int ForbidReuse;
+  int MaximumNumberOfConcurrentTransfers;
+  int MaximumNumberOfRetries;
+
+  class vtkInternal;
+  vtkInternal* Internal;
 
 };
 
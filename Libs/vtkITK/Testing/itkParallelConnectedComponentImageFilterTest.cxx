@@ -0,0 +1,275 @@
+// vtkITK includes
+#include "itkParallelConnectedComponentImageFilter.h"
+
+// ITK includes
+#include "itkConnectedComponentImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Compare itk::ParallelConnectedComponentImageFilter with the components
+// found by itk::ConnectedComponentImageFilter, labeled and measured
+// independently of the number of threads.
+
+typedef itk::Image<unsigned char, 3> InputImageType;
+typedef itk::Image<unsigned short, 3> OutputImageType;
+typedef itk::ParallelConnectedComponentImageFilter<InputImageType, OutputImageType> FilterType;
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct Component
+{
+  Component() : Size(0), First(-1) {}
+  unsigned long Size;
+  long First;
+  InputImageType::IndexType Min;
+  InputImageType::IndexType Max;
+  double Sum[3];
+};
+
+//----------------------------------------------------------------------------
+class ComponentCompare
+{
+public:
+  ComponentCompare(const std::vector<Component>& components, bool sortBySize)
+    : Components(components), SortBySize(sortBySize) {}
+  bool operator()(size_t a, size_t b) const
+    {
+    if (this->SortBySize &&
+        this->Components[a].Size != this->Components[b].Size)
+      {
+      return this->Components[a].Size > this->Components[b].Size;
+      }
+    return this->Components[a].First < this->Components[b].First;
+    }
+  const std::vector<Component>& Components;
+  bool SortBySize;
+};
+
+//----------------------------------------------------------------------------
+// Pseudo-random foreground with a U that only connects through the last
+// slices, so that slabs merge components found in their neighbors.
+InputImageType::Pointer CreateImage(const InputImageType::SizeType& size)
+{
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  unsigned int seed = 12345;
+  itk::ImageRegionIterator<InputImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    seed = seed * 1103515245 + 12345;
+    it.Set(((seed >> 16) % 100) < 30 ? 1 : 0);
+    }
+  const long last = static_cast<long>(size[2]) - 1;
+  for (long z = 0; z <= last; ++z)
+    {
+    InputImageType::IndexType index;
+    index[1] = 1;
+    index[2] = z;
+    for (long x = 1; x <= 5; ++x)
+      {
+      index[0] = x;
+      image->SetPixel(index, (x == 1 || x == 5 || z == last) ? 1 : 0);
+      }
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+bool TestFilter(InputImageType* image, bool fullyConnected, bool sortBySize,
+                unsigned long minimumSize, int numberOfThreads)
+{
+  typedef itk::ConnectedComponentImageFilter<InputImageType, OutputImageType> ReferenceFilterType;
+  ReferenceFilterType::Pointer reference = ReferenceFilterType::New();
+  reference->SetInput(image);
+  reference->SetFullyConnected(fullyConnected);
+  reference->Update();
+  OutputImageType* referenceLabels = reference->GetOutput();
+
+  // Measure the reference components
+  std::vector<Component> components(1);
+  itk::ImageRegionConstIterator<OutputImageType> ref(
+    referenceLabels, referenceLabels->GetLargestPossibleRegion());
+  long offset = 0;
+  for (ref.GoToBegin(); !ref.IsAtEnd(); ++ref, ++offset)
+    {
+    const unsigned short label = ref.Get();
+    if (label == 0)
+      {
+      continue;
+      }
+    if (label >= components.size())
+      {
+      components.resize(label + 1);
+      }
+    Component& component = components[label];
+    const InputImageType::IndexType index = ref.GetIndex();
+    if (component.Size == 0)
+      {
+      component.First = offset;
+      component.Min = index;
+      component.Max = index;
+      component.Sum[0] = component.Sum[1] = component.Sum[2] = 0.;
+      }
+    ++component.Size;
+    for (unsigned int d = 0; d < 3; ++d)
+      {
+      component.Min[d] = std::min(component.Min[d], index[d]);
+      component.Max[d] = std::max(component.Max[d], index[d]);
+      component.Sum[d] += index[d];
+      }
+    }
+
+  // Expected output labels
+  std::vector<size_t> objects;
+  for (size_t label = 1; label < components.size(); ++label)
+    {
+    if (components[label].Size > 0)
+      {
+      objects.push_back(label);
+      }
+    }
+  const unsigned long originalNumberOfObjects = objects.size();
+  std::sort(objects.begin(), objects.end(), ComponentCompare(components, sortBySize));
+  std::vector<unsigned short> expectedLabels(components.size(), 0);
+  std::vector<size_t> expectedObjects;
+  for (size_t o = 0; o < objects.size(); ++o)
+    {
+    if (components[objects[o]].Size >= minimumSize)
+      {
+      expectedObjects.push_back(objects[o]);
+      expectedLabels[objects[o]] = static_cast<unsigned short>(expectedObjects.size());
+      }
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetFullyConnected(fullyConnected);
+  filter->SetSortObjectsBySize(sortBySize);
+  filter->SetMinimumObjectSize(minimumSize);
+  filter->SetNumberOfThreads(numberOfThreads);
+  filter->Update();
+
+  if (filter->GetOriginalNumberOfObjects() != originalNumberOfObjects ||
+      filter->GetNumberOfObjects() != expectedObjects.size() ||
+      filter->GetSizeOfObjectsInPixels().size() != expectedObjects.size())
+    {
+    std::cerr << "Line " << __LINE__ << ": " << filter->GetNumberOfObjects()
+              << " objects out of " << filter->GetOriginalNumberOfObjects()
+              << " instead of " << expectedObjects.size() << " out of "
+              << originalNumberOfObjects << std::endl;
+    return false;
+    }
+
+  itk::ImageRegionConstIterator<OutputImageType> out(
+    filter->GetOutput(), filter->GetOutput()->GetLargestPossibleRegion());
+  for (ref.GoToBegin(), out.GoToBegin(); !out.IsAtEnd(); ++ref, ++out)
+    {
+    if (out.Get() != expectedLabels[ref.Get()])
+      {
+      std::cerr << "Line " << __LINE__ << ": label " << out.Get() << " at "
+                << out.GetIndex() << " instead of " << expectedLabels[ref.Get()]
+                << std::endl;
+      return false;
+      }
+    }
+
+  for (size_t o = 0; o < expectedObjects.size(); ++o)
+    {
+    const Component& component = components[expectedObjects[o]];
+    const unsigned short label = static_cast<unsigned short>(o + 1);
+    const FilterType::RegionType boundingBox = filter->GetBoundingBoxOfObject(label);
+    const FilterType::CentroidType centroid = filter->GetCentroidOfObject(label);
+    bool same = (filter->GetSizeOfObjectInPixels(label) == component.Size);
+    for (unsigned int d = 0; d < 3; ++d)
+      {
+      same = same &&
+        boundingBox.GetIndex()[d] == component.Min[d] &&
+        static_cast<long>(boundingBox.GetSize()[d]) == component.Max[d] - component.Min[d] + 1 &&
+        std::fabs(centroid[d] - component.Sum[d] / component.Size) < 1e-9;
+      }
+    if (!same)
+      {
+      std::cerr << "Line " << __LINE__ << ": wrong measures of label " << label
+                << ": size " << filter->GetSizeOfObjectInPixels(label)
+                << " instead of " << component.Size << ", bounding box "
+                << boundingBox << ", centroid " << centroid << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main( int, char** )
+{
+  InputImageType::SizeType size;
+  size[0] = 23;
+  size[1] = 17;
+  size[2] = 19;
+  InputImageType::Pointer image = CreateImage(size);
+
+  // A single slice is split along its rows
+  InputImageType::SizeType sliceSize;
+  sliceSize[0] = 41;
+  sliceSize[1] = 29;
+  sliceSize[2] = 1;
+  InputImageType::Pointer slice = CreateImage(sliceSize);
+
+  InputImageType* images[2] = {image, slice};
+  const int threads[6] = {1, 2, 3, 5, 8, 32};
+  const unsigned long minimumSizes[2] = {0, 4};
+  for (int i = 0; i < 2; ++i)
+    {
+    for (int t = 0; t < 6; ++t)
+      {
+      for (int fullyConnected = 0; fullyConnected < 2; ++fullyConnected)
+        {
+        for (int sortBySize = 0; sortBySize < 2; ++sortBySize)
+          {
+          for (int m = 0; m < 2; ++m)
+            {
+            if (!TestFilter(images[i], fullyConnected != 0, sortBySize != 0,
+                            minimumSizes[m], threads[t]))
+              {
+              std::cerr << "Image " << i << ", " << threads[t] << " threads, "
+                        << (fullyConnected ? "fully connected, " : "face connected, ")
+                        << (sortBySize ? "sorted by size, " : "raster order, ")
+                        << "minimum size " << minimumSizes[m] << std::endl;
+              return EXIT_FAILURE;
+              }
+            }
+          }
+        }
+      }
+    }
+
+  // The U is one component in all the slabs
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetNumberOfThreads(4);
+  filter->Update();
+  InputImageType::IndexType left = {{1, 1, 0}};
+  InputImageType::IndexType right = {{5, 1, 0}};
+  const unsigned short label = filter->GetOutput()->GetPixel(left);
+  if (label == 0 || filter->GetOutput()->GetPixel(right) != label ||
+      filter->GetBoundingBoxOfObject(label).GetSize()[2] != size[2])
+    {
+    std::cerr << "Line " << __LINE__ << ": the U is split across the slabs" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "PASSED" << std::endl;
+  return EXIT_SUCCESS;
+}
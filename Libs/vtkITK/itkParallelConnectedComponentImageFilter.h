@@ -0,0 +1,252 @@
+#ifndef __itkParallelConnectedComponentImageFilter_h
+#define __itkParallelConnectedComponentImageFilter_h
+
+#include "itkImage.h"
+#include "itkImageToImageFilter.h"
+#include "itkContinuousIndex.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** /class ParallelConnectedComponentImageFilter
+ * \brief Label the connected components of a binary image and measure them.
+ *
+ * ParallelConnectedComponentImageFilter combines
+ * ConnectedComponentImageFilter and RelabelComponentImageFilter:
+ * every non zero pixel of the input is foreground, the connected
+ * components are labeled 1..N in the raster order of their first pixel,
+ * as ConnectedComponentImageFilter does, or by decreasing size if
+ * SortObjectsBySize is set (ties are broken by the raster order), and the
+ * components smaller than MinimumObjectSize are set to 0.
+ *
+ * The image is split into slabs along its last non singleton
+ * dimension. Each thread labels its slab with a union-find raster
+ * scan and accumulates the size, bounding box and centroid of its
+ * provisional labels. The components are then merged across the slab
+ * boundaries and each thread writes the output labels of its slab
+ * through a lookup table: there is no separate pass to count the
+ * component sizes nor to remove the small components.
+ *
+ * The size, bounding box and centroid (in index space) of the
+ * remaining components are available after the update.
+ */
+
+template <class TInputImage, class TOutputImage>
+class ParallelConnectedComponentImageFilter:public ImageToImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelConnectedComponentImageFilter Self;
+  typedef ImageToImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef SmartPointer<Self> Pointer;
+  typedef SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods).  */
+  itkTypeMacro(ParallelConnectedComponentImageFilter,
+               ImageToImageFilter);
+
+  /** Image related typedefs. */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  typedef TInputImage InputImageType;
+  typedef typename InputImageType::Pointer InputImagePointer;
+  typedef typename InputImageType::ConstPointer InputImageConstPointer;
+  typedef typename InputImageType::PixelType InputImagePixelType;
+  typedef typename InputImageType::RegionType RegionType;
+  typedef typename InputImageType::IndexType IndexType;
+  typedef typename InputImageType::SizeType SizeType;
+  typedef typename IndexType::IndexValueType IndexValueType;
+  typedef typename SizeType::SizeValueType ObjectSizeType;
+
+  typedef TOutputImage OutputImageType;
+  typedef typename OutputImageType::Pointer OutputImagePointer;
+  typedef typename OutputImageType::PixelType OutputImagePixelType;
+
+  typedef ContinuousIndex<double, itkGetStaticConstMacro(ImageDimension)> CentroidType;
+
+  void PrintSelf ( std::ostream& os, Indent indent ) const;
+
+  /// If true, pixels touching by a vertex or an edge are connected.
+  /// Otherwise only pixels sharing a face are connected. False by default.
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /// Components with fewer pixels than MinimumObjectSize are removed
+  /// from the output. 0 by default.
+  itkSetMacro(MinimumObjectSize, ObjectSizeType);
+  itkGetConstMacro(MinimumObjectSize, ObjectSizeType);
+
+  /// If true, the components are labeled by decreasing size, as
+  /// RelabelComponentImageFilter does. Otherwise they are labeled in the
+  /// raster order of their first pixel. False by default.
+  itkSetMacro(SortObjectsBySize, bool);
+  itkGetConstMacro(SortObjectsBySize, bool);
+  itkBooleanMacro(SortObjectsBySize);
+
+  /// Number of components in the output (after the size filtering)
+  itkGetConstMacro(NumberOfObjects, ObjectSizeType);
+
+  /// Number of components before the size filtering
+  itkGetConstMacro(OriginalNumberOfObjects, ObjectSizeType);
+
+  /// Number of pixels of the components, element i is the size of label i+1
+  const std::vector<ObjectSizeType>& GetSizeOfObjectsInPixels() const
+    { return m_SizeOfObjectsInPixels; }
+
+  /// Number of pixels of a component, 0 if there is no such label
+  ObjectSizeType GetSizeOfObjectInPixels(OutputImagePixelType label) const;
+
+  /// Smallest region containing a component, empty if there is no such label
+  RegionType GetBoundingBoxOfObject(OutputImagePixelType label) const;
+
+  /// Centroid of a component in index space
+  CentroidType GetCentroidOfObject(OutputImagePixelType label) const;
+
+protected:
+  ParallelConnectedComponentImageFilter();
+  ~ParallelConnectedComponentImageFilter(){}
+
+  /// Override since the filter needs all the data for the algorithm
+  void GenerateInputRequestedRegion();
+
+  /// Override since the filter produces the entire dataset
+  void EnlargeOutputRequestedRegion(DataObject *output);
+
+  void GenerateData();
+
+  /// Provisional labels are local to a slab
+  typedef unsigned int ProvisionalLabelType;
+
+  /// Measures of a provisional label or a component
+  struct ObjectStatistics
+    {
+    ObjectSizeType Size;
+    /// Offset of the first pixel in raster order, used to sort the
+    /// components of same size
+    OffsetValueType First;
+    IndexValueType Min[ImageDimension];
+    IndexValueType Max[ImageDimension];
+    double Sum[ImageDimension];
+    };
+
+  struct Slab
+    {
+    /// First and last+1 index along the split dimension
+    IndexValueType Begin;
+    IndexValueType End;
+    /// Union-find forest of the provisional labels, 0 is the background
+    std::vector<ProvisionalLabelType> Parents;
+    std::vector<ObjectStatistics> Statistics;
+    /// Provisional label -> component of the slab after flattening,
+    /// then -> output label
+    std::vector<ObjectSizeType> Labels;
+    ObjectSizeType NumberOfComponents;
+    };
+
+  enum Step
+    {
+    LabelSlabs,
+    WriteOutput
+    };
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /// Raster scan of a slab: set provisional labels and statistics
+  void LabelSlab(Slab& slab);
+  /// Union the components across the slab boundaries, sort and filter
+  /// them and build the lookup table of each slab
+  void MergeSlabs();
+  /// Write the output labels of a slab through its lookup table
+  void WriteSlab(const Slab& slab);
+
+  /// Neighbors preceding the current pixel in raster order
+  void ComputePreviousNeighbors(const SizeType& size);
+
+  /// Root of a label in a union-find forest, with path halving
+  template <class TLabel>
+  static TLabel Find(std::vector<TLabel>& parents, TLabel label)
+    {
+    while (parents[label] != label)
+      {
+      parents[label] = parents[parents[label]];
+      label = parents[label];
+      }
+    return label;
+    }
+
+  /// Merge the trees of two labels. The smallest root becomes the root of
+  /// the merged tree, so a root is never larger than the labels of its tree.
+  template <class TLabel>
+  static TLabel Union(std::vector<TLabel>& parents, TLabel a, TLabel b)
+    {
+    a = Find(parents, a);
+    b = Find(parents, b);
+    if (a < b)
+      {
+      parents[b] = a;
+      return a;
+      }
+    parents[a] = b;
+    return b;
+    }
+
+  /// Sort the components by raster order, or by decreasing size then by
+  /// raster order as RelabelComponentImageFilter does with the output of
+  /// ConnectedComponentImageFilter.
+  class ObjectCompare
+    {
+  public:
+    ObjectCompare(const std::vector<ObjectStatistics>& statistics, bool sortBySize)
+      : Statistics(statistics), SortBySize(sortBySize) {}
+    bool operator()(size_t a, size_t b) const
+      {
+      if (this->SortBySize &&
+          this->Statistics[a].Size != this->Statistics[b].Size)
+        {
+        return this->Statistics[a].Size > this->Statistics[b].Size;
+        }
+      return this->Statistics[a].First < this->Statistics[b].First;
+      }
+    const std::vector<ObjectStatistics>& Statistics;
+    bool SortBySize;
+    };
+
+private:
+  ParallelConnectedComponentImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  bool m_FullyConnected;
+  bool m_SortObjectsBySize;
+  ObjectSizeType m_MinimumObjectSize;
+  ObjectSizeType m_NumberOfObjects;
+  ObjectSizeType m_OriginalNumberOfObjects;
+
+  std::vector<ObjectSizeType> m_SizeOfObjectsInPixels;
+  std::vector<RegionType> m_BoundingBoxOfObjects;
+  std::vector<CentroidType> m_CentroidOfObjects;
+
+  // Internal state of the update
+  Step m_Step;
+  unsigned int m_SplitDimension;
+  OffsetValueType m_Strides[ImageDimension];
+  std::vector<OffsetValueType> m_NeighborOffsets;
+  std::vector<int> m_NeighborShifts; // ImageDimension ints per neighbor
+  std::vector<ProvisionalLabelType> m_ProvisionalLabels;
+  std::vector<Slab> m_Slabs;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelConnectedComponentImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,552 @@
+#ifndef __itkParallelConnectedComponentImageFilter_txx_
+#define __itkParallelConnectedComponentImageFilter_txx_
+
+#include "itkParallelConnectedComponentImageFilter.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <class TInputImage, class TOutputImage>
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::ParallelConnectedComponentImageFilter()
+{
+  m_FullyConnected = false;
+  m_SortObjectsBySize = false;
+  m_MinimumObjectSize = 0;
+  m_NumberOfObjects = 0;
+  m_OriginalNumberOfObjects = 0;
+  m_Step = LabelSlabs;
+  m_SplitDimension = 0;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+    m_Strides[d] = 0;
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  os << indent << "SortObjectsBySize: " << m_SortObjectsBySize << std::endl;
+  os << indent << "MinimumObjectSize: " << m_MinimumObjectSize << std::endl;
+  os << indent << "NumberOfObjects: " << m_NumberOfObjects << std::endl;
+  os << indent << "OriginalNumberOfObjects: " << m_OriginalNumberOfObjects << std::endl;
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+  if ( this->GetInput() )
+    {
+    InputImagePointer image = const_cast< InputImageType * >( this->GetInput() );
+    image->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::EnlargeOutputRequestedRegion(DataObject *output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <class TInputImage, class TOutputImage>
+typename ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>::ObjectSizeType
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::GetSizeOfObjectInPixels(OutputImagePixelType label) const
+{
+  if (label < 1 || static_cast<ObjectSizeType>(label) > m_SizeOfObjectsInPixels.size())
+    {
+    return 0;
+    }
+  return m_SizeOfObjectsInPixels[static_cast<ObjectSizeType>(label) - 1];
+}
+
+template <class TInputImage, class TOutputImage>
+typename ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>::RegionType
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::GetBoundingBoxOfObject(OutputImagePixelType label) const
+{
+  if (label < 1 || static_cast<ObjectSizeType>(label) > m_BoundingBoxOfObjects.size())
+    {
+    RegionType empty;
+    return empty;
+    }
+  return m_BoundingBoxOfObjects[static_cast<ObjectSizeType>(label) - 1];
+}
+
+template <class TInputImage, class TOutputImage>
+typename ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>::CentroidType
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::GetCentroidOfObject(OutputImagePixelType label) const
+{
+  if (label < 1 || static_cast<ObjectSizeType>(label) > m_CentroidOfObjects.size())
+    {
+    CentroidType centroid;
+    centroid.Fill(0.);
+    return centroid;
+    }
+  return m_CentroidOfObjects[static_cast<ObjectSizeType>(label) - 1];
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::ComputePreviousNeighbors(const SizeType& size)
+{
+  m_NeighborOffsets.clear();
+  m_NeighborShifts.clear();
+
+  // Enumerate the 3^N neighbors, keep the ones before the center in
+  // raster order: the last non zero shift is -1. Neighbors along the
+  // dimensions of size 1 are always outside of the image.
+  int shifts[ImageDimension];
+  unsigned int numberOfNeighbors = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+    numberOfNeighbors *= 3;
+    }
+  for (unsigned int n = 0; n < numberOfNeighbors; ++n)
+    {
+    unsigned int code = n;
+    int last = 0;
+    unsigned int nonZero = 0;
+    bool flat = false;
+    OffsetValueType offset = 0;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      shifts[d] = static_cast<int>(code % 3) - 1;
+      code /= 3;
+      if (shifts[d] != 0)
+        {
+        last = shifts[d];
+        ++nonZero;
+        flat = flat || size[d] == 1;
+        }
+      offset += shifts[d] * m_Strides[d];
+      }
+    if (last != -1 || flat || (!m_FullyConnected && nonZero != 1))
+      {
+      continue;
+      }
+    m_NeighborOffsets.push_back(offset);
+    m_NeighborShifts.insert(m_NeighborShifts.end(), shifts, shifts + ImageDimension);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  m_NumberOfObjects = 0;
+  m_OriginalNumberOfObjects = 0;
+  m_SizeOfObjectsInPixels.clear();
+  m_BoundingBoxOfObjects.clear();
+  m_CentroidOfObjects.clear();
+
+  this->AllocateOutputs();
+
+  const InputImageType* input = this->GetInput();
+  const SizeType size = input->GetBufferedRegion().GetSize();
+
+  OffsetValueType numberOfPixels = 1;
+  m_SplitDimension = 0;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+    m_Strides[d] = numberOfPixels;
+    numberOfPixels *= static_cast<OffsetValueType>(size[d]);
+    if (size[d] > 1)
+      {
+      m_SplitDimension = d;
+      }
+    }
+  if (numberOfPixels == 0)
+    {
+    return;
+    }
+  this->ComputePreviousNeighbors(size);
+
+  // Split the image in slabs, at most one per thread
+  IndexValueType length = static_cast<IndexValueType>(size[m_SplitDimension]);
+  IndexValueType numberOfSlabs = std::max(1, std::min(
+    static_cast<int>(this->GetNumberOfThreads()), static_cast<int>(length)));
+  m_Slabs.clear();
+  m_Slabs.resize(numberOfSlabs);
+  for (IndexValueType s = 0; s < numberOfSlabs; ++s)
+    {
+    m_Slabs[s].Begin = s * length / numberOfSlabs;
+    m_Slabs[s].End = (s + 1) * length / numberOfSlabs;
+    m_Slabs[s].NumberOfComponents = 0;
+    }
+  m_ProvisionalLabels.resize(numberOfPixels);
+
+  MultiThreader* threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads(static_cast<int>(numberOfSlabs));
+  threader->SetSingleMethod(Self::ThreaderCallback, this);
+
+  m_Step = LabelSlabs;
+  threader->SingleMethodExecute();
+  this->UpdateProgress(0.5);
+
+  try
+    {
+    this->MergeSlabs();
+    }
+  catch (...)
+    {
+    m_Slabs.clear();
+    std::vector<ProvisionalLabelType>().swap(m_ProvisionalLabels);
+    throw;
+    }
+  this->UpdateProgress(0.6);
+
+  m_Step = WriteOutput;
+  threader->SingleMethodExecute();
+
+  // Release the internal buffers
+  m_Slabs.clear();
+  std::vector<ProvisionalLabelType>().swap(m_ProvisionalLabels);
+  this->UpdateProgress(1.0);
+}
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::ThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct* info =
+    static_cast<MultiThreader::ThreadInfoStruct*>(arg);
+  Self* self = static_cast<Self*>(info->UserData);
+  const size_t numberOfThreads = static_cast<size_t>(info->NumberOfThreads);
+
+  // The threader may run less threads than there are slabs
+  for (size_t s = static_cast<size_t>(info->ThreadID);
+       s < self->m_Slabs.size(); s += numberOfThreads)
+    {
+    if (self->m_Step == LabelSlabs)
+      {
+      self->LabelSlab(self->m_Slabs[s]);
+      }
+    else
+      {
+      self->WriteSlab(self->m_Slabs[s]);
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::LabelSlab(Slab& slab)
+{
+  const InputImageType* input = this->GetInput();
+  const InputImagePixelType* inPtr = input->GetBufferPointer();
+  const SizeType size = input->GetBufferedRegion().GetSize();
+  ProvisionalLabelType* labels = &m_ProvisionalLabels[0];
+  const size_t numberOfNeighbors = m_NeighborOffsets.size();
+  const InputImagePixelType zero = NumericTraits<InputImagePixelType>::Zero;
+
+  slab.Parents.assign(1, 0);
+  slab.Statistics.resize(1);
+
+  IndexValueType index[ImageDimension];
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+    index[d] = 0;
+    }
+  index[m_SplitDimension] = slab.Begin;
+
+  const OffsetValueType begin = slab.Begin * m_Strides[m_SplitDimension];
+  const OffsetValueType end = slab.End * m_Strides[m_SplitDimension];
+  for (OffsetValueType i = begin; i < end; ++i)
+    {
+    ProvisionalLabelType label = 0;
+    if (inPtr[i] != zero)
+      {
+      // Neighbors outside of the image or of the slab are only tested
+      // on the border of the slab
+      bool interior = index[m_SplitDimension] > slab.Begin;
+      for (unsigned int d = 0; d < ImageDimension && interior; ++d)
+        {
+        interior = size[d] == 1 ||
+          (index[d] > 0 && index[d] + 1 < static_cast<IndexValueType>(size[d]));
+        }
+      for (size_t n = 0; n < numberOfNeighbors; ++n)
+        {
+        if (!interior)
+          {
+          const int* shifts = &m_NeighborShifts[n * ImageDimension];
+          bool inside = true;
+          for (unsigned int d = 0; d < ImageDimension && inside; ++d)
+            {
+            IndexValueType neighbor = index[d] + shifts[d];
+            inside = neighbor >= (d == m_SplitDimension ? slab.Begin : 0) &&
+              neighbor < static_cast<IndexValueType>(size[d]);
+            }
+          if (!inside)
+            {
+            continue;
+            }
+          }
+        const ProvisionalLabelType neighborLabel = labels[i + m_NeighborOffsets[n]];
+        if (neighborLabel == 0)
+          {
+          continue;
+          }
+        label = (label == 0) ? neighborLabel :
+          Union(slab.Parents, label, neighborLabel);
+        }
+      if (label == 0)
+        {
+        label = static_cast<ProvisionalLabelType>(slab.Parents.size());
+        slab.Parents.push_back(label);
+        ObjectStatistics newStatistics;
+        newStatistics.Size = 0;
+        newStatistics.First = i;
+        for (unsigned int d = 0; d < ImageDimension; ++d)
+          {
+          newStatistics.Min[d] = index[d];
+          newStatistics.Max[d] = index[d];
+          newStatistics.Sum[d] = 0.;
+          }
+        slab.Statistics.push_back(newStatistics);
+        }
+      ObjectStatistics& statistics = slab.Statistics[label];
+      ++statistics.Size;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+        {
+        statistics.Min[d] = std::min(statistics.Min[d], index[d]);
+        statistics.Max[d] = std::max(statistics.Max[d], index[d]);
+        statistics.Sum[d] += index[d];
+        }
+      }
+    labels[i] = label;
+
+    // Next index in raster order
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      if (++index[d] < static_cast<IndexValueType>(size[d]) || d == ImageDimension - 1)
+        {
+        break;
+        }
+      index[d] = 0;
+      }
+    }
+
+  // Flatten the forest: number the components of the slab from 1 in the
+  // order of their first pixel and merge the statistics of their labels.
+  // The root of a tree is its smallest label so it is numbered first.
+  const size_t numberOfLabels = slab.Parents.size();
+  std::vector<ObjectStatistics> components(1);
+  slab.Labels.assign(numberOfLabels, 0);
+  for (size_t l = 1; l < numberOfLabels; ++l)
+    {
+    ProvisionalLabelType root = Find(
+      slab.Parents, static_cast<ProvisionalLabelType>(l));
+    const ObjectStatistics& statistics = slab.Statistics[l];
+    if (root == l)
+      {
+      slab.Labels[l] = components.size();
+      components.push_back(statistics);
+      continue;
+      }
+    slab.Labels[l] = slab.Labels[root];
+    ObjectStatistics& component = components[slab.Labels[l]];
+    component.Size += statistics.Size;
+    component.First = std::min(component.First, statistics.First);
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      component.Min[d] = std::min(component.Min[d], statistics.Min[d]);
+      component.Max[d] = std::max(component.Max[d], statistics.Max[d]);
+      component.Sum[d] += statistics.Sum[d];
+      }
+    }
+  slab.NumberOfComponents = components.size() - 1;
+  slab.Statistics.swap(components);
+  std::vector<ProvisionalLabelType>().swap(slab.Parents);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::MergeSlabs()
+{
+  const InputImageType* input = this->GetInput();
+  const SizeType size = input->GetBufferedRegion().GetSize();
+  const IndexType start = input->GetBufferedRegion().GetIndex();
+  const ProvisionalLabelType* labels = &m_ProvisionalLabels[0];
+
+  // Global numbering of the components of all the slabs, from 0
+  std::vector<ObjectSizeType> firstComponent(m_Slabs.size() + 1, 0);
+  for (size_t s = 0; s < m_Slabs.size(); ++s)
+    {
+    firstComponent[s + 1] = firstComponent[s] + m_Slabs[s].NumberOfComponents;
+    }
+  const ObjectSizeType numberOfComponents = firstComponent[m_Slabs.size()];
+  std::vector<ObjectSizeType> parents(numberOfComponents);
+  std::vector<ObjectStatistics> statistics(numberOfComponents);
+  for (size_t s = 0; s < m_Slabs.size(); ++s)
+    {
+    std::copy(m_Slabs[s].Statistics.begin() + 1, m_Slabs[s].Statistics.end(),
+              statistics.begin() + firstComponent[s]);
+    std::vector<ObjectStatistics>().swap(m_Slabs[s].Statistics);
+    }
+  for (ObjectSizeType c = 0; c < numberOfComponents; ++c)
+    {
+    parents[c] = c;
+    }
+
+  // Connect the first plane of each slab to the last plane of the
+  // previous slab
+  for (size_t s = 1; s < m_Slabs.size(); ++s)
+    {
+    const Slab& slab = m_Slabs[s];
+    const Slab& previousSlab = m_Slabs[s - 1];
+    IndexValueType index[ImageDimension];
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      index[d] = 0;
+      }
+    const OffsetValueType begin = slab.Begin * m_Strides[m_SplitDimension];
+    const OffsetValueType end = begin + m_Strides[m_SplitDimension];
+    for (OffsetValueType i = begin; i < end; ++i)
+      {
+      if (labels[i] != 0)
+        {
+        const ObjectSizeType component =
+          firstComponent[s] + slab.Labels[labels[i]] - 1;
+        for (size_t n = 0; n < m_NeighborOffsets.size(); ++n)
+          {
+          const int* shifts = &m_NeighborShifts[n * ImageDimension];
+          if (shifts[m_SplitDimension] != -1)
+            {
+            continue;
+            }
+          bool inside = true;
+          for (unsigned int d = 0; d < m_SplitDimension && inside; ++d)
+            {
+            IndexValueType neighbor = index[d] + shifts[d];
+            inside = neighbor >= 0 && neighbor < static_cast<IndexValueType>(size[d]);
+            }
+          const OffsetValueType j = i + m_NeighborOffsets[n];
+          if (!inside || labels[j] == 0)
+            {
+            continue;
+            }
+          Union(parents, component,
+            firstComponent[s - 1] + previousSlab.Labels[labels[j]] - 1);
+          }
+        }
+      for (unsigned int d = 0; d < m_SplitDimension; ++d)
+        {
+        if (++index[d] < static_cast<IndexValueType>(size[d]))
+          {
+          break;
+          }
+        index[d] = 0;
+        }
+      }
+    }
+
+  // Merge the statistics into the roots
+  std::vector<size_t> objects;
+  for (ObjectSizeType c = 0; c < numberOfComponents; ++c)
+    {
+    const ObjectSizeType root = Find(parents, c);
+    if (root == c)
+      {
+      objects.push_back(c);
+      continue;
+      }
+    ObjectStatistics& object = statistics[root];
+    object.Size += statistics[c].Size;
+    object.First = std::min(object.First, statistics[c].First);
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      object.Min[d] = std::min(object.Min[d], statistics[c].Min[d]);
+      object.Max[d] = std::max(object.Max[d], statistics[c].Max[d]);
+      object.Sum[d] += statistics[c].Sum[d];
+      }
+    }
+  m_OriginalNumberOfObjects = objects.size();
+
+  // Sort the objects and remove the small ones
+  std::sort(objects.begin(), objects.end(),
+            ObjectCompare(statistics, m_SortObjectsBySize));
+  std::vector<ObjectSizeType> outputLabels(numberOfComponents, 0);
+  for (size_t o = 0; o < objects.size(); ++o)
+    {
+    const ObjectStatistics& object = statistics[objects[o]];
+    if (object.Size < m_MinimumObjectSize)
+      {
+      if (m_SortObjectsBySize)
+        {
+        // the next objects are smaller
+        break;
+        }
+      continue;
+      }
+    outputLabels[objects[o]] = ++m_NumberOfObjects;
+
+    RegionType boundingBox;
+    CentroidType centroid;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      boundingBox.SetIndex(d, start[d] + object.Min[d]);
+      boundingBox.SetSize(d, object.Max[d] - object.Min[d] + 1);
+      centroid[d] = start[d] + object.Sum[d] / object.Size;
+      }
+    m_SizeOfObjectsInPixels.push_back(object.Size);
+    m_BoundingBoxOfObjects.push_back(boundingBox);
+    m_CentroidOfObjects.push_back(centroid);
+    }
+  if (m_NumberOfObjects > static_cast<ObjectSizeType>(
+        NumericTraits<OutputImagePixelType>::max()))
+    {
+    itkExceptionMacro(<< "Number of objects greater than maximum allowed by output pixel type");
+    }
+
+  // Lookup tables from the provisional labels to the output labels
+  for (size_t s = 0; s < m_Slabs.size(); ++s)
+    {
+    std::vector<ObjectSizeType>& slabLabels = m_Slabs[s].Labels;
+    for (size_t l = 1; l < slabLabels.size(); ++l)
+      {
+      slabLabels[l] = outputLabels[Find(
+        parents, firstComponent[s] + slabLabels[l] - 1)];
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParallelConnectedComponentImageFilter<TInputImage, TOutputImage>
+::WriteSlab(const Slab& slab)
+{
+  OutputImagePixelType* outPtr = this->GetOutput()->GetBufferPointer();
+  const ProvisionalLabelType* labels = &m_ProvisionalLabels[0];
+  const ObjectSizeType* lookup = &slab.Labels[0];
+  const OffsetValueType begin = slab.Begin * m_Strides[m_SplitDimension];
+  const OffsetValueType end = slab.End * m_Strides[m_SplitDimension];
+  for (OffsetValueType i = begin; i < end; ++i)
+    {
+    outPtr[i] = static_cast<OutputImagePixelType>(lookup[labels[i]]);
+    }
+}
+
+} // end namespace itk
+
+#endif
@@ -16,12 +16,14 @@
 #include "vtkObjectFactory.h"
 
 #include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
 #include "vtkPointData.h"
 #include "vtkImageData.h"
 #include "vtkProcessObject.h"
 
-#include "itkConnectedComponentImageFilter.h"
-#include "itkRelabelComponentImageFilter.h"
+#include "itkParallelConnectedComponentImageFilter.h"
 #include "itkCommand.h"
 
 vtkCxxRevisionMacro(vtkITKIslandMath, "$Revision: 1900 $");
@@ -36,10 +38,18 @@ vtkITKIslandMath::vtkITKIslandMath()
   this->NumberOfIslands = 0;
   this->OriginalNumberOfIslands = 0;
 
+  this->IslandSizes = vtkIdTypeArray::New();
+  this->IslandExtents = vtkIntArray::New();
+  this->IslandExtents->SetNumberOfComponents(6);
+  this->IslandCentroids = vtkDoubleArray::New();
+  this->IslandCentroids->SetNumberOfComponents(3);
 }
 
 vtkITKIslandMath::~vtkITKIslandMath()
 {
+  this->IslandSizes->Delete();
+  this->IslandExtents->Delete();
+  this->IslandCentroids->Delete();
 }
 
 void vtkITKIslandMath::PrintSelf(ostream& os, vtkIndent indent)
@@ -52,6 +62,7 @@ void vtkITKIslandMath::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "MaximumSize: " << MaximumSize << std::endl;
   os << indent << "NumberOfIslands: " << NumberOfIslands << std::endl;
   os << indent << "OriginalNumberOfIslands: " << OriginalNumberOfIslands << std::endl;
+  os << indent << "IslandSizes: " << IslandSizes->GetNumberOfTuples() << " islands" << std::endl;
 }
 
 // Note: local function not method - conforms to signature in itkCommand.h
@@ -102,27 +113,58 @@ void vtkITKIslandMathExecute(vtkITKIslandMath *self, vtkImageData* input,
 
 
   // Calculate the island operation
-  // ccfilter - identifies the islands
-  // relabel - sorts them by size
-  typedef itk::ConnectedComponentImageFilter<ImageType, ImageType> ConnectedComponentType;
+  // the filter identifies the islands, sorts them by size and measures
+  // them in a single multithreaded pass
+  typedef itk::ParallelConnectedComponentImageFilter<ImageType, ImageType> ConnectedComponentType;
   typename ConnectedComponentType::Pointer ccfilter = ConnectedComponentType::New();
-  typedef itk::RelabelComponentImageFilter<ImageType, ImageType> RelabelComponentType;
-  typename RelabelComponentType::Pointer relabel = RelabelComponentType::New();
 
   ccfilter->AddObserver(itk::ProgressEvent(), progressCommand);
-  relabel->AddObserver(itk::ProgressEvent(), progressCommand);
 
   ccfilter->SetFullyConnected(self->GetFullyConnected());
+  ccfilter->SortObjectsBySizeOn();
+  ccfilter->SetMinimumObjectSize( self->GetMinimumSize() );
   ccfilter->SetInput( inImage );
-  relabel->SetInput( ccfilter->GetOutput() );
-  relabel->SetMinimumObjectSize( self->GetMinimumSize() );
-  relabel->Update();
-  self->SetNumberOfIslands(relabel->GetNumberOfObjects());
-  self->SetOriginalNumberOfIslands(relabel->GetOriginalNumberOfObjects());
+  try
+    {
+    ccfilter->Update();
+    }
+  catch (itk::ExceptionObject &err)
+    {
+    // e.g. more islands than the scalar type can represent
+    vtkErrorWithObjectMacro(self, << "Failed to calculate the islands: " << err.GetDescription());
+    return;
+    }
+  self->SetNumberOfIslands(ccfilter->GetNumberOfObjects());
+  self->SetOriginalNumberOfIslands(ccfilter->GetOriginalNumberOfObjects());
+
+  vtkIdTypeArray* sizes = self->GetIslandSizes();
+  vtkIntArray* extents = self->GetIslandExtents();
+  vtkDoubleArray* centroids = self->GetIslandCentroids();
+  const vtkIdType numberOfIslands = static_cast<vtkIdType>(ccfilter->GetNumberOfObjects());
+  // the ITK image starts at index 0, the vtkImageData at its extent
+  int extent[6];
+  input->GetExtent(extent);
+  sizes->SetNumberOfTuples(numberOfIslands);
+  extents->SetNumberOfTuples(numberOfIslands);
+  centroids->SetNumberOfTuples(numberOfIslands);
+  for (vtkIdType i = 0; i < numberOfIslands; ++i)
+    {
+    const T label = static_cast<T>(i + 1);
+    sizes->SetValue(i, static_cast<vtkIdType>(ccfilter->GetSizeOfObjectInPixels(label)));
+    typename ImageType::RegionType box = ccfilter->GetBoundingBoxOfObject(label);
+    typename ConnectedComponentType::CentroidType centroid = ccfilter->GetCentroidOfObject(label);
+    for (int d = 0; d < 3; ++d)
+      {
+      extents->SetComponent(i, 2*d, extent[2*d] + box.GetIndex()[d]);
+      extents->SetComponent(i, 2*d + 1,
+                            extent[2*d] + box.GetIndex()[d] + box.GetSize()[d] - 1);
+      centroids->SetComponent(i, d, extent[2*d] + centroid[d]);
+      }
+    }
 
   // Copy to the output
-  memcpy(outPtr, relabel->GetOutput()->GetBufferPointer(),
-         relabel->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  memcpy(outPtr, ccfilter->GetOutput()->GetBufferPointer(),
+         ccfilter->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
 
 }
 
@@ -135,6 +177,12 @@ void vtkITKIslandMath::SimpleExecute(vtkImageData *input, vtkImageData *output)
 {
   vtkDebugMacro(<< "Executing Island Math");
 
+  this->NumberOfIslands = 0;
+  this->OriginalNumberOfIslands = 0;
+  this->IslandSizes->SetNumberOfTuples(0);
+  this->IslandExtents->SetNumberOfTuples(0);
+  this->IslandCentroids->SetNumberOfTuples(0);
+
   //
   // Initialize and check input
   //
@@ -13,7 +13,17 @@
 #include "vtkITK.h"
 #include "vtkSimpleImageToImageFilter.h"
 
+class vtkDoubleArray;
+class vtkIdTypeArray;
+class vtkIntArray;
+
 /// \brief ITK-based utilities for manipulating connected regions in label maps.
+///
+/// Every non zero voxel of the input is part of an island. The output
+/// labels the islands from 1 by decreasing size, islands smaller than
+/// MinimumSize are set to 0. The islands are labeled by multiple threads
+/// (see itk::ParallelConnectedComponentImageFilter) and their size, extent
+/// and centroid are computed in the same pass.
 class VTK_ITK_EXPORT vtkITKIslandMath : public vtkSimpleImageToImageFilter
 {
  public:
@@ -55,6 +65,18 @@ class VTK_ITK_EXPORT vtkITKIslandMath : public vtkSimpleImageToImageFilter
   vtkGetMacro(OriginalNumberOfIslands, unsigned long);
   vtkSetMacro(OriginalNumberOfIslands, unsigned long);
 
+  /// 
+  /// Number of voxels of each island, tuple i describes island i+1
+  vtkGetObjectMacro(IslandSizes, vtkIdTypeArray);
+
+  /// 
+  /// IJK extent (6 components) of each island, tuple i describes island i+1
+  vtkGetObjectMacro(IslandExtents, vtkIntArray);
+
+  /// 
+  /// IJK centroid (3 components) of each island, tuple i describes island i+1
+  vtkGetObjectMacro(IslandCentroids, vtkDoubleArray);
+
 
 protected:
   vtkITKIslandMath();
@@ -69,7 +91,11 @@ protected:
 
   unsigned long NumberOfIslands;
   unsigned long OriginalNumberOfIslands;
-  
+
+  vtkIdTypeArray* IslandSizes;
+  vtkIntArray* IslandExtents;
+  vtkDoubleArray* IslandCentroids;
+
 private:
   vtkITKIslandMath(const vtkITKIslandMath&);  /// Not implemented.
   void operator=(const vtkITKIslandMath&);  /// Not implemented.
@@ -25,6 +25,10 @@
 #include "itkMattesMutualInformationImageToImageMetric.h"
 #include "itkLBFGSBOptimizer.h"
 
+#include "itkBSplineDecompositionImageFilter.h"
+#include "itkBSplineResampleImageFunction.h"
+#include "itkIdentityTransform.h"
+#include "itkMultiResolutionPyramidImageFilter.h"
 #include "itkOrientImageFilter.h"
 #include "itkResampleImageFilter.h"
 
@@ -36,6 +40,9 @@
 
 #include "itkTimeProbesCollectorBase.h"
 
+#include <algorithm>
+#include <sstream>
+
 // Use an anonymous namespace to keep class types and function names
 // from colliding when module is used as shared object module.  Every
 // thing should be in an anonymous namespace except for the module
@@ -62,12 +69,20 @@ public:
     m_CostFunction = fn;
   }
 
+  /// Level of the pyramid printed in the metric trace
+  void SetLevel(unsigned int level)
+  {
+    m_Level = level;
+  }
+
 protected:
   CommandIterationUpdate()
   {
+    m_Level = 0;
   };
   itk::ProcessObject::Pointer m_Registration;
   CostFunctionType::Pointer   m_CostFunction;
+  unsigned int                m_Level;
 public:
   typedef itk::LBFGSBOptimizer OptimizerType;
   typedef OptimizerType *      OptimizerPointer;
@@ -87,6 +102,11 @@ public:
       return;
       }
 
+    // Metric trace
+    std::cout << "Level " << m_Level
+              << " iteration " << optimizer->GetCurrentIteration()
+              << " metric " << optimizer->GetValue() << std::endl;
+
     if( m_Registration )
       {
       m_Registration->UpdateProgress(
@@ -97,6 +117,97 @@ public:
 
 };
 
+// Place a grid with nodesOnImage nodes per dimension on the image.
+//
+//  Note that the B-spline computation requires a finite support
+//  region ( 1 grid node at the lower borders and 2 grid nodes at
+//  upper borders).
+template <class TTransform, class TImage>
+void SetGridOnImage(TTransform * transform, const TImage * image, unsigned int nodesOnImage)
+{
+  const unsigned int ImageDimension = TImage::ImageDimension;
+
+  typename TTransform::RegionType           bsplineRegion;
+  typename TTransform::RegionType::SizeType gridSizeOnImage;
+  typename TTransform::RegionType::SizeType gridBorderSize;
+  typename TTransform::RegionType::SizeType totalGridSize;
+
+  gridSizeOnImage.Fill( nodesOnImage );
+  gridBorderSize.Fill( 3 );    // Border for spline order = 3 ( 1 lower, 2 upper )
+  totalGridSize = gridSizeOnImage + gridBorderSize;
+
+  bsplineRegion.SetSize( totalGridSize );
+
+  typename TTransform::SpacingType spacing = image->GetSpacing();
+  typename TTransform::OriginType  origin = image->GetOrigin();
+
+  typename TImage::SizeType imageSize = image->GetLargestPossibleRegion().GetSize();
+  for( unsigned int r = 0; r < ImageDimension; r++ )
+    {
+    spacing[r] *= floor( static_cast<double>(imageSize[r] - 1)
+                         / static_cast<double>(gridSizeOnImage[r] - 1) );
+    origin[r]  -=  spacing[r];
+    }
+
+  transform->SetGridSpacing( spacing );
+  transform->SetGridOrigin( origin );
+  transform->SetGridRegion( bsplineRegion );
+}
+
+// Parameters of the fine transform that represent the same deformation
+// as the coarse transform: the coefficients of the coarse grid are
+// evaluated at the nodes of the fine grid and decomposed again into
+// B-spline coefficients.
+template <class TTransform>
+typename TTransform::ParametersType
+RefineGridParameters(const TTransform * coarse, const TTransform * fine)
+{
+  const unsigned int SpaceDimension = TTransform::SpaceDimension;
+
+  typedef typename TTransform::ImageType ParametersImageType;
+  typedef itk::ResampleImageFilter<ParametersImageType, ParametersImageType> ResamplerType;
+  typedef itk::BSplineResampleImageFunction<ParametersImageType, double>      FunctionType;
+  typedef itk::IdentityTransform<double, SpaceDimension>                       IdentityTransformType;
+  typedef itk::BSplineDecompositionImageFilter<ParametersImageType, ParametersImageType>
+    DecompositionType;
+
+  typename TTransform::ParametersType parameters( fine->GetNumberOfParameters() );
+  unsigned int                        parameterCounter = 0;
+  for( unsigned int k = 0; k < SpaceDimension; k++ )
+    {
+    typename ResamplerType::Pointer upsampler = ResamplerType::New();
+    typename FunctionType::Pointer function = FunctionType::New();
+    typename IdentityTransformType::Pointer identity = IdentityTransformType::New();
+
+#if ITK_VERSION_MAJOR >= 4
+    upsampler->SetInput( coarse->GetCoefficientImages()[k] );
+#else
+    upsampler->SetInput( coarse->GetCoefficientImage()[k] );
+#endif
+    upsampler->SetInterpolator( function );
+    upsampler->SetTransform( identity );
+    upsampler->SetSize( fine->GetGridRegion().GetSize() );
+    upsampler->SetOutputSpacing( fine->GetGridSpacing() );
+    upsampler->SetOutputOrigin( fine->GetGridOrigin() );
+    upsampler->SetOutputDirection( fine->GetGridDirection() );
+
+    typename DecompositionType::Pointer decomposition = DecompositionType::New();
+    decomposition->SetSplineOrder( TTransform::SplineOrder );
+    decomposition->SetInput( upsampler->GetOutput() );
+    decomposition->Update();
+
+    // copy the coefficients into the parameter array
+    typedef itk::ImageRegionConstIterator<ParametersImageType> Iterator;
+    Iterator it( decomposition->GetOutput(),
+                 decomposition->GetOutput()->GetLargestPossibleRegion() );
+    for( ; !it.IsAtEnd(); ++it )
+      {
+      parameters[parameterCounter++] = it.Get();
+      }
+    }
+  return parameters;
+}
+
 template <class T>
 int DoIt( int argc, char * argv[], T )
 {
@@ -139,15 +250,9 @@ int DoIt( int argc, char * argv[], T )
     InputImageType,
     OutputImageType>    RegistrationType;
 
-  typename MetricType::Pointer         metric        = MetricType::New();
-  typename OptimizerType::Pointer      optimizer     = OptimizerType::New();
-  typename InterpolatorType::Pointer   interpolator  = InterpolatorType::New();
+  // Holds the bulk transform, then the result of the finest level
   typename TransformType::Pointer      transform     = TransformType::New();
-  typename RegistrationType::Pointer   registration  = RegistrationType::New();
 
-  typedef TransformType::RegionType     RegionType;
-  typedef TransformType::SpacingType    SpacingType;
-  typedef TransformType::OriginType     OriginType;
   typedef TransformType::ParametersType ParametersType;
 
   // Read fixed and moving images
@@ -222,48 +327,6 @@ int DoIt( int argc, char * argv[], T )
   movingOrient->Update();
   collector.Stop( "Read moving volume" );
 
-  // Setup BSpline deformation
-  //
-  //  Note that the B-spline computation requires a finite support
-  //  region ( 1 grid node at the lower borders and 2 grid nodes at
-  //  upper borders).
-  RegionType bsplineRegion;
-  typename RegionType::SizeType   gridSizeOnImage;
-  typename RegionType::SizeType   gridBorderSize;
-  typename RegionType::SizeType   totalGridSize;
-
-  gridSizeOnImage.Fill( gridSize );
-  gridBorderSize.Fill( 3 );    // Border for spline order = 3 ( 1 lower, 2 upper )
-  totalGridSize = gridSizeOnImage + gridBorderSize;
-
-  bsplineRegion.SetSize( totalGridSize );
-
-  SpacingType spacing = fixedOrient->GetOutput()->GetSpacing();
-  OriginType  origin = fixedOrient->GetOutput()->GetOrigin();;
-
-  typename InputImageType::RegionType fixedRegion =
-    fixedOrient->GetOutput()->GetLargestPossibleRegion();
-  typename InputImageType::SizeType fixedImageSize =
-    fixedRegion.GetSize();
-  for( unsigned int r = 0; r < ImageDimension; r++ )
-    {
-    spacing[r] *= floor( static_cast<double>(fixedImageSize[r] - 1)
-                         / static_cast<double>(gridSizeOnImage[r] - 1) );
-    origin[r]  -=  spacing[r];
-    }
-
-  transform->SetGridSpacing( spacing );
-  transform->SetGridOrigin( origin );
-  transform->SetGridRegion( bsplineRegion );
-
-  const unsigned int numberOfParameters =
-    transform->GetNumberOfParameters();
-
-  ParametersType parameters( numberOfParameters );
-  parameters.Fill( 0.0 );
-
-  transform->SetParameters( parameters );
-
   // Initialize the transform with a bulk transform using either a
   // transform that aligns the centers of the volumes or a specified
   // bulk transform
@@ -324,84 +387,180 @@ int DoIt( int argc, char * argv[], T )
     std::cout << "Initial transform: "; initial->Print( std::cout );
     }
 
-  // Setup optimizer
-  //
+  // Image pyramids. The levels are Gaussian smoothed and downsampled
+  // by 2 in each dimension from one level to the next. With a single
+  // level the registration runs on the full resolution images only.
   //
-  typename OptimizerType::BoundSelectionType boundSelect( transform->GetNumberOfParameters() );
-  typename OptimizerType::BoundValueType     upperBound( transform->GetNumberOfParameters() );
-  typename OptimizerType::BoundValueType     lowerBound( transform->GetNumberOfParameters() );
-  if( ConstrainDeformation )
+  const unsigned int numberOfLevels = std::max( NumberOfLevels, 1 );
+
+  typedef itk::MultiResolutionPyramidImageFilter<InputImageType, InputImageType> PyramidType;
+  typename PyramidType::Pointer fixedPyramid = PyramidType::New();
+  typename PyramidType::Pointer movingPyramid = PyramidType::New();
+  if( numberOfLevels > 1 )
     {
-    boundSelect.Fill( 2 );
-    upperBound.Fill(  MaximumDeformation );
-    lowerBound.Fill( -MaximumDeformation );
+    fixedPyramid->SetInput( fixedOrient->GetOutput() );
+    fixedPyramid->SetNumberOfLevels( numberOfLevels );
+    movingPyramid->SetInput( movingOrient->GetOutput() );
+    movingPyramid->SetNumberOfLevels( numberOfLevels );
+    if( NumberOfThreads > 0 )
+      {
+      fixedPyramid->SetNumberOfThreads( NumberOfThreads );
+      movingPyramid->SetNumberOfThreads( NumberOfThreads );
+      }
+    collector.Start( "Image pyramids" );
+    fixedPyramid->Update();
+    movingPyramid->Update();
+    collector.Stop( "Image pyramids" );
     }
-  else
+
+  // Create the Command observer, it is registered with the optimizer of
+  // each level.
+  //
+  typename CommandIterationUpdate::Pointer observer = CommandIterationUpdate::New();
+
+  // Registration, from the coarsest to the finest level. The B-spline
+  // grid is refined by a factor of 2 from one level to the next and
+  // the parameters found at a level initialize the next one.
+  //
+  typename TransformType::Pointer previousTransform;
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
     {
-    boundSelect.Fill( 0 );
-    upperBound.Fill( 0.0 );
-    lowerBound.Fill( 0.0 );
-    }
+    const unsigned int levelsToFinest = numberOfLevels - 1 - level;
+    const unsigned int nodesOnImage =
+      std::max( 3u, static_cast<unsigned int>( (gridSize - 1) >> levelsToFinest ) + 1 );
 
-  optimizer->SetBoundSelection( boundSelect );
-  optimizer->SetUpperBound( upperBound );
-  optimizer->SetLowerBound( lowerBound );
+    typename InputImageType::Pointer fixedImage = fixedOrient->GetOutput();
+    typename InputImageType::Pointer movingImage = movingOrient->GetOutput();
+    if( numberOfLevels > 1 )
+      {
+      fixedImage = fixedPyramid->GetOutput( level );
+      movingImage = movingPyramid->GetOutput( level );
+      }
 
-  optimizer->SetCostFunctionConvergenceFactor( 1e+1 );
-  optimizer->SetProjectedGradientTolerance( 1e-7 );
-  optimizer->SetMaximumNumberOfIterations( Iterations );
-  optimizer->SetMaximumNumberOfEvaluations( 500 );
-  optimizer->SetMaximumNumberOfCorrections( 12 );
+    // The grid is placed on the full resolution fixed image at all the
+    // levels, so that the grids of the levels are nested.
+    typename TransformType::Pointer levelTransform = TransformType::New();
+    SetGridOnImage( levelTransform.GetPointer(), fixedOrient->GetOutput(), nodesOnImage );
+    levelTransform->SetBulkTransform( transform->GetBulkTransform() );
 
-  // Create the Command observer and register it with the optimizer.
-  //
-  typename CommandIterationUpdate::Pointer observer = CommandIterationUpdate::New();
-  observer->SetRegistration( registration );
-  observer->SetCostFunction( metric );
+    ParametersType levelParameters( levelTransform->GetNumberOfParameters() );
+    levelParameters.Fill( 0.0 );
+    if( previousTransform )
+      {
+      levelParameters = RefineGridParameters( previousTransform.GetPointer(),
+                                              levelTransform.GetPointer() );
+      }
+    levelTransform->SetParametersByValue( levelParameters );
+
+    // Setup optimizer
+    //
+    //
+    typename OptimizerType::Pointer optimizer = OptimizerType::New();
+    typename OptimizerType::BoundSelectionType boundSelect( levelTransform->GetNumberOfParameters() );
+    typename OptimizerType::BoundValueType     upperBound( levelTransform->GetNumberOfParameters() );
+    typename OptimizerType::BoundValueType     lowerBound( levelTransform->GetNumberOfParameters() );
+    if( ConstrainDeformation )
+      {
+      boundSelect.Fill( 2 );
+      upperBound.Fill(  MaximumDeformation );
+      lowerBound.Fill( -MaximumDeformation );
+      }
+    else
+      {
+      boundSelect.Fill( 0 );
+      upperBound.Fill( 0.0 );
+      lowerBound.Fill( 0.0 );
+      }
 
-  optimizer->AddObserver( itk::IterationEvent(), observer );
+    optimizer->SetBoundSelection( boundSelect );
+    optimizer->SetUpperBound( upperBound );
+    optimizer->SetLowerBound( lowerBound );
+
+    optimizer->SetCostFunctionConvergenceFactor( 1e+1 );
+    optimizer->SetProjectedGradientTolerance( 1e-7 );
+    optimizer->SetMaximumNumberOfIterations( Iterations );
+    optimizer->SetMaximumNumberOfEvaluations( 500 );
+    optimizer->SetMaximumNumberOfCorrections( 12 );
+
+    // Setup metric
+    //
+    // The samples can't outnumber the pixels of the coarse levels. The
+    // PDF derivatives are accumulated per thread instead of being
+    // stored explicitly for each parameter, which is much cheaper with
+    // the many parameters of a B-spline transform.
+    //
+    typename MetricType::Pointer metric = MetricType::New();
+    const unsigned long numberOfPixels =
+      fixedImage->GetLargestPossibleRegion().GetNumberOfPixels();
+    metric->ReinitializeSeed( 76926294 );
+    metric->SetNumberOfHistogramBins( HistogramBins );
+    metric->SetNumberOfSpatialSamples(
+      std::min( static_cast<unsigned long>( SpatialSamples ), numberOfPixels ) );
+    metric->SetUseExplicitPDFDerivatives( false );
+#if ITK_VERSION_MAJOR >= 4
+    if( NumberOfThreads > 0 )
+      {
+      metric->SetNumberOfThreads( NumberOfThreads );
+      }
+#endif
 
-  // Setup metric
-  //
-  //
-  metric->ReinitializeSeed( 76926294 );
-  metric->SetNumberOfHistogramBins( HistogramBins );
-  metric->SetNumberOfSpatialSamples( SpatialSamples );
+    typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
+    typename RegistrationType::Pointer registration = RegistrationType::New();
+
+    observer->SetRegistration( registration );
+    observer->SetCostFunction( metric );
+    observer->SetLevel( level );
+    optimizer->AddObserver( itk::IterationEvent(), observer );
+
+    std::cout << std::endl << "Starting Registration level " << level
+              << ": image size " << fixedImage->GetLargestPossibleRegion().GetSize()
+              << ", " << nodesOnImage << " grid nodes per dimension, "
+              << levelTransform->GetNumberOfParameters() << " parameters" << std::endl;
+
+    registration->SetFixedImage( fixedImage );
+    registration->SetMovingImage( movingImage );
+    registration->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+    registration->SetMetric( metric       );
+    registration->SetOptimizer( optimizer    );
+    registration->SetInterpolator( interpolator );
+    registration->SetTransform( levelTransform );
+    registration->SetInitialTransformParameters( levelTransform->GetParameters() );
+    if( NumberOfThreads > 0 )
+      {
+      registration->SetNumberOfThreads( NumberOfThreads );
+      }
 
-  std::cout << std::endl << "Starting Registration" << std::endl;
+    std::ostringstream probeName;
+    probeName << "Registration level " << level;
+    try
+      {
+      itk::PluginFilterWatcher watchRegistration(registration,
+                                                 "Registering",
+                                                 CLPProcessInformation,
+                                                 1.0 / 3.0 / numberOfLevels,
+                                                 1.0 / 3.0 + level * 1.0 / 3.0 / numberOfLevels);
+      collector.Start( probeName.str().c_str() );
+      registration->Update();
+      collector.Stop( probeName.str().c_str() );
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      std::cerr << "ExceptionObject caught !" << std::endl;
+      std::cerr << err << std::endl;
+      return EXIT_FAILURE;
+      }
 
-  // Registration
-  //
-  //
-  registration->SetFixedImage( fixedOrient->GetOutput()  );
-  registration->SetMovingImage( movingOrient->GetOutput() );
-  registration->SetMetric( metric       );
-  registration->SetOptimizer( optimizer    );
-  registration->SetInterpolator( interpolator );
-  registration->SetTransform( transform    );
-  registration->SetInitialTransformParameters( transform->GetParameters() );
+    levelTransform->SetParametersByValue( registration->GetLastTransformParameters() );
+    std::cout << "Level " << level << " done after "
+              << optimizer->GetCurrentIteration() << " iterations, metric "
+              << optimizer->GetValue() << std::endl;
 
-  try
-    {
-    itk::PluginFilterWatcher watchRegistration(registration,
-                                               "Registering",
-                                               CLPProcessInformation,
-                                               1.0 / 3.0, 2.0 / 3.0);
-    collector.Start( "Registration" );
-    registration->Update();
-    collector.Stop( "Registration" );
-    }
-  catch( itk::ExceptionObject & err )
-    {
-    std::cerr << "ExceptionObject caught !" << std::endl;
-    std::cerr << err << std::endl;
-    return EXIT_FAILURE;
+    previousTransform = levelTransform;
     }
 
-  typename OptimizerType::ParametersType finalParameters =
-    registration->GetLastTransformParameters();
+  transform = previousTransform;
+  const ParametersType & finalParameters = transform->GetParameters();
   std::cout << "Final parameters: " << finalParameters[50] << std::endl;
-  transform->SetParameters( finalParameters );
 
   if( OutputTransform != "" )
     {
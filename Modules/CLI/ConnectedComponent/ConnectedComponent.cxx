@@ -11,7 +11,7 @@ command line processing and additional features have been added.
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkConnectedComponentImageFilter.h"
+#include "itkParallelConnectedComponentImageFilter.h"
 
 #include "ConnectedComponentCLP.h"
 #include "itkPluginUtilities.h"
@@ -39,7 +39,7 @@ int DoIt( int argc, char * argv[])
   typename InputImageType::Pointer image;
   typename ReaderType::Pointer  reader = ReaderType::New();
 
-  typedef itk::ConnectedComponentImageFilter<InputImageType, InputImageType>  FilterType;
+  typedef itk::ParallelConnectedComponentImageFilter<InputImageType, InputImageType>  FilterType;
 
   typename ReaderType::Pointer reader1 = ReaderType::New();
   itk::PluginFilterWatcher watchReader1(reader1, "Read Volume", CLPProcessInformation);
@@ -50,6 +50,9 @@ int DoIt( int argc, char * argv[])
   itk::PluginFilterWatcher watchFilter(filter,   "Processing", CLPProcessInformation);
 
   filter->SetInput(reader1->GetOutput());
+  filter->SetFullyConnected(FullyConnected);
+  filter->SetMinimumObjectSize(MinimumSize);
+  filter->SetSortObjectsBySize(SortBySize);
 
   typename WriterType::Pointer writer = WriterType::New();
   itk::PluginFilterWatcher watchWriter(writer,
@@ -59,6 +62,10 @@ int DoIt( int argc, char * argv[])
   writer->SetInput( filter->GetOutput() );
   writer->Update();
 
+  std::cout << filter->GetNumberOfObjects() << " objects ("
+            << filter->GetOriginalNumberOfObjects() - filter->GetNumberOfObjects()
+            << " smaller than " << MinimumSize << " voxels removed)" << std::endl;
+
   return EXIT_SUCCESS;
 }
 
@@ -11,13 +11,25 @@ command line processing and additional features have been added.
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkExtractImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
 #include "itkShiftScaleImageFilter.h"
 #include "itkGDCMImageIO.h"
 #include "itkMetaDataObject.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#if ITK_VERSION_MAJOR >= 4
+#include "gdcmUIDGenerator.h"
+#else
+#include "gdcmUtil.h"
+#endif
 
 #include "CreateDICOMSeriesCLP.h"
 
+#include <algorithm>
+#include <vector>
+
 // Use an anonymous namespace to keep class types and function names
 // from colliding when module is used as shared object module.  Every
 // thing should be in an anonymous namespace except for the module
@@ -26,6 +38,211 @@ command line processing and additional features have been added.
 namespace
 {
 
+// DICOM UIDs are at most 64 characters long
+const std::string::size_type MaximumUIDLength = 64;
+
+std::string GenerateUID()
+{
+#if ITK_VERSION_MAJOR >= 4
+  gdcm::UIDGenerator generator;
+  return generator.Generate();
+#else
+  return gdcm::Util::CreateUniqueUID("");
+#endif
+}
+
+unsigned int NumberOfDigits(unsigned int n)
+{
+  unsigned int digits = 1;
+  for( ; n >= 10; n /= 10 )
+    {
+    ++digits;
+    }
+  return digits;
+}
+
+// Writes the slices of a volume as a DICOM series with a pool of threads.
+// The tags shared by all the slices are prepared once in Template. Each
+// thread takes the next slice to write, fills its own tags, copies its
+// pixels and writes it with its own ImageIO. The SOP instance UID of a
+// slice is derived from the series instance UID and the instance number:
+// the files are the same whatever the number of threads.
+template <class TImage3D, class TImage2D>
+class SliceWriter
+{
+public:
+  typedef itk::MetaDataDictionary           DictionaryType;
+  typedef itk::ImageFileWriter<TImage2D>    WriterType;
+  typedef typename TImage2D::PixelType      PixelType;
+
+  SliceWriter()
+    : Image(0), Reverse(false), UseCompression(false),
+    NextSlice(0), NumberOfWrittenSlices(0), Error(false)
+  {
+  }
+
+  // Return false if a slice could not be written
+  bool Write(int numberOfThreads)
+  {
+    this->NextSlice = 0;
+    this->NumberOfWrittenSlices = 0;
+    this->Error = false;
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(&SliceWriter::ThreadFunction, this);
+    threader->SingleMethodExecute();
+    return !this->Error;
+  }
+
+  // Shared by the threads, read only while writing
+  const TImage3D*          Image;
+  DictionaryType           Template;
+  std::string              SeriesInstanceUID;
+  std::vector<std::string> FileNames;
+  bool                     Reverse;
+  bool                     UseCompression;
+
+protected:
+  static ITK_THREAD_RETURN_TYPE ThreadFunction(void* arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct* info =
+      static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+    SliceWriter* self = static_cast<SliceWriter *>(info->UserData);
+    itk::GDCMImageIO::Pointer gdcmIO = itk::GDCMImageIO::New();
+    // The UIDs are set in the dictionary
+    gdcmIO->KeepOriginalUIDOn();
+    const unsigned int numberOfSlices = static_cast<unsigned int>(self->FileNames.size());
+    for( ;; )
+      {
+      self->Lock.Lock();
+      const unsigned int slice = self->NextSlice++;
+      const bool done = self->Error || slice >= numberOfSlices;
+      self->Lock.Unlock();
+      if( done )
+        {
+        break;
+        }
+      try
+        {
+        self->WriteSlice(slice, gdcmIO);
+        }
+      catch( itk::ExceptionObject & excp )
+        {
+        self->Lock.Lock();
+        std::cerr << "Exception thrown while writing the file "
+                  << self->FileNames[slice] << std::endl;
+        std::cerr << excp << std::endl;
+        self->Error = true;
+        self->Lock.Unlock();
+        break;
+        }
+      self->Lock.Lock();
+      ++self->NumberOfWrittenSlices;
+      std::cout << "<filter-progress>"
+                << static_cast<float>(self->NumberOfWrittenSlices) / numberOfSlices
+                << "</filter-progress>"
+                << std::endl
+                << std::flush;
+      self->Lock.Unlock();
+      }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  void WriteSlice(unsigned int i, itk::GDCMImageIO* gdcmIO)
+  {
+    DictionaryType            dictionary = this->Template;
+    itksys_ios::ostringstream value;
+
+    typename TImage3D::PointType position;
+    typename TImage3D::IndexType index;
+    index.Fill(0);
+    index[2] = i;
+    this->Image->TransformIndexToPhysicalPoint(index, position);
+    value << position[0] << "\\" << position[1] << "\\" << position[2];
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0032", value.str() ); // Image Position (Patient)
+    value.str("");
+    value << i + 1;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0013", value.str() ); // Instance Number
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0018",
+                                          this->SeriesInstanceUID + "." + value.str() ); // SOP Instance UID
+
+    // Copy the pixels of the slice
+    const unsigned int numberOfSlices = static_cast<unsigned int>(this->FileNames.size());
+    typename TImage3D::RegionType sliceRegion = this->Image->GetLargestPossibleRegion();
+    sliceRegion.SetIndex(2, sliceRegion.GetIndex(2) + (this->Reverse ? numberOfSlices - i - 1 : i));
+    sliceRegion.SetSize(2, 1);
+
+    typename TImage2D::RegionType region;
+    typename TImage2D::SpacingType spacing;
+    typename TImage2D::PointType origin;
+    typename TImage2D::DirectionType direction;
+    typename TImage3D::PointType slicePosition;
+    this->Image->TransformIndexToPhysicalPoint(sliceRegion.GetIndex(), slicePosition);
+    for( unsigned int d = 0; d < 2; ++d )
+      {
+      region.SetIndex(d, sliceRegion.GetIndex(d));
+      region.SetSize(d, sliceRegion.GetSize(d));
+      spacing[d] = this->Image->GetSpacing()[d];
+      origin[d] = slicePosition[d];
+      for( unsigned int e = 0; e < 2; ++e )
+        {
+        direction[d][e] = this->Image->GetDirection()[d][e];
+        }
+      }
+    // Same as the ITKv3 compatible collapse of itk::ExtractImageFilter
+    if( direction[0][0] * direction[1][1] - direction[0][1] * direction[1][0] == 0.0 )
+      {
+      direction.SetIdentity();
+      }
+    typename TImage2D::Pointer image = TImage2D::New();
+    image->SetRegions(region);
+    image->SetSpacing(spacing);
+    image->SetOrigin(origin);
+    image->SetDirection(direction);
+    image->Allocate();
+
+    PixelType minValue = itk::NumericTraits<PixelType>::max();
+    PixelType maxValue = itk::NumericTraits<PixelType>::NonpositiveMin();
+    itk::ImageRegionConstIterator<TImage3D> in(this->Image, sliceRegion);
+    itk::ImageRegionIterator<TImage2D>      out(image, region);
+    for( in.GoToBegin(), out.GoToBegin(); !in.IsAtEnd(); ++in, ++out )
+      {
+      const PixelType p = in.Get();
+      out.Set(p);
+      if( p > maxValue )
+        {
+        maxValue = p;
+        }
+      if( p < minValue )
+        {
+        minValue = p;
+        }
+      }
+    PixelType windowCenter = (minValue + maxValue) / 2;
+    PixelType windowWidth = (maxValue - minValue);
+
+    value.str("");
+    value << windowCenter;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1050", value.str() ); // Window Center
+    value.str("");
+    value << windowWidth;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1051", value.str() ); // Window Width
+    image->SetMetaDataDictionary(dictionary);
+
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName(this->FileNames[i].c_str() );
+    writer->SetInput(image);
+    writer->SetUseCompression(this->UseCompression);
+    writer->SetImageIO(gdcmIO);
+    writer->Update();
+  }
+
+  itk::SimpleFastMutexLock Lock;
+  unsigned int             NextSlice;
+  unsigned int             NumberOfWrittenSlices;
+  bool                     Error;
+};
+
 template <class Tin>
 int DoIt( int argc, char * argv[])
 {
@@ -37,8 +254,6 @@ int DoIt( int argc, char * argv[])
   typedef itk::Image<InputPixelType, 2>                        Image2DType;
   typedef itk::ImageFileReader<Image3DType>                    ReaderType;
   typedef itk::ShiftScaleImageFilter<Image3DType, Image3DType> ShiftScaleType;
-  typedef itk::ImageFileWriter<Image2DType>                    WriterType;
-  typedef itk::GDCMImageIO                                     ImageIOType;
 
   typename Image3DType::Pointer image;
   typename ReaderType::Pointer  reader = ReaderType::New();
@@ -86,10 +301,165 @@ int DoIt( int argc, char * argv[])
     }
 
   typedef itk::MetaDataDictionary DictionaryType;
+  typedef SliceWriter<Image3DType, Image2DType> SliceWriterType;
   unsigned int numberOfSlices = image->GetLargestPossibleRegion().GetSize()[2];
 
-  typename ImageIOType::Pointer gdcmIO = ImageIOType::New();
-  DictionaryType       dictionary;
+  // The SOP instance UIDs are the series instance UID followed by the
+  // instance number.
+  const std::string::size_type maximumSeriesUIDLength =
+    MaximumUIDLength - 1 - NumberOfDigits(numberOfSlices);
+  if( studyInstanceUID.empty() )
+    {
+    studyInstanceUID = GenerateUID();
+    }
+  if( seriesInstanceUID.empty() )
+    {
+    seriesInstanceUID = GenerateUID();
+    // Keep the generated prefix and enough random digits to be unique
+    if( seriesInstanceUID.size() > maximumSeriesUIDLength )
+      {
+      seriesInstanceUID.resize(maximumSeriesUIDLength);
+      }
+    while( !seriesInstanceUID.empty() && *seriesInstanceUID.rbegin() == '.' )
+      {
+      seriesInstanceUID.resize(seriesInstanceUID.size() - 1);
+      }
+    }
+  if( studyInstanceUID.size() > MaximumUIDLength
+      || seriesInstanceUID.size() > maximumSeriesUIDLength )
+    {
+    std::cerr << "The study instance UID must be at most " << MaximumUIDLength
+              << " characters long and the series instance UID at most "
+              << maximumSeriesUIDLength << " characters long" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Tags shared by all the slices
+  SliceWriterType sliceWriter;
+  sliceWriter.Image = image;
+  sliceWriter.SeriesInstanceUID = seriesInstanceUID;
+  sliceWriter.Reverse = reverseImages;
+  sliceWriter.UseCompression = useCompression;
+  DictionaryType& dictionary = sliceWriter.Template;
+  itksys_ios::ostringstream value;
+
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0008", std::string("ORIGINAL\\PRIMARY\\AXIAL") );  // Image
+                                                                                                             // Type
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0016", std::string("1.2.840.10008.5.1.4.1.1.2") ); // SOP
+                                                                                                             // Class
+                                                                                                             // UID
+  itk::EncapsulateMetaData<std::string>(dictionary, "0010|0030", std::string("20060101") );                  //
+                                                                                                             // Patient's
+                                                                                                             // Birthdate
+  itk::EncapsulateMetaData<std::string>(dictionary, "0010|0032", std::string("010100.000000") );             //
+                                                                                                             // Patient's
+                                                                                                             // Birth
+                                                                                                             // Time
+  itk::EncapsulateMetaData<std::string>(dictionary, "0010|0040", std::string("M") );                         //
+                                                                                                             // Patient's
+                                                                                                             // Sex
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", std::string("20050101") );                  // Study
+                                                                                                             // Date
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0030", std::string("010100.000000") );             // Study
+                                                                                                             // Time
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0050", std::string("1") );                         //
+                                                                                                             // Accession
+                                                                                                             // Number
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0090", std::string("Unknown") );                   //
+                                                                                                             // Referring
+                                                                                                             // Physician's
+                                                                                                             // Name
+  itk::EncapsulateMetaData<std::string>(dictionary, "0018|5100", std::string("HFS") );                       //
+                                                                                                             // Patient
+                                                                                                             // Position
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|1040", std::string("SN") );                        //
+                                                                                                             // Position
+                                                                                                             // Reference
+                                                                                                             // Indicator
+  // itk::EncapsulateMetaData<std::string>(dictionary,"0020|0037",
+  // std::string("1.000000\\0.000000\\0.000000\\0.000000\\1.000000\\0.000000")); // Image Orientation (Patient)
+  value.str("");
+  value << oMatrix[0][0] << "\\" << oMatrix[1][0] << "\\" << oMatrix[2][0] << "\\";
+  value << oMatrix[0][1] << "\\" << oMatrix[1][1] << "\\" << oMatrix[2][1];
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|0037", value.str() ); // Image Orientation (Patient)
+  value.str("");
+  value << spacing[2];
+  itk::EncapsulateMetaData<std::string>(dictionary, "0018|0050", value.str() ); // Slice Thickness
+
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|000d", studyInstanceUID); // Study Instance UID
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|000e", seriesInstanceUID); // Series Instance UID
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|0052", seriesInstanceUID + ".0"); // Frame of Reference UID
+
+  // Parameters from the command line
+  if( patientName.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0010", patientName);
+    }
+  if( patientID.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0020", patientID);
+    }
+  if( patientComments.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0010|4000", patientComments);
+    }
+  if( studyID.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0010", studyID);
+    }
+  if( studyDate.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", studyDate);
+    }
+  if( studyComments.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0032|4000", studyComments);
+    }
+  if( studyDescription.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|1030", studyDescription);
+    }
+  if( modality.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0060", modality);
+    }
+  if( manufacturer.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0070", manufacturer);
+    }
+  if( model.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|1090", model);
+    }
+  if( seriesNumber.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0011", seriesNumber);
+    }
+  if( seriesDescription.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|103e", seriesDescription);
+    }
+
+  // Always set the rescale interscept and rescale slope (even if
+  // they are at their defaults of 0 and 1 respectively).
+  // value.str("");
+  // value << rescaleIntercept;
+  // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1052", value.str());
+  // value.str("");
+  // value << rescaleSlope;
+  // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1053", value.str());
+
+#if WIN32
+#define snprintf sprintf_s
+#endif
+  for( unsigned int i = 0; i < numberOfSlices; i++ )
+    {
+    char imageNumber[BUFSIZ];
+    snprintf(imageNumber, BUFSIZ, dicomNumberFormat.c_str(), i + 1);
+    value.str("");
+    value << dicomDirectory << "/" << dicomPrefix << imageNumber << ".dcm";
+    sliceWriter.FileNames.push_back(value.str() );
+    }
 
   // Progress
   std::cout << "<filter-start>"
@@ -105,208 +475,15 @@ int DoIt( int argc, char * argv[])
   std::cout << "</filter-start>"
             << std::endl;
   std::cout << std::flush;
-  float progress = 1.0 / (float) numberOfSlices;
-  for( unsigned int i = 0; i < numberOfSlices; i++ )
-    {
-    std::cout << "<filter-progress>"
-              << (i + 1) * progress
-              << "</filter-progress>"
-              << std::endl
-              << std::flush;
-
-    itksys_ios::ostringstream value;
-    typename Image3DType::PointType    origin;
-    typename Image3DType::IndexType    index;
-    index.Fill(0);
-    index[2] = i;
-    image->TransformIndexToPhysicalPoint(index, origin);
-
-    // Set all required DICOM fields
-    value.str("");
-    value << origin[0] << "\\" << origin[1] << "\\" << origin[2];
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0032", value.str() );
-
-    value.str("");
-    value << i + 1;
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0013", value.str() );
-
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0008", std::string("ORIGINAL\\PRIMARY\\AXIAL") );  // Image
-                                                                                                               // Type
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0016", std::string("1.2.840.10008.5.1.4.1.1.2") ); // SOP
-                                                                                                               // Class
-                                                                                                               // UID
-    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0030", std::string("20060101") );                  //
-                                                                                                               // Patient's
-                                                                                                               // Birthdate
-    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0032", std::string("010100.000000") );             //
-                                                                                                               // Patient's
-                                                                                                               // Birth
-                                                                                                               // Time
-    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0040", std::string("M") );                         //
-                                                                                                               // Patient's
-                                                                                                               // Sex
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", std::string("20050101") );                  // Study
-                                                                                                               // Date
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0030", std::string("010100.000000") );             // Study
-                                                                                                               // Time
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0050", std::string("1") );                         //
-                                                                                                               // Accession
-                                                                                                               // Number
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0090", std::string("Unknown") );                   //
-                                                                                                               // Referring
-                                                                                                               // Physician's
-                                                                                                               // Name
-    itk::EncapsulateMetaData<std::string>(dictionary, "0018|5100", std::string("HFS") );                       //
-                                                                                                               // Patient
-                                                                                                               // Position
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|1040", std::string("SN") );                        //
-                                                                                                               // Position
-                                                                                                               // Reference
-                                                                                                               // Indicator
-    // itk::EncapsulateMetaData<std::string>(dictionary,"0020|0037",
-    // std::string("1.000000\\0.000000\\0.000000\\0.000000\\1.000000\\0.000000")); // Image Orientation (Patient)
-    value.str("");
-    value << oMatrix[0][0] << "\\" << oMatrix[1][0] << "\\" << oMatrix[2][0] << "\\";
-    value << oMatrix[0][1] << "\\" << oMatrix[1][1] << "\\" << oMatrix[2][1];
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0037", value.str() ); // Image Orientation (Patient)
-    value.str("");
-    value << spacing[2];
-    itk::EncapsulateMetaData<std::string>(dictionary, "0018|0050", value.str() ); // Slice Thickness
 
-    // Parameters from the command line
-    if( patientName.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0010|0010", patientName);
-      }
-    if( patientID.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0010|0020", patientID);
-      }
-    if( patientComments.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0010|4000", patientComments);
-      }
-    if( studyID.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0010", studyID);
-      }
-    if( studyDate.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", studyDate);
-      }
-    if( studyComments.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0032|4000", studyComments);
-      }
-    if( studyDescription.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|1030", studyDescription);
-      }
-    if( modality.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0060", modality);
-      }
-    if( manufacturer.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0070", manufacturer);
-      }
-    if( model.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|1090", model);
-      }
-    if( seriesNumber.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0011", seriesNumber);
-      }
-    if( seriesDescription.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|103e", seriesDescription);
-      }
-
-    // Always set the rescale interscept and rescale slope (even if
-    // they are at their defaults of 0 and 1 respectively).
-    // value.str("");
-    // value << rescaleIntercept;
-    // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1052", value.str());
-    // value.str("");
-    // value << rescaleSlope;
-    // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1053", value.str());
-
-    typename Image3DType::RegionType extractRegion;
-    typename Image3DType::SizeType   extractSize;
-    typename Image3DType::IndexType  extractIndex;
-    extractSize = image->GetLargestPossibleRegion().GetSize();
-    extractIndex.Fill(0);
-    if( reverseImages )
-      {
-      extractIndex[2] = numberOfSlices - i - 1;
-      }
-    else
-      {
-      extractIndex[2] = i;
-      }
-    extractSize[2] = 0;
-    extractRegion.SetSize(extractSize);
-    extractRegion.SetIndex(extractIndex);
-
-    typedef itk::ExtractImageFilter<Image3DType, Image2DType> ExtractType;
-    typename ExtractType::Pointer extract = ExtractType::New();
-#if  ITK_VERSION_MAJOR >= 4
-    extract->SetDirectionCollapseToGuess();  // ITKv3 compatible, but not recommended
-#endif
-    extract->SetInput(image );
-    extract->SetExtractionRegion(extractRegion);
-    extract->GetOutput()->SetMetaDataDictionary(dictionary);
-    extract->Update();
-
-    itk::ImageRegionIterator<Image2DType> it( extract->GetOutput(), extract->GetOutput()->GetLargestPossibleRegion() );
-    typename Image2DType::PixelType                minValue = itk::NumericTraits<typename Image2DType::PixelType>::max();
-    typename Image2DType::PixelType                maxValue = itk::NumericTraits<typename Image2DType::PixelType>::min();
-    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
-      {
-      typename Image2DType::PixelType p = it.Get();
-      if( p > maxValue )
-        {
-        maxValue = p;
-        }
-      if( p < minValue )
-        {
-        minValue = p;
-        }
-      }
-    typename Image2DType::PixelType windowCenter = (minValue + maxValue) / 2;
-    typename Image2DType::PixelType windowWidth = (maxValue - minValue);
-
-    value.str("");
-    value << windowCenter;
-    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1050", value.str() );
-    value.str("");
-    value << windowWidth;
-    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1051", value.str() );
-
-    typename WriterType::Pointer writer = WriterType::New();
-    char                imageNumber[BUFSIZ];
-#if WIN32
-#define snprintf sprintf_s
-#endif
-    snprintf(imageNumber, BUFSIZ, dicomNumberFormat.c_str(), i + 1);
-    value.str("");
-    value << dicomDirectory << "/" << dicomPrefix << imageNumber << ".dcm";
-    writer->SetFileName(value.str().c_str() );
-
-    writer->SetInput(extract->GetOutput() );
-    writer->SetUseCompression(useCompression);
-    try
-      {
-      writer->SetImageIO(gdcmIO);
-      writer->Update();
-      }
-    catch( itk::ExceptionObject & excp )
-      {
-      std::cerr << "Exception thrown while writing the file " << std::endl;
-      std::cerr << excp << std::endl;
-      return EXIT_FAILURE;
-      }
+  if( numberOfThreads <= 0 )
+    {
+    numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  numberOfThreads = std::max(1, std::min(numberOfThreads, static_cast<int>(numberOfSlices) ) );
+  if( !sliceWriter.Write(numberOfThreads) )
+    {
+    return EXIT_FAILURE;
     }
   std::cout << "<filter-end>"
             << std::endl;
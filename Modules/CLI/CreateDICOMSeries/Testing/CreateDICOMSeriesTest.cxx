@@ -1,5 +1,19 @@
 #include "itkTestMain.h"
 
+#include "itkGDCMImageIO.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMetaDataObject.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
 #ifdef WIN32
 #define MODULE_IMPORT __declspec(dllimport)
 #else
@@ -8,7 +22,123 @@
 
 extern "C" MODULE_IMPORT int ModuleEntryPoint(int, char * []);
 
+namespace
+{
+
+typedef itk::Image<short, 2>            SliceType;
+typedef itk::ImageFileReader<SliceType> SliceReaderType;
+
+std::string SliceFileName( const std::string & directory, const std::string & prefix, unsigned int slice )
+{
+  char imageNumber[BUFSIZ];
+  sprintf(imageNumber, "%04d", slice);
+  return directory + "/" + prefix + imageNumber + ".dcm";
+}
+
+// Compare the header elements and the pixels of two DICOM files. The
+// instance creation date and time can be added when the file is written
+// and are not compared.
+bool CompareDICOMFiles( const std::string & fileName1, const std::string & fileName2 )
+{
+  SliceReaderType::Pointer readers[2];
+  const std::string        fileNames[2] = { fileName1, fileName2 };
+  for( int n = 0; n < 2; ++n )
+    {
+    readers[n] = SliceReaderType::New();
+    readers[n]->SetImageIO(itk::GDCMImageIO::New() );
+    readers[n]->SetFileName(fileNames[n].c_str() );
+    try
+      {
+      readers[n]->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      std::cerr << "Unable to read " << fileNames[n] << std::endl << excp << std::endl;
+      return false;
+      }
+    }
+
+  const itk::MetaDataDictionary & dictionary1 = readers[0]->GetMetaDataDictionary();
+  const itk::MetaDataDictionary & dictionary2 = readers[1]->GetMetaDataDictionary();
+  std::vector<std::string>        keys1 = dictionary1.GetKeys();
+  std::vector<std::string>        keys2 = dictionary2.GetKeys();
+  if( keys1 != keys2 )
+    {
+    std::cerr << fileName1 << " and " << fileName2 << " have different elements" << std::endl;
+    return false;
+    }
+  for( std::vector<std::string>::const_iterator key = keys1.begin(); key != keys1.end(); ++key )
+    {
+    if( *key == "0008|0012" || *key == "0008|0013" )
+      {
+      continue;
+      }
+    std::string value1;
+    std::string value2;
+    const bool  isString1 = itk::ExposeMetaData<std::string>(dictionary1, *key, value1);
+    const bool  isString2 = itk::ExposeMetaData<std::string>(dictionary2, *key, value2);
+    if( isString1 != isString2 || value1 != value2 )
+      {
+      std::cerr << "The element " << *key << " of " << fileName1 << " (" << value1
+                << ") and " << fileName2 << " (" << value2 << ") are different" << std::endl;
+      return false;
+      }
+    }
+
+  SliceType * slice1 = readers[0]->GetOutput();
+  SliceType * slice2 = readers[1]->GetOutput();
+  if( slice1->GetLargestPossibleRegion() != slice2->GetLargestPossibleRegion() )
+    {
+    std::cerr << fileName1 << " and " << fileName2 << " have different sizes" << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIterator<SliceType> it1(slice1, slice1->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator<SliceType> it2(slice2, slice2->GetLargestPossibleRegion() );
+  for( ; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if( it1.Get() != it2.Get() )
+      {
+      std::cerr << fileName1 << " and " << fileName2 << " have different pixels at "
+                << it1.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+// Compare the DICOM series <directory>/<prefix1>NNNN.dcm and
+// <directory>/<prefix2>NNNN.dcm slice by slice.
+int CompareDICOMSeries( int argc, char * argv[] )
+{
+  if( argc < 4 )
+    {
+    std::cerr << "Usage: " << argv[0] << " directory prefix1 prefix2" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = argv[1];
+  unsigned int      slice = 1;
+  for( ; itksys::SystemTools::FileExists(SliceFileName(directory, argv[2], slice).c_str() ); ++slice )
+    {
+    if( !CompareDICOMFiles(SliceFileName(directory, argv[2], slice),
+                           SliceFileName(directory, argv[3], slice) ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if( slice == 1 || itksys::SystemTools::FileExists(SliceFileName(directory, argv[3], slice).c_str() ) )
+    {
+    std::cerr << "The series " << argv[2] << " and " << argv[3] << " have different numbers of files"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Compared " << slice - 1 << " files" << std::endl;
+  return EXIT_SUCCESS;
+}
+
 void RegisterTests()
 {
   StringToTestFunctionMap["ModuleEntryPoint"] = ModuleEntryPoint;
+  StringToTestFunctionMap["CompareDICOMSeries"] = CompareDICOMSeries;
 }
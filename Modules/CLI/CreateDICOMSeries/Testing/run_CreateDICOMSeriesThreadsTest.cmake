@@ -0,0 +1,43 @@
+# test_cmd .........: command to run without args
+# input_volume .....: volume to write as a DICOM series
+# dicom_directory ..: directory of the DICOM series
+# baseline .........: baseline of the 40th slice
+
+# Sanity checks
+set(expected_defined_vars test_cmd input_volume dicom_directory baseline)
+foreach(var ${expected_defined_vars})
+  if(NOT ${var})
+    message(FATAL_ERROR "Variable ${var} not defined !")
+  endif()
+endforeach()
+
+# Write the series with 1 and 4 threads and the same UIDs
+foreach(threads 1 4)
+  execute_process(
+    COMMAND ${test_cmd}
+      --compare ${baseline} ${dicom_directory}/CTHeadAxialThreads${threads}Dicom0040.dcm
+      ModuleEntryPoint
+      --patientName Austrialian
+      --patientID 8775070
+      --studyInstanceUID 1.2.826.0.1.3680043.2.1125.1
+      --seriesInstanceUID 1.2.826.0.1.3680043.2.1125.1.1
+      --numberOfThreads ${threads}
+      --dicomDirectory ${dicom_directory}
+      --dicomPrefix CTHeadAxialThreads${threads}Dicom
+      ${input_volume}
+    RESULT_VARIABLE exec_not_successful
+    )
+  if(exec_not_successful)
+    message(FATAL_ERROR "${test_cmd} failed with ${threads} threads")
+  endif()
+endforeach()
+
+# The files must be the same
+execute_process(
+  COMMAND ${test_cmd} CompareDICOMSeries ${dicom_directory}
+    CTHeadAxialThreads1Dicom CTHeadAxialThreads4Dicom
+  RESULT_VARIABLE test_not_successful
+  )
+if(test_not_successful)
+  message(SEND_ERROR "The series written with 1 and 4 threads are different!")
+endif()
@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   Slicer
+  Language:  C++
+
+  Copyright (c) Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See License.txt or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+// Compare the blockwise patch distances of itk::UNLMFilter to the neighbourhood
+// implementation, on a synthetic DWI: both outputs must match within
+// floating-point tolerance, and the computation times are printed.
+//
+// Usage: itkUNLMFilterBenchmark [sizeX sizeY sizeZ [gradients [neighbours]]]
+
+#include "itkImageRegionIterator.h"
+#include "itkTimeProbe.h"
+#include "itkUNLMFilter.h"
+#include "itkVectorImage.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+typedef itk::VectorImage<short, 3>                                  DiffusionImageType;
+typedef itk::VectorImage<double, 3>                                 DoubleDiffusionImageType;
+typedef itk::UNLMFilter<DiffusionImageType, DoubleDiffusionImageType> UNLMFilterType;
+
+// Smooth tissue-like signal decreasing with the gradient index, plus Rician noise
+DiffusionImageType::Pointer CreateDWI( const DiffusionImageType::SizeType & size,
+                                       unsigned int numberOfGradients, double sigma )
+{
+  DiffusionImageType::Pointer image = DiffusionImageType::New();
+  image->SetRegions( size );
+  image->SetVectorLength( numberOfGradients + 1 );
+  image->Allocate();
+  srand( 0 );
+  itk::ImageRegionIterator<DiffusionImageType> it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const DiffusionImageType::IndexType idx = it.GetIndex();
+    DiffusionImageType::PixelType       pixel = it.Get();
+    const double                        tissue = 500.0 + 300.0 * sin( 0.3 * idx[0] ) * cos( 0.2 * idx[1] + 0.1 * idx[2] );
+    for( unsigned int c = 0; c <= numberOfGradients; ++c )
+      {
+      const double signal = ( c == 0 ? 1.5 * tissue : tissue * ( 0.3 + 0.2 * cos( 0.7 * c + 0.05 * idx[0] ) ) );
+      const double real = signal + sigma * ( rand() / static_cast<double>( RAND_MAX ) - 0.5 ) * 3.4;
+      const double imag = sigma * ( rand() / static_cast<double>( RAND_MAX ) - 0.5 ) * 3.4;
+      pixel[c] = static_cast<short>( sqrt( real * real + imag * imag ) );
+      }
+    it.Set( pixel );
+    }
+  return image;
+}
+
+DoubleDiffusionImageType::Pointer Filter( DiffusionImageType * image, unsigned int numberOfGradients,
+                                          unsigned int neighbours, double sigma, bool blockwise, double & time )
+{
+  UNLMFilterType::Pointer filter = UNLMFilterType::New();
+  filter->SetInput( image );
+  UNLMFilterType::InputImageSizeType radius;
+  radius[0] = 3; radius[1] = 3; radius[2] = 1;
+  filter->SetRSearch( radius );
+  radius.Fill( 1 );
+  filter->SetRComp( radius );
+  filter->SetNDWI( numberOfGradients );
+  filter->SetNBaselines( 1 );
+  UNLMFilterType::IndicatorType dwi( numberOfGradients );
+  for( unsigned int k = 0; k < numberOfGradients; ++k )
+    {
+    // Directions spread over the sphere
+    const double                  z = -1.0 + ( 2.0 * k + 1.0 ) / numberOfGradients;
+    const double                  phi = 2.399963 * k;
+    UNLMFilterType::GradientType grad;
+    grad[0] = sqrt( 1.0 - z * z ) * cos( phi );
+    grad[1] = sqrt( 1.0 - z * z ) * sin( phi );
+    grad[2] = z;
+    filter->AddGradientDirection( grad );
+    dwi[k] = k + 1;
+    }
+  filter->SetDWI( dwi );
+  UNLMFilterType::IndicatorType baselines( 1 );
+  baselines[0] = 0;
+  filter->SetBaselines( baselines );
+  filter->SetNeighbours( neighbours );
+  filter->SetSigma( sigma );
+  filter->SetH( sigma );
+  filter->SetUseBlockwiseDistances( blockwise );
+  itk::TimeProbe probe;
+  probe.Start();
+  filter->Update();
+  probe.Stop();
+  time = probe.GetMeanTime();
+  return filter->GetOutput();
+}
+
+} // end of anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+  DiffusionImageType::SizeType size;
+  size[0] = 32; size[1] = 32; size[2] = 16;
+  unsigned int numberOfGradients = 12;
+  unsigned int neighbours = 3;
+  if( argc > 3 )
+    {
+    for( unsigned int d = 0; d < 3; ++d )
+      {
+      size[d] = atoi( argv[d + 1] );
+      }
+    }
+  if( argc > 4 )
+    {
+    numberOfGradients = atoi( argv[4] );
+    }
+  if( argc > 5 )
+    {
+    neighbours = atoi( argv[5] );
+    }
+  const double sigma = 20.0;
+  DiffusionImageType::Pointer image = CreateDWI( size, numberOfGradients, sigma );
+
+  double                            neighborhoodTime = 0.0;
+  double                            blockwiseTime = 0.0;
+  DoubleDiffusionImageType::Pointer reference =
+    Filter( image, numberOfGradients, neighbours, sigma, false, neighborhoodTime );
+  DoubleDiffusionImageType::Pointer blockwise =
+    Filter( image, numberOfGradients, neighbours, sigma, true, blockwiseTime );
+
+  double maxError = 0.0;
+  itk::ImageRegionIterator<DoubleDiffusionImageType> rit( reference, reference->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator<DoubleDiffusionImageType> bit( blockwise, blockwise->GetLargestPossibleRegion() );
+  for( rit.GoToBegin(), bit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++bit )
+    {
+    const DoubleDiffusionImageType::PixelType r = rit.Get();
+    const DoubleDiffusionImageType::PixelType b = bit.Get();
+    for( unsigned int c = 0; c < r.GetSize(); ++c )
+      {
+      const double error = fabs( r[c] - b[c] ) / ( fabs( r[c] ) > 1.0 ? fabs( r[c] ) : 1.0 );
+      maxError = ( error > maxError ? error : maxError );
+      }
+    }
+
+  std::cout << "Image: " << size << ", " << numberOfGradients << " gradients, "
+            << neighbours << " neighbouring gradients" << std::endl;
+  std::cout << "Neighbourhood implementation: " << neighborhoodTime << " s" << std::endl;
+  std::cout << "Blockwise implementation: " << blockwiseTime << " s" << std::endl;
+  if( blockwiseTime > 0.0 )
+    {
+    std::cout << "Speedup: " << neighborhoodTime / blockwiseTime << std::endl;
+    }
+  std::cout << "Maximum relative difference: " << maxError << std::endl;
+  if( maxError > 1e-4 )
+    {
+    std::cerr << "The blockwise implementation differs from the neighbourhood implementation" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -108,6 +108,13 @@ public:
   itkGetMacro( RSearch,    InputImageSizeType );
   itkSetMacro( RComp,      InputImageSizeType );
   itkGetMacro( RComp,      InputImageSizeType );
+  /** Compute the patch distances blockwise, with separable sums over blocks
+   *  of squared differences shared by neighbouring voxels and all the
+   *  channels processed together (default). Otherwise, the distances are
+   *  computed voxel by voxel with neighbourhood iterators. */
+  itkSetMacro( UseBlockwiseDistances, bool );
+  itkGetMacro( UseBlockwiseDistances, bool );
+  itkBooleanMacro( UseBlockwiseDistances );
 
   /** Add a new gradient direction: */
   void AddGradientDirection( GradientType grad )
@@ -170,6 +177,18 @@ protected:
 #endif
   void BeforeThreadedGenerateData();
 
+  /** Voxel by voxel implementation, with neighbourhood iterators */
+  void ThreadedGenerateDataNeighborhood( const OutputImageRegionType & outputRegionForThread );
+
+  /** Blockwise implementation */
+  void ThreadedGenerateDataBlockwise( const OutputImageRegionType & outputRegionForThread );
+
+  /** Convolve the interleaved values of a block along one dimension with a
+   *  1D kernel; the output block is smaller by 2*radius along that dimension */
+  static void ConvolveBlock( const float* in, const unsigned int* inExtent, unsigned int dim,
+                             const float* weights, unsigned int radius,
+                             unsigned int numberOfValues, float* out );
+
   void GenerateInputRequestedRegion();
 
 private:
@@ -194,6 +213,8 @@ private:
   float              m_H;
   InputImageSizeType m_RSearch;
   InputImageSizeType m_RComp;
+  // The implementation to use:
+  bool m_UseBlockwiseDistances;
 };
 
 } // end namespace itk
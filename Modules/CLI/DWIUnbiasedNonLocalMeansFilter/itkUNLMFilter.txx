@@ -24,6 +24,8 @@
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 #include "math.h"
 
+#include <algorithm>
+
 namespace itk
 {
 template <class TInputImage, class TOutputImage>
@@ -41,6 +43,7 @@ UNLMFilter<TInputImage, TOutputImage>
   m_H             = 1.0f;
   m_RSearch.Fill(3);
   m_RComp.Fill(1);
+  m_UseBlockwiseDistances = true;
 }
 
 template <class TInputImage, class TOutputImage>
@@ -139,6 +142,20 @@ void UNLMFilter<TInputImage, TOutputImage>
 ::ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread,
                         ThreadIdType itkNotUsed(threadId) )
 #endif
+{
+  if( m_UseBlockwiseDistances )
+    {
+    this->ThreadedGenerateDataBlockwise( outputRegionForThread );
+    }
+  else
+    {
+    this->ThreadedGenerateDataNeighborhood( outputRegionForThread );
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::ThreadedGenerateDataNeighborhood( const OutputImageRegionType& outputRegionForThread )
 {
   // Boundary conditions for this filter; Neumann conditions are fine
   ZeroFluxNeumannBoundaryCondition<InputImageType> nbc;
@@ -401,6 +418,436 @@ void UNLMFilter<TInputImage, TOutputImage>
   delete[] valsD;
 }
 
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::ConvolveBlock( const float* in, const unsigned int* inExtent, unsigned int dim,
+                 const float* weights, unsigned int radius,
+                 unsigned int numberOfValues, float* out )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  unsigned int       outExtent[Dimension];
+  unsigned long      inStride[Dimension];
+  unsigned long      stride = 1;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    outExtent[d] = inExtent[d];
+    inStride[d]  = stride;
+    stride      *= inExtent[d];
+    }
+  outExtent[dim] -= 2 * radius;
+  unsigned long numRows = 1;
+  for( unsigned int d = 1; d < Dimension; ++d )
+    {
+    numRows *= outExtent[d];
+    }
+  const unsigned long step = inStride[dim] * numberOfValues;
+  for( unsigned long row = 0; row < numRows; ++row )  // For each row along the first dimension
+    {
+    unsigned long inBase = 0;
+    unsigned long rest   = row;
+    for( unsigned int d = 1; d < Dimension; ++d )
+      {
+      inBase += ( rest % outExtent[d] ) * inStride[d];
+      rest   /= outExtent[d];
+      }
+    for( unsigned int i = 0; i < outExtent[0]; ++i, out += numberOfValues )
+      {
+      const float* first = in + ( inBase + i ) * numberOfValues;
+      for( unsigned int v = 0; v < numberOfValues; ++v )
+        {
+        out[v] = weights[0] * first[v];
+        }
+      for( unsigned int t = 1; t <= 2 * radius; ++t )
+        {
+        const float* src = first + t * step;
+        const float  w   = weights[t];
+        for( unsigned int v = 0; v < numberOfValues; ++v )
+          {
+          out[v] += w * src[v];
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::ThreadedGenerateDataBlockwise( const OutputImageRegionType& outputRegionForThread )
+{
+  // The output region is processed by blocks. For each search offset, the squared differences between the channels
+  // of the voxels of the (padded) block and the channels of the voxels shifted by the offset are computed once; the
+  // patch distances of all the voxels of the block are then obtained by separable sums of these differences with the
+  // Gaussian window, and accumulated into the weighted averages. The results are the ones of the neighbourhood
+  // implementation up to floating-point rounding.
+  const unsigned int         Dimension = TInputImage::ImageDimension;
+  InputImageConstPointer     input  = this->GetInput();
+  OutputImagePointer         output = this->GetOutput();
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+  const InputImageRegionType largestRegion  = input->GetLargestPossibleRegion();
+  // -------------------------------------------------------------------------------------------------------------
+  // CHANNELS AND PAIRS OF CHANNELS TO COMPARE:
+  // The filtered channels (baselines, then gradient images) are the columns of the blocks copied from the input
+  const unsigned int        numChannels = m_NBaselines + m_NDWI;
+  std::vector<unsigned int> channels( numChannels );
+  for( unsigned int j = 0; j < m_NBaselines; ++j )
+    {
+    channels[j] = m_Baselines[j];
+    }
+  for( unsigned int j = 0; j < m_NDWI; ++j )
+    {
+    channels[m_NBaselines + j] = m_DWI[j];
+    }
+  // Each pair compares the patch of a channel (which is the filtered one) around the voxel to the patch of another
+  // channel around the searched voxel; the distance of a channel to itself at the voxel is replaced by the maximum
+  float                     sqh = 1.0f / (m_H * m_H);
+  std::vector<unsigned int> pairFirst;
+  std::vector<unsigned int> pairSecond;
+  std::vector<float>        pairScale;
+  std::vector<bool>         pairSelf;
+  for( unsigned int j = 0; j < m_NBaselines; ++j )
+    {
+    pairFirst.push_back( j );
+    pairSecond.push_back( j );
+    pairScale.push_back( sqh * 0.0625f );
+    pairSelf.push_back( true );
+    }
+  for( unsigned int j = 0; j < m_NDWI; ++j )
+    {
+    for( unsigned int g = 0; g < m_Neighbours; ++g )
+      {
+      unsigned int second = j;
+      if( g > 0 )
+        {
+        for( unsigned int k = 0; k < m_NDWI; ++k )
+          {
+          if( m_DWI[k] == m_NeighboursInd[j][g] )
+            {
+            second = k;
+            break;
+            }
+          }
+        }
+      pairFirst.push_back( m_NBaselines + j );
+      pairSecond.push_back( m_NBaselines + second );
+      pairScale.push_back( sqh );
+      pairSelf.push_back( g == 0 );
+      }
+    }
+  const unsigned int numPairs = pairFirst.size();
+  // -------------------------------------------------------------------------------------------------------------
+  // SEPARABLE GAUSSIAN WINDOW (std=1):
+  // The central weight is the one of the closest pixel to the center, as in the neighbourhood implementation
+  std::vector<std::vector<float> > window( Dimension );
+  float                            windowSum = 1.0f;
+  bool                             hasNeighbours = false;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    const int radius = m_RComp[d];
+    float     sum    = 0.0f;
+    for( int t = -radius; t <= radius; ++t )
+      {
+      window[d].push_back( ::exp( -static_cast<float>( t * t ) / 2 ) );
+      sum += window[d].back();
+      }
+    windowSum *= sum;
+    hasNeighbours = hasNeighbours || radius > 0;
+    }
+  const float centerCorrection = ( hasNeighbours ? ::exp( -0.5f ) - 1.0f : 0.0f );
+  const float windowNorm = 1.0f / ( windowSum + centerCorrection );
+  // -------------------------------------------------------------------------------------------------------------
+  // BLOCKS:
+  // Split the region until the differences of a padded block fit in a few megabytes
+  const InputImageIndexType regionStart = outputRegionForThread.GetIndex();
+  const InputImageSizeType  regionSize  = outputRegionForThread.GetSize();
+  InputImageSizeType        blockSize   = regionSize;
+  const unsigned long       maxValues   = 1 << 19;
+  for( ;; )
+    {
+    unsigned long paddedSize = 1;
+    unsigned int  largest = 0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      paddedSize *= blockSize[d] + 2 * m_RComp[d];
+      if( blockSize[d] > blockSize[largest] )
+        {
+        largest = d;
+        }
+      }
+    if( paddedSize * numPairs <= maxValues || blockSize[largest] <= 1 )
+      {
+      break;
+      }
+    blockSize[largest] = ( blockSize[largest] + 1 ) / 2;
+    }
+  unsigned long paddedBlockSize = 1;
+  unsigned long blockVoxels = 1;
+  unsigned long maxGatherSize = 1;
+  unsigned long numBlocks = 1;
+  unsigned long blocksPerDim[Dimension];
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    paddedBlockSize *= blockSize[d] + 2 * m_RComp[d];
+    blockVoxels     *= blockSize[d];
+    maxGatherSize   *= blockSize[d] + 2 * m_RComp[d] + 3 * m_RSearch[d];
+    blocksPerDim[d]  = ( regionSize[d] + blockSize[d] - 1 ) / blockSize[d];
+    numBlocks       *= blocksPerDim[d];
+    }
+  std::vector<float>  gathered( maxGatherSize * numChannels );
+  std::vector<float>  differences( paddedBlockSize * numPairs );
+  std::vector<float>  pass1( paddedBlockSize * numPairs );
+  std::vector<float>  pass2( paddedBlockSize * numPairs );
+  std::vector<double> sumWeights( blockVoxels * numChannels );
+  std::vector<double> sumValues( blockVoxels * numChannels );
+  std::vector<float>  maxWeights( blockVoxels * numChannels );
+  std::vector<long>   offsetLow[Dimension];
+  std::vector<long>   offsetHigh[Dimension];
+  for( unsigned long block = 0; block < numBlocks; ++block )
+    {
+    // ---------------------
+    // Extent of the block:
+    InputImageIndexType bStart;
+    unsigned int        bSize[Dimension];
+    unsigned long rest = block;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      const unsigned long b = rest % blocksPerDim[d];
+      rest /= blocksPerDim[d];
+      bStart[d] = regionStart[d] + b * blockSize[d];
+      bSize[d]  = std::min( blockSize[d], regionSize[d] - b * blockSize[d] );
+      }
+    // ---------------------
+    // Search offsets of each coordinate of the block. As in the neighbourhood implementation, the search region is
+    // shifted inside the image at its lower boundary and cropped at its upper boundary:
+    long oMin[Dimension];
+    long oMax[Dimension];
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      const long size   = largestRegion.GetSize()[d];
+      const long radius = m_RSearch[d];
+      offsetLow[d].resize( bSize[d] );
+      offsetHigh[d].resize( bSize[d] );
+      oMin[d] = 0;
+      oMax[d] = 1;
+      for( unsigned int i = 0; i < bSize[d]; ++i )
+        {
+        const long x  = bStart[d] + i - largestRegion.GetIndex()[d];
+        const long lo = std::max( x - radius, 0L );
+        const long hi = std::min( lo + 2 * radius + 1, size );
+        offsetLow[d][i]  = lo - x;
+        offsetHigh[d][i] = hi - x;
+        oMin[d] = std::min( oMin[d], lo - x );
+        oMax[d] = std::max( oMax[d], hi - x );
+        }
+      }
+    // ---------------------
+    // Copy the channels of the voxels needed by the block (with Neumann boundary conditions):
+    InputImageIndexType gStart;
+    unsigned long       gExtent[Dimension];
+    unsigned long       gStride[Dimension];
+    unsigned long       gSize = 1;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      gStart[d]  = bStart[d] - static_cast<long>( m_RComp[d] ) + oMin[d];
+      gExtent[d] = bSize[d] + 2 * m_RComp[d] + ( oMax[d] - 1 - oMin[d] );
+      gStride[d] = gSize;
+      gSize     *= gExtent[d];
+      }
+    for( unsigned long q = 0; q < gSize; ++q )
+      {
+      InputImageIndexType idx;
+      unsigned long       r = q;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        const long first = bufferedRegion.GetIndex()[d];
+        const long last  = first + static_cast<long>( bufferedRegion.GetSize()[d] ) - 1;
+        idx[d] = std::min( std::max( gStart[d] + static_cast<long>( r % gExtent[d] ), first ), last );
+        r     /= gExtent[d];
+        }
+      const InputPixelType pixel = input->GetPixel( idx );
+      float*               g = &gathered[q * numChannels];
+      for( unsigned int c = 0; c < numChannels; ++c )
+        {
+        g[c] = pixel[channels[c]];
+        }
+      }
+    // ---------------------
+    // Positions in the copied voxels of the padded block and of the block:
+    unsigned int  pExtent[Dimension];
+    unsigned long pRows = 1;
+    unsigned long bRows = 1;
+    unsigned long pOrigin = 0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      pExtent[d] = bSize[d] + 2 * m_RComp[d];
+      pOrigin   += -oMin[d] * gStride[d];
+      if( d > 0 )
+        {
+        pRows *= pExtent[d];
+        bRows *= bSize[d];
+        }
+      }
+    const unsigned long numVoxels = bRows * bSize[0];
+    std::fill( sumWeights.begin(), sumWeights.begin() + numVoxels * numChannels, 0.0 );
+    std::fill( sumValues.begin(), sumValues.begin() + numVoxels * numChannels, 0.0 );
+    std::fill( maxWeights.begin(), maxWeights.begin() + numVoxels * numChannels, -100.0f );
+    // -------------------------------------------------------------------------------------------------------------
+    // ACCUMULATE THE WEIGHTED AVERAGES, FOR EACH SEARCH OFFSET
+    unsigned long numOffsets = 1;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      numOffsets *= oMax[d] - oMin[d];
+      }
+    for( unsigned long n = 0; n < numOffsets; ++n )
+      {
+      long          offset[Dimension];
+      long          offsetPosition = 0;
+      bool          isCenter = true;
+      bool          isUsed = true;
+      unsigned long r = n;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        offset[d] = oMin[d] + static_cast<long>( r % ( oMax[d] - oMin[d] ) );
+        r        /= oMax[d] - oMin[d];
+        offsetPosition += offset[d] * static_cast<long>( gStride[d] );
+        isCenter = isCenter && offset[d] == 0;
+        bool used = false;
+        for( unsigned int i = 0; i < bSize[d] && !used; ++i )
+          {
+          used = offset[d] >= offsetLow[d][i] && offset[d] < offsetHigh[d][i];
+          }
+        isUsed = isUsed && used;
+        }
+      if( !isUsed )
+        {
+        continue;
+        }
+      // ---------------------
+      // Squared differences in the padded block:
+      float* e = &differences[0];
+      for( unsigned long row = 0; row < pRows; ++row )
+        {
+        unsigned long base = pOrigin;
+        unsigned long rr = row;
+        for( unsigned int d = 1; d < Dimension; ++d )
+          {
+          base += ( rr % pExtent[d] ) * gStride[d];
+          rr   /= pExtent[d];
+          }
+        for( unsigned int i = 0; i < pExtent[0]; ++i, e += numPairs )
+          {
+          const float* ga = &gathered[( base + i ) * numChannels];
+          const float* gb = ga + offsetPosition * static_cast<long>( numChannels );
+          for( unsigned int p = 0; p < numPairs; ++p )
+            {
+            const float aux = ga[pairFirst[p]] - gb[pairSecond[p]];
+            e[p] = aux * aux;
+            }
+          }
+        }
+      // ---------------------
+      // Sums over the patches, one dimension at a time:
+      const float* sums = &differences[0];
+      unsigned int extent[Dimension];
+      std::copy( pExtent, pExtent + Dimension, extent );
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        if( m_RComp[d] == 0 )
+          {
+          continue;
+          }
+        float* out = ( sums == &pass1[0] ? &pass2[0] : &pass1[0] );
+        ConvolveBlock( sums, extent, d, &window[d][0], m_RComp[d], numPairs, out );
+        extent[d] -= 2 * m_RComp[d];
+        sums = out;
+        }
+      // ---------------------
+      // Weights of the searched voxels:
+      unsigned long voxel = 0;
+      for( unsigned long row = 0; row < bRows; ++row )
+        {
+        unsigned long center = m_RComp[0];        // Position of the voxel in the padded block
+        unsigned long position = pOrigin + m_RComp[0]; // Position of the voxel in the copied voxels
+        unsigned long pStride = pExtent[0];
+        unsigned long rr = row;
+        bool          rowUsed = true;
+        for( unsigned int d = 1; d < Dimension; ++d )
+          {
+          const unsigned int i = rr % bSize[d];
+          rr       /= bSize[d];
+          center   += ( i + m_RComp[d] ) * pStride;
+          position += ( i + m_RComp[d] ) * gStride[d];
+          pStride  *= pExtent[d];
+          rowUsed = rowUsed && offset[d] >= offsetLow[d][i] && offset[d] < offsetHigh[d][i];
+          }
+        if( !rowUsed )
+          {
+          voxel += bSize[0];
+          continue;
+          }
+        for( unsigned int i = 0; i < bSize[0]; ++i, ++voxel, ++center, ++position )
+          {
+          if( offset[0] < offsetLow[0][i] || offset[0] >= offsetHigh[0][i] )
+            {
+            continue;
+            }
+          const float* g = &gathered[( position + offsetPosition ) * numChannels];
+          const float* sum = sums + voxel * numPairs;
+          const float* ec = &differences[center * numPairs];
+          double*      sw = &sumWeights[voxel * numChannels];
+          double*      sv = &sumValues[voxel * numChannels];
+          float*       mw = &maxWeights[voxel * numChannels];
+          for( unsigned int p = 0; p < numPairs; ++p )
+            {
+            if( isCenter && pairSelf[p] )
+              {
+              continue;
+              }
+            const float dist = ( sum[p] + centerCorrection * ec[p] ) * windowNorm;
+            const float w    = ::exp( -dist * pairScale[p] );
+            const float v    = g[pairSecond[p]];
+            const unsigned int c = pairFirst[p];
+            sw[c] += w;
+            sv[c] += w * v * v;
+            if( w > mw[c] )
+              {
+              mw[c] = w;
+              }
+            }
+          }
+        }
+      }
+    // -------------------------------------------------------------------------------------------------------------
+    // SET THE OUTPUT PIXELS
+    for( unsigned long voxel = 0; voxel < numVoxels; ++voxel )
+      {
+      InputImageIndexType idx;
+      unsigned long       position = pOrigin;
+      unsigned long       vr = voxel;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        idx[d]    = bStart[d] + static_cast<long>( vr % bSize[d] );
+        position += ( vr % bSize[d] + m_RComp[d] ) * gStride[d];
+        vr       /= bSize[d];
+        }
+      OutputPixelType op = input->GetPixel( idx );
+      const float*    g = &gathered[position * numChannels];
+      for( unsigned int c = 0; c < numChannels; ++c )
+        {
+        const float  max = maxWeights[voxel * numChannels + c];
+        const double center = ( max > 1e-6 ? max : 1.0f );
+        const double v = g[c];
+        float        value = static_cast<float>( ( sumValues[voxel * numChannels + c] + center * v * v )
+                                                 / ( sumWeights[voxel * numChannels + c] + center ) );
+        // Remove Rician bias:
+        value -= 2.0f * m_Sigma * m_Sigma;
+        value = ( value > 1e-10 ? ::sqrt(value) : itk::NumericTraits<float>::Zero );
+        op[channels[c]] = static_cast<ScalarType>(value);
+        }
+      output->SetPixel( idx, op );
+      }
+    }
+}
+
 } // end namespace itk
 
 #endif
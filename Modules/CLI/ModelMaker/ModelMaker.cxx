@@ -26,12 +26,14 @@ Version:   $Revision$
 #include "vtkMRMLModelStorageNode.h"
 #include "vtkMRMLScene.h"
 
+// SlicerBaseLogic includes
+#include "vtkSlicerMeshProcessingFilter.h"
+
 // vtkITK includes
 #include "vtkITKArchetypeImageSeriesScalarReader.h"
 
 // VTK includes
 #include <vtkDebugLeaks.h>
-#include <vtkDecimatePro.h>
 #include <vtkDiscreteMarchingCubes.h>
 #include <vtkGeometryFilter.h>
 #include <vtkImageAccumulate.h>
@@ -279,7 +281,7 @@ int main(int argc, char * argv[])
   vtkSmartPointer<vtkSmoothPolyDataFilter>          smootherPoly;
 
   vtkSmartPointer<vtkImageConstantPad>        padder;
-  vtkSmartPointer<vtkDecimatePro>             decimator;
+  vtkSmartPointer<vtkSlicerMeshProcessingFilter> decimator;
   vtkSmartPointer<vtkMarchingCubes>           mcubes;
   vtkSmartPointer<vtkImageThreshold>          imageThreshold;
   vtkSmartPointer<vtkThreshold>               threshold;
@@ -1190,14 +1192,13 @@ int main(int argc, char * argv[])
       }
     if (!skipLabel)
       {
-      // In switch from vtk 4 to vtk 5, vtkDecimate was deprecated from the Patented dir, use vtkDecimatePro
-      // TODO: look at vtkQuadraticDecimation
+      // Quadric error decimation, it preserves the topology of the surface
       if (decimator != NULL)
         {
         decimator->SetInput(NULL);
         decimator = NULL;
         }
-      decimator = vtkSmartPointer<vtkDecimatePro>::New();
+      decimator = vtkSmartPointer<vtkSlicerMeshProcessingFilter>::New();
       std::string            comment6 = "Decimate " + labelName;
       vtkPluginFilterWatcher watchImageThreshold(decimator,
                                                  comment6.c_str(),
@@ -1217,18 +1218,8 @@ int main(int argc, char * argv[])
         {
         decimator->SetInput(geometryFilter->GetOutput());
         }
-      decimator->SetFeatureAngle(60);
-      // decimator->SetMaximumIterations(Decimate);
-      // decimator->SetMaximumSubIterations(0);
-
-      // decimator->PreserveEdgesOn();
-      decimator->SplittingOff();
-      decimator->PreserveTopologyOn();
-
-      decimator->SetMaximumError(1);
+      decimator->DecimationOn();
       decimator->SetTargetReduction(Decimate);
-      // decimator->SetInitialError(0.0002);
-      // decimator->SetErrorIncrement(0.002);
       (decimator->GetOutput())->ReleaseDataFlagOff();
 
       try
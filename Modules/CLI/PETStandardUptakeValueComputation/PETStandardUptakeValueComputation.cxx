@@ -16,10 +16,7 @@
 
 // VTK includes
 #include <vtkGlobFileNames.h>
-#include <vtkImageAccumulate.h>
 #include <vtkImageData.h>
-#include <vtkImageThreshold.h>
-#include <vtkImageToImageStencil.h>
 #include <vtkNew.h>
 
 // ITK includes
@@ -34,6 +31,11 @@
 #undef HAVE_SSTREAM // stupid DCMTK Header issue
 #include "itkDCMTKFileReader.h"
 
+#include "SUVStatisticsCalculator.h"
+
+// STD includes
+#include <vector>
+
 // ...
 // ...............................................................................................
 // ...
@@ -94,6 +96,7 @@ struct parameters
   {
     std::string PETDICOMPath;
     std::string PETVolumeName;
+    std::vector<std::string> PETFrameVolumeNames;
     std::string VOIVolumeName;
     std::string VOIVolumeColorTableFile;
     std::string parameterFile;
@@ -738,25 +741,87 @@ double DecayCorrection(parameters & list, double inVal )
 // ...
 // ...............................................................................................
 // ...
-const char * MapLabelIDtoColorName( int id, std::string colorFile )
+bool ReadColorTable( std::string colorFile, vtkMRMLColorTableNode * colorNode )
 {
   // use the colour table that was passed in with the VOI volume
-
-  const char *colorName = "";
-
-  vtkNew<vtkMRMLColorTableNode> colorNode;
   vtkNew<vtkMRMLColorTableStorageNode> colorStorageNode;
   colorStorageNode->SetFileName(colorFile.c_str() );
 
-  if( !colorStorageNode->ReadData(colorNode.GetPointer()) )
+  if( !colorStorageNode->ReadData(colorNode) )
     {
     std::cerr << "Error reading colour file " << colorStorageNode->GetFileName() << endl;
+    return false;
     }
-  else
+  return true;
+}
+
+// ...
+// ...............................................................................................
+// ...
+std::string MapLabelIDtoColorName( int id, vtkMRMLColorTableNode * colorNode )
+{
+  const char *colorName = colorNode ? colorNode->GetColorName(id) : NULL;
+  return colorName ? colorName : "";
+}
+
+// ...
+// ...............................................................................................
+// ...
+// Append a line per label with voxels to the output CSV file. The lines of a
+// dynamic PET study end with the frame number (frame < 0 otherwise).
+void AppendSUVStatisticsToCSV( parameters & list, const std::vector<SUVStatistics> & statistics,
+                               int labelMin, vtkMRMLColorTableNode * colorNode,
+                               bool validDose, int frame )
+{
+  std::string outputFile = list.SUVOutputTable;
+  if( outputFile.compare("") == 0 )
     {
-    colorName = colorNode->GetColorName(id);
+    return;
     }
-  return colorName;
+  // open file containing suvs and append to it.
+  std::ofstream ofile;
+  ofile.open( outputFile.c_str(), ios::out | ios::app );
+  if( !ofile.is_open() )
+    {
+    // report error, clean up, and get out.
+    std::cerr << "ERROR: cannot open nuclear medicine output csv parameter file '" << outputFile.c_str() << "', see return strings for values" << std::endl;
+    return;
+    }
+  for( size_t l = 0; l < statistics.size(); ++l )
+    {
+    const SUVStatistics & labelStatistics = statistics[l];
+    if( labelStatistics.Count == 0 )
+      {
+      continue;
+      }
+    int i = labelMin + static_cast<int>(l);
+    std::string labelName = MapLabelIDtoColorName(i, colorNode);
+    if( labelName.empty() )
+      {
+      labelName = "unknown";
+      }
+    // oops, weight by dose is infinity. make a ridiculous number.
+    double suvmin = validDose ? labelStatistics.Min : 99999999999999999.;
+    double suvmax = validDose ? labelStatistics.Max : 99999999999999999.;
+    double suvmean = validDose ? labelStatistics.GetMean() : 99999999999999999.;
+    double suvpeak = validDose ? labelStatistics.Peak : 99999999999999999.;
+
+    // --- for each value..
+    // --- format looks like:
+    // patientID, studyDate, dose, labelID, suvmin, suvmax, suvmean, labelName, suvpeak, voxelCount[, frame]
+    // ...
+    std::stringstream ss;
+    ss << list.patientName << ", " << list.studyDate << ", " << list.injectedDose  << ", "  << i << ", " << suvmin << ", " << suvmax
+       << ", " << suvmean << ", " << labelName.c_str() << ", " << suvpeak << ", " << labelStatistics.Count;
+    if( frame >= 0 )
+      {
+      ss << ", " << frame;
+      }
+    ss << std::endl;
+    ofile << ss.str();
+    std::cout << "Wrote output for label " << labelName.c_str() << " to " << outputFile.c_str() << std::endl;
+    }
+  ofile.close();
 }
 
 // ...
@@ -783,7 +848,6 @@ int LoadImagesAndComputeSUV( parameters & list, T )
   // for writing csv output files
   //
   std::string   outputFile = list.SUVOutputTable;
-  std::ofstream ofile;
   std::string  outputStringFile = list.SUVOutputStringFile;
   std::ofstream stringFile;
   vtkImageData *                    petVolume;
@@ -1356,7 +1420,55 @@ int LoadImagesAndComputeSUV( parameters & list, T )
     return EXIT_FAILURE;
     }
 
-  double suvmax, suvmin, suvmean;
+  // --- we want to use the following units as noted at file top:
+  // --- CPET(t) -- tissue radioactivity in pixels-- kBq/mlunits
+  // --- injectced dose-- MBq and
+  // --- patient weight-- kg.
+  // --- computed SUV should be in units g/ml
+  double weight = list.patientWeight;
+  double dose = list.injectedDose;
+
+  // --- do some error checking and reporting.
+  if( dose == 0.0 )
+    {
+    std::cerr << "ComputeSUV: Got NULL dose!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( weight == 0.0 )
+    {
+    std::cerr << "ComputeSUV: got zero weight!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // --- the decay correction is computed once for all the labels
+  double tissueConversionFactor = ConvertRadioactivityUnits(1, list.radioactivityUnits.c_str(), "kBq");
+  dose  = ConvertRadioactivityUnits( dose, list.radioactivityUnits.c_str(), "MBq");
+  dose = DecayCorrection(list, dose);
+  weight = ConvertWeightUnits( weight, list.weightUnits.c_str(), "kg");
+
+  // --- check a possible multiply by slope -- take intercept into account?
+  SUVStatisticsCalculator calculator;
+  if( dose == 0.0 )
+    {
+    std::cerr << "Warning: got an injected dose of 0.0. Results of SUV computation not valid." << std::endl;
+    }
+  else
+    {
+    calculator.SetSUVFactor(tissueConversionFactor * weight / dose);
+    }
+
+  // --- accumulate the statistics of all the labels in one pass
+  std::vector<SUVStatistics> statistics;
+  calculator.SetLabels(voiVolume);
+  if( !calculator.Compute(petVolume, statistics) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  bool colorTableRead = ReadColorTable(list.VOIVolumeColorTableFile, colorNode.GetPointer() );
+
+  double suvmax, suvmin, suvmean, suvpeak;
 
   // make up a string with output to return
   std::string outputLabelString = "OutputLabel = ";
@@ -1364,121 +1476,55 @@ int LoadImagesAndComputeSUV( parameters & list, T )
   std::string outputSUVMaxString = "SUVMax = ";
   std::string outputSUVMeanString = "SUVMean = ";
   std::string outputSUVMinString = "SUVMin = ";
+  std::string outputSUVPeakString = "SUVPeak = ";
 
-  // --- find the max and min label in mask
-  vtkImageAccumulate *stataccum = vtkImageAccumulate::New();
-  stataccum->SetInput( voiVolume );
-  stataccum->Update();
-  int lo = static_cast<int>(stataccum->GetMin()[0]);
-  int hi = static_cast<int>(stataccum->GetMax()[0]);
-  stataccum->Delete();
-
-  std::string labelName;
-  int         NumberOfVOIs = 0;
-  for( int i = lo; i <= hi; i++ )
+  // --- the last label with voxels ends the output strings
+  int hi = 0;
+  for( size_t l = 0; l < statistics.size(); ++l )
     {
-    std::stringstream ss;
-    if( i == 0 )
-      {
-      // --- eliminate 0 (background) label.
-      continue;
-      }
-
-    labelName.clear();
-    labelName = MapLabelIDtoColorName(i, list.VOIVolumeColorTableFile);
-    if( labelName.empty() )
+    if( statistics[l].Count > 0 )
       {
-      labelName.clear();
-      labelName = "unknown";
+      hi = calculator.GetLabelMin() + static_cast<int>(l);
       }
+    }
 
-    // --- get label name from labelID
-
-    suvmax = 0.0;
-    suvmean = 0.0;
-
-    // create the binary volume of the label
-    vtkImageThreshold *thresholder = vtkImageThreshold::New();
-    thresholder->SetInput(voiVolume);
-    thresholder->SetInValue(1);
-    thresholder->SetOutValue(0);
-    thresholder->ReplaceOutOn();
-    thresholder->ThresholdBetween(i, i);
-    thresholder->SetOutputScalarType(petVolume->GetScalarType() );
-    thresholder->Update();
-
-    // use vtk's statistics class with the binary labelmap as a stencil
-    vtkImageToImageStencil *stencil = vtkImageToImageStencil::New();
-    stencil->SetInput(thresholder->GetOutput() );
-    stencil->ThresholdBetween(1, 1);
-
-    vtkImageAccumulate *labelstat = vtkImageAccumulate::New();
-    labelstat->SetInput(petVolume);
-    labelstat->SetStencil(stencil->GetOutput() );
-    labelstat->Update();
-
-    stencil->Delete();
+  std::string labelName;
+  int         NumberOfVOIs = 0;
+  for( size_t l = 0; l < statistics.size(); ++l )
+    {
+    int i = calculator.GetLabelMin() + static_cast<int>(l);
+    const SUVStatistics & labelStatistics = statistics[l];
 
     // --- For how many labels was SUV computed?
 
-    int voxNumber = labelstat->GetVoxelCount();
-    if( voxNumber > 0 )
+    if( labelStatistics.Count > 0 )
       {
       NumberOfVOIs++;
 
-      double CPETmin = (labelstat->GetMin() )[0];
-      double CPETmax = (labelstat->GetMax() )[0];
-      double CPETmean = (labelstat->GetMean() )[0];
-
-      // --- we want to use the following units as noted at file top:
-      // --- CPET(t) -- tissue radioactivity in pixels-- kBq/mlunits
-      // --- injectced dose-- MBq and
-      // --- patient weight-- kg.
-      // --- computed SUV should be in units g/ml
-      double weight = list.patientWeight;
-      double dose = list.injectedDose;
-
-      // --- do some error checking and reporting.
-      if( list.radioactivityUnits.c_str() == NULL )
+      // --- get label name from labelID
+      labelName = MapLabelIDtoColorName(i, colorTableRead ? colorNode.GetPointer() : NULL);
+      if( labelName.empty() )
         {
-        std::cerr << "ComputeSUV: Got null radioactivityUnits." << std::endl;
-        return EXIT_FAILURE;
+        labelName = "unknown";
         }
-      if( dose == 0.0 )
-        {
-        std::cerr << "ComputeSUV: Got NULL dose!" << std::endl;
-        return EXIT_FAILURE;
-        }
-      if( weight == 0.0 )
-        {
-        std::cerr << "ComputeSUV: got zero weight!" << std::endl;
-        return EXIT_FAILURE;
-        }
-
-      double tissueConversionFactor = ConvertRadioactivityUnits(1, list.radioactivityUnits.c_str(), "kBq");
-      dose  = ConvertRadioactivityUnits( dose, list.radioactivityUnits.c_str(), "MBq");
-      dose = DecayCorrection(list, dose);
-      weight = ConvertWeightUnits( weight, list.weightUnits.c_str(), "kg");
 
-      // --- check a possible multiply by slope -- take intercept into account?
       if( dose == 0.0 )
         {
         // oops, weight by dose is infinity. make a ridiculous number.
         suvmin = 99999999999999999.;
         suvmax = 99999999999999999.;
         suvmean = 99999999999999999.;
-        std::cerr << "Warning: got an injected dose of 0.0. Results of SUV computation not valid." << std::endl;
+        suvpeak = 99999999999999999.;
         }
       else
         {
-        double weightByDose = weight / dose;
-        suvmax = (CPETmax * tissueConversionFactor) * weightByDose;
-        suvmin = (CPETmin * tissueConversionFactor ) * weightByDose;
-        suvmean = (CPETmean * tissueConversionFactor) * weightByDose;
+        suvmax = labelStatistics.Max;
+        suvmin = labelStatistics.Min;
+        suvmean = labelStatistics.GetMean();
+        suvpeak = labelStatistics.Peak;
         }
       // --- append to output return string file
       std::stringstream outputStringStream;
-//      outputStringStream << list.patientName << ", " << list.studyDate << ", " << list.injectedDose  << ", "  << i << ", " << suvmax << ", " << suvmean << ", " << labelName.c_str() << ", " << ", " << ", " << ", " << std::endl;
       std::string postfixStr = ", ";
       if (i == hi)
         {
@@ -1499,38 +1545,51 @@ int LoadImagesAndComputeSUV( parameters & list, T )
       outputStringStream.str("");
       outputStringStream << suvmin << postfixStr;
       outputSUVMinString += outputStringStream.str();
+      outputStringStream.str("");
+      outputStringStream << suvpeak << postfixStr;
+      outputSUVPeakString += outputStringStream.str();
+      }
+    }
 
-      // --- write output CSV file
+  // --- write output CSV file
+  int frame = list.PETFrameVolumeNames.empty() ? -1 : 0;
+  AppendSUVStatisticsToCSV(list, statistics, calculator.GetLabelMin(),
+                           colorTableRead ? colorNode.GetPointer() : NULL, dose != 0.0, frame);
 
-      // open file containing suvs and append to it.
-      if (outputFile.compare("") != 0)
-        {
-        ofile.open( outputFile.c_str(), ios::out | ios::app );
-        if( !ofile.is_open() )
-          {
-          // report error, clean up, and get out.
-          std::cerr << "ERROR: cannot open nuclear medicine output csv parameter file '" << outputFile.c_str() << "', see return strings for values" << std::endl;
-          }
-        else
-          {
-          // --- for each value..
-          // --- format looks like:
-          // patientID, studyDate, dose, labelID, suvmin, suvmax, suvmean, labelName
-          // ...
-          ss.str("");
-          ss << list.patientName << ", " << list.studyDate << ", " << list.injectedDose  << ", "  << i << ", " << suvmin << ", " << suvmax
-             << ", " << suvmean << ", " << labelName.c_str() << std::endl;
-          ofile << ss.str();
-          ofile.close();
-          std::cout << "Wrote output for label " << labelName.c_str() << " to " << outputFile.c_str() << std::endl;
-          }
-        }
+  // --- frames of a dynamic PET study, with the labels and the SUV factor
+  // --- of the PET volume. The output strings only show the PET volume.
+  if( !list.PETFrameVolumeNames.empty() && outputFile.compare("") == 0 )
+    {
+    std::cerr << "The SUV statistics of the PET frames are only written in the output csv file, specify it to compute them." << std::endl;
+    }
+  for( size_t f = 0; f < list.PETFrameVolumeNames.size() && outputFile.compare("") != 0; ++f )
+    {
+    const std::string & frameVolumeName = list.PETFrameVolumeNames[f];
+    FILE * framefile = fopen(frameVolumeName.c_str(), "r");
+    if( framefile == NULL )
+      {
+      std::cerr << "ERROR: cannot open PET frame file '" << frameVolumeName.c_str() << "'" << endl;
+      return EXIT_FAILURE;
       }
+    fclose(framefile);
 
+    vtkNew<vtkITKArchetypeImageSeriesScalarReader> frameReader;
+    frameReader->SetArchetype(frameVolumeName.c_str() );
+    frameReader->SetOutputScalarTypeToNative();
+    frameReader->SetDesiredCoordinateOrientationToNative();
+    frameReader->SetUseNativeOriginOn();
+    frameReader->Update();
+    std::cout << "Done reading the file " << frameVolumeName.c_str() << endl;
 
-    thresholder->Delete();
-    labelstat->Delete();
+    if( !calculator.Compute(frameReader->GetOutput(), statistics) )
+      {
+      return EXIT_FAILURE;
+      }
+    AppendSUVStatisticsToCSV(list, statistics, calculator.GetLabelMin(),
+                             colorTableRead ? colorNode.GetPointer() : NULL, dose != 0.0,
+                             static_cast<int>(f) + 1);
     }
+
   // --- write output return string file
   if (outputStringFile.compare("") != 0)
     {
@@ -1540,6 +1599,7 @@ int LoadImagesAndComputeSUV( parameters & list, T )
     ss << outputSUVMaxString << std::endl;
     ss << outputSUVMeanString << std::endl;
     ss << outputSUVMinString << std::endl;
+    ss << outputSUVPeakString << std::endl;
     std::string stringOutput = ss.str();
     stringFile.open(outputStringFile.c_str());
     if (!stringFile.is_open() )
@@ -1617,6 +1677,7 @@ int main( int argc, char * argv[] )
     list.PETDICOMPath = PETDICOMPath;
     // keep the PET volume as the node selector PET volume
     list.PETVolumeName = PETVolume;
+    list.PETFrameVolumeNames = PETFrameVolumes;
     list.VOIVolumeName = VOIVolume;
     list.VOIVolumeColorTableFile = ColorTable;
     list.SUVOutputTable = OutputCSV;
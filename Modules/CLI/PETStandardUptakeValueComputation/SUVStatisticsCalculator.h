@@ -0,0 +1,424 @@
+#ifndef __SUVStatisticsCalculator_h
+#define __SUVStatisticsCalculator_h
+
+// VTK includes
+#include <vtkImageCast.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Keep the class types and function names from colliding when the module
+// is used as shared object module, see PETStandardUptakeValueComputation.cxx
+namespace
+{
+
+// ...
+// ...............................................................................................
+// ...
+// SUV statistics of the voxels of a label
+struct SUVStatistics
+{
+  SUVStatistics()
+    : Count(0), Sum(0.0), Min(VTK_DOUBLE_MAX), Max(-VTK_DOUBLE_MAX), Peak(-VTK_DOUBLE_MAX)
+  {
+  }
+
+  void Merge( const SUVStatistics & other )
+  {
+    this->Count += other.Count;
+    this->Sum += other.Sum;
+    this->Min = std::min(this->Min, other.Min);
+    this->Max = std::max(this->Max, other.Max);
+    this->Peak = std::max(this->Peak, other.Peak);
+  }
+
+  double GetMean() const
+  {
+    return this->Count > 0 ? this->Sum / this->Count : 0.0;
+  }
+
+  vtkIdType Count;
+  double    Sum;
+  double    Min;
+  double    Max;
+  // highest mean SUV of a 1 ml sphere centered on a voxel of the label
+  double    Peak;
+};
+
+// ...
+// ...............................................................................................
+// ...
+// rowSums holds extent[1] - extent[0] + 2 values per row of the extent in
+// the slices [kBegin, kEnd): the sums of the first 0, 1, ... PET values of
+// the row from extent[0]
+template <class T>
+void ComputeRowSums( const T * pet, int petComponents, const int dims[3],
+                     const int extent[6], int kBegin, int kEnd, double * rowSums )
+{
+  const vtkIdType rowSize = extent[1] - extent[0] + 1;
+  const vtkIdType rowsPerSlice = extent[3] - extent[2] + 1;
+  for( int k = kBegin; k < kEnd; ++k )
+    {
+    for( int j = extent[2]; j <= extent[3]; ++j )
+      {
+      const vtkIdType row = (k - extent[4]) * rowsPerSlice + j - extent[2];
+      const T *       values =
+        pet + ( (static_cast<vtkIdType>(k) * dims[1] + j) * dims[0] + extent[0]) * petComponents;
+      double * sums = rowSums + row * (rowSize + 1);
+      sums[0] = 0.0;
+      for( vtkIdType i = 0; i < rowSize; ++i )
+        {
+        sums[i + 1] = sums[i] + values[i * petComponents];
+        }
+      }
+    }
+}
+
+// ...
+// ...............................................................................................
+// ...
+// Mean PET value of the sphere centered on each voxel of the extent in the
+// slices [kBegin, kEnd), clipped by the volume. The sphere is made of rows
+// along i given by (j offset, k offset, half width) triplets, the sum of a
+// row is the difference of two row sums (box filter along i).
+// The row sums cover the extent padded by the sphere and clipped by the
+// volume: clipping the sphere by rowSumsExtent clips it by the volume.
+void ComputeSphereMeans( const double * rowSums, const int rowSumsExtent[6],
+                         const int extent[6], int kBegin, int kEnd,
+                         const std::vector<int> & sphereRows, double * sphereMeans )
+{
+  const vtkIdType rowSize = rowSumsExtent[1] - rowSumsExtent[0] + 1;
+  const vtkIdType rowsPerSlice = rowSumsExtent[3] - rowSumsExtent[2] + 1;
+  const vtkIdType meansRowSize = extent[1] - extent[0] + 1;
+  const vtkIdType meansRowsPerSlice = extent[3] - extent[2] + 1;
+  for( int k = kBegin; k < kEnd; ++k )
+    {
+    for( int j = extent[2]; j <= extent[3]; ++j )
+      {
+      double * means = sphereMeans
+        + ( (k - extent[4]) * meansRowsPerSlice + j - extent[2]) * meansRowSize;
+      for( int i = extent[0]; i <= extent[1]; ++i )
+        {
+        double    sum = 0.0;
+        vtkIdType count = 0;
+        for( size_t n = 0; n < sphereRows.size(); n += 3 )
+          {
+          const int jj = j + sphereRows[n];
+          const int kk = k + sphereRows[n + 1];
+          if( jj < rowSumsExtent[2] || jj > rowSumsExtent[3] ||
+              kk < rowSumsExtent[4] || kk > rowSumsExtent[5] )
+            {
+            continue;
+            }
+          const int      iMin = std::max(i - sphereRows[n + 2], rowSumsExtent[0]);
+          const int      iMax = std::min(i + sphereRows[n + 2], rowSumsExtent[1]);
+          const double * sums = rowSums
+            + ( (kk - rowSumsExtent[4]) * rowsPerSlice + jj - rowSumsExtent[2]) * (rowSize + 1);
+          sum += sums[iMax - rowSumsExtent[0] + 1] - sums[iMin - rowSumsExtent[0]];
+          count += iMax - iMin + 1;
+          }
+        // the center row is always inside of the volume
+        means[i - extent[0]] = sum / count;
+        }
+      }
+    }
+}
+
+// ...
+// ...............................................................................................
+// ...
+template <class T>
+void AccumulateSUVStatistics( const T * pet, int petComponents,
+                              const int * labels, int labelComponents,
+                              const double * sphereMeans,
+                              const int dims[3], const int extent[6], int kBegin, int kEnd,
+                              int labelMin, double suvFactor,
+                              std::vector<SUVStatistics> & statistics )
+{
+  const vtkIdType meansRowSize = extent[1] - extent[0] + 1;
+  const vtkIdType meansRowsPerSlice = extent[3] - extent[2] + 1;
+  for( int k = kBegin; k < kEnd; ++k )
+    {
+    for( int j = extent[2]; j <= extent[3]; ++j )
+      {
+      vtkIdType id = (static_cast<vtkIdType>(k) * dims[1] + j) * dims[0] + extent[0];
+      vtkIdType meanId = ( (k - extent[4]) * meansRowsPerSlice + j - extent[2]) * meansRowSize;
+      for( int i = extent[0]; i <= extent[1]; ++i, ++id, ++meanId )
+        {
+        const int label = labels[id * labelComponents];
+        if( label == 0 )
+          {
+          // --- eliminate 0 (background) label.
+          continue;
+          }
+        SUVStatistics & stat = statistics[label - labelMin];
+        const double suv = pet[id * petComponents] * suvFactor;
+        ++stat.Count;
+        stat.Sum += suv;
+        stat.Min = std::min(stat.Min, suv);
+        stat.Max = std::max(stat.Max, suv);
+        stat.Peak = std::max(stat.Peak, sphereMeans[meanId] * suvFactor);
+        }
+      }
+    }
+}
+
+// ...
+// ...............................................................................................
+// ...
+// Computes the SUV statistics of all the labels of a VOI volume in a single
+// multithreaded pass over a PET volume. The labels and the SUV factor are set
+// once and reused for each frame of a dynamic PET study.
+//
+// SUVpeak uses an image of the mean of the 1 ml sphere centered on each
+// voxel. It is computed once per frame from the running sums of the rows,
+// the peak of a label is then the maximum of the image over the label.
+// Both images only cover the bounding box of the labels, padded by the
+// sphere for the row sums.
+class SUVStatisticsCalculator
+{
+public:
+  SUVStatisticsCalculator()
+    : LabelMin(0), NumberOfLabels(0), SUVFactor(1.0), Frame(NULL), Pass(RowSumsPass)
+  {
+  }
+
+  void SetLabels( vtkImageData * voiVolume )
+  {
+    vtkNew<vtkImageCast> cast;
+    cast->SetInput(voiVolume);
+    cast->SetOutputScalarTypeToInt();
+    cast->Update();
+    this->Labels = vtkSmartPointer<vtkImageData>::New();
+    this->Labels->ShallowCopy(cast->GetOutput() );
+
+    double range[2];
+    this->Labels->GetScalarRange(range);
+    this->LabelMin = static_cast<int>(range[0]);
+    this->NumberOfLabels = static_cast<int>(range[1]) - this->LabelMin + 1;
+
+    // --- rows of the voxels of a 1 ml sphere (radius in mm)
+    const double radius = pow(3000.0 / (4.0 * vtkMath::Pi() ), 1.0 / 3.0);
+    double       spacing[3];
+    int          extent[3];
+    this->Labels->GetSpacing(spacing);
+    for( int n = 0; n < 3; ++n )
+      {
+      spacing[n] = fabs(spacing[n]);
+      extent[n] = spacing[n] > 0.0 ? static_cast<int>(radius / spacing[n]) : 0;
+      }
+    this->SphereRows.clear();
+    for( int k = -extent[2]; k <= extent[2]; ++k )
+      {
+      for( int j = -extent[1]; j <= extent[1]; ++j )
+        {
+        const double y = j * spacing[1];
+        const double z = k * spacing[2];
+        if( y * y + z * z > radius * radius )
+          {
+          continue;
+          }
+        int halfWidth = 0;
+        while( halfWidth < extent[0] )
+          {
+          const double x = (halfWidth + 1) * spacing[0];
+          if( x * x + y * y + z * z > radius * radius )
+            {
+            break;
+            }
+          ++halfWidth;
+          }
+        this->SphereRows.push_back(j);
+        this->SphereRows.push_back(k);
+        this->SphereRows.push_back(halfWidth);
+        }
+      }
+
+    // --- bounding box of the labels, empty without any label
+    int*       dims = this->Labels->GetDimensions();
+    const int* labels = static_cast<int *>(this->Labels->GetScalarPointer() );
+    const int  labelComponents = this->Labels->GetNumberOfScalarComponents();
+    for( int n = 0; n < 3; ++n )
+      {
+      this->LabelExtent[2 * n] = dims[n];
+      this->LabelExtent[2 * n + 1] = -1;
+      }
+    for( int k = 0; k < dims[2]; ++k )
+      {
+      for( int j = 0; j < dims[1]; ++j )
+        {
+        for( int i = 0; i < dims[0]; ++i, labels += labelComponents )
+          {
+          if( *labels == 0 )
+            {
+            continue;
+            }
+          const int ijk[3] = { i, j, k };
+          for( int n = 0; n < 3; ++n )
+            {
+            this->LabelExtent[2 * n] = std::min(this->LabelExtent[2 * n], ijk[n]);
+            this->LabelExtent[2 * n + 1] = std::max(this->LabelExtent[2 * n + 1], ijk[n]);
+            }
+          }
+        }
+      }
+    for( int n = 0; n < 3; ++n )
+      {
+      this->RowSumsExtent[2 * n] = std::max(this->LabelExtent[2 * n] - extent[n], 0);
+      this->RowSumsExtent[2 * n + 1] = std::min(this->LabelExtent[2 * n + 1] + extent[n], dims[n] - 1);
+      }
+  }
+
+  // factor converting the PET values into SUV
+  void SetSUVFactor( double factor )
+  {
+    this->SUVFactor = factor;
+  }
+
+  int GetLabelMin() const
+  {
+    return this->LabelMin;
+  }
+
+  // statistics are indexed by label - GetLabelMin().
+  // Return false if the frame does not match the labels.
+  bool Compute( vtkImageData * petFrame, std::vector<SUVStatistics> & statistics )
+  {
+    int* dims = petFrame->GetDimensions();
+    int* labelDims = this->Labels->GetDimensions();
+    if( dims[0] != labelDims[0] || dims[1] != labelDims[1] || dims[2] != labelDims[2] )
+      {
+      std::cerr << "The PET volume (" << dims[0] << "x" << dims[1] << "x" << dims[2]
+                << ") and the VOI volume (" << labelDims[0] << "x" << labelDims[1] << "x"
+                << labelDims[2] << ") have different dimensions." << std::endl;
+      return false;
+      }
+
+    statistics.assign(this->NumberOfLabels, SUVStatistics() );
+    if( this->LabelExtent[0] > this->LabelExtent[1] )
+      {
+      // --- no label
+      return true;
+      }
+
+    const int*      rowSumsExtent = this->RowSumsExtent;
+    const int*      labelExtent = this->LabelExtent;
+    const vtkIdType rowSumsSize = static_cast<vtkIdType>(rowSumsExtent[1] - rowSumsExtent[0] + 2)
+      * (rowSumsExtent[3] - rowSumsExtent[2] + 1) * (rowSumsExtent[5] - rowSumsExtent[4] + 1);
+    const vtkIdType sphereMeansSize = static_cast<vtkIdType>(labelExtent[1] - labelExtent[0] + 1)
+      * (labelExtent[3] - labelExtent[2] + 1) * (labelExtent[5] - labelExtent[4] + 1);
+    const int numberOfThreads =
+      std::max(1, std::min(vtkMultiThreader::GetGlobalDefaultNumberOfThreads(),
+                           rowSumsExtent[5] - rowSumsExtent[4] + 1) );
+    this->Frame = petFrame;
+    this->RowSums.resize(rowSumsSize);
+    this->SphereMeans.resize(sphereMeansSize);
+    this->ThreadStatistics.assign(numberOfThreads,
+                                  std::vector<SUVStatistics>(this->NumberOfLabels) );
+    this->Threader->SetNumberOfThreads(numberOfThreads);
+    this->Threader->SetSingleMethod(SUVStatisticsCalculator::ThreadedExecute, this);
+    // --- each pass needs the complete output of the previous one
+    this->Pass = RowSumsPass;
+    this->Threader->SingleMethodExecute();
+    this->Pass = SphereMeansPass;
+    this->Threader->SingleMethodExecute();
+    this->Pass = StatisticsPass;
+    this->Threader->SingleMethodExecute();
+    this->Frame = NULL;
+
+    for( int t = 0; t < numberOfThreads; ++t )
+      {
+      for( int l = 0; l < this->NumberOfLabels; ++l )
+        {
+        statistics[l].Merge(this->ThreadStatistics[t][l]);
+        }
+      }
+    this->ThreadStatistics.clear();
+    return true;
+  }
+
+protected:
+  enum PassType
+    {
+    RowSumsPass,
+    SphereMeansPass,
+    StatisticsPass
+    };
+
+  static VTK_THREAD_RETURN_TYPE ThreadedExecute( void * arg )
+  {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+    static_cast<SUVStatisticsCalculator *>(info->UserData)->Execute(
+      info->ThreadID, info->NumberOfThreads);
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // each thread runs the pass on a slab of the slices of the row sums
+  // extent or of the label extent
+  void Execute( int threadId, int numberOfThreads )
+  {
+    int*       dims = this->Frame->GetDimensions();
+    const int* extent = this->Pass == RowSumsPass ? this->RowSumsExtent : this->LabelExtent;
+    const int  numberOfSlices = extent[5] - extent[4] + 1;
+    const int  kBegin = extent[4] + numberOfSlices * threadId / numberOfThreads;
+    const int  kEnd = extent[4] + numberOfSlices * (threadId + 1) / numberOfThreads;
+    const int petComponents = this->Frame->GetNumberOfScalarComponents();
+    void*     pet = this->Frame->GetScalarPointer();
+    if( this->Pass == SphereMeansPass )
+      {
+      ComputeSphereMeans(&this->RowSums[0], this->RowSumsExtent, this->LabelExtent,
+                         kBegin, kEnd, this->SphereRows, &this->SphereMeans[0]);
+      return;
+      }
+    const int* labels = static_cast<int *>(this->Labels->GetScalarPointer() );
+    const int  labelComponents = this->Labels->GetNumberOfScalarComponents();
+    if( this->Pass == RowSumsPass )
+      {
+      switch( this->Frame->GetScalarType() )
+        {
+        vtkTemplateMacro(ComputeRowSums(static_cast<VTK_TT *>(pet), petComponents,
+                                        dims, extent, kBegin, kEnd, &this->RowSums[0]) );
+        default:
+          std::cerr << "Unsupported PET scalar type " << this->Frame->GetScalarTypeAsString()
+                    << std::endl;
+        }
+      return;
+      }
+    switch( this->Frame->GetScalarType() )
+      {
+      vtkTemplateMacro(AccumulateSUVStatistics(static_cast<VTK_TT *>(pet), petComponents,
+                                               labels, labelComponents, &this->SphereMeans[0],
+                                               dims, extent, kBegin, kEnd,
+                                               this->LabelMin, this->SUVFactor,
+                                               this->ThreadStatistics[threadId]) );
+      default:
+        break;
+      }
+  }
+
+  vtkSmartPointer<vtkImageData>            Labels;
+  int                                      LabelMin;
+  int                                      NumberOfLabels;
+  double                                   SUVFactor;
+  std::vector<int>                         SphereRows;
+  int                                      LabelExtent[6];
+  int                                      RowSumsExtent[6];
+  vtkImageData *                           Frame;
+  PassType                                 Pass;
+  std::vector<double>                      RowSums;
+  std::vector<double>                      SphereMeans;
+  vtkNew<vtkMultiThreader>                 Threader;
+  std::vector<std::vector<SUVStatistics> > ThreadStatistics;
+};
+
+} // end of anonymous namespace
+
+#endif
@@ -0,0 +1,314 @@
+#include "../SUVStatisticsCalculator.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageAccumulate.h>
+#include <vtkImageData.h>
+#include <vtkImageThreshold.h>
+#include <vtkImageToImageStencil.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+// ...
+// ...............................................................................................
+// ...
+// Synthetic PET volume: a smooth uptake with two hot spots
+vtkSmartPointer<vtkImageData> CreatePETVolume( double scale )
+{
+  vtkSmartPointer<vtkImageData> pet = vtkSmartPointer<vtkImageData>::New();
+  pet->SetDimensions(40, 36, 30);
+  pet->SetSpacing(2.0, 2.5, 3.0);
+  pet->SetScalarTypeToFloat();
+  pet->SetNumberOfScalarComponents(1);
+  pet->AllocateScalars();
+  float * values = static_cast<float *>(pet->GetScalarPointer() );
+  for( int k = 0; k < 30; ++k )
+    {
+    for( int j = 0; j < 36; ++j )
+      {
+      for( int i = 0; i < 40; ++i )
+        {
+        double value = 1000.0 + 10.0 * ( (i * 7 + j * 13 + k * 17) % 23);
+        value += 8000.0 * exp(-( (i - 12) * (i - 12) + (j - 10) * (j - 10) + (k - 8) * (k - 8) ) / 6.0);
+        value += 5000.0 * exp(-( (i - 30) * (i - 30) + (j - 25) * (j - 25) + (k - 20) * (k - 20) ) / 20.0);
+        *values++ = static_cast<float>(scale * value);
+        }
+      }
+    }
+  return pet;
+}
+
+// ...
+// ...............................................................................................
+// ...
+// Labels 1, 2 and 3 are blocks, label 5 touches the border of the volume
+// and label 4 is not used
+vtkSmartPointer<vtkImageData> CreateVOIVolume()
+{
+  vtkSmartPointer<vtkImageData> voi = vtkSmartPointer<vtkImageData>::New();
+  voi->SetDimensions(40, 36, 30);
+  voi->SetSpacing(2.0, 2.5, 3.0);
+  voi->SetScalarTypeToShort();
+  voi->SetNumberOfScalarComponents(1);
+  voi->AllocateScalars();
+  short * labels = static_cast<short *>(voi->GetScalarPointer() );
+  for( int k = 0; k < 30; ++k )
+    {
+    for( int j = 0; j < 36; ++j )
+      {
+      for( int i = 0; i < 40; ++i )
+        {
+        short label = 0;
+        if( i >= 8 && i <= 16 && j >= 6 && j <= 14 && k >= 5 && k <= 11 )
+          {
+          label = 1;
+          }
+        else if( i >= 25 && i <= 35 && j >= 20 && j <= 30 && k >= 15 && k <= 25 )
+          {
+          label = 2;
+          }
+        else if( i >= 20 && i <= 22 && j >= 2 && j <= 3 && k == 27 )
+          {
+          label = 3;
+          }
+        else if( i >= 37 && j <= 2 && k <= 3 )
+          {
+          label = 5;
+          }
+        *labels++ = label;
+        }
+      }
+    }
+  return voi;
+}
+
+// ...
+// ...............................................................................................
+// ...
+// Statistics of a label computed the way the module used to: a stencil of
+// the thresholded VOI volume and vtkImageAccumulate for the count, min, max
+// and mean, the sphere summed around each voxel of the label for the peak.
+SUVStatistics ComputeReferenceStatistics( vtkImageData * pet, vtkImageData * voi,
+                                          int label, double suvFactor )
+{
+  vtkNew<vtkImageThreshold> thresholder;
+  thresholder->SetInput(voi);
+  thresholder->SetInValue(1);
+  thresholder->SetOutValue(0);
+  thresholder->ReplaceOutOn();
+  thresholder->ThresholdBetween(label, label);
+  thresholder->SetOutputScalarType(pet->GetScalarType() );
+  thresholder->Update();
+
+  vtkNew<vtkImageToImageStencil> stencil;
+  stencil->SetInput(thresholder->GetOutput() );
+  stencil->ThresholdBetween(1, 1);
+
+  vtkNew<vtkImageAccumulate> labelstat;
+  labelstat->SetInput(pet);
+  labelstat->SetStencil(stencil->GetOutput() );
+  labelstat->Update();
+
+  SUVStatistics statistics;
+  statistics.Count = labelstat->GetVoxelCount();
+  if( statistics.Count == 0 )
+    {
+    return statistics;
+    }
+  statistics.Min = labelstat->GetMin()[0] * suvFactor;
+  statistics.Max = labelstat->GetMax()[0] * suvFactor;
+  statistics.Sum = labelstat->GetMean()[0] * suvFactor * statistics.Count;
+
+  // --- offsets of the voxels of a 1 ml sphere (radius in mm)
+  const double radius = pow(3000.0 / (4.0 * vtkMath::Pi() ), 1.0 / 3.0);
+  double *     spacing = pet->GetSpacing();
+  int          extent[3];
+  for( int n = 0; n < 3; ++n )
+    {
+    extent[n] = static_cast<int>(radius / spacing[n]);
+    }
+  std::vector<int> offsets;
+  for( int k = -extent[2]; k <= extent[2]; ++k )
+    {
+    for( int j = -extent[1]; j <= extent[1]; ++j )
+      {
+      for( int i = -extent[0]; i <= extent[0]; ++i )
+        {
+        const double x = i * spacing[0];
+        const double y = j * spacing[1];
+        const double z = k * spacing[2];
+        if( x * x + y * y + z * z <= radius * radius )
+          {
+          offsets.push_back(i);
+          offsets.push_back(j);
+          offsets.push_back(k);
+          }
+        }
+      }
+    }
+
+  int * dims = pet->GetDimensions();
+  for( int k = 0; k < dims[2]; ++k )
+    {
+    for( int j = 0; j < dims[1]; ++j )
+      {
+      for( int i = 0; i < dims[0]; ++i )
+        {
+        if( voi->GetScalarComponentAsDouble(i, j, k, 0) != label )
+          {
+          continue;
+          }
+        double sum = 0.0;
+        int    count = 0;
+        for( size_t n = 0; n < offsets.size(); n += 3 )
+          {
+          const int ii = i + offsets[n];
+          const int jj = j + offsets[n + 1];
+          const int kk = k + offsets[n + 2];
+          if( ii < 0 || ii >= dims[0] || jj < 0 || jj >= dims[1] || kk < 0 || kk >= dims[2] )
+            {
+            continue;
+            }
+          sum += pet->GetScalarComponentAsDouble(ii, jj, kk, 0);
+          ++count;
+          }
+        statistics.Peak = std::max(statistics.Peak, sum * suvFactor / count);
+        }
+      }
+    }
+  return statistics;
+}
+
+// ...
+// ...............................................................................................
+// ...
+bool IsClose( double value, double expected )
+{
+  return fabs(value - expected) <= 1e-9 * std::max(1.0, fabs(expected) );
+}
+
+// ...
+// ...............................................................................................
+// ...
+bool CheckStatistics( vtkImageData * pet, vtkImageData * voi, int labelMin,
+                      const std::vector<SUVStatistics> & statistics, double suvFactor )
+{
+  if( labelMin != 0 || statistics.size() != 6 )
+    {
+    std::cerr << "Wrong labels: " << labelMin << ", " << statistics.size() << std::endl;
+    return false;
+    }
+  for( int label = 1; label <= 5; ++label )
+    {
+    const SUVStatistics & labelStatistics = statistics[label - labelMin];
+    SUVStatistics         expected = ComputeReferenceStatistics(pet, voi, label, suvFactor);
+    if( labelStatistics.Count != expected.Count ||
+        (expected.Count > 0 &&
+         (!IsClose(labelStatistics.Min, expected.Min) ||
+          !IsClose(labelStatistics.Max, expected.Max) ||
+          !IsClose(labelStatistics.GetMean(), expected.GetMean() ) ||
+          !IsClose(labelStatistics.Peak, expected.Peak) ) ) )
+      {
+      std::cerr << "Wrong statistics of label " << label << ":"
+                << " count " << labelStatistics.Count << " (expected " << expected.Count << ")"
+                << " min " << labelStatistics.Min << " (" << expected.Min << ")"
+                << " max " << labelStatistics.Max << " (" << expected.Max << ")"
+                << " mean " << labelStatistics.GetMean() << " (" << expected.GetMean() << ")"
+                << " peak " << labelStatistics.Peak << " (" << expected.Peak << ")"
+                << std::endl;
+      return false;
+      }
+    }
+  if( statistics[4].Count != 0 || statistics[1].Peak <= statistics[1].GetMean() )
+    {
+    std::cerr << "Wrong statistics of the unused label or of the hot spot" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+// ...
+// ...............................................................................................
+// ...
+int SUVStatisticsCalculatorTest( int, char * [] )
+{
+  vtkSmartPointer<vtkImageData> pet = CreatePETVolume(1.0);
+  vtkSmartPointer<vtkImageData> voi = CreateVOIVolume();
+  const double                  suvFactor = 0.37;
+
+  SUVStatisticsCalculator calculator;
+  calculator.SetSUVFactor(suvFactor);
+  calculator.SetLabels(voi);
+  std::vector<SUVStatistics> statistics;
+  if( !calculator.Compute(pet, statistics) ||
+      !CheckStatistics(pet, voi, calculator.GetLabelMin(), statistics, suvFactor) )
+    {
+    std::cerr << "Line " << __LINE__ << ": Compute failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // --- another frame of a dynamic study, with the same labels
+  vtkSmartPointer<vtkImageData> frame = CreatePETVolume(0.5);
+  if( !calculator.Compute(frame, statistics) ||
+      !CheckStatistics(frame, voi, calculator.GetLabelMin(), statistics, suvFactor) )
+    {
+    std::cerr << "Line " << __LINE__ << ": Compute of a second frame failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // --- a single small label: the row sums and the sphere means only cover
+  // its bounding box padded by the sphere
+  vtkSmartPointer<vtkImageData> smallVoi = vtkSmartPointer<vtkImageData>::New();
+  smallVoi->DeepCopy(voi);
+  short * smallLabels = static_cast<short *>(smallVoi->GetScalarPointer() );
+  for( vtkIdType id = 0; id < smallVoi->GetNumberOfPoints(); ++id )
+    {
+    smallLabels[id] = (smallLabels[id] == 1) ? 1 : 0;
+    }
+  calculator.SetLabels(smallVoi);
+  SUVStatistics expected = ComputeReferenceStatistics(pet, smallVoi, 1, suvFactor);
+  if( !calculator.Compute(pet, statistics) || calculator.GetLabelMin() != 0 ||
+      statistics.size() != 2 || statistics[1].Count != expected.Count ||
+      !IsClose(statistics[1].GetMean(), expected.GetMean() ) ||
+      !IsClose(statistics[1].Peak, expected.Peak) )
+    {
+    std::cerr << "Line " << __LINE__ << ": Compute of a single label failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // --- no label
+  vtkSmartPointer<vtkImageData> emptyVoi = vtkSmartPointer<vtkImageData>::New();
+  emptyVoi->DeepCopy(voi);
+  emptyVoi->GetPointData()->GetScalars()->FillComponent(0, 0.0);
+  calculator.SetLabels(emptyVoi);
+  if( !calculator.Compute(pet, statistics) || statistics.size() != 1 ||
+      statistics[0].Count != 0 )
+    {
+    std::cerr << "Line " << __LINE__ << ": Compute without label failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // --- a frame on another grid is rejected
+  vtkNew<vtkImageData> otherFrame;
+  otherFrame->SetDimensions(40, 36, 29);
+  otherFrame->SetScalarTypeToFloat();
+  otherFrame->AllocateScalars();
+  if( calculator.Compute(otherFrame.GetPointer(), statistics) )
+    {
+    std::cerr << "Line " << __LINE__ << ": Compute of a frame on another grid succeeded" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
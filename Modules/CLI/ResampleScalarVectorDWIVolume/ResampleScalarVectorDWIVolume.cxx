@@ -28,6 +28,7 @@
 
 // ResampleScalarVectorDWIVolume includes
 #include "ResampleScalarVectorDWIVolumeCLP.h"
+#include "itkVectorImageResampleFilter.h"
 
 // ResampleDTIVolume includes
 #include "dtiprocessFiles/deformationfieldio.h"
@@ -72,6 +73,7 @@ struct parameters
   std::string imageCenter;
   std::string transformsOrder;
   bool notbulk;
+  bool precomputeField;
   };
 
 // To check the image voxel type
@@ -474,6 +476,23 @@ void ResampleDeformationField( DeformationImageType::Pointer & field,
   field = resampleFieldFilter->GetOutput();
 }
 
+// Create a null deformation field on the output grid of the resampler
+template <class ImageType>
+DeformationImageType::Pointer
+NullDeformationField( typename itk::ResampleImageFilter<ImageType, ImageType>::Pointer resampler )
+{
+  DeformationImageType::Pointer field = DeformationImageType::New();
+  field->SetSpacing( resampler->GetOutputSpacing() );
+  field->SetOrigin( resampler->GetOutputOrigin() );
+  field->SetRegions( resampler->GetSize() );
+  field->SetDirection( resampler->GetOutputDirection() );
+  field->Allocate();
+  DeformationPixelType vectorNull;
+  vectorNull.Fill( 0.0 );
+  field->FillBuffer( vectorNull );
+  return field;
+}
+
 // Loads the transforms and merge them into only one transform
 template <class ImageType>
 itk::Transform<double, 3, 3>::Pointer
@@ -542,15 +561,7 @@ SetAllTransform( parameters & list,
       }
     else  // if no deformation field was loaded, we create an empty one
       {
-      field = DeformationImageType::New();
-      field->SetSpacing( resampler->GetOutputSpacing() );
-      field->SetOrigin( resampler->GetOutputOrigin() );
-      field->SetRegions( resampler->GetSize() );
-      field->SetDirection( resampler->GetOutputDirection() );
-      field->Allocate();
-      DeformationPixelType vectorNull;
-      vectorNull.Fill( 0.0 );
-      field->FillBuffer( vectorNull );
+      field = NullDeformationField<ImageType>( resampler );
       }
     // Compute the transformation field adding all the transforms together
     while( list.transformationFile.compare( "" ) && transformFile->GetTransformList()->size() )
@@ -653,47 +664,31 @@ SetAllTransform( parameters & list,
     {
     // only one transform, just load it
     transform = SetTransform<ImageType>( list, image, transformFile, outputImageCenter );
-    }
-  return transform;
-}
-
-// Write back the vector of images into a image vector
-template <class PixelType>
-int AddImage( typename itk::VectorImage<PixelType, 3>
-              ::Pointer & imagePile,
-              const std::vector<typename itk::Image<PixelType, 3>::Pointer> & vectorImage
-              )
-{
-  typedef itk::Image<PixelType, 3> ImageType;
-  imagePile->SetRegions( vectorImage.at( 0 )->GetLargestPossibleRegion().GetSize() );
-  imagePile->SetOrigin( vectorImage.at( 0 )->GetOrigin() );
-  imagePile->SetDirection( vectorImage.at( 0 )->GetDirection() );
-  imagePile->SetSpacing( vectorImage.at( 0 )->GetSpacing() );
-  imagePile->SetVectorLength( vectorImage.size() );
-  imagePile->Allocate();
-  typename itk::ImageRegionIterator<itk::VectorImage<PixelType, 3> > out( imagePile,
-                                                                          imagePile->GetLargestPossibleRegion()
-                                                                          );
-  typedef typename itk::ImageRegionIterator<ImageType> IteratorImageType;
-  std::vector<IteratorImageType> in;
-  for( unsigned int i = 0; i < imagePile->GetVectorLength(); i++ )
-    {
-    IteratorImageType intemp( vectorImage.at( i ), vectorImage.at( i )->GetLargestPossibleRegion() );
-    intemp.GoToBegin();
-    in.push_back( intemp );
-    }
-  itk::VariableLengthVector<PixelType> value;
-  value.SetSize( vectorImage.size() );
-  for( out.GoToBegin(); !out.IsAtEnd(); ++out )
-    {
-    for( unsigned int i = 0; i < imagePile->GetVectorLength(); i++ )
+    // Sample a non-linear transform (e.g. a BSpline) once on the output grid
+    // instead of evaluating it for every voxel of every component
+    typedef itk::MatrixOffsetTransformBase<double, 3, 3> MatrixTransformType;
+    if( list.precomputeField && transform
+        && !dynamic_cast<MatrixTransformType *>( transform.GetPointer() ) )
       {
-      value.SetElement( i, in.at( i ).Get() );
-      ++in[i];
+      typedef itk::TransformDeformationFieldFilter<double, double, 3> itkTransformDeformationFieldFilterType;
+      typename itkTransformDeformationFieldFilterType::Pointer transformDeformationFieldFilter =
+        itkTransformDeformationFieldFilterType::New();
+      if( list.numberOfThread )
+        {
+        transformDeformationFieldFilter->SetNumberOfThreads( list.numberOfThread );
+        }
+      transformDeformationFieldFilter->SetInput( NullDeformationField<ImageType>( resampler ) );
+      transformDeformationFieldFilter->SetTransform( transform );
+      transformDeformationFieldFilter->Update();
+      typename DeformationImageType::Pointer field = transformDeformationFieldFilter->GetOutput();
+      field->DisconnectPipeline();
+      typedef itk::WarpTransform3D<double> WarpTransformType;
+      typename WarpTransformType::Pointer warpTransform = WarpTransformType::New();
+      warpTransform->SetDeformationField( field );
+      transform = warpTransform;
       }
-    out.Set( value );
     }
-  return EXIT_SUCCESS;
+  return transform;
 }
 
 // Separate the vector image into a vector of images
@@ -1178,7 +1173,8 @@ int Rotate( parameters & list )
   typedef itk::ResampleImageFilter<ImageType, ImageType>   ResampleType;
   typedef itk::Transform<double, 3, 3>                     TransformType;
   typedef itk::VectorImage<PixelType, 3>                   VectorImageType;
-  typename ImageType::Pointer image;
+  typedef itk::VectorImageResampleFilter<PixelType, 3>     VectorResampleType;
+  typename VectorImageType::Pointer        inputImage;
   std::vector<typename ImageType::Pointer> vectorOfImage;
   itk::MetaDataDictionary                  dico;
   try
@@ -1194,42 +1190,81 @@ int Rotate( parameters & list )
       }
     // Save metadata dictionary
     dico = reader->GetOutput()->GetMetaDataDictionary();
-    // Separate the vector image into a vector of images
-    SeparateImages<PixelType>( reader->GetOutput(), vectorOfImage );
+    inputImage = reader->GetOutput();
+    // Linear and nearest neighbor interpolations are done on all the components
+    // together, the other interpolators need the components as separate images
+    if( list.interpolationType.compare( "linear" ) && list.interpolationType.compare( "nn" ) )
+      {
+      SeparateImages<PixelType>( inputImage, vectorOfImage );
+      }
     }
   catch( itk::ExceptionObject exception )
     {
     std::cerr << exception << std::endl;
     return EXIT_FAILURE;
     }
-  // Set interpolator
-  typename InterpolatorType::Pointer interpol;
-  interpol = SetInterpolator<ImageType>( list );
-  // Create resampler and initialize its output parameters
+  // Scalar image with the geometry of the input, used to compute the output
+  // parameters and the transforms
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( inputImage->GetLargestPossibleRegion() );
+  image->SetOrigin( inputImage->GetOrigin() );
+  image->SetSpacing( inputImage->GetSpacing() );
+  image->SetDirection( inputImage->GetDirection() );
+  // Initialize the output parameters
   typename ResampleType::Pointer resample = ResampleType::New();
-  SetOutputParameters<ImageType>( list, resample, vectorOfImage[0] );
+  SetOutputParameters<ImageType>( list, resample, image );
   TransformType::Pointer transform;
   // Load transforms and compute a merged transform
-  transform = SetAllTransform<ImageType>( list, resample, vectorOfImage[0] );
+  transform = SetAllTransform<ImageType>( list, resample, image );
   if( !transform )
     {
     return EXIT_FAILURE;
     }
-  resample->SetTransform( transform );
-  resample->SetInterpolator( interpol );
-  std::vector<typename ImageType::Pointer> vectorOutputImage;
-  // Resample all the images separately
-  for( ::size_t idx = 0; idx < vectorOfImage.size(); idx++ )
+  // Resample all the components at once
+  typename VectorResampleType::Pointer vectorResample = VectorResampleType::New();
+  vectorResample->SetInput( inputImage );
+  vectorResample->SetTransform( transform );
+  vectorResample->SetOutputSpacing( resample->GetOutputSpacing() );
+  vectorResample->SetOutputOrigin( resample->GetOutputOrigin() );
+  vectorResample->SetOutputDirection( resample->GetOutputDirection() );
+  vectorResample->SetSize( resample->GetSize() );
+  vectorResample->SetDefaultPixelValue( static_cast<PixelType>( list.defaultPixelValue ) );
+  if( !list.interpolationType.compare( "nn" ) )
+    {
+    vectorResample->SetInterpolation( VectorResampleType::NearestNeighbor );
+    }
+  else if( !list.interpolationType.compare( "linear" ) )
+    {
+    vectorResample->SetInterpolation( VectorResampleType::Linear );
+    }
+  else
     {
-    resample->SetInput( vectorOfImage[idx] );
-    resample->Update();
-    vectorOutputImage.push_back( resample->GetOutput() );
-    vectorOutputImage[idx]->DisconnectPipeline();
+    std::vector<typename InterpolatorType::Pointer> interpolators;
+    for( ::size_t idx = 0; idx < vectorOfImage.size(); idx++ )
+      {
+      typename InterpolatorType::Pointer interpol = SetInterpolator<ImageType>( list );
+      interpol->SetInputImage( vectorOfImage[idx] );
+      interpolators.push_back( interpol );
+      }
+    vectorResample->SetComponentInterpolators( interpolators );
+    }
+  if( list.numberOfThread )
+    {
+    vectorResample->SetNumberOfThreads( list.numberOfThread );
+    }
+  typename VectorImageType::Pointer outputImage;
+  try
+    {
+    vectorResample->Update();
+    outputImage = vectorResample->GetOutput();
+    outputImage->DisconnectPipeline();
+    }
+  catch( itk::ExceptionObject exception )
+    {
+    std::cerr << exception << std::endl;
+    return EXIT_FAILURE;
     }
-  typename itk::VectorImage<PixelType, 3>::Pointer outputImage;
-  outputImage = itk::VectorImage<PixelType, 3>::New();
-  AddImage<PixelType>( outputImage, vectorOutputImage );
-  vectorOutputImage.clear();
+  vectorOfImage.clear();
   // If necessary, transform gradient vectors with the loaded transformations
   int dwmriProblem = CheckDWMRI( dico, transform );
   if( list.space ) // && list.transformationFile.compare( "" ) )
@@ -1290,6 +1325,7 @@ int main( int argc, char * argv[] )
   list.imageCenter = imageCenter;
   list.transformsOrder = transformsOrder;
   list.notbulk = notbulk;
+  list.precomputeField = precomputeField;
   // verify if all the vector parameters have the good length
   if( list.outputImageSpacing.size() != 3 || list.outputImageSize.size() != 3
       || ( list.outputImageOrigin.size() != 3
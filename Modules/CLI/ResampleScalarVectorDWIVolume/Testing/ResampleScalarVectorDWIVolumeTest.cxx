@@ -9,7 +9,10 @@
 
 extern "C" MODULE_IMPORT int ModuleEntryPoint(int, char * []);
 
+int itkVectorImageResampleFilterTest(int, char * []);
+
 void RegisterTests()
 {
   StringToTestFunctionMap["ModuleEntryPoint"] = ModuleEntryPoint;
+  StringToTestFunctionMap["itkVectorImageResampleFilterTest"] = itkVectorImageResampleFilterTest;
 }
@@ -0,0 +1,246 @@
+#include "itkVectorImageResampleFilter.h"
+
+#include <itkAffineTransform.h>
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+#include <itkResampleImageFilter.h>
+#include <itkTranslationTransform.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Compare itk::VectorImageResampleFilter with itk::ResampleImageFilter run on
+// each component of the vector image, with linear and non-linear transforms
+// and the interpolations of ResampleScalarVectorDWIVolume.
+namespace
+{
+
+typedef short                                            PixelType;
+typedef itk::VectorImage<PixelType, 3>                   VectorImageType;
+typedef itk::Image<PixelType, 3>                         ImageType;
+typedef itk::VectorImageResampleFilter<PixelType, 3>     VectorResampleType;
+typedef itk::ResampleImageFilter<ImageType, ImageType>   ResampleType;
+typedef itk::InterpolateImageFunction<ImageType, double> InterpolatorType;
+typedef itk::Transform<double, 3, 3>                     TransformType;
+
+const unsigned int NumberOfComponents = 5;
+const PixelType    DefaultPixelValue = -7;
+
+VectorImageType::Pointer CreateVectorImage()
+{
+  VectorImageType::SizeType size;
+  size[0] = 12;
+  size[1] = 10;
+  size[2] = 8;
+  VectorImageType::SpacingType spacing;
+  spacing[0] = 1.5;
+  spacing[1] = 1.0;
+  spacing[2] = 2.0;
+  VectorImageType::PointType origin;
+  origin[0] = -3.0;
+  origin[1] = 4.0;
+  origin[2] = 1.0;
+  VectorImageType::Pointer image = VectorImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->SetVectorLength( NumberOfComponents );
+  image->Allocate();
+  itk::ImageRegionIterator<VectorImageType> it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const VectorImageType::IndexType index = it.GetIndex();
+    VectorImageType::PixelType       pixel( NumberOfComponents );
+    for( unsigned int c = 0; c < NumberOfComponents; c++ )
+      {
+      pixel[c] = static_cast<PixelType>( ( index[0] * 37 + index[1] * 11 * ( c + 1 )
+                                           + index[2] * 5 + c * 101 ) % 700 - 200 );
+      }
+    it.Set( pixel );
+    }
+  return image;
+}
+
+ImageType::Pointer ExtractComponent( VectorImageType * vectorImage, unsigned int component )
+{
+  ImageType::Pointer image = ImageType::New();
+  image->CopyInformation( vectorImage );
+  image->SetRegions( vectorImage->GetLargestPossibleRegion() );
+  image->Allocate();
+  itk::ImageRegionConstIterator<VectorImageType> in( vectorImage, vectorImage->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator<ImageType>            out( image, image->GetLargestPossibleRegion() );
+  for( in.GoToBegin(), out.GoToBegin(); !in.IsAtEnd(); ++in, ++out )
+    {
+    out.Set( in.Get()[component] );
+    }
+  return image;
+}
+
+InterpolatorType::Pointer CreateInterpolator( const std::string & interpolation )
+{
+  if( interpolation == "nn" )
+    {
+    return itk::NearestNeighborInterpolateImageFunction<ImageType, double>::New().GetPointer();
+    }
+  if( interpolation == "linear" )
+    {
+    return itk::LinearInterpolateImageFunction<ImageType, double>::New().GetPointer();
+    }
+  typedef itk::BSplineInterpolateImageFunction<ImageType, double, double> BSplineInterpolatorType;
+  BSplineInterpolatorType::Pointer interpolator = BSplineInterpolatorType::New();
+  interpolator->SetSplineOrder( 3 );
+  return interpolator.GetPointer();
+}
+
+// The output grid is rotated, larger and shifted so that some voxels are
+// mapped outside of the input
+bool TestResample( VectorImageType * input, const TransformType * transform,
+                   const std::string & interpolation, int numberOfThreads )
+{
+  VectorImageType::SizeType size;
+  size[0] = 14;
+  size[1] = 13;
+  size[2] = 9;
+  VectorImageType::SpacingType spacing;
+  spacing[0] = 1.2;
+  spacing[1] = 1.1;
+  spacing[2] = 1.7;
+  VectorImageType::PointType origin;
+  origin[0] = -5.3;
+  origin[1] = 2.9;
+  origin[2] = -0.6;
+  VectorImageType::DirectionType direction;
+  direction.SetIdentity();
+  const double angle = 0.2;
+  direction[0][0] = std::cos( angle );
+  direction[0][1] = -std::sin( angle );
+  direction[1][0] = std::sin( angle );
+  direction[1][1] = std::cos( angle );
+
+  std::vector<ImageType::Pointer> components;
+  for( unsigned int c = 0; c < NumberOfComponents; c++ )
+    {
+    components.push_back( ExtractComponent( input, c ) );
+    }
+
+  VectorResampleType::Pointer vectorResample = VectorResampleType::New();
+  vectorResample->SetInput( input );
+  vectorResample->SetTransform( transform );
+  vectorResample->SetOutputSpacing( spacing );
+  vectorResample->SetOutputOrigin( origin );
+  vectorResample->SetOutputDirection( direction );
+  vectorResample->SetSize( size );
+  vectorResample->SetDefaultPixelValue( DefaultPixelValue );
+  vectorResample->SetNumberOfThreads( numberOfThreads );
+  if( interpolation == "nn" )
+    {
+    vectorResample->SetInterpolation( VectorResampleType::NearestNeighbor );
+    }
+  else if( interpolation == "linear" )
+    {
+    vectorResample->SetInterpolation( VectorResampleType::Linear );
+    }
+  else
+    {
+    std::vector<InterpolatorType::Pointer> interpolators;
+    for( unsigned int c = 0; c < NumberOfComponents; c++ )
+      {
+      InterpolatorType::Pointer interpolator = CreateInterpolator( interpolation );
+      interpolator->SetInputImage( components[c] );
+      interpolators.push_back( interpolator );
+      }
+    vectorResample->SetComponentInterpolators( interpolators );
+    }
+  vectorResample->Update();
+  VectorImageType * output = vectorResample->GetOutput();
+
+  unsigned int outsideVoxels = 0;
+  for( unsigned int c = 0; c < NumberOfComponents; c++ )
+    {
+    ResampleType::Pointer resample = ResampleType::New();
+    resample->SetInput( components[c] );
+    resample->SetTransform( transform );
+    resample->SetInterpolator( CreateInterpolator( interpolation ) );
+    resample->SetOutputSpacing( spacing );
+    resample->SetOutputOrigin( origin );
+    resample->SetOutputDirection( direction );
+    resample->SetSize( size );
+    resample->SetDefaultPixelValue( DefaultPixelValue );
+    resample->Update();
+
+    itk::ImageRegionConstIterator<ImageType> expected( resample->GetOutput(),
+                                                       resample->GetOutput()->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator<VectorImageType> it( output, output->GetLargestPossibleRegion() );
+    for( expected.GoToBegin(), it.GoToBegin(); !it.IsAtEnd(); ++expected, ++it )
+      {
+      // The values may be rounded differently
+      if( std::abs( it.Get()[c] - expected.Get() ) > 1 )
+        {
+        std::cerr << "Interpolation " << interpolation << ", " << numberOfThreads
+                  << " threads, component " << c << " at " << it.GetIndex()
+                  << ": " << it.Get()[c] << " instead of " << expected.Get() << std::endl;
+        return false;
+        }
+      if( c == 0 && expected.Get() == DefaultPixelValue )
+        {
+        ++outsideVoxels;
+        }
+      }
+    }
+  if( outsideVoxels == 0 )
+    {
+    std::cerr << "Interpolation " << interpolation << ": no voxel outside of the input" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+int itkVectorImageResampleFilterTest( int, char * [] )
+{
+  VectorImageType::Pointer input = CreateVectorImage();
+
+  // Linear transform, mapped from the output indices to the input indices
+  typedef itk::AffineTransform<double, 3> AffineTransformType;
+  AffineTransformType::Pointer affine = AffineTransformType::New();
+  AffineTransformType::OutputVectorType translation;
+  translation[0] = 0.37;
+  translation[1] = -0.81;
+  translation[2] = 0.23;
+  affine->Translate( translation );
+  AffineTransformType::OutputVectorType axis;
+  axis[0] = 0.2;
+  axis[1] = 0.3;
+  axis[2] = 1.0;
+  affine->Rotate3D( axis, 0.15 );
+
+  // Not a MatrixOffsetTransformBase: evaluated at each output voxel
+  typedef itk::TranslationTransform<double, 3> TranslationTransformType;
+  TranslationTransformType::Pointer translationTransform = TranslationTransformType::New();
+  translationTransform->Translate( translation );
+
+  const TransformType * transforms[2] = { affine.GetPointer(), translationTransform.GetPointer() };
+  const char *          interpolations[3] = { "nn", "linear", "bs" };
+  const int             numberOfThreads[2] = { 1, 3 };
+  for( int t = 0; t < 2; t++ )
+    {
+    for( int i = 0; i < 3; i++ )
+      {
+      for( int n = 0; n < 2; n++ )
+        {
+        if( !TestResample( input, transforms[t], interpolations[i], numberOfThreads[n] ) )
+          {
+          std::cerr << "Transform " << transforms[t]->GetNameOfClass() << " failed" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#ifndef __itkVectorImageResampleFilter_h
+#define __itkVectorImageResampleFilter_h
+
+#include <itkImage.h>
+#include <itkImageToImageFilter.h>
+#include <itkInterpolateImageFunction.h>
+#include <itkMatrix.h>
+#include <itkTransform.h>
+#include <itkVectorImage.h>
+
+#include <vector>
+
+namespace itk
+{
+/** \class VectorImageResampleFilter
+ *
+ * Resample all the components of a vector image (e.g. the gradients of a
+ * DWI) at once. The transform is evaluated once per output voxel, and
+ * the output region is split among the threads.
+ *
+ * Nearest neighbor and linear interpolations are done here, on all the
+ * components together from the contiguous pixel buffer of the input.
+ * Other interpolations are done by one interpolator per component (set
+ * on the components of the input separated into scalar images) evaluated
+ * at the same continuous index.
+ *
+ * Linear transforms are reduced to an affine map from the output index to
+ * the input continuous index.
+ *
+ * The output matches ResampleImageFilter run on each component with the
+ * same transform and interpolation: the voxels mapped outside of the input
+ * buffer, as tested by ImageFunction::IsInsideBuffer, get the default pixel
+ * value and the interpolated values are clamped to the range of the pixel
+ * type.
+ */
+template <class TPixel, unsigned int VDimension = 3>
+class VectorImageResampleFilter
+  : public ImageToImageFilter<VectorImage<TPixel, VDimension>, VectorImage<TPixel, VDimension> >
+{
+public:
+  typedef VectorImage<TPixel, VDimension>           ImageType;
+  typedef VectorImageResampleFilter                 Self;
+  typedef ImageToImageFilter<ImageType, ImageType>  Superclass;
+  typedef SmartPointer<Self>                        Pointer;
+  typedef SmartPointer<const Self>                  ConstPointer;
+
+  itkNewMacro( Self );
+  itkTypeMacro( VectorImageResampleFilter, ImageToImageFilter );
+
+  typedef TPixel                                             ComponentType;
+  typedef Image<TPixel, VDimension>                          ComponentImageType;
+  typedef InterpolateImageFunction<ComponentImageType, double> ComponentInterpolatorType;
+  typedef typename ComponentInterpolatorType::Pointer        ComponentInterpolatorPointer;
+  typedef Transform<double, VDimension, VDimension>          TransformType;
+  typedef typename ImageType::RegionType                     OutputImageRegionType;
+  typedef typename ImageType::IndexType                      IndexType;
+  typedef typename ImageType::SizeType                       SizeType;
+  typedef typename ImageType::SpacingType                    SpacingType;
+  typedef typename ImageType::PointType                      PointType;
+  typedef typename ImageType::DirectionType                  DirectionType;
+
+  enum InterpolationType
+    {
+    NearestNeighbor,
+    Linear
+    };
+
+  // /Set the transform mapping the output points to the input points
+  itkSetConstObjectMacro( Transform, TransformType );
+  itkGetConstObjectMacro( Transform, TransformType );
+
+  // /Interpolation of the components, ignored if component interpolators are set
+  itkSetMacro( Interpolation, InterpolationType );
+  itkGetConstMacro( Interpolation, InterpolationType );
+
+  // /One interpolator per component, each set on its component image
+  void SetComponentInterpolators( const std::vector<ComponentInterpolatorPointer> & interpolators );
+
+  // /Value of all the components of the voxels mapped outside of the input
+  itkSetMacro( DefaultPixelValue, double );
+  itkGetConstMacro( DefaultPixelValue, double );
+
+  itkSetMacro( OutputSpacing, SpacingType );
+  itkGetConstReferenceMacro( OutputSpacing, SpacingType );
+  itkSetMacro( OutputOrigin, PointType );
+  itkGetConstReferenceMacro( OutputOrigin, PointType );
+  itkSetMacro( OutputDirection, DirectionType );
+  itkGetConstReferenceMacro( OutputDirection, DirectionType );
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+
+// /Get the time of the last modification of the object
+  unsigned long GetMTime() const;
+
+protected:
+  VectorImageResampleFilter();
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  void GenerateOutputInformation();
+
+  void GenerateInputRequestedRegion();
+
+  void BeforeThreadedGenerateData();
+
+#if ITK_VERSION_MAJOR < 4
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread, int threadId );
+
+#else
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId );
+
+#endif
+
+  // /Map an output index to a continuous index of the input
+  void ComputeInputIndex( const IndexType & outputIndex, double inputIndex[VDimension] ) const;
+
+  // /Interpolate all the components at a continuous index of the input, false if outside
+  bool Interpolate( const double inputIndex[VDimension], double * values ) const;
+
+private:
+  VectorImageResampleFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );            // purposely not implemented
+
+  typename TransformType::ConstPointer      m_Transform;
+  InterpolationType                         m_Interpolation;
+  std::vector<ComponentInterpolatorPointer> m_ComponentInterpolators;
+  double                                    m_DefaultPixelValue;
+  SpacingType                               m_OutputSpacing;
+  PointType                                 m_OutputOrigin;
+  DirectionType                             m_OutputDirection;
+  SizeType                                  m_Size;
+
+  // Output index to input continuous index when the transform is linear
+  bool                                      m_LinearTransform;
+  Matrix<double, VDimension, VDimension>    m_IndexMatrix;
+  Vector<double, VDimension>                m_IndexOffset;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkVectorImageResampleFilter.txx"
+#endif
+
+#endif
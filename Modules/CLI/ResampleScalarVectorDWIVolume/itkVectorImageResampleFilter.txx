@@ -0,0 +1,382 @@
+#ifndef __itkVectorImageResampleFilter_txx
+#define __itkVectorImageResampleFilter_txx
+
+#include "itkVectorImageResampleFilter.h"
+
+#include <itkConfigure.h>
+#include <itkContinuousIndex.h>
+#include <itkMatrixOffsetTransformBase.h>
+#include <itkNumericTraits.h>
+#include <itkProgressReporter.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <class TPixel, unsigned int VDimension>
+VectorImageResampleFilter<TPixel, VDimension>
+::VectorImageResampleFilter()
+{
+  this->SetNumberOfRequiredInputs( 1 );
+  m_Interpolation = Linear;
+  m_DefaultPixelValue = 0;
+  m_OutputSpacing.Fill( 1.0 );
+  m_OutputOrigin.Fill( 0.0 );
+  m_OutputDirection.SetIdentity();
+  m_Size.Fill( 0 );
+  m_LinearTransform = false;
+  m_IndexMatrix.SetIdentity();
+  m_IndexOffset.Fill( 0.0 );
+}
+
+template <class TPixel, unsigned int VDimension>
+void
+VectorImageResampleFilter<TPixel, VDimension>
+::SetComponentInterpolators( const std::vector<ComponentInterpolatorPointer> & interpolators )
+{
+  m_ComponentInterpolators = interpolators;
+  this->Modified();
+}
+
+template <class TPixel, unsigned int VDimension>
+unsigned long
+VectorImageResampleFilter<TPixel, VDimension>
+::GetMTime() const
+{
+  unsigned long latestTime = Superclass::GetMTime();
+  if( m_Transform.IsNotNull() && latestTime < m_Transform->GetMTime() )
+    {
+    latestTime = m_Transform->GetMTime();
+    }
+  return latestTime;
+}
+
+template <class TPixel, unsigned int VDimension>
+void
+VectorImageResampleFilter<TPixel, VDimension>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  ImageType *       outputPtr = this->GetOutput();
+  const ImageType * inputPtr = this->GetInput();
+  if( !outputPtr || !inputPtr )
+    {
+    return;
+    }
+  outputPtr->SetSpacing( m_OutputSpacing );
+  outputPtr->SetOrigin( m_OutputOrigin );
+  outputPtr->SetDirection( m_OutputDirection );
+  OutputImageRegionType region;
+  region.SetSize( m_Size );
+  outputPtr->SetLargestPossibleRegion( region );
+  outputPtr->SetVectorLength( inputPtr->GetVectorLength() );
+}
+
+template <class TPixel, unsigned int VDimension>
+void
+VectorImageResampleFilter<TPixel, VDimension>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+  // The transform may map the output anywhere in the input
+  ImageType * inputPtr = const_cast<ImageType *>( this->GetInput() );
+  if( inputPtr )
+    {
+    inputPtr->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template <class TPixel, unsigned int VDimension>
+void
+VectorImageResampleFilter<TPixel, VDimension>
+::BeforeThreadedGenerateData()
+{
+  if( m_Transform.IsNull() )
+    {
+    itkExceptionMacro( << "Transform not set" );
+    }
+  if( !m_ComponentInterpolators.empty()
+      && m_ComponentInterpolators.size() != this->GetInput()->GetVectorLength() )
+    {
+    itkExceptionMacro( << "One interpolator per component is required" );
+    }
+  // A linear transform composed with the index to physical point matrices
+  // of the images maps the output indices to input continuous indices:
+  // inputIndex = m_IndexMatrix * outputIndex + m_IndexOffset
+  typedef MatrixOffsetTransformBase<double, VDimension, VDimension> MatrixTransformType;
+  const MatrixTransformType * matrixTransform =
+    dynamic_cast<const MatrixTransformType *>( m_Transform.GetPointer() );
+  m_LinearTransform = ( matrixTransform != 0 );
+  if( !m_LinearTransform )
+    {
+    return;
+    }
+  const ImageType * inputPtr = this->GetInput();
+  Matrix<double, VDimension, VDimension> outputIndexToPhysical;
+  Matrix<double, VDimension, VDimension> inputIndexToPhysical;
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    for( unsigned int j = 0; j < VDimension; j++ )
+      {
+      outputIndexToPhysical[i][j] = m_OutputDirection[i][j] * m_OutputSpacing[j];
+      inputIndexToPhysical[i][j] = inputPtr->GetDirection()[i][j] * inputPtr->GetSpacing()[j];
+      }
+    }
+  const Matrix<double, VDimension, VDimension> physicalToInputIndex =
+    Matrix<double, VDimension, VDimension>( inputIndexToPhysical.GetInverse() );
+  m_IndexMatrix = physicalToInputIndex * matrixTransform->GetMatrix() * outputIndexToPhysical;
+  Vector<double, VDimension> origin;
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    origin[i] = m_OutputOrigin[i];
+    }
+  Vector<double, VDimension> offset = matrixTransform->GetMatrix() * origin
+    + matrixTransform->GetOffset();
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    offset[i] -= inputPtr->GetOrigin()[i];
+    }
+  m_IndexOffset = physicalToInputIndex * offset;
+}
+
+template <class TPixel, unsigned int VDimension>
+void
+VectorImageResampleFilter<TPixel, VDimension>
+::ComputeInputIndex( const IndexType & outputIndex, double inputIndex[VDimension] ) const
+{
+  if( m_LinearTransform )
+    {
+    for( unsigned int i = 0; i < VDimension; i++ )
+      {
+      inputIndex[i] = m_IndexOffset[i];
+      for( unsigned int j = 0; j < VDimension; j++ )
+        {
+        inputIndex[i] += m_IndexMatrix[i][j] * outputIndex[j];
+        }
+      }
+    return;
+    }
+  PointType outputPoint;
+  this->GetOutput()->TransformIndexToPhysicalPoint( outputIndex, outputPoint );
+  const PointType                      inputPoint = m_Transform->TransformPoint( outputPoint );
+  ContinuousIndex<double, VDimension> continuousIndex;
+  this->GetInput()->TransformPhysicalPointToContinuousIndex( inputPoint, continuousIndex );
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    inputIndex[i] = continuousIndex[i];
+    }
+}
+
+template <class TPixel, unsigned int VDimension>
+bool
+VectorImageResampleFilter<TPixel, VDimension>
+::Interpolate( const double inputIndex[VDimension], double * values ) const
+{
+  const ImageType *   inputPtr = this->GetInput();
+  const unsigned int  numberOfComponents = inputPtr->GetVectorLength();
+  if( !m_ComponentInterpolators.empty() )
+    {
+    ContinuousIndex<double, VDimension> continuousIndex;
+    for( unsigned int i = 0; i < VDimension; i++ )
+      {
+      continuousIndex[i] = inputIndex[i];
+      }
+    if( !m_ComponentInterpolators[0]->IsInsideBuffer( continuousIndex ) )
+      {
+      return false;
+      }
+    for( unsigned int c = 0; c < numberOfComponents; c++ )
+      {
+      values[c] = m_ComponentInterpolators[c]->EvaluateAtContinuousIndex( continuousIndex );
+      }
+    return true;
+    }
+
+  const OutputImageRegionType & buffer = inputPtr->GetBufferedRegion();
+  const typename ImageType::OffsetValueType * offsetTable = inputPtr->GetOffsetTable();
+  const ComponentType * inputBuffer = inputPtr->GetBufferPointer();
+  // Continuous index relative to the buffer, tested as
+  // ImageFunction::IsInsideBuffer does for the interpolators of
+  // ResampleImageFilter: outside, the voxel gets the default pixel value.
+  double index[VDimension];
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    index[i] = inputIndex[i] - buffer.GetIndex()[i];
+#if ITK_VERSION_MAJOR > 3 || defined(ITK_USE_CENTERED_PIXEL_COORDINATES_CONSISTENTLY)
+    // The buffer spans [-0.5, size - 0.5[
+    if( !( index[i] >= -0.5 && index[i] < buffer.GetSize()[i] - 0.5 ) )
+#else
+    // The buffer spans [0, size - 1]
+    if( !( index[i] >= 0.0 && index[i] <= buffer.GetSize()[i] - 1.0 ) )
+#endif
+      {
+      return false;
+      }
+    }
+  if( m_Interpolation == NearestNeighbor )
+    {
+    typename ImageType::OffsetValueType offset = 0;
+    for( unsigned int i = 0; i < VDimension; i++ )
+      {
+      long nearest = static_cast<long>( std::floor( index[i] + 0.5 ) );
+      nearest = std::min( std::max( nearest, 0L ), static_cast<long>( buffer.GetSize()[i] ) - 1 );
+      offset += nearest * offsetTable[i];
+      }
+    const ComponentType * pixel = inputBuffer + offset * numberOfComponents;
+    for( unsigned int c = 0; c < numberOfComponents; c++ )
+      {
+      values[c] = pixel[c];
+      }
+    return true;
+    }
+
+  // Linear: accumulate the 2^VDimension neighbors. Inside the buffer but
+  // less than half a voxel away from its border, the missing neighbors are
+  // replaced by the border voxels as LinearInterpolateImageFunction does with
+  // centered pixel coordinates. Otherwise their weight is 0.
+  long   lower[VDimension];
+  double distance[VDimension];
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    lower[i] = static_cast<long>( std::floor( index[i] ) );
+    distance[i] = index[i] - lower[i];
+    }
+  for( unsigned int c = 0; c < numberOfComponents; c++ )
+    {
+    values[c] = 0.0;
+    }
+  for( unsigned int neighbor = 0; neighbor < ( 1u << VDimension ); neighbor++ )
+    {
+    double                              weight = 1.0;
+    typename ImageType::OffsetValueType offset = 0;
+    for( unsigned int i = 0; i < VDimension; i++ )
+      {
+      long position = lower[i];
+      if( neighbor & ( 1u << i ) )
+        {
+        ++position;
+        weight *= distance[i];
+        }
+      else
+        {
+        weight *= 1.0 - distance[i];
+        }
+      position = std::min( std::max( position, 0L ), static_cast<long>( buffer.GetSize()[i] ) - 1 );
+      offset += position * offsetTable[i];
+      }
+    if( weight == 0.0 )
+      {
+      continue;
+      }
+    const ComponentType * pixel = inputBuffer + offset * numberOfComponents;
+    for( unsigned int c = 0; c < numberOfComponents; c++ )
+      {
+      values[c] += weight * pixel[c];
+      }
+    }
+  return true;
+}
+
+template <class TPixel, unsigned int VDimension>
+void
+#if ITK_VERSION_MAJOR < 4
+VectorImageResampleFilter<TPixel, VDimension>
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        int threadId )
+#else
+VectorImageResampleFilter<TPixel, VDimension>
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+#endif
+  {
+  ImageType *        outputPtr = this->GetOutput();
+  const unsigned int numberOfComponents = outputPtr->GetVectorLength();
+  const IndexType    start = outputRegionForThread.GetIndex();
+  const SizeType     size = outputRegionForThread.GetSize();
+  unsigned long      numberOfLines = 1;
+  for( unsigned int i = 1; i < VDimension; i++ )
+    {
+    numberOfLines *= size[i];
+    }
+  ProgressReporter progress( this, threadId, numberOfLines );
+
+  const double minimum = static_cast<double>( NumericTraits<ComponentType>::NonpositiveMin() );
+  const double maximum = static_cast<double>( NumericTraits<ComponentType>::max() );
+  std::vector<double> values( numberOfComponents );
+  double              inputIndex[VDimension];
+  double              step[VDimension];
+  for( unsigned int i = 0; i < VDimension; i++ )
+    {
+    step[i] = m_IndexMatrix[i][0];
+    }
+  for( unsigned long line = 0; line < numberOfLines; line++ )
+    {
+    IndexType     index = start;
+    unsigned long rest = line;
+    for( unsigned int i = 1; i < VDimension; i++ )
+      {
+      index[i] = start[i] + rest % size[i];
+      rest /= size[i];
+      }
+    ComponentType * out = outputPtr->GetBufferPointer()
+      + outputPtr->ComputeOffset( index ) * numberOfComponents;
+    if( m_LinearTransform )
+      {
+      this->ComputeInputIndex( index, inputIndex );
+      }
+    for( unsigned long x = 0; x < size[0]; x++, out += numberOfComponents )
+      {
+      if( m_LinearTransform )
+        {
+        if( x > 0 )
+          {
+          for( unsigned int i = 0; i < VDimension; i++ )
+            {
+            inputIndex[i] += step[i];
+            }
+          }
+        }
+      else
+        {
+        index[0] = start[0] + x;
+        this->ComputeInputIndex( index, inputIndex );
+        }
+      if( !this->Interpolate( inputIndex, &values[0] ) )
+        {
+        for( unsigned int c = 0; c < numberOfComponents; c++ )
+          {
+          out[c] = static_cast<ComponentType>( m_DefaultPixelValue );
+          }
+        continue;
+        }
+      for( unsigned int c = 0; c < numberOfComponents; c++ )
+        {
+        const double value = std::min( std::max( values[c], minimum ), maximum );
+        out[c] = static_cast<ComponentType>( value );
+        }
+      }
+    progress.CompletedPixel();
+    }
+  }
+
+template <class TPixel, unsigned int VDimension>
+void
+VectorImageResampleFilter<TPixel, VDimension>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Interpolation: "
+     << ( m_Interpolation == NearestNeighbor ? "NearestNeighbor" : "Linear" ) << std::endl;
+  os << indent << "ComponentInterpolators: " << m_ComponentInterpolators.size() << std::endl;
+  os << indent << "DefaultPixelValue: " << m_DefaultPixelValue << std::endl;
+  os << indent << "OutputSpacing: " << m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << m_OutputDirection << std::endl;
+  os << indent << "Size: " << m_Size << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -23,6 +23,7 @@
 #include <vtkMRMLTransformNode.h>
 
 /// VTK includes
+#include <vtkCollection.h>
 #include <vtkGeneralTransform.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
@@ -36,6 +37,7 @@
 
 /// STD includes
 #include <cassert>
+#include <vector>
 
 vtkCxxRevisionMacro(vtkSlicerModelsLogic, "$Revision$");
 vtkStandardNewMacro(vtkSlicerModelsLogic);
@@ -112,12 +114,16 @@ vtkMRMLModelNode* vtkSlicerModelsLogic::AddModel(vtkPolyData* polyData)
 //----------------------------------------------------------------------------
 int vtkSlicerModelsLogic::AddModels (const char* dirname, const char* suffix )
 {
+  if (this->GetMRMLScene() == 0)
+    {
+    return 0;
+    }
   std::string ssuf = suffix;
   itksys::Directory dir;
   dir.Load(dirname);
 
+  std::vector<std::string> fullPaths;
   int nfiles = dir.GetNumberOfFiles();
-  int res = 1;
   for (int i=0; i<nfiles; i++) {
     const char* filename = dir.GetFile(i);
     std::string sname = filename;
@@ -127,28 +133,73 @@ int vtkSlicerModelsLogic::AddModels (const char* dirname, const char* suffix )
         {
         std::string fullPath = std::string(dir.GetPath())
             + "/" + filename;
-        if (this->AddModel(fullPath.c_str()) == NULL)
-          {
-          res = 0;
-          }
+        fullPaths.push_back(fullPath);
         }
       }
   }
+
+  // Read the FreeSurfer surfaces concurrently, AddModel() then uses the
+  // surfaces already read by their storage node
+  vtkNew<vtkMRMLModelStorageNode> mStorageNode;
+  vtkNew<vtkCollection> fsmStorageNodes;
+  std::vector<vtkSmartPointer<vtkMRMLFreeSurferModelStorageNode> >
+    fsmStorageNodeOfFile(fullPaths.size());
+  for (size_t i = 0; i < fullPaths.size(); ++i)
+    {
+    const std::string name = itksys::SystemTools::GetFilenameName(fullPaths[i]);
+    vtkNew<vtkMRMLFreeSurferModelStorageNode> fsmStorageNode;
+    if (mStorageNode->SupportedFileType(name.c_str()) ||
+        !fsmStorageNode->SupportedFileType(name.c_str()))
+      {
+      continue;
+      }
+    fsmStorageNode->SetScene(this->GetMRMLScene());
+    fsmStorageNode->SetFileName(fullPaths[i].c_str());
+    fsmStorageNodes->AddItem(fsmStorageNode.GetPointer());
+    fsmStorageNodeOfFile[i] = fsmStorageNode.GetPointer();
+    }
+  if (fsmStorageNodes->GetNumberOfItems() > 1)
+    {
+    vtkMRMLFreeSurferModelStorageNode::ReadSurfacesInParallel(
+      fsmStorageNodes.GetPointer());
+    }
+
+  int res = 1;
+  for (size_t i = 0; i < fullPaths.size(); ++i)
+    {
+    vtkSmartPointer<vtkMRMLFreeSurferModelStorageNode> fsmStorageNode =
+      fsmStorageNodeOfFile[i];
+    if (fsmStorageNode == NULL)
+      {
+      fsmStorageNode = vtkSmartPointer<vtkMRMLFreeSurferModelStorageNode>::New();
+      }
+    if (this->AddModel(fullPaths[i].c_str(), fsmStorageNode) == NULL)
+      {
+      res = 0;
+      }
+    }
   return res;
 }
 
 //----------------------------------------------------------------------------
 vtkMRMLModelNode* vtkSlicerModelsLogic::AddModel (const char* filename)
+{
+  vtkNew<vtkMRMLFreeSurferModelStorageNode> fsmStorageNode;
+  return this->AddModel(filename, fsmStorageNode.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLModelNode* vtkSlicerModelsLogic::AddModel (const char* filename,
+  vtkMRMLFreeSurferModelStorageNode* fsmStorageNode)
 {
   if (this->GetMRMLScene() == 0 ||
-      filename == 0)
+      filename == 0 || fsmStorageNode == 0)
     {
     return 0;
     }
   vtkNew<vtkMRMLModelNode> modelNode;
   vtkNew<vtkMRMLModelDisplayNode> displayNode;
   vtkNew<vtkMRMLModelStorageNode> mStorageNode;
-  vtkNew<vtkMRMLFreeSurferModelStorageNode> fsmStorageNode;
   fsmStorageNode->SetUseStripper(0);  // turn off stripping by default (breaks some pickers)
   vtkSmartPointer<vtkMRMLStorageNode> storageNode;
 
@@ -187,7 +238,7 @@ vtkMRMLModelNode* vtkSlicerModelsLogic::AddModel (const char* filename)
   else if (fsmStorageNode->SupportedFileType(name.c_str()))
     {
     vtkDebugMacro("AddModel: have a freesurfer type model file.");
-    storageNode = fsmStorageNode.GetPointer();
+    storageNode = fsmStorageNode;
     }
 
   /* don't read just yet, need to add to the scene first for remote reading
@@ -19,6 +19,7 @@
 #include "vtkSlicerModuleLogic.h"
 #include "vtkSlicerModelsModuleLogicExport.h"
 
+class vtkMRMLFreeSurferModelStorageNode;
 class vtkMRMLModelNode;
 class vtkMRMLStorageNode;
 class vtkMRMLTransformNode;
@@ -60,6 +61,7 @@ class VTK_SLICER_MODELS_MODULE_LOGIC_EXPORT vtkSlicerModelsLogic
   /// 
   /// Create model nodes and
   /// read their polydata from a specified directory
+  /// The FreeSurfer surfaces of the directory are read concurrently.
   int AddModels (const char* dirname, const char* suffix );
 
   /// 
@@ -94,6 +96,11 @@ protected:
   /// instantiated.
   virtual void ObserveMRMLScene();
 
+  /// Add a model read from \a filename, \a fsmStorageNode is used if the
+  /// file is a FreeSurfer surface.
+  vtkMRMLModelNode* AddModel(const char* filename,
+                             vtkMRMLFreeSurferModelStorageNode* fsmStorageNode);
+
   //
   vtkMRMLModelNode *ActiveModelNode;
 
@@ -56,6 +56,20 @@ public:
   vtkGetMacro (RaycastTechnique, int);
   vtkSetMacro (RaycastTechnique, int);
 
+  /// Render still frames progressively: a coarse image is rendered first
+  /// and refined by the following renders until the interaction resumes.
+  /// Composite and MIP only. 0 by default.
+  vtkGetMacro (ProgressiveRendering, int);
+  vtkSetMacro (ProgressiveRendering, int);
+  vtkBooleanMacro (ProgressiveRendering, int);
+
+  /// Step over the empty regions along the rays with a hierarchy of the
+  /// transparent regions of the volume. The image is the same, only
+  /// composite rendering is faster. 0 by default.
+  vtkGetMacro (SpaceLeaping, int);
+  vtkSetMacro (SpaceLeaping, int);
+  vtkBooleanMacro (SpaceLeaping, int);
+
 protected:
   vtkMRMLCPURayCastVolumeRenderingDisplayNode();
   ~vtkMRMLCPURayCastVolumeRenderingDisplayNode();
@@ -71,6 +85,9 @@ protected:
    * 5: Illustrative Context Preserving Exploration
    * */
   int RaycastTechnique;
+
+  int ProgressiveRendering;
+  int SpaceLeaping;
 };
 
 #endif
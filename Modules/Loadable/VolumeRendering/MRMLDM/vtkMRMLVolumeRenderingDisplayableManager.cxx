@@ -90,6 +90,7 @@ int vtkMRMLVolumeRenderingDisplayableManager::DefaultGPUMemorySize = 256;
 vtkMRMLVolumeRenderingDisplayableManager::vtkMRMLVolumeRenderingDisplayableManager()
 {
   this->MapperRaycast = NULL;
+  this->MapperProgressiveRaycast = NULL;
   this->MapperTexture = NULL;
   this->MapperGPURaycast = NULL;
   this->MapperGPURaycastII = NULL;
@@ -150,6 +151,7 @@ vtkMRMLVolumeRenderingDisplayableManager::~vtkMRMLVolumeRenderingDisplayableMana
 
   //delete instances
   vtkSetMRMLNodeMacro(this->MapperRaycast, NULL);
+  vtkSetMRMLNodeMacro(this->MapperProgressiveRaycast, NULL);
   vtkSetMRMLNodeMacro(this->MapperTexture, NULL);
   vtkSetMRMLNodeMacro(this->MapperGPURaycast, NULL);
   vtkSetMRMLNodeMacro(this->MapperGPURaycastII, NULL);
@@ -198,6 +200,7 @@ void vtkMRMLVolumeRenderingDisplayableManager::SetGUICallbackCommand(vtkCommand*
   //cpu ray casting
   this->MapperRaycast->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, callback);
   this->MapperRaycast->AddObserver(vtkCommand::ProgressEvent,callback);
+  this->MapperProgressiveRaycast->AddObserver(vtkCommand::ProgressEvent,callback);
 
   //hook up the gpu mapper
   this->MapperGPURaycast->AddObserver(vtkCommand::VolumeMapperComputeGradientsProgressEvent, callback);
@@ -225,6 +228,14 @@ void vtkMRMLVolumeRenderingDisplayableManager::Reset()
   vtkSetAndObserveMRMLNodeEventsMacro(this->MapperRaycast,
                                       newMapperRaycast.GetPointer(),
                                       mapperEventsWithProgress.GetPointer());
+  // CPU mapper with progressive refinement
+  vtkNew<vtkSlicerFixedPointVolumeRayCastMapper> newMapperProgressiveRaycast;
+  vtkNew<vtkIntArray> progressiveMapperEvents;
+  progressiveMapperEvents->InsertNextValue(
+    vtkSlicerFixedPointVolumeRayCastMapper::ProgressiveRefinementEvent);
+  vtkSetAndObserveMRMLNodeEventsMacro(this->MapperProgressiveRaycast,
+                                      newMapperProgressiveRaycast.GetPointer(),
+                                      progressiveMapperEvents.GetPointer());
   // 3D Texture
   vtkNew<vtkSlicerVolumeTextureMapper3D> newMapperTexture;
   vtkSetAndObserveMRMLNodeEventsMacro(this->MapperTexture,
@@ -549,6 +560,31 @@ void vtkMRMLVolumeRenderingDisplayableManager
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager
+::UpdateProgressiveCPURaycastMapper(
+  vtkSlicerFixedPointVolumeRayCastMapper* mapper,
+  vtkMRMLCPURayCastVolumeRenderingDisplayNode* vspNode)
+{
+  this->UpdateMapper(mapper, vspNode);
+  const bool highDef = vspNode->GetPerformanceControl() ==
+    vtkMRMLVolumeRenderingDisplayNode::MaximumQuality;
+  mapper->SetAutoAdjustSampleDistances( highDef ? 0 : 1);
+  mapper->SetSampleDistance(this->GetSampleDistance(vspNode));
+  mapper->SetInteractiveSampleDistance(this->GetSampleDistance(vspNode));
+  mapper->SetImageSampleDistance(highDef ? 0.5 : 1.);
+  mapper->SetProgressiveRendering(vspNode->GetProgressiveRendering());
+  mapper->SetSpaceLeaping(vspNode->GetSpaceLeaping());
+
+  // Minimum intensity projection is not supported by this mapper, see
+  // GetVolumeMapper()
+  mapper->SetBlendMode(
+    vspNode->GetRaycastTechnique() ==
+      vtkMRMLVolumeRenderingDisplayNode::MaximumIntensityProjection ?
+    vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND :
+    vtkVolumeMapper::COMPOSITE_BLEND);
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLVolumeRenderingDisplayableManager
 ::UpdateNCIRaycastMapper(
@@ -655,7 +691,8 @@ int vtkMRMLVolumeRenderingDisplayableManager
                                               ->GetFgVolumeNode())->GetImageData());
     }
   int supported = 0;
-  if (volumeMapper->IsA("vtkFixedPointVolumeRayCastMapper"))
+  if (volumeMapper->IsA("vtkFixedPointVolumeRayCastMapper") ||
+      volumeMapper->IsA("vtkSlicerFixedPointVolumeRayCastMapper"))
     {
     supported = 1;
     }
@@ -693,6 +730,14 @@ vtkVolumeMapper* vtkMRMLVolumeRenderingDisplayableManager
     }
   if (vspNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
     {
+    vtkMRMLCPURayCastVolumeRenderingDisplayNode* cpuNode =
+      vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(vspNode);
+    if ((cpuNode->GetProgressiveRendering() || cpuNode->GetSpaceLeaping()) &&
+        cpuNode->GetRaycastTechnique() !=
+          vtkMRMLVolumeRenderingDisplayNode::MinimumIntensityProjection)
+      {
+      return this->MapperProgressiveRaycast;
+      }
     return this->MapperRaycast;
     }
   else if (vspNode->IsA("vtkMRMLNCIRayCastVolumeRenderingDisplayNode"))
@@ -806,7 +851,13 @@ bool vtkMRMLVolumeRenderingDisplayableManager::UpdateMapper(
   vtkMRMLVolumeRenderingDisplayNode* vspNode)
 {
   vtkVolumeMapper* volumeMapper = this->GetVolumeMapper(vspNode);
-  if (vspNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
+  if (vspNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode") &&
+      volumeMapper == this->MapperProgressiveRaycast)
+    {
+    this->UpdateProgressiveCPURaycastMapper(this->MapperProgressiveRaycast,
+                                            vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(vspNode));
+    }
+  else if (vspNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
     {
     this->UpdateCPURaycastMapper(vtkFixedPointVolumeRayCastMapper::SafeDownCast(volumeMapper),
                                  vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(vspNode));
@@ -1272,6 +1323,11 @@ void vtkMRMLVolumeRenderingDisplayableManager
         vtkMRMLVolumeRenderingDisplayNode::SafeDownCast(caller));
       }
     }
+  else if (event == vtkSlicerFixedPointVolumeRayCastMapper::ProgressiveRefinementEvent)
+    {
+    // The last render was a coarse pass, refine it when idle
+    this->RequestRender();
+    }
   else if (event == vtkMRMLScalarVolumeNode::ImageDataModifiedEvent)
     {
     this->SetupMapperFromVolumeNode(this->DisplayedNode);
@@ -35,6 +35,7 @@ class vtkMRMLVolumeRenderingDisplayNode;
 class vtkMRMLVolumeRenderingScenarioNode;
 class vtkSlicerVolumeRenderingLogic;
 class vtkSlicerVolumeTextureMapper3D;
+class vtkSlicerFixedPointVolumeRayCastMapper;
 class vtkSlicerGPURayCastVolumeMapper;
 class vtkSlicerGPURayCastMultiVolumeMapper;
 class vtkVolumeProperty;
@@ -106,6 +107,8 @@ public:
                     vtkMRMLVolumeRenderingDisplayNode* vspNode);
   void UpdateCPURaycastMapper(vtkFixedPointVolumeRayCastMapper* mapper,
                               vtkMRMLCPURayCastVolumeRenderingDisplayNode* vspNode);
+  void UpdateProgressiveCPURaycastMapper(vtkSlicerFixedPointVolumeRayCastMapper* mapper,
+                                         vtkMRMLCPURayCastVolumeRenderingDisplayNode* vspNode);
   void UpdateNCIRaycastMapper(vtkSlicerGPURayCastVolumeMapper* mapper,
                               vtkMRMLNCIRayCastVolumeRenderingDisplayNode* vspNode);
   void UpdateNCIMultiVolumeRaycastMapper(vtkSlicerGPURayCastMultiVolumeMapper* mapper,
@@ -196,6 +199,12 @@ protected:
   // The software accelerated software mapper
   vtkFixedPointVolumeRayCastMapper *MapperRaycast;
 
+  // Description:
+  // The software mapper with hierarchical space leaping and progressive
+  // refinement, used when the CPU display node is progressive or space
+  // leaping
+  vtkSlicerFixedPointVolumeRayCastMapper *MapperProgressiveRaycast;
+
   // Description:
   // The gpu ray cast mapper.
   vtkGPUVolumeRayCastMapper *MapperGPURaycast3;
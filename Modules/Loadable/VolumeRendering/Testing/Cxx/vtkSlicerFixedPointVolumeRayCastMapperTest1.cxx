@@ -0,0 +1,220 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VolumeRenderingReplacements includes
+#include <vtkSlicerFixedPointVolumeRayCastMapper.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
+#include <vtkColorTransferFunction.h>
+#include <vtkImageData.h>
+#include <vtkImageDifference.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+#include <vtkWindowToImageFilter.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// A sphere in the middle of an empty volume, with an empty corner inside the
+// sphere so that the rays leap over regions before and after it.
+void SetupImageData(vtkImageData* imageData)
+{
+  const int dim = 64;
+  imageData->SetDimensions(dim, dim, dim);
+  imageData->SetScalarTypeToUnsignedChar();
+  imageData->SetNumberOfScalarComponents(1);
+  imageData->AllocateScalars();
+  unsigned char* ptr = static_cast<unsigned char*>(
+    imageData->GetScalarPointer(0,0,0));
+  for (int z = 0; z < dim; ++z)
+    {
+    for (int y = 0; y < dim; ++y)
+      {
+      for (int x = 0; x < dim; ++x)
+        {
+        const int dx = x - dim / 2;
+        const int dy = y - dim / 2;
+        const int dz = z - dim / 2;
+        const int r2 = dx * dx + dy * dy + dz * dz;
+        unsigned char value = 0;
+        if (r2 < 20 * 20 && !(dx > 0 && dy > 0 && dz > 0))
+          {
+          value = static_cast<unsigned char>(120 + (x + 2 * y + 3 * z) % 100);
+          }
+        *(ptr++) = value;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void SetupVolumeProperty(vtkVolumeProperty* volumeProperty, bool shade)
+{
+  vtkNew<vtkPiecewiseFunction> opacity;
+  opacity->AddPoint(0., 0.);
+  opacity->AddPoint(100., 0.);
+  opacity->AddPoint(255., 0.3);
+  vtkNew<vtkColorTransferFunction> color;
+  color->AddRGBPoint(0., 0., 0., 0.);
+  color->AddRGBPoint(120., 1., 0.5, 0.);
+  color->AddRGBPoint(255., 1., 1., 1.);
+  volumeProperty->SetScalarOpacity(opacity.GetPointer());
+  volumeProperty->SetColor(color.GetPointer());
+  volumeProperty->SetInterpolationTypeToLinear();
+  volumeProperty->SetShade(shade ? 1 : 0);
+}
+
+//----------------------------------------------------------------------------
+void CountRefinementEvents(vtkObject*, unsigned long, void* clientData, void*)
+{
+  ++(*reinterpret_cast<int*>(clientData));
+}
+
+//----------------------------------------------------------------------------
+void Screenshot(vtkRenderWindow* renderWindow, vtkImageData* screenshot)
+{
+  vtkNew<vtkWindowToImageFilter> windowToImageFilter;
+  windowToImageFilter->SetInput(renderWindow);
+  windowToImageFilter->Update();
+  screenshot->DeepCopy(windowToImageFilter->GetOutput());
+}
+
+//----------------------------------------------------------------------------
+bool AreScreenshotsEqual(vtkImageData* screenshot, vtkImageData* reference)
+{
+  vtkNew<vtkImageDifference> diff;
+  diff->SetInput(reference);
+  diff->SetImage(screenshot);
+  diff->Update();
+  return diff->GetThresholdedError() == 0.;
+}
+
+//----------------------------------------------------------------------------
+// Render the same view with and without space leaping, then progressively:
+// the images must be the same.
+bool TestRendering(int blendMode, bool shade)
+{
+  vtkNew<vtkImageData> imageData;
+  SetupImageData(imageData.GetPointer());
+  vtkNew<vtkVolumeProperty> volumeProperty;
+  SetupVolumeProperty(volumeProperty.GetPointer(), shade);
+
+  vtkNew<vtkSlicerFixedPointVolumeRayCastMapper> mapper;
+  mapper->SetInput(imageData.GetPointer());
+  mapper->SetBlendMode(blendMode);
+  mapper->SetAutoAdjustSampleDistances(0);
+  mapper->SetSampleDistance(0.5);
+  mapper->SetImageSampleDistance(1.);
+  vtkNew<vtkVolume> volume;
+  volume->SetMapper(mapper.GetPointer());
+  volume->SetProperty(volumeProperty.GetPointer());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddVolume(volume.GetPointer());
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(200, 200);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(renderer.GetPointer());
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Azimuth(30.);
+  renderer->GetActiveCamera()->Elevation(20.);
+
+  mapper->SpaceLeapingOff();
+  renderWindow->Render();
+  vtkNew<vtkImageData> reference;
+  Screenshot(renderWindow.GetPointer(), reference.GetPointer());
+
+  mapper->SpaceLeapingOn();
+  renderWindow->Render();
+  vtkNew<vtkImageData> spaceLeaping;
+  Screenshot(renderWindow.GetPointer(), spaceLeaping.GetPointer());
+  if (!AreScreenshotsEqual(spaceLeaping.GetPointer(), reference.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << ": space leaping changes the image, blend mode "
+              << blendMode << ", shade " << shade << std::endl;
+    return false;
+    }
+
+  // Each still render of the same view but the last one is a coarse pass
+  vtkNew<vtkCallbackCommand> refinementCallback;
+  int refinementEvents = 0;
+  refinementCallback->SetCallback(CountRefinementEvents);
+  refinementCallback->SetClientData(&refinementEvents);
+  mapper->AddObserver(vtkSlicerFixedPointVolumeRayCastMapper::ProgressiveRefinementEvent,
+                      refinementCallback.GetPointer());
+  mapper->SetProgressiveLevels(3);
+  mapper->ProgressiveRenderingOn();
+  for (int pass = 0; pass < 3; ++pass)
+    {
+    renderWindow->Render();
+    const bool coarsePass = pass < 2;
+    if (mapper->GetProgressiveRefinementPending() != (coarsePass ? 1 : 0) ||
+        refinementEvents != (coarsePass ? pass + 1 : 2))
+      {
+      std::cerr << "Line " << __LINE__ << ": wrong progressive pass " << pass
+                << ", " << refinementEvents << " refinement events" << std::endl;
+      return false;
+      }
+    }
+  vtkNew<vtkImageData> progressive;
+  Screenshot(renderWindow.GetPointer(), progressive.GetPointer());
+  if (mapper->GetProgressiveRefinementPending() ||
+      !AreScreenshotsEqual(progressive.GetPointer(), reference.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << ": the refined image is not the full "
+              << "resolution image, blend mode " << blendMode << ", shade "
+              << shade << std::endl;
+    return false;
+    }
+
+  // Moving the camera starts again from the coarsest pass
+  renderer->GetActiveCamera()->Azimuth(10.);
+  renderWindow->Render();
+  if (!mapper->GetProgressiveRefinementPending() || refinementEvents != 3)
+    {
+    std::cerr << "Line " << __LINE__ << ": the progressive render doesn't "
+              << "restart when the view changes" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerFixedPointVolumeRayCastMapperTest1(int vtkNotUsed(argc),
+                                                char* vtkNotUsed(argv)[])
+{
+  if (!TestRendering(vtkVolumeMapper::COMPOSITE_BLEND, false) ||
+      !TestRendering(vtkVolumeMapper::COMPOSITE_BLEND, true) ||
+      !TestRendering(vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND, false))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
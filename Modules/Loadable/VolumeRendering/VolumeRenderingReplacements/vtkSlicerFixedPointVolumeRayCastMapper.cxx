@@ -40,6 +40,8 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkVolumeProperty.h"
 #include "vtkSlicerFixedPointRayCastImage.h"
 
+#include <cstring>
+
 
 vtkCxxRevisionMacro(vtkSlicerFixedPointVolumeRayCastMapper, "$Revision: 1.20.4.1 $");
 vtkStandardNewMacro(vtkSlicerFixedPointVolumeRayCastMapper);
@@ -506,9 +508,41 @@ vtkSlicerFixedPointVolumeRayCastMapper::vtkSlicerFixedPointVolumeRayCastMapper()
     this->MinMaxVolumeSize[3] = 0;
     this->SavedMinMaxInput = NULL;
 
+    this->OpacityClassification = NULL;
+    this->OpacityClassificationComponents = 0;
+    this->SavedClassificationGradientOpacityRequired = 0;
+    for ( i = 0; i < 4; i++ )
+    {
+        this->SavedMinNonZeroGradientMagnitudeIndex[i] = 0;
+    }
+
+    this->MinMaxTree = NULL;
+    this->MinMaxTreeAllocatedSize = 0;
+    this->MinMaxTreeLevels = 0;
+    for ( i = 0; i < VTKKW_FPMM_TREE_MAX_LEVELS; i++ )
+    {
+        this->MinMaxTreeSize[i][0] = 0;
+        this->MinMaxTreeSize[i][1] = 0;
+        this->MinMaxTreeSize[i][2] = 0;
+        this->MinMaxTreeLevel[i] = NULL;
+    }
+    this->SpaceLeapAlongRays = 0;
+
     this->Volume = NULL;
     //SLICERADD
     this->ManualInteractive=0;
+    this->ManualInteractiveRate=0.;
+
+    this->SpaceLeaping = 1;
+
+    this->ProgressiveRendering = 0;
+    this->ProgressiveLevels = 3;
+    this->ProgressivePass = 0;
+    this->ProgressiveRefinementPending = 0;
+    this->ProgressiveImageSampleDistance = 1.0;
+    this->ProgressiveViewMTime = 0;
+    this->ProgressiveViewSize[0] = 0;
+    this->ProgressiveViewSize[1] = 0;
     //ENDSLICERADD
 
 
@@ -620,6 +654,8 @@ vtkSlicerFixedPointVolumeRayCastMapper::~vtkSlicerFixedPointVolumeRayCastMapper(
 
     // Delete storage used by min/max volume
     delete [] this->MinMaxVolume;
+    delete [] this->OpacityClassification;
+    delete [] this->MinMaxTree;
 }
 
 float vtkSlicerFixedPointVolumeRayCastMapper::ComputeRequiredImageSampleDistance( float desiredTime,
@@ -935,30 +971,31 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
             this->MinMaxVolumeSize[1] = targetSize[1];
             this->MinMaxVolumeSize[2] = targetSize[2];
             this->MinMaxVolumeSize[3] = targetSize[3];
+        }
 
-            // Initialize the structure
-            unsigned short *tmpPtr = this->MinMaxVolume;
-            for ( i = 0; i < targetSize[0] * targetSize[1] * targetSize[2]; i++ )
+        // Initialize the structure. This must be done each time the data
+        // changes, not only when the size of the min max volume does.
+        unsigned short *tmpPtr = this->MinMaxVolume;
+        for ( i = 0; i < targetSize[0] * targetSize[1] * targetSize[2]; i++ )
+        {
+            for ( j = 0; j < targetSize[3]; j++ )
             {
-                for ( j = 0; j < targetSize[3]; j++ )
-                {
-                    *(tmpPtr++) = 0xffff;  // Min Scalar
-                    *(tmpPtr++) = 0;       // Max Scalar
-                    *(tmpPtr++) = 0;       // Max Gradient Magnitude and
-                }                      // Flag computed from transfer functions
-            }
+                *(tmpPtr++) = 0xffff;  // Min Scalar
+                *(tmpPtr++) = 0;       // Max Scalar
+                *(tmpPtr++) = 0;       // Max Gradient Magnitude and
+            }                      // Flag computed from transfer functions
+        }
 
-            // Now put the scalar data values into the structure
-            int scalarType   = input->GetScalarType();
-            void *dataPtr = input->GetScalarPointer();
+        // Now put the scalar data values into the structure
+        int scalarType   = input->GetScalarType();
+        void *dataPtr = input->GetScalarPointer();
 
-            switch ( scalarType )
-            {
-                vtkTemplateMacro(
-                    vtkSlicerFixedPointVolumeRayCastMapperFillInMinMaxVolume(
-                    (VTK_TT *)(dataPtr), this->MinMaxVolume, dim, targetSize,
-                    independent, components, this->TableShift, this->TableScale) );
-            }
+        switch ( scalarType )
+        {
+            vtkTemplateMacro(
+                vtkSlicerFixedPointVolumeRayCastMapperFillInMinMaxVolume(
+                (VTK_TT *)(dataPtr), this->MinMaxVolume, dim, targetSize,
+                independent, components, this->TableShift, this->TableScale) );
         }
 
         this->SavedMinMaxInput = input;
@@ -977,22 +1014,32 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
         this->SavedMinMaxBuildTime.Modified();
     }
 
-    // Update the flags now
-    unsigned short *minNonZeroScalarIndex = new unsigned short [this->MinMaxVolumeSize[3]];
-    for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
+    // Classify the scalar indices: entry i of a component is the number of
+    // indices below i with a non-zero opacity, so a region has some opacity
+    // if the counts differ at its minimum and after its maximum. The flags
+    // only depend on this classification (and on the gradient magnitude
+    // threshold), not on the colors nor on the actual opacity values.
+    const int classificationSize = 32769;
+    int numComponents = this->MinMaxVolumeSize[3];
+    unsigned short *classification =
+        new unsigned short [numComponents * classificationSize];
+    for ( c = 0; c < numComponents; c++ )
     {
-        for ( i = 0; i < this->TableSize[c]; i++ )
+        unsigned short *counts = classification + c * classificationSize;
+        unsigned short count = 0;
+        for ( i = 0; i < 32768; i++ )
         {
-            if ( this->ScalarOpacityTable[c][i] )
+            counts[i] = count;
+            if ( i < this->TableSize[c] && this->ScalarOpacityTable[c][i] )
             {
-                break;
+                count++;
             }
         }
-        minNonZeroScalarIndex[c] = i;
+        counts[32768] = count;
     }
 
-    unsigned char *minNonZeroGradientMagnitudeIndex = new unsigned char [this->MinMaxVolumeSize[3]];
-    for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
+    unsigned char minNonZeroGradientMagnitudeIndex[4] = {0, 0, 0, 0};
+    for ( c = 0; c < numComponents; c++ )
     {
         for ( i = 0; i < 256; i++ )
         {
@@ -1001,12 +1048,34 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
                 break;
             }
         }
-        minNonZeroGradientMagnitudeIndex[c] = i;
+        minNonZeroGradientMagnitudeIndex[c] = static_cast<unsigned char>((i < 256)?(i):(255));
+    }
+
+    // Nothing to do if the min max volume was not rebuilt and the opacity
+    // classification did not change (e.g. only the colors were edited)
+    if ( !(needToUpdate&0x06) &&
+         this->OpacityClassification &&
+         this->OpacityClassificationComponents == numComponents &&
+         this->SavedClassificationGradientOpacityRequired == this->GradientOpacityRequired &&
+         memcmp( this->SavedMinNonZeroGradientMagnitudeIndex,
+                 minNonZeroGradientMagnitudeIndex, numComponents ) == 0 &&
+         memcmp( this->OpacityClassification, classification,
+                 numComponents * classificationSize * sizeof(unsigned short) ) == 0 )
+    {
+        delete [] classification;
+        this->SavedMinMaxFlagTime.Modified();
+        return;
     }
 
+    delete [] this->OpacityClassification;
+    this->OpacityClassification = classification;
+    this->OpacityClassificationComponents = numComponents;
+    this->SavedClassificationGradientOpacityRequired = this->GradientOpacityRequired;
+    memcpy( this->SavedMinNonZeroGradientMagnitudeIndex,
+            minNonZeroGradientMagnitudeIndex, numComponents );
+
+    // Update the flags now
     unsigned short *tmpPtr = this->MinMaxVolume;
-    int zero = 0;
-    int nonZero = 0;
 
     for ( k = 0; k < this->MinMaxVolumeSize[2]; k++ )
     {
@@ -1014,60 +1083,25 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
         {
             for ( i = 0; i < this->MinMaxVolumeSize[0]; i++ )
             {
-                for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
+                for ( c = 0; c < numComponents; c++ )
                 {
-                    // We definite have 0 opacity because our maximum scalar value in
-                    // this region is below the minimum scalar value with non-zero opacity
-                    // for this component
-                    if ( tmpPtr[1] < minNonZeroScalarIndex[c] )
-                    {
-                        tmpPtr[2] &= 0xff00;
-                        zero++;
-                    }
-                    // We have 0 opacity because we are using gradient magnitudes and
-                    // the maximum gradient magnitude in this area is below the minimum
-                    // gradient magnitude with non-zero opacity for this component
-                    else if ( this->GradientOpacityRequired &&
-                        (tmpPtr[2]>>8) < minNonZeroGradientMagnitudeIndex[c] )
-                    {
-                        tmpPtr[2] &= 0xff00;
-                        zero++;
-                    }
-                    // We definitely have non-zero opacity because our minimum scalar
-                    // value is lower than our first scalar with non-zero opacity, and
-                    // the maximum scalar value is greater than this threshold - so
-                    // we must encounter scalars with opacity in between
-                    else if ( tmpPtr[0] < minNonZeroScalarIndex[c] )
+                    unsigned short *counts = classification + c * classificationSize;
+                    int minIndex = tmpPtr[0];
+                    int maxIndex = (tmpPtr[1] < 32767)?(tmpPtr[1]):(32767);
+
+                    tmpPtr[2] &= 0xff00;
+
+                    // Some opacity if there are indices with a non-zero opacity
+                    // between the minimum and maximum scalar values of the region
+                    // and, when gradient opacity is used, if the maximum gradient
+                    // magnitude in this area reaches the minimum gradient magnitude
+                    // with non-zero opacity for this component
+                    if ( minIndex <= maxIndex &&
+                         counts[maxIndex+1] != counts[minIndex] &&
+                         ( !this->GradientOpacityRequired ||
+                           (tmpPtr[2]>>8) >= minNonZeroGradientMagnitudeIndex[c] ) )
                     {
-                        tmpPtr[2] &= 0xff00;
                         tmpPtr[2] |= 0x0001;
-                        nonZero++;
-                    }
-                    // We have to search between min scalar value and the
-                    // max scalar stored in the minmax volume to look for non-zero
-                    // opacity since both values must be above our first non-zero
-                    // threshold so we don't have information in this area
-                    else
-                    {
-                        int loop;
-                        for ( loop = tmpPtr[0]; loop <= tmpPtr[1]; loop++ )
-                        {
-                            if ( this->ScalarOpacityTable[c][loop] )
-                            {
-                                break;
-                            }
-                        }
-                        if ( loop <= tmpPtr[1] )
-                        {
-                            tmpPtr[2] &= 0xff00;
-                            tmpPtr[2] |= 0x0001;
-                            nonZero++;
-                        }
-                        else
-                        {
-                            tmpPtr[2] &= 0xff00;
-                            zero++;
-                        }
                     }
                     tmpPtr += 3;
                 }
@@ -1075,10 +1109,106 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
         }
     }
 
+    this->UpdateMinMaxTree();
+
     this->SavedMinMaxFlagTime.Modified();
 
 }
 
+// Build the space leaping hierarchy from the flags of the first component
+// of the min max volume.
+void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxTree()
+{
+    int i, j, k, l;
+    int size[3];
+    size[0] = this->MinMaxVolumeSize[0];
+    size[1] = this->MinMaxVolumeSize[1];
+    size[2] = this->MinMaxVolumeSize[2];
+
+    vtkIdType offsets[VTKKW_FPMM_TREE_MAX_LEVELS];
+    vtkIdType totalSize = 0;
+    this->MinMaxTreeLevels = 0;
+    while ( this->MinMaxTreeLevels < VTKKW_FPMM_TREE_MAX_LEVELS )
+    {
+        l = this->MinMaxTreeLevels++;
+        this->MinMaxTreeSize[l][0] = size[0];
+        this->MinMaxTreeSize[l][1] = size[1];
+        this->MinMaxTreeSize[l][2] = size[2];
+        offsets[l] = totalSize;
+        totalSize += static_cast<vtkIdType>(size[0]) * size[1] * size[2];
+        if ( size[0] <= 1 && size[1] <= 1 && size[2] <= 1 )
+        {
+            break;
+        }
+        size[0] = (size[0] + 1) / 2;
+        size[1] = (size[1] + 1) / 2;
+        size[2] = (size[2] + 1) / 2;
+    }
+
+    if ( totalSize != this->MinMaxTreeAllocatedSize )
+    {
+        delete [] this->MinMaxTree;
+        this->MinMaxTree = (totalSize > 0)?(new unsigned char [totalSize]):(NULL);
+        this->MinMaxTreeAllocatedSize = totalSize;
+    }
+    if ( !this->MinMaxTree )
+    {
+        this->MinMaxTreeLevels = 0;
+        return;
+    }
+    for ( l = 0; l < this->MinMaxTreeLevels; l++ )
+    {
+        this->MinMaxTreeLevel[l] = this->MinMaxTree + offsets[l];
+    }
+
+    // Level 0: the flags of the first component, as checked by the
+    // space leaping of the composite helpers
+    const unsigned short *mmPtr = this->MinMaxVolume + 2;
+    const int mmIncrement = 3 * this->MinMaxVolumeSize[3];
+    unsigned char *treePtr = this->MinMaxTreeLevel[0];
+    vtkIdType numberOfCells = static_cast<vtkIdType>(this->MinMaxVolumeSize[0]) *
+        this->MinMaxVolumeSize[1] * this->MinMaxVolumeSize[2];
+    for ( vtkIdType cell = 0; cell < numberOfCells; cell++ )
+    {
+        *(treePtr++) = ((*mmPtr)&0x00ff)?(1):(0);
+        mmPtr += mmIncrement;
+    }
+
+    // Coarser levels: OR of the 2x2x2 children
+    for ( l = 1; l < this->MinMaxTreeLevels; l++ )
+    {
+        const int *fine = this->MinMaxTreeSize[l-1];
+        const unsigned char *finePtr = this->MinMaxTreeLevel[l-1];
+        treePtr = this->MinMaxTreeLevel[l];
+        for ( k = 0; k < this->MinMaxTreeSize[l][2]; k++ )
+        {
+            int z1 = 2*k;
+            int z2 = (2*k+1 < fine[2])?(2*k+1):(z1);
+            for ( j = 0; j < this->MinMaxTreeSize[l][1]; j++ )
+            {
+                int y1 = 2*j;
+                int y2 = (2*j+1 < fine[1])?(2*j+1):(y1);
+                for ( i = 0; i < this->MinMaxTreeSize[l][0]; i++ )
+                {
+                    int x1 = 2*i;
+                    int x2 = (2*i+1 < fine[0])?(2*i+1):(x1);
+                    unsigned char flag = 0;
+                    for ( int z = z1; z <= z2 && !flag; z++ )
+                    {
+                        for ( int y = y1; y <= y2 && !flag; y++ )
+                        {
+                            const unsigned char *rowPtr =
+                                finePtr + (static_cast<vtkIdType>(z)*fine[1] + y)*fine[0];
+                            flag = rowPtr[x1] | rowPtr[x2];
+                        }
+                    }
+                    *(treePtr++) = flag;
+                }
+            }
+        }
+    }
+}
+
 void vtkSlicerFixedPointVolumeRayCastMapper::UpdateCroppingRegions()
 {
     this->ConvertCroppingRegionPlanesToVoxels();
@@ -1154,6 +1284,13 @@ int vtkSlicerFixedPointVolumeRayCastMapper::PerImageInitialization( vtkRenderer
 
     }
 
+    //SLICERADD
+    if ( !multiRender )
+    {
+        this->UpdateProgressivePass( ren, vol );
+    }
+    //ENDSLICERADD
+
     // Pass the ImageSampleDistance on the RayCastImage
     this->RayCastImage->SetImageSampleDistance( this->ImageSampleDistance );
 
@@ -1223,6 +1360,15 @@ void vtkSlicerFixedPointVolumeRayCastMapper::PerVolumeInitialization( vtkRendere
     this->UpdateGradients( vol );
     this->UpdateShadingTable( ren, vol );
     this->UpdateMinMaxVolume( vol );
+
+    // The rays can only step over the empty regions of the hierarchy when
+    // the helpers would skip them too: composite rendering with the space
+    // leaping of the first (and only) component of the min max volume
+    this->SpaceLeapAlongRays =
+        ( this->SpaceLeaping &&
+          this->MinMaxTreeLevels > 0 &&
+          this->MinMaxVolumeSize[3] == 1 &&
+          this->GetBlendMode() != vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND );
 }
 
 // This is the initialization that should be done once per subvolume
@@ -1297,8 +1443,81 @@ void vtkSlicerFixedPointVolumeRayCastMapper::AbortRender()
     // Restore values
     this->ImageSampleDistance = this->OldImageSampleDistance;
     this->SampleDistance      = this->OldSampleDistance;
+
+    //SLICERADD
+    // Start the progressive render again next time
+    this->ProgressivePass = 0;
+    this->ProgressiveRefinementPending = 0;
+    //ENDSLICERADD
 }
 
+//SLICERADD
+// Still renders of an unchanged view refine the image pass after pass,
+// anything else starts again from the coarsest pass.
+void vtkSlicerFixedPointVolumeRayCastMapper::UpdateProgressivePass( vtkRenderer *ren, vtkVolume *vol )
+{
+    this->ProgressiveRefinementPending = 0;
+    if ( !this->ProgressiveRendering )
+    {
+        this->ProgressivePass = 0;
+        return;
+    }
+
+    int interactive = ( this->ManualInteractive == 1 ||
+                        vol->GetAllocatedRenderTime() < 1.0 );
+
+    unsigned long viewMTime = this->GetMTime();
+    unsigned long mtime = vol->GetMTime();
+    viewMTime = (mtime > viewMTime)?(mtime):(viewMTime);
+    if ( vol->GetProperty() )
+    {
+        mtime = vol->GetProperty()->GetMTime();
+        viewMTime = (mtime > viewMTime)?(mtime):(viewMTime);
+    }
+    if ( this->GetInput() )
+    {
+        mtime = this->GetInput()->GetMTime();
+        viewMTime = (mtime > viewMTime)?(mtime):(viewMTime);
+    }
+    if ( ren->GetActiveCamera() )
+    {
+        mtime = ren->GetActiveCamera()->GetMTime();
+        viewMTime = (mtime > viewMTime)?(mtime):(viewMTime);
+    }
+    int viewSize[2];
+    ren->GetTiledSize( &viewSize[0], &viewSize[1] );
+
+    if ( interactive ||
+         viewMTime != this->ProgressiveViewMTime ||
+         viewSize[0] != this->ProgressiveViewSize[0] ||
+         viewSize[1] != this->ProgressiveViewSize[1] )
+    {
+        this->ProgressivePass = 0;
+    }
+    this->ProgressiveViewMTime = viewMTime;
+    this->ProgressiveViewSize[0] = viewSize[0];
+    this->ProgressiveViewSize[1] = viewSize[1];
+
+    int coarsening = this->ProgressiveLevels - 1 - this->ProgressivePass;
+    if ( interactive || coarsening <= 0 )
+    {
+        return;
+    }
+
+    float maximumImageSampleDistance =
+        (this->MaximumImageSampleDistance > this->ImageSampleDistance)?
+        (this->MaximumImageSampleDistance):(this->ImageSampleDistance);
+    float coarseImageSampleDistance =
+        this->ImageSampleDistance * static_cast<float>(1 << coarsening);
+    this->ProgressiveImageSampleDistance = this->ImageSampleDistance;
+    this->ImageSampleDistance =
+        (coarseImageSampleDistance < maximumImageSampleDistance)?
+        (coarseImageSampleDistance):(maximumImageSampleDistance);
+    this->ProgressivePass++;
+    this->ProgressiveRefinementPending = 1;
+}
+//ENDSLICERADD
+
 // Capture the ZBuffer to use for intermixing with opaque geometry
 // that has already been rendered
 void vtkSlicerFixedPointVolumeRayCastMapper::CaptureZBuffer( vtkRenderer *ren )
@@ -1419,6 +1638,16 @@ void vtkSlicerFixedPointVolumeRayCastMapper::Render( vtkRenderer *ren, vtkVolume
         this->OldSampleDistance ) );
 
     this->SampleDistance = this->OldSampleDistance;
+
+    //SLICERADD
+    if ( this->ProgressiveRefinementPending )
+    {
+        // Keep the requested image sample distance for the next pass and
+        // let the application schedule it
+        this->ImageSampleDistance = this->ProgressiveImageSampleDistance;
+        this->InvokeEvent( vtkSlicerFixedPointVolumeRayCastMapper::ProgressiveRefinementEvent );
+    }
+    //ENDSLICERADD
 }
 
 VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_CastRays( void *arg )
@@ -1657,8 +1886,155 @@ void vtkSlicerFixedPointVolumeRayCastMapper::ComputeRayInfo( int x, int y, unsig
                     stepsValid = 1;
                 }
             }
+
+            if ( this->SpaceLeapAlongRays && *numSteps > 0 )
+            {
+                this->SkipEmptySpace( pos, dir, numSteps );
+            }
+        }
+    }
+}
+
+unsigned int vtkSlicerFixedPointVolumeRayCastMapper::ComputeEmptySteps( unsigned int pos[3],
+                                                                       unsigned int dir[3],
+                                                                       unsigned int numSteps )
+{
+    if ( !this->SpaceLeapAlongRays || this->MinMaxTreeLevels == 0 )
+    {
+        return 0;
+    }
+
+    unsigned int p[3] = { pos[0], pos[1], pos[2] };
+    unsigned int steps = 0;
+    while ( steps < numSteps )
+    {
+        unsigned int mmpos[3];
+        mmpos[0] = p[0] >> VTKKW_FPMM_SHIFT;
+        mmpos[1] = p[1] >> VTKKW_FPMM_SHIFT;
+        mmpos[2] = p[2] >> VTKKW_FPMM_SHIFT;
+
+        // Outside of the min max volume: let the helper handle the sample
+        const int *size = this->MinMaxTreeSize[0];
+        if ( mmpos[0] >= static_cast<unsigned int>(size[0]) ||
+             mmpos[1] >= static_cast<unsigned int>(size[1]) ||
+             mmpos[2] >= static_cast<unsigned int>(size[2]) )
+        {
+            return steps;
+        }
+        if ( this->MinMaxTreeLevel[0][ (mmpos[2]*size[1] + mmpos[1])*size[0] + mmpos[0] ] )
+        {
+            return steps;
         }
+
+        // Largest empty node containing the sample
+        int level = 0;
+        while ( level + 1 < this->MinMaxTreeLevels )
+        {
+            size = this->MinMaxTreeSize[level+1];
+            unsigned int node[3];
+            node[0] = mmpos[0] >> (level + 1);
+            node[1] = mmpos[1] >> (level + 1);
+            node[2] = mmpos[2] >> (level + 1);
+            if ( this->MinMaxTreeLevel[level+1][ (node[2]*size[1] + node[1])*size[0] + node[0] ] )
+            {
+                break;
+            }
+            level++;
+        }
+
+        // Number of steps to leave this node: the first step that crosses one
+        // of its faces along any axis
+        const int shift = VTKKW_FPMM_SHIFT + level;
+        vtkTypeUInt64 skip = 0;
+        int skipValid = 0;
+        int axis;
+        for ( axis = 0; axis < 3; axis++ )
+        {
+            vtkTypeUInt64 increment = dir[axis]&0x7fffffff;
+            if ( !increment )
+            {
+                continue;
+            }
+            vtkTypeUInt64 position = p[axis];
+            vtkTypeUInt64 nodeStart = (position >> shift) << shift;
+            vtkTypeUInt64 axisSteps;
+            if ( dir[axis]&0x80000000 )
+            {
+                vtkTypeUInt64 nodeEnd = nodeStart + (static_cast<vtkTypeUInt64>(1) << shift);
+                axisSteps = (nodeEnd - position + increment - 1) / increment;
+            }
+            else
+            {
+                axisSteps = (position - nodeStart) / increment + 1;
+            }
+            if ( !skipValid || axisSteps < skip )
+            {
+                skip = axisSteps;
+                skipValid = 1;
+            }
+        }
+
+        if ( !skipValid || skip >= numSteps - steps )
+        {
+            return numSteps;
+        }
+
+        steps += static_cast<unsigned int>(skip);
+        for ( axis = 0; axis < 3; axis++ )
+        {
+            unsigned int delta = static_cast<unsigned int>(skip) * (dir[axis]&0x7fffffff);
+            if ( dir[axis]&0x80000000 )
+            {
+                p[axis] += delta;
+            }
+            else
+            {
+                p[axis] -= delta;
+            }
+        }
+    }
+    return steps;
+}
+
+// Move the start and the end of the ray to the first and the last samples
+// in regions with some opacity. The composite helpers would skip the samples
+// in between anyway, but one at a time.
+void vtkSlicerFixedPointVolumeRayCastMapper::SkipEmptySpace( unsigned int pos[3],
+                                                            unsigned int dir[3],
+                                                            unsigned int *numSteps )
+{
+    unsigned int front = this->ComputeEmptySteps( pos, dir, *numSteps );
+    if ( front >= *numSteps )
+    {
+        *numSteps = 0;
+        return;
+    }
+
+    int axis;
+    for ( axis = 0; axis < 3; axis++ )
+    {
+        unsigned int delta = front * (dir[axis]&0x7fffffff);
+        if ( dir[axis]&0x80000000 )
+        {
+            pos[axis] += delta;
+        }
+        else
+        {
+            pos[axis] -= delta;
+        }
+    }
+    *numSteps -= front;
+
+    // Walk back from the last sample
+    unsigned int last[3];
+    unsigned int back[3];
+    for ( axis = 0; axis < 3; axis++ )
+    {
+        unsigned int delta = (*numSteps - 1) * (dir[axis]&0x7fffffff);
+        last[axis] = (dir[axis]&0x80000000)?(pos[axis] + delta):(pos[axis] - delta);
+        back[axis] = dir[axis]^0x80000000;
     }
+    *numSteps -= this->ComputeEmptySteps( last, back, *numSteps );
 }
 
 void vtkSlicerFixedPointVolumeRayCastMapper::InitializeRayInfo( vtkVolume   *vol )
@@ -3116,6 +3492,12 @@ void vtkSlicerFixedPointVolumeRayCastMapper::PrintSelf(ostream& os, vtkIndent in
         << this->AutoAdjustSampleDistances << endl;
     os << indent << "Intermix Intersecting Geometry: "
         << (this->IntermixIntersectingGeometry ? "On\n" : "Off\n");
+    os << indent << "Progressive Rendering: "
+        << (this->ProgressiveRendering ? "On\n" : "Off\n");
+    os << indent << "Progressive Levels: " << this->ProgressiveLevels << endl;
+    os << indent << "Space Leaping: "
+        << (this->SpaceLeaping ? "On\n" : "Off\n");
+    os << indent << "Space Leaping Tree Levels: " << this->MinMaxTreeLevels << endl;
 
     os << indent << "ShadingRequired: " << this->ShadingRequired << endl;
     os << indent << "GradientOpacityRequired: " << this->GradientOpacityRequired
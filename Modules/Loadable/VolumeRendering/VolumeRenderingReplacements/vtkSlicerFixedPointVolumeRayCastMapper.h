@@ -46,6 +46,19 @@
 // the neighborhood (an unsigned char) and the flag that is filled
 // in for the current lookup tables to indicate whether this region
 // can be skipped.
+//
+// The flags are only recomputed when the transfer functions change which
+// scalar indices have a non-zero opacity, and they are gathered in a
+// hierarchy of 2x2x2 regions (a min max octree reduced to the flags). When
+// the helpers rely on the flags of the first component (composite rendering
+// of one or dependent components), the empty regions at both ends of a ray
+// are stepped over through the largest empty node of the hierarchy instead of
+// one sample at a time.
+//
+// In ProgressiveRendering mode, a still render first casts the rays with a
+// coarser image sample distance and fires a ProgressiveRefinementEvent. The
+// next still renders of the same view refine the image until the requested
+// image sample distance is reached.
 
 // .SECTION see also
 // vtkVolumeMapper
@@ -53,6 +66,7 @@
 #ifndef __vtkSlicerFixedPointVolumeRayCastMapper_h
 #define __vtkSlicerFixedPointVolumeRayCastMapper_h
 
+#include "vtkCommand.h"
 #include "vtkVolumeMapper.h"
 #include "VolumeRenderingReplacementsExport.h"
 
@@ -61,6 +75,7 @@
 #define VTKKW_FPMM_SHIFT     17
 #define VTKKW_FP_MASK        0x7fff
 #define VTKKW_FP_SCALE       32767.0
+#define VTKKW_FPMM_TREE_MAX_LEVELS 16
 
 class vtkMatrix4x4;
 class vtkMultiThreader;
@@ -97,6 +112,44 @@ public:
     vtkGetMacro(ManualInteractiveRate,double);
     vtkSetMacro(ManualInteractiveRate,double);
 
+    // Description:
+    // Render still frames in several passes: the first pass casts the rays
+    // with an image sample distance 2^(ProgressiveLevels-1) times the
+    // requested one, each following still render of the same view halves it.
+    // A ProgressiveRefinementEvent is fired after each pass but the last one
+    // so that the application can schedule the next render when idle.
+    // Interactive renders are not affected. Off by default.
+    vtkGetMacro(ProgressiveRendering,int);
+    vtkSetMacro(ProgressiveRendering,int);
+    vtkBooleanMacro(ProgressiveRendering,int);
+    vtkGetMacro(ProgressiveLevels,int);
+    vtkSetClampMacro(ProgressiveLevels,int,1,8);
+
+    // Description:
+    // Step over the empty regions at both ends of the rays through the space
+    // leaping hierarchy. It only applies to composite rendering of one or
+    // dependent components and doesn't change the image. On by default.
+    vtkGetMacro(SpaceLeaping,int);
+    vtkSetMacro(SpaceLeaping,int);
+    vtkBooleanMacro(SpaceLeaping,int);
+
+    // Description:
+    // Whether the last render was a coarse pass of a progressive render.
+    vtkGetMacro(ProgressiveRefinementPending,int);
+
+    enum
+    {
+        ProgressiveRefinementEvent = vtkCommand::UserEvent + 1
+    };
+
+    // Description:
+    // Number of samples, from the first one, that lie in regions with no
+    // opacity according to the space leaping hierarchy. Returns 0 when the
+    // hierarchy is not used for the current render.
+    unsigned int ComputeEmptySteps( unsigned int pos[3],
+                                    unsigned int dir[3],
+                                    unsigned int numSteps );
+
   //ENDSLICERADD
 
   static vtkSlicerFixedPointVolumeRayCastMapper *New();
@@ -263,6 +316,21 @@ protected:
     //SLICERADD
     int ManualInteractive;
     double ManualInteractiveRate;
+
+    int SpaceLeaping;
+
+    int ProgressiveRendering;
+    int ProgressiveLevels;
+    int ProgressivePass;
+    int ProgressiveRefinementPending;
+    float ProgressiveImageSampleDistance;
+    unsigned long ProgressiveViewMTime;
+    int ProgressiveViewSize[2];
+
+    // Description:
+    // Coarsen the image sample distance for the current pass of a
+    // progressive render.
+    void UpdateProgressivePass( vtkRenderer *ren, vtkVolume *vol );
   //ENDSLICERADD
 
 
@@ -442,6 +510,29 @@ protected:
   void            FillInMaxGradientMagnitudes( int fullDim[3],
                                                int smallDim[3] );
 
+  // Number of scalar indices with a non zero opacity below each index
+  // (32769 entries per component). Two transfer functions with the same
+  // counts skip the same regions.
+  unsigned short *OpacityClassification;
+  int             OpacityClassificationComponents;
+  unsigned char   SavedMinNonZeroGradientMagnitudeIndex[4];
+  int             SavedClassificationGradientOpacityRequired;
+
+  // Space leaping hierarchy: level 0 holds the flags of the first component
+  // of the min max volume, each node of level l+1 is non zero if one of its
+  // 2x2x2 children of level l is.
+  unsigned char  *MinMaxTree;
+  vtkIdType       MinMaxTreeAllocatedSize;
+  int             MinMaxTreeLevels;
+  int             MinMaxTreeSize[VTKKW_FPMM_TREE_MAX_LEVELS][3];
+  unsigned char  *MinMaxTreeLevel[VTKKW_FPMM_TREE_MAX_LEVELS];
+  int             SpaceLeapAlongRays;
+
+  void            UpdateMinMaxTree();
+  void            SkipEmptySpace( unsigned int pos[3],
+                                  unsigned int dir[3],
+                                  unsigned int *numSteps );
+
 private:
   vtkSlicerFixedPointVolumeRayCastMapper(const vtkSlicerFixedPointVolumeRayCastMapper&);  // Not implemented.
   void operator=(const vtkSlicerFixedPointVolumeRayCastMapper&);  // Not implemented.
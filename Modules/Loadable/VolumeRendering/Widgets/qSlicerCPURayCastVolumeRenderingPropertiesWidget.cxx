@@ -63,6 +63,10 @@ void qSlicerCPURayCastVolumeRenderingPropertiesWidgetPrivate
   this->populateRenderingTechniqueComboBox();
   QObject::connect(this->RenderingTechniqueComboBox, SIGNAL(currentIndexChanged(int)),
                    widget, SLOT(setRenderingTechnique(int)));
+  QObject::connect(this->ProgressiveRenderingCheckBox, SIGNAL(toggled(bool)),
+                   widget, SLOT(setProgressiveRendering(bool)));
+  QObject::connect(this->SpaceLeapingCheckBox, SIGNAL(toggled(bool)),
+                   widget, SLOT(setSpaceLeaping(bool)));
 }
 
 // --------------------------------------------------------------------------
@@ -123,6 +127,11 @@ void qSlicerCPURayCastVolumeRenderingPropertiesWidget
     index = 0;
     }
   d->RenderingTechniqueComboBox->setCurrentIndex(index);
+
+  d->ProgressiveRenderingCheckBox->setChecked(
+    this->mrmlCPURayCastDisplayNode()->GetProgressiveRendering() != 0);
+  d->SpaceLeapingCheckBox->setChecked(
+    this->mrmlCPURayCastDisplayNode()->GetSpaceLeaping() != 0);
 }
 
 //-----------------------------------------------------------------------------
@@ -137,3 +146,25 @@ void qSlicerCPURayCastVolumeRenderingPropertiesWidget
   int technique = d->RenderingTechniqueComboBox->itemData(index).toInt();
   this->mrmlCPURayCastDisplayNode()->SetRaycastTechnique(technique);
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerCPURayCastVolumeRenderingPropertiesWidget
+::setProgressiveRendering(bool enable)
+{
+  if (!this->mrmlCPURayCastDisplayNode())
+    {
+    return;
+    }
+  this->mrmlCPURayCastDisplayNode()->SetProgressiveRendering(enable ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCPURayCastVolumeRenderingPropertiesWidget
+::setSpaceLeaping(bool enable)
+{
+  if (!this->mrmlCPURayCastDisplayNode())
+    {
+    return;
+    }
+  this->mrmlCPURayCastDisplayNode()->SetSpaceLeaping(enable ? 1 : 0);
+}
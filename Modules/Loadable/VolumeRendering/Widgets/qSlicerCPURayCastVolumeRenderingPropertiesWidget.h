@@ -40,6 +40,8 @@ public:
 
 public slots:
   void setRenderingTechnique(int index);
+  void setProgressiveRendering(bool enable);
+  void setSpaceLeaping(bool enable);
 
 protected slots:
   virtual void updateWidgetFromMRML();
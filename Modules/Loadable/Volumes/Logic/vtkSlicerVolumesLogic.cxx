@@ -271,6 +271,24 @@ ArchetypeVolumeNodeSet ArchetypeVectorVolumeNodeSetFactory(std::string& volumeNa
   return nodeSet;
 }
 
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLStorageNode> CreateScalarVolumeStorageNode(int options)
+{
+  if (options & vtkSlicerVolumesLogic::Bricked)
+    {
+    // Only the NRRD storage node reads by bricks
+    vtkNew<vtkMRMLNRRDStorageNode> storageNode;
+    storageNode->SetCenterImage(options & vtkSlicerVolumesLogic::CenterImage);
+    storageNode->BrickedReadingOn();
+    return storageNode.GetPointer();
+    }
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+  storageNode->SetCenterImage(options & vtkSlicerVolumesLogic::CenterImage);
+  storageNode->SetUseOrientationFromFile(!((options & vtkSlicerVolumesLogic::DiscardOrientation) != 0));
+  storageNode->SetSingleFile(options & vtkSlicerVolumesLogic::SingleFile);
+  return storageNode.GetPointer();
+}
+
 //----------------------------------------------------------------------------
 ArchetypeVolumeNodeSet LabelMapVolumeNodeSetFactory(std::string& volumeName, vtkMRMLScene* scene, int options)
 {
@@ -286,14 +304,11 @@ ArchetypeVolumeNodeSet LabelMapVolumeNodeSetFactory(std::string& volumeName, vtk
   nodeSet.Scene->AddNode(lmdisplayNode.GetPointer());
   scalarNode->SetAndObserveDisplayNodeID(lmdisplayNode->GetID());
 
-  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
-  storageNode->SetCenterImage(options & vtkSlicerVolumesLogic::CenterImage);
-  storageNode->SetUseOrientationFromFile(!((options & vtkSlicerVolumesLogic::DiscardOrientation) != 0));
-  storageNode->SetSingleFile(options & vtkSlicerVolumesLogic::SingleFile);
-  nodeSet.Scene->AddNode(storageNode.GetPointer());
+  vtkSmartPointer<vtkMRMLStorageNode> storageNode = CreateScalarVolumeStorageNode(options);
+  nodeSet.Scene->AddNode(storageNode);
   scalarNode->SetAndObserveStorageNodeID(storageNode->GetID());
 
-  nodeSet.StorageNode = storageNode.GetPointer();
+  nodeSet.StorageNode = storageNode;
   nodeSet.DisplayNode = lmdisplayNode.GetPointer();
   nodeSet.Node = scalarNode.GetPointer();
 
@@ -317,14 +332,11 @@ ArchetypeVolumeNodeSet ScalarVolumeNodeSetFactory(std::string& volumeName, vtkMR
   nodeSet.Scene->AddNode(sdisplayNode.GetPointer());
   scalarNode->SetAndObserveDisplayNodeID(sdisplayNode->GetID());
 
-  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
-  storageNode->SetCenterImage(options & vtkSlicerVolumesLogic::CenterImage);
-  storageNode->SetUseOrientationFromFile(!((options & vtkSlicerVolumesLogic::DiscardOrientation) != 0));
-  storageNode->SetSingleFile(options & vtkSlicerVolumesLogic::SingleFile);
-  nodeSet.Scene->AddNode(storageNode.GetPointer());
+  vtkSmartPointer<vtkMRMLStorageNode> storageNode = CreateScalarVolumeStorageNode(options);
+  nodeSet.Scene->AddNode(storageNode);
   scalarNode->SetAndObserveStorageNodeID(storageNode->GetID());
 
-  nodeSet.StorageNode = storageNode.GetPointer();
+  nodeSet.StorageNode = storageNode;
   nodeSet.DisplayNode = sdisplayNode.GetPointer();
   nodeSet.Node = scalarNode.GetPointer();
 
@@ -490,6 +502,7 @@ vtkMRMLScalarVolumeNode* vtkSlicerVolumesLogic::AddArchetypeScalarVolume(
 // bit 2: loading single file
 // bit 3: auto calculate window/level
 // bit 4: discard image orientation
+// bit 5: read by bricks (NRRD files only)
 // higher bits are reserved for future use
 vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     const NodeSetFactoryRegistry& volumeRegistry,
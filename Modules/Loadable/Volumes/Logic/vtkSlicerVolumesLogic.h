@@ -74,7 +74,10 @@ public:
     CenterImage = 2,
     SingleFile = 4,
     AutoWindowLevel = 8,
-    DiscardOrientation = 16
+    DiscardOrientation = 16,
+    /// Read the scalar volume by bricks on demand, for NRRD files larger
+    /// than the memory (see vtkMRMLNRRDStorageNode::BrickedReading)
+    Bricked = 32
   };
 
   /// Factory function to create a volume node, display node, and
@@ -82,6 +82,8 @@ void qSlicerScalarVolumeDisplayWidgetPrivate::init()
 
   QObject::connect(this->InterpolateCheckbox, SIGNAL(toggled(bool)),
                    q, SLOT(setInterpolate(bool)));
+  QObject::connect(this->MipmapPyramidCheckbox, SIGNAL(toggled(bool)),
+                   q, SLOT(setUseMipmapPyramid(bool)));
   QObject::connect(this->ColorTableComboBox, SIGNAL(currentNodeChanged(vtkMRMLNode*)),
                    q, SLOT(setColorNode(vtkMRMLNode*)));
 
@@ -200,6 +202,7 @@ void qSlicerScalarVolumeDisplayWidget::updateWidgetFromMRML()
     {
     d->ColorTableComboBox->setCurrentNode(displayNode->GetColorNode());
     d->InterpolateCheckbox->setChecked(displayNode->GetInterpolate());
+    d->MipmapPyramidCheckbox->setChecked(displayNode->GetUseMipmapPyramid());
     }
   if (this->isVisible())
     {
@@ -296,6 +299,18 @@ void qSlicerScalarVolumeDisplayWidget::setInterpolate(bool interpolate)
   displayNode->SetInterpolate(interpolate);
 }
 
+// --------------------------------------------------------------------------
+void qSlicerScalarVolumeDisplayWidget::setUseMipmapPyramid(bool use)
+{
+  vtkMRMLScalarVolumeDisplayNode* displayNode =
+    this->volumeDisplayNode();
+  if (!displayNode)
+    {
+    return;
+    }
+  displayNode->SetUseMipmapPyramid(use);
+}
+
 // --------------------------------------------------------------------------
 void qSlicerScalarVolumeDisplayWidget::setColorNode(vtkMRMLNode* colorNode)
 {
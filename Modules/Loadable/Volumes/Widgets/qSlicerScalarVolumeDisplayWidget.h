@@ -48,6 +48,9 @@ public slots:
   void setMRMLVolumeNode(vtkMRMLNode* node);
 
   void setInterpolate(bool interpolate);
+  /// Reslice zoomed out slices from a downsampled volume while interacting
+  /// \sa vtkMRMLVolumeDisplayNode::SetUseMipmapPyramid()
+  void setUseMipmapPyramid(bool use);
   void setColorNode(vtkMRMLNode* colorNode);
   void setPreset(const QString& presetName);
 
@@ -140,6 +140,10 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
     {
     options |= properties["discardOrientation"].toBool() ? 0x10 : 0x0;
     }
+  if (properties.contains("bricked"))
+    {
+    options |= properties["bricked"].toBool() ? 0x20 : 0x0;
+    }
   vtkSmartPointer<vtkStringArray> fileList;
   if (properties.contains("fileNames"))
     {
@@ -145,17 +145,24 @@ class ChangeIslandEffectLogic(IslandEffect.IslandEffectLogic):
     ijk = xyToIJK.MultiplyPoint( xy + (0, 1) )[:3]
     ijk = map(lambda v: int(round(v)), ijk)
 
-    connectivity = slicer.vtkImageConnectivity()
-    connectivity.SetFunctionToChangeIsland()
-    connectivity.SetInput( self.getScopedLabelInput() )
-    connectivity.SetOutput( self.getScopedLabelOutput() )
-    connectivity.SetOutputLabel( self.editUtil.getLabel() )
-    connectivity.SetSeed( ijk )
-    # TODO: $this setProgressFilter $connectivity "Change Island"
-    connectivity.Update()
+    # the scoped output can be the scoped input: work on a shallow copy
+    labelImage = vtk.vtkImageData()
+    labelImage.ShallowCopy( self.getScopedLabelInput() )
+    islandImage = self.seedIsland(labelImage, ijk)
+    if islandImage is None:
+      return
+
+    # write the label over the island, keep the input elsewhere
+    mask = vtk.vtkImageMask()
+    mask.SetImageInput( labelImage )
+    mask.SetMaskInput( islandImage )
+    mask.NotMaskOn()
+    mask.SetMaskedOutputValue( self.editUtil.getLabel() )
+    mask.SetOutput( self.getScopedLabelOutput() )
+    mask.Update()
 
     self.applyScopedLabel()
-    connectivity.SetOutput( None )
+    mask.SetOutput( None )
 
 #
 # The ChangeIslandEffect class definition 
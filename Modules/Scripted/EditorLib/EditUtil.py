@@ -194,7 +194,14 @@ class EditUtil(object):
 class UndoRedo(object):
   """ Code to manage a list of undo/redo volumes
   stored in a compressed format using the vtkImageStash
-  class to compress label maps in a thread
+  class to compress label maps by bricks in parallel.
+  Each checkpoint only compresses the bricks that changed since
+  the previous checkpoint and shares the other ones with it,
+  and restoring a checkpoint only decompresses the bricks that
+  differ from the current state, so the cost of a checkpoint is
+  proportional to the modified region instead of the volume size.
+  Effects report the voxels they modify with addModifiedCorners so
+  that the next checkpoint does not need to compare all the bricks.
   """
 
   class checkPoint(object):
@@ -202,30 +209,54 @@ class UndoRedo(object):
     step consisting of the stashed data
     and the volumeNode it corresponds to
     """
-    def __init__(self,volumeNode):
+    def __init__(self,volumeNode,previousCheckPoint=None):
       self.volumeNode = volumeNode
-      self.stashImage = vtk.vtkImageData()
+      # extent of the voxels modified since this checkpoint and
+      # modification time of the image when it was last reported
+      self.modifiedExtent = None
+      self.modifiedMTime = None
       self.stash = slicer.vtkImageStash()
-      self.stashImage.DeepCopy( volumeNode.GetImageData() )
-      self.stash.SetStashImage( self.stashImage )
-      self.stash.ThreadedStash()
-
-    def restore(self):
-      """Unstash the volume but first check that the
-      stash operation is not still ongoing in the other thread.
-      TODO: the stash operation is determinisitic, so there's
-      no chance of a deadlock here, but it would still be better
-      to integrate the wait into the event queue to avoid locking
-      the interface.  In practice this would only happen if the user
-      clicks Undo while the thread is still executing, which is
-      unlikely.  And at worst this busy loop will consume two threads
-      (this one and the stashing one) for the time the stash takes to complete.
+      # stash the image of the volume directly, without copying it
+      imageData = volumeNode.GetImageData()
+      self.stash.SetStashImage( imageData )
+      self.stash.KeepScalarsOn()
+      if previousCheckPoint and previousCheckPoint.volumeNode == volumeNode:
+        self.stash.SetPreviousStash( previousCheckPoint.stash )
+        # the reported extent is only trusted if the image has not been
+        # modified since the last report, otherwise all the bricks are compared
+        if (previousCheckPoint.modifiedExtent and
+            previousCheckPoint.modifiedMTime == imageData.GetMTime()):
+          self.stash.SetModifiedExtent( previousCheckPoint.modifiedExtent )
+      self.stash.Stash()
+      self.stash.SetPreviousStash( None )
+      self.stash.SetStashImage( None )
+
+    def restore(self,currentCheckPoint=None):
+      """Unstash the volume. If currentCheckPoint is the stash
+      of the current state of the volume, only the bricks that
+      differ from it are decompressed.
       """
-      while self.stash.GetStashing():
-        pass
-      self.stash.Unstash()
-      self.volumeNode.GetImageData().DeepCopy( self.stashImage )
+      currentStash = None
+      if currentCheckPoint and currentCheckPoint.volumeNode == self.volumeNode:
+        currentStash = currentCheckPoint.stash
+      self.stash.SetStashImage( self.volumeNode.GetImageData() )
+      self.stash.Unstash( currentStash )
+      self.stash.SetStashImage( None )
       EditUtil().markVolumeNodeAsModified(self.volumeNode)
+      # the image matches this checkpoint again: report the decompressed
+      # bricks as modified so that the next checkpoint shares the other
+      # bricks without comparing them
+      self.modifiedExtent = None
+      extent = self.stash.GetUnstashedExtent()
+      if extent[0] <= extent[1] and extent[2] <= extent[3] and extent[4] <= extent[5]:
+        self.addModifiedExtent(extent)
+
+    def addModifiedExtent(self,extent):
+      """Add the extent to the voxels modified since this checkpoint"""
+      if self.modifiedExtent:
+        extent = [ f(a,b) for f,a,b in zip((min,max)*3, self.modifiedExtent, extent) ]
+      self.modifiedExtent = list(extent)
+      self.modifiedMTime = self.volumeNode.GetImageData().GetMTime()
 
 
   def __init__(self,undoSize=100):
@@ -233,6 +264,7 @@ class UndoRedo(object):
     self.undoSize = undoSize
     self.undoList = []
     self.redoList = []
+    self.lastCheckPoint = None
     self.editUtil = EditUtil()
     self.stateChangedCallback = self.defaultStateChangedCallback
 
@@ -256,14 +288,31 @@ class UndoRedo(object):
     the passed list (could be undo or redo list)
     """
     if not self.enabled or not volumeNode or not volumeNode.GetImageData():
+      # the current state is not stashed
+      self.lastCheckPoint = None
       return
-    checkPointList.append( self.checkPoint(volumeNode) )
+    self.lastCheckPoint = self.checkPoint(volumeNode, self.lastCheckPoint)
+    checkPointList.append( self.lastCheckPoint )
     self.stateChangedCallback()
     if len(checkPointList) >= self.undoSize:
       return( checkPointList[1:] )
     else:
       return( checkPointList )
 
+  def addModifiedCorners(self,volumeNode,ijkCorners):
+    """Called by effects after they modify the voxels of the volume node
+    inside the bounding box of the ijk corners, and after
+    EditUtil.markVolumeNodeAsModified. The next checkpoint then only
+    compresses the bricks of the modified region.
+    """
+    if not ijkCorners or not self.lastCheckPoint or self.lastCheckPoint.volumeNode != volumeNode:
+      return
+    extent = []
+    for axis in xrange(3):
+      coordinates = [ int(round(corner[axis])) for corner in ijkCorners ]
+      extent += [ min(coordinates), max(coordinates) ]
+    self.lastCheckPoint.addModifiedExtent(extent)
+
   def saveState(self):
     """Called by effects as they modify the label volume node
     """
@@ -283,7 +332,9 @@ class UndoRedo(object):
     # store current state onto redoList
     self.redoList = self.storeVolume( self.redoList, self.editUtil.getLabelVolume() )
     # get the checkPoint to restore and remove it from the list
-    self.undoList[-1].restore()
+    checkPoint = self.undoList[-1]
+    checkPoint.restore( self.lastCheckPoint )
+    self.lastCheckPoint = checkPoint
     self.undoList = self.undoList[:-1]
     self.stateChangedCallback()
 
@@ -298,6 +349,8 @@ class UndoRedo(object):
     # store current state onto undoList
     self.undoList = self.storeVolume( self.undoList, self.editUtil.getLabelVolume() )
     # get the checkPoint to restore and remove it from the list
-    self.redoList[-1].restore()
+    checkPoint = self.redoList[-1]
+    checkPoint.restore( self.lastCheckPoint )
+    self.lastCheckPoint = checkPoint
     self.redoList = self.redoList[:-1]
     self.stateChangedCallback()
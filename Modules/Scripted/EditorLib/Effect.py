@@ -399,16 +399,19 @@ class EffectLogic(object):
     if self.undoRedo:
       self.undoRedo.saveState()
     targetImage = volumeNode.GetImageData()
+    modifiedCorners = None
     if self.scope == "All":
       targetImage.DeepCopy( self.scopedImageBuffer )
     elif self.scope == "Visible":
       self.scopedSlicePaint.SetWorkingImage( targetImage )
       self.scopedSlicePaint.SetReplaceImage( self.scopedImageBuffer )
-      self.getVisibleCorners( layerLogic, self.scopedSlicePaint )
+      modifiedCorners = self.getVisibleCorners( layerLogic, self.scopedSlicePaint )
       self.scopedSlicePaint.Paint()
     else:
       print("Invalid scope option %s" % self.scope)
     self.editUtil.markVolumeNodeAsModified(volumeNode)
+    if self.undoRedo and modifiedCorners:
+      self.undoRedo.addModifiedCorners(volumeNode, modifiedCorners)
 
   def getVisibleCorners(self,layerLogic,slicePaint=None):
     """return a nested list of ijk coordinates representing
@@ -200,71 +200,28 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
     bgImage = self.editUtil.getBackgroundImage()
     labelImage = self.editUtil.getLabelImage()
 
-    # collect seeds
     dim = bgImage.GetWholeExtent()
-    # initialize the filter
-    self.fm = slicer.vtkPichonFastMarching()
-    scalarRange = bgImage.GetScalarRange()
-    depth = scalarRange[1]-scalarRange[0]
-
-    # this is more or less arbitrary; large depth values will bring the
-    # algorithm to the knees
-    scaleValue = 0
-    shiftValue = 0
-
-    if depth>300:
-      scaleValue = 300./depth
-    if scalarRange[0] < 0:
-      shiftValue = scalarRange[0]*-1
-
-    if scaleValue or shiftValue:
-      rescale = vtk.vtkImageShiftScale()
-      rescale.SetInput(bgImage)
-      rescale.SetScale(scaleValue)
-      rescale.SetShift(shiftValue)
-      rescale.Update()
-      bgImage = rescale.GetOutput()
-      scalarRange = bgImage.GetScalarRange()
-      depth = scalarRange[1]-scalarRange[0]
-
-    print('Input scalar range: '+str(depth))
-    self.fm.init(dim[1]+1, dim[3]+1, dim[5]+1, depth, 1, 1, 1)
-
-    caster = vtk.vtkImageCast()
-    caster.SetOutputScalarTypeToShort()
-    caster.SetInput(bgImage)
-    caster.Update()
-
-    self.fm.SetInput(caster.GetOutput())
-    # self.fm.SetOutput(labelImage)
-
-    npoints = int((dim[1]+1)*(dim[3]+1)*(dim[5]+1)*percentMax/100.)
-
-    self.fm.setNPointsEvolution(npoints)
+    # initialize the filter: the speed image is computed from the background
+    # image (any scalar type) and the statistics of the seeds
+    self.fm = slicer.vtkImageFastMarching()
+    self.fm.SetInputImage(bgImage)
+    self.fm.SetLabelImage(labelImage)
     print('Setting active label to '+str(self.editUtil.getLabel()))
-    self.fm.setActiveLabel(self.editUtil.getLabel())
+    self.fm.SetLabel(self.editUtil.getLabel())
 
-    nSeeds = self.fm.addSeedsFromImage(labelImage)
+    nSeeds = self.fm.Initialize()
     if nSeeds == 0:
+      self.fm = None
       return 0
 
-    self.fm.Modified()
-    self.fm.Update()
-
-    # TODO: need to call show() twice for data to be updated
-    self.fm.show(1)
-    self.fm.Modified()
-    self.fm.Update()
-
-    self.fm.show(1)
-    self.fm.Modified()
-    self.fm.Update()
+    npoints = int((dim[1]+1)*(dim[3]+1)*(dim[5]+1)*percentMax/100.)
+    npoints = self.fm.March(npoints)
 
     self.undoRedo.saveState()
 
-    self.editUtil.getLabelImage().DeepCopy(self.fm.GetOutput())
+    # the label image is updated in place
+    self.fm.Show(1)
     self.editUtil.markVolumeNodeAsModified(self.sliceLogic.GetLabelLayer().GetVolumeNode())
-    # print('FastMarching output image: '+str(output))
     print('FastMarching march update completed')
 
     return npoints
@@ -272,13 +229,8 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
   def updateLabel(self,value):
     if not self.fm:
       return
-    self.fm.show(value)
-    self.fm.Modified()
-    self.fm.Update()
-
-    self.editUtil.getLabelImage().DeepCopy(self.fm.GetOutput())
-    self.editUtil.getLabelImage().Modified()
- 
+    # only the voxels added or removed since the last update are modified
+    self.fm.Show(value)
     self.editUtil.markVolumeNodeAsModified(self.sliceLogic.GetLabelLayer().GetVolumeNode())
 
   def getLabelNode(self):
@@ -349,29 +349,21 @@ class HelperBox(object):
     lo = int(accum.GetMin()[0])
     hi = int(accum.GetMax()[0])
 
-    # TODO: pending resolution of bug 1822, run the thresholding
-    # in single threaded mode to avoid data corruption observed on mac release
-    # builds
-    thresholder = vtk.vtkImageThreshold()
-    thresholder.SetNumberOfThreads(1)
+    # encode the merge volume once: each structure is decoded from the runs
+    # of its label instead of thresholding the whole merge volume per label
+    labelMap = slicer.vtkImageRunLengthLabelMap()
+    labelMap.SetImage( merge.GetImageData() )
+    labelImage = vtk.vtkImageData()
     for i in xrange(lo,hi+1):
       self.statusText( "Splitting label %d..."%i )
-      thresholder.SetInput( merge.GetImageData() )
-      thresholder.SetInValue( i )
-      thresholder.SetOutValue( 0 )
-      thresholder.ReplaceInOn()
-      thresholder.ReplaceOutOn()
-      thresholder.ThresholdBetween( i, i )
-      thresholder.SetOutputScalarType( merge.GetImageData().GetScalarType() )
-      thresholder.Update()
-      if thresholder.GetOutput().GetScalarRange() != (0.0, 0.0):
+      if labelMap.GetLabelImage( i, labelImage ) != 0:
         labelName = colorNode.GetColorName(i)
         self.statusText( "Creating structure volume %s..."%labelName )
         structureVolume = self.structureVolume( labelName )
         if not structureVolume:
           self.addStructure( i, "noEdit" )
         structureVolume = self.structureVolume( labelName )
-        structureVolume.GetImageData().DeepCopy( thresholder.GetOutput() )
+        structureVolume.GetImageData().DeepCopy( labelImage )
         self.editUtil.markVolumeNodeAsModified(structureVolume)
 
     self.statusText( "Finished splitting." )
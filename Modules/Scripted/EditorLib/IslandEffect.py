@@ -1,5 +1,6 @@
 import os
 from __main__ import vtk
+import vtkITK
 from __main__ import qt
 from __main__ import ctk
 from __main__ import slicer
@@ -155,6 +156,46 @@ class IslandEffectLogic(Effect.EffectLogic):
   def __init__(self,sliceLogic):
     super(IslandEffectLogic,self).__init__(sliceLogic)
 
+  def seedIsland(self,labelImage,ijk):
+    """Return an unsigned char mask of the island containing the ijk
+    voxel: the voxels connected to it that have the same label value.
+    Return None if ijk is outside of the label image.
+    """
+    dims = labelImage.GetDimensions()
+    for axis in xrange(3):
+      if ijk[axis] < 0 or ijk[axis] >= dims[axis]:
+        print( "Seed %s out of bounds" % str(ijk) )
+        return None
+    seedLabel = labelImage.GetScalarComponentAsDouble(ijk[0], ijk[1], ijk[2], 0)
+
+    # voxels of the seed label are the foreground of the island math
+    # (unsigned int leaves room for more than 65535 islands)
+    preThresh = vtk.vtkImageThreshold()
+    preThresh.SetInput( labelImage )
+    preThresh.ThresholdBetween( seedLabel, seedLabel )
+    preThresh.SetInValue( 1 )
+    preThresh.SetOutValue( 0 )
+    preThresh.ReplaceInOn()
+    preThresh.ReplaceOutOn()
+    preThresh.SetOutputScalarTypeToUnsignedInt()
+
+    islandMath = vtkITK.vtkITKIslandMath()
+    islandMath.SetInput( preThresh.GetOutput() )
+    islandMath.SetFullyConnected( False )
+    islandMath.Update()
+    island = islandMath.GetOutput().GetScalarComponentAsDouble(ijk[0], ijk[1], ijk[2], 0)
+
+    postThresh = vtk.vtkImageThreshold()
+    postThresh.SetInput( islandMath.GetOutput() )
+    postThresh.ThresholdBetween( island, island )
+    postThresh.SetInValue( 1 )
+    postThresh.SetOutValue( 0 )
+    postThresh.ReplaceInOn()
+    postThresh.ReplaceOutOn()
+    postThresh.SetOutputScalarTypeToUnsignedChar()
+    postThresh.Update()
+    return postThresh.GetOutput()
+
 #
 # The IslandEffect class definition 
 #
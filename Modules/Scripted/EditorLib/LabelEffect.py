@@ -440,6 +440,8 @@ class LabelEffectLogic(Effect.EffectLogic):
     self.painter.Paint()
 
     self.editUtil.markVolumeNodeAsModified(labelNode)
+    if self.undoRedo:
+      self.undoRedo.addModifiedCorners(labelNode, (tl, tr, bl, br))
 
   def sliceIJKPlane(self):
     """ Return a code indicating which plane of IJK
@@ -0,0 +1,462 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// EditorLib includes
+#include "vtkImageFastMarching.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+const int Dimension = 32;
+const int Center = 16;
+const int Radius = 8;
+const int SeedLabel = 1;
+const int OtherLabel = 2;
+
+bool testSpeed();
+bool testVolume();
+bool testArrivalOrder();
+bool testShow();
+bool testThreads();
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkImageFastMarchingTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  if (!testSpeed())
+    {
+    std::cerr << "testSpeed call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testVolume())
+    {
+    std::cerr << "testVolume call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testArrivalOrder())
+    {
+    std::cerr << "testArrivalOrder call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testShow())
+    {
+    std::cerr << "testShow call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testThreads())
+    {
+    std::cerr << "testThreads call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+vtkIdType voxelIndex(int i, int j, int k)
+{
+  return i + (j + static_cast<vtkIdType>(k) * Dimension) * Dimension;
+}
+
+//---------------------------------------------------------------------------
+double distanceToSeed(vtkIdType voxel)
+{
+  const double i = static_cast<double>(voxel % Dimension - Center);
+  const double j = static_cast<double>((voxel / Dimension) % Dimension - Center);
+  const double k = static_cast<double>(voxel / (Dimension * Dimension) - Center);
+  return sqrt(i * i + j * j + k * k);
+}
+
+//---------------------------------------------------------------------------
+/// Uniform bright sphere on a dark background, seeded at its center, with a
+/// voxel of another label inside the sphere.
+void createImages(vtkImageData* input, vtkImageData* labels)
+{
+  input->SetDimensions(Dimension, Dimension, Dimension);
+  input->SetScalarTypeToShort();
+  input->SetNumberOfScalarComponents(1);
+  input->AllocateScalars();
+  labels->SetDimensions(Dimension, Dimension, Dimension);
+  labels->SetScalarTypeToShort();
+  labels->SetNumberOfScalarComponents(1);
+  labels->AllocateScalars();
+  short* inputPtr = static_cast<short*>(input->GetScalarPointer());
+  short* labelPtr = static_cast<short*>(labels->GetScalarPointer());
+  for (int k = 0; k < Dimension; ++k)
+    {
+    for (int j = 0; j < Dimension; ++j)
+      {
+      for (int i = 0; i < Dimension; ++i)
+        {
+        const int r2 = (i - Center) * (i - Center) + (j - Center) * (j - Center)
+          + (k - Center) * (k - Center);
+        inputPtr[voxelIndex(i, j, k)] = (r2 <= Radius * Radius) ? 100 : 0;
+        labelPtr[voxelIndex(i, j, k)] = 0;
+        }
+      }
+    }
+  labelPtr[voxelIndex(Center, Center, Center)] = SeedLabel;
+  labelPtr[voxelIndex(Center + 3, Center, Center)] = OtherLabel;
+}
+
+//---------------------------------------------------------------------------
+/// The speed is 1 where the 3x3x3 neighborhood has the median and the
+/// inhomogeneity of the seed (at most 5 dark voxels), minimal elsewhere.
+bool isFast(vtkImageData* input, int i, int j, int k)
+{
+  if (i == 0 || j == 0 || k == 0 ||
+      i == Dimension - 1 || j == Dimension - 1 || k == Dimension - 1)
+    {
+    return false;
+    }
+  const short* inputPtr = static_cast<short*>(input->GetScalarPointer());
+  int darkVoxels = 0;
+  for (int dk = -1; dk <= 1; ++dk)
+    {
+    for (int dj = -1; dj <= 1; ++dj)
+      {
+      for (int di = -1; di <= 1; ++di)
+        {
+        darkVoxels += (inputPtr[voxelIndex(i + di, j + dj, k + dk)] == 0) ? 1 : 0;
+        }
+      }
+    }
+  return darkVoxels <= 5;
+}
+
+//---------------------------------------------------------------------------
+/// Fast voxels face-connected to the seed, without the seed and the voxel of
+/// the other label: the voxels reached before any slow voxel.
+std::vector<bool> expectedRegion(vtkImageData* input, vtkIdType& regionSize)
+{
+  std::vector<bool> region(Dimension * Dimension * Dimension, false);
+  std::vector<bool> visited(region.size(), false);
+  std::vector<vtkIdType> front(1, voxelIndex(Center, Center, Center));
+  visited[front[0]] = true;
+  visited[voxelIndex(Center + 3, Center, Center)] = true;
+  regionSize = 0;
+  const vtkIdType offsets[6] = {-1, 1, -Dimension, Dimension,
+    -Dimension * Dimension, Dimension * Dimension};
+  while (!front.empty())
+    {
+    vtkIdType voxel = front.back();
+    front.pop_back();
+    for (int face = 0; face < 6; ++face)
+      {
+      vtkIdType neighbor = voxel + offsets[face];
+      if (visited[neighbor])
+        {
+        continue;
+        }
+      visited[neighbor] = true;
+      if (isFast(input, neighbor % Dimension, (neighbor / Dimension) % Dimension,
+                 neighbor / (Dimension * Dimension)))
+        {
+        region[neighbor] = true;
+        ++regionSize;
+        front.push_back(neighbor);
+        }
+      }
+    }
+  return region;
+}
+
+//---------------------------------------------------------------------------
+vtkIdType countLabel(vtkImageData* labels, int label)
+{
+  const short* labelPtr = static_cast<short*>(labels->GetScalarPointer());
+  vtkIdType count = 0;
+  for (vtkIdType n = 0; n < Dimension * Dimension * Dimension; ++n)
+    {
+    count += (labelPtr[n] == label) ? 1 : 0;
+    }
+  return count;
+}
+
+//---------------------------------------------------------------------------
+bool initialize(vtkImageFastMarching* fastMarching, vtkImageData* input,
+                vtkImageData* labels, int numberOfThreads)
+{
+  createImages(input, labels);
+  fastMarching->SetInputImage(input);
+  fastMarching->SetLabelImage(labels);
+  fastMarching->SetLabel(SeedLabel);
+  fastMarching->SetNumberOfThreads(numberOfThreads);
+  int seeds = fastMarching->Initialize();
+  if (seeds != 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": Initialize() found "
+              << seeds << " seeds instead of 1" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testSpeed()
+{
+  vtkNew<vtkImageData> input;
+  vtkNew<vtkImageData> labels;
+  vtkNew<vtkImageFastMarching> fastMarching;
+  if (!initialize(fastMarching.GetPointer(), input.GetPointer(), labels.GetPointer(), 1))
+    {
+    return false;
+    }
+  vtkImageData* speedImage = fastMarching->GetSpeedImage();
+  if (!speedImage || speedImage->GetScalarType() != VTK_FLOAT)
+    {
+    std::cerr << "Line " << __LINE__ << ": no float speed image" << std::endl;
+    return false;
+    }
+  const float* speed = static_cast<float*>(speedImage->GetScalarPointer());
+  for (int k = 0; k < Dimension; ++k)
+    {
+    for (int j = 0; j < Dimension; ++j)
+      {
+      for (int i = 0; i < Dimension; ++i)
+        {
+        const float value = speed[voxelIndex(i, j, k)];
+        const bool border = (i == 0 || j == 0 || k == 0 ||
+          i == Dimension - 1 || j == Dimension - 1 || k == Dimension - 1);
+        const bool expected = border ? (value == 0.f) :
+          isFast(input.GetPointer(), i, j, k) ? (fabs(value - 1.f) < 1e-6) :
+          (value > 0.f && value < 1e-5);
+        if (!expected)
+          {
+          std::cerr << "Line " << __LINE__ << ": wrong speed " << value
+                    << " at " << i << ", " << j << ", " << k << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testVolume()
+{
+  vtkNew<vtkImageData> input;
+  vtkNew<vtkImageData> labels;
+  vtkNew<vtkImageFastMarching> fastMarching;
+  if (!initialize(fastMarching.GetPointer(), input.GetPointer(), labels.GetPointer(), 1))
+    {
+    return false;
+    }
+  vtkIdType regionSize = 0;
+  std::vector<bool> region = expectedRegion(input.GetPointer(), regionSize);
+
+  // The whole sphere but its outer shell is reached before any slow voxel
+  vtkIdType marched = fastMarching->March(regionSize);
+  if (marched != regionSize || fastMarching->GetNumberOfMarchedPoints() != regionSize)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << marched << " voxels marched instead of "
+              << regionSize << std::endl;
+    return false;
+    }
+  fastMarching->Show(1.);
+  const short* labelPtr = static_cast<short*>(labels->GetScalarPointer());
+  for (vtkIdType n = 0; n < Dimension * Dimension * Dimension; ++n)
+    {
+    short expected = region[n] ? SeedLabel : 0;
+    if (n == voxelIndex(Center, Center, Center))
+      {
+      expected = SeedLabel;
+      }
+    else if (n == voxelIndex(Center + 3, Center, Center))
+      {
+      expected = OtherLabel;
+      }
+    if (labelPtr[n] != expected)
+      {
+      std::cerr << "Line " << __LINE__ << ": label " << labelPtr[n] << " instead of "
+                << expected << " at voxel " << n << std::endl;
+      return false;
+      }
+    }
+  const double fastArrival = fastMarching->GetShownArrivalTime();
+  if (fastArrival < Radius - 2 || fastArrival > 2 * Radius)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong arrival time " << fastArrival
+              << " at the border of the sphere" << std::endl;
+    return false;
+    }
+
+  // Marching further reaches slow voxels, much later
+  marched = fastMarching->March(regionSize + 10);
+  fastMarching->Show(1.);
+  if (marched != regionSize + 10 ||
+      countLabel(labels.GetPointer(), SeedLabel) != regionSize + 11 ||
+      countLabel(labels.GetPointer(), OtherLabel) != 1 ||
+      fastMarching->GetShownArrivalTime() < 1000. * fastArrival)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong expansion out of the sphere: "
+              << marched << " voxels marched, arrival time "
+              << fastMarching->GetShownArrivalTime() << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testArrivalOrder()
+{
+  vtkNew<vtkImageData> input;
+  vtkNew<vtkImageData> labels;
+  vtkNew<vtkImageFastMarching> fastMarching;
+  if (!initialize(fastMarching.GetPointer(), input.GetPointer(), labels.GetPointer(), 1))
+    {
+    return false;
+    }
+  vtkIdType regionSize = 0;
+  expectedRegion(input.GetPointer(), regionSize);
+  fastMarching->March(regionSize);
+
+  // Voxels are reached by increasing arrival time, never earlier than their
+  // distance to the seed at unit speed.
+  const short* labelPtr = static_cast<short*>(labels->GetScalarPointer());
+  std::vector<short> previousLabels(labelPtr, labelPtr + Dimension * Dimension * Dimension);
+  double previousArrival = 0.;
+  const int steps = 20;
+  for (int step = 1; step <= steps; ++step)
+    {
+    fastMarching->Show(static_cast<double>(step) / steps);
+    const double arrival = fastMarching->GetShownArrivalTime();
+    if (arrival < previousArrival)
+      {
+      std::cerr << "Line " << __LINE__ << ": arrival time " << arrival
+                << " after " << previousArrival << std::endl;
+      return false;
+      }
+    for (vtkIdType n = 0; n < Dimension * Dimension * Dimension; ++n)
+      {
+      if (labelPtr[n] == SeedLabel && previousLabels[n] == 0 &&
+          distanceToSeed(n) > arrival + 1e-2)
+        {
+        std::cerr << "Line " << __LINE__ << ": voxel " << n << " at distance "
+                  << distanceToSeed(n) << " reached at " << arrival << std::endl;
+        return false;
+        }
+      if (labelPtr[n] == 0 && previousLabels[n] == SeedLabel)
+        {
+        std::cerr << "Line " << __LINE__ << ": voxel " << n << " unlabeled" << std::endl;
+        return false;
+        }
+      previousLabels[n] = labelPtr[n];
+      }
+    previousArrival = arrival;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testShow()
+{
+  vtkNew<vtkImageData> input;
+  vtkNew<vtkImageData> labels;
+  vtkNew<vtkImageFastMarching> fastMarching;
+  if (!initialize(fastMarching.GetPointer(), input.GetPointer(), labels.GetPointer(), 1))
+    {
+    return false;
+    }
+  vtkIdType regionSize = 0;
+  expectedRegion(input.GetPointer(), regionSize);
+  fastMarching->March(regionSize);
+
+  const vtkIdType numberOfVoxels = Dimension * Dimension * Dimension;
+  const short* labelPtr = static_cast<short*>(labels->GetScalarPointer());
+  fastMarching->Show(0.3);
+  std::vector<short> partialLabels(labelPtr, labelPtr + numberOfVoxels);
+  const vtkIdType expectedCount = static_cast<vtkIdType>(0.3 * regionSize + 0.5) + 1;
+  if (countLabel(labels.GetPointer(), SeedLabel) != expectedCount)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << countLabel(labels.GetPointer(), SeedLabel)
+              << " voxels labeled instead of " << expectedCount << std::endl;
+    return false;
+    }
+
+  // Going back and forth gives the same label image
+  fastMarching->Show(1.);
+  fastMarching->Show(0.3);
+  if (memcmp(&partialLabels[0], labelPtr, numberOfVoxels * sizeof(short)) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": Show() is not reversible" << std::endl;
+    return false;
+    }
+
+  // Only the seed and the other label are left
+  fastMarching->Show(0.);
+  if (countLabel(labels.GetPointer(), SeedLabel) != 1 ||
+      countLabel(labels.GetPointer(), OtherLabel) != 1 ||
+      labelPtr[voxelIndex(Center, Center, Center)] != SeedLabel ||
+      fastMarching->GetShownArrivalTime() != 0.)
+    {
+    std::cerr << "Line " << __LINE__ << ": Show(0) doesn't restore the seeds" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testThreads()
+{
+  vtkNew<vtkImageData> input;
+  vtkNew<vtkImageData> labels;
+  vtkNew<vtkImageFastMarching> fastMarching;
+  if (!initialize(fastMarching.GetPointer(), input.GetPointer(), labels.GetPointer(), 1))
+    {
+    return false;
+    }
+  vtkNew<vtkImageData> threadedInput;
+  vtkNew<vtkImageData> threadedLabels;
+  vtkNew<vtkImageFastMarching> threadedFastMarching;
+  if (!initialize(threadedFastMarching.GetPointer(), threadedInput.GetPointer(),
+                  threadedLabels.GetPointer(), 4))
+    {
+    return false;
+    }
+
+  const vtkIdType numberOfVoxels = Dimension * Dimension * Dimension;
+  if (memcmp(fastMarching->GetSpeedImage()->GetScalarPointer(),
+             threadedFastMarching->GetSpeedImage()->GetScalarPointer(),
+             numberOfVoxels * sizeof(float)) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": the speed image depends on the "
+              << "number of threads" << std::endl;
+    return false;
+    }
+  const vtkIdType marched = fastMarching->March(2000);
+  const vtkIdType threadedMarched = threadedFastMarching->March(2000);
+  fastMarching->Show(1.);
+  threadedFastMarching->Show(1.);
+  if (marched != threadedMarched ||
+      fastMarching->GetShownArrivalTime() != threadedFastMarching->GetShownArrivalTime() ||
+      memcmp(labels->GetScalarPointer(), threadedLabels->GetScalarPointer(),
+             numberOfVoxels * sizeof(short)) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": the expansion depends on the "
+              << "number of threads" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
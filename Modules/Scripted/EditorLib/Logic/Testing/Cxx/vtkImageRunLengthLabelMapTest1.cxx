@@ -0,0 +1,787 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// EditorLib includes
+#include "vtkImageRunLengthLabelMap.h"
+#include "vtkImageSlicePaint.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtk_zlib.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+bool testRoundTrip();
+bool testSlices();
+bool testDenseSlices();
+bool testLabelImage();
+bool testWriteReadNRRD(const std::string& temporaryDirectory);
+bool testReadNRRD(const std::string& temporaryDirectory);
+bool testPaintLabelMap();
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkImageRunLengthLabelMapTest1(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkImageRunLengthLabelMapTest1 /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string temporaryDirectory = argv[1];
+
+  if (!testRoundTrip())
+    {
+    std::cerr << "testRoundTrip call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testSlices())
+    {
+    std::cerr << "testSlices call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testDenseSlices())
+    {
+    std::cerr << "testDenseSlices call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testLabelImage())
+    {
+    std::cerr << "testLabelImage call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testWriteReadNRRD(temporaryDirectory))
+    {
+    std::cerr << "testWriteReadNRRD call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testReadNRRD(temporaryDirectory))
+    {
+    std::cerr << "testReadNRRD call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testPaintLabelMap())
+    {
+    std::cerr << "testPaintLabelMap call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// 64x40x30 label map with labelled blocks, stripes along the rows and empty
+// slices at both ends
+vtkSmartPointer<vtkImageData> createLabelMap()
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(-3, 60, 5, 44, 2, 31);
+  image->SetSpacing(0.5, 0.75, 2.);
+  image->SetOrigin(10., -20., 5.);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  for (int k = 2; k <= 31; ++k)
+    {
+    for (int j = 5; j <= 44; ++j)
+      {
+      for (int i = -3; i <= 60; ++i)
+        {
+        short label = 0;
+        if (k >= 5 && k <= 28)
+          {
+          if (i >= 10 && i <= 40 && j >= 10 && j <= 30)
+            {
+            label = static_cast<short>(1 + (i + j + k) / 16 % 3);
+            }
+          else if (j % 7 == 0 && i % 5 != 0)
+            {
+            label = 7;
+            }
+          }
+        *static_cast<short*>(image->GetScalarPointer(i, j, k)) = label;
+        }
+      }
+    }
+  return image;
+}
+
+//---------------------------------------------------------------------------
+// Checkerboard of labels in the slices [kMin, kMax]: each label voxel is a
+// run, the runs take more memory than the voxels
+void addCheckerboard(vtkImageData* image, int kMin, int kMax)
+{
+  int* extent = image->GetExtent();
+  for (int k = kMin; k <= kMax; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        *static_cast<short*>(image->GetScalarPointer(i, j, k)) =
+          static_cast<short>((i + j) % 2 ? 0 : 1 + (i + 3) % 3);
+        }
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+std::vector<short> scalarValues(vtkImageData* image)
+{
+  const short* scalars = static_cast<short*>(image->GetScalarPointer());
+  return std::vector<short>(scalars, scalars + image->GetNumberOfPoints());
+}
+
+//---------------------------------------------------------------------------
+bool isEqual(vtkImageData* image, const std::vector<short>& values)
+{
+  return image->GetScalarType() == VTK_SHORT &&
+    image->GetNumberOfPoints() == static_cast<vtkIdType>(values.size()) &&
+    std::equal(values.begin(), values.end(),
+               static_cast<short*>(image->GetScalarPointer()));
+}
+
+//---------------------------------------------------------------------------
+bool isEqual(vtkImageRunLengthLabelMap* labelMap, const std::vector<short>& values)
+{
+  vtkNew<vtkImageData> image;
+  labelMap->GetImage(image.GetPointer());
+  return isEqual(image.GetPointer(), values);
+}
+
+//---------------------------------------------------------------------------
+// Number of runs of non-zero labels along the rows
+vtkIdType countRuns(vtkImageData* image)
+{
+  int* extent = image->GetExtent();
+  vtkIdType numberOfRuns = 0;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      short previous = 0;
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        short label = *static_cast<short*>(image->GetScalarPointer(i, j, k));
+        if (label != 0 && label != previous)
+          {
+          ++numberOfRuns;
+          }
+        previous = label;
+        }
+      }
+    }
+  return numberOfRuns;
+}
+
+//---------------------------------------------------------------------------
+std::vector<unsigned char> gzipCompress(const void* data, size_t size)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+               Z_DEFAULT_STRATEGY);
+  std::vector<unsigned char> member(deflateBound(&stream, static_cast<uLong>(size)) + 32);
+  stream.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+  stream.avail_in = static_cast<uInt>(size);
+  stream.next_out = &member[0];
+  stream.avail_out = static_cast<uInt>(member.size());
+  deflate(&stream, Z_FINISH);
+  member.resize(stream.total_out);
+  deflateEnd(&stream);
+  return member;
+}
+
+//---------------------------------------------------------------------------
+bool isClose(double value, double expected)
+{
+  return fabs(value - expected) < 1e-9;
+}
+
+//---------------------------------------------------------------------------
+bool testRoundTrip()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  std::vector<short> values = scalarValues(image);
+
+  // More threads than slices with labels
+  vtkNew<vtkImageRunLengthLabelMap> labelMap;
+  labelMap->SetNumberOfThreads(7);
+  labelMap->SetImage(image);
+  int* extent = labelMap->GetExtent();
+  if (extent[0] != -3 || extent[1] != 60 || extent[2] != 5 ||
+      extent[3] != 44 || extent[4] != 2 || extent[5] != 31 ||
+      labelMap->GetSpacing()[2] != 2. || labelMap->GetOrigin()[1] != -20. ||
+      labelMap->GetScalarType() != VTK_SHORT)
+    {
+    std::cerr << __LINE__ << ": Wrong geometry" << std::endl;
+    return false;
+    }
+  if (labelMap->GetNumberOfRuns() != countRuns(image))
+    {
+    std::cerr << __LINE__ << ": Wrong number of runs: " << labelMap->GetNumberOfRuns()
+              << " instead of " << countRuns(image) << std::endl;
+    return false;
+    }
+  if (labelMap->GetActualMemorySize() >= image->GetActualMemorySize())
+    {
+    std::cerr << __LINE__ << ": Label map not smaller than the image: "
+              << labelMap->GetActualMemorySize() << " KiB" << std::endl;
+    return false;
+    }
+  for (int k = 1; k <= 32; k += 3)
+    {
+    for (int j = 4; j <= 45; ++j)
+      {
+      for (int i = -4; i <= 61; ++i)
+        {
+        bool inside = (i >= -3 && i <= 60 && j >= 5 && j <= 44 && k >= 2 && k <= 31);
+        double expected = inside ?
+          *static_cast<short*>(image->GetScalarPointer(i, j, k)) : 0.;
+        if (labelMap->GetValue(i, j, k) != expected)
+          {
+          std::cerr << __LINE__ << ": Wrong value at " << i << " " << j << " " << k
+                    << ": " << labelMap->GetValue(i, j, k) << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+
+  vtkNew<vtkImageData> decodedImage;
+  labelMap->GetImage(decodedImage.GetPointer());
+  int decodedExtent[6];
+  decodedImage->GetExtent(decodedExtent);
+  if (!isEqual(decodedImage.GetPointer(), values) ||
+      !std::equal(decodedExtent, decodedExtent + 6, image->GetExtent()) ||
+      decodedImage->GetSpacing()[0] != 0.5 || decodedImage->GetOrigin()[0] != 10.)
+    {
+    std::cerr << __LINE__ << ": GetImage failed" << std::endl;
+    return false;
+    }
+
+  // Only the first component is encoded
+  vtkNew<vtkImageData> twoComponents;
+  twoComponents->SetExtent(0, 9, 0, 4, 0, 2);
+  twoComponents->SetScalarTypeToUnsignedChar();
+  twoComponents->SetNumberOfScalarComponents(2);
+  twoComponents->AllocateScalars();
+  unsigned char* scalars = static_cast<unsigned char*>(twoComponents->GetScalarPointer());
+  for (vtkIdType n = 0; n < twoComponents->GetNumberOfPoints(); ++n)
+    {
+    scalars[2 * n] = static_cast<unsigned char>(n % 4 == 0 ? 0 : 3);
+    scalars[2 * n + 1] = 255;
+    }
+  labelMap->SetImage(twoComponents.GetPointer());
+  labelMap->GetImage(decodedImage.GetPointer());
+  scalars = static_cast<unsigned char*>(decodedImage->GetScalarPointer());
+  if (decodedImage->GetScalarType() != VTK_UNSIGNED_CHAR ||
+      decodedImage->GetNumberOfScalarComponents() != 1 ||
+      decodedImage->GetNumberOfPoints() != 150)
+    {
+    std::cerr << __LINE__ << ": Wrong decoded image" << std::endl;
+    return false;
+    }
+  for (vtkIdType n = 0; n < decodedImage->GetNumberOfPoints(); ++n)
+    {
+    if (scalars[n] != (n % 4 == 0 ? 0 : 3))
+      {
+      std::cerr << __LINE__ << ": Wrong value at " << n << std::endl;
+      return false;
+      }
+    }
+
+  // Initialize keeps the geometry
+  labelMap->Initialize();
+  if (labelMap->GetNumberOfRuns() != 0 || labelMap->GetExtent()[1] != 9)
+    {
+    std::cerr << __LINE__ << ": Initialize failed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testSlices()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  vtkNew<vtkImageRunLengthLabelMap> labelMap;
+  labelMap->SetImage(image);
+
+  // The slab is indexed with the ijk coordinates of the label map
+  vtkNew<vtkImageData> slab;
+  labelMap->GetSlices(10, 12, slab.GetPointer());
+  int* slabExtent = slab->GetExtent();
+  if (slabExtent[0] != -3 || slabExtent[1] != 60 || slabExtent[2] != 5 ||
+      slabExtent[3] != 44 || slabExtent[4] != 10 || slabExtent[5] != 12)
+    {
+    std::cerr << __LINE__ << ": Wrong slab extent" << std::endl;
+    return false;
+    }
+  for (int k = 10; k <= 12; ++k)
+    {
+    for (int j = 5; j <= 44; ++j)
+      {
+      for (int i = -3; i <= 60; ++i)
+        {
+        if (*static_cast<short*>(slab->GetScalarPointer(i, j, k)) !=
+            *static_cast<short*>(image->GetScalarPointer(i, j, k)))
+          {
+          std::cerr << __LINE__ << ": Wrong slab value at "
+                    << i << " " << j << " " << k << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+
+  // Edit the slab, in the middle and at both ends of the rows
+  for (int i = -3; i <= 60; i += 9)
+    {
+    *static_cast<short*>(slab->GetScalarPointer(i, 20, 11)) = 9;
+    *static_cast<short*>(image->GetScalarPointer(i, 20, 11)) = 9;
+    }
+  *static_cast<short*>(slab->GetScalarPointer(60, 44, 12)) = 4;
+  *static_cast<short*>(image->GetScalarPointer(60, 44, 12)) = 4;
+  *static_cast<short*>(slab->GetScalarPointer(20, 20, 10)) = 0;
+  *static_cast<short*>(image->GetScalarPointer(20, 20, 10)) = 0;
+  labelMap->SetSlices(slab.GetPointer());
+  if (!isEqual(labelMap.GetPointer(), scalarValues(image)) ||
+      labelMap->GetValue(60, 44, 12) != 4. || labelMap->GetValue(20, 20, 10) != 0.)
+    {
+    std::cerr << __LINE__ << ": SetSlices failed" << std::endl;
+    return false;
+    }
+
+  // Slices partially outside of the label map are clamped
+  labelMap->GetSlices(28, 40, slab.GetPointer());
+  if (slab->GetExtent()[4] != 28 || slab->GetExtent()[5] != 31)
+    {
+    std::cerr << __LINE__ << ": Wrong clamped slab extent" << std::endl;
+    return false;
+    }
+  std::fill(static_cast<short*>(slab->GetScalarPointer()),
+            static_cast<short*>(slab->GetScalarPointer()) + slab->GetNumberOfPoints(), 0);
+  labelMap->SetSlices(slab.GetPointer());
+  for (int k = 28; k <= 31; ++k)
+    {
+    std::fill(static_cast<short*>(image->GetScalarPointer(-3, 5, k)),
+              static_cast<short*>(image->GetScalarPointer(-3, 5, k)) + 64 * 40, 0);
+    }
+  if (!isEqual(labelMap.GetPointer(), scalarValues(image)) ||
+      labelMap->GetNumberOfRuns() != countRuns(image))
+    {
+    std::cerr << __LINE__ << ": SetSlices of cleared slices failed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testDenseSlices()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  addCheckerboard(image, 20, 22);
+  std::vector<short> values = scalarValues(image);
+  vtkNew<vtkImageRunLengthLabelMap> labelMap;
+  labelMap->SetImage(image);
+  if (labelMap->GetNumberOfDenseSlices() != 3 ||
+      labelMap->GetNumberOfRuns() >= countRuns(image) ||
+      !isEqual(labelMap.GetPointer(), values))
+    {
+    std::cerr << __LINE__ << ": Wrong dense slices: " << labelMap->GetNumberOfDenseSlices()
+              << " dense slices, " << labelMap->GetNumberOfRuns() << " runs" << std::endl;
+    return false;
+    }
+  for (int j = 5; j <= 44; ++j)
+    {
+    for (int i = -3; i <= 60; ++i)
+      {
+      if (labelMap->GetValue(i, j, 21) !=
+          *static_cast<short*>(image->GetScalarPointer(i, j, 21)))
+        {
+        std::cerr << __LINE__ << ": Wrong dense value at " << i << " " << j << std::endl;
+        return false;
+        }
+      }
+    }
+
+  // Slabs of dense slices are decoded and encoded like the others
+  vtkNew<vtkImageData> slab;
+  labelMap->GetSlices(19, 21, slab.GetPointer());
+  std::fill(static_cast<short*>(slab->GetScalarPointer(-3, 5, 21)),
+            static_cast<short*>(slab->GetScalarPointer(-3, 5, 21)) + 64 * 40, 0);
+  std::fill(static_cast<short*>(image->GetScalarPointer(-3, 5, 21)),
+            static_cast<short*>(image->GetScalarPointer(-3, 5, 21)) + 64 * 40, 0);
+  addCheckerboard(slab.GetPointer(), 19, 19);
+  addCheckerboard(image, 19, 19);
+  labelMap->SetSlices(slab.GetPointer());
+  if (labelMap->GetNumberOfDenseSlices() != 3 ||
+      labelMap->GetValue(-3, 5, 21) != 0. || labelMap->GetValue(-3, 5, 19) != 1. ||
+      !isEqual(labelMap.GetPointer(), scalarValues(image)))
+    {
+    std::cerr << __LINE__ << ": SetSlices of dense slices failed" << std::endl;
+    return false;
+    }
+
+  // Dense slices are not smaller than the voxels, but not much bigger
+  if (labelMap->GetActualMemorySize() >= image->GetActualMemorySize())
+    {
+    std::cerr << __LINE__ << ": Label map not smaller than the image: "
+              << labelMap->GetActualMemorySize() << " KiB" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testLabelImage()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  addCheckerboard(image, 20, 20);
+  vtkNew<vtkImageRunLengthLabelMap> labelMap;
+  labelMap->SetNumberOfThreads(3);
+  labelMap->SetImage(image);
+  if (labelMap->GetNumberOfDenseSlices() != 1)
+    {
+    std::cerr << __LINE__ << ": Wrong number of dense slices" << std::endl;
+    return false;
+    }
+
+  // Labels of runs only, of runs and dense slices, and missing
+  const short labels[4] = {1, 3, 7, 9};
+  vtkNew<vtkImageData> labelImage;
+  for (int n = 0; n < 4; ++n)
+    {
+    std::vector<short> values = scalarValues(image);
+    vtkIdType expectedNumberOfVoxels = 0;
+    for (size_t v = 0; v < values.size(); ++v)
+      {
+      if (values[v] == labels[n])
+        {
+        ++expectedNumberOfVoxels;
+        }
+      else
+        {
+        values[v] = 0;
+        }
+      }
+    vtkIdType numberOfVoxels = labelMap->GetLabelImage(labels[n], labelImage.GetPointer());
+    if (numberOfVoxels != expectedNumberOfVoxels ||
+        labelImage->GetExtent()[0] != -3 || labelImage->GetExtent()[5] != 31 ||
+        !isEqual(labelImage.GetPointer(), values))
+      {
+      std::cerr << __LINE__ << ": Wrong image of the label " << labels[n] << ": "
+                << numberOfVoxels << " voxels instead of " << expectedNumberOfVoxels
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testWriteReadNRRD(const std::string& temporaryDirectory)
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  std::vector<short> values = scalarValues(image);
+  vtkNew<vtkImageRunLengthLabelMap> labelMap;
+  labelMap->SetImage(image);
+
+  // Oblique IJK to RAS: i goes posterior, j goes right
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  ijkToRAS->SetElement(0, 0, 0.);
+  ijkToRAS->SetElement(1, 0, -0.5);
+  ijkToRAS->SetElement(0, 1, 0.75);
+  ijkToRAS->SetElement(1, 1, 0.);
+  ijkToRAS->SetElement(2, 2, 2.);
+  ijkToRAS->SetElement(0, 3, 12.);
+  ijkToRAS->SetElement(1, 3, -34.);
+  ijkToRAS->SetElement(2, 3, 56.);
+  // RAS of the first voxel of the extent
+  double firstVoxel[4] = {-3., 5., 2., 1.};
+  double origin[4];
+  ijkToRAS->MultiplyPoint(firstVoxel, origin);
+
+  const std::string fileName = temporaryDirectory + "/vtkImageRunLengthLabelMapTest1.nrrd";
+  if (!labelMap->WriteNRRD(fileName.c_str(), ijkToRAS.GetPointer()))
+    {
+    std::cerr << __LINE__ << ": WriteNRRD failed" << std::endl;
+    return false;
+    }
+
+  // The data is compressed
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  std::string line;
+  bool gzip = false;
+  while (std::getline(file, line) && !line.empty())
+    {
+    gzip = gzip || line == "encoding: gzip";
+    }
+  file.close();
+  if (!gzip)
+    {
+    std::cerr << __LINE__ << ": The NRRD data is not compressed" << std::endl;
+    return false;
+    }
+
+  vtkNew<vtkImageRunLengthLabelMap> readLabelMap;
+  vtkNew<vtkMatrix4x4> readIJKToRAS;
+  if (!readLabelMap->ReadNRRD(fileName.c_str(), readIJKToRAS.GetPointer()))
+    {
+    std::cerr << __LINE__ << ": ReadNRRD failed" << std::endl;
+    return false;
+    }
+  remove(fileName.c_str());
+  for (int row = 0; row < 4; ++row)
+    {
+    for (int column = 0; column < 4; ++column)
+      {
+      double expected = column == 3 ? (row == 3 ? 1. : origin[row]) :
+        ijkToRAS->GetElement(row, column);
+      if (!isClose(readIJKToRAS->GetElement(row, column), expected))
+        {
+        std::cerr << __LINE__ << ": Wrong IJK to RAS element " << row << " " << column
+                  << ": " << readIJKToRAS->GetElement(row, column) << std::endl;
+        return false;
+        }
+      }
+    }
+  int* extent = readLabelMap->GetExtent();
+  if (extent[0] != 0 || extent[1] != 63 || extent[2] != 0 || extent[3] != 39 ||
+      extent[4] != 0 || extent[5] != 29 ||
+      !isClose(readLabelMap->GetSpacing()[0], 0.5) ||
+      !isClose(readLabelMap->GetSpacing()[1], 0.75) ||
+      readLabelMap->GetNumberOfRuns() != labelMap->GetNumberOfRuns() ||
+      !isEqual(readLabelMap.GetPointer(), values))
+    {
+    std::cerr << __LINE__ << ": Wrong label map read" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testReadNRRD(const std::string& temporaryDirectory)
+{
+  // 5x4x3 short volume in RAS space, its gzip data split in two members in
+  // the middle of a slice
+  std::vector<short> values(5 * 4 * 3);
+  for (size_t n = 0; n < values.size(); ++n)
+    {
+    values[n] = static_cast<short>(n % 3 == 0 ? 0 : 300 + n % 5);
+    }
+  const size_t split = 27;
+  std::vector<unsigned char> data = gzipCompress(&values[0], split);
+  std::vector<unsigned char> secondMember =
+    gzipCompress(reinterpret_cast<const char*>(&values[0]) + split,
+                 values.size() * sizeof(short) - split);
+  data.insert(data.end(), secondMember.begin(), secondMember.end());
+
+  const std::string fileName = temporaryDirectory + "/vtkImageRunLengthLabelMapTest1RAS.nrrd";
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  file << "NRRD0004\n"
+       << "# comment\n"
+       << "type: short\n"
+       << "dimension: 3\n"
+       << "space: right-anterior-superior\n"
+       << "sizes: 5 4 3\n"
+       << "space directions: (1,0,0) (0,2,0) (0,0,3)\n"
+       << "kinds: domain domain domain\n"
+#ifdef VTK_WORDS_BIGENDIAN
+       << "endian: big\n"
+#else
+       << "endian: little\n"
+#endif
+       << "encoding: gzip\n"
+       << "space origin: (5,6,7)\n"
+       << "key:=value\n"
+       << "\n";
+  file.write(reinterpret_cast<const char*>(&data[0]), data.size());
+  file.close();
+
+  vtkNew<vtkImageRunLengthLabelMap> labelMap;
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  int success = labelMap->ReadNRRD(fileName.c_str(), ijkToRAS.GetPointer());
+  remove(fileName.c_str());
+  if (!success)
+    {
+    std::cerr << __LINE__ << ": ReadNRRD failed" << std::endl;
+    return false;
+    }
+  // RAS space is not flipped
+  if (ijkToRAS->GetElement(0, 0) != 1. || ijkToRAS->GetElement(1, 1) != 2. ||
+      ijkToRAS->GetElement(2, 2) != 3. || ijkToRAS->GetElement(0, 3) != 5. ||
+      ijkToRAS->GetElement(1, 3) != 6. || ijkToRAS->GetElement(2, 3) != 7. ||
+      labelMap->GetSpacing()[1] != 2. || labelMap->GetOrigin()[0] != 5.)
+    {
+    std::cerr << __LINE__ << ": Wrong IJK to RAS" << std::endl;
+    return false;
+    }
+  if (!isEqual(labelMap.GetPointer(), values))
+    {
+    std::cerr << __LINE__ << ": Wrong values" << std::endl;
+    return false;
+    }
+
+  // Detached data, after a line and a few bytes to skip
+  const std::string dataFileName =
+    temporaryDirectory + "/vtkImageRunLengthLabelMapTest1Detached.raw";
+  const std::string headerFileName =
+    temporaryDirectory + "/vtkImageRunLengthLabelMapTest1Detached.nhdr";
+  file.open(dataFileName.c_str(), std::ios::out | std::ios::binary);
+  file << "skipped line\n"
+       << "abcd";
+  file.write(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(short));
+  file.close();
+  file.open(headerFileName.c_str(), std::ios::out | std::ios::binary);
+  file << "NRRD0004\n"
+       << "type: short\n"
+       << "dimension: 3\n"
+       << "sizes: 5 4 3\n"
+#ifdef VTK_WORDS_BIGENDIAN
+       << "endian: big\n"
+#else
+       << "endian: little\n"
+#endif
+       << "encoding: raw\n"
+       << "line skip: 1\n"
+       << "byte skip: 4\n"
+       << "data file: vtkImageRunLengthLabelMapTest1Detached.raw\n";
+  file.close();
+  success = labelMap->ReadNRRD(headerFileName.c_str());
+  remove(headerFileName.c_str());
+  remove(dataFileName.c_str());
+  if (!success || !isEqual(labelMap.GetPointer(), values))
+    {
+    std::cerr << __LINE__ << ": ReadNRRD of detached data failed" << std::endl;
+    return false;
+    }
+
+  // Truncated data
+  file.open(fileName.c_str(), std::ios::out | std::ios::binary);
+  file << "NRRD0004\n"
+       << "type: short\n"
+       << "dimension: 3\n"
+       << "sizes: 5 4 3\n"
+       << "encoding: raw\n"
+       << "\n";
+  file.write(reinterpret_cast<const char*>(&values[0]), 50);
+  file.close();
+  success = labelMap->ReadNRRD(fileName.c_str());
+  remove(fileName.c_str());
+  if (success || labelMap->GetNumberOfRuns() != 0)
+    {
+    std::cerr << __LINE__ << ": ReadNRRD of truncated data succeeded" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testPaintLabelMap()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  vtkNew<vtkImageRunLengthLabelMap> labelMap;
+  labelMap->SetImage(image);
+
+  vtkNew<vtkMatrix4x4> ijkToWorld;
+  ijkToWorld->SetElement(0, 0, 0.5);
+  ijkToWorld->SetElement(1, 1, 0.75);
+  ijkToWorld->SetElement(2, 2, 2.);
+  ijkToWorld->SetElement(0, 3, 10.);
+  ijkToWorld->SetElement(1, 3, -20.);
+  ijkToWorld->SetElement(2, 3, 5.);
+  double brushCenterIJK[4] = {25., 22., 14., 1.};
+  double brushCenter[4];
+  ijkToWorld->MultiplyPoint(brushCenterIJK, brushCenter);
+
+  // Oblique paint region spanning the slices 12 to 16
+  vtkNew<vtkImageSlicePaint> painter;
+  painter->SetBackgroundImage(image);
+  painter->SetBackgroundIJKToWorld(ijkToWorld.GetPointer());
+  painter->SetWorkingIJKToWorld(ijkToWorld.GetPointer());
+  painter->SetTopLeft(5, 5, 12);
+  painter->SetTopRight(45, 5, 12);
+  painter->SetBottomLeft(5, 40, 16);
+  painter->SetBottomRight(45, 40, 16);
+  painter->SetBrushCenter(brushCenter);
+  painter->SetBrushRadius(8.);
+  painter->SetPaintLabel(5);
+  painter->SetPaintOver(1);
+
+  painter->SetWorkingImage(image);
+  painter->Paint();
+  painter->SetWorkingImage(0);
+  std::vector<short> values = scalarValues(image);
+  if (std::count(values.begin(), values.end(), 5) == 0)
+    {
+    std::cerr << __LINE__ << ": Nothing painted" << std::endl;
+    return false;
+    }
+
+  painter->SetWorkingLabelMap(labelMap.GetPointer());
+  painter->Paint();
+  if (painter->GetWorkingImage() != 0 || !isEqual(labelMap.GetPointer(), values))
+    {
+    std::cerr << __LINE__ << ": Painting the label map failed" << std::endl;
+    return false;
+    }
+
+  // Without paint over, only the background is painted
+  painter->SetPaintLabel(6);
+  painter->SetPaintOver(0);
+  painter->SetBrushRadius(12.);
+  painter->SetWorkingLabelMap(0);
+  painter->SetWorkingImage(image);
+  painter->Paint();
+  painter->SetWorkingImage(0);
+  values = scalarValues(image);
+  painter->SetWorkingLabelMap(labelMap.GetPointer());
+  painter->Paint();
+  if (!isEqual(labelMap.GetPointer(), values))
+    {
+    std::cerr << __LINE__ << ": Painting the label map without paint over failed"
+              << std::endl;
+    return false;
+    }
+
+  // A paint region outside of the label map leaves it unchanged
+  painter->SetTopLeft(5, 5, 40);
+  painter->SetTopRight(45, 5, 40);
+  painter->SetBottomLeft(5, 40, 42);
+  painter->SetBottomRight(45, 40, 42);
+  painter->Paint();
+  painter->SetWorkingLabelMap(0);
+  if (!isEqual(labelMap.GetPointer(), values))
+    {
+    std::cerr << __LINE__ << ": Painting outside of the label map changed it"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
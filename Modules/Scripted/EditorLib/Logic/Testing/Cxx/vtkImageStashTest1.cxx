@@ -0,0 +1,318 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// EditorLib includes
+#include "vtkImageStash.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+bool testRoundTrip();
+bool testSharedBricks();
+bool testModifiedExtent();
+bool testGeometryChange();
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkImageStashTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  if (!testRoundTrip())
+    {
+    std::cerr << "testRoundTrip call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testSharedBricks())
+    {
+    std::cerr << "testSharedBricks call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testModifiedExtent())
+    {
+    std::cerr << "testModifiedExtent call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!testGeometryChange())
+    {
+    std::cerr << "testGeometryChange call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// 100x80x50 label map (4x3x2 bricks of 32^3 voxels) with a few labelled blocks
+vtkSmartPointer<vtkImageData> createLabelMap()
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(10, 109, 0, 79, -5, 44);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  short* scalars = static_cast<short*>(image->GetScalarPointer());
+  const vtkIdType numberOfVoxels = image->GetNumberOfPoints();
+  for (vtkIdType n = 0; n < numberOfVoxels; ++n)
+    {
+    scalars[n] = static_cast<short>((n / 1000) % 7 == 0 ? 1 : 0);
+    }
+  return image;
+}
+
+//---------------------------------------------------------------------------
+std::vector<short> scalarValues(vtkImageData* image)
+{
+  const short* scalars = static_cast<short*>(image->GetScalarPointer());
+  return std::vector<short>(scalars, scalars + image->GetNumberOfPoints());
+}
+
+//---------------------------------------------------------------------------
+bool isEqual(vtkImageData* image, const std::vector<short>& values)
+{
+  return image->GetPointData()->GetScalars() &&
+    image->GetNumberOfPoints() == static_cast<vtkIdType>(values.size()) &&
+    std::equal(values.begin(), values.end(),
+               static_cast<short*>(image->GetScalarPointer()));
+}
+
+//---------------------------------------------------------------------------
+void setLabel(vtkImageData* image, int i, int j, int k, short label)
+{
+  *static_cast<short*>(image->GetScalarPointer(i, j, k)) = label;
+  image->Modified();
+}
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkImageStash> stash(vtkImageData* image,
+                                     vtkImageStash* previousStash = 0)
+{
+  vtkSmartPointer<vtkImageStash> newStash = vtkSmartPointer<vtkImageStash>::New();
+  newStash->SetStashImage(image);
+  newStash->KeepScalarsOn();
+  newStash->SetPreviousStash(previousStash);
+  newStash->Stash();
+  newStash->SetPreviousStash(0);
+  newStash->SetStashImage(0);
+  return newStash;
+}
+
+//---------------------------------------------------------------------------
+bool restore(vtkImageStash* stashToRestore, vtkImageData* image,
+             vtkImageStash* currentStash, const std::vector<short>& expected)
+{
+  stashToRestore->SetStashImage(image);
+  stashToRestore->Unstash(currentStash);
+  stashToRestore->SetStashImage(0);
+  return isEqual(image, expected);
+}
+
+//---------------------------------------------------------------------------
+bool testRoundTrip()
+{
+  // Stash a copy and strip its scalars, as the stash did originally
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  std::vector<short> values = scalarValues(image);
+
+  vtkNew<vtkImageStash> imageStash;
+  imageStash->SetStashImage(image);
+  imageStash->SetBrickSize(16);
+  imageStash->Stash();
+  if (image->GetPointData()->GetScalars()->GetNumberOfTuples() != 0 ||
+      imageStash->GetNumberOfBricks() != 7 * 5 * 4 ||
+      imageStash->GetNumberOfCompressedBricks() != imageStash->GetNumberOfBricks() ||
+      imageStash->GetStashedSize() <= 0 ||
+      imageStash->GetStashedSize() >= static_cast<vtkTypeInt64>(values.size() * sizeof(short)))
+    {
+    std::cerr << __LINE__ << ": Stash failed: "
+              << imageStash->GetNumberOfBricks() << " bricks, "
+              << imageStash->GetStashedSize() << " bytes" << std::endl;
+    return false;
+    }
+  imageStash->Unstash();
+  if (!isEqual(image, values))
+    {
+    std::cerr << __LINE__ << ": Unstash failed" << std::endl;
+    return false;
+    }
+
+  // Threaded stash
+  imageStash->ThreadedStash();
+  while (imageStash->GetStashing())
+    {
+    }
+  imageStash->Unstash();
+  if (!isEqual(image, values))
+    {
+    std::cerr << __LINE__ << ": Unstash of a threaded stash failed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testSharedBricks()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  std::vector<short> values0 = scalarValues(image);
+  vtkSmartPointer<vtkImageStash> stash0 = stash(image);
+
+  // A stroke in one brick
+  setLabel(image, 50, 40, 20, 5);
+  setLabel(image, 51, 40, 20, 5);
+  std::vector<short> values1 = scalarValues(image);
+  vtkSmartPointer<vtkImageStash> stash1 = stash(image, stash0);
+  if (stash1->GetNumberOfCompressedBricks() != 1)
+    {
+    std::cerr << __LINE__ << ": Wrong number of compressed bricks: "
+              << stash1->GetNumberOfCompressedBricks() << std::endl;
+    return false;
+    }
+
+  // Moving labels without changing the adler32 checksum of the brick: the
+  // byte sum and the position weighted byte sum are kept.
+  setLabel(image, 20, 70, 40, 3);
+  setLabel(image, 30, 70, 40, 3);
+  std::vector<short> values2 = scalarValues(image);
+  vtkSmartPointer<vtkImageStash> stash2 = stash(image, stash1);
+  setLabel(image, 20, 70, 40, 0);
+  setLabel(image, 30, 70, 40, 0);
+  setLabel(image, 21, 70, 40, 3);
+  setLabel(image, 29, 70, 40, 3);
+  std::vector<short> values3 = scalarValues(image);
+  vtkSmartPointer<vtkImageStash> stash3 = stash(image, stash2);
+  if (stash3->GetNumberOfCompressedBricks() != 1)
+    {
+    std::cerr << __LINE__ << ": Modified brick with the same adler32 not compressed"
+              << std::endl;
+    return false;
+    }
+
+  // Undo and redo, only decompressing the bricks that differ
+  if (!restore(stash2, image, stash3, values2) ||
+      !restore(stash1, image, stash2, values1) ||
+      !restore(stash0, image, stash1, values0) ||
+      !restore(stash3, image, stash0, values3) ||
+      !restore(stash1, image, 0, values1))
+    {
+    std::cerr << __LINE__ << ": Unstash failed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testModifiedExtent()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  std::vector<short> values0 = scalarValues(image);
+  vtkSmartPointer<vtkImageStash> stash0 = stash(image);
+
+  // The stroke spans two bricks along I (structured coordinates start at 10)
+  setLabel(image, 40, 10, 0, 2);
+  setLabel(image, 45, 10, 0, 2);
+  std::vector<short> values1 = scalarValues(image);
+  vtkSmartPointer<vtkImageStash> stash1 = vtkSmartPointer<vtkImageStash>::New();
+  stash1->SetStashImage(image);
+  stash1->KeepScalarsOn();
+  stash1->SetPreviousStash(stash0);
+  stash1->SetModifiedExtent(40, 45, 10, 10, 0, 0);
+  stash1->Stash();
+  stash1->SetPreviousStash(0);
+  stash1->SetStashImage(0);
+  if (stash1->GetNumberOfCompressedBricks() != 2)
+    {
+    std::cerr << __LINE__ << ": Wrong number of compressed bricks: "
+              << stash1->GetNumberOfCompressedBricks() << std::endl;
+    return false;
+    }
+  if (!restore(stash0, image, stash1, values0))
+    {
+    std::cerr << __LINE__ << ": Unstash failed" << std::endl;
+    return false;
+    }
+  // Only the two bricks of the stroke are decompressed
+  int* extent = stash0->GetUnstashedExtent();
+  if (extent[0] != 10 || extent[1] != 73 || extent[2] != 0 || extent[3] != 31 ||
+      extent[4] != -5 || extent[5] != 26)
+    {
+    std::cerr << __LINE__ << ": Wrong unstashed extent: " << extent[0] << " "
+              << extent[1] << " " << extent[2] << " " << extent[3] << " "
+              << extent[4] << " " << extent[5] << std::endl;
+    return false;
+    }
+  if (!restore(stash1, image, stash0, values1))
+    {
+    std::cerr << __LINE__ << ": Unstash failed" << std::endl;
+    return false;
+    }
+  // Nothing to decompress when the bricks are all shared
+  vtkSmartPointer<vtkImageStash> stash2 = stash(image, stash1);
+  extent = stash2->GetUnstashedExtent();
+  if (stash2->GetNumberOfCompressedBricks() != 0 ||
+      !restore(stash2, image, stash1, values1) || extent[0] <= extent[1])
+    {
+    std::cerr << __LINE__ << ": Unstash of the current state failed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool testGeometryChange()
+{
+  vtkSmartPointer<vtkImageData> image = createLabelMap();
+  std::vector<short> values = scalarValues(image);
+  vtkSmartPointer<vtkImageStash> stash0 = stash(image);
+
+  // A previous stash of another geometry is not used
+  vtkNew<vtkImageData> otherImage;
+  otherImage->SetExtent(0, 63, 0, 63, 0, 63);
+  otherImage->SetScalarTypeToShort();
+  otherImage->SetNumberOfScalarComponents(1);
+  otherImage->AllocateScalars();
+  std::fill(static_cast<short*>(otherImage->GetScalarPointer()),
+            static_cast<short*>(otherImage->GetScalarPointer()) + 64 * 64 * 64, 0);
+  vtkSmartPointer<vtkImageStash> stash1 = stash(otherImage.GetPointer(), stash0);
+  if (stash1->GetNumberOfCompressedBricks() != stash1->GetNumberOfBricks())
+    {
+    std::cerr << __LINE__ << ": Bricks shared with a stash of another geometry"
+              << std::endl;
+    return false;
+    }
+
+  // Unstashing into an image of another geometry restores the stashed
+  // geometry, the current stash is ignored.
+  if (!restore(stash0, otherImage.GetPointer(), stash1, values))
+    {
+    std::cerr << __LINE__ << ": Unstash failed" << std::endl;
+    return false;
+    }
+  int extent[6];
+  otherImage->GetExtent(extent);
+  if (extent[0] != 10 || extent[1] != 109 || extent[4] != -5 || extent[5] != 44)
+    {
+    std::cerr << __LINE__ << ": Wrong extent after unstash" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
@@ -0,0 +1,626 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+#include "vtkImageFastMarching.h"
+#include "vtkImageFastMarchingHeap.h"
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+/// Status of the voxels during the expansion
+enum
+{
+  FAR_VOXEL = 0,
+  TRIAL_VOXEL,
+  KNOWN_VOXEL,
+  BLOCKED_VOXEL
+};
+
+/// Smallest speed, relative to the speed of the voxels matching perfectly
+/// the statistics of the seeds.
+const double MINIMUM_SPEED = 1e-6;
+
+/// Number of progress events invoked during March()
+const int GRANULARITY_PROGRESS = 20;
+
+//----------------------------------------------------------------------------
+/// Median and inhomogeneity (difference between the 22nd and 6th of the 27
+/// sorted values) of the 3x3x3 neighborhood of a voxel.
+template <class T>
+inline void vtkImageFastMarchingNeighborhoodFeatures(
+  const T* voxel, const vtkIdType offsets[27], double& median, double& inhomogeneity)
+{
+  double values[27];
+  for (int n = 0; n < 27; ++n)
+    {
+    values[n] = static_cast<double>(voxel[offsets[n]]);
+    }
+  std::sort(values, values + 27);
+  median = values[13];
+  inhomogeneity = values[21] - values[5];
+}
+
+//----------------------------------------------------------------------------
+struct vtkImageFastMarchingStatistics
+{
+  double MedianMean;
+  double MedianVariance;
+  double InhomogeneityMean;
+  double InhomogeneityVariance;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageFastMarchingSeedStatistics(
+  const T* input, const std::vector<vtkIdType>& seeds,
+  const vtkIdType offsets[27], double minimumVariance,
+  vtkImageFastMarchingStatistics& stats)
+{
+  double sumMedian = 0., sumMedian2 = 0.;
+  double sumInhomo = 0., sumInhomo2 = 0.;
+  for (std::vector<vtkIdType>::const_iterator it = seeds.begin();
+       it != seeds.end(); ++it)
+    {
+    double median, inhomogeneity;
+    vtkImageFastMarchingNeighborhoodFeatures(input + *it, offsets, median, inhomogeneity);
+    sumMedian += median;
+    sumMedian2 += median * median;
+    sumInhomo += inhomogeneity;
+    sumInhomo2 += inhomogeneity * inhomogeneity;
+    }
+  double count = static_cast<double>(seeds.size());
+  stats.MedianMean = sumMedian / count;
+  stats.MedianVariance = std::max(
+    sumMedian2 / count - stats.MedianMean * stats.MedianMean, minimumVariance);
+  stats.InhomogeneityMean = sumInhomo / count;
+  stats.InhomogeneityVariance = std::max(
+    sumInhomo2 / count - stats.InhomogeneityMean * stats.InhomogeneityMean, minimumVariance);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageFastMarchingComputeSpeed(
+  const T* input, float* speed, const int dims[3], int zMin, int zMax,
+  const vtkIdType offsets[27], const vtkImageFastMarchingStatistics& stats,
+  double powerSpeed)
+{
+  const vtkIdType dimXY = static_cast<vtkIdType>(dims[0]) * dims[1];
+  for (int k = zMin; k <= zMax; ++k)
+    {
+    for (int j = 0; j < dims[1]; ++j)
+      {
+      vtkIdType index = k * dimXY + static_cast<vtkIdType>(j) * dims[0];
+      for (int i = 0; i < dims[0]; ++i, ++index)
+        {
+        if (i == 0 || j == 0 || k == 0 ||
+            i == dims[0] - 1 || j == dims[1] - 1 || k == dims[2] - 1)
+          {
+          // border voxels are never reached
+          speed[index] = 0.f;
+          continue;
+          }
+        double median, inhomogeneity;
+        vtkImageFastMarchingNeighborhoodFeatures(input + index, offsets, median, inhomogeneity);
+        double dm = median - stats.MedianMean;
+        double dh = inhomogeneity - stats.InhomogeneityMean;
+        double pI = exp(-dm * dm / (2. * stats.MedianVariance));
+        double pH = exp(-dh * dh / (2. * stats.InhomogeneityVariance));
+        double s = pow(pI * pI * pH, powerSpeed);
+        speed[index] = static_cast<float>(s > MINIMUM_SPEED ? s : MINIMUM_SPEED);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Data shared by the threads computing the speed image
+struct vtkImageFastMarchingSpeedThreadData
+{
+  vtkImageData* Input;
+  float* Speed;
+  const int* Dimensions;
+  const vtkIdType* NeighborhoodOffsets;
+  vtkImageFastMarchingStatistics Statistics;
+  double PowerSpeed;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkImageFastMarchingSpeedThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkImageFastMarchingSpeedThreadData* data =
+    static_cast<vtkImageFastMarchingSpeedThreadData*>(info->UserData);
+
+  // split the slices between the threads
+  int numberOfSlices = data->Dimensions[2];
+  int zMin = info->ThreadID * numberOfSlices / info->NumberOfThreads;
+  int zMax = (info->ThreadID + 1) * numberOfSlices / info->NumberOfThreads - 1;
+  if (zMin > zMax)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+  void* inputPtr = data->Input->GetScalarPointer();
+  switch (data->Input->GetScalarType())
+    {
+    vtkTemplateMacro(vtkImageFastMarchingComputeSpeed(
+      static_cast<VTK_TT*>(inputPtr), data->Speed, data->Dimensions,
+      zMin, zMax, data->NeighborhoodOffsets, data->Statistics,
+      data->PowerSpeed));
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+vtkIdType vtkImageFastMarchingInitializeStatus(
+  const T* labels, int label, const int dims[3], unsigned char* status,
+  std::vector<vtkIdType>& seeds)
+{
+  vtkIdType index = 0;
+  for (int k = 0; k < dims[2]; ++k)
+    {
+    for (int j = 0; j < dims[1]; ++j)
+      {
+      for (int i = 0; i < dims[0]; ++i, ++index)
+        {
+        bool border = (i == 0 || j == 0 || k == 0 ||
+          i == dims[0] - 1 || j == dims[1] - 1 || k == dims[2] - 1);
+        if (border)
+          {
+          // border voxels are neither reached nor used as seeds
+          status[index] = BLOCKED_VOXEL;
+          }
+        else if (static_cast<int>(labels[index]) == label)
+          {
+          status[index] = KNOWN_VOXEL;
+          seeds.push_back(index);
+          }
+        else if (labels[index] != 0)
+          {
+          status[index] = BLOCKED_VOXEL;
+          }
+        else
+          {
+          status[index] = FAR_VOXEL;
+          }
+        }
+      }
+    }
+  return static_cast<vtkIdType>(seeds.size());
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageFastMarchingShow(
+  T* labels, int label, const std::vector<vtkIdType>& marched,
+  vtkIdType oldCount, vtkIdType newCount)
+{
+  for (vtkIdType n = oldCount; n < newCount; ++n)
+    {
+    labels[marched[n]] = static_cast<T>(label);
+    }
+  for (vtkIdType n = newCount; n < oldCount; ++n)
+    {
+    labels[marched[n]] = static_cast<T>(0);
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkImageFastMarching::vtkInternal
+{
+public:
+  vtkInternal();
+
+  /// Solve the Eikonal equation at \a index using the reached neighbors.
+  float ArrivalTime(vtkIdType index, float speed)const;
+
+  int Dimensions[3];
+  /// Offsets of the 6 face neighbors, ordered -x, +x, -y, +y, -z, +z
+  vtkIdType FaceOffsets[6];
+  /// Offsets of the 27 voxels of the 3x3x3 neighborhood
+  vtkIdType NeighborhoodOffsets[27];
+  double InvSpacing2[3];
+
+  std::vector<float> Arrival;
+  std::vector<unsigned char> Status;
+  vtkImageFastMarchingHeap Front;
+
+  /// Voxels in their order of arrival
+  std::vector<vtkIdType> Marched;
+  /// Number of voxels of Marched currently labeled
+  vtkIdType Shown;
+  bool Initialized;
+
+  vtkImageFastMarchingStatistics Statistics;
+  float* Speed;
+};
+
+//----------------------------------------------------------------------------
+vtkImageFastMarching::vtkInternal::vtkInternal()
+{
+  this->Shown = 0;
+  this->Initialized = false;
+  this->Speed = 0;
+}
+
+//----------------------------------------------------------------------------
+float vtkImageFastMarching::vtkInternal::ArrivalTime(vtkIdType index, float speed)const
+{
+  // smallest reached neighbor along each axis
+  double t[3];
+  int axes[3] = {0, 1, 2};
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    t[axis] = VTK_DOUBLE_MAX;
+    for (int side = 0; side < 2; ++side)
+      {
+      vtkIdType neighbor = index + this->FaceOffsets[2 * axis + side];
+      if (this->Status[neighbor] == KNOWN_VOXEL)
+        {
+        t[axis] = std::min(t[axis], static_cast<double>(this->Arrival[neighbor]));
+        }
+      }
+    }
+  // sort axes by increasing neighbor time
+  for (int a = 0; a < 2; ++a)
+    {
+    for (int b = a + 1; b < 3; ++b)
+      {
+      if (t[axes[b]] < t[axes[a]])
+        {
+        std::swap(axes[a], axes[b]);
+        }
+      }
+    }
+  // Solve sum_axis ((T - t_axis) / h_axis)^2 = 1 / speed^2 adding the axes
+  // one at a time while the solution is larger than the next neighbor time.
+  double invSpeed2 = 1. / (static_cast<double>(speed) * speed);
+  double A = 0., B = 0., C = -invSpeed2;
+  double solution = VTK_DOUBLE_MAX;
+  for (int n = 0; n < 3; ++n)
+    {
+    int axis = axes[n];
+    if (t[axis] >= VTK_DOUBLE_MAX || solution <= t[axis])
+      {
+      break;
+      }
+    A += this->InvSpacing2[axis];
+    B += -2. * t[axis] * this->InvSpacing2[axis];
+    C += t[axis] * t[axis] * this->InvSpacing2[axis];
+    double discriminant = B * B - 4. * A * C;
+    if (discriminant < 0.)
+      {
+      break;
+      }
+    solution = (-B + sqrt(discriminant)) / (2. * A);
+    }
+  return static_cast<float>(solution);
+}
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkImageFastMarching, "$Revision$");
+vtkStandardNewMacro(vtkImageFastMarching);
+
+//----------------------------------------------------------------------------
+vtkImageFastMarching::vtkImageFastMarching()
+{
+  this->InputImage = NULL;
+  this->LabelImage = NULL;
+  this->SpeedImage = NULL;
+  this->MultiThreader = vtkMultiThreader::New();
+  this->Label = 1;
+  this->PowerSpeed = 1.;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkImageFastMarching::~vtkImageFastMarching()
+{
+  this->SetInputImage(NULL);
+  this->SetLabelImage(NULL);
+  if (this->SpeedImage)
+    {
+    this->SpeedImage->Delete();
+    }
+  this->MultiThreader->Delete();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFastMarching::SetNumberOfThreads(int numberOfThreads)
+{
+  this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageFastMarching::GetNumberOfThreads()
+{
+  return this->MultiThreader->GetNumberOfThreads();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageFastMarching::Initialize()
+{
+  vtkInternal* internal = this->Internal;
+  internal->Initialized = false;
+  internal->Marched.clear();
+  internal->Shown = 0;
+
+  if (!this->InputImage || !this->LabelImage)
+    {
+    vtkErrorMacro("Initialize: input and label images must be set");
+    return 0;
+    }
+  if (this->InputImage->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("Initialize: input image has "
+                  << this->InputImage->GetNumberOfScalarComponents()
+                  << " instead of 1 scalar component.");
+    return 0;
+    }
+  int* dims = this->InputImage->GetDimensions();
+  int* labelDims = this->LabelImage->GetDimensions();
+  if (dims[0] != labelDims[0] || dims[1] != labelDims[1] || dims[2] != labelDims[2])
+    {
+    vtkErrorMacro("Initialize: input and label images have different dimensions");
+    return 0;
+    }
+  if (dims[0] < 3 || dims[1] < 3 || dims[2] < 3)
+    {
+    vtkErrorMacro("Initialize: image is too small, at least 3 voxels are needed along each axis");
+    return 0;
+    }
+
+  // Geometry
+  const vtkIdType dimX = dims[0];
+  const vtkIdType dimXY = dimX * dims[1];
+  const vtkIdType numberOfVoxels = dimXY * dims[2];
+  double* spacing = this->InputImage->GetSpacing();
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    internal->Dimensions[axis] = dims[axis];
+    internal->InvSpacing2[axis] = 1. / (spacing[axis] * spacing[axis]);
+    }
+  internal->FaceOffsets[0] = -1;
+  internal->FaceOffsets[1] = 1;
+  internal->FaceOffsets[2] = -dimX;
+  internal->FaceOffsets[3] = dimX;
+  internal->FaceOffsets[4] = -dimXY;
+  internal->FaceOffsets[5] = dimXY;
+  int n = 0;
+  for (int k = -1; k <= 1; ++k)
+    {
+    for (int j = -1; j <= 1; ++j)
+      {
+      for (int i = -1; i <= 1; ++i)
+        {
+        internal->NeighborhoodOffsets[n++] = i + j * dimX + k * dimXY;
+        }
+      }
+    }
+
+  // Seeds
+  std::vector<vtkIdType> seeds;
+  internal->Status.resize(numberOfVoxels);
+  void* labelPtr = this->LabelImage->GetScalarPointer();
+  switch (this->LabelImage->GetScalarType())
+    {
+    vtkTemplateMacro(vtkImageFastMarchingInitializeStatus(
+      static_cast<VTK_TT*>(labelPtr), this->Label, dims, &internal->Status[0], seeds));
+    default:
+      vtkErrorMacro("Initialize: unsupported label image scalar type");
+      return 0;
+    }
+  if (seeds.empty())
+    {
+    vtkWarningMacro("Initialize: no seed with label " << this->Label);
+    return 0;
+    }
+
+  // Statistics of the seeds
+  double range[2];
+  this->InputImage->GetScalarRange(range);
+  double minimumVariance = 1e-3 * (range[1] - range[0]);
+  minimumVariance = std::max(minimumVariance * minimumVariance, 1e-12);
+  void* inputPtr = this->InputImage->GetScalarPointer();
+  switch (this->InputImage->GetScalarType())
+    {
+    vtkTemplateMacro(vtkImageFastMarchingSeedStatistics(
+      static_cast<VTK_TT*>(inputPtr), seeds, internal->NeighborhoodOffsets,
+      minimumVariance, internal->Statistics));
+    default:
+      vtkErrorMacro("Initialize: unsupported input image scalar type");
+      return 0;
+    }
+
+  // Speed image, computed in parallel
+  if (!this->SpeedImage)
+    {
+    this->SpeedImage = vtkImageData::New();
+    }
+  this->SpeedImage->SetOrigin(this->InputImage->GetOrigin());
+  this->SpeedImage->SetSpacing(this->InputImage->GetSpacing());
+  this->SpeedImage->SetExtent(this->InputImage->GetExtent());
+  this->SpeedImage->SetWholeExtent(this->InputImage->GetExtent());
+  this->SpeedImage->SetScalarTypeToFloat();
+  this->SpeedImage->SetNumberOfScalarComponents(1);
+  this->SpeedImage->AllocateScalars();
+  internal->Speed = static_cast<float*>(this->SpeedImage->GetScalarPointer());
+  vtkImageFastMarchingSpeedThreadData threadData;
+  threadData.Input = this->InputImage;
+  threadData.Speed = internal->Speed;
+  threadData.Dimensions = internal->Dimensions;
+  threadData.NeighborhoodOffsets = internal->NeighborhoodOffsets;
+  threadData.Statistics = internal->Statistics;
+  threadData.PowerSpeed = this->PowerSpeed;
+  this->MultiThreader->SetSingleMethod(vtkImageFastMarchingSpeedThread, &threadData);
+  this->MultiThreader->SingleMethodExecute();
+
+  // Initial front: neighbors of the seeds
+  internal->Arrival.assign(numberOfVoxels, VTK_FLOAT_MAX);
+  internal->Front.Initialize(numberOfVoxels);
+  for (std::vector<vtkIdType>::const_iterator it = seeds.begin(); it != seeds.end(); ++it)
+    {
+    internal->Arrival[*it] = 0.f;
+    }
+  for (std::vector<vtkIdType>::const_iterator it = seeds.begin(); it != seeds.end(); ++it)
+    {
+    for (int face = 0; face < 6; ++face)
+      {
+      vtkIdType neighbor = *it + internal->FaceOffsets[face];
+      if (internal->Status[neighbor] == FAR_VOXEL)
+        {
+        internal->Status[neighbor] = TRIAL_VOXEL;
+        float t = internal->ArrivalTime(neighbor, internal->Speed[neighbor]);
+        internal->Arrival[neighbor] = t;
+        internal->Front.Push(neighbor, t);
+        }
+      }
+    }
+
+  internal->Initialized = true;
+  return static_cast<int>(seeds.size());
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageFastMarching::March(vtkIdType numberOfPoints)
+{
+  vtkInternal* internal = this->Internal;
+  if (!internal->Initialized)
+    {
+    vtkErrorMacro("March: Initialize() must be called first");
+    return 0;
+    }
+  vtkIdType alreadyMarched = static_cast<vtkIdType>(internal->Marched.size());
+  vtkIdType toMarch = numberOfPoints - alreadyMarched;
+  if (toMarch <= 0)
+    {
+    return alreadyMarched;
+    }
+  internal->Marched.reserve(numberOfPoints);
+  vtkIdType progressStep = std::max(toMarch / GRANULARITY_PROGRESS, static_cast<vtkIdType>(1));
+  for (vtkIdType count = 0; count < toMarch; ++count)
+    {
+    if (internal->Front.Empty())
+      {
+      vtkDebugMacro("March: nowhere else to go. End of evolution.");
+      break;
+      }
+    if (count % progressStep == 0)
+      {
+      double progress = static_cast<double>(count) / toMarch;
+      this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+      }
+    float t;
+    vtkIdType index = internal->Front.Pop(t);
+    internal->Status[index] = KNOWN_VOXEL;
+    internal->Arrival[index] = t;
+    internal->Marched.push_back(index);
+
+    for (int face = 0; face < 6; ++face)
+      {
+      vtkIdType neighbor = index + internal->FaceOffsets[face];
+      unsigned char status = internal->Status[neighbor];
+      if (status != FAR_VOXEL && status != TRIAL_VOXEL)
+        {
+        continue;
+        }
+      float neighborT = internal->ArrivalTime(neighbor, internal->Speed[neighbor]);
+      if (status == FAR_VOXEL)
+        {
+        internal->Status[neighbor] = TRIAL_VOXEL;
+        internal->Arrival[neighbor] = neighborT;
+        internal->Front.Push(neighbor, neighborT);
+        }
+      else if (neighborT < internal->Arrival[neighbor])
+        {
+        internal->Arrival[neighbor] = neighborT;
+        internal->Front.DecreaseKey(neighbor, neighborT);
+        }
+      }
+    }
+  double progress = 1.;
+  this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+  return static_cast<vtkIdType>(internal->Marched.size());
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageFastMarching::GetNumberOfMarchedPoints()
+{
+  return static_cast<vtkIdType>(this->Internal->Marched.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFastMarching::Show(double fraction)
+{
+  vtkInternal* internal = this->Internal;
+  if (!internal->Initialized || !this->LabelImage)
+    {
+    return;
+    }
+  if (fraction < 0. || fraction > 1.)
+    {
+    vtkErrorMacro("Show: fraction " << fraction << " is not in [0, 1]");
+    return;
+    }
+  vtkIdType count = static_cast<vtkIdType>(
+    fraction * static_cast<double>(internal->Marched.size()) + 0.5);
+  if (count == internal->Shown)
+    {
+    return;
+    }
+  void* labelPtr = this->LabelImage->GetScalarPointer();
+  switch (this->LabelImage->GetScalarType())
+    {
+    vtkTemplateMacro(vtkImageFastMarchingShow(
+      static_cast<VTK_TT*>(labelPtr), this->Label, internal->Marched,
+      internal->Shown, count));
+    }
+  internal->Shown = count;
+  this->LabelImage->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkImageFastMarching::GetShownArrivalTime()
+{
+  vtkInternal* internal = this->Internal;
+  if (internal->Shown == 0)
+    {
+    return 0.;
+    }
+  return internal->Arrival[internal->Marched[internal->Shown - 1]];
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFastMarching::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "InputImage: " << this->InputImage << "\n";
+  os << indent << "LabelImage: " << this->LabelImage << "\n";
+  os << indent << "SpeedImage: " << this->SpeedImage << "\n";
+  os << indent << "Label: " << this->Label << "\n";
+  os << indent << "PowerSpeed: " << this->PowerSpeed << "\n";
+  os << indent << "NumberOfThreads: " << this->MultiThreader->GetNumberOfThreads() << "\n";
+  os << indent << "NumberOfMarchedPoints: " << this->Internal->Marched.size() << "\n";
+  os << indent << "NumberOfShownPoints: " << this->Internal->Shown << "\n";
+}
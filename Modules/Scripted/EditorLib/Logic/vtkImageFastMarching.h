@@ -0,0 +1,128 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkImageFastMarching - Fast marching region growing on a label map
+///
+/// Rewrite of vtkPichonFastMarching:
+///  - the front is stored in an indexed binary heap supporting decrease-key
+///    (see vtkImageFastMarchingHeap), no stale entries are left in the heap
+///  - the speed image is precomputed once in Initialize(), in parallel, from
+///    the median and inhomogeneity (inter-quartile range) of the 3x3x3
+///    neighborhood of each voxel compared to the statistics of the seeds.
+///    Unlike vtkPichonFastMarching, the statistics are not updated during
+///    the expansion.
+///  - the input image can be of any scalar type.
+///  - the expansion is incremental: March() can be called again to extend the
+///    expansion and Show() only updates the voxels whose visibility changed,
+///    so the marcher slider can move back and forth without recomputation.
+///
+/// Usage:
+///   fm->SetInputImage(backgroundImage);
+///   fm->SetLabelImage(labelImage); // seeds are voxels with value Label
+///   fm->SetLabel(label);
+///   fm->Initialize();
+///   fm->March(numberOfPoints);
+///   fm->Show(1.0); // labelImage is modified in place
+///
+/// Voxels of the label image that have a non zero value different from
+/// Label are never overwritten.
+
+#ifndef __vtkImageFastMarching_h
+#define __vtkImageFastMarching_h
+
+#include "vtkSlicerEditorLibModuleLogicExport.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObject.h>
+
+class vtkMultiThreader;
+
+class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageFastMarching : public vtkObject
+{
+public:
+  static vtkImageFastMarching *New();
+  vtkTypeRevisionMacro(vtkImageFastMarching,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Intensity image driving the expansion. Single component, any scalar type.
+  vtkSetObjectMacro(InputImage, vtkImageData);
+  vtkGetObjectMacro(InputImage, vtkImageData);
+
+  ///
+  /// Label map containing the seeds. It is modified in place by Show().
+  /// Must have the same dimensions as InputImage.
+  vtkSetObjectMacro(LabelImage, vtkImageData);
+  vtkGetObjectMacro(LabelImage, vtkImageData);
+
+  ///
+  /// Label of the seeds and of the voxels added by the expansion.
+  vtkSetMacro(Label, int);
+  vtkGetMacro(Label, int);
+
+  ///
+  /// Exponent applied to the speed function. 1 by default.
+  vtkSetMacro(PowerSpeed, double);
+  vtkGetMacro(PowerSpeed, double);
+
+  ///
+  /// Number of threads used to compute the speed image.
+  /// Defaults to the number of processors.
+  void SetNumberOfThreads(int numberOfThreads);
+  int GetNumberOfThreads();
+
+  ///
+  /// Speed image computed by Initialize() (float, same geometry as InputImage).
+  vtkGetObjectMacro(SpeedImage, vtkImageData);
+
+  ///
+  /// Compute the speed image and put the neighbors of the seeds in the front.
+  /// Return the number of seed voxels, 0 if the expansion can't start.
+  int Initialize();
+
+  ///
+  /// Extend the expansion until \a numberOfPoints voxels have been reached
+  /// or the front is empty. Voxels reached by a previous call are kept.
+  /// Return the number of voxels reached so far.
+  vtkIdType March(vtkIdType numberOfPoints);
+
+  ///
+  /// Number of voxels reached by the expansion so far.
+  vtkIdType GetNumberOfMarchedPoints();
+
+  ///
+  /// Set Label on the first \a fraction (in [0,1]) of the reached voxels,
+  /// in order of arrival, and reset the others to 0. Only the voxels that
+  /// changed since the previous call are visited.
+  void Show(double fraction);
+
+  ///
+  /// Arrival time of the last shown voxel
+  double GetShownArrivalTime();
+
+protected:
+  vtkImageFastMarching();
+  ~vtkImageFastMarching();
+
+  vtkImageData* InputImage;
+  vtkImageData* LabelImage;
+  vtkImageData* SpeedImage;
+  vtkMultiThreader* MultiThreader;
+  int Label;
+  double PowerSpeed;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkImageFastMarching(const vtkImageFastMarching&);  /// Not implemented.
+  void operator=(const vtkImageFastMarching&);  /// Not implemented.
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkImageFastMarchingHeap - Indexed binary min-heap of voxels
+///
+/// Min-heap of (arrival time, voxel index) pairs used by vtkImageFastMarching.
+/// The position of each voxel in the heap is tracked, so that the arrival
+/// time of a voxel already in the heap can be decreased (decrease-key) or the
+/// voxel removed without leaving stale entries in the heap.
+/// This class is not wrapped.
+
+#ifndef __vtkImageFastMarchingHeap_h
+#define __vtkImageFastMarchingHeap_h
+
+// VTK includes
+#include <vtkType.h>
+
+// STD includes
+#include <vector>
+
+class vtkImageFastMarchingHeap
+{
+public:
+  /// Empty the heap and allow voxel indices in [0, numberOfVoxels)
+  void Initialize(vtkIdType numberOfVoxels)
+    {
+    this->Entries.clear();
+    this->Positions.assign(numberOfVoxels, -1);
+    }
+
+  bool Empty()const
+    {
+    return this->Entries.empty();
+    }
+
+  vtkIdType Size()const
+    {
+    return static_cast<vtkIdType>(this->Entries.size());
+    }
+
+  bool Contains(vtkIdType voxel)const
+    {
+    return this->Positions[voxel] >= 0;
+    }
+
+  /// Arrival time of a voxel in the heap
+  float Key(vtkIdType voxel)const
+    {
+    return this->Entries[this->Positions[voxel]].Key;
+    }
+
+  /// Insert \a voxel or, if it already is in the heap, set its key to
+  /// \a key if \a key is smaller.
+  void Push(vtkIdType voxel, float key)
+    {
+    if (this->Contains(voxel))
+      {
+      this->DecreaseKey(voxel, key);
+      return;
+      }
+    Entry entry;
+    entry.Key = key;
+    entry.Voxel = voxel;
+    this->Entries.push_back(entry);
+    this->Positions[voxel] = static_cast<int>(this->Entries.size() - 1);
+    this->Up(this->Positions[voxel]);
+    }
+
+  /// Lower the key of a voxel in the heap. No-op if \a key is not smaller.
+  void DecreaseKey(vtkIdType voxel, float key)
+    {
+    int position = this->Positions[voxel];
+    if (key >= this->Entries[position].Key)
+      {
+      return;
+      }
+    this->Entries[position].Key = key;
+    this->Up(position);
+    }
+
+  /// Remove the voxel with the smallest key and return it.
+  vtkIdType Pop(float& key)
+    {
+    Entry top = this->Entries[0];
+    this->Positions[top.Voxel] = -1;
+    Entry last = this->Entries.back();
+    this->Entries.pop_back();
+    if (!this->Entries.empty())
+      {
+      this->Entries[0] = last;
+      this->Positions[last.Voxel] = 0;
+      this->Down(0);
+      }
+    key = top.Key;
+    return top.Voxel;
+    }
+
+  /// Remove \a voxel from the heap if it is in the heap.
+  void Remove(vtkIdType voxel)
+    {
+    int position = this->Positions[voxel];
+    if (position < 0)
+      {
+      return;
+      }
+    this->Positions[voxel] = -1;
+    Entry last = this->Entries.back();
+    this->Entries.pop_back();
+    if (position == static_cast<int>(this->Entries.size()))
+      {
+      return;
+      }
+    float removedKey = this->Entries[position].Key;
+    this->Entries[position] = last;
+    this->Positions[last.Voxel] = position;
+    if (last.Key < removedKey)
+      {
+      this->Up(position);
+      }
+    else
+      {
+      this->Down(position);
+      }
+    }
+
+protected:
+  struct Entry
+  {
+    float Key;
+    vtkIdType Voxel;
+  };
+
+  void Up(int position)
+    {
+    Entry entry = this->Entries[position];
+    while (position > 0)
+      {
+      int parent = (position - 1) / 2;
+      if (!(entry.Key < this->Entries[parent].Key))
+        {
+        break;
+        }
+      this->Entries[position] = this->Entries[parent];
+      this->Positions[this->Entries[position].Voxel] = position;
+      position = parent;
+      }
+    this->Entries[position] = entry;
+    this->Positions[entry.Voxel] = position;
+    }
+
+  void Down(int position)
+    {
+    const int size = static_cast<int>(this->Entries.size());
+    Entry entry = this->Entries[position];
+    for (int child = 2 * position + 1; child < size; child = 2 * position + 1)
+      {
+      if (child + 1 < size &&
+          this->Entries[child + 1].Key < this->Entries[child].Key)
+        {
+        ++child;
+        }
+      if (!(this->Entries[child].Key < entry.Key))
+        {
+        break;
+        }
+      this->Entries[position] = this->Entries[child];
+      this->Positions[this->Entries[position].Voxel] = position;
+      position = child;
+      }
+    this->Entries[position] = entry;
+    this->Positions[entry.Voxel] = position;
+    }
+
+  std::vector<Entry> Entries;
+  /// Position of each voxel in Entries, -1 if not in the heap.
+  /// int is enough as the heap only contains the front of the expansion.
+  std::vector<int> Positions;
+};
+
+#endif
@@ -0,0 +1,777 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+#include "vtkImageRunLengthLabelMap.h"
+
+// vtkTeem includes
+#include <vtkNRRDReader.h>
+#include <vtkNRRDWriter.h>
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+//----------------------------------------------------------------------------
+/// Run of voxels of the same label along a row of a slice. Row and Start
+/// are relative to the extent of the label map.
+struct vtkImageRunLengthLabelMapRun
+{
+  int Row;
+  int Start;
+  int Length;
+  double Value;
+
+  bool operator<(const vtkImageRunLengthLabelMapRun& other)const
+  {
+    return this->Row < other.Row ||
+      (this->Row == other.Row && this->Start < other.Start);
+  }
+};
+
+typedef std::vector<vtkImageRunLengthLabelMapRun> vtkImageRunLengthLabelMapRuns;
+
+//----------------------------------------------------------------------------
+/// Labels of a slice: either runs, or the voxels of the slice in the scalar
+/// type of the label map when the runs would take more memory
+struct vtkImageRunLengthLabelMapSlice
+{
+  vtkImageRunLengthLabelMapRuns Runs;
+  std::vector<unsigned char> Voxels;
+};
+
+//----------------------------------------------------------------------------
+class vtkImageRunLengthLabelMap::vtkInternal
+{
+public:
+  enum Mode
+  {
+    Encode,
+    Decode,
+    DecodeLabel
+  };
+
+  /// Encode the first component of a slice whose rows are contiguous and
+  /// as wide as the label map
+  void EncodeSlice(vtkImageRunLengthLabelMap* self, int k, const void* slice,
+                   int scalarType, int numberOfComponents);
+  /// Decode a slice into a buffer of the scalar type of the label map
+  void DecodeSlice(vtkImageRunLengthLabelMap* self, int k, void* slice);
+  /// Decode the voxels of a label of a slice, return their number
+  vtkIdType DecodeSliceLabel(vtkImageRunLengthLabelMap* self, int k, void* slice,
+                             double label);
+  /// Encode or decode the slices [kMin, kMax] of the image, return the
+  /// number of voxels of the label in DecodeLabel mode
+  vtkIdType ExecuteSlices(vtkImageRunLengthLabelMap* self, vtkImageData* image,
+                          int mode, double label, int kMin, int kMax);
+  /// Split the slices [kMin, kMax] of the image between the threads
+  vtkIdType ThreadedExecuteSlices(vtkImageRunLengthLabelMap* self, vtkImageData* image,
+                                  int mode, double label, int kMin, int kMax);
+  static VTK_THREAD_RETURN_TYPE ThreadedExecute(void *arg);
+
+  /// Data shared by the threads encoding or decoding the slices
+  struct ThreadData
+  {
+    vtkImageRunLengthLabelMap* Self;
+    vtkImageData* Image;
+    int Mode;
+    double Label;
+    int Slices[2];
+    /// Voxels of the label decoded by each thread
+    std::vector<vtkIdType> NumberOfVoxels;
+  };
+
+  /// Labels of each slice of the extent
+  std::vector<vtkImageRunLengthLabelMapSlice> Slices;
+};
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int ScalarSize(int scalarType)
+{
+  switch (scalarType)
+    {
+    vtkTemplateMacro(return sizeof(VTK_TT));
+    default:
+      break;
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+/// Encode the runs of a slice, give up as soon as there are more than
+/// maximumNumberOfRuns runs
+template <class T>
+bool EncodeRuns(const T* slice, int numberOfComponents, int dimX, int dimY,
+                size_t maximumNumberOfRuns, vtkImageRunLengthLabelMapRuns& runs)
+{
+  runs.clear();
+  const T* ptr = slice;
+  for (int j = 0; j < dimY; ++j)
+    {
+    int i = 0;
+    while (i < dimX)
+      {
+      const T value = ptr[i * numberOfComponents];
+      if (value == 0)
+        {
+        ++i;
+        continue;
+        }
+      if (runs.size() >= maximumNumberOfRuns)
+        {
+        runs.clear();
+        return false;
+        }
+      vtkImageRunLengthLabelMapRun run;
+      run.Row = j;
+      run.Start = i++;
+      while (i < dimX && ptr[i * numberOfComponents] == value)
+        {
+        ++i;
+        }
+      run.Length = i - run.Start;
+      run.Value = static_cast<double>(value);
+      runs.push_back(run);
+      }
+    ptr += static_cast<vtkIdType>(dimX) * numberOfComponents;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void CopyVoxels(const T* slice, int numberOfComponents, vtkIdType numberOfVoxels,
+                T* voxels)
+{
+  for (vtkIdType n = 0; n < numberOfVoxels; ++n)
+    {
+    voxels[n] = slice[n * numberOfComponents];
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void DecodeRuns(const vtkImageRunLengthLabelMapRuns& runs, T* slice, int dimX, int dimY)
+{
+  std::fill(slice, slice + static_cast<vtkIdType>(dimX) * dimY, static_cast<T>(0));
+  for (vtkImageRunLengthLabelMapRuns::const_iterator it = runs.begin();
+       it != runs.end(); ++it)
+    {
+    T* ptr = slice + static_cast<vtkIdType>(it->Row) * dimX + it->Start;
+    std::fill(ptr, ptr + it->Length, static_cast<T>(it->Value));
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+vtkIdType DecodeLabelRuns(const vtkImageRunLengthLabelMapRuns& runs, double label,
+                          T* slice, int dimX, int dimY)
+{
+  std::fill(slice, slice + static_cast<vtkIdType>(dimX) * dimY, static_cast<T>(0));
+  vtkIdType numberOfVoxels = 0;
+  for (vtkImageRunLengthLabelMapRuns::const_iterator it = runs.begin();
+       it != runs.end(); ++it)
+    {
+    if (it->Value != label)
+      {
+      continue;
+      }
+    T* ptr = slice + static_cast<vtkIdType>(it->Row) * dimX + it->Start;
+    std::fill(ptr, ptr + it->Length, static_cast<T>(it->Value));
+    numberOfVoxels += it->Length;
+    }
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+vtkIdType DecodeLabelVoxels(const T* voxels, double label, T* slice,
+                            vtkIdType numberOfVoxels)
+{
+  vtkIdType numberOfLabelVoxels = 0;
+  for (vtkIdType n = 0; n < numberOfVoxels; ++n)
+    {
+    // like the runs, the background is not a label
+    if (label != 0. && static_cast<double>(voxels[n]) == label)
+      {
+      slice[n] = voxels[n];
+      ++numberOfLabelVoxels;
+      }
+    else
+      {
+      slice[n] = 0;
+      }
+    }
+  return numberOfLabelVoxels;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+double VoxelValue(const T* voxels, vtkIdType index)
+{
+  return static_cast<double>(voxels[index]);
+}
+
+//----------------------------------------------------------------------------
+/// Record the errors reported by the NRRD reader and writer, they don't
+/// all show up in their status
+class ErrorObserver : public vtkCommand
+{
+public:
+  static ErrorObserver* New() { return new ErrorObserver; }
+  virtual void Execute(vtkObject*, unsigned long, void*)
+  {
+    this->Error = true;
+  }
+  bool Error;
+protected:
+  ErrorObserver() : Error(false) {}
+};
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::vtkInternal::EncodeSlice(
+  vtkImageRunLengthLabelMap* self, int k, const void* slice,
+  int scalarType, int numberOfComponents)
+{
+  int dimX = self->Extent[1] - self->Extent[0] + 1;
+  int dimY = self->Extent[3] - self->Extent[2] + 1;
+  vtkIdType numberOfVoxels = static_cast<vtkIdType>(dimX) * dimY;
+  // beyond that many runs, the voxels take less memory
+  size_t maximumNumberOfRuns = static_cast<size_t>(
+    numberOfVoxels * ScalarSize(scalarType) / sizeof(vtkImageRunLengthLabelMapRun));
+  vtkImageRunLengthLabelMapSlice& labels = this->Slices[k - self->Extent[4]];
+  vtkImageRunLengthLabelMapRuns runs;
+  bool encoded = true;
+  switch (scalarType)
+    {
+    vtkTemplateMacro(encoded = EncodeRuns(static_cast<const VTK_TT*>(slice),
+                                          numberOfComponents, dimX, dimY,
+                                          maximumNumberOfRuns, runs));
+    default:
+      break;
+    }
+  if (encoded)
+    {
+    // copy to release the memory allocated while encoding
+    vtkImageRunLengthLabelMapRuns(runs).swap(labels.Runs);
+    std::vector<unsigned char>().swap(labels.Voxels);
+    return;
+    }
+  vtkImageRunLengthLabelMapRuns().swap(labels.Runs);
+  labels.Voxels.resize(numberOfVoxels * ScalarSize(scalarType));
+  switch (scalarType)
+    {
+    vtkTemplateMacro(CopyVoxels(static_cast<const VTK_TT*>(slice), numberOfComponents,
+                                numberOfVoxels,
+                                reinterpret_cast<VTK_TT*>(&labels.Voxels[0])));
+    default:
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::vtkInternal::DecodeSlice(
+  vtkImageRunLengthLabelMap* self, int k, void* slice)
+{
+  int dimX = self->Extent[1] - self->Extent[0] + 1;
+  int dimY = self->Extent[3] - self->Extent[2] + 1;
+  const vtkImageRunLengthLabelMapSlice& labels = this->Slices[k - self->Extent[4]];
+  if (!labels.Voxels.empty())
+    {
+    memcpy(slice, &labels.Voxels[0], labels.Voxels.size());
+    return;
+    }
+  switch (self->ScalarType)
+    {
+    vtkTemplateMacro(DecodeRuns(labels.Runs, static_cast<VTK_TT*>(slice), dimX, dimY));
+    default:
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageRunLengthLabelMap::vtkInternal::DecodeSliceLabel(
+  vtkImageRunLengthLabelMap* self, int k, void* slice, double label)
+{
+  int dimX = self->Extent[1] - self->Extent[0] + 1;
+  int dimY = self->Extent[3] - self->Extent[2] + 1;
+  const vtkImageRunLengthLabelMapSlice& labels = this->Slices[k - self->Extent[4]];
+  vtkIdType numberOfVoxels = 0;
+  switch (self->ScalarType)
+    {
+    vtkTemplateMacro(
+      numberOfVoxels = labels.Voxels.empty() ?
+        DecodeLabelRuns(labels.Runs, label, static_cast<VTK_TT*>(slice), dimX, dimY) :
+        DecodeLabelVoxels(reinterpret_cast<const VTK_TT*>(&labels.Voxels[0]), label,
+                          static_cast<VTK_TT*>(slice),
+                          static_cast<vtkIdType>(dimX) * dimY));
+    default:
+      break;
+    }
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageRunLengthLabelMap::vtkInternal::ExecuteSlices(
+  vtkImageRunLengthLabelMap* self, vtkImageData* image, int mode, double label,
+  int kMin, int kMax)
+{
+  const int* extent = image->GetExtent();
+  vtkIdType numberOfVoxels = 0;
+  for (int k = kMin; k <= kMax; ++k)
+    {
+    void* slice = image->GetScalarPointer(extent[0], extent[2], k);
+    switch (mode)
+      {
+      case Encode:
+        this->EncodeSlice(self, k, slice, image->GetScalarType(),
+                          image->GetNumberOfScalarComponents());
+        break;
+      case Decode:
+        this->DecodeSlice(self, k, slice);
+        break;
+      case DecodeLabel:
+        numberOfVoxels += this->DecodeSliceLabel(self, k, slice, label);
+        break;
+      default:
+        break;
+      }
+    }
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageRunLengthLabelMap::vtkInternal::ThreadedExecuteSlices(
+  vtkImageRunLengthLabelMap* self, vtkImageData* image, int mode, double label,
+  int kMin, int kMax)
+{
+  ThreadData data;
+  data.Self = self;
+  data.Image = image;
+  data.Mode = mode;
+  data.Label = label;
+  data.Slices[0] = kMin;
+  data.Slices[1] = kMax;
+  data.NumberOfVoxels.resize(self->MultiThreader->GetNumberOfThreads(), 0);
+  self->MultiThreader->SetSingleMethod(vtkInternal::ThreadedExecute, &data);
+  self->MultiThreader->SingleMethodExecute();
+  vtkIdType numberOfVoxels = 0;
+  for (size_t thread = 0; thread < data.NumberOfVoxels.size(); ++thread)
+    {
+    numberOfVoxels += data.NumberOfVoxels[thread];
+    }
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkImageRunLengthLabelMap::vtkInternal::ThreadedExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ThreadData* data = static_cast<ThreadData*>(info->UserData);
+
+  // split the slices between the threads
+  int numberOfSlices = data->Slices[1] - data->Slices[0] + 1;
+  int kMin = data->Slices[0] + info->ThreadID * numberOfSlices / info->NumberOfThreads;
+  int kMax = data->Slices[0] + (info->ThreadID + 1) * numberOfSlices / info->NumberOfThreads - 1;
+  data->NumberOfVoxels[info->ThreadID] = data->Self->Internal->ExecuteSlices(
+    data->Self, data->Image, data->Mode, data->Label, kMin, kMax);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkImageRunLengthLabelMap, "$Revision$");
+vtkStandardNewMacro(vtkImageRunLengthLabelMap);
+
+//----------------------------------------------------------------------------
+vtkImageRunLengthLabelMap::vtkImageRunLengthLabelMap()
+{
+  this->Extent[0] = this->Extent[2] = this->Extent[4] = 0;
+  this->Extent[1] = this->Extent[3] = this->Extent[5] = -1;
+  this->Spacing[0] = this->Spacing[1] = this->Spacing[2] = 1.;
+  this->Origin[0] = this->Origin[1] = this->Origin[2] = 0.;
+  this->ScalarType = VTK_SHORT;
+  this->MultiThreader = vtkMultiThreader::New();
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkImageRunLengthLabelMap::~vtkImageRunLengthLabelMap()
+{
+  this->MultiThreader->Delete();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::SetNumberOfThreads(int numberOfThreads)
+{
+  this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageRunLengthLabelMap::GetNumberOfThreads()
+{
+  return this->MultiThreader->GetNumberOfThreads();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::SetImage(vtkImageData *image)
+{
+  if (!image)
+    {
+    vtkErrorMacro("SetImage: image cannot be NULL");
+    return;
+    }
+  image->Update();
+  if (!image->GetScalarPointer())
+    {
+    vtkErrorMacro("SetImage: image has no scalars");
+    return;
+    }
+  image->GetExtent(this->Extent);
+  image->GetSpacing(this->Spacing);
+  image->GetOrigin(this->Origin);
+  this->ScalarType = image->GetScalarType();
+  this->Internal->Slices.clear();
+  this->Internal->Slices.resize(std::max(this->Extent[5] - this->Extent[4] + 1, 0));
+
+  this->Internal->ThreadedExecuteSlices(this, image, vtkInternal::Encode, 0.,
+                                        this->Extent[4], this->Extent[5]);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::GetImage(vtkImageData *image)
+{
+  if (!image)
+    {
+    vtkErrorMacro("GetImage: image cannot be NULL");
+    return;
+    }
+  image->SetExtent(this->Extent);
+  image->SetWholeExtent(this->Extent);
+  image->SetSpacing(this->Spacing);
+  image->SetOrigin(this->Origin);
+  image->SetScalarType(this->ScalarType);
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  if (this->Internal->Slices.empty())
+    {
+    return;
+    }
+
+  this->Internal->ThreadedExecuteSlices(this, image, vtkInternal::Decode, 0.,
+                                        this->Extent[4], this->Extent[5]);
+  image->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageRunLengthLabelMap::GetLabelImage(double label, vtkImageData *image)
+{
+  if (!image)
+    {
+    vtkErrorMacro("GetLabelImage: image cannot be NULL");
+    return 0;
+    }
+  image->SetExtent(this->Extent);
+  image->SetWholeExtent(this->Extent);
+  image->SetSpacing(this->Spacing);
+  image->SetOrigin(this->Origin);
+  image->SetScalarType(this->ScalarType);
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  if (this->Internal->Slices.empty())
+    {
+    return 0;
+    }
+
+  vtkIdType numberOfVoxels = this->Internal->ThreadedExecuteSlices(
+    this, image, vtkInternal::DecodeLabel, label, this->Extent[4], this->Extent[5]);
+  image->Modified();
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::GetSlices(int kMin, int kMax, vtkImageData *slab)
+{
+  if (!slab)
+    {
+    vtkErrorMacro("GetSlices: slab cannot be NULL");
+    return;
+    }
+  int extent[6] = {this->Extent[0], this->Extent[1], this->Extent[2], this->Extent[3],
+                   std::max(kMin, this->Extent[4]), std::min(kMax, this->Extent[5])};
+  if (extent[4] > extent[5])
+    {
+    vtkErrorMacro("GetSlices: slices " << kMin << " to " << kMax
+                  << " are outside of the label map");
+    return;
+    }
+  slab->SetExtent(extent);
+  slab->SetWholeExtent(extent);
+  slab->SetSpacing(this->Spacing);
+  slab->SetOrigin(this->Origin);
+  slab->SetScalarType(this->ScalarType);
+  slab->SetNumberOfScalarComponents(1);
+  slab->AllocateScalars();
+
+  // a stroke touches a few slices, not worth spawning threads
+  this->Internal->ExecuteSlices(this, slab, vtkInternal::Decode, 0., extent[4], extent[5]);
+  slab->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::SetSlices(vtkImageData *slab)
+{
+  if (!slab || !slab->GetScalarPointer())
+    {
+    vtkErrorMacro("SetSlices: slab has no scalars");
+    return;
+    }
+  int* extent = slab->GetExtent();
+  if (extent[0] != this->Extent[0] || extent[1] != this->Extent[1] ||
+      extent[2] != this->Extent[2] || extent[3] != this->Extent[3])
+    {
+    vtkErrorMacro("SetSlices: the slices of the slab must have the size of the label map slices");
+    return;
+    }
+  if (slab->GetScalarType() != this->ScalarType)
+    {
+    vtkErrorMacro("SetSlices: the slab must have the scalar type of the label map");
+    return;
+    }
+
+  this->Internal->ExecuteSlices(this, slab, vtkInternal::Encode, 0.,
+                                std::max(extent[4], this->Extent[4]),
+                                std::min(extent[5], this->Extent[5]));
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkImageRunLengthLabelMap::GetValue(int i, int j, int k)
+{
+  if (i < this->Extent[0] || i > this->Extent[1] ||
+      j < this->Extent[2] || j > this->Extent[3] ||
+      k < this->Extent[4] || k > this->Extent[5])
+    {
+    return 0.;
+    }
+  const vtkImageRunLengthLabelMapSlice& labels =
+    this->Internal->Slices[k - this->Extent[4]];
+  if (!labels.Voxels.empty())
+    {
+    vtkIdType index = static_cast<vtkIdType>(j - this->Extent[2]) *
+      (this->Extent[1] - this->Extent[0] + 1) + (i - this->Extent[0]);
+    switch (this->ScalarType)
+      {
+      vtkTemplateMacro(
+        return VoxelValue(reinterpret_cast<const VTK_TT*>(&labels.Voxels[0]), index));
+      default:
+        break;
+      }
+    return 0.;
+    }
+  const vtkImageRunLengthLabelMapRuns& runs = labels.Runs;
+  vtkImageRunLengthLabelMapRun voxel;
+  voxel.Row = j - this->Extent[2];
+  voxel.Start = i - this->Extent[0];
+  // first run after the voxel, the voxel can only be in the previous run
+  vtkImageRunLengthLabelMapRuns::const_iterator it =
+    std::upper_bound(runs.begin(), runs.end(), voxel);
+  if (it == runs.begin())
+    {
+    return 0.;
+    }
+  --it;
+  if (it->Row != voxel.Row || voxel.Start >= it->Start + it->Length)
+    {
+    return 0.;
+    }
+  return it->Value;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::Initialize()
+{
+  std::vector<vtkImageRunLengthLabelMapSlice>::iterator it;
+  for (it = this->Internal->Slices.begin(); it != this->Internal->Slices.end(); ++it)
+    {
+    vtkImageRunLengthLabelMapRuns().swap(it->Runs);
+    std::vector<unsigned char>().swap(it->Voxels);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageRunLengthLabelMap::GetNumberOfRuns()
+{
+  vtkIdType numberOfRuns = 0;
+  std::vector<vtkImageRunLengthLabelMapSlice>::const_iterator it;
+  for (it = this->Internal->Slices.begin(); it != this->Internal->Slices.end(); ++it)
+    {
+    numberOfRuns += static_cast<vtkIdType>(it->Runs.size());
+    }
+  return numberOfRuns;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageRunLengthLabelMap::GetNumberOfDenseSlices()
+{
+  int numberOfDenseSlices = 0;
+  std::vector<vtkImageRunLengthLabelMapSlice>::const_iterator it;
+  for (it = this->Internal->Slices.begin(); it != this->Internal->Slices.end(); ++it)
+    {
+    if (!it->Voxels.empty())
+      {
+      ++numberOfDenseSlices;
+      }
+    }
+  return numberOfDenseSlices;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkImageRunLengthLabelMap::GetActualMemorySize()
+{
+  vtkTypeInt64 size = static_cast<vtkTypeInt64>(this->Internal->Slices.capacity()) *
+    sizeof(vtkImageRunLengthLabelMapSlice);
+  std::vector<vtkImageRunLengthLabelMapSlice>::const_iterator it;
+  for (it = this->Internal->Slices.begin(); it != this->Internal->Slices.end(); ++it)
+    {
+    size += static_cast<vtkTypeInt64>(it->Runs.capacity()) * sizeof(vtkImageRunLengthLabelMapRun);
+    size += static_cast<vtkTypeInt64>(it->Voxels.capacity());
+    }
+  return static_cast<unsigned long>((size + 1023) / 1024);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageRunLengthLabelMap::WriteNRRD(const char *fileName, vtkMatrix4x4 *ijkToRAS)
+{
+  vtkNew<vtkImageData> image;
+  this->GetImage(image.GetPointer());
+
+  // The writer expects the IJK to RAS matrix of the first voxel of the extent
+  vtkNew<vtkMatrix4x4> firstVoxelIJKToRAS;
+  if (ijkToRAS)
+    {
+    firstVoxelIJKToRAS->DeepCopy(ijkToRAS);
+    }
+  else
+    {
+    for (int row = 0; row < 3; ++row)
+      {
+      firstVoxelIJKToRAS->SetElement(row, row, this->Spacing[row]);
+      firstVoxelIJKToRAS->SetElement(row, 3, this->Origin[row]);
+      }
+    }
+  for (int row = 0; row < 3; ++row)
+    {
+    double origin = firstVoxelIJKToRAS->GetElement(row, 3);
+    for (int column = 0; column < 3; ++column)
+      {
+      origin += firstVoxelIJKToRAS->GetElement(row, column) * this->Extent[2 * column];
+      }
+    firstVoxelIJKToRAS->SetElement(row, 3, origin);
+    }
+
+  vtkNew<ErrorObserver> errorObserver;
+  vtkNew<vtkNRRDWriter> writer;
+  writer->AddObserver(vtkCommand::ErrorEvent, errorObserver.GetPointer());
+  writer->SetFileName(fileName);
+  writer->SetInput(image.GetPointer());
+  writer->SetIJKToRASMatrix(firstVoxelIJKToRAS.GetPointer());
+  writer->SetUseCompression(1);
+  writer->Write();
+  if (writer->GetWriteError() || errorObserver->Error)
+    {
+    vtkErrorMacro("WriteNRRD: failed to write " << fileName);
+    return 0;
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageRunLengthLabelMap::ReadNRRD(const char *fileName, vtkMatrix4x4 *ijkToRAS)
+{
+  // The labels of the previous label map are dropped, even on failure
+  this->Initialize();
+
+  vtkNew<ErrorObserver> errorObserver;
+  vtkNew<vtkNRRDReader> reader;
+  reader->AddObserver(vtkCommand::ErrorEvent, errorObserver.GetPointer());
+  reader->SetFileName(fileName);
+  reader->UpdateInformation();
+  if (reader->GetReadStatus() || errorObserver->Error)
+    {
+    vtkErrorMacro("ReadNRRD: can't read the header of " << fileName);
+    return 0;
+    }
+  if (reader->GetNumberOfComponents() != 1)
+    {
+    vtkErrorMacro("ReadNRRD: " << fileName << " is not a scalar volume");
+    return 0;
+    }
+  reader->Update();
+  vtkImageData* image = reader->GetOutput();
+  if (errorObserver->Error || !image->GetScalarPointer())
+    {
+    vtkErrorMacro("ReadNRRD: can't read the data of " << fileName);
+    return 0;
+    }
+
+  vtkNew<vtkMatrix4x4> readIJKToRAS;
+  vtkMatrix4x4::Invert(reader->GetRasToIjkMatrix(), readIJKToRAS.GetPointer());
+  if (ijkToRAS)
+    {
+    ijkToRAS->DeepCopy(readIJKToRAS.GetPointer());
+    }
+
+  this->SetImage(image);
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    this->Extent[2 * axis + 1] -= this->Extent[2 * axis];
+    this->Extent[2 * axis] = 0;
+    this->Spacing[axis] = sqrt(
+      readIJKToRAS->GetElement(0, axis) * readIJKToRAS->GetElement(0, axis) +
+      readIJKToRAS->GetElement(1, axis) * readIJKToRAS->GetElement(1, axis) +
+      readIJKToRAS->GetElement(2, axis) * readIJKToRAS->GetElement(2, axis));
+    this->Origin[axis] = readIJKToRAS->GetElement(axis, 3);
+    }
+  this->Modified();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRunLengthLabelMap::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Extent: " << this->Extent[0] << " " << this->Extent[1] << " "
+     << this->Extent[2] << " " << this->Extent[3] << " "
+     << this->Extent[4] << " " << this->Extent[5] << "\n";
+  os << indent << "Spacing: " << this->Spacing[0] << " " << this->Spacing[1] << " "
+     << this->Spacing[2] << "\n";
+  os << indent << "Origin: " << this->Origin[0] << " " << this->Origin[1] << " "
+     << this->Origin[2] << "\n";
+  os << indent << "ScalarType: " << this->ScalarType << "\n";
+  os << indent << "NumberOfRuns: " << this->GetNumberOfRuns() << "\n";
+  os << indent << "NumberOfDenseSlices: " << this->GetNumberOfDenseSlices() << "\n";
+  os << indent << "NumberOfThreads: " << this->GetNumberOfThreads() << "\n";
+}
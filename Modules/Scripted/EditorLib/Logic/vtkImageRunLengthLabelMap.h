@@ -0,0 +1,134 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkImageRunLengthLabelMap - Sparse label map stored as runs of labels
+///
+/// The non-zero voxels of each slice are stored as runs of voxels of the
+/// same label along the rows (i axis). Background voxels are not stored, so
+/// the memory scales with the labelled content instead of the grid size.
+/// Each run takes 24 bytes: a slice whose runs would take more memory than
+/// its voxels (noisy or highly fragmented labels) is stored densely instead.
+///
+/// The label map is converted from and to a dense vtkImageData with
+/// SetImage/GetImage (both split the slices over a vtkMultiThreader).
+/// GetSlices/SetSlices decode and encode a slab of slices only, for example
+/// the slices touched by a vtkImageSlicePaint stroke. GetLabelImage decodes
+/// the voxels of a single label, for example to split a merged label map
+/// into structures.
+///
+/// WriteNRRD and ReadNRRD go through vtkNRRDWriter and vtkNRRDReader.
+///
+/// Only the first scalar component of the images is used.
+
+#ifndef __vtkImageRunLengthLabelMap_h
+#define __vtkImageRunLengthLabelMap_h
+
+#include "vtkSlicerEditorLibModuleLogicExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkImageData;
+class vtkMatrix4x4;
+class vtkMultiThreader;
+
+class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageRunLengthLabelMap : public vtkObject
+{
+public:
+  static vtkImageRunLengthLabelMap *New();
+  vtkTypeRevisionMacro(vtkImageRunLengthLabelMap,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Encode the first component of a dense image. The extent, spacing,
+  /// origin and scalar type of the image are kept.
+  void SetImage(vtkImageData *image);
+
+  ///
+  /// Decode the label map into a dense image
+  void GetImage(vtkImageData *image);
+
+  ///
+  /// Decode the voxels of the given label into a dense image, the other
+  /// voxels are set to 0. Return the number of voxels of the label, always
+  /// 0 for the background label 0.
+  vtkIdType GetLabelImage(double label, vtkImageData *image);
+
+  ///
+  /// Decode the slices [kMin, kMax] into the slab image. The extent of the
+  /// slab is the extent of the label map restricted to the slices, so it
+  /// can be indexed with the ijk coordinates of the label map.
+  void GetSlices(int kMin, int kMax, vtkImageData *slab);
+
+  ///
+  /// Encode back the slices covered by the extent of the slab image
+  void SetSlices(vtkImageData *slab);
+
+  ///
+  /// Label of the voxel, 0 outside of the extent
+  double GetValue(int i, int j, int k);
+
+  ///
+  /// Remove all the labels, the geometry is kept
+  void Initialize();
+
+  vtkGetVector6Macro(Extent, int);
+  vtkGetVector3Macro(Spacing, double);
+  vtkGetVector3Macro(Origin, double);
+  vtkGetMacro(ScalarType, int);
+
+  ///
+  /// Number of runs of non-zero labels of the slices stored as runs
+  vtkIdType GetNumberOfRuns();
+
+  ///
+  /// Number of slices stored densely because their runs would take more
+  /// memory than their voxels
+  int GetNumberOfDenseSlices();
+
+  ///
+  /// Memory used by the runs and the dense slices in kibibytes (1024 bytes)
+  unsigned long GetActualMemorySize();
+
+  ///
+  /// Write the label map in a gzip compressed NRRD file. If ijkToRAS is set,
+  /// it gives the space directions and origin of the file, otherwise the
+  /// spacing and origin of the label map are used.
+  /// Return 0 on failure.
+  int WriteNRRD(const char *fileName, vtkMatrix4x4 *ijkToRAS = 0);
+
+  ///
+  /// Read a scalar NRRD file, the extent of the label map starts at 0. The
+  /// IJK to RAS matrix of the file is copied into ijkToRAS if set.
+  /// Return 0 on failure, the label map is then empty.
+  int ReadNRRD(const char *fileName, vtkMatrix4x4 *ijkToRAS = 0);
+
+  ///
+  /// Number of threads splitting the slices in SetImage and GetImage
+  void SetNumberOfThreads(int numberOfThreads);
+  int GetNumberOfThreads();
+
+protected:
+  vtkImageRunLengthLabelMap();
+  ~vtkImageRunLengthLabelMap();
+
+  int Extent[6];
+  double Spacing[3];
+  double Origin[3];
+  int ScalarType;
+  vtkMultiThreader *MultiThreader;
+
+  class vtkInternal;
+  vtkInternal *Internal;
+
+private:
+  vtkImageRunLengthLabelMap(const vtkImageRunLengthLabelMap&);  /// Not implemented.
+  void operator=(const vtkImageRunLengthLabelMap&);  /// Not implemented.
+};
+
+#endif
@@ -18,6 +18,9 @@
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <algorithm>
+
 
 vtkCxxRevisionMacro(vtkImageSlicePaint, "$Revision$");
 vtkStandardNewMacro(vtkImageSlicePaint);
@@ -33,6 +36,7 @@ vtkImageSlicePaint::vtkImageSlicePaint()
   this->MaskImage = NULL;
   this->BackgroundImage = NULL;
   this->WorkingImage = NULL;
+  this->WorkingLabelMap = NULL;
   this->ExtractImage = NULL;
   this->ReplaceImage = NULL;
 
@@ -57,6 +61,7 @@ vtkImageSlicePaint::~vtkImageSlicePaint()
   this->SetMaskImage (NULL);
   this->SetBackgroundImage (NULL);
   this->SetWorkingImage (NULL);
+  this->SetWorkingLabelMap (NULL);
   this->SetExtractImage (NULL);
   this->SetReplaceImage (NULL);
 
@@ -393,6 +398,11 @@ void vtkImageSlicePaint::Paint()
 {
   void *ptr = NULL;
   
+  if ( this->GetWorkingImage() == NULL && this->GetWorkingLabelMap() != NULL )
+    {
+    this->PaintLabelMap();
+    return;
+    }
   if ( this->GetWorkingImage() == NULL )
     {
     vtkErrorMacro (<< "Working image cannot be NULL\n");
@@ -413,6 +423,31 @@ void vtkImageSlicePaint::Paint()
   return;
 }
 
+//----------------------------------------------------------------------------
+void vtkImageSlicePaint::PaintLabelMap()
+{
+  // the paint region is bilinear, its corners bound the slices it touches
+  int kMin = std::min( std::min(this->TopLeft[2], this->TopRight[2]),
+                       std::min(this->BottomLeft[2], this->BottomRight[2]) );
+  int kMax = std::max( std::max(this->TopLeft[2], this->TopRight[2]),
+                       std::max(this->BottomLeft[2], this->BottomRight[2]) );
+  int *extent = this->WorkingLabelMap->GetExtent();
+  if ( kMax < extent[4] || kMin > extent[5] )
+    {
+    // nothing to paint
+    return;
+    }
+
+  // paint into the decoded slices, their extent is the one of the label map
+  // restricted to the slices, so the paint region is unchanged
+  vtkNew<vtkImageData> slab;
+  this->WorkingLabelMap->GetSlices(kMin, kMax, slab.GetPointer());
+  this->SetWorkingImage(slab.GetPointer());
+  this->Paint();
+  this->SetWorkingImage(NULL);
+  this->WorkingLabelMap->SetSlices(slab.GetPointer());
+}
+
 //----------------------------------------------------------------------------
 void vtkImageSlicePaint::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -429,6 +464,7 @@ void vtkImageSlicePaint::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "BackgroundImage: " << this->GetBackgroundImage() << "\n";
   os << indent << "WorkingImage: " << this->GetWorkingImage() << "\n";
+  os << indent << "WorkingLabelMap: " << this->GetWorkingLabelMap() << "\n";
   os << indent << "ExtractImage: " << this->GetExtractImage() << "\n";
   os << indent << "ReplaceImage: " << this->GetReplaceImage() << "\n";
 
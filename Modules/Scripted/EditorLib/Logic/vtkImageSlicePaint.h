@@ -30,6 +30,9 @@
 /// of the ExtractImage can be saved together with the original coordinates
 /// in order to implement undo.
 //
+/// The WorkingImage can be replaced by a sparse WorkingLabelMap, only the
+/// slices spanned by the paint region are then decoded and encoded back.
+//
 /// The WorkingImage is modified using either a round paintbrush or an
 /// image mask.  In either case, as the region is being traversed in IJK space,
 /// the coordinate is transformed to World space to check if it should be modified
@@ -43,6 +46,7 @@
 #define __vtkImageSlicePaint_h
 
 #include "vtkSlicerEditorLibModuleLogicExport.h"
+#include "vtkImageRunLengthLabelMap.h"
 
 // VTK includes
 #include <vtkImageData.h>
@@ -93,6 +97,11 @@ public:
   vtkSetObjectMacro(WorkingImage, vtkImageData);
   vtkGetObjectMacro(WorkingImage, vtkImageData);
 
+  /// 
+  /// Sparse label map to be painted into when WorkingImage is NULL
+  vtkSetObjectMacro(WorkingLabelMap, vtkImageRunLengthLabelMap);
+  vtkGetObjectMacro(WorkingLabelMap, vtkImageRunLengthLabelMap);
+
   /// 
   /// The place to store data pulled out
   vtkSetObjectMacro(ExtractImage, vtkImageData);
@@ -143,6 +152,10 @@ protected:
   vtkImageSlicePaint();
   ~vtkImageSlicePaint();
 
+  /// 
+  /// Paint into the slices of the WorkingLabelMap spanned by the paint region
+  void PaintLabelMap();
+
   int TopLeft[3];
   int TopRight[3];
   int BottomLeft[3];
@@ -151,6 +164,7 @@ protected:
   vtkImageData *MaskImage;
   vtkImageData *BackgroundImage;
   vtkImageData *WorkingImage;
+  vtkImageRunLengthLabelMap *WorkingLabelMap;
   vtkImageData *ExtractImage;
   vtkImageData *ReplaceImage;
 
@@ -16,6 +16,326 @@
 
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtk_zlib.h"
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+//----------------------------------------------------------------------------
+class vtkImageStash::vtkInternal
+{
+public:
+  struct Brick
+  {
+    /// voxels of the brick, 0-based
+    int Extent[6];
+    /// zlib compressed voxels, can be shared with other stashes
+    vtkSmartPointer<vtkUnsignedCharArray> Data;
+    /// crc32 and adler32 of the voxels
+    vtkTypeUInt64 Hash;
+  };
+
+  enum Operation
+  {
+    CompareBricks,
+    CompressBricks,
+    UncompressBricks
+  };
+
+  /// Data shared by the threads working on the bricks
+  struct ThreadData
+  {
+    vtkInternal* Internal;
+    Operation Task;
+    const std::vector<int>* Bricks;
+    unsigned char* Scalars;
+    int CompressionLevel;
+    vtkInternal* Previous;
+    /// Bricks that zlib failed to compress or decompress, by thread
+    std::vector<int> NumberOfErrors;
+  };
+
+  vtkInternal();
+
+  /// Split the image into bricks of brickSize^3 voxels
+  void InitializeBricks(const int extent[6], int scalarType,
+                        int numberOfComponents, int brickSize);
+  /// True if the bricks of the stash have the same geometry as this one
+  bool IsCompatible(vtkInternal* other)const;
+  vtkIdType GetBrickSize(const Brick& brick)const;
+  /// Copy the voxels of the brick from the scalars to the buffer or back
+  void CopyBrick(const Brick& brick, unsigned char* scalars,
+                 unsigned char* buffer, bool toBuffer)const;
+  /// Hash of the voxels of the brick in the scalars
+  vtkTypeUInt64 BrickHash(const Brick& brick, const unsigned char* scalars)const;
+  /// Hash of contiguous voxels
+  static vtkTypeUInt64 Hash(const unsigned char* buffer, vtkIdType size);
+
+  /// Run the operation on the bricks, split between the threads.
+  /// Return the number of bricks zlib failed to compress or decompress.
+  int Execute(Operation task, const std::vector<int>& bricks,
+              unsigned char* scalars, int compressionLevel,
+              vtkInternal* previous = 0);
+  static VTK_THREAD_RETURN_TYPE ThreadedExecute(void *arg);
+  static VTK_THREAD_RETURN_TYPE ThreadedStash(void *arg);
+
+  std::vector<Brick> Bricks;
+  /// Bricks to be compressed by CompressBricks
+  std::vector<int> BricksToCompress;
+  /// Result of CompareBricks for each brick
+  std::vector<char> UnchangedBricks;
+  int Extent[6];
+  int Dimensions[3];
+  int ScalarType;
+  int NumberOfComponents;
+  int VoxelSize;
+  int BrickSize;
+  /// True once all the bricks are compressed
+  bool Valid;
+  vtkSmartPointer<vtkMultiThreader> Threader;
+};
+
+//----------------------------------------------------------------------------
+vtkImageStash::vtkInternal::vtkInternal()
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Extent[2 * i] = 0;
+    this->Extent[2 * i + 1] = -1;
+    this->Dimensions[i] = 0;
+    }
+  this->ScalarType = VTK_VOID;
+  this->NumberOfComponents = 0;
+  this->VoxelSize = 0;
+  this->BrickSize = 0;
+  this->Valid = false;
+  this->Threader = vtkSmartPointer<vtkMultiThreader>::New();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStash::vtkInternal::InitializeBricks(
+  const int extent[6], int scalarType, int numberOfComponents, int brickSize)
+{
+  int numberOfBricks[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Extent[2 * i] = extent[2 * i];
+    this->Extent[2 * i + 1] = extent[2 * i + 1];
+    this->Dimensions[i] = std::max(extent[2 * i + 1] - extent[2 * i] + 1, 0);
+    numberOfBricks[i] = (this->Dimensions[i] + brickSize - 1) / brickSize;
+    }
+  this->ScalarType = scalarType;
+  this->NumberOfComponents = numberOfComponents;
+  this->VoxelSize = vtkDataArray::GetDataTypeSize(scalarType) * numberOfComponents;
+  this->BrickSize = brickSize;
+  this->Valid = false;
+  this->Bricks.clear();
+  this->Bricks.resize(numberOfBricks[0] * numberOfBricks[1] * numberOfBricks[2]);
+  int index = 0;
+  for (int k = 0; k < numberOfBricks[2]; ++k)
+    {
+    for (int j = 0; j < numberOfBricks[1]; ++j)
+      {
+      for (int i = 0; i < numberOfBricks[0]; ++i, ++index)
+        {
+        int brickIndex[3] = {i, j, k};
+        Brick& brick = this->Bricks[index];
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          brick.Extent[2 * axis] = brickIndex[axis] * brickSize;
+          brick.Extent[2 * axis + 1] =
+            std::min(brick.Extent[2 * axis] + brickSize, this->Dimensions[axis]) - 1;
+          }
+        brick.Hash = 0;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStash::vtkInternal::IsCompatible(vtkInternal* other)const
+{
+  return other->Valid &&
+    other->Dimensions[0] == this->Dimensions[0] &&
+    other->Dimensions[1] == this->Dimensions[1] &&
+    other->Dimensions[2] == this->Dimensions[2] &&
+    other->ScalarType == this->ScalarType &&
+    other->NumberOfComponents == this->NumberOfComponents &&
+    other->BrickSize == this->BrickSize;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageStash::vtkInternal::GetBrickSize(const Brick& brick)const
+{
+  return static_cast<vtkIdType>(brick.Extent[1] - brick.Extent[0] + 1) *
+    (brick.Extent[3] - brick.Extent[2] + 1) *
+    (brick.Extent[5] - brick.Extent[4] + 1) * this->VoxelSize;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStash::vtkInternal::CopyBrick(
+  const Brick& brick, unsigned char* scalars, unsigned char* buffer, bool toBuffer)const
+{
+  const size_t rowSize = static_cast<size_t>(brick.Extent[1] - brick.Extent[0] + 1) *
+    this->VoxelSize;
+  for (int k = brick.Extent[4]; k <= brick.Extent[5]; ++k)
+    {
+    for (int j = brick.Extent[2]; j <= brick.Extent[3]; ++j)
+      {
+      unsigned char* row = scalars + ((static_cast<vtkIdType>(k) * this->Dimensions[1] + j) *
+        this->Dimensions[0] + brick.Extent[0]) * this->VoxelSize;
+      if (toBuffer)
+        {
+        memcpy(buffer, row, rowSize);
+        }
+      else
+        {
+        memcpy(row, buffer, rowSize);
+        }
+      buffer += rowSize;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// The bricks are compared by their hashes only: adler32 alone collides
+// easily on mostly empty label maps, crc32 catches the small differences
+// it misses and the pair makes a 64-bit hash.
+vtkTypeUInt64 vtkImageStash::vtkInternal::BrickHash(
+  const Brick& brick, const unsigned char* scalars)const
+{
+  const uInt rowSize = static_cast<uInt>(brick.Extent[1] - brick.Extent[0] + 1) *
+    this->VoxelSize;
+  uLong adler = adler32(0L, Z_NULL, 0);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  for (int k = brick.Extent[4]; k <= brick.Extent[5]; ++k)
+    {
+    for (int j = brick.Extent[2]; j <= brick.Extent[3]; ++j)
+      {
+      const unsigned char* row = scalars + ((static_cast<vtkIdType>(k) * this->Dimensions[1] + j) *
+        this->Dimensions[0] + brick.Extent[0]) * this->VoxelSize;
+      adler = adler32(adler, row, rowSize);
+      crc = crc32(crc, row, rowSize);
+      }
+    }
+  return (static_cast<vtkTypeUInt64>(crc & 0xffffffffUL) << 32) |
+    static_cast<vtkTypeUInt64>(adler & 0xffffffffUL);
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 vtkImageStash::vtkInternal::Hash(const unsigned char* buffer, vtkIdType size)
+{
+  const uLong adler = adler32(adler32(0L, Z_NULL, 0), buffer, static_cast<uInt>(size));
+  const uLong crc = crc32(crc32(0L, Z_NULL, 0), buffer, static_cast<uInt>(size));
+  return (static_cast<vtkTypeUInt64>(crc & 0xffffffffUL) << 32) |
+    static_cast<vtkTypeUInt64>(adler & 0xffffffffUL);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageStash::vtkInternal::Execute(Operation task, const std::vector<int>& bricks,
+                                        unsigned char* scalars, int compressionLevel,
+                                        vtkInternal* previous)
+{
+  if (bricks.empty())
+    {
+    return 0;
+    }
+  ThreadData data;
+  data.Internal = this;
+  data.Task = task;
+  data.Bricks = &bricks;
+  data.Scalars = scalars;
+  data.CompressionLevel = compressionLevel;
+  data.Previous = previous;
+  const int numberOfThreads = std::min(
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads(), static_cast<int>(bricks.size()));
+  data.NumberOfErrors.assign(numberOfThreads, 0);
+  this->Threader->SetNumberOfThreads(numberOfThreads);
+  this->Threader->SetSingleMethod(vtkInternal::ThreadedExecute, &data);
+  this->Threader->SingleMethodExecute();
+  int numberOfErrors = 0;
+  for (size_t thread = 0; thread < data.NumberOfErrors.size(); ++thread)
+    {
+    numberOfErrors += data.NumberOfErrors[thread];
+    }
+  return numberOfErrors;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkImageStash::vtkInternal::ThreadedExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ThreadData* data = static_cast<ThreadData*>(info->UserData);
+  vtkInternal* internal = data->Internal;
+
+  // split the bricks between the threads
+  const size_t numberOfBricks = data->Bricks->size();
+  const size_t begin = numberOfBricks * info->ThreadID / info->NumberOfThreads;
+  const size_t end = numberOfBricks * (info->ThreadID + 1) / info->NumberOfThreads;
+  std::vector<unsigned char> buffer;
+  std::vector<unsigned char> compressed;
+  for (size_t n = begin; n < end; ++n)
+    {
+    const int index = (*data->Bricks)[n];
+    Brick& brick = internal->Bricks[index];
+    const vtkIdType brickSize = internal->GetBrickSize(brick);
+    switch (data->Task)
+      {
+      case CompareBricks:
+        brick.Hash = internal->BrickHash(brick, data->Scalars);
+        internal->UnchangedBricks[index] = brick.Hash == data->Previous->Bricks[index].Hash;
+        break;
+      case CompressBricks:
+        {
+        buffer.resize(brickSize);
+        internal->CopyBrick(brick, data->Scalars, &buffer[0], true);
+        brick.Hash = vtkInternal::Hash(&buffer[0], brickSize);
+        uLongf compressedSize = compressBound(static_cast<uLong>(brickSize));
+        compressed.resize(compressedSize);
+        if (compress2(&compressed[0], &compressedSize, &buffer[0],
+                      static_cast<uLong>(brickSize), data->CompressionLevel) != Z_OK)
+          {
+          ++data->NumberOfErrors[info->ThreadID];
+          break;
+          }
+        // the array is created by the calling thread
+        brick.Data->SetNumberOfTuples(compressedSize);
+        memcpy(brick.Data->GetPointer(0), &compressed[0], compressedSize);
+        break;
+        }
+      case UncompressBricks:
+        {
+        buffer.resize(brickSize);
+        uLongf uncompressedSize = static_cast<uLongf>(brickSize);
+        if (uncompress(&buffer[0], &uncompressedSize, brick.Data->GetPointer(0),
+                       static_cast<uLong>(brick.Data->GetNumberOfTuples())) != Z_OK ||
+            uncompressedSize != static_cast<uLongf>(brickSize))
+          {
+          // leave the voxels of the brick untouched
+          ++data->NumberOfErrors[info->ThreadID];
+          break;
+          }
+        internal->CopyBrick(brick, data->Scalars, &buffer[0], false);
+        break;
+        }
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkImageStash::vtkInternal::ThreadedStash(void *arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkImageStash *self = static_cast<vtkImageStash *>(info->UserData);
+  self->CompressBricks();
+  self->SetStashing(0);
+  return VTK_THREAD_RETURN_VALUE;
+}
 
 vtkCxxRevisionMacro(vtkImageStash, "$Revision: 12690 $");
 vtkStandardNewMacro(vtkImageStash);
@@ -24,18 +344,26 @@ vtkStandardNewMacro(vtkImageStash);
 vtkImageStash::vtkImageStash()
 {
   this->StashImage = NULL;
-  this->StashedScalars = NULL;
+  this->PreviousStash = NULL;
   this->MultiThreader = vtkMultiThreader::New();
-  this->Compressor = vtkZLibDataCompressor::New();
+  this->NumberOfTuples = 0;
   this->CompressionLevel = 1; // corresponds to Z_BEST_SPEED
+  this->BrickSize = 32;
+  this->ModifiedExtent[0] = this->ModifiedExtent[2] = this->ModifiedExtent[4] = 0;
+  this->ModifiedExtent[1] = this->ModifiedExtent[3] = this->ModifiedExtent[5] = -1;
+  this->KeepScalars = 0;
+  this->UnstashedExtent[0] = this->UnstashedExtent[2] = this->UnstashedExtent[4] = 0;
+  this->UnstashedExtent[1] = this->UnstashedExtent[3] = this->UnstashedExtent[5] = -1;
+  this->NumberOfCompressedBricks = 0;
   this->Stashing = 0;
   this->StashingThreadID = 0;
+  this->Internal = new vtkInternal;
 }
 
 //----------------------------------------------------------------------------
 vtkImageStash::~vtkImageStash()
 {
-  
+
   if (this->Stashing)
     {
     this->MultiThreader->TerminateThread(this->StashingThreadID);
@@ -44,87 +372,195 @@ vtkImageStash::~vtkImageStash()
     {
     this->StashImage->Delete();
     }
-  if (this->StashedScalars)
+  if (this->PreviousStash)
     {
-    this->StashedScalars->Delete();
+    this->PreviousStash->Delete();
     }
   if (this->MultiThreader)
     {
     this->MultiThreader->Delete();
     }
-  if (this->Compressor)
-    {
-    this->Compressor->Delete();
-    }
+  delete this->Internal;
 }
 
 //----------------------------------------------------------------------------
-static void *vtkImageStash_ThreadFunction( vtkMultiThreader::ThreadInfo *genericData )
+int vtkImageStash::GetNumberOfBricks()
 {
-  ThreadInfoStruct *info = static_cast<ThreadInfoStruct*>(genericData);
-  vtkImageStash *self = static_cast<vtkImageStash *>(info->UserData);
-  self->Stash();
-  self->SetStashing(0);
-  return NULL;
+  return static_cast<int>(this->Internal->Bricks.size());
+}
+
+//----------------------------------------------------------------------------
+vtkTypeInt64 vtkImageStash::GetStashedSize()
+{
+  vtkTypeInt64 size = 0;
+  std::vector<vtkInternal::Brick>::const_iterator it;
+  for (it = this->Internal->Bricks.begin(); it != this->Internal->Bricks.end(); ++it)
+    {
+    if (it->Data)
+      {
+      size += it->Data->GetNumberOfTuples();
+      }
+    }
+  return size;
 }
 
 //----------------------------------------------------------------------------
 void vtkImageStash::ThreadedStash()
 {
+  if (!this->PrepareStash())
+    {
+    return;
+    }
   this->SetStashing(1);
   this->StashingThreadID = this->MultiThreader->SpawnThread(
-                                        (vtkThreadFunctionType) &vtkImageStash_ThreadFunction, 
+                                        vtkInternal::ThreadedStash,
                                         static_cast<void *>(this));
 }
 
 
 //----------------------------------------------------------------------------
 void vtkImageStash::Stash()
+{
+  if (this->PrepareStash())
+    {
+    this->CompressBricks();
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStash::PrepareStash()
 {
   //
-  // put a compressed version of the scalars into the compressed 
-  // buffer, and then set the scalar size to zero
+  // find the bricks that differ from the previous stash, the other ones
+  // share the compressed data of the previous stash
   //
   if (!this->GetStashImage())
     {
     vtkErrorWithObjectMacro (this, "Cannot stash - no image data");
-    return;
+    return false;
     }
 
-  vtkDataArray *scalars = this->GetStashImage()->GetPointData()->GetScalars();  
+  vtkDataArray *scalars = this->GetStashImage()->GetPointData()->GetScalars();
   if (!scalars)
     {
     vtkErrorWithObjectMacro (this, "Cannot stash - image has no scalars");
-    return;
+    return false;
     }
 
+  vtkInternal* internal = this->Internal;
   this->SetNumberOfTuples(scalars->GetNumberOfTuples());
-  vtkIdType numPrims = this->GetNumberOfTuples() * scalars->GetNumberOfComponents();
-  vtkIdType size = vtkDataArray::GetDataTypeSize(scalars->GetDataType());
-  vtkIdType scalarSize = size * numPrims;
+  internal->InitializeBricks(this->GetStashImage()->GetExtent(), scalars->GetDataType(),
+                             scalars->GetNumberOfComponents(), this->BrickSize);
+  if (static_cast<vtkIdType>(internal->Dimensions[0]) * internal->Dimensions[1] *
+      internal->Dimensions[2] != this->GetNumberOfTuples())
+    {
+    vtkErrorWithObjectMacro (this, "Cannot stash - the scalars do not match the image extent");
+    internal->Bricks.clear();
+    return false;
+    }
+  unsigned char *p = static_cast<unsigned char *>(scalars->GetVoidPointer(0));
 
-  unsigned char *p = static_cast<unsigned char *>(scalars->WriteVoidPointer(0, numPrims));
-  this->GetCompressor()->SetCompressionLevel(this->GetCompressionLevel());
-  vtkUnsignedCharArray* compressedBuffer=this->GetCompressor()->Compress(p, scalarSize); // returns a new buffer that has to be deleted
-  // The compressor allocates space that has the size of an uncompressed volume
-  // and even if it uses less memory the buffer size is not reduced.
-  // Call squeeze on the buffer to reclaim the unused memory space
-  // (typically reduces memory consumption from hundreds of megabytes to under a megabyte)
-  compressedBuffer->Squeeze(); 
-  this->SetStashedScalars(compressedBuffer);
-  compressedBuffer->Delete();
+  vtkInternal* previous = 0;
+  if (this->PreviousStash && this->PreviousStash != this &&
+      !this->PreviousStash->GetStashing() &&
+      internal->IsCompatible(this->PreviousStash->Internal))
+    {
+    previous = this->PreviousStash->Internal;
+    }
 
-  // this will realloc a zero sized buffer
-  scalars->SetNumberOfTuples(0);
-  scalars->Squeeze();
+  internal->BricksToCompress.clear();
+  const int* imageExtent = this->GetStashImage()->GetExtent();
+  bool modifiedExtent = this->ModifiedExtent[0] <= this->ModifiedExtent[1] &&
+                        this->ModifiedExtent[2] <= this->ModifiedExtent[3] &&
+                        this->ModifiedExtent[4] <= this->ModifiedExtent[5];
+  internal->UnchangedBricks.assign(internal->Bricks.size(), 0);
+  if (previous && !modifiedExtent)
+    {
+    std::vector<int> allBricks;
+    for (int n = 0; n < static_cast<int>(internal->Bricks.size()); ++n)
+      {
+      allBricks.push_back(n);
+      }
+    internal->Execute(vtkInternal::CompareBricks, allBricks, p,
+                      this->CompressionLevel, previous);
+    }
+  for (int n = 0; n < static_cast<int>(internal->Bricks.size()); ++n)
+    {
+    vtkInternal::Brick& brick = internal->Bricks[n];
+    bool modified = true;
+    if (previous && modifiedExtent)
+      {
+      modified = false;
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        int min = this->ModifiedExtent[2 * axis] - imageExtent[2 * axis];
+        int max = this->ModifiedExtent[2 * axis + 1] - imageExtent[2 * axis];
+        modified = (axis == 0 || modified) &&
+          max >= brick.Extent[2 * axis] && min <= brick.Extent[2 * axis + 1];
+        }
+      }
+    else if (previous)
+      {
+      modified = !internal->UnchangedBricks[n];
+      }
+    if (modified)
+      {
+      brick.Data = vtkSmartPointer<vtkUnsignedCharArray>::New();
+      internal->BricksToCompress.push_back(n);
+      }
+    else
+      {
+      brick.Data = previous->Bricks[n].Data;
+      brick.Hash = previous->Bricks[n].Hash;
+      }
+    }
+  this->NumberOfCompressedBricks = static_cast<int>(internal->BricksToCompress.size());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStash::CompressBricks()
+{
+  //
+  // put a compressed version of the modified bricks into the stash,
+  // and then set the scalar size to zero
+  //
+  vtkInternal* internal = this->Internal;
+  vtkDataArray *scalars = this->GetStashImage()->GetPointData()->GetScalars();
+  unsigned char *p = static_cast<unsigned char *>(scalars->GetVoidPointer(0));
+  int numberOfErrors = internal->Execute(vtkInternal::CompressBricks,
+                                         internal->BricksToCompress, p,
+                                         this->CompressionLevel);
+  internal->BricksToCompress.clear();
+  if (numberOfErrors)
+    {
+    // keep the scalars, the stash can't restore them
+    vtkErrorWithObjectMacro (this, "Cannot stash - failed to compress "
+                             << numberOfErrors << " bricks");
+    internal->Valid = false;
+    return;
+    }
+  internal->Valid = true;
+
+  if (!this->KeepScalars)
+    {
+    // this will realloc a zero sized buffer
+    scalars->SetNumberOfTuples(0);
+    scalars->Squeeze();
+    }
 }
 
 //----------------------------------------------------------------------------
 void vtkImageStash::Unstash()
+{
+  this->Unstash(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStash::Unstash(vtkImageStash *currentStash)
 {
   //
   // put the decompressed values back into the scalar array
-  //  - note: image data cannot have been touched since calling Stash
   //
   if (!this->StashImage)
     {
@@ -138,48 +574,97 @@ void vtkImageStash::Unstash()
     return;
     }
 
-  vtkDataArray *scalars = this->StashImage->GetPointData()->GetScalars();  
-  if (!scalars)
+  vtkInternal* internal = this->Internal;
+  if (!internal->Valid)
     {
-    vtkErrorMacro ("Cannot unstash - image has no scalars");
+    vtkErrorMacro ("Cannot unstash - nothing in the stash");
     return;
     }
 
-  if (!this->StashedScalars)
+  vtkDataArray *scalars = this->StashImage->GetPointData()->GetScalars();
+  int *extent = this->StashImage->GetExtent();
+  bool sameGeometry = scalars &&
+    scalars->GetDataType() == internal->ScalarType &&
+    scalars->GetNumberOfComponents() == internal->NumberOfComponents &&
+    extent[1] - extent[0] + 1 == internal->Dimensions[0] &&
+    extent[3] - extent[2] + 1 == internal->Dimensions[1] &&
+    extent[5] - extent[4] + 1 == internal->Dimensions[2];
+  if (!sameGeometry)
     {
-    vtkErrorMacro ("Cannot unstash - nothing in the stash");
-    return;
+    // the image has been replaced, restore the stashed geometry
+    this->StashImage->SetExtent(internal->Extent);
+    this->StashImage->SetScalarType(internal->ScalarType);
+    this->StashImage->SetNumberOfScalarComponents(internal->NumberOfComponents);
+    this->StashImage->AllocateScalars();
+    scalars = this->StashImage->GetPointData()->GetScalars();
+    }
+  bool stripped = scalars->GetNumberOfTuples() != this->GetNumberOfTuples();
+  if (stripped)
+    {
+    // we saved the original number of tuples before squeezing
+    //   - the number of components and the datatype are unchanged from before
+    //     so setting the number of tuples reallocates the right amount of data
+    scalars->SetNumberOfTuples(this->GetNumberOfTuples());
     }
 
-  // we saved the original number of tuples before squeezing
-  //   - the number of components and the datatype are unchanged from before
-  //     so we know the right size for the output buffer
-  vtkIdType numPrims = this->GetNumberOfTuples() * scalars->GetNumberOfComponents();
-  vtkIdType size = vtkDataArray::GetDataTypeSize(scalars->GetDataType());
-  vtkIdType scalarSize = size * numPrims;
-
-  // setting the number of tuples reallocates the right amount of data
-  // so we can uncompress directly into the buffer
-  scalars->SetNumberOfTuples(this->GetNumberOfTuples());
-  vtkIdType stashedSize = this->StashedScalars->GetNumberOfTuples();
-  unsigned char *scalar_p = 
-      static_cast<unsigned char *>(scalars->WriteVoidPointer(0, numPrims));
-  unsigned char *stash_p = 
-      static_cast<unsigned char *>(this->StashedScalars->WriteVoidPointer(0, stashedSize));
-  this->GetCompressor()->Uncompress(stash_p, stashedSize, scalar_p, scalarSize);
+  // only the bricks that differ from the current content need to be
+  // decompressed
+  std::vector<int> bricks;
+  bool diff = sameGeometry && !stripped && currentStash && currentStash != this &&
+    !currentStash->GetStashing() && internal->IsCompatible(currentStash->Internal);
+  this->UnstashedExtent[0] = this->UnstashedExtent[2] = this->UnstashedExtent[4] = VTK_INT_MAX;
+  this->UnstashedExtent[1] = this->UnstashedExtent[3] = this->UnstashedExtent[5] = VTK_INT_MIN;
+  for (int n = 0; n < static_cast<int>(internal->Bricks.size()); ++n)
+    {
+    const vtkInternal::Brick& brick = internal->Bricks[n];
+    if (!diff || brick.Data != currentStash->Internal->Bricks[n].Data)
+      {
+      bricks.push_back(n);
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        this->UnstashedExtent[2 * axis] = std::min(this->UnstashedExtent[2 * axis],
+          brick.Extent[2 * axis] + extent[2 * axis]);
+        this->UnstashedExtent[2 * axis + 1] = std::max(this->UnstashedExtent[2 * axis + 1],
+          brick.Extent[2 * axis + 1] + extent[2 * axis]);
+        }
+      }
+    }
+  if (bricks.empty())
+    {
+    this->UnstashedExtent[0] = this->UnstashedExtent[2] = this->UnstashedExtent[4] = 0;
+    this->UnstashedExtent[1] = this->UnstashedExtent[3] = this->UnstashedExtent[5] = -1;
+    }
+  unsigned char *scalar_p = static_cast<unsigned char *>(scalars->GetVoidPointer(0));
+  int numberOfErrors = internal->Execute(vtkInternal::UncompressBricks, bricks, scalar_p,
+                                         this->CompressionLevel);
+  if (numberOfErrors)
+    {
+    vtkErrorMacro ("Unstash: failed to decompress " << numberOfErrors << " bricks");
+    }
+  scalars->Modified();
+  this->StashImage->Modified();
 }
 
 //----------------------------------------------------------------------------
 void vtkImageStash::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
-  
+
   os << indent << "StashImage: " << this->GetStashImage() << "\n";
+  os << indent << "PreviousStash: " << this->GetPreviousStash() << "\n";
   os << indent << "Stashing: " << this->GetStashing() << "\n";
-  os << indent << "Stashed Scalars: " << this->GetStashedScalars() << "\n";
-  if ( this->GetStashedScalars()) this->GetStashedScalars()->PrintSelf(os,indent.GetNextIndent());
   os << indent << "CompressionLevel: " << this->GetCompressionLevel() << "\n";
-  os << indent << "Compressor: \n";
-  this->GetCompressor()->PrintSelf(os,indent.GetNextIndent());
+  os << indent << "BrickSize: " << this->GetBrickSize() << "\n";
+  os << indent << "ModifiedExtent: " << this->ModifiedExtent[0] << " "
+     << this->ModifiedExtent[1] << " " << this->ModifiedExtent[2] << " "
+     << this->ModifiedExtent[3] << " " << this->ModifiedExtent[4] << " "
+     << this->ModifiedExtent[5] << "\n";
+  os << indent << "KeepScalars: " << this->GetKeepScalars() << "\n";
+  os << indent << "UnstashedExtent: " << this->UnstashedExtent[0] << " "
+     << this->UnstashedExtent[1] << " " << this->UnstashedExtent[2] << " "
+     << this->UnstashedExtent[3] << " " << this->UnstashedExtent[4] << " "
+     << this->UnstashedExtent[5] << "\n";
+  os << indent << "NumberOfBricks: " << this->GetNumberOfBricks() << "\n";
+  os << indent << "NumberOfCompressedBricks: " << this->GetNumberOfCompressedBricks() << "\n";
+  os << indent << "StashedSize: " << this->GetStashedSize() << "\n";
 }
-
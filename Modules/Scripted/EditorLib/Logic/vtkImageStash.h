@@ -14,6 +14,18 @@
 =========================================================================*/
 ///  vtkImageStash - 
 ///  Store an image data in a compressed form to save memory
+///
+///  The scalars are split into bricks of BrickSize^3 voxels that are
+///  compressed independently and in parallel.
+///
+///  When PreviousStash is set, only the bricks that differ from it are
+///  compressed, the other bricks share the compressed data of the previous
+///  stash. The modified bricks are the bricks intersecting ModifiedExtent
+///  when it is set. Otherwise the bricks are compared to the bricks of the
+///  previous stash by a 64-bit hash of their voxels (crc32 and adler32),
+///  without decompressing them.
+///  Successive stashes of an image edited by strokes then cost time and
+///  memory proportional to the strokes.
 
 #ifndef __vtkImageStash_h
 #define __vtkImageStash_h
@@ -23,8 +35,6 @@
 // VTK includes
 #include <vtkImageData.h>
 #include <vtkMultiThreader.h>
-#include <vtkUnsignedCharArray.h>
-#include <vtkZLibDataCompressor.h>
 
 class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageStash : public vtkObject
 {
@@ -43,12 +53,6 @@ public:
   vtkSetObjectMacro(StashImage, vtkImageData);
   vtkGetObjectMacro(StashImage, vtkImageData);
 
-  /// 
-  /// The stashed scalars:
-  /// this is the zlib compressed image scalar data
-  vtkSetObjectMacro(StashedScalars, vtkUnsignedCharArray);
-  vtkGetObjectMacro(StashedScalars, vtkUnsignedCharArray);
-
   // Description:
   // To keep track of original number of tuples in scalar data
   vtkSetMacro(NumberOfTuples, vtkIdType);
@@ -64,22 +68,65 @@ public:
   void Stash();
 
   /// 
-  /// compress and strip the scalars in a separate thread
+  /// compress and strip the scalars in a separate thread.
+  /// The bricks shared with PreviousStash are found before returning,
+  /// the stash image must not be modified until GetStashing() is 0.
   void ThreadedStash();
 
   /// 
   /// decompress and restore the scalars
   void Unstash();
 
+  /// 
+  /// decompress the scalars into the stash image. If currentStash is the
+  /// stash of the current content of the stash image, only the bricks
+  /// that differ from it are decompressed.
+  void Unstash(vtkImageStash *currentStash);
+
   // Description:
   // Get/Set the compression level.
   vtkSetClampMacro(CompressionLevel, int, 0, 9);
   vtkGetMacro(CompressionLevel, int);
 
   // Description:
-  // Get/Set the compressor if needed
-  vtkSetObjectMacro(Compressor, vtkZLibDataCompressor);
-  vtkGetObjectMacro(Compressor, vtkZLibDataCompressor);
+  // Number of voxels along each axis of the bricks compressed independently
+  vtkSetClampMacro(BrickSize, int, 1, VTK_INT_MAX);
+  vtkGetMacro(BrickSize, int);
+
+  // Description:
+  // Stash of a previous state of the image to share the unmodified
+  // bricks with. It is only used by Stash() and ThreadedStash().
+  vtkSetObjectMacro(PreviousStash, vtkImageStash);
+  vtkGetObjectMacro(PreviousStash, vtkImageStash);
+
+  // Description:
+  // Extent of the voxels modified since PreviousStash, in structured
+  // coordinates. If the extent is empty (default), all the bricks are
+  // compared to the ones of PreviousStash.
+  vtkSetVector6Macro(ModifiedExtent, int);
+  vtkGetVector6Macro(ModifiedExtent, int);
+
+  // Description:
+  // Keep the scalars of the stash image after stashing, e.g. when the
+  // stash image is the image being edited instead of a copy. Off by default.
+  vtkSetMacro(KeepScalars, int);
+  vtkGetMacro(KeepScalars, int);
+  vtkBooleanMacro(KeepScalars, int);
+
+  // Description:
+  // Extent of the bricks decompressed by the last Unstash, in structured
+  // coordinates. It is empty if no brick was decompressed.
+  vtkGetVector6Macro(UnstashedExtent, int);
+
+  // Description:
+  // Number of bricks of the stash, and number of bricks compressed by the
+  // last stash instead of being shared with PreviousStash
+  int GetNumberOfBricks();
+  vtkGetMacro(NumberOfCompressedBricks, int);
+
+  // Description:
+  // Size in bytes of the compressed bricks, including the shared ones
+  vtkTypeInt64 GetStashedSize();
 
   // Description:
   // Check if compression thread is finished
@@ -90,14 +137,29 @@ protected:
   vtkImageStash();
   ~vtkImageStash();
 
+  /// 
+  /// Find the bricks to compress and share the other ones.
+  /// Return false if the stash image cannot be stashed.
+  bool PrepareStash();
+  /// 
+  /// Compress the bricks found by PrepareStash and strip the scalars
+  void CompressBricks();
+
   vtkImageData *StashImage;
-  vtkUnsignedCharArray *StashedScalars;
+  vtkImageStash *PreviousStash;
   vtkMultiThreader *MultiThreader;
   vtkIdType NumberOfTuples;
-  vtkZLibDataCompressor *Compressor;
   int CompressionLevel;
+  int BrickSize;
+  int ModifiedExtent[6];
+  int KeepScalars;
+  int UnstashedExtent[6];
+  int NumberOfCompressedBricks;
   int Stashing;
 
+  class vtkInternal;
+  vtkInternal *Internal;
+
 private:
   int StashingThreadID;
 
@@ -293,6 +293,7 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     # interaction state variables
     self.position = [0, 0, 0]
     self.paintCoordinates = []
+    self.paintedCorners = []
     self.feedbackActors = []
     self.lastRadius = 0
 
@@ -506,6 +507,9 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     labelLogic = sliceLogic.GetLabelLayer()
     labelNode = labelLogic.GetVolumeNode()
     self.editUtil.markVolumeNodeAsModified(labelNode)
+    if self.undoRedo:
+      self.undoRedo.addModifiedCorners(labelNode, self.paintedCorners)
+    self.paintedCorners = []
 
   def paintPixel(self, x, y):
     """
@@ -537,6 +541,7 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     parameterNode = self.editUtil.getParameterNode()
     paintLabel = int(parameterNode.GetParameter("label"))
     labelImage.SetScalarComponentFromFloat(ijk[0],ijk[1],ijk[2],0, paintLabel)
+    self.paintedCorners.append(ijk)
     self.editUtil.markVolumeNodeAsModified(labelNode)
 
   def paintBrush(self, x, y):
@@ -735,6 +740,7 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
 
 
             self.painter.Paint()
+            self.paintedCorners += [tltemp, trtemp, bltemp, brtemp]
 
 
     # paint the slice: same for circular and spherical brush modes
@@ -745,6 +751,7 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     self.painter.SetBrushCenter( brushCenter[0], brushCenter[1], brushCenter[2] )
     self.painter.SetBrushRadius( brushRadius )
     self.painter.Paint()
+    self.paintedCorners += [tl, tr, bl, br]
 
 
 #
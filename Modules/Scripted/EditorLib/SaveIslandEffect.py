@@ -141,16 +141,23 @@ class SaveIslandEffectLogic(IslandEffect.IslandEffectLogic):
     ijk = xyToIJK.MultiplyPoint( xy + (0, 1) )[:3]
     ijk = map(lambda v: int(round(v)), ijk)
 
-    connectivity = slicer.vtkImageConnectivity()
-    connectivity.SetFunctionToSaveIsland()
-    connectivity.SetInput( self.getScopedLabelInput() )
-    connectivity.SetOutput( self.getScopedLabelOutput() )
-    connectivity.SetSeed( ijk )
-    # TODO: $this setProgressFilter $connectivity "Save Island"
-    connectivity.Update()
+    # the scoped output can be the scoped input: work on a shallow copy
+    labelImage = vtk.vtkImageData()
+    labelImage.ShallowCopy( self.getScopedLabelInput() )
+    islandImage = self.seedIsland(labelImage, ijk)
+    if islandImage is None:
+      return
+
+    # keep the input on the island, clear everything else
+    mask = vtk.vtkImageMask()
+    mask.SetImageInput( labelImage )
+    mask.SetMaskInput( islandImage )
+    mask.SetMaskedOutputValue( 0 )
+    mask.SetOutput( self.getScopedLabelOutput() )
+    mask.Update()
 
     self.applyScopedLabel()
-    connectivity.SetOutput( None )
+    mask.SetOutput( None )
 
 #
 # The SaveIslandEffect class definition 
@@ -431,36 +431,41 @@ class SurfaceToolboxLogic:
 
     surface = state.inputModelNode.GetPolyData()
 
-    if state.decimation:
-      triangle = vtk.vtkTriangleFilter()
-      triangle.SetInput(surface)
-      decimation = vtk.vtkDecimatePro()
-      decimation.SetInput(triangle.GetOutput())
-      decimation.SetTargetReduction(state.reduction)
-      decimation.SetBoundaryVertexDeletion(state.boundaryDeletion)
-      decimation.PreserveTopologyOn()
-      decimation.Update()
-      surface = decimation.GetOutput()
-
-    if state.smoothing:
-      if state.smoothingMethod == "Laplace":
-        smoothing = vtk.vtkSmoothPolyDataFilter()
-        smoothing.SetInput(surface)
-        smoothing.SetBoundarySmoothing(state.boundarySmoothing)
-        smoothing.SetNumberOfIterations(state.laplaceIterations)
-        smoothing.SetRelaxationFactor(state.laplaceRelaxation)
-        smoothing.Update()
-        surface = smoothing.GetOutput()
-      elif state.smoothingMethod == "Taubin":
-        smoothing = vtk.vtkWindowedSincPolyDataFilter()
-        smoothing.SetInput(surface)
-        smoothing.SetBoundarySmoothing(state.boundarySmoothing)
-        smoothing.SetNumberOfIterations(state.taubinIterations)
-        smoothing.SetPassBand(state.taubinPassBand)
-        smoothing.Update()
-        surface = smoothing.GetOutput()
-
-    if state.normals:
+    # Decimation, Laplace smoothing and normals are computed in one pass over
+    # the mesh. The filter outputs triangles only: it is not used for normals
+    # alone, vtkPolyDataNormals keeps the vertices, lines and cell data.
+    laplace = state.smoothing and state.smoothingMethod == "Laplace"
+    taubin = state.smoothing and state.smoothingMethod == "Taubin"
+    meshProcessingNormals = (state.normals and not state.splitting and not taubin)
+    if state.decimation or laplace:
+      meshProcessing = slicer.vtkSlicerMeshProcessingFilter()
+      meshProcessing.SetInput(surface)
+      meshProcessing.SetDecimation(state.decimation)
+      meshProcessing.SetTargetReduction(state.reduction)
+      meshProcessing.SetBoundaryDeletion(state.boundaryDeletion)
+      meshProcessing.SetSmoothing(laplace)
+      meshProcessing.SetBoundarySmoothing(state.boundarySmoothing)
+      meshProcessing.SetSmoothingMethodToLaplace()
+      meshProcessing.SetNumberOfIterations(int(state.laplaceIterations))
+      meshProcessing.SetRelaxationFactor(state.laplaceRelaxation)
+      meshProcessing.SetComputeNormals(meshProcessingNormals)
+      meshProcessing.SetAutoOrientNormals(meshProcessingNormals)
+      meshProcessing.SetFlipNormals(meshProcessingNormals and state.flipNormals)
+      meshProcessing.Update()
+      surface = meshProcessing.GetOutput()
+    else:
+      meshProcessingNormals = False
+
+    if taubin:
+      smoothing = vtk.vtkWindowedSincPolyDataFilter()
+      smoothing.SetInput(surface)
+      smoothing.SetBoundarySmoothing(state.boundarySmoothing)
+      smoothing.SetNumberOfIterations(state.taubinIterations)
+      smoothing.SetPassBand(state.taubinPassBand)
+      smoothing.Update()
+      surface = smoothing.GetOutput()
+
+    if state.normals and not meshProcessingNormals:
       normals = vtk.vtkPolyDataNormals()
       normals.SetInput(surface)
       normals.AutoOrientNormalsOn()
@@ -522,6 +527,8 @@ class SurfaceToolboxTest(unittest.TestCase):
     """
     self.setUp()
     self.test_SurfaceToolbox1()
+    self.setUp()
+    self.test_SurfaceToolbox2()
 
   def test_SurfaceToolbox1(self):
     """ Ideally you should have several levels of tests.  At the lowest level
@@ -558,3 +565,130 @@ class SurfaceToolboxTest(unittest.TestCase):
     logic = SurfaceToolboxLogic()
     self.assertTrue( logic.hasImageData(volumeNode) )
     self.delayDisplay('Test passed!')
+
+  def test_SurfaceToolbox2(self):
+    """ Compare the outputs of the logic with the VTK filters it replaces
+    or keeps using.
+    """
+    self.delayDisplay("Starting the filter comparison test")
+
+    # Sphere with a line and cell data: only triangles go through the mesh
+    # processing filter
+    sphere = vtk.vtkSphereSource()
+    sphere.SetThetaResolution(32)
+    sphere.SetPhiResolution(32)
+    line = vtk.vtkLineSource()
+    line.SetPoint1(-1., 0., 0.)
+    line.SetPoint2(1., 0., 0.)
+    append = vtk.vtkAppendPolyData()
+    append.AddInput(sphere.GetOutput())
+    append.AddInput(line.GetOutput())
+    cellIds = vtk.vtkIdFilter()
+    cellIds.SetInputConnection(append.GetOutputPort())
+    cellIds.PointIdsOff()
+    cellIds.CellIdsOn()
+    cellIds.Update()
+    surface = cellIds.GetOutput()
+
+    inputModelNode = slicer.vtkMRMLModelNode()
+    inputModelNode.SetAndObservePolyData(surface)
+    slicer.mrmlScene.AddNode(inputModelNode)
+    outputModelNode = slicer.vtkMRMLModelNode()
+    slicer.mrmlScene.AddNode(outputModelNode)
+
+    class state(object):
+      pass
+    def defaultState():
+      s = state()
+      s.inputModelNode = inputModelNode
+      s.outputModelNode = outputModelNode
+      s.decimation = False
+      s.reduction = 0.8
+      s.boundaryDeletion = False
+      s.smoothing = False
+      s.smoothingMethod = "Laplace"
+      s.laplaceIterations = 100.0
+      s.laplaceRelaxation = 0.5
+      s.taubinIterations = 30.0
+      s.taubinPassBand = 0.1
+      s.boundarySmoothing = True
+      s.normals = False
+      s.flipNormals = False
+      s.splitting = False
+      s.featureAngle = 30.0
+      s.cleaner = False
+      s.connectivity = False
+      return s
+
+    def assertSamePolyData(polyData, expected):
+      self.assertEqual(polyData.GetNumberOfPoints(), expected.GetNumberOfPoints())
+      self.assertEqual(polyData.GetNumberOfVerts(), expected.GetNumberOfVerts())
+      self.assertEqual(polyData.GetNumberOfLines(), expected.GetNumberOfLines())
+      self.assertEqual(polyData.GetNumberOfPolys(), expected.GetNumberOfPolys())
+      self.assertEqual(polyData.GetCellData().GetNumberOfArrays(),
+                       expected.GetCellData().GetNumberOfArrays())
+      for i in xrange(expected.GetNumberOfPoints()):
+        point = polyData.GetPoint(i)
+        expectedPoint = expected.GetPoint(i)
+        for j in xrange(3):
+          self.assertAlmostEqual(point[j], expectedPoint[j], places=6)
+
+    logic = SurfaceToolboxLogic()
+
+    # Normals only: vtkPolyDataNormals, the line and the cell data are kept
+    s = defaultState()
+    s.normals = True
+    s.flipNormals = True
+    self.assertTrue(logic.applyFilters(s))
+    normals = vtk.vtkPolyDataNormals()
+    normals.SetInput(surface)
+    normals.AutoOrientNormalsOn()
+    normals.FlipNormalsOn()
+    normals.SetSplitting(False)
+    normals.SetFeatureAngle(30.0)
+    normals.ConsistencyOn()
+    normals.Update()
+    output = outputModelNode.GetPolyData()
+    assertSamePolyData(output, normals.GetOutput())
+    self.assertEqual(output.GetNumberOfLines(), 1)
+    self.assertTrue(output.GetCellData().GetArray("vtkIdFilter_Ids") is not None)
+    self.assertTrue(output.GetPointData().GetNormals() is not None)
+
+    # Taubin smoothing: vtkWindowedSincPolyDataFilter, same pass band
+    s = defaultState()
+    s.smoothing = True
+    s.smoothingMethod = "Taubin"
+    self.assertTrue(logic.applyFilters(s))
+    smoothing = vtk.vtkWindowedSincPolyDataFilter()
+    smoothing.SetInput(surface)
+    smoothing.SetBoundarySmoothing(True)
+    smoothing.SetNumberOfIterations(30)
+    smoothing.SetPassBand(0.1)
+    smoothing.Update()
+    assertSamePolyData(outputModelNode.GetPolyData(), smoothing.GetOutput())
+
+    # Laplace smoothing with normals: one pass of the mesh processing
+    # filter, the normals point outward like vtkPolyDataNormals ones
+    s = defaultState()
+    s.smoothing = True
+    s.laplaceIterations = 10.0
+    s.normals = True
+    self.assertTrue(logic.applyFilters(s))
+    output = outputModelNode.GetPolyData()
+    self.assertEqual(output.GetNumberOfPolys(), sphere.GetOutput().GetNumberOfPolys())
+    outputNormals = output.GetPointData().GetNormals()
+    self.assertTrue(outputNormals is not None)
+    for i in xrange(output.GetNumberOfPoints()):
+      point = output.GetPoint(i)
+      normal = outputNormals.GetTuple3(i)
+      self.assertTrue(sum([point[j] * normal[j] for j in xrange(3)]) > 0.)
+
+    # Decimation
+    s = defaultState()
+    s.decimation = True
+    s.reduction = 0.5
+    self.assertTrue(logic.applyFilters(s))
+    numberOfPolys = sphere.GetOutput().GetNumberOfPolys()
+    self.assertTrue(outputModelNode.GetPolyData().GetNumberOfPolys() < 0.6 * numberOfPolys)
+
+    self.delayDisplay('Test passed!')